@@ -0,0 +1,100 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include "esp_websocket_bufpool.h"
+
+void esp_websocket_bufpool_init(esp_websocket_bufpool_t *pool, esp_websocket_bufpool_slot_t *slots, int slot_count,
+                                size_t size, uint32_t idle_ms)
+{
+    pool->slots = slots;
+    pool->slot_count = slot_count;
+    pool->size = size;
+    pool->idle_ms = idle_ms;
+    for (int i = 0; i < slot_count; i++) {
+        atomic_init(&slots[i].buf, NULL);
+        atomic_init(&slots[i].since, 0);
+    }
+    atomic_init(&pool->hits, 0);
+    atomic_init(&pool->misses, 0);
+    atomic_init(&pool->trimmed, 0);
+    atomic_init(&pool->overflow, 0);
+}
+
+void *esp_websocket_bufpool_get(esp_websocket_bufpool_t *pool)
+{
+    for (int i = 0; i < pool->slot_count; i++) {
+        esp_websocket_bufpool_slot_t *s = &pool->slots[i];
+        // Cheap check first so empty slots are not written to
+        if (atomic_load_explicit(&s->buf, memory_order_relaxed) == NULL) {
+            continue;
+        }
+        void *buf = atomic_exchange_explicit(&s->buf, NULL, memory_order_acquire);
+        if (buf) {
+            atomic_fetch_add_explicit(&pool->hits, 1, memory_order_relaxed);
+            return buf;
+        }
+    }
+    atomic_fetch_add_explicit(&pool->misses, 1, memory_order_relaxed);
+    return malloc(pool->size);
+}
+
+void esp_websocket_bufpool_put(esp_websocket_bufpool_t *pool, void *buf, uint32_t now_ms)
+{
+    if (buf == NULL) {
+        return;
+    }
+    for (int i = 0; i < pool->slot_count; i++) {
+        esp_websocket_bufpool_slot_t *s = &pool->slots[i];
+        void *expected = NULL;
+        if (atomic_load_explicit(&s->buf, memory_order_relaxed) != NULL) {
+            continue;
+        }
+        // The stamp may briefly belong to the previous buffer of the slot; at worst trim frees a buffer early
+        atomic_store_explicit(&s->since, now_ms, memory_order_relaxed);
+        if (atomic_compare_exchange_strong_explicit(&s->buf, &expected, buf, memory_order_release,
+                memory_order_relaxed)) {
+            return;
+        }
+    }
+    atomic_fetch_add_explicit(&pool->overflow, 1, memory_order_relaxed);
+    free(buf);
+}
+
+int esp_websocket_bufpool_trim(esp_websocket_bufpool_t *pool, uint32_t now_ms)
+{
+    int freed = 0;
+    for (int i = 0; i < pool->slot_count; i++) {
+        esp_websocket_bufpool_slot_t *s = &pool->slots[i];
+        if (atomic_load_explicit(&s->buf, memory_order_relaxed) == NULL ||
+                now_ms - (uint32_t)atomic_load_explicit(&s->since, memory_order_relaxed) < pool->idle_ms) {
+            continue;
+        }
+        void *buf = atomic_exchange_explicit(&s->buf, NULL, memory_order_acquire);
+        if (buf) {
+            free(buf);
+            freed++;
+        }
+    }
+    atomic_fetch_add_explicit(&pool->trimmed, freed, memory_order_relaxed);
+    return freed;
+}
+
+void esp_websocket_bufpool_drain(esp_websocket_bufpool_t *pool)
+{
+    for (int i = 0; i < pool->slot_count; i++) {
+        free(atomic_exchange(&pool->slots[i].buf, NULL));
+    }
+}
+
+int esp_websocket_bufpool_cached(esp_websocket_bufpool_t *pool)
+{
+    int n = 0;
+    for (int i = 0; i < pool->slot_count; i++) {
+        n += atomic_load_explicit(&pool->slots[i].buf, memory_order_relaxed) != NULL;
+    }
+    return n;
+}
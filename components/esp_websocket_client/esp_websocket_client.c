@@ -7,6 +7,13 @@
 #include <stdio.h>
 
 #include "esp_websocket_client.h"
+#include "esp_websocket_frame.h"
+#include "esp_websocket_txq.h"
+#include "esp_websocket_wakeup.h"
+#include "esp_websocket_rxmsg.h"
+#include "esp_websocket_sink.h"
+#include "esp_websocket_bufpool.h"
+#include "esp_websocket_tls.h"
 #include "esp_transport.h"
 #include "esp_transport_tcp.h"
 #include "esp_transport_ssl.h"
@@ -22,6 +29,9 @@
 #include "esp_system.h"
 #include <errno.h>
 #include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/random.h>
+#include <stddef.h>
 
 static const char *TAG = "websocket_client";
 
@@ -38,6 +48,8 @@ static const char *TAG = "websocket_client";
 #define WEBSOCKET_KEEP_ALIVE_IDLE       (5)
 #define WEBSOCKET_KEEP_ALIVE_INTERVAL   (5)
 #define WEBSOCKET_KEEP_ALIVE_COUNT      (3)
+#define WEBSOCKET_TX_QUEUE_DEPTH        (16)
+#define WEBSOCKET_POLL_MAX_MS           (60 * 1000)     // Upper bound of one wait when no deadline is closer
 
 #define ESP_WS_CLIENT_MEM_CHECK(TAG, a, action) if (!(a)) {                                         \
         ESP_LOGE(TAG,"%s(%d): %s", __FUNCTION__, __LINE__, "Memory exhausted");                     \
@@ -101,6 +113,7 @@ typedef struct {
     const char                  *cert_common_name;
     esp_err_t                   (*crt_bundle_attach)(void *conf);
     esp_transport_handle_t      ext_transport;
+    int                         dns_cache_ttl_ms;
 } websocket_config_storage_t;
 
 typedef enum {
@@ -118,6 +131,7 @@ struct esp_websocket_client {
     esp_websocket_error_codes_t error_handle;
     esp_transport_list_handle_t transport_list;
     esp_transport_handle_t      transport;
+    esp_transport_handle_t      parent_transport;   /*!< tcp/ssl transport under `transport`, NULL for ext_transport */
     websocket_config_storage_t *config;
     websocket_client_state_t    state;
     uint64_t                    keepalive_tick_ms;
@@ -128,6 +142,8 @@ struct esp_websocket_client {
     bool                        run;
     bool                        wait_for_pong_resp;
     bool                        selected_for_destroying;
+    bool                        close_by_server;    /*!< The close handshake in progress was started by the server */
+    int                         ping_rtt_ms;        /*!< Time from the last answered PING to its PONG, -1 if none yet */
     EventGroupHandle_t          status_bits;
     SemaphoreHandle_t           lock;
     size_t                      errormsg_size;
@@ -141,29 +157,106 @@ struct esp_websocket_client {
     int                         payload_offset;
     esp_transport_keep_alive_t  keep_alive_cfg;
     struct ifreq                *if_name;
+    esp_websocket_txq_t         *tx_queue;          /*!< Outbound queue, NULL if not configured */
+    SemaphoreHandle_t           tx_queue_lock;      /*!< Guards tx_queue, never held while writing */
+    int                         wakeup_fd;          /*!< Interrupts the task's wait, -1 if unavailable */
+    volatile bool               reconnect_requested; /*!< Drop the connection on the next CONNECTED iteration */
+    esp_websocket_rxmsg_t       *rx_msg;            /*!< Message reassembly arena, NULL if not configured */
+    esp_websocket_sink_cb_t     sink;               /*!< Binary message sink, `on_data` NULL if not set */
+    esp_websocket_sink_t        sink_state;         /*!< Binary message in progress */
+    bool                        sink_frame;         /*!< The frame being read belongs to that message */
+    esp_websocket_data_handler_t data_handler;      /*!< Direct WEBSOCKET_EVENT_DATA receiver, NULL to post events */
+    void                        *data_handler_arg;
+    char                        dns_addr[INET6_ADDRSTRLEN]; /*!< Cached address of `config->host`, empty if none */
+    uint64_t                    dns_expires_ms;     /*!< Look the host up again from this time on */
+    esp_transport_handle_t      dns_transport;      /*!< Between `transport` and parent_transport with the DNS cache, else NULL */
+#ifdef CONFIG_ESP_WS_CLIENT_BUFFER_POOL
+    esp_websocket_bufpool_t     *buf_pool;          /*!< Source of the dynamic buffers: own_pool or the shared pool */
+    esp_websocket_bufpool_t     own_pool;
+    esp_websocket_bufpool_slot_t own_slots[2];      /*!< One rx and one tx buffer */
+#endif
+    esp_websocket_tls_store_t   *tls_store;         /*!< TLS sessions and handshake statistics, NULL if not resuming sessions */
+    esp_transport_handle_t      tls_transport;      /*!< parent_transport when it resumes sessions, to get its socket */
 };
 
+_Static_assert(sizeof(esp_websocket_iov_t) == sizeof(esp_websocket_txq_seg_t) &&
+               offsetof(esp_websocket_iov_t, len) == offsetof(esp_websocket_txq_seg_t, len),
+               "queued segments are written with the iov path");
+_Static_assert(WEBSOCKET_TX_LANE_MAX == ESP_WEBSOCKET_TXQ_LANES, "one queue lane per tx lane");
+_Static_assert(ESP_WEBSOCKET_TX_QUEUE_MAX_IOV <= ESP_WEBSOCKET_TXQ_MAX_SEGS, "referenced buffers per message");
+
 static uint64_t _tick_get_ms(void)
 {
     return esp_timer_get_time() / 1000;
 }
 
+#ifdef CONFIG_ESP_WS_CLIENT_BUFFER_POOL
+#if CONFIG_ESP_WS_CLIENT_BUFFER_POOL_SHARED_SLOTS > 0
+static esp_websocket_bufpool_slot_t s_shared_slots[CONFIG_ESP_WS_CLIENT_BUFFER_POOL_SHARED_SLOTS];
+static esp_websocket_bufpool_t s_shared_pool;
+static atomic_int s_shared_pool_state;              /*!< 0 unused, 1 being set up, 2 ready */
+#endif
+
+/* Clients with the buffer size of the first client share the pool, others get their own */
+static void esp_websocket_client_init_pool(esp_websocket_client_handle_t client, int buffer_size)
+{
+#if CONFIG_ESP_WS_CLIENT_BUFFER_POOL_SHARED_SLOTS > 0
+    int state = 0;
+    if (atomic_compare_exchange_strong(&s_shared_pool_state, &state, 1)) {
+        esp_websocket_bufpool_init(&s_shared_pool, s_shared_slots, CONFIG_ESP_WS_CLIENT_BUFFER_POOL_SHARED_SLOTS,
+                                   buffer_size, CONFIG_ESP_WS_CLIENT_BUFFER_POOL_IDLE_MS);
+        atomic_store(&s_shared_pool_state, 2);
+    }
+    while (atomic_load(&s_shared_pool_state) != 2) {
+        taskYIELD();
+    }
+    if (s_shared_pool.size == (size_t)buffer_size) {
+        client->buf_pool = &s_shared_pool;
+        return;
+    }
+#endif
+    esp_websocket_bufpool_init(&client->own_pool, client->own_slots, 2, buffer_size,
+                               CONFIG_ESP_WS_CLIENT_BUFFER_POOL_IDLE_MS);
+    client->buf_pool = &client->own_pool;
+}
+#endif
+
+#ifdef CONFIG_ESP_WS_CLIENT_ENABLE_DYNAMIC_BUFFER
+static char *esp_websocket_buf_alloc(esp_websocket_client_handle_t client)
+{
+#ifdef CONFIG_ESP_WS_CLIENT_BUFFER_POOL
+    return esp_websocket_bufpool_get(client->buf_pool);
+#else
+    return calloc(1, client->buffer_size);
+#endif
+}
+
+static void esp_websocket_buf_release(esp_websocket_client_handle_t client, char *buf)
+{
+#ifdef CONFIG_ESP_WS_CLIENT_BUFFER_POOL
+    esp_websocket_bufpool_put(client->buf_pool, buf, (uint32_t)_tick_get_ms());
+#else
+    free(buf);
+#endif
+}
+#endif
+
 static esp_err_t esp_websocket_new_buf(esp_websocket_client_handle_t client, bool is_tx)
 {
 #ifdef CONFIG_ESP_WS_CLIENT_ENABLE_DYNAMIC_BUFFER
     if (is_tx) {
         if (client->tx_buffer) {
-            free(client->tx_buffer);
+            esp_websocket_buf_release(client, client->tx_buffer);
         }
 
-        client->tx_buffer = calloc(1, client->buffer_size);
+        client->tx_buffer = esp_websocket_buf_alloc(client);
         ESP_WS_CLIENT_MEM_CHECK(TAG, client->tx_buffer, return ESP_ERR_NO_MEM);
     } else {
         if (client->rx_buffer) {
-            free(client->rx_buffer);
+            esp_websocket_buf_release(client, client->rx_buffer);
         }
 
-        client->rx_buffer = calloc(1, client->buffer_size);
+        client->rx_buffer = esp_websocket_buf_alloc(client);
         ESP_WS_CLIENT_MEM_CHECK(TAG, client->rx_buffer, return ESP_ERR_NO_MEM);
     }
 #endif
@@ -175,18 +268,32 @@ static void esp_websocket_free_buf(esp_websocket_client_handle_t client, bool is
 #ifdef CONFIG_ESP_WS_CLIENT_ENABLE_DYNAMIC_BUFFER
     if (is_tx) {
         if (client->tx_buffer) {
-            free(client->tx_buffer);
+            esp_websocket_buf_release(client, client->tx_buffer);
             client->tx_buffer = NULL;
         }
     } else {
         if (client->rx_buffer) {
-            free(client->rx_buffer);
+            esp_websocket_buf_release(client, client->rx_buffer);
             client->rx_buffer = NULL;
         }
     }
 #endif
 }
 
+/* Free pooled buffers that have not been used for CONFIG_ESP_WS_CLIENT_BUFFER_POOL_IDLE_MS */
+static void esp_websocket_client_trim_buffers(esp_websocket_client_handle_t client)
+{
+#ifdef CONFIG_ESP_WS_CLIENT_BUFFER_POOL
+    esp_websocket_bufpool_trim(client->buf_pool, (uint32_t)_tick_get_ms());
+#endif
+}
+
+/* Transport that records the errors of the connection: the DNS cache transport has no error state of its own */
+static esp_transport_handle_t esp_websocket_client_error_transport(esp_websocket_client_handle_t client)
+{
+    return client->dns_transport ? client->parent_transport : client->transport;
+}
+
 static esp_err_t esp_websocket_client_dispatch_event(esp_websocket_client_handle_t client,
         esp_websocket_event_id_t event,
         const char *data,
@@ -205,16 +312,20 @@ static esp_err_t esp_websocket_client_dispatch_event(esp_websocket_client_handle
     event_data.payload_offset = client->payload_offset;
 
     if (client->error_handle.error_type == WEBSOCKET_ERROR_TYPE_TCP_TRANSPORT) {
-        event_data.error_handle.esp_tls_last_esp_err = esp_tls_get_and_clear_last_error(esp_transport_get_error_handle(client->transport),
+        event_data.error_handle.esp_tls_last_esp_err = esp_tls_get_and_clear_last_error(esp_transport_get_error_handle(esp_websocket_client_error_transport(client)),
                 &client->error_handle.esp_tls_stack_err,
                 &client->error_handle.esp_tls_cert_verify_flags);
         event_data.error_handle.esp_tls_stack_err = client->error_handle.esp_tls_stack_err;
         event_data.error_handle.esp_tls_cert_verify_flags = client->error_handle.esp_tls_cert_verify_flags;
-        event_data.error_handle.esp_transport_sock_errno = esp_transport_get_errno(client->transport);
+        event_data.error_handle.esp_transport_sock_errno = esp_transport_get_errno(esp_websocket_client_error_transport(client));
     }
     event_data.error_handle.error_type = client->error_handle.error_type;
     event_data.error_handle.esp_ws_handshake_status_code = client->error_handle.esp_ws_handshake_status_code;
 
+    if (event == WEBSOCKET_EVENT_DATA && client->data_handler) {
+        client->data_handler(client->data_handler_arg, &event_data);
+        return ESP_OK;
+    }
 
     if ((err = esp_event_post_to(client->event_handle,
                                  WEBSOCKET_EVENTS, event,
@@ -226,10 +337,33 @@ static esp_err_t esp_websocket_client_dispatch_event(esp_websocket_client_handle
     return esp_event_loop_run(client->event_handle, 0);
 }
 
+/* Drop every queued message; runs after the state left CONNECTED so no new message can slip in */
+static void esp_websocket_client_flush_tx_queue(esp_websocket_client_handle_t client)
+{
+    if (client->tx_queue == NULL) {
+        return;
+    }
+    for (int lane = 0; lane < ESP_WEBSOCKET_TXQ_LANES; lane++) {
+        esp_websocket_txq_msg_t msg;
+        while (1) {
+            xSemaphoreTake(client->tx_queue_lock, portMAX_DELAY);
+            int ret = esp_websocket_txq_pop(client->tx_queue, lane, false, &msg);
+            xSemaphoreGive(client->tx_queue_lock);
+            if (ret != 0) {
+                break;
+            }
+            if (msg.done) {
+                msg.done(msg.arg, false);
+            }
+        }
+    }
+}
+
 static esp_err_t esp_websocket_client_abort_connection(esp_websocket_client_handle_t client, esp_websocket_error_type_t error_type)
 {
     ESP_WS_CLIENT_STATE_CHECK(TAG, client, return ESP_FAIL);
     esp_transport_close(client->transport);
+    client->reconnect_requested = false;    // Any disconnect satisfies a pending esp_websocket_client_reconnect()
 
     if (!client->config->auto_reconnect) {
         client->run = false;
@@ -240,6 +374,7 @@ static esp_err_t esp_websocket_client_abort_connection(esp_websocket_client_hand
         client->state = WEBSOCKET_STATE_WAIT_TIMEOUT;
     }
     client->error_handle.error_type = error_type;
+    esp_websocket_client_flush_tx_queue(client);
     esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_DISCONNECTED, NULL, 0);
     return ESP_OK;
 }
@@ -398,6 +533,8 @@ static esp_err_t esp_websocket_client_set_config(esp_websocket_client_handle_t c
         cfg->ping_interval_sec = config->ping_interval_sec;
     }
 
+    cfg->dns_cache_ttl_ms = config->dns_cache_ttl_ms;
+
     return ESP_OK;
 }
 
@@ -438,9 +575,32 @@ static void destroy_and_free_resources(esp_websocket_client_handle_t client)
     if (client->transport_list) {
         esp_transport_list_destroy(client->transport_list);
     }
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    // After the transports, which store their last session on close
+    esp_websocket_tls_store_destroy(client->tls_store);
+#endif
     vSemaphoreDelete(client->lock);
+    if (client->tx_queue) {
+        esp_websocket_client_flush_tx_queue(client);
+        esp_websocket_txq_deinit(client->tx_queue);
+        free(client->tx_queue);
+    }
+    if (client->tx_queue_lock) {
+        vSemaphoreDelete(client->tx_queue_lock);
+    }
+    esp_websocket_wakeup_close(client->wakeup_fd);
+    if (client->rx_msg) {
+        esp_websocket_rxmsg_deinit(client->rx_msg);
+        free(client->rx_msg);
+    }
     free(client->tx_buffer);
     free(client->rx_buffer);
+#ifdef CONFIG_ESP_WS_CLIENT_BUFFER_POOL
+    // The shared pool outlives the client and is trimmed by the remaining ones
+    if (client->buf_pool == &client->own_pool) {
+        esp_websocket_bufpool_drain(&client->own_pool);
+    }
+#endif
     free(client->errormsg_buffer);
     if (client->status_bits) {
         vEventGroupDelete(client->status_bits);
@@ -459,6 +619,7 @@ static esp_err_t stop_wait_task(esp_websocket_client_handle_t client)
     }
 
     client->run = false;
+    esp_websocket_wakeup_signal(client->wakeup_fd);
     xEventGroupWaitBits(client->status_bits, STOPPED_BIT, false, true, portMAX_DELAY);
     client->state = WEBSOCKET_STATE_UNKNOW;
     return ESP_OK;
@@ -481,6 +642,257 @@ static esp_err_t set_websocket_transport_optional_settings(esp_websocket_client_
     return ESP_ERR_INVALID_ARG;
 }
 
+/*
+ * Address to connect to for `host`. A host name is looked up here and the address is reused until
+ * `dns_cache_ttl_ms` expires, or kept when a lookup fails, so reconnects do not wait for DNS.
+ */
+static const char *esp_websocket_client_connect_host(esp_websocket_client_handle_t client, const char *host)
+{
+    struct in6_addr numeric;
+    if (inet_pton(AF_INET, host, &numeric) == 1 || inet_pton(AF_INET6, host, &numeric) == 1) {
+        return host;
+    }
+    uint64_t now = _tick_get_ms();
+    if (client->dns_addr[0] && now < client->dns_expires_ms) {
+        return client->dns_addr;
+    }
+
+    const struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res = NULL;
+    char resolved[INET6_ADDRSTRLEN] = "";
+    if (getaddrinfo(host, NULL, &hints, &res) == 0 && res) {
+        if (res->ai_family == AF_INET) {
+            inet_ntop(AF_INET, &((struct sockaddr_in *)res->ai_addr)->sin_addr, resolved, sizeof(resolved));
+        } else if (res->ai_family == AF_INET6) {
+            inet_ntop(AF_INET6, &((struct sockaddr_in6 *)res->ai_addr)->sin6_addr, resolved, sizeof(resolved));
+        }
+        freeaddrinfo(res);
+    }
+    if (resolved[0]) {
+        memcpy(client->dns_addr, resolved, sizeof(client->dns_addr));
+        client->dns_expires_ms = now + client->config->dns_cache_ttl_ms;
+        ESP_LOGD(TAG, "Resolved %s to %s", host, client->dns_addr);
+    } else if (client->dns_addr[0]) {
+        ESP_LOGW(TAG, "Failed to resolve %s, using cached address %s", host, client->dns_addr);
+    }
+    // Without any address the transport resolves the name itself and reports the failure
+    return client->dns_addr[0] ? client->dns_addr : host;
+}
+
+/*
+ * Parent of the ws transport with `dns_cache_ttl_ms`: the ws transport connects with the configured
+ * host name, which it also sends in the Host header, and this transport connects the tcp transport
+ * to the cached address instead. Everything else goes straight to the tcp transport.
+ */
+static void esp_websocket_client_connect_failed(esp_websocket_client_handle_t client, const char *addr)
+{
+    if (addr == client->dns_addr) {
+        // The host may have moved: look it up again on the next attempt, keep this one as fallback
+        client->dns_expires_ms = 0;
+    }
+}
+
+static int dns_connect(esp_transport_handle_t t, const char *host, int port, int timeout_ms)
+{
+    esp_websocket_client_handle_t client = esp_transport_get_context_data(t);
+    const char *addr = esp_websocket_client_connect_host(client, host);
+    int ret = esp_transport_connect(client->parent_transport, addr, port, timeout_ms);
+    if (ret < 0) {
+        esp_websocket_client_connect_failed(client, addr);
+    }
+    return ret;
+}
+
+static int dns_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms)
+{
+    esp_websocket_client_handle_t client = esp_transport_get_context_data(t);
+    return esp_transport_read(client->parent_transport, buffer, len, timeout_ms);
+}
+
+static int dns_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms)
+{
+    esp_websocket_client_handle_t client = esp_transport_get_context_data(t);
+    return esp_transport_write(client->parent_transport, buffer, len, timeout_ms);
+}
+
+static int dns_close(esp_transport_handle_t t)
+{
+    esp_websocket_client_handle_t client = esp_transport_get_context_data(t);
+    return esp_transport_close(client->parent_transport);
+}
+
+static int dns_poll_read(esp_transport_handle_t t, int timeout_ms)
+{
+    esp_websocket_client_handle_t client = esp_transport_get_context_data(t);
+    return esp_transport_poll_read(client->parent_transport, timeout_ms);
+}
+
+static int dns_poll_write(esp_transport_handle_t t, int timeout_ms)
+{
+    esp_websocket_client_handle_t client = esp_transport_get_context_data(t);
+    return esp_transport_poll_write(client->parent_transport, timeout_ms);
+}
+
+static int dns_destroy(esp_transport_handle_t t)
+{
+    // The client and the tcp transport are released on their own
+    (void)t;
+    return 0;
+}
+
+static esp_transport_handle_t esp_websocket_client_init_dns_transport(esp_websocket_client_handle_t client)
+{
+    esp_transport_handle_t t = esp_transport_init();
+    if (t == NULL) {
+        return NULL;
+    }
+    esp_transport_set_context_data(t, client);
+    esp_transport_set_func(t, dns_connect, dns_read, dns_write, dns_close, dns_poll_read, dns_poll_write, dns_destroy);
+    return t;
+}
+
+static esp_transport_handle_t esp_websocket_client_init_ssl_transport(esp_websocket_client_handle_t client)
+{
+    esp_transport_handle_t ssl = esp_transport_ssl_init();
+    if (ssl == NULL) {
+        return NULL;
+    }
+    if (client->keep_alive_cfg.keep_alive_enable) {
+        esp_transport_ssl_set_keep_alive(ssl, &client->keep_alive_cfg);
+    }
+    if (client->if_name) {
+        esp_transport_ssl_set_interface_name(ssl, client->if_name);
+    }
+
+    if (client->config->use_global_ca_store == true) {
+        esp_transport_ssl_enable_global_ca_store(ssl);
+    } else if (client->config->cert) {
+        if (!client->config->cert_len) {
+            esp_transport_ssl_set_cert_data(ssl, client->config->cert, strlen(client->config->cert));
+        } else {
+            esp_transport_ssl_set_cert_data_der(ssl, client->config->cert, client->config->cert_len);
+        }
+    }
+    if (client->config->client_cert) {
+        if (!client->config->client_cert_len) {
+            esp_transport_ssl_set_client_cert_data(ssl, client->config->client_cert, strlen(client->config->client_cert));
+        } else {
+            esp_transport_ssl_set_client_cert_data_der(ssl, client->config->client_cert, client->config->client_cert_len);
+        }
+    }
+    if (client->config->client_key) {
+        if (!client->config->client_key_len) {
+            esp_transport_ssl_set_client_key_data(ssl, client->config->client_key, strlen(client->config->client_key));
+        } else {
+            esp_transport_ssl_set_client_key_data_der(ssl, client->config->client_key, client->config->client_key_len);
+        }
+#if CONFIG_ESP_TLS_USE_DS_PERIPHERAL
+    } else if (client->config->client_ds_data) {
+        esp_transport_ssl_set_ds_data(ssl, client->config->client_ds_data);
+#endif
+    }
+    if (client->config->crt_bundle_attach) {
+#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        esp_transport_ssl_crt_bundle_attach(ssl, client->config->crt_bundle_attach);
+#else //CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        ESP_LOGE(TAG, "crt_bundle_attach configured but not enabled in menuconfig: Please enable MBEDTLS_CERTIFICATE_BUNDLE option");
+#endif
+    }
+    if (client->config->skip_cert_common_name_check) {
+        esp_transport_ssl_skip_common_name_check(ssl);
+    }
+    if (client->config->cert_common_name) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+        esp_transport_ssl_set_common_name(ssl, client->config->cert_common_name);
+#else
+        ESP_LOGE(TAG, "cert_common_name requires ESP-IDF 5.1.0 or later");
+#endif
+    }
+    return ssl;
+}
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+// Same settings as esp_websocket_client_init_ssl_transport(), for the transport that resumes sessions
+/*
+ * The TLS transport connects to the cached address itself: it has to give esp-tls the host name
+ * for SNI and the certificate check, so a parent transport like the ws one cannot swap it.
+ */
+static const char *tls_resolve(void *arg, const char *host)
+{
+    return esp_websocket_client_connect_host(arg, host);
+}
+
+static void tls_connect_failed(void *arg, const char *addr)
+{
+    esp_websocket_client_connect_failed(arg, addr);
+}
+
+static esp_transport_handle_t esp_websocket_client_init_tls_transport(esp_websocket_client_handle_t client)
+{
+    esp_tls_cfg_t cfg = { 0 };
+    if (client->keep_alive_cfg.keep_alive_enable) {
+        cfg.keep_alive_cfg = (tls_keep_alive_cfg_t *)&client->keep_alive_cfg;
+    }
+    cfg.if_name = client->if_name;
+
+    if (client->config->use_global_ca_store == true) {
+        cfg.use_global_ca_store = true;
+    } else if (client->config->cert) {
+        if (!client->config->cert_len) {
+            cfg.cacert_pem_buf = (const unsigned char *)client->config->cert;
+            cfg.cacert_pem_bytes = strlen(client->config->cert) + 1;
+        } else {
+            cfg.cacert_buf = (const unsigned char *)client->config->cert;
+            cfg.cacert_bytes = client->config->cert_len;
+        }
+    }
+    if (client->config->client_cert) {
+        if (!client->config->client_cert_len) {
+            cfg.clientcert_pem_buf = (const unsigned char *)client->config->client_cert;
+            cfg.clientcert_pem_bytes = strlen(client->config->client_cert) + 1;
+        } else {
+            cfg.clientcert_buf = (const unsigned char *)client->config->client_cert;
+            cfg.clientcert_bytes = client->config->client_cert_len;
+        }
+    }
+    if (client->config->client_key) {
+        if (!client->config->client_key_len) {
+            cfg.clientkey_pem_buf = (const unsigned char *)client->config->client_key;
+            cfg.clientkey_pem_bytes = strlen(client->config->client_key) + 1;
+        } else {
+            cfg.clientkey_buf = (const unsigned char *)client->config->client_key;
+            cfg.clientkey_bytes = client->config->client_key_len;
+        }
+#if CONFIG_ESP_TLS_USE_DS_PERIPHERAL
+    } else if (client->config->client_ds_data) {
+        cfg.ds_data = client->config->client_ds_data;
+#endif
+    }
+    if (client->config->crt_bundle_attach) {
+#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        cfg.crt_bundle_attach = client->config->crt_bundle_attach;
+#else //CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        ESP_LOGE(TAG, "crt_bundle_attach configured but not enabled in menuconfig: Please enable MBEDTLS_CERTIFICATE_BUNDLE option");
+#endif
+    }
+    cfg.skip_common_name = client->config->skip_cert_common_name_check;
+    cfg.common_name = client->config->cert_common_name;
+    esp_transport_handle_t tls = esp_websocket_tls_init(&cfg, client->tls_store);
+    if (tls && client->config->dns_cache_ttl_ms > 0) {
+        const esp_websocket_tls_resolver_t resolver = {
+            .resolve = tls_resolve,
+            .connect_failed = tls_connect_failed,
+            .arg = client,
+        };
+        esp_websocket_tls_set_resolver(tls, &resolver);
+    }
+    return tls;
+}
+#endif
+
 static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_handle_t client)
 {
     if (!client->config->scheme) {
@@ -492,6 +904,9 @@ static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_hand
         esp_transport_list_destroy(client->transport_list);
         client->transport_list = NULL;
     }
+    client->parent_transport = NULL;
+    client->tls_transport = NULL;
+    client->dns_transport = NULL;
 
     client->transport_list = esp_transport_list_init();
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->transport_list, return ESP_ERR_NO_MEM);
@@ -508,70 +923,36 @@ static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_hand
             esp_transport_tcp_set_interface_name(tcp, client->if_name);
         }
 
-        esp_transport_handle_t ws = esp_transport_ws_init(tcp);
+        client->parent_transport = tcp;
+        if (client->config->dns_cache_ttl_ms > 0) {
+            client->dns_transport = esp_websocket_client_init_dns_transport(client);
+            ESP_WS_CLIENT_MEM_CHECK(TAG, client->dns_transport, return ESP_ERR_NO_MEM);
+            esp_transport_set_default_port(client->dns_transport, WEBSOCKET_TCP_DEFAULT_PORT);
+            esp_transport_list_add(client->transport_list, client->dns_transport, "_dns");
+        }
+        esp_transport_handle_t ws = esp_transport_ws_init(client->dns_transport ? client->dns_transport : tcp);
         ESP_WS_CLIENT_MEM_CHECK(TAG, ws, return ESP_ERR_NO_MEM);
 
         esp_transport_set_default_port(ws, WEBSOCKET_TCP_DEFAULT_PORT);
         esp_transport_list_add(client->transport_list, ws, WS_OVER_TCP_SCHEME);
         ESP_WS_CLIENT_ERR_OK_CHECK(TAG, set_websocket_transport_optional_settings(client, WS_OVER_TCP_SCHEME), return ESP_FAIL;)
     } else if (strcasecmp(client->config->scheme, WS_OVER_TLS_SCHEME) == 0) {
-        esp_transport_handle_t ssl = esp_transport_ssl_init();
+        esp_transport_handle_t ssl = NULL;
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        if (client->tls_store) {
+            ssl = esp_websocket_client_init_tls_transport(client);
+            client->tls_transport = ssl;
+        } else
+#endif
+        {
+            ssl = esp_websocket_client_init_ssl_transport(client);
+        }
         ESP_WS_CLIENT_MEM_CHECK(TAG, ssl, return ESP_ERR_NO_MEM);
 
         esp_transport_set_default_port(ssl, WEBSOCKET_SSL_DEFAULT_PORT);
         esp_transport_list_add(client->transport_list, ssl, "_ssl"); // need to save to transport list, for cleanup
-        if (client->keep_alive_cfg.keep_alive_enable) {
-            esp_transport_ssl_set_keep_alive(ssl, &client->keep_alive_cfg);
-        }
-        if (client->if_name) {
-            esp_transport_ssl_set_interface_name(ssl, client->if_name);
-        }
-
-        if (client->config->use_global_ca_store == true) {
-            esp_transport_ssl_enable_global_ca_store(ssl);
-        } else if (client->config->cert) {
-            if (!client->config->cert_len) {
-                esp_transport_ssl_set_cert_data(ssl, client->config->cert, strlen(client->config->cert));
-            } else {
-                esp_transport_ssl_set_cert_data_der(ssl, client->config->cert, client->config->cert_len);
-            }
-        }
-        if (client->config->client_cert) {
-            if (!client->config->client_cert_len) {
-                esp_transport_ssl_set_client_cert_data(ssl, client->config->client_cert, strlen(client->config->client_cert));
-            } else {
-                esp_transport_ssl_set_client_cert_data_der(ssl, client->config->client_cert, client->config->client_cert_len);
-            }
-        }
-        if (client->config->client_key) {
-            if (!client->config->client_key_len) {
-                esp_transport_ssl_set_client_key_data(ssl, client->config->client_key, strlen(client->config->client_key));
-            } else {
-                esp_transport_ssl_set_client_key_data_der(ssl, client->config->client_key, client->config->client_key_len);
-            }
-#if CONFIG_ESP_TLS_USE_DS_PERIPHERAL
-        } else if (client->config->client_ds_data) {
-            esp_transport_ssl_set_ds_data(ssl, client->config->client_ds_data);
-#endif
-        }
-        if (client->config->crt_bundle_attach) {
-#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
-            esp_transport_ssl_crt_bundle_attach(ssl, client->config->crt_bundle_attach);
-#else //CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
-            ESP_LOGE(TAG, "crt_bundle_attach configured but not enabled in menuconfig: Please enable MBEDTLS_CERTIFICATE_BUNDLE option");
-#endif
-        }
-        if (client->config->skip_cert_common_name_check) {
-            esp_transport_ssl_skip_common_name_check(ssl);
-        }
-        if (client->config->cert_common_name) {
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
-            esp_transport_ssl_set_common_name(ssl, client->config->cert_common_name);
-#else
-            ESP_LOGE(TAG, "cert_common_name requires ESP-IDF 5.1.0 or later");
-#endif
-        }
 
+        client->parent_transport = ssl;
         esp_transport_handle_t wss = esp_transport_ws_init(ssl);
         ESP_WS_CLIENT_MEM_CHECK(TAG, wss, return ESP_ERR_NO_MEM);
 
@@ -586,6 +967,32 @@ static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_hand
     return ESP_OK;
 }
 
+static int esp_websocket_client_write_all(esp_transport_handle_t t, const char *buf, int len, int timeout_ms)
+{
+    int done = 0;
+    while (done < len) {
+        int wlen = esp_transport_write(t, buf + done, len - done, timeout_ms);
+        if (wlen <= 0) {
+            return wlen < 0 ? wlen : -1;
+        }
+        done += wlen;
+    }
+    return done;
+}
+
+static void esp_websocket_client_report_write_error(esp_websocket_client_handle_t client, int ret)
+{
+    esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(esp_websocket_client_error_transport(client));
+    if (error_handle) {
+        esp_websocket_client_error(client, "esp_transport_write() returned %d, transport_error=%s, tls_error_code=%i, tls_flags=%i, errno=%d",
+                                   ret, esp_err_to_name(error_handle->last_error), error_handle->esp_tls_error_code,
+                                   error_handle->esp_tls_flags, errno);
+    } else {
+        esp_websocket_client_error(client, "esp_transport_write() returned %d, errno=%d", ret, errno);
+    }
+    esp_websocket_client_abort_connection(client, WEBSOCKET_ERROR_TYPE_TCP_TRANSPORT);
+}
+
 static int esp_websocket_client_send_with_exact_opcode(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode, const uint8_t *data, int len, TickType_t timeout)
 {
     int ret = -1;
@@ -632,15 +1039,7 @@ static int esp_websocket_client_send_with_exact_opcode(esp_websocket_client_hand
         if (wlen < 0 || (wlen == 0 && need_write != 0)) {
             ret = wlen;
             esp_websocket_free_buf(client, true);
-            esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(client->transport);
-            if (error_handle) {
-                esp_websocket_client_error(client, "esp_transport_write() returned %d, transport_error=%s, tls_error_code=%i, tls_flags=%i, errno=%d",
-                                           ret, esp_err_to_name(error_handle->last_error), error_handle->esp_tls_error_code,
-                                           error_handle->esp_tls_flags, errno);
-            } else {
-                esp_websocket_client_error(client, "esp_transport_write() returned %d, errno=%d", ret, errno);
-            }
-            esp_websocket_client_abort_connection(client, WEBSOCKET_ERROR_TYPE_TCP_TRANSPORT);
+            esp_websocket_client_report_write_error(client, ret);
             goto unlock_and_return;
         }
         opcode = 0;
@@ -655,10 +1054,288 @@ unlock_and_return:
     return ret;
 }
 
+/* Write one message from several buffers; the caller holds client->lock. Returns the payload length or -1 */
+static int esp_websocket_client_send_segments(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode,
+        const esp_websocket_iov_t *iov, int iovcnt, size_t total, TickType_t timeout)
+{
+    opcode &= ~WS_TRANSPORT_OPCODES_FIN;
+    if (client->parent_transport == NULL) {
+        // External transport: no access to the raw stream, send as a fragmented message instead
+        for (int i = 0; i < iovcnt || i == 0; i++) {
+            ws_transport_opcodes_t op = (i == 0) ? opcode : WS_TRANSPORT_OPCODES_CONT;
+            if (i >= iovcnt - 1) {
+                op |= WS_TRANSPORT_OPCODES_FIN;
+            }
+            const uint8_t *data = iovcnt ? iov[i].data : NULL;
+            int len = iovcnt ? (int)iov[i].len : 0;
+            if (esp_websocket_client_send_with_exact_opcode(client, op, data, len, timeout) < 0) {
+                return -1;
+            }
+        }
+        return (int)total;
+    }
+
+    if (esp_websocket_new_buf(client, true) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to setup tx buffer");
+        return -1;
+    }
+
+    // One frame for the whole message: header, then every buffer masked straight into the tx buffer,
+    // which is flushed to the tcp/ssl transport whenever it fills up
+    uint8_t mask[4];
+    getrandom(mask, sizeof(mask), 0);
+    uint8_t *buf = (uint8_t *)client->tx_buffer;
+    int timeout_ms = (timeout == portMAX_DELAY) ? -1 : timeout * portTICK_PERIOD_MS;
+    size_t fill = esp_websocket_frame_header(buf, opcode | WS_TRANSPORT_OPCODES_FIN, total, mask);
+    size_t phase = 0;
+
+    for (int i = 0; i <= iovcnt; i++) {
+        const uint8_t *src = (i < iovcnt) ? iov[i].data : NULL;
+        size_t remain = (i < iovcnt) ? iov[i].len : 0;
+        while (remain > 0) {
+            size_t n = client->buffer_size - fill;
+            n = n < remain ? n : remain;
+            esp_websocket_mask_copy(buf + fill, src, n, mask, phase);
+            fill += n;
+            phase += n;
+            src += n;
+            remain -= n;
+            if (fill == client->buffer_size) {
+                int wlen = esp_websocket_client_write_all(client->parent_transport, (char *)buf, fill, timeout_ms);
+                if (wlen < 0) {
+                    esp_websocket_free_buf(client, true);
+                    esp_websocket_client_report_write_error(client, wlen);
+                    return -1;
+                }
+                fill = 0;
+            }
+        }
+    }
+    if (fill > 0) {
+        int wlen = esp_websocket_client_write_all(client->parent_transport, (char *)buf, fill, timeout_ms);
+        if (wlen < 0) {
+            esp_websocket_free_buf(client, true);
+            esp_websocket_client_report_write_error(client, wlen);
+            return -1;
+        }
+    }
+    esp_websocket_free_buf(client, true);
+    return (int)total;
+}
+
+int esp_websocket_client_send_iov(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode,
+                                  const esp_websocket_iov_t *iov, int iovcnt, TickType_t timeout)
+{
+    int ret;
+    size_t total = 0;
+
+    if (client == NULL || iovcnt < 0 || (iov == NULL && iovcnt > 0)) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return -1;
+    }
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].data == NULL && iov[i].len > 0) {
+            ESP_LOGE(TAG, "Invalid arguments");
+            return -1;
+        }
+        total += iov[i].len;
+    }
+    if (total > INT32_MAX) {
+        ESP_LOGE(TAG, "Message too long");
+        return -1;
+    }
+
+    if (!esp_websocket_client_is_connected(client)) {
+        ESP_LOGE(TAG, "Websocket client is not connected");
+        return -1;
+    }
+
+    if (client->transport == NULL) {
+        ESP_LOGE(TAG, "Invalid transport");
+        return -1;
+    }
+
+    if (xSemaphoreTakeRecursive(client->lock, timeout) != pdPASS) {
+        ESP_LOGE(TAG, "Could not lock ws-client within %" PRIu32 " timeout", timeout);
+        return -1;
+    }
+    ret = esp_websocket_client_send_segments(client, opcode, iov, iovcnt, total, timeout);
+    xSemaphoreGiveRecursive(client->lock);
+    return ret;
+}
+
+static esp_err_t esp_websocket_client_push(esp_websocket_client_handle_t client, esp_websocket_tx_lane_t lane,
+        ws_transport_opcodes_t opcode, const esp_websocket_iov_t *iov, int iovcnt, bool copy,
+        esp_websocket_tx_done_cb_t done_cb, void *arg)
+{
+    size_t total = 0;
+
+    if (client == NULL || lane < 0 || lane >= WEBSOCKET_TX_LANE_MAX || iovcnt < 0 || (iov == NULL && iovcnt > 0) ||
+            (!copy && iovcnt > ESP_WEBSOCKET_TX_QUEUE_MAX_IOV)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].data == NULL && iov[i].len > 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        total += iov[i].len;
+    }
+    if (total > INT32_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (client->tx_queue == NULL) {
+        ESP_LOGE(TAG, "Outbound queue is not configured");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(client->tx_queue_lock, portMAX_DELAY);
+    if (client->state != WEBSOCKET_STATE_CONNECTED) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (esp_websocket_txq_push(client->tx_queue, lane, opcode & ~WS_TRANSPORT_OPCODES_FIN,
+                                      (const esp_websocket_txq_seg_t *)iov, iovcnt, copy, done_cb, arg) != 0) {
+        err = ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(client->tx_queue_lock);
+    if (err == ESP_OK) {
+        esp_websocket_wakeup_signal(client->wakeup_fd);
+    }
+    return err;
+}
+
+esp_err_t esp_websocket_client_enqueue(esp_websocket_client_handle_t client, esp_websocket_tx_lane_t lane,
+                                       ws_transport_opcodes_t opcode, const char *data, int len)
+{
+    if (len < 0 || (data == NULL && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const esp_websocket_iov_t iov = { .data = data, .len = len };
+    return esp_websocket_client_push(client, lane, opcode, &iov, 1, true, NULL, NULL);
+}
+
+esp_err_t esp_websocket_client_enqueue_iov(esp_websocket_client_handle_t client, esp_websocket_tx_lane_t lane,
+        ws_transport_opcodes_t opcode, const esp_websocket_iov_t *iov, int iovcnt,
+        esp_websocket_tx_done_cb_t done_cb, void *arg)
+{
+    return esp_websocket_client_push(client, lane, opcode, iov, iovcnt, false, done_cb, arg);
+}
+
+esp_err_t esp_websocket_client_set_binary_sink(esp_websocket_client_handle_t client, const esp_websocket_binary_sink_t *sink)
+{
+    if (client == NULL || (sink && sink->on_data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // The task holds the lock while reading, so the sink never changes in the middle of a read
+    xSemaphoreTakeRecursive(client->lock, portMAX_DELAY);
+    if (sink) {
+        client->sink.get_buffer = sink->get_buffer;
+        client->sink.on_data = sink->on_data;
+        client->sink.ctx = sink->ctx;
+    } else {
+        memset(&client->sink, 0, sizeof(client->sink));
+    }
+    xSemaphoreGiveRecursive(client->lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_set_data_handler(esp_websocket_client_handle_t client, esp_websocket_data_handler_t handler,
+        void *arg)
+{
+    if (client == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTakeRecursive(client->lock, portMAX_DELAY);
+    client->data_handler = handler;
+    client->data_handler_arg = arg;
+    xSemaphoreGiveRecursive(client->lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_get_tls_stats(esp_websocket_client_handle_t client, esp_websocket_tls_stats_t *stats)
+{
+    if (client == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    if (client->tls_store) {
+        esp_websocket_tls_store_get_stats(client->tls_store, stats);
+        return ESP_OK;
+    }
+#endif
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_websocket_client_get_tx_queue_stats(esp_websocket_client_handle_t client, esp_websocket_tx_lane_t lane,
+        esp_websocket_tx_queue_stats_t *stats)
+{
+    if (client == NULL || stats == NULL || lane < 0 || lane >= WEBSOCKET_TX_LANE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->tx_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(client->tx_queue_lock, portMAX_DELAY);
+    const esp_websocket_txq_stats_t *st = &client->tx_queue->lanes[lane].stats;
+    stats->queued = st->queued;
+    stats->queued_bytes = st->queued_bytes;
+    stats->copy_used = st->ring_used;
+    stats->copy_size = st->ring_size;
+    stats->depth = st->depth;
+    stats->sent = st->sent;
+    stats->rejected = st->rejected;
+    stats->dropped = st->dropped;
+    stats->high_water_bytes = st->high_water_bytes;
+    xSemaphoreGive(client->tx_queue_lock);
+    return ESP_OK;
+}
+
+/**
+ * Called by the client task with client->lock held: write every queued control message, then at most one
+ * bulk message, so a control message waits for no more than the bulk frame already being written.
+ * Returns true if messages are still waiting.
+ */
+static bool esp_websocket_client_drain_tx_queue(esp_websocket_client_handle_t client)
+{
+    if (client->tx_queue == NULL) {
+        return false;
+    }
+    int lane = WEBSOCKET_TX_LANE_CONTROL;
+    while (lane == WEBSOCKET_TX_LANE_CONTROL && client->state == WEBSOCKET_STATE_CONNECTED) {
+        esp_websocket_txq_msg_t msg;
+        xSemaphoreTake(client->tx_queue_lock, portMAX_DELAY);
+        const esp_websocket_txq_msg_t *head = esp_websocket_txq_peek(client->tx_queue, &lane);
+        if (head) {
+            msg = *head;    // payload stays valid until the pop below
+        }
+        xSemaphoreGive(client->tx_queue_lock);
+        if (head == NULL) {
+            return false;
+        }
+
+        bool sent = esp_websocket_client_send_segments(client, msg.opcode, (const esp_websocket_iov_t *)msg.segs,
+                    msg.seg_count, msg.len, client->config->network_timeout_ms / portTICK_PERIOD_MS) >= 0;
+        if (!sent && client->state != WEBSOCKET_STATE_CONNECTED) {
+            return false;   // the connection was aborted and the queue flushed, this message included
+        }
+        xSemaphoreTake(client->tx_queue_lock, portMAX_DELAY);
+        esp_websocket_txq_pop(client->tx_queue, lane, sent, &msg);
+        xSemaphoreGive(client->tx_queue_lock);
+        if (msg.done) {
+            msg.done(msg.arg, sent);
+        }
+    }
+    xSemaphoreTake(client->tx_queue_lock, portMAX_DELAY);
+    bool pending = esp_websocket_txq_pending(client->tx_queue) > 0;
+    xSemaphoreGive(client->tx_queue_lock);
+    return pending;
+}
+
 esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_client_config_t *config)
 {
     esp_websocket_client_handle_t client = calloc(1, sizeof(struct esp_websocket_client));
     ESP_WS_CLIENT_MEM_CHECK(TAG, client, return NULL);
+    client->wakeup_fd = -1;
+    client->ping_rtt_ms = -1;
 
     esp_event_loop_args_t event_args = {
         .queue_size = WEBSOCKET_EVENT_QUEUE_SIZE,
@@ -687,6 +1364,47 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
     client->lock = xSemaphoreCreateRecursiveMutex();
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->lock, goto _websocket_init_fail);
 
+    client->wakeup_fd = esp_websocket_wakeup_open();
+    if (client->wakeup_fd < 0) {
+        ESP_LOGW(TAG, "No eventfd for the websocket task (errno=%d), falling back to polling", errno);
+    }
+
+    if (config->tx_queue_control_size || config->tx_queue_bulk_size || config->tx_queue_depth > 0) {
+        const size_t ring_size[ESP_WEBSOCKET_TXQ_LANES] = { config->tx_queue_control_size, config->tx_queue_bulk_size };
+        int depth = config->tx_queue_depth > 0 ? config->tx_queue_depth : WEBSOCKET_TX_QUEUE_DEPTH;
+        client->tx_queue_lock = xSemaphoreCreateMutex();
+        ESP_WS_CLIENT_MEM_CHECK(TAG, client->tx_queue_lock, goto _websocket_init_fail);
+        client->tx_queue = calloc(1, sizeof(esp_websocket_txq_t));
+        ESP_WS_CLIENT_MEM_CHECK(TAG, client->tx_queue, goto _websocket_init_fail);
+        if (esp_websocket_txq_init(client->tx_queue, ring_size, depth > UINT16_MAX ? UINT16_MAX : depth) != 0) {
+            free(client->tx_queue);
+            client->tx_queue = NULL;
+            ESP_LOGE(TAG, "Failed to allocate the outbound queue");
+            goto _websocket_init_fail;
+        }
+    }
+
+    if (config->rx_message_max > 0) {
+        client->rx_msg = calloc(1, sizeof(esp_websocket_rxmsg_t));
+        ESP_WS_CLIENT_MEM_CHECK(TAG, client->rx_msg, goto _websocket_init_fail);
+        if (esp_websocket_rxmsg_init(client->rx_msg, config->rx_message_max, config->rx_reassemble_binary) != 0) {
+            free(client->rx_msg);
+            client->rx_msg = NULL;
+            ESP_LOGE(TAG, "Failed to allocate the message reassembly buffer");
+            goto _websocket_init_fail;
+        }
+    }
+
+    if (config->tls_session_cache_size > 0 && config->ext_transport == NULL) {
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        client->tls_store = esp_websocket_tls_store_create(config->tls_session_cache_size,
+                            config->tls_session_lifetime_ms > 0 ? config->tls_session_lifetime_ms : 0);
+        ESP_WS_CLIENT_MEM_CHECK(TAG, client->tls_store, goto _websocket_init_fail);
+#else
+        ESP_LOGW(TAG, "tls_session_cache_size needs CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS, using full TLS handshakes");
+#endif
+    }
+
     client->config = calloc(1, sizeof(websocket_config_storage_t));
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->config, goto _websocket_init_fail);
 
@@ -764,6 +1482,8 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->tx_buffer, {
         goto _websocket_init_fail;
     });
+#elif defined(CONFIG_ESP_WS_CLIENT_BUFFER_POOL)
+    esp_websocket_client_init_pool(client, buffer_size);
 #endif
     client->status_bits = xEventGroupCreate();
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->status_bits, {
@@ -824,6 +1544,7 @@ esp_err_t esp_websocket_client_set_uri(esp_websocket_client_handle_t client, con
         free(client->config->host);
         asprintf(&client->config->host, "%.*s", puri.field_data[UF_HOST].len, uri + puri.field_data[UF_HOST].off);
         ESP_WS_CLIENT_MEM_CHECK(TAG, client->config->host, return ESP_ERR_NO_MEM);
+        client->dns_addr[0] = '\0';
     }
 
 
@@ -838,9 +1559,17 @@ esp_err_t esp_websocket_client_set_uri(esp_websocket_client_handle_t client, con
                      puri.field_data[UF_QUERY].len, uri + puri.field_data[UF_QUERY].off);
         }
         ESP_WS_CLIENT_MEM_CHECK(TAG, client->config->path, return ESP_ERR_NO_MEM);
+        if (client->transport && client->transport != client->config->ext_transport) {
+            // The running ws transport keeps its own copy of the path
+            esp_transport_ws_set_path(client->transport, client->config->path);
+        }
     }
     if (puri.field_data[UF_PORT].off) {
         client->config->port = strtol((const char *)(uri + puri.field_data[UF_PORT].off), NULL, 10);
+    } else {
+        // Without an explicit port use the scheme default, not the port of the previous URI
+        client->config->port = (client->config->scheme && strcasecmp(client->config->scheme, WS_OVER_TLS_SCHEME) == 0) ?
+                               WEBSOCKET_SSL_DEFAULT_PORT : WEBSOCKET_TCP_DEFAULT_PORT;
     }
 
     if (puri.field_data[UF_USERINFO].len) {
@@ -924,19 +1653,66 @@ esp_err_t esp_websocket_client_append_header(esp_websocket_client_handle_t clien
     return ESP_OK;
 }
 
+/**
+ * Reassembly mode: copy the chunk just read into the message arena and dispatch the
+ * message once complete, presented as a single final frame. Chunks that are not
+ * reassembled (control frames, streamed binary messages) are dispatched as usual.
+ */
+static void esp_websocket_client_dispatch_chunk(esp_websocket_client_handle_t client, int rlen)
+{
+    esp_websocket_rxmsg_t *m = client->rx_msg;
+    uint32_t dropped = m->dropped;
+    esp_websocket_rxmsg_result_t res = esp_websocket_rxmsg_feed(m, client->last_opcode, client->last_fin,
+                                       client->payload_offset, client->payload_len, client->rx_buffer, rlen);
+    switch (res) {
+    case ESP_WEBSOCKET_RXMSG_PASS:
+        esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_DATA, client->rx_buffer, rlen);
+        break;
+    case ESP_WEBSOCKET_RXMSG_COMPLETE: {
+        ws_transport_opcodes_t frame_opcode = client->last_opcode;
+        int frame_len = client->payload_len;
+        int frame_offset = client->payload_offset;
+        client->last_opcode = (ws_transport_opcodes_t)m->opcode;
+        client->payload_len = m->len;
+        client->payload_offset = 0;
+        esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_DATA, (const char *)m->buf, m->len);
+        client->last_opcode = frame_opcode;
+        client->payload_len = frame_len;
+        client->payload_offset = frame_offset;
+        break;
+    }
+    case ESP_WEBSOCKET_RXMSG_DROPPED:
+        if (m->dropped != dropped) {
+            ESP_LOGW(TAG, "Dropping incoming message larger than %u bytes", (unsigned)m->max);
+        } else if (client->payload_offset == 0 && client->last_opcode == WS_TRANSPORT_OPCODES_CONT && !m->overflow) {
+            ESP_LOGW(TAG, "Dropping continuation frame without a message in progress");
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 static esp_err_t esp_websocket_client_recv(esp_websocket_client_handle_t client)
 {
     int rlen;
     client->payload_offset = 0;
+    client->sink_frame = false;
     if (esp_websocket_new_buf(client, false) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to setup rx buffer");
         return ESP_FAIL;
     }
     do {
-        rlen = esp_transport_read(client->transport, client->rx_buffer, client->buffer_size, client->config->network_timeout_ms);
+        // The first read of a frame also parses its header, so only later reads can go to the sink buffers
+        char *buf = client->rx_buffer;
+        int size = client->buffer_size;
+        if (client->sink_frame) {
+            buf = esp_websocket_sink_buffer(&client->sink_state, client->rx_buffer, client->buffer_size, &size);
+        }
+        rlen = esp_transport_read(client->transport, buf, size, client->config->network_timeout_ms);
         if (rlen < 0) {
             esp_websocket_free_buf(client, false);
-            esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(client->transport);
+            esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(esp_websocket_client_error_transport(client));
             if (error_handle) {
                 esp_websocket_client_error(client, "esp_transport_read() failed with %d, transport_error=%s, tls_error_code=%i, tls_flags=%i, errno=%d",
                                            rlen, esp_err_to_name(error_handle->last_error), error_handle->esp_tls_error_code,
@@ -956,7 +1732,29 @@ static esp_err_t esp_websocket_client_recv(esp_websocket_client_handle_t client)
             return ESP_OK;
         }
 
-        esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_DATA, client->rx_buffer, rlen);
+        if (client->payload_offset == 0) {
+            bool interrupted;
+            client->sink_frame = esp_websocket_sink_frame(&client->sink_state, &client->sink, client->last_opcode,
+                                 &interrupted);
+            if (interrupted) {
+                ESP_LOGW(TAG, "Binary message interrupted by a new one");
+            }
+            if (client->last_opcode == WS_TRANSPORT_OPCODES_PONG && client->wait_for_pong_resp) {
+                // Measured before WEBSOCKET_EVENT_DATA so that its receiver can read the new value
+                client->ping_rtt_ms = (int)(_tick_get_ms() - client->pingpong_tick_ms);
+            }
+        }
+        if (client->sink_frame) {
+            bool last = client->last_fin && client->payload_offset + rlen >= client->payload_len;
+            if (!esp_websocket_sink_data(&client->sink_state, buf, rlen, buf == client->rx_buffer, last)) {
+                ESP_LOGW(TAG, "Binary sink failed before offset %u, dropping the rest of the message",
+                         (unsigned)client->sink_state.offset);
+            }
+        } else if (client->rx_msg) {
+            esp_websocket_client_dispatch_chunk(client, rlen);
+        } else {
+            esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_DATA, client->rx_buffer, rlen);
+        }
 
         client->payload_offset += rlen;
     } while (client->payload_offset < client->payload_len);
@@ -979,6 +1777,61 @@ static esp_err_t esp_websocket_client_recv(esp_websocket_client_handle_t client)
 
 static int esp_websocket_client_send_close(esp_websocket_client_handle_t client, int code, const char *additional_data, int total_len, TickType_t timeout);
 
+/* Milliseconds until `since + interval` has passed (the task checks deadlines with `>`) */
+static int esp_websocket_client_ms_until(uint64_t since, uint64_t interval)
+{
+    uint64_t deadline = since + interval + 1;
+    uint64_t now = _tick_get_ms();
+    if (deadline <= now) {
+        return 0;
+    }
+    return deadline - now > INT32_MAX ? INT32_MAX : (int)(deadline - now);
+}
+
+/**
+ * Wait in the CONNECTED state for incoming data, a wakeup (queued message, stop, close)
+ * or the next ping/pong deadline. Returns >0 if the transport is readable, 0 otherwise,
+ * <0 on a transport error.
+ */
+static int esp_websocket_client_poll(esp_websocket_client_handle_t client, bool tx_pending)
+{
+    if (tx_pending) {
+        return esp_transport_poll_read(client->transport, 0);
+    }
+
+    int timeout_ms = WEBSOCKET_POLL_MAX_MS;
+    if ((CLOSE_FRAME_SENT_BIT & xEventGroupGetBits(client->status_bits)) == 0) {
+        int ping_ms = esp_websocket_client_ms_until(client->ping_tick_ms, client->config->ping_interval_sec * 1000ULL);
+        timeout_ms = ping_ms < timeout_ms ? ping_ms : timeout_ms;
+        if (client->wait_for_pong_resp) {
+            int pong_ms = esp_websocket_client_ms_until(client->pingpong_tick_ms, client->config->pingpong_timeout_sec * 1000ULL);
+            timeout_ms = pong_ms < timeout_ms ? pong_ms : timeout_ms;
+        }
+    }
+
+    int sockfd = esp_transport_get_socket(client->transport);
+    if (sockfd < 0 && client->dns_transport) {
+        sockfd = esp_transport_get_socket(client->parent_transport);
+    }
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    if (sockfd < 0 && client->tls_transport) {
+        sockfd = esp_websocket_tls_get_socket(client->tls_transport);
+    }
+#endif
+    if (client->wakeup_fd < 0 || sockfd < 0) {
+        // Without the wakeup event, poll in slices so that queued messages are picked up
+        int slice_ms = client->tx_queue ? CONFIG_ESP_WS_CLIENT_TX_QUEUE_POLL_MS : 1000;
+        return esp_transport_poll_read(client->transport, timeout_ms < slice_ms ? timeout_ms : slice_ms);
+    }
+
+    // TLS may already hold decrypted bytes that select() cannot see
+    int ret = esp_transport_poll_read(client->transport, 0);
+    if (ret != 0) {
+        return ret;
+    }
+    return esp_websocket_wakeup_wait(client->wakeup_fd, sockfd, timeout_ms);
+}
+
 static void esp_websocket_client_task(void *pv)
 {
     const int lock_timeout = portMAX_DELAY;
@@ -1000,9 +1853,12 @@ static void esp_websocket_client_task(void *pv)
     }
 
     client->state = WEBSOCKET_STATE_INIT;
+    client->close_by_server = false;
+    client->reconnect_requested = false;
     xEventGroupClearBits(client->status_bits, STOPPED_BIT | CLOSE_FRAME_SENT_BIT);
     esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_BEGIN, NULL, 0);
     int read_select = 0;
+    bool tx_pending = false;
     while (client->run) {
         if (xSemaphoreTakeRecursive(client->lock, lock_timeout) != pdPASS) {
             ESP_LOGE(TAG, "Failed to lock ws-client tasks, exiting the task...");
@@ -1021,7 +1877,7 @@ static void esp_websocket_client_task(void *pv)
                                                client->config->port,
                                                client->config->network_timeout_ms);
             if (result < 0) {
-                esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(client->transport);
+                esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(esp_websocket_client_error_transport(client));
                 client->error_handle.esp_ws_handshake_status_code  = esp_transport_ws_get_upgrade_request_status(client->transport);
                 if (error_handle) {
                     esp_websocket_client_error(client, "esp_transport_connect() failed with %d, "
@@ -1039,10 +1895,20 @@ static void esp_websocket_client_task(void *pv)
 
             client->state = WEBSOCKET_STATE_CONNECTED;
             client->wait_for_pong_resp = false;
+            client->ping_rtt_ms = -1;
+            if (client->rx_msg) {
+                esp_websocket_rxmsg_reset(client->rx_msg);
+            }
+            esp_websocket_sink_reset(&client->sink_state);
             client->error_handle.error_type = WEBSOCKET_ERROR_TYPE_NONE;
             esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_CONNECTED, NULL, 0);
             break;
         case WEBSOCKET_STATE_CONNECTED:
+            if (client->reconnect_requested) {
+                // Requested by esp_websocket_client_reconnect(): DISCONNECTED is dispatched from this task
+                esp_websocket_client_abort_connection(client, WEBSOCKET_ERROR_TYPE_NONE);
+                break;
+            }
             if ((CLOSE_FRAME_SENT_BIT & xEventGroupGetBits(client->status_bits)) == 0) { // only send and check for PING
                 // if closing hasn't been initiated
                 if (_tick_get_ms() - client->ping_tick_ms > client->config->ping_interval_sec * 1000) {
@@ -1066,6 +1932,11 @@ static void esp_websocket_client_task(void *pv)
             }
 
 
+            tx_pending = esp_websocket_client_drain_tx_queue(client);
+            if (client->state != WEBSOCKET_STATE_CONNECTED) {
+                break;
+            }
+
             if (read_select == 0) {
                 ESP_LOGV(TAG, "Read poll timeout: skipping esp_transport_read()...");
                 break;
@@ -1092,6 +1963,7 @@ static void esp_websocket_client_task(void *pv)
                 ESP_LOGD(TAG, "Closing initiated by the server, sending close frame");
                 esp_transport_ws_send_raw(client->transport, WS_TRANSPORT_OPCODES_CLOSE | WS_TRANSPORT_OPCODES_FIN, NULL, 0, client->config->network_timeout_ms);
                 xEventGroupSetBits(client->status_bits, CLOSE_FRAME_SENT_BIT);
+                client->close_by_server = true;
             }
             break;
         default:
@@ -1099,10 +1971,14 @@ static void esp_websocket_client_task(void *pv)
             break;
         }
         xSemaphoreGiveRecursive(client->lock);
+        if (!client->run) {
+            break;
+        }
+        esp_websocket_client_trim_buffers(client);
         if (WEBSOCKET_STATE_CONNECTED == client->state) {
-            read_select = esp_transport_poll_read(client->transport, 1000); //Poll every 1000ms
+            read_select = esp_websocket_client_poll(client, tx_pending);
             if (read_select < 0) {
-                esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(client->transport);
+                esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(esp_websocket_client_error_transport(client));
                 if (error_handle) {
                     esp_websocket_client_error(client, "esp_transport_poll_read() returned %d, transport_error=%s, tls_error_code=%i, tls_flags=%i, errno=%d",
                                                read_select, esp_err_to_name(error_handle->last_error), error_handle->esp_tls_error_code,
@@ -1116,7 +1992,12 @@ static void esp_websocket_client_task(void *pv)
             }
         } else if (WEBSOCKET_STATE_WAIT_TIMEOUT == client->state) {
             // waiting for reconnecting...
-            vTaskDelay(client->wait_timeout_ms / 2 / portTICK_PERIOD_MS);
+            if (client->wakeup_fd >= 0) {
+                esp_websocket_wakeup_wait(client->wakeup_fd, -1,
+                                          esp_websocket_client_ms_until(client->reconnect_tick_ms, client->wait_timeout_ms));
+            } else {
+                vTaskDelay(client->wait_timeout_ms / 2 / portTICK_PERIOD_MS);
+            }
         } else if (WEBSOCKET_STATE_CLOSING == client->state &&
                    (CLOSE_FRAME_SENT_BIT & xEventGroupGetBits(client->status_bits))) {
             ESP_LOGD(TAG, " Waiting for TCP connection to be closed by the server");
@@ -1127,6 +2008,16 @@ static void esp_websocket_client_task(void *pv)
             } else if (ret < 0) {
                 ESP_LOGW(TAG, "Connection terminated while waiting for clean TCP close");
             }
+            if (client->close_by_server && client->config->auto_reconnect) {
+                // The server went away (e.g. restarting): reconnect as after any other disconnect
+                esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_CLOSED, NULL, 0);
+                xSemaphoreTakeRecursive(client->lock, lock_timeout);
+                client->close_by_server = false;
+                xEventGroupClearBits(client->status_bits, CLOSE_FRAME_SENT_BIT);
+                esp_websocket_client_abort_connection(client, WEBSOCKET_ERROR_TYPE_NONE);
+                xSemaphoreGiveRecursive(client->lock);
+                continue;
+            }
             client->run = false;
             client->state = WEBSOCKET_STATE_UNKNOW;
             esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_CLOSED, NULL, 0);
@@ -1134,10 +2025,11 @@ static void esp_websocket_client_task(void *pv)
         }
     }
 
+    client->state = WEBSOCKET_STATE_UNKNOW;
+    esp_websocket_client_flush_tx_queue(client);
     esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_FINISH, NULL, 0);
     esp_transport_close(client->transport);
     xEventGroupSetBits(client->status_bits, STOPPED_BIT);
-    client->state = WEBSOCKET_STATE_UNKNOW;
     if (client->selected_for_destroying == true) {
         destroy_and_free_resources(client);
     }
@@ -1229,6 +2121,7 @@ static esp_err_t esp_websocket_client_close_with_optional_body(esp_websocket_cli
 
     // Set closing bit to prevent from sending PING frames while connected
     xEventGroupSetBits(client->status_bits, CLOSE_FRAME_SENT_BIT);
+    esp_websocket_wakeup_signal(client->wakeup_fd);
 
     if (STOPPED_BIT & xEventGroupWaitBits(client->status_bits, STOPPED_BIT, false, true, timeout)) {
         return ESP_OK;
@@ -1236,6 +2129,7 @@ static esp_err_t esp_websocket_client_close_with_optional_body(esp_websocket_cli
 
     // If could not close gracefully within timeout, stop the client and disconnect
     client->run = false;
+    esp_websocket_wakeup_signal(client->wakeup_fd);
     xEventGroupWaitBits(client->status_bits, STOPPED_BIT, false, true, portMAX_DELAY);
     client->state = WEBSOCKET_STATE_UNKNOW;
     return ESP_OK;
@@ -1309,6 +2203,14 @@ size_t esp_websocket_client_get_ping_interval_sec(esp_websocket_client_handle_t
     return client->config->ping_interval_sec;
 }
 
+int esp_websocket_client_get_ping_rtt_ms(esp_websocket_client_handle_t client)
+{
+    if (client == NULL) {
+        return -1;
+    }
+    return client->ping_rtt_ms;
+}
+
 esp_err_t esp_websocket_client_set_ping_interval_sec(esp_websocket_client_handle_t client, size_t ping_interval_sec)
 {
     if (client == NULL) {
@@ -1341,6 +2243,19 @@ int esp_websocket_client_get_reconnect_timeout(esp_websocket_client_handle_t cli
     return client->wait_timeout_ms;
 }
 
+esp_err_t esp_websocket_client_reconnect(esp_websocket_client_handle_t client)
+{
+    if (client == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!client->run || !client->config->auto_reconnect) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    client->reconnect_requested = true;
+    esp_websocket_wakeup_signal(client->wakeup_fd);
+    return ESP_OK;
+}
+
 esp_err_t esp_websocket_client_set_reconnect_timeout(esp_websocket_client_handle_t client, int reconnect_timeout_ms)
 {
     if (client == NULL) {
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_websocket_frame.h"
+
+#define WS_MASK_BIT     (0x80)
+
+size_t esp_websocket_frame_header(uint8_t *hdr, uint8_t opcode, uint64_t len, const uint8_t mask[4])
+{
+    size_t n = 0;
+    uint8_t mask_bit = mask ? WS_MASK_BIT : 0;
+
+    hdr[n++] = opcode;
+    if (len <= 125) {
+        hdr[n++] = (uint8_t)len | mask_bit;
+    } else if (len <= 0xFFFF) {
+        hdr[n++] = 126 | mask_bit;
+        hdr[n++] = (uint8_t)(len >> 8);
+        hdr[n++] = (uint8_t)len;
+    } else {
+        hdr[n++] = 127 | mask_bit;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            hdr[n++] = (uint8_t)(len >> shift);
+        }
+    }
+    if (mask) {
+        memcpy(&hdr[n], mask, 4);
+        n += 4;
+    }
+    return n;
+}
+
+void esp_websocket_mask_copy(uint8_t *dst, const uint8_t *src, size_t len, const uint8_t mask[4], size_t phase)
+{
+    size_t k = phase & 3;
+
+    // Leading bytes until the destination is word aligned
+    while (len > 0 && ((uintptr_t)dst & 3) != 0) {
+        *dst++ = *src++ ^ mask[k];
+        k = (k + 1) & 3;
+        len--;
+    }
+
+    // Key rotated to the current phase; byte order in memory matches the stream
+    uint8_t key[4] = { mask[k], mask[(k + 1) & 3], mask[(k + 2) & 3], mask[(k + 3) & 3] };
+    uint32_t m;
+    memcpy(&m, key, 4);
+
+    while (len >= 16) {
+        uint32_t w[4];
+        memcpy(w, src, 16);
+        w[0] ^= m;
+        w[1] ^= m;
+        w[2] ^= m;
+        w[3] ^= m;
+        memcpy(dst, w, 16);
+        src += 16;
+        dst += 16;
+        len -= 16;
+    }
+    while (len >= 4) {
+        uint32_t w;
+        memcpy(&w, src, 4);
+        w ^= m;
+        memcpy(dst, &w, 4);
+        src += 4;
+        dst += 4;
+        len -= 4;
+    }
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src[i] ^ key[i];
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_websocket_rxmsg.h"
+
+#define RXMSG_OPCODE_CONT   (0x00)
+#define RXMSG_OPCODE_TEXT   (0x01)
+#define RXMSG_OPCODE_BINARY (0x02)
+
+int esp_websocket_rxmsg_init(esp_websocket_rxmsg_t *m, size_t max, bool binary)
+{
+    memset(m, 0, sizeof(*m));
+    m->buf = malloc(max + 1);
+    if (m->buf == NULL) {
+        return -1;
+    }
+    m->max = max;
+    m->binary = binary;
+    return 0;
+}
+
+void esp_websocket_rxmsg_deinit(esp_websocket_rxmsg_t *m)
+{
+    free(m->buf);
+    m->buf = NULL;
+}
+
+void esp_websocket_rxmsg_reset(esp_websocket_rxmsg_t *m)
+{
+    m->active = false;
+    m->passing = false;
+    m->overflow = false;
+    m->len = 0;
+}
+
+esp_websocket_rxmsg_result_t esp_websocket_rxmsg_feed(esp_websocket_rxmsg_t *m, uint8_t opcode, bool fin,
+        size_t frame_offset, size_t frame_len, const void *data, size_t len)
+{
+    bool last_chunk = frame_offset + len >= frame_len;
+
+    if (opcode == RXMSG_OPCODE_TEXT || opcode == RXMSG_OPCODE_BINARY) {
+        if (frame_offset == 0) {
+            // First frame of a new message; an unfinished previous one can no longer complete
+            if (m->active && !m->overflow) {
+                m->dropped++;
+            }
+            esp_websocket_rxmsg_reset(m);
+            if (opcode == RXMSG_OPCODE_BINARY && !m->binary) {
+                m->passing = !fin;
+                return ESP_WEBSOCKET_RXMSG_PASS;
+            }
+            m->active = true;
+            m->opcode = opcode;
+        } else if (!m->active) {
+            return ESP_WEBSOCKET_RXMSG_PASS;
+        }
+    } else if (opcode == RXMSG_OPCODE_CONT) {
+        if (m->passing) {
+            if (fin && last_chunk) {
+                m->passing = false;
+            }
+            return ESP_WEBSOCKET_RXMSG_PASS;
+        }
+        if (!m->active) {
+            return ESP_WEBSOCKET_RXMSG_DROPPED;
+        }
+    } else {
+        // Control frames may arrive between the fragments of a message
+        return ESP_WEBSOCKET_RXMSG_PASS;
+    }
+
+    if (!m->overflow) {
+        if (len > m->max - m->len) {
+            m->overflow = true;
+            m->dropped++;
+        } else {
+            memcpy(m->buf + m->len, data, len);
+            m->len += len;
+        }
+    }
+    if (!(fin && last_chunk)) {
+        return m->overflow ? ESP_WEBSOCKET_RXMSG_DROPPED : ESP_WEBSOCKET_RXMSG_PENDING;
+    }
+
+    m->active = false;
+    if (m->overflow) {
+        m->overflow = false;
+        m->len = 0;
+        return ESP_WEBSOCKET_RXMSG_DROPPED;
+    }
+    m->buf[m->len] = 0;
+    m->delivered++;
+    return ESP_WEBSOCKET_RXMSG_COMPLETE;
+}
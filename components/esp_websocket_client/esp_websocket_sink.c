@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_websocket_sink.h"
+
+#define SINK_OPCODE_CONT    (0x00)
+#define SINK_OPCODE_BINARY  (0x02)
+
+void esp_websocket_sink_reset(esp_websocket_sink_t *s)
+{
+    s->active = false;
+}
+
+bool esp_websocket_sink_frame(esp_websocket_sink_t *s, const esp_websocket_sink_cb_t *cb, uint8_t opcode,
+                              bool *interrupted)
+{
+    *interrupted = false;
+    if (opcode == SINK_OPCODE_BINARY) {
+        *interrupted = s->active;
+        s->active = cb->on_data != NULL;
+        s->msg = *cb;
+        s->offset = 0;
+        s->discard = false;
+        return s->active;
+    }
+    return opcode == SINK_OPCODE_CONT && s->active;
+}
+
+char *esp_websocket_sink_buffer(esp_websocket_sink_t *s, char *rx_buffer, int rx_size, int *size)
+{
+    size_t avail = 0;
+    char *buf = NULL;
+    if (!s->discard && s->msg.get_buffer) {
+        buf = s->msg.get_buffer(s->msg.ctx, s->offset, &avail);
+    }
+    if (buf == NULL || avail == 0) {
+        *size = rx_size;
+        return rx_buffer;
+    }
+    *size = avail > INT32_MAX ? INT32_MAX : (int)avail;
+    return buf;
+}
+
+bool esp_websocket_sink_data(esp_websocket_sink_t *s, const char *data, int len, bool in_rx, bool last)
+{
+    bool ok = true;
+    bool copy = in_rx && s->msg.get_buffer;
+    do {
+        const char *piece = data;
+        size_t n = len;
+        if (copy && !s->discard) {
+            size_t avail = 0;
+            char *buf = s->msg.get_buffer(s->msg.ctx, s->offset, &avail);
+            if (buf && avail > 0) {
+                n = avail < n ? avail : n;
+                memcpy(buf, data, n);
+                piece = buf;
+            }
+        }
+        bool final = last && n == (size_t)len;
+        if (!s->discard && s->msg.on_data(s->msg.ctx, (const uint8_t *)piece, n, s->offset, final) != 0) {
+            s->discard = true;
+            ok = false;
+        }
+        s->offset += n;
+        data += n;
+        len -= n;
+    } while (len > 0);
+    if (last) {
+        s->active = false;
+    }
+    return ok;
+}
@@ -0,0 +1,326 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include "sdkconfig.h"
+#include "esp_websocket_tls.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+
+static const char *TAG = "websocket_tls";
+
+typedef struct {
+    esp_tls_cfg_t cfg;
+    esp_websocket_tls_store_t *store;
+    esp_tls_t *tls;
+    int sockfd;
+    char host[ESP_WEBSOCKET_TLS_CACHE_HOST_MAX];   /*!< Server of the current connection, for the session taken at close */
+    uint16_t port;
+    esp_websocket_tls_resolver_t resolver;
+} esp_websocket_tls_t;
+
+// Statistics are read by other tasks, everything else is only used by the client task
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t tls_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void tls_free_session(void *session)
+{
+    esp_tls_free_client_session((esp_tls_client_session_t *)session);
+}
+
+static void tls_store_session(esp_websocket_tls_t *ctx)
+{
+    esp_tls_client_session_t *session = esp_tls_get_client_session(ctx->tls);
+    if (session) {
+        esp_websocket_tls_cache_put(&ctx->store->cache, ctx->host, ctx->port, session, tls_now_ms());
+    }
+}
+
+static void tls_update_stats(esp_websocket_tls_store_t *store, bool ok, bool offered, uint32_t ms)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    esp_websocket_tls_stats_t *s = &store->stats;
+    if (!ok) {
+        s->failed++;
+    } else if (offered) {
+        s->session_handshakes++;
+        s->session_ms_total += ms;
+    } else {
+        s->full_handshakes++;
+        s->full_ms_total += ms;
+    }
+    if (ok) {
+        s->last_handshake_ms = ms;
+        s->last_session_offered = offered;
+    }
+    s->sessions_cached = esp_websocket_tls_cache_count(&store->cache);
+    s->sessions_expired = store->cache.expired;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+static bool tls_failed_before_handshake(esp_tls_t *tls)
+{
+    esp_tls_error_handle_t error_handle;
+    if (esp_tls_get_error_handle(tls, &error_handle) != ESP_OK || error_handle == NULL) {
+        return false;
+    }
+    switch (error_handle->last_error) {
+    case ESP_ERR_ESP_TLS_CANNOT_RESOLVE_HOSTNAME:
+    case ESP_ERR_ESP_TLS_CANNOT_CREATE_SOCKET:
+    case ESP_ERR_ESP_TLS_FAILED_CONNECT_TO_HOST:
+    case ESP_ERR_ESP_TLS_CONNECTION_TIMEOUT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* The client reads the transport's error handle for its logs and WEBSOCKET_EVENT_ERROR */
+static void tls_capture_error(esp_transport_handle_t t, esp_tls_t *tls)
+{
+    esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(t);
+    esp_tls_error_handle_t tls_error;
+    if (error_handle && tls && esp_tls_get_error_handle(tls, &tls_error) == ESP_OK && tls_error) {
+        *error_handle = *tls_error;
+    }
+}
+
+static int tls_close(esp_transport_handle_t t)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    if (ctx->tls == NULL) {
+        return 0;
+    }
+    if (ctx->sockfd >= 0) {
+        // With TLS 1.3 the ticket arrives after the handshake, and servers may renew it
+        tls_store_session(ctx);
+    }
+    int ret = esp_tls_conn_destroy(ctx->tls);
+    ctx->tls = NULL;
+    ctx->sockfd = -1;
+    return ret;
+}
+
+static int tls_connect(esp_transport_handle_t t, const char *host, int port, int timeout_ms)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    tls_close(t);
+    ctx->tls = esp_tls_init();
+    if (ctx->tls == NULL) {
+        return -1;
+    }
+    if (strlen(host) < sizeof(ctx->host)) {
+        strcpy(ctx->host, host);
+    } else {
+        ctx->host[0] = '\0';    // Not cached, see esp_websocket_tls_cache_put()
+    }
+    ctx->port = port;
+
+    esp_tls_cfg_t cfg = ctx->cfg;
+    cfg.timeout_ms = timeout_ms;
+    cfg.client_session = esp_websocket_tls_cache_get(&ctx->store->cache, host, port, tls_now_ms());
+    bool offered = cfg.client_session != NULL;
+    // Sessions stay keyed by the host name; SNI and the certificate check use it as the common name
+    const char *addr = ctx->resolver.resolve ? ctx->resolver.resolve(ctx->resolver.arg, host) : host;
+    if (addr != host && cfg.common_name == NULL) {
+        cfg.common_name = host;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int ret = esp_tls_conn_new_sync(addr, strlen(addr), port, &cfg, ctx->tls);
+    uint32_t handshake_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    if (ret <= 0) {
+        if (addr != host && ctx->resolver.connect_failed) {
+            ctx->resolver.connect_failed(ctx->resolver.arg, addr);
+        }
+        if (offered && !tls_failed_before_handshake(ctx->tls)) {
+            // The server may have failed on the session: the next attempt does a full handshake
+            esp_websocket_tls_cache_drop(&ctx->store->cache, host, port);
+        }
+        ESP_LOGE(TAG, "Failed to open a new connection to %s:%d%s", host, port, offered ? " (session offered)" : "");
+        tls_capture_error(t, ctx->tls);
+        esp_tls_conn_destroy(ctx->tls);
+        ctx->tls = NULL;
+        tls_update_stats(ctx->store, false, offered, handshake_ms);
+        return -1;
+    }
+    esp_tls_get_conn_sockfd(ctx->tls, &ctx->sockfd);
+    tls_store_session(ctx);
+    tls_update_stats(ctx->store, true, offered, handshake_ms);
+    ESP_LOGD(TAG, "Connected to %s:%d in %"PRIu32" ms, %s", host, port, handshake_ms,
+             offered ? "session offered" : "full handshake");
+    return 0;
+}
+
+static int tls_poll(esp_websocket_tls_t *ctx, bool write, int timeout_ms)
+{
+    if (ctx->sockfd < 0) {
+        return -1;
+    }
+    fd_set fds;
+    fd_set errset;
+    FD_ZERO(&fds);
+    FD_ZERO(&errset);
+    FD_SET(ctx->sockfd, &fds);
+    FD_SET(ctx->sockfd, &errset);
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    int ret = select(ctx->sockfd + 1, write ? NULL : &fds, write ? &fds : NULL, &errset,
+                     timeout_ms < 0 ? NULL : &timeout);
+    if (ret > 0 && FD_ISSET(ctx->sockfd, &errset)) {
+        int sock_errno = 0;
+        uint32_t optlen = sizeof(sock_errno);
+        getsockopt(ctx->sockfd, SOL_SOCKET, SO_ERROR, &sock_errno, &optlen);
+        ESP_LOGE(TAG, "poll error on fd %d: %s", ctx->sockfd, strerror(sock_errno));
+        return -1;
+    }
+    return ret;
+}
+
+static int tls_poll_read(esp_transport_handle_t t, int timeout_ms)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    if (ctx->tls && esp_tls_get_bytes_avail(ctx->tls) > 0) {
+        // Already decrypted: the socket may have nothing more to read
+        return 1;
+    }
+    return tls_poll(ctx, false, timeout_ms);
+}
+
+static int tls_poll_write(esp_transport_handle_t t, int timeout_ms)
+{
+    return tls_poll(esp_transport_get_context_data(t), true, timeout_ms);
+}
+
+static int tls_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    int poll = tls_poll_read(t, timeout_ms);
+    if (poll == -1) {
+        return ERR_TCP_TRANSPORT_CONNECTION_FAILED;
+    }
+    if (poll == 0) {
+        return ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT;
+    }
+    ssize_t ret = esp_tls_conn_read(ctx->tls, buffer, len);
+    if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_TIMEOUT) {
+        return ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT;
+    }
+    if (ret < 0) {
+        ESP_LOGE(TAG, "esp_tls_conn_read error, errno=%s", strerror(errno));
+        tls_capture_error(t, ctx->tls);
+        return ERR_TCP_TRANSPORT_CONNECTION_FAILED;
+    }
+    if (ret == 0) {
+        return ERR_TCP_TRANSPORT_CONNECTION_CLOSED_BY_FIN;
+    }
+    return ret;
+}
+
+static int tls_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    int poll = tls_poll_write(t, timeout_ms);
+    if (poll <= 0) {
+        ESP_LOGW(TAG, "Poll timeout or error, errno=%s, fd=%d, timeout_ms=%d", strerror(errno), ctx->sockfd, timeout_ms);
+        return poll;
+    }
+    ssize_t ret = esp_tls_conn_write(ctx->tls, buffer, len);
+    if (ret < 0) {
+        ESP_LOGE(TAG, "esp_tls_conn_write error, errno=%s", strerror(errno));
+        tls_capture_error(t, ctx->tls);
+    }
+    return ret;
+}
+
+static int tls_destroy(esp_transport_handle_t t)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    tls_close(t);
+    free(ctx);
+    return 0;
+}
+
+esp_websocket_tls_store_t *esp_websocket_tls_store_create(int size, uint32_t lifetime_ms)
+{
+    esp_websocket_tls_store_t *store = calloc(1, sizeof(esp_websocket_tls_store_t));
+    if (store == NULL) {
+        return NULL;
+    }
+    if (esp_websocket_tls_cache_init(&store->cache, size, lifetime_ms, tls_free_session) != 0) {
+        free(store);
+        return NULL;
+    }
+    store->stats.last_handshake_ms = -1;
+    return store;
+}
+
+void esp_websocket_tls_store_destroy(esp_websocket_tls_store_t *store)
+{
+    if (store == NULL) {
+        return;
+    }
+    esp_websocket_tls_cache_deinit(&store->cache);
+    free(store);
+}
+
+void esp_websocket_tls_store_get_stats(esp_websocket_tls_store_t *store, esp_websocket_tls_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = store->stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+esp_transport_handle_t esp_websocket_tls_init(const esp_tls_cfg_t *cfg, esp_websocket_tls_store_t *store)
+{
+    esp_transport_handle_t t = esp_transport_init();
+    if (t == NULL) {
+        return NULL;
+    }
+    esp_websocket_tls_t *ctx = calloc(1, sizeof(esp_websocket_tls_t));
+    if (ctx == NULL) {
+        esp_transport_destroy(t);
+        return NULL;
+    }
+    ctx->cfg = *cfg;
+    ctx->store = store;
+    ctx->sockfd = -1;
+    esp_transport_set_context_data(t, ctx);
+    esp_transport_set_func(t, tls_connect, tls_read, tls_write, tls_close, tls_poll_read, tls_poll_write, tls_destroy);
+    return t;
+}
+
+void esp_websocket_tls_set_resolver(esp_transport_handle_t t, const esp_websocket_tls_resolver_t *resolver)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    if (resolver) {
+        ctx->resolver = *resolver;
+    } else {
+        memset(&ctx->resolver, 0, sizeof(ctx->resolver));
+    }
+}
+
+int esp_websocket_tls_get_socket(esp_transport_handle_t t)
+{
+    esp_websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    return ctx ? ctx->sockfd : -1;
+}
+
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_websocket_tls_cache.h"
+
+static esp_websocket_tls_cache_entry_t *tls_cache_find(esp_websocket_tls_cache_t *c, const char *host, uint16_t port)
+{
+    for (int i = 0; i < c->size; i++) {
+        esp_websocket_tls_cache_entry_t *e = &c->entries[i];
+        if (e->session && e->port == port && strcmp(e->host, host) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void tls_cache_release(esp_websocket_tls_cache_t *c, esp_websocket_tls_cache_entry_t *e)
+{
+    if (e->session) {
+        c->free_session(e->session);
+        e->session = NULL;
+    }
+}
+
+int esp_websocket_tls_cache_init(esp_websocket_tls_cache_t *c, int size, uint32_t lifetime_ms,
+                                 esp_websocket_tls_session_free_t free_session)
+{
+    memset(c, 0, sizeof(*c));
+    c->entries = calloc(size, sizeof(esp_websocket_tls_cache_entry_t));
+    if (c->entries == NULL) {
+        return -1;
+    }
+    c->size = size;
+    c->lifetime_ms = lifetime_ms;
+    c->free_session = free_session;
+    return 0;
+}
+
+void esp_websocket_tls_cache_deinit(esp_websocket_tls_cache_t *c)
+{
+    for (int i = 0; i < c->size; i++) {
+        tls_cache_release(c, &c->entries[i]);
+    }
+    free(c->entries);
+    c->entries = NULL;
+    c->size = 0;
+}
+
+void *esp_websocket_tls_cache_get(esp_websocket_tls_cache_t *c, const char *host, uint16_t port, uint32_t now_ms)
+{
+    esp_websocket_tls_cache_entry_t *e = tls_cache_find(c, host, port);
+    if (e == NULL) {
+        return NULL;
+    }
+    if (c->lifetime_ms && now_ms - e->stored_ms >= c->lifetime_ms) {
+        // The server would most likely refuse it: do a full handshake instead of sending a stale ticket
+        tls_cache_release(c, e);
+        c->expired++;
+        return NULL;
+    }
+    e->used_ms = now_ms;
+    return e->session;
+}
+
+void esp_websocket_tls_cache_put(esp_websocket_tls_cache_t *c, const char *host, uint16_t port, void *session,
+                                 uint32_t now_ms)
+{
+    if (session == NULL) {
+        return;
+    }
+    if (strlen(host) >= ESP_WEBSOCKET_TLS_CACHE_HOST_MAX || c->size == 0) {
+        c->free_session(session);
+        return;
+    }
+    esp_websocket_tls_cache_entry_t *e = tls_cache_find(c, host, port);
+    if (e == NULL) {
+        // A free slot, otherwise the least recently used one
+        e = &c->entries[0];
+        for (int i = 0; i < c->size && e->session; i++) {
+            esp_websocket_tls_cache_entry_t *candidate = &c->entries[i];
+            if (candidate->session == NULL || (int32_t)(candidate->used_ms - e->used_ms) < 0) {
+                e = candidate;
+            }
+        }
+        if (e->session) {
+            c->evicted++;
+        }
+        strcpy(e->host, host);
+        e->port = port;
+    }
+    tls_cache_release(c, e);
+    e->session = session;
+    e->stored_ms = now_ms;
+    e->used_ms = now_ms;
+    c->stored++;
+}
+
+void esp_websocket_tls_cache_drop(esp_websocket_tls_cache_t *c, const char *host, uint16_t port)
+{
+    esp_websocket_tls_cache_entry_t *e = tls_cache_find(c, host, port);
+    if (e) {
+        tls_cache_release(c, e);
+    }
+}
+
+int esp_websocket_tls_cache_count(const esp_websocket_tls_cache_t *c)
+{
+    int count = 0;
+    for (int i = 0; i < c->size; i++) {
+        count += c->entries[i].session != NULL;
+    }
+    return count;
+}
@@ -0,0 +1,175 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_websocket_txq.h"
+
+int esp_websocket_txq_init(esp_websocket_txq_t *q, const size_t ring_size[ESP_WEBSOCKET_TXQ_LANES], uint16_t depth)
+{
+    memset(q, 0, sizeof(*q));
+    for (int i = 0; i < ESP_WEBSOCKET_TXQ_LANES; i++) {
+        esp_websocket_txq_lane_t *l = &q->lanes[i];
+        l->msgs = calloc(depth, sizeof(esp_websocket_txq_msg_t));
+        l->ring = ring_size[i] ? malloc(ring_size[i]) : NULL;
+        if (l->msgs == NULL || (ring_size[i] && l->ring == NULL)) {
+            esp_websocket_txq_deinit(q);
+            return -1;
+        }
+        l->depth = depth;
+        l->ring_size = ring_size[i];
+        l->stats.depth = depth;
+        l->stats.ring_size = ring_size[i];
+    }
+    return 0;
+}
+
+void esp_websocket_txq_deinit(esp_websocket_txq_t *q)
+{
+    for (int i = 0; i < ESP_WEBSOCKET_TXQ_LANES; i++) {
+        free(q->lanes[i].msgs);
+        free(q->lanes[i].ring);
+    }
+    memset(q, 0, sizeof(*q));
+}
+
+/* Reserve len contiguous ring bytes; a tail too short for the payload is skipped and held with it */
+static uint8_t *ring_alloc(esp_websocket_txq_lane_t *l, size_t len, size_t *ring_len)
+{
+    size_t free_bytes = l->ring_size - l->ring_used;
+    size_t skip = 0;
+
+    if (len == 0) {
+        *ring_len = 0;
+        return l->ring;
+    }
+    if (l->ring_used == 0) {
+        l->ring_head = l->ring_tail = 0;
+    }
+    if (l->ring_tail >= l->ring_head) {
+        size_t at_end = l->ring_size - l->ring_tail;
+        if (len > at_end) {
+            if (len > l->ring_head) {
+                return NULL;
+            }
+            skip = at_end;
+        }
+    } else if (len > l->ring_head - l->ring_tail) {
+        return NULL;
+    }
+    if (skip + len > free_bytes) {
+        return NULL;
+    }
+
+    uint8_t *p = l->ring + (skip ? 0 : l->ring_tail);
+    l->ring_tail = ((skip ? 0 : l->ring_tail) + len) % l->ring_size;
+    l->ring_used += skip + len;
+    *ring_len = skip + len;
+    return p;
+}
+
+static void ring_free(esp_websocket_txq_lane_t *l, size_t ring_len)
+{
+    if (ring_len == 0) {
+        return;
+    }
+    l->ring_used -= ring_len;
+    l->ring_head = (l->ring_head + ring_len) % l->ring_size;
+    if (l->ring_used == 0) {
+        l->ring_head = l->ring_tail = 0;
+    }
+}
+
+int esp_websocket_txq_push(esp_websocket_txq_t *q, int lane, uint8_t opcode, const esp_websocket_txq_seg_t *segs,
+                           int seg_count, bool copy, esp_websocket_txq_done_cb_t done, void *arg)
+{
+    esp_websocket_txq_lane_t *l = &q->lanes[lane];
+    size_t len = 0;
+    for (int i = 0; i < seg_count; i++) {
+        len += segs[i].len;
+    }
+    if (l->count == l->depth || (!copy && seg_count > ESP_WEBSOCKET_TXQ_MAX_SEGS)) {
+        l->stats.rejected++;
+        return -1;
+    }
+
+    esp_websocket_txq_msg_t *m = &l->msgs[(l->head + l->count) % l->depth];
+    memset(m, 0, sizeof(*m));
+    if (copy) {
+        uint8_t *p = ring_alloc(l, len, &m->ring_len);
+        if (p == NULL) {
+            l->stats.rejected++;
+            return -1;
+        }
+        size_t off = 0;
+        for (int i = 0; i < seg_count; i++) {
+            memcpy(p + off, segs[i].data, segs[i].len);
+            off += segs[i].len;
+        }
+        m->segs[0].data = p;
+        m->segs[0].len = len;
+        m->seg_count = 1;
+    } else {
+        memcpy(m->segs, segs, seg_count * sizeof(*segs));
+        m->seg_count = seg_count;
+    }
+    m->opcode = opcode;
+    m->len = len;
+    m->done = done;
+    m->arg = arg;
+    l->count++;
+
+    l->stats.queued = l->count;
+    l->stats.queued_bytes += len;
+    l->stats.ring_used = l->ring_used;
+    if (l->stats.queued_bytes > l->stats.high_water_bytes) {
+        l->stats.high_water_bytes = l->stats.queued_bytes;
+    }
+    return 0;
+}
+
+const esp_websocket_txq_msg_t *esp_websocket_txq_peek(esp_websocket_txq_t *q, int *lane)
+{
+    for (int i = 0; i < ESP_WEBSOCKET_TXQ_LANES; i++) {
+        esp_websocket_txq_lane_t *l = &q->lanes[i];
+        if (l->count > 0) {
+            *lane = i;
+            return &l->msgs[l->head];
+        }
+    }
+    return NULL;
+}
+
+int esp_websocket_txq_pop(esp_websocket_txq_t *q, int lane, bool sent, esp_websocket_txq_msg_t *out)
+{
+    esp_websocket_txq_lane_t *l = &q->lanes[lane];
+    if (l->count == 0) {
+        return -1;
+    }
+    *out = l->msgs[l->head];
+    ring_free(l, out->ring_len);
+    l->head = (l->head + 1) % l->depth;
+    l->count--;
+
+    if (sent) {
+        l->stats.sent++;
+    } else {
+        l->stats.dropped++;
+    }
+    l->stats.queued = l->count;
+    l->stats.queued_bytes -= out->len;
+    l->stats.ring_used = l->ring_used;
+    return 0;
+}
+
+int esp_websocket_txq_pending(const esp_websocket_txq_t *q)
+{
+    int n = 0;
+    for (int i = 0; i < ESP_WEBSOCKET_TXQ_LANES; i++) {
+        n += q->lanes[i].count;
+    }
+    return n;
+}
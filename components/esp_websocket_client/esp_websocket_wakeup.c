@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include "esp_websocket_wakeup.h"
+
+#if defined(ESP_PLATFORM) && !CONFIG_IDF_TARGET_LINUX
+#include "esp_err.h"
+#include "esp_vfs_eventfd.h"
+#else
+#include <sys/eventfd.h>
+#endif
+
+int esp_websocket_wakeup_open(void)
+{
+#if defined(ESP_PLATFORM) && !CONFIG_IDF_TARGET_LINUX
+    // The driver may already have been registered by the application or another client
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    esp_err_t err = esp_vfs_eventfd_register(&config);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return -1;
+    }
+#endif
+    return eventfd(0, 0);
+}
+
+void esp_websocket_wakeup_close(int fd)
+{
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+void esp_websocket_wakeup_signal(int fd)
+{
+    if (fd >= 0) {
+        uint64_t one = 1;
+        // Cannot block: the counter would have to reach 2^64 - 1
+        (void)!write(fd, &one, sizeof(one));
+    }
+}
+
+int esp_websocket_wakeup_wait(int wakeup_fd, int sock_fd, int timeout_ms)
+{
+    fd_set readset;
+    FD_ZERO(&readset);
+    FD_SET(wakeup_fd, &readset);
+    if (sock_fd >= 0) {
+        FD_SET(sock_fd, &readset);
+    }
+    int maxfd = sock_fd > wakeup_fd ? sock_fd : wakeup_fd;
+    struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    int ret = select(maxfd + 1, &readset, NULL, NULL, timeout_ms < 0 ? NULL : &tv);
+    if (ret < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    if (FD_ISSET(wakeup_fd, &readset)) {
+        uint64_t count;
+        (void)!read(wakeup_fd, &count, sizeof(count));
+    }
+    return sock_fd >= 0 && FD_ISSET(sock_fd, &readset) ? 1 : 0;
+}
@@ -34,7 +34,7 @@ typedef enum {
     WEBSOCKET_EVENT_CONNECTED,      /*!< Once the Websocket has been connected to the server, no data exchange has been performed */
     WEBSOCKET_EVENT_DISCONNECTED,   /*!< The connection has been disconnected */
     WEBSOCKET_EVENT_DATA,           /*!< When receiving data from the server, possibly multiple portions of the packet */
-    WEBSOCKET_EVENT_CLOSED,         /*!< The connection has been closed cleanly */
+    WEBSOCKET_EVENT_CLOSED,         /*!< The connection has been closed cleanly. If the server closed it and auto reconnect is enabled, WEBSOCKET_EVENT_DISCONNECTED follows and the client reconnects */
     WEBSOCKET_EVENT_BEFORE_CONNECT, /*!< The event occurs before connecting */
     WEBSOCKET_EVENT_BEGIN,          /*!< The event occurs once after thread creation, before event loop */
     WEBSOCKET_EVENT_FINISH,         /*!< The event occurs once after event loop, before thread destruction */
@@ -66,6 +66,93 @@ typedef struct {
     int       esp_transport_sock_errno;         /*!< errno from the underlying socket */
 } esp_websocket_error_codes_t;
 
+/**
+ * @brief Buffer descriptor for esp_websocket_client_send_iov()
+ */
+typedef struct {
+    const void *data;                       /*!< Buffer start, may be NULL if len is 0 */
+    size_t len;                             /*!< Buffer length */
+} esp_websocket_iov_t;
+
+#define ESP_WEBSOCKET_TX_QUEUE_MAX_IOV  (4)    /*!< Buffers per message for esp_websocket_client_enqueue_iov() */
+
+/**
+ * @brief Outbound queue lanes
+ *
+ * The client task writes every queued control message before the next bulk message,
+ * and at most one bulk message between two checks of the control lane.
+ */
+typedef enum {
+    WEBSOCKET_TX_LANE_CONTROL = 0,  /*!< Short replies and commands */
+    WEBSOCKET_TX_LANE_BULK,         /*!< Large transfers such as audio */
+    WEBSOCKET_TX_LANE_MAX
+} esp_websocket_tx_lane_t;
+
+/**
+ * @brief Completion callback of a queued message, called from the websocket task
+ *
+ * @param arg   Argument given to esp_websocket_client_enqueue_iov()
+ * @param sent  true if the message was written to the transport, false if it was dropped on disconnect or stop
+ */
+typedef void (*esp_websocket_tx_done_cb_t)(void *arg, bool sent);
+
+/**
+ * @brief Outbound queue lane statistics
+ */
+typedef struct {
+    uint16_t queued;                /*!< Messages waiting */
+    size_t queued_bytes;            /*!< Payload bytes waiting (copied and referenced) */
+    size_t copy_used;               /*!< Bytes of the lane copy buffer in use */
+    size_t copy_size;               /*!< Size of the lane copy buffer */
+    uint16_t depth;                 /*!< Maximum messages in the lane */
+    uint32_t sent;                  /*!< Messages written */
+    uint32_t rejected;              /*!< Enqueue calls refused because the lane was full */
+    uint32_t dropped;               /*!< Messages dropped on disconnect or stop */
+    size_t high_water_bytes;        /*!< Largest queued_bytes seen */
+} esp_websocket_tx_queue_stats_t;
+
+/**
+ * @brief TLS handshake statistics of a wss client with `tls_session_cache_size`
+ *
+ * Times cover the TCP connect and the TLS handshake. Whether the server accepted an offered session
+ * is not reported by esp-tls: an abbreviated handshake shows as a much shorter time.
+ */
+typedef struct {
+    int last_handshake_ms;          /*!< Last successful connect, -1 before the first one */
+    bool last_session_offered;      /*!< The last successful connect offered a cached session */
+    uint32_t full_handshakes;       /*!< Successful connects without a cached session */
+    uint32_t session_handshakes;    /*!< Successful connects offering a cached session */
+    uint32_t failed;                /*!< Failed connects */
+    uint64_t full_ms_total;         /*!< Sum of the times of full_handshakes */
+    uint64_t session_ms_total;      /*!< Sum of the times of session_handshakes */
+    uint32_t sessions_cached;       /*!< Servers with a cached session */
+    uint32_t sessions_expired;      /*!< Sessions not offered because of `tls_session_lifetime_ms` */
+} esp_websocket_tls_stats_t;
+
+/**
+ * @brief Receiver of incoming binary messages, called from the websocket task instead of WEBSOCKET_EVENT_DATA
+ *
+ * The payload of every binary message, including its continuation frames, is passed to `on_data` in order.
+ * With `get_buffer`, the client reads the payload straight into the application's buffers (ring buffer,
+ * flash writer, decoder input) in pieces as large as the buffer, instead of rx-buffer-sized chunks.
+ * Text and control frames are still delivered as events.
+ */
+typedef struct {
+    /**
+     * Optional: destination for the next bytes of the current message, at message offset `offset`.
+     * Return the buffer and set `size` to its free length; returning NULL (or leaving this callback NULL)
+     * delivers the bytes from the client rx buffer instead.
+     */
+    void *(*get_buffer)(void *ctx, size_t offset, size_t *size);
+    /**
+     * Bytes `[offset, offset + len)` of the current binary message, in the buffer last returned by
+     * `get_buffer` (or the rx buffer, valid only during the call). `final` is set on the last piece of the
+     * message. Returning anything but ESP_OK discards the rest of the message.
+     */
+    esp_err_t (*on_data)(void *ctx, const uint8_t *data, size_t len, size_t offset, bool final);
+    void *ctx;                      /*!< Passed to both callbacks */
+} esp_websocket_binary_sink_t;
+
 /**
  * @brief Websocket event data
  */
@@ -81,6 +168,11 @@ typedef struct {
     esp_websocket_error_codes_t error_handle; /*!< esp-websocket error handle including esp-tls errors as well as internal websocket errors */
 } esp_websocket_event_data_t;
 
+/**
+ * @brief Direct receiver of WEBSOCKET_EVENT_DATA, see esp_websocket_client_set_data_handler()
+ */
+typedef void (*esp_websocket_data_handler_t)(void *arg, const esp_websocket_event_data_t *data);
+
 /**
  * @brief Websocket Client transport
  */
@@ -134,6 +226,14 @@ typedef struct {
     size_t                      ping_interval_sec;          /*!< Websocket ping interval, defaults to 10 seconds if not set */
     struct ifreq                *if_name;                   /*!< The name of interface for data to go through. Use the default interface without setting */
     esp_transport_handle_t      ext_transport;              /*!< External WebSocket tcp_transport handle to the client; or if null, the client will create its own transport handle. */
+    size_t                      tx_queue_control_size;      /*!< Bytes reserved for copied messages in the control lane of the outbound queue. The queue is disabled if this, `tx_queue_bulk_size` and `tx_queue_depth` are all 0 */
+    size_t                      tx_queue_bulk_size;         /*!< Bytes reserved for copied messages in the bulk lane, may be 0 if bulk messages are only enqueued by reference */
+    int                         tx_queue_depth;             /*!< Maximum messages per lane of the outbound queue (defaults to 16 if the queue is enabled) */
+    size_t                      rx_message_max;             /*!< Deliver whole text messages, reassembled from all their frames and chunks in a buffer of this size allocated once per client: one WEBSOCKET_EVENT_DATA per message with `fin` set, `payload_offset` 0 and the data NUL terminated. Larger messages are dropped. 0 delivers every chunk of at most `buffer_size` bytes as received */
+    bool                        rx_reassemble_binary;       /*!< With `rx_message_max`, reassemble binary messages too; otherwise binary messages are still delivered chunk by chunk (suited to streaming) */
+    int                         dns_cache_ttl_ms;           /*!< Resolve a host name before connecting and reuse the address for this long, and keep using it if a lookup fails; looked up again after a failed connect. The handshake still sends the host name in the Host header. wss uses the cache only with `tls_session_cache_size` (the TLS transport passes the host name to esp-tls for SNI and certificate checks); the esp_transport_ssl transport resolves on every connect. 0 lets the transport resolve on every connect */
+    int                         tls_session_cache_size;     /*!< wss: keep the TLS session (ticket or session ID) of this many servers and offer it on the next connect to the same server, for an abbreviated handshake. Sessions are kept in RAM across stop/start and set_uri until the client is destroyed. Requires CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS; 0 uses the ssl transport of tcp_transport */
+    int                         tls_session_lifetime_ms;    /*!< Do not offer sessions older than this (the server decides anyway), 0 for no limit */
 } esp_websocket_client_config_t;
 
 /**
@@ -152,7 +252,9 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
 
 /**
  * @brief      Set URL for client, when performing this behavior, the options in the URL will replace the old ones
- *             Must stop the WebSocket client before set URI if the client has been connected
+ *             Must stop the WebSocket client before set URI if the client has been connected, or call it from the
+ *             WEBSOCKET_EVENT_DISCONNECTED handler to make the next reconnect go to another server. The scheme
+ *             cannot change while the client runs, and a URL without a port keeps the previous port.
  *
  * @param[in]  client  The client
  * @param[in]  uri     The uri
@@ -256,6 +358,137 @@ esp_err_t esp_websocket_client_destroy_on_exit(esp_websocket_client_handle_t cli
  */
 int esp_websocket_client_send_bin(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout);
 
+/**
+ * @brief      Write a message gathered from several buffers as a single WebSocket frame
+ *
+ *  Notes:
+ *   - The buffers are masked directly into the tx buffer and written to the underlying tcp/ssl transport
+ *     whenever it fills up, so the message is neither assembled in a temporary buffer nor split into
+ *     one frame per `buffer_size` bytes as with esp_websocket_client_send_bin().
+ *   - The caller's buffers are not modified.
+ *   - With `ext_transport` the raw stream is not accessible; the buffers are then sent as a fragmented
+ *     message (one frame per buffer) under the client lock.
+ *
+ * @param[in]  client  The client
+ * @param[in]  opcode  Message opcode (WS_TRANSPORT_OPCODES_BINARY or WS_TRANSPORT_OPCODES_TEXT), FIN is always set
+ * @param[in]  iov     Buffers, sent in order
+ * @param[in]  iovcnt  Number of buffers
+ * @param[in]  timeout Write data timeout in RTOS ticks
+ *
+ * @return
+ *     - Number of payload bytes sent (sum of all buffer lengths)
+ *     - (-1) if any errors
+ */
+int esp_websocket_client_send_iov(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode,
+                                  const esp_websocket_iov_t *iov, int iovcnt, TickType_t timeout);
+
+/**
+ * @brief      Queue a message for the websocket task to send, copying the payload
+ *
+ *  Notes:
+ *   - Never blocks on the network: returns as soon as the message is copied into the lane buffer.
+ *   - The message is sent as a single final frame with `opcode`, in order with the other messages of the lane.
+ *   - Requires the outbound queue to be configured (`tx_queue_*` in esp_websocket_client_config_t).
+ *
+ * @param[in]  client  The client
+ * @param[in]  lane    Priority lane
+ * @param[in]  opcode  WS_TRANSPORT_OPCODES_TEXT or WS_TRANSPORT_OPCODES_BINARY
+ * @param[in]  data    The data
+ * @param[in]  len     The length
+ *
+ * @return
+ *     - ESP_OK if queued
+ *     - ESP_ERR_NO_MEM if the lane is full (backpressure: retry later or drop)
+ *     - ESP_ERR_INVALID_STATE if not connected or the queue is not configured
+ *     - ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_SIZE on bad arguments
+ */
+esp_err_t esp_websocket_client_enqueue(esp_websocket_client_handle_t client, esp_websocket_tx_lane_t lane,
+                                       ws_transport_opcodes_t opcode, const char *data, int len);
+
+/**
+ * @brief      Queue a message gathered from caller buffers without copying
+ *
+ *  Notes:
+ *   - The buffers must stay valid and unchanged until `done_cb` is called; it is called exactly once,
+ *     from the websocket task, when the message was written or dropped (disconnect, stop or destroy).
+ *   - The buffers are sent as one frame, as with esp_websocket_client_send_iov().
+ *
+ * @param[in]  client   The client
+ * @param[in]  lane     Priority lane
+ * @param[in]  opcode   WS_TRANSPORT_OPCODES_TEXT or WS_TRANSPORT_OPCODES_BINARY
+ * @param[in]  iov      Buffers, at most ESP_WEBSOCKET_TX_QUEUE_MAX_IOV
+ * @param[in]  iovcnt   Number of buffers
+ * @param[in]  done_cb  Completion callback, may be NULL
+ * @param[in]  arg      Callback argument
+ *
+ * @return     As esp_websocket_client_enqueue(); `done_cb` is not called unless ESP_OK is returned
+ */
+esp_err_t esp_websocket_client_enqueue_iov(esp_websocket_client_handle_t client, esp_websocket_tx_lane_t lane,
+        ws_transport_opcodes_t opcode, const esp_websocket_iov_t *iov, int iovcnt,
+        esp_websocket_tx_done_cb_t done_cb, void *arg);
+
+/**
+ * @brief      Get outbound queue statistics of a lane
+ *
+ * @param[in]  client  The client
+ * @param[in]  lane    Lane
+ * @param[out] stats   Statistics
+ *
+ * @return     ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE if the queue is not configured
+ */
+esp_err_t esp_websocket_client_get_tx_queue_stats(esp_websocket_client_handle_t client, esp_websocket_tx_lane_t lane,
+        esp_websocket_tx_queue_stats_t *stats);
+
+/**
+ * @brief      Get the TLS handshake statistics
+ *
+ * @param[in]  client  The client
+ * @param[out] stats   Statistics
+ *
+ * @return     ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE if `tls_session_cache_size` is not in use
+ */
+esp_err_t esp_websocket_client_get_tls_stats(esp_websocket_client_handle_t client, esp_websocket_tls_stats_t *stats);
+
+/**
+ * @brief      Route incoming binary messages to a sink instead of WEBSOCKET_EVENT_DATA
+ *
+ *  Notes:
+ *   - The callbacks run in the websocket task, without the event loop; they must not block for long.
+ *   - Takes precedence over `rx_reassemble_binary`.
+ *   - May be called while the client is running; a message in progress is finished with the old setting.
+ *
+ * @param[in]  client  The client
+ * @param[in]  sink    Sink (copied), or NULL to deliver binary messages as events again
+ *
+ * @return     ESP_OK, or ESP_ERR_INVALID_ARG if `client` is NULL or `sink` has no `on_data`
+ */
+esp_err_t esp_websocket_client_set_binary_sink(esp_websocket_client_handle_t client, const esp_websocket_binary_sink_t *sink);
+
+/**
+ * @brief      Deliver WEBSOCKET_EVENT_DATA by calling `handler` directly instead of posting to the event loop
+ *
+ *  Every data event otherwise costs an event post (a heap copy of the event data and a queue send) and a
+ *  loop run, per rx-buffer chunk. Lifecycle events (connected, disconnected, error, closed, ...) are still
+ *  posted to the handlers registered with esp_websocket_register_events(); they no longer receive data events.
+ *
+ *  Notes:
+ *   - The handler runs synchronously in the websocket task with the client lock held. It must not block:
+ *     no waiting on queues, semaphores or the network, and no long processing. Hand the data to another task
+ *     (stream buffer, queue with zero timeout) and return.
+ *   - It may call esp_websocket_client_enqueue() and the other non-blocking calls, but not
+ *     esp_websocket_client_stop(), esp_websocket_client_close() or esp_websocket_client_destroy().
+ *   - `data` and the memory it points to are valid only during the call.
+ *   - Binary messages routed to a sink (esp_websocket_client_set_binary_sink()) do not reach the handler.
+ *
+ * @param[in]  client   The client
+ * @param[in]  handler  Handler, or NULL to post data events to the event loop again
+ * @param[in]  arg      Passed to the handler
+ *
+ * @return     ESP_OK, or ESP_ERR_INVALID_ARG if `client` is NULL
+ */
+esp_err_t esp_websocket_client_set_data_handler(esp_websocket_client_handle_t client, esp_websocket_data_handler_t handler,
+        void *arg);
+
 /**
  * @brief      Write binary data to the WebSocket connection and sends it without setting the FIN flag(data send with WS OPCODE=02, i.e. binary)
  *
@@ -413,6 +646,17 @@ bool esp_websocket_client_is_connected(esp_websocket_client_handle_t client);
  */
 size_t esp_websocket_client_get_ping_interval_sec(esp_websocket_client_handle_t client);
 
+/**
+ * @brief      Get the round trip time of the last answered PING, measured by the client task.
+ *
+ * Updated before the PONG is delivered as WEBSOCKET_EVENT_DATA, and reset on every connect.
+ *
+ * @param[in]  client             The client
+ *
+ * @return     Milliseconds from sending the PING to receiving its PONG, or -1 if no PONG was received on this connection
+ */
+int esp_websocket_client_get_ping_rtt_ms(esp_websocket_client_handle_t client);
+
 /**
  * @brief      Set new ping interval sec for client.
  *
@@ -432,6 +676,21 @@ esp_err_t esp_websocket_client_set_ping_interval_sec(esp_websocket_client_handle
  */
 int esp_websocket_client_get_reconnect_timeout(esp_websocket_client_handle_t client);
 
+/**
+ * @brief      Drop the current connection and reconnect, as after a lost connection
+ *
+ * The connection is aborted by the client task, which then dispatches WEBSOCKET_EVENT_DISCONNECTED and waits
+ * for the reconnect timeout. The DISCONNECTED handler can change the URI and timeout there, so the switch happens
+ * in the same task as any other reconnect. Does nothing if the client is not connected when the request is handled.
+ *
+ * @param[in]  client             The client
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_STATE if the client is not running or automatic reconnect is disabled
+ */
+esp_err_t esp_websocket_client_reconnect(esp_websocket_client_handle_t client);
+
 /**
  * @brief      Set next reconnect timeout for client.
  *
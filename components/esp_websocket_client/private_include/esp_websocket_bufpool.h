@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief Pool of rx/tx buffers for CONFIG_ESP_WS_CLIENT_ENABLE_DYNAMIC_BUFFER
+ *
+ * Dynamic buffer mode used to calloc a buffer before every receive and send and
+ * free it afterwards. The pool keeps released buffers in a few slots instead, so
+ * a busy connection reuses the same memory, and frees them once they have been
+ * idle for a while, so an idle connection still holds no buffers.
+ *
+ * Every slot is a single atomic pointer: get exchanges it with NULL, put
+ * compare-exchanges NULL with the buffer. No lock is taken, so one pool can be
+ * shared by several clients (tasks), and a buffer is owned by exactly one
+ * caller at a time. Buffers are allocated lazily on a miss and are not zeroed.
+ * Plain C (stdatomic), also built on the host (see tools/ws_host).
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    _Atomic(void *) buf;            /*!< Cached buffer, NULL if the slot is empty */
+    atomic_uint_fast32_t since;     /*!< Time (ms) the buffer was put back */
+} esp_websocket_bufpool_slot_t;
+
+typedef struct {
+    esp_websocket_bufpool_slot_t *slots;
+    int slot_count;
+    size_t size;                    /*!< Size of every buffer */
+    uint32_t idle_ms;               /*!< Cached buffers idle for longer are freed by trim */
+    atomic_uint hits;               /*!< Gets served from a slot */
+    atomic_uint misses;             /*!< Gets that had to allocate */
+    atomic_uint trimmed;            /*!< Buffers freed after being idle */
+    atomic_uint overflow;           /*!< Buffers freed on put because every slot was taken */
+} esp_websocket_bufpool_t;
+
+/**
+ * @brief      Set up an empty pool over caller-provided slots; allocates nothing
+ */
+void esp_websocket_bufpool_init(esp_websocket_bufpool_t *pool, esp_websocket_bufpool_slot_t *slots, int slot_count,
+                                size_t size, uint32_t idle_ms);
+
+/**
+ * @brief      Take a buffer of `pool->size` bytes, allocating one if no slot holds a buffer
+ *
+ * @return     Buffer (contents undefined), or NULL if out of memory
+ */
+void *esp_websocket_bufpool_get(esp_websocket_bufpool_t *pool);
+
+/**
+ * @brief      Return a buffer taken from the pool; it is freed if every slot is taken. NULL is ignored.
+ */
+void esp_websocket_bufpool_put(esp_websocket_bufpool_t *pool, void *buf, uint32_t now_ms);
+
+/**
+ * @brief      Free the cached buffers idle for longer than `idle_ms`
+ *
+ * @return     Number of buffers freed
+ */
+int esp_websocket_bufpool_trim(esp_websocket_bufpool_t *pool, uint32_t now_ms);
+
+/**
+ * @brief      Free every cached buffer (buffers taken out are not affected)
+ */
+void esp_websocket_bufpool_drain(esp_websocket_bufpool_t *pool);
+
+/**
+ * @brief      Number of buffers currently cached in the slots
+ */
+int esp_websocket_bufpool_cached(esp_websocket_bufpool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
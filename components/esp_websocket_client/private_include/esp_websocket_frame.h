@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief WebSocket frame helpers used by the zero-copy send path
+ *
+ * Plain C without IDF dependencies, so that the framing and masking can be
+ * benchmarked and verified on the host (see tools/ws_host).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_WEBSOCKET_FRAME_MAX_HEADER   (14)    /*!< 2 base + 8 extended length + 4 mask key */
+
+/**
+ * @brief      Build a WebSocket frame header
+ *
+ * @param[out] hdr     Output buffer, at least ESP_WEBSOCKET_FRAME_MAX_HEADER bytes
+ * @param[in]  opcode  Opcode byte, including the FIN bit
+ * @param[in]  len     Payload length
+ * @param[in]  mask    Masking key (client frames), or NULL for an unmasked frame
+ *
+ * @return     Header length in bytes
+ */
+size_t esp_websocket_frame_header(uint8_t *hdr, uint8_t opcode, uint64_t len, const uint8_t mask[4]);
+
+/**
+ * @brief      Copy and mask payload bytes in one pass
+ *
+ * Works a 32-bit word at a time once the destination is aligned, so the
+ * payload is read exactly once and never modified in place.
+ *
+ * @param[out] dst     Destination
+ * @param[in]  src     Source payload (any alignment, may live in PSRAM)
+ * @param[in]  len     Number of bytes
+ * @param[in]  mask    Masking key
+ * @param[in]  phase   Offset of src within the frame payload (selects the key byte)
+ */
+void esp_websocket_mask_copy(uint8_t *dst, const uint8_t *src, size_t len, const uint8_t mask[4], size_t phase);
+
+#ifdef __cplusplus
+}
+#endif
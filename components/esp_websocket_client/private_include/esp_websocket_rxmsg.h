@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief Reassembly of fragmented incoming messages
+ *
+ * The client reads each frame in chunks of at most its rx buffer size. In
+ * reassembly mode the chunks of text (and optionally binary) messages, including
+ * their continuation frames, are copied into one arena allocated per client, so
+ * that a whole message can be delivered in a single event. The arena is reused for
+ * every message: nothing is allocated after esp_websocket_rxmsg_init().
+ *
+ * Plain C without IDF dependencies (see tools/ws_host).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_WEBSOCKET_RXMSG_PASS,       /*!< Not reassembled (control frame, or binary without binary reassembly): deliver the chunk as is */
+    ESP_WEBSOCKET_RXMSG_PENDING,    /*!< Copied, the message is not complete yet */
+    ESP_WEBSOCKET_RXMSG_COMPLETE,   /*!< The message is complete in the arena */
+    ESP_WEBSOCKET_RXMSG_DROPPED,    /*!< Chunk discarded: the message exceeds the arena or is out of sequence */
+} esp_websocket_rxmsg_result_t;
+
+typedef struct {
+    uint8_t *buf;                   /*!< Arena, `max + 1` bytes so that a message can be NUL terminated */
+    size_t max;                     /*!< Largest message */
+    size_t len;                     /*!< Bytes of the current message */
+    uint8_t opcode;                 /*!< Opcode of the first frame of the current message */
+    bool binary;                    /*!< Reassemble binary messages too */
+    bool active;                    /*!< A reassembled message is in progress */
+    bool passing;                   /*!< A passed-through binary message is in progress */
+    bool overflow;                  /*!< The current message is being discarded */
+    uint32_t delivered;             /*!< Messages completed */
+    uint32_t dropped;               /*!< Messages discarded */
+} esp_websocket_rxmsg_t;
+
+/**
+ * @brief      Allocate the arena
+ *
+ * @param[out] m       Reassembly state
+ * @param[in]  max     Largest message in bytes
+ * @param[in]  binary  Reassemble binary messages as well as text messages
+ *
+ * @return     0 on success, -1 if out of memory
+ */
+int esp_websocket_rxmsg_init(esp_websocket_rxmsg_t *m, size_t max, bool binary);
+
+/**
+ * @brief      Free the arena
+ */
+void esp_websocket_rxmsg_deinit(esp_websocket_rxmsg_t *m);
+
+/**
+ * @brief      Forget a partial message (on a new connection)
+ */
+void esp_websocket_rxmsg_reset(esp_websocket_rxmsg_t *m);
+
+/**
+ * @brief      Feed one chunk read from the transport
+ *
+ * @param[in]  opcode        Opcode of the frame the chunk belongs to (0 for a continuation frame)
+ * @param[in]  fin           FIN flag of the frame
+ * @param[in]  frame_offset  Offset of the chunk within the frame payload
+ * @param[in]  frame_len     Payload length of the frame
+ * @param[in]  data          Chunk
+ * @param[in]  len           Chunk length
+ *
+ * @return     What to do with the chunk; on ESP_WEBSOCKET_RXMSG_COMPLETE the message is
+ *             `m->buf` / `m->len` with opcode `m->opcode`, followed by a NUL byte, and
+ *             stays valid until the next call
+ */
+esp_websocket_rxmsg_result_t esp_websocket_rxmsg_feed(esp_websocket_rxmsg_t *m, uint8_t opcode, bool fin,
+        size_t frame_offset, size_t frame_len, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief Delivery of incoming binary messages to a sink (esp_websocket_client_set_binary_sink())
+ *
+ * The client reads each frame with esp_transport_read(); the first read of a frame also
+ * parses its header and goes to the rx buffer, later reads of a sink frame go straight to
+ * the application buffer returned by `get_buffer` when there is one. This module tracks the
+ * message in progress across its continuation frames and passes every piece to `on_data`
+ * with its message offset and the `final` flag, copying bytes that landed in the rx buffer
+ * into the application buffers first.
+ *
+ * Plain C without IDF dependencies (see tools/ws_host).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sink callbacks, same layout and semantics as esp_websocket_binary_sink_t (`on_data` returns ESP_OK == 0)
+ */
+typedef struct {
+    void *(*get_buffer)(void *ctx, size_t offset, size_t *size);
+    int (*on_data)(void *ctx, const uint8_t *data, size_t len, size_t offset, bool final);
+    void *ctx;
+} esp_websocket_sink_cb_t;
+
+typedef struct {
+    esp_websocket_sink_cb_t msg;    /*!< Sink of the binary message in progress */
+    size_t offset;                  /*!< Message offset of the next byte */
+    bool active;                    /*!< A binary message is being passed to `msg` */
+    bool discard;                   /*!< `on_data` failed, drop the rest of the message */
+} esp_websocket_sink_t;
+
+/**
+ * @brief      Forget a message in progress (on a new connection)
+ */
+void esp_websocket_sink_reset(esp_websocket_sink_t *s);
+
+/**
+ * @brief      At the start of a frame: does it belong to a binary message for the sink?
+ *
+ * A binary frame starts a new message with the sink configured now (`cb->on_data` NULL
+ * if none); a continuation frame belongs to the message in progress.
+ *
+ * @param[in]  cb           Sink currently configured
+ * @param[in]  opcode       Opcode of the frame (0 for a continuation frame)
+ * @param[out] interrupted  Set if a new binary message cut short the one in progress
+ *
+ * @return     true if the frame is to be passed to the sink
+ */
+bool esp_websocket_sink_frame(esp_websocket_sink_t *s, const esp_websocket_sink_cb_t *cb, uint8_t opcode,
+                              bool *interrupted);
+
+/**
+ * @brief      Destination for the next read of a sink frame
+ *
+ * @param[in]  rx_buffer  Client rx buffer, used if the sink has no buffer to offer
+ * @param[in]  rx_size    Its size
+ * @param[out] size       Size of the returned buffer
+ *
+ * @return     The application buffer, or `rx_buffer`
+ */
+char *esp_websocket_sink_buffer(esp_websocket_sink_t *s, char *rx_buffer, int rx_size, int *size);
+
+/**
+ * @brief      Pass bytes of a sink frame to the application
+ *
+ * @param[in]  data     Bytes read
+ * @param[in]  len      Their length
+ * @param[in]  in_rx    `data` is in the rx buffer (copied into the sink's buffers if it has them)
+ * @param[in]  last     These are the last bytes of the message
+ *
+ * @return     false if `on_data` failed during this call: the rest of the message is dropped
+ */
+bool esp_websocket_sink_data(esp_websocket_sink_t *s, const char *data, int len, bool in_rx, bool last);
+
+#ifdef __cplusplus
+}
+#endif
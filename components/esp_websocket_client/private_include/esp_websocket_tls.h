@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief TLS transport with client session resumption
+ *
+ * A tcp_transport implementation on top of esp-tls used for wss when
+ * `tls_session_cache_size` is set. It does what the ssl transport of tcp_transport
+ * does, and in addition offers the session of the previous handshake with the same
+ * server (esp_tls_cfg_t::client_session) so that the server can resume it with an
+ * abbreviated handshake: no certificate chain to send and verify, and no key
+ * exchange. The session is taken after each successful handshake and again when
+ * the connection is closed, to pick up tickets the server sends later (TLS 1.3).
+ *
+ * Sessions are kept in a store owned by the client, so they survive
+ * esp_websocket_client_stop()/start() and a change of server with
+ * esp_websocket_client_set_uri(). The store also measures each handshake.
+ *
+ * With a resolver set (the client's DNS cache) the transport connects to the address
+ * it returns and passes the host name to esp-tls as the common name, which mbedTLS
+ * uses for SNI and to check the certificate.
+ *
+ * Requires CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS.
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_transport.h"
+#include "esp_tls.h"
+#include "esp_websocket_client.h"
+#include "esp_websocket_tls_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    esp_websocket_tls_cache_t cache;
+    esp_websocket_tls_stats_t stats;
+} esp_websocket_tls_store_t;
+
+/**
+ * @brief      Address lookup used by the transport
+ */
+typedef struct {
+    const char *(*resolve)(void *arg, const char *host);    /*!< Address to connect to for `host`, or `host` itself */
+    void (*connect_failed)(void *arg, const char *addr);    /*!< Connecting to an address other than the host name failed */
+    void *arg;
+} esp_websocket_tls_resolver_t;
+
+/**
+ * @brief      Create a session store
+ *
+ * @param[in]  size         Number of servers to keep a session for
+ * @param[in]  lifetime_ms  Maximum age of an offered session, 0 for no limit
+ *
+ * @return     The store, or NULL if out of memory
+ */
+esp_websocket_tls_store_t *esp_websocket_tls_store_create(int size, uint32_t lifetime_ms);
+
+/**
+ * @brief      Release all sessions and the store (no transport may use it any more)
+ */
+void esp_websocket_tls_store_destroy(esp_websocket_tls_store_t *store);
+
+/**
+ * @brief      Copy the handshake statistics (any task)
+ */
+void esp_websocket_tls_store_get_stats(esp_websocket_tls_store_t *store, esp_websocket_tls_stats_t *stats);
+
+/**
+ * @brief      Create the transport
+ *
+ * @param[in]  cfg    TLS configuration, copied; the buffers it points to must outlive the transport.
+ *                    `timeout_ms` and `client_session` are set per connect.
+ * @param[in]  store  Session store
+ *
+ * @return     The transport, or NULL if out of memory
+ */
+esp_transport_handle_t esp_websocket_tls_init(const esp_tls_cfg_t *cfg, esp_websocket_tls_store_t *store);
+
+/**
+ * @brief      Connect to the addresses `resolver` returns instead of letting esp-tls look up the host
+ *
+ * @param[in]  t         The transport
+ * @param[in]  resolver  Copied; NULL to let esp-tls resolve the host on every connect
+ */
+void esp_websocket_tls_set_resolver(esp_transport_handle_t t, const esp_websocket_tls_resolver_t *resolver);
+
+/**
+ * @brief      Socket of the current connection, -1 if not connected
+ *
+ * The transport cannot register a get_socket function with tcp_transport, so the client asks
+ * for the socket directly to wait on it together with its wakeup event.
+ */
+int esp_websocket_tls_get_socket(esp_transport_handle_t t);
+
+#ifdef __cplusplus
+}
+#endif
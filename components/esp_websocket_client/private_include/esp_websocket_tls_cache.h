@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief TLS client session cache
+ *
+ * Keeps the TLS session (ticket or session ID) of the last successful handshake
+ * with each server, keyed by host and port, so that the next connect to the same
+ * server can offer it and get an abbreviated handshake. A few slots cover the
+ * primary and fallback servers of a client; when all are taken the least recently
+ * used session is evicted.
+ *
+ * Sessions are opaque: the cache owns them once stored and releases them with the
+ * free function given at init (esp_tls_free_client_session() on the chip). A
+ * session returned by esp_websocket_tls_cache_get() stays owned by the cache.
+ *
+ * Plain C without IDF dependencies (see tools/ws_host). Not thread safe: the
+ * cache is used by one client task.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_WEBSOCKET_TLS_CACHE_HOST_MAX    64  /*!< Longer host names are not cached */
+
+typedef void (*esp_websocket_tls_session_free_t)(void *session);
+
+typedef struct {
+    char host[ESP_WEBSOCKET_TLS_CACHE_HOST_MAX];
+    uint16_t port;
+    void *session;                  /*!< NULL if the slot is free */
+    uint32_t stored_ms;             /*!< When the session was stored, for the lifetime */
+    uint32_t used_ms;               /*!< Last store or lookup, for eviction */
+} esp_websocket_tls_cache_entry_t;
+
+typedef struct {
+    esp_websocket_tls_cache_entry_t *entries;
+    int size;
+    uint32_t lifetime_ms;           /*!< Sessions older than this are not offered, 0 for no limit */
+    esp_websocket_tls_session_free_t free_session;
+    uint32_t stored;                /*!< Sessions stored */
+    uint32_t evicted;               /*!< Sessions evicted to make room */
+    uint32_t expired;               /*!< Sessions dropped at lookup because of their age */
+} esp_websocket_tls_cache_t;
+
+/**
+ * @brief      Allocate the slots
+ *
+ * @param[out] c             Cache
+ * @param[in]  size          Number of servers to keep a session for
+ * @param[in]  lifetime_ms   Maximum age of an offered session, 0 for no limit
+ * @param[in]  free_session  Releases a session
+ *
+ * @return     0 on success, -1 if out of memory
+ */
+int esp_websocket_tls_cache_init(esp_websocket_tls_cache_t *c, int size, uint32_t lifetime_ms,
+                                 esp_websocket_tls_session_free_t free_session);
+
+/**
+ * @brief      Release all sessions and the slots
+ */
+void esp_websocket_tls_cache_deinit(esp_websocket_tls_cache_t *c);
+
+/**
+ * @brief      Session to offer when connecting to a server
+ *
+ * @return     The cached session (still owned by the cache), or NULL if there is none or it is
+ *             older than the lifetime (it is then released)
+ */
+void *esp_websocket_tls_cache_get(esp_websocket_tls_cache_t *c, const char *host, uint16_t port, uint32_t now_ms);
+
+/**
+ * @brief      Store the session of a successful handshake
+ *
+ * Takes ownership of `session`, replacing the previous session of the server or evicting the
+ * least recently used one. If the host name is too long the session is released.
+ */
+void esp_websocket_tls_cache_put(esp_websocket_tls_cache_t *c, const char *host, uint16_t port, void *session,
+                                 uint32_t now_ms);
+
+/**
+ * @brief      Release the session of a server (e.g. after a handshake offering it failed)
+ */
+void esp_websocket_tls_cache_drop(esp_websocket_tls_cache_t *c, const char *host, uint16_t port);
+
+/**
+ * @brief      Number of cached sessions
+ */
+int esp_websocket_tls_cache_count(const esp_websocket_tls_cache_t *c);
+
+#ifdef __cplusplus
+}
+#endif
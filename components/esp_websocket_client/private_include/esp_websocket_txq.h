@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief Outbound message queue with priority lanes
+ *
+ * Each lane is a FIFO of at most `depth` messages plus a byte ring for messages
+ * whose payload is copied at enqueue time. Messages may also reference caller
+ * buffers, which must stay valid until the completion callback runs.
+ * All memory is allocated in esp_websocket_txq_init(); push never allocates.
+ *
+ * The queue does no locking and no I/O: the client serializes access with its
+ * own mutex and writes the frames, which keeps the queue testable on the host
+ * (see tools/ws_host).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_WEBSOCKET_TXQ_LANES     (2)     /*!< Lane 0 (control) is always drained before lane 1 (bulk) */
+#define ESP_WEBSOCKET_TXQ_MAX_SEGS  (4)     /*!< Buffers per referenced message */
+
+typedef void (*esp_websocket_txq_done_cb_t)(void *arg, bool sent);
+
+typedef struct {
+    const void *data;
+    size_t len;
+} esp_websocket_txq_seg_t;
+
+typedef struct {
+    uint8_t opcode;                                         /*!< Opcode byte without FIN, the frame is always final */
+    uint8_t seg_count;
+    esp_websocket_txq_seg_t segs[ESP_WEBSOCKET_TXQ_MAX_SEGS];
+    size_t len;                                             /*!< Payload length, sum of all segments */
+    size_t ring_len;                                        /*!< Bytes held in the lane ring, including a skipped tail */
+    esp_websocket_txq_done_cb_t done;
+    void *arg;
+} esp_websocket_txq_msg_t;
+
+typedef struct {
+    uint16_t queued;                /*!< Messages waiting */
+    size_t queued_bytes;            /*!< Payload bytes waiting, copied and referenced */
+    size_t ring_used;               /*!< Bytes of the copy ring in use */
+    size_t ring_size;
+    uint16_t depth;
+    uint32_t sent;                  /*!< Messages written to the transport */
+    uint32_t rejected;              /*!< Pushes refused because the lane was full */
+    uint32_t dropped;               /*!< Messages discarded by a flush (disconnect) */
+    size_t high_water_bytes;        /*!< Largest queued_bytes seen */
+} esp_websocket_txq_stats_t;
+
+typedef struct {
+    esp_websocket_txq_msg_t *msgs;
+    uint16_t depth;
+    uint16_t head;
+    uint16_t count;
+    uint8_t *ring;
+    size_t ring_size;
+    size_t ring_head;               /*!< Start of the oldest copied payload */
+    size_t ring_tail;               /*!< Next free byte */
+    size_t ring_used;
+    esp_websocket_txq_stats_t stats;
+} esp_websocket_txq_lane_t;
+
+typedef struct {
+    esp_websocket_txq_lane_t lanes[ESP_WEBSOCKET_TXQ_LANES];
+} esp_websocket_txq_t;
+
+/**
+ * @brief      Allocate the lanes
+ *
+ * @param[out] q          Queue
+ * @param[in]  ring_size  Copy ring size of each lane in bytes, may be 0 for a reference-only lane
+ * @param[in]  depth      Maximum number of messages per lane
+ *
+ * @return     0 on success, -1 if out of memory (nothing is left allocated)
+ */
+int esp_websocket_txq_init(esp_websocket_txq_t *q, const size_t ring_size[ESP_WEBSOCKET_TXQ_LANES], uint16_t depth);
+
+/**
+ * @brief      Free the lanes; the queue must have been flushed
+ */
+void esp_websocket_txq_deinit(esp_websocket_txq_t *q);
+
+/**
+ * @brief      Append a message to a lane
+ *
+ * @param[in]  q          Queue
+ * @param[in]  lane       Lane index
+ * @param[in]  opcode     Opcode byte without FIN
+ * @param[in]  segs       Payload buffers
+ * @param[in]  seg_count  Number of buffers (at most ESP_WEBSOCKET_TXQ_MAX_SEGS unless copied)
+ * @param[in]  copy       Copy the payload into the lane ring; otherwise the buffers are referenced
+ * @param[in]  done       Completion callback, or NULL
+ * @param[in]  arg        Callback argument
+ *
+ * @return     0 on success, -1 if the lane has no free message slot or ring space
+ */
+int esp_websocket_txq_push(esp_websocket_txq_t *q, int lane, uint8_t opcode, const esp_websocket_txq_seg_t *segs,
+                           int seg_count, bool copy, esp_websocket_txq_done_cb_t done, void *arg);
+
+/**
+ * @brief      Oldest message of the highest priority non-empty lane
+ *
+ * The message stays queued (and its copied payload valid) until esp_websocket_txq_pop().
+ *
+ * @param[out] lane  Lane of the returned message
+ *
+ * @return     Message, or NULL if all lanes are empty
+ */
+const esp_websocket_txq_msg_t *esp_websocket_txq_peek(esp_websocket_txq_t *q, int *lane);
+
+/**
+ * @brief      Remove the oldest message of a lane
+ *
+ * The completion callback is not called here: it is returned in `out` so that the
+ * caller can run it after releasing its lock.
+ *
+ * @param[in]  sent  Whether the message was written (counted in the stats)
+ * @param[out] out   Removed message
+ *
+ * @return     0 on success, -1 if the lane is empty
+ */
+int esp_websocket_txq_pop(esp_websocket_txq_t *q, int lane, bool sent, esp_websocket_txq_msg_t *out);
+
+/**
+ * @brief      Number of messages waiting in all lanes
+ */
+int esp_websocket_txq_pending(const esp_websocket_txq_t *q);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief Wakeup event for the websocket task
+ *
+ * An eventfd that the task selects on together with the connection socket, so
+ * that other tasks can interrupt the wait when they queue a message, stop or
+ * close the client. On the chip the eventfd comes from the esp_vfs_eventfd
+ * driver (lwIP select handles both descriptors); on the linux target and on the
+ * host it is the system eventfd (see tools/ws_host).
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief      Create the wakeup event
+ *
+ * @return     File descriptor, or -1 if eventfd is not available (the caller falls back to polling)
+ */
+int esp_websocket_wakeup_open(void);
+
+/**
+ * @brief      Close the wakeup event; a negative fd is ignored
+ */
+void esp_websocket_wakeup_close(int fd);
+
+/**
+ * @brief      Wake up the task waiting on the event; safe from any task, a negative fd is ignored
+ */
+void esp_websocket_wakeup_signal(int fd);
+
+/**
+ * @brief      Wait until the socket is readable, the event is signalled or the timeout expires
+ *
+ * A pending signal is consumed.
+ *
+ * @param[in]  wakeup_fd   Wakeup event
+ * @param[in]  sock_fd     Connection socket, or -1 to wait on the event only
+ * @param[in]  timeout_ms  Timeout, -1 to wait forever
+ *
+ * @return     1 if the socket is readable, 0 on wakeup or timeout, -1 on error
+ */
+int esp_websocket_wakeup_wait(int wakeup_fd, int sock_fd, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file audio_adpcm.c
+ * @brief IMA ADPCM 块编解码
+ */
+
+#include <string.h>
+#include "audio_adpcm.h"
+#include "esp_attr.h"
+
+static const DRAM_ATTR int8_t s_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+static const DRAM_ATTR int16_t s_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static inline int32_t adpcm_step(uint8_t code, int32_t *predictor, int32_t *index)
+{
+    int32_t step = s_step_table[*index];
+    int32_t delta = step >> 3;
+    if (code & 4) delta += step;
+    if (code & 2) delta += step >> 1;
+    if (code & 1) delta += step >> 2;
+
+    int32_t p = (code & 8) ? *predictor - delta : *predictor + delta;
+    if (p > 32767) p = 32767;
+    if (p < -32768) p = -32768;
+    *predictor = p;
+
+    int32_t i = *index + s_index_table[code];
+    if (i < 0) i = 0;
+    if (i > 88) i = 88;
+    *index = i;
+    return p;
+}
+
+size_t IRAM_ATTR audio_adpcm_decode_block(const uint8_t *block, size_t block_size, int channels,
+                                          int16_t *out, int out_channels, size_t max_frames)
+{
+    size_t frames = AUDIO_ADPCM_SAMPLES_PER_BLOCK(block_size);
+    if (frames > max_frames) {
+        frames = max_frames;
+    }
+
+    for (int ch = 0; ch < channels; ch++) {
+        const uint8_t *src = block + ch * block_size;
+        int32_t predictor = (int16_t)(src[0] | (src[1] << 8));
+        int32_t index = src[2] > 88 ? 88 : src[2];
+        const uint8_t *data = src + 4;
+
+        // 单声道存储时, 最后一个存储通道负责填充剩余的输出通道
+        int fill = (ch == channels - 1) ? out_channels - ch : 1;
+        int16_t *dst = out + ch;
+
+        for (size_t n = 0; n < frames; n++) {
+            int16_t sample;
+            if (n == 0) {
+                sample = (int16_t)predictor;
+            } else {
+                uint8_t byte = data[(n - 1) >> 1];
+                uint8_t code = ((n - 1) & 1) ? (byte >> 4) : (byte & 0x0F);
+                sample = (int16_t)adpcm_step(code, &predictor, &index);
+            }
+            for (int k = 0; k < fill; k++) {
+                dst[k] = sample;
+            }
+            dst += out_channels;
+        }
+    }
+    return frames;
+}
+
+void audio_adpcm_encode_block(const int16_t *in, size_t frames, int channels,
+                              uint8_t *block, size_t block_size, uint8_t *index_state)
+{
+    const size_t block_frames = AUDIO_ADPCM_SAMPLES_PER_BLOCK(block_size);
+    if (frames == 0) {
+        memset(block, 0, block_size * channels);
+        return;
+    }
+
+    for (int ch = 0; ch < channels; ch++) {
+        uint8_t *dst = block + ch * block_size;
+        int32_t predictor = in[ch];
+        int32_t index = index_state[ch] > 88 ? 88 : index_state[ch];
+        dst[0] = (uint8_t)(predictor & 0xFF);
+        dst[1] = (uint8_t)((predictor >> 8) & 0xFF);
+        dst[2] = (uint8_t)index;
+        dst[3] = 0;
+        uint8_t *data = dst + 4;
+
+        for (size_t n = 1; n < block_frames; n++) {
+            // 不足一个块时重复最后一帧
+            int32_t sample = in[(n < frames ? n : frames - 1) * channels + ch];
+            int32_t diff = sample - predictor;
+            int32_t step = s_step_table[index];
+            uint8_t code = 0;
+            if (diff < 0) {
+                code = 8;
+                diff = -diff;
+            }
+            if (diff >= step) {
+                code |= 4;
+                diff -= step;
+            }
+            if (diff >= step >> 1) {
+                code |= 2;
+                diff -= step >> 1;
+            }
+            if (diff >= step >> 2) {
+                code |= 1;
+            }
+            // 与解码器相同的重建, 保证编解码两端预测值一致
+            adpcm_step(code, &predictor, &index);
+
+            size_t pos = (n - 1) >> 1;
+            if ((n - 1) & 1) {
+                data[pos] |= (uint8_t)(code << 4);
+            } else {
+                data[pos] = code;
+            }
+        }
+        index_state[ch] = (uint8_t)index;
+    }
+}
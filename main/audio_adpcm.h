@@ -0,0 +1,53 @@
+/**
+ * @file audio_adpcm.h
+ * @brief IMA ADPCM 块编解码
+ * @details 块格式与 tools/gen_audio_assets.py 一致: 每通道子块 = 4 字节块头
+ *          (int16 首样本, uint8 步长索引, uint8 保留) + 压缩数据 (低半字节在前).
+ *          多通道时各通道子块依次存放.
+ */
+
+#ifndef _AUDIO_ADPCM_H_
+#define _AUDIO_ADPCM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 每通道子块包含的样本数 */
+#define AUDIO_ADPCM_SAMPLES_PER_BLOCK(block_size) (1 + ((block_size) - 4) * 2)
+
+/**
+ * @brief 解码一个 ADPCM 块
+ * @param block 块数据 (channels 个子块)
+ * @param block_size 每通道子块字节数
+ * @param channels 存储通道数
+ * @param[out] out 输出 PCM, 按 out_channels 交织; 存储为单声道而输出多通道时复制到各通道
+ * @param out_channels 输出通道数 (>= channels)
+ * @param max_frames 最多输出的帧数 (用于最后一个不完整的块)
+ * @return 实际输出的帧数
+ */
+size_t audio_adpcm_decode_block(const uint8_t *block, size_t block_size, int channels,
+                                int16_t *out, int out_channels, size_t max_frames);
+
+/**
+ * @brief 编码一个 ADPCM 块
+ * @details 每通道的步长索引跨块延续 (保存在 index_state 中), 块头首样本即该块第一帧.
+ *          不足一个块的帧数时以最后一帧补齐, 解码时用 max_frames 截断
+ * @param in 输入 PCM, 按 channels 交织
+ * @param frames 输入帧数 (不超过 AUDIO_ADPCM_SAMPLES_PER_BLOCK(block_size))
+ * @param channels 通道数
+ * @param[out] block 输出块 (channels 个子块, 共 channels * block_size 字节)
+ * @param block_size 每通道子块字节数
+ * @param[in,out] index_state 每通道步长索引, 首块前清零
+ */
+void audio_adpcm_encode_block(const int16_t *in, size_t frames, int channels,
+                              uint8_t *block, size_t block_size, uint8_t *index_state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_ADPCM_H_ */
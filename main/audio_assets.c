@@ -0,0 +1,675 @@
+/**
+ * @file audio_assets.c
+ * @brief 提示音资源注册表
+ */
+
+#include "audio_assets.h"
+#include "audio_adpcm.h"
+#include "audio_pool.h"
+#include "board.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_http_client.h"
+#include "esp_rom_crc.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "ASSETS";
+
+/* 资源格式与 I2S 配置是否一致在加载分区时检查 (分区可以单独更新), 这里只检查解码缓冲区 */
+_Static_assert(AUDIO_ADPCM_SAMPLES_PER_BLOCK(AUDIO_ASSETS_ADPCM_BLOCK_SIZE) * BOARD_AUDIO_PLAYBACK_CHANNELS *
+               sizeof(int16_t) <= BOARD_AUDIO_POOL_DMA_BLOCK_SIZE, "ADPCM 解码块超过缓冲区池暂存块大小");
+
+#define AUDIO_ASSETS_MAGIC          0x54455341  // 'ASET'
+#define AUDIO_ASSETS_VERSION        1
+#define AUDIO_ASSETS_MAX_COUNT      64          // 注册表容量, 保证头部和索引落在第一个扇区内
+#define AUDIO_ASSETS_MAX_ID         255
+#define AUDIO_ASSETS_SECTOR_SIZE    4096
+#define AUDIO_ASSETS_HTTP_BUF_SIZE  4096
+#define AUDIO_ASSETS_UPDATE_WAIT_MS 30000       // 开始更新前等待正在进行的播放结束的最长时间
+
+/* 分区镜像格式, 与 tools/gen_audio_assets.py 一致 */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t sample_rate;
+    uint8_t channels;
+    uint8_t bit_width;
+    uint16_t adpcm_block_size;
+    uint32_t data_size;
+    uint32_t data_crc32;
+    uint32_t index_crc32;
+    uint32_t reserved;
+} audio_assets_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t id;
+    uint8_t codec;
+    uint8_t channels;
+    char name[AUDIO_ASSETS_NAME_LEN];
+    uint32_t offset;
+    uint32_t size;
+    uint32_t frames;
+    uint32_t duration_ms;
+} audio_assets_entry_t;
+
+_Static_assert(sizeof(audio_assets_header_t) == 32, "分区头部格式错误");
+_Static_assert(sizeof(audio_assets_entry_t) == 44, "分区索引格式错误");
+_Static_assert(sizeof(audio_assets_header_t) + AUDIO_ASSETS_MAX_COUNT * sizeof(audio_assets_entry_t)
+               <= AUDIO_ASSETS_SECTOR_SIZE, "索引必须落在第一个扇区内");
+_Static_assert(AUDIO_ASSETS_MAX_COUNT <= INT16_MAX, "s_asset_index 的 int16_t 存不下注册表下标");
+_Static_assert(AUDIO_ASSETS_MAX_ID <= UINT16_MAX, "资源 ID 超出索引条目的 uint16_t");
+
+/* 注册表 (s_lock 保护, 更新时清空并重新加载; 查找返回副本) */
+static const esp_partition_t *s_partition = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static audio_asset_t s_assets[AUDIO_ASSETS_MAX_COUNT];     // 按名称排序
+static int16_t s_asset_index[AUDIO_ASSETS_MAX_ID + 1];      // ID -> s_assets 下标
+static int s_asset_count = 0;
+static uint32_t s_generation = 0;                           // 每次清空注册表加 1, 见 audio_asset_t::generation
+static int s_playing = 0;                                   // 正在读取分区数据的播放数, 更新前等待归零
+
+/* 更新状态 */
+static struct {
+    bool active;
+    uint8_t *head;          // 第一个扇区 (头部 + 索引), 校验通过后最后写入
+    size_t limit;           // 镜像大小上限
+    size_t written;         // 已写入字节数
+    size_t erased;          // 已擦除到的偏移
+} s_update;
+
+static int asset_name_cmp(const void *a, const void *b)
+{
+    return strcmp(((const audio_asset_t *)a)->name, ((const audio_asset_t *)b)->name);
+}
+
+static void audio_assets_clear(void)
+{
+    s_asset_count = 0;
+    s_generation++;
+    memset(s_asset_index, 0xFF, sizeof(s_asset_index));
+}
+
+/**
+ * @brief 从分区头部和索引构建注册表 (调用者持有 s_lock)
+ * @note 只校验头部和索引, 不读取资源数据, 启动耗时与资源大小无关
+ */
+static esp_err_t audio_assets_load_index(void)
+{
+    audio_assets_header_t header;
+    audio_assets_clear();
+
+    esp_err_t ret = esp_partition_read(s_partition, 0, &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (header.magic != AUDIO_ASSETS_MAGIC) {
+        ESP_LOGW(TAG, "assets 分区为空或未烧录");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (header.version != AUDIO_ASSETS_VERSION || header.count > AUDIO_ASSETS_MAX_COUNT) {
+        ESP_LOGE(TAG, "不支持的 assets 分区版本 %d (%d 个资源)", header.version, header.count);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header.sample_rate != BOARD_AUDIO_SAMPLE_RATE || header.channels != BOARD_AUDIO_PLAYBACK_CHANNELS ||
+        header.bit_width != BOARD_AUDIO_PLAYBACK_BIT_WIDTH || header.adpcm_block_size != AUDIO_ASSETS_ADPCM_BLOCK_SIZE) {
+        ESP_LOGE(TAG, "assets 分区格式 (%u Hz x%d, %d 位) 与 I2S 配置不一致",
+                 (unsigned int)header.sample_rate, header.channels, header.bit_width);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    size_t index_size = header.count * sizeof(audio_assets_entry_t);
+    size_t data_start = (sizeof(header) + index_size + 3) & ~3;
+    uint8_t *index = malloc(data_start - sizeof(header));
+    if (index == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ret = esp_partition_read(s_partition, sizeof(header), index, data_start - sizeof(header));
+    if (ret == ESP_OK && esp_rom_crc32_le(0, index, data_start - sizeof(header)) != header.index_crc32) {
+        ESP_LOGE(TAG, "assets 分区索引校验失败");
+        ret = ESP_ERR_INVALID_CRC;
+    }
+
+    for (int i = 0; ret == ESP_OK && i < header.count; i++) {
+        const audio_assets_entry_t *e = (const audio_assets_entry_t *)(index + i * sizeof(audio_assets_entry_t));
+        if (e->id > AUDIO_ASSETS_MAX_ID || e->offset + e->size > s_partition->size) {
+            ESP_LOGW(TAG, "跳过无效资源条目 %d", e->id);
+            continue;
+        }
+        audio_asset_t *a = &s_assets[s_asset_count++];
+        a->id = e->id;
+        memcpy(a->name, e->name, AUDIO_ASSETS_NAME_LEN);
+        a->name[AUDIO_ASSETS_NAME_LEN - 1] = '\0';
+        a->offset = e->offset;
+        a->size = e->size;
+        a->codec = (audio_asset_codec_t)e->codec;
+        a->sample_rate = header.sample_rate;
+        a->channels = e->channels;
+        a->frames = e->frames;
+        a->duration_ms = e->duration_ms;
+        a->generation = s_generation;
+    }
+    free(index);
+    if (ret != ESP_OK) {
+        audio_assets_clear();
+        return ret;
+    }
+
+    qsort(s_assets, s_asset_count, sizeof(audio_asset_t), asset_name_cmp);
+    for (int i = 0; i < s_asset_count; i++) {
+        s_asset_index[s_assets[i].id] = i;
+    }
+
+    ESP_LOGI(TAG, "已加载 %d 个提示音资源 (数据 %u 字节)", s_asset_count, (unsigned int)header.data_size);
+    return ESP_OK;
+}
+
+esp_err_t audio_assets_init(void)
+{
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+        if (s_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        audio_assets_clear();
+    }
+
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, AUDIO_ASSETS_PARTITION_SUBTYPE,
+                                           AUDIO_ASSETS_PARTITION_LABEL);
+    if (s_partition == NULL) {
+        ESP_LOGE(TAG, "未找到 assets 分区, 请检查分区表");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t ret = audio_assets_load_index();
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+/* 按 ID 查找 (调用者持有 s_lock) */
+static const audio_asset_t *audio_assets_lookup_id(int id)
+{
+    if (id < 0 || id > AUDIO_ASSETS_MAX_ID || s_asset_index[id] < 0) {
+        return NULL;
+    }
+    return &s_assets[s_asset_index[id]];
+}
+
+/* 按名称查找 (调用者持有 s_lock) */
+static const audio_asset_t *audio_assets_lookup_name(const char *name)
+{
+    // 表按名称排序, 二分查找
+    int lo = 0;
+    int hi = s_asset_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(name, s_assets[mid].name);
+        if (cmp == 0) {
+            return &s_assets[mid];
+        }
+        if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t audio_assets_get(int id, audio_asset_t *asset)
+{
+    if (asset == NULL || s_lock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const audio_asset_t *found = audio_assets_lookup_id(id);
+    if (found != NULL) {
+        *asset = *found;
+    }
+    xSemaphoreGive(s_lock);
+    return found != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t audio_assets_find(const char *name, audio_asset_t *asset)
+{
+    if (name == NULL || asset == NULL || s_lock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const audio_asset_t *found = audio_assets_lookup_name(name);
+    if (found != NULL) {
+        *asset = *found;
+    }
+    xSemaphoreGive(s_lock);
+    return found != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 流式播放 PCM 资源
+ * @details 按块从映射的分区顺序复制到内部 RAM 暂存缓冲区再写入 I2S
+ */
+static esp_err_t audio_assets_play_pcm(i2s_chan_handle_t tx_handle, const audio_asset_t *asset, const uint8_t *data)
+{
+    uint8_t *staging = audio_pool_dma_alloc();
+    if (staging == NULL) {
+        ESP_LOGE(TAG, "分配暂存缓冲区失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    bool started = false;
+    for (size_t offset = 0; offset < asset->size; ) {
+        size_t chunk = asset->size - offset;
+        if (chunk > BOARD_AUDIO_PLAY_CHUNK_SIZE) {
+            chunk = BOARD_AUDIO_PLAY_CHUNK_SIZE;
+        }
+        memcpy(staging, data + offset, chunk);
+        offset += chunk;
+
+        size_t loaded = 0;
+        if (!started) {
+            ret = board_audio_stream_begin(tx_handle, staging, chunk, &loaded);
+            if (ret != ESP_OK) {
+                break;
+            }
+            started = true;
+        }
+        ret = board_audio_stream_write(tx_handle, staging + loaded, chunk - loaded, UINT32_MAX);
+        if (ret != ESP_OK) {
+            break;
+        }
+    }
+
+    if (started) {
+        board_audio_stream_end(tx_handle);
+    }
+    audio_pool_dma_free(staging);
+    return ret;
+}
+
+/**
+ * @brief 流式解码播放 ADPCM 资源
+ * @details 每次解码一个块到内部 RAM 缓冲区再写入 I2S, 闪存只按压缩后的数据量顺序读取
+ */
+static esp_err_t audio_assets_play_adpcm(i2s_chan_handle_t tx_handle, const audio_asset_t *asset, const uint8_t *data)
+{
+    const size_t block_bytes = AUDIO_ASSETS_ADPCM_BLOCK_SIZE * asset->channels;
+    const size_t block_frames = AUDIO_ADPCM_SAMPLES_PER_BLOCK(AUDIO_ASSETS_ADPCM_BLOCK_SIZE);
+    const size_t frame_bytes = BOARD_AUDIO_PLAYBACK_CHANNELS * sizeof(int16_t);
+
+    int16_t *pcm = audio_pool_dma_alloc();
+    if (pcm == NULL) {
+        ESP_LOGE(TAG, "分配解码缓冲区失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    const uint8_t *block = data;
+    size_t frames_left = asset->frames;
+    int64_t decode_us = 0;
+    bool started = false;
+
+    while (frames_left > 0 && block + block_bytes <= data + asset->size) {
+        int64_t t0 = esp_timer_get_time();
+        size_t frames = audio_adpcm_decode_block(block, AUDIO_ASSETS_ADPCM_BLOCK_SIZE, asset->channels,
+                                                 pcm, BOARD_AUDIO_PLAYBACK_CHANNELS, frames_left);
+        decode_us += esp_timer_get_time() - t0;
+        block += block_bytes;
+        frames_left -= frames;
+
+        size_t bytes = frames * frame_bytes;
+        size_t loaded = 0;
+        if (!started) {
+            // 首个块用于预加载, 启用通道后不会先输出空白
+            ret = board_audio_stream_begin(tx_handle, (const uint8_t *)pcm, bytes, &loaded);
+            if (ret != ESP_OK) {
+                break;
+            }
+            started = true;
+        }
+        ret = board_audio_stream_write(tx_handle, (const uint8_t *)pcm + loaded, bytes - loaded, UINT32_MAX);
+        if (ret != ESP_OK) {
+            break;
+        }
+    }
+
+    if (started) {
+        board_audio_stream_end(tx_handle);
+    }
+    audio_pool_dma_free(pcm);
+
+    // 解码耗时占音频时长的比例
+    uint32_t load_permille = asset->duration_ms ? (uint32_t)(decode_us / asset->duration_ms) : 0;
+    ESP_LOGI(TAG, "ADPCM 解码耗时 %lld 微秒, CPU 占用 %u.%u%%",
+             (long long)decode_us, (unsigned int)(load_permille / 10), (unsigned int)(load_permille % 10));
+    if (load_permille > CONFIG_AUDIO_ASSETS_DECODE_BUDGET_PCT * 10) {
+        ESP_LOGW(TAG, "ADPCM 解码超出 CPU 预算 (%d%%)", CONFIG_AUDIO_ASSETS_DECODE_BUDGET_PCT);
+    }
+    return ret;
+}
+
+esp_err_t audio_assets_play(i2s_chan_handle_t tx_handle, const audio_asset_t *asset)
+{
+    if (tx_handle == NULL || asset == NULL || s_partition == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 先占用播放通道, 切换采样率之后其他任务不能再改动时钟; 其他播放进行中时直接返回
+    esp_err_t ret = board_audio_playback_acquire();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 只在检查时持有锁; 播放期间持有引用 (s_playing), 分区更新等待引用归零后才擦除
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_update.active) {
+        xSemaphoreGive(s_lock);
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 副本取得之后分区可能已更新, 数据位置可能已经变了
+    if (asset->generation != s_generation) {
+        ESP_LOGW(TAG, "提示音 %d (%s) 已随资源分区更新, 请重新查找", asset->id, asset->name);
+        xSemaphoreGive(s_lock);
+        board_audio_playback_release();
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_playing++;
+    xSemaphoreGive(s_lock);
+
+    // 提示音按编译时采样率生成, 时钟域已切换到其他采样率时先切回
+    ret = board_audio_set_sample_rate(asset->sample_rate);
+    if (ret != ESP_OK) {
+        goto done;
+    }
+
+    ESP_LOGI(TAG, "播放提示音 %d (%s): %u 字节, %u Hz x%d, %u 毫秒",
+             asset->id, asset->name, (unsigned int)asset->size,
+             (unsigned int)asset->sample_rate, asset->channels, (unsigned int)asset->duration_ms);
+
+    const void *data = NULL;
+    esp_partition_mmap_handle_t mmap_handle;
+    ret = esp_partition_mmap(s_partition, asset->offset, asset->size,
+                                       ESP_PARTITION_MMAP_DATA, &data, &mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "映射资源数据失败: %s", esp_err_to_name(ret));
+        goto done;
+    }
+
+    if (asset->codec == AUDIO_ASSET_CODEC_IMA_ADPCM) {
+        ret = audio_assets_play_adpcm(tx_handle, asset, data);
+    } else {
+        ret = audio_assets_play_pcm(tx_handle, asset, data);
+    }
+    esp_partition_munmap(mmap_handle);
+
+done:
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_playing--;
+    xSemaphoreGive(s_lock);
+    board_audio_playback_release();
+    return ret;
+}
+
+/**************************** 分区更新 ****************************/
+
+esp_err_t audio_assets_update_begin(size_t image_size)
+{
+    if (s_partition == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (image_size > s_partition->size) {
+        ESP_LOGE(TAG, "镜像大小 %u 超出 assets 分区大小 %u",
+                 (unsigned int)image_size, (unsigned int)s_partition->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_update.active) {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 先标记为更新中, 新的播放请求不再开始; 等正在播放的资源读完再擦除
+    s_update.active = true;
+    uint32_t waited = 0;
+    while (s_playing > 0 && waited < AUDIO_ASSETS_UPDATE_WAIT_MS) {
+        xSemaphoreGive(s_lock);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        waited += 10;
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+    }
+    if (s_playing > 0) {
+        ESP_LOGE(TAG, "等待提示音播放结束超时, 取消更新");
+        s_update.active = false;
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    s_update.head = heap_caps_malloc(AUDIO_ASSETS_SECTOR_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s_update.head == NULL) {
+        s_update.active = false;
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    memset(s_update.head, 0xFF, AUDIO_ASSETS_SECTOR_SIZE);
+
+    // 先擦除头部扇区, 使旧镜像立即失效
+    esp_err_t ret = esp_partition_erase_range(s_partition, 0, AUDIO_ASSETS_SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        heap_caps_free(s_update.head);
+        s_update.head = NULL;
+        s_update.active = false;
+        xSemaphoreGive(s_lock);
+        return ret;
+    }
+
+    audio_assets_clear();
+    s_update.limit = image_size ? image_size : s_partition->size;
+    s_update.written = 0;
+    s_update.erased = AUDIO_ASSETS_SECTOR_SIZE;
+    xSemaphoreGive(s_lock);
+
+    ESP_LOGI(TAG, "开始更新 assets 分区, 镜像大小: %u 字节", (unsigned int)image_size);
+    return ESP_OK;
+}
+
+esp_err_t audio_assets_update_write(const void *data, size_t len)
+{
+    if (!s_update.active || (data == NULL && len > 0)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_update.written + len > s_update.limit) {
+        ESP_LOGE(TAG, "更新数据超出镜像大小");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t *src = data;
+
+    // 头部扇区先缓存在内存中
+    if (s_update.written < AUDIO_ASSETS_SECTOR_SIZE) {
+        size_t n = AUDIO_ASSETS_SECTOR_SIZE - s_update.written;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(s_update.head + s_update.written, src, n);
+        s_update.written += n;
+        src += n;
+        len -= n;
+    }
+    if (len == 0) {
+        return ESP_OK;
+    }
+
+    // 按需擦除后续扇区
+    size_t end = s_update.written + len;
+    if (end > s_update.erased) {
+        size_t erase_end = (end + AUDIO_ASSETS_SECTOR_SIZE - 1) & ~(AUDIO_ASSETS_SECTOR_SIZE - 1);
+        esp_err_t ret = esp_partition_erase_range(s_partition, s_update.erased, erase_end - s_update.erased);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "擦除 assets 分区失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        s_update.erased = erase_end;
+    }
+
+    esp_err_t ret = esp_partition_write(s_partition, s_update.written, src, len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "写入 assets 分区失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    s_update.written += len;
+    return ESP_OK;
+}
+
+/**
+ * @brief 校验已写入的镜像 (头部仍在内存中)
+ */
+static esp_err_t audio_assets_update_verify(size_t *head_len)
+{
+    const audio_assets_header_t *header = (const audio_assets_header_t *)s_update.head;
+    if (s_update.written < sizeof(*header) || header->magic != AUDIO_ASSETS_MAGIC ||
+        header->version != AUDIO_ASSETS_VERSION || header->count > AUDIO_ASSETS_MAX_COUNT) {
+        ESP_LOGE(TAG, "镜像头部无效");
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    size_t data_start = (sizeof(*header) + header->count * sizeof(audio_assets_entry_t) + 3) & ~3;
+    size_t total = data_start + header->data_size;
+    if (s_update.written != total) {
+        ESP_LOGE(TAG, "镜像长度不符: 已接收 %u 字节, 应为 %u 字节",
+                 (unsigned int)s_update.written, (unsigned int)total);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (esp_rom_crc32_le(0, s_update.head + sizeof(*header), data_start - sizeof(*header)) != header->index_crc32) {
+        ESP_LOGE(TAG, "镜像索引校验失败");
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    // 数据校验: 头部扇区内的部分在内存中, 其余部分映射分区读取
+    *head_len = total < AUDIO_ASSETS_SECTOR_SIZE ? total : AUDIO_ASSETS_SECTOR_SIZE;
+    uint32_t crc = esp_rom_crc32_le(0, s_update.head + data_start, *head_len - data_start);
+    if (total > AUDIO_ASSETS_SECTOR_SIZE) {
+        const void *rest = NULL;
+        esp_partition_mmap_handle_t mmap_handle;
+        esp_err_t ret = esp_partition_mmap(s_partition, AUDIO_ASSETS_SECTOR_SIZE, total - AUDIO_ASSETS_SECTOR_SIZE,
+                                           ESP_PARTITION_MMAP_DATA, &rest, &mmap_handle);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        crc = esp_rom_crc32_le(crc, rest, total - AUDIO_ASSETS_SECTOR_SIZE);
+        esp_partition_munmap(mmap_handle);
+    }
+    if (crc != header->data_crc32) {
+        ESP_LOGE(TAG, "镜像数据校验失败");
+        return ESP_ERR_INVALID_CRC;
+    }
+    return ESP_OK;
+}
+
+esp_err_t audio_assets_update_end(void)
+{
+    if (!s_update.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    size_t head_len = 0;
+    esp_err_t ret = audio_assets_update_verify(&head_len);
+    if (ret == ESP_OK) {
+        // 校验通过后最后写入头部扇区, 镜像才会生效
+        ret = esp_partition_write(s_partition, 0, s_update.head, head_len);
+    }
+    if (ret == ESP_OK) {
+        ret = audio_assets_load_index();
+    }
+
+    heap_caps_free(s_update.head);
+    s_update.head = NULL;
+    s_update.active = false;
+    xSemaphoreGive(s_lock);
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "assets 分区更新完成");
+    } else {
+        ESP_LOGE(TAG, "assets 分区更新失败: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void audio_assets_update_abort(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_update.active) {
+        heap_caps_free(s_update.head);
+        s_update.head = NULL;
+        s_update.active = false;
+        ESP_LOGW(TAG, "assets 分区更新已取消, 分区需重新下载");
+    }
+    xSemaphoreGive(s_lock);
+}
+
+esp_err_t audio_assets_update_from_url(const char *url)
+{
+    if (url == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .timeout_ms = BOARD_WS_NETWORK_TIMEOUT_MS,
+        .buffer_size = AUDIO_ASSETS_HTTP_BUF_SIZE,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client == NULL) {
+        return ESP_FAIL;
+    }
+
+    uint8_t *buf = malloc(AUDIO_ASSETS_HTTP_BUF_SIZE);
+    esp_err_t ret = buf ? esp_http_client_open(client, 0) : ESP_ERR_NO_MEM;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "打开 %s 失败: %s", url, esp_err_to_name(ret));
+        goto cleanup;
+    }
+
+    int64_t content_length = esp_http_client_fetch_headers(client);
+    int status = esp_http_client_get_status_code(client);
+    if (status != 200 || content_length < 0) {
+        ESP_LOGE(TAG, "下载 assets 镜像失败, HTTP 状态码: %d", status);
+        ret = ESP_ERR_INVALID_RESPONSE;
+        goto cleanup;
+    }
+
+    ret = audio_assets_update_begin((size_t)content_length);
+    if (ret != ESP_OK) {
+        goto cleanup;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    while (ret == ESP_OK) {
+        int len = esp_http_client_read(client, (char *)buf, AUDIO_ASSETS_HTTP_BUF_SIZE);
+        if (len < 0) {
+            ret = ESP_FAIL;
+        } else if (len == 0) {
+            break;
+        } else {
+            ret = audio_assets_update_write(buf, len);
+        }
+    }
+
+    if (ret == ESP_OK) {
+        ret = audio_assets_update_end();
+        int64_t elapsed_ms = (esp_timer_get_time() - start_us) / 1000;
+        ESP_LOGI(TAG, "下载 %lld 字节, 耗时 %lld 毫秒", (long long)content_length, (long long)elapsed_ms);
+    } else {
+        audio_assets_update_abort();
+    }
+
+cleanup:
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    free(buf);
+    return ret;
+}
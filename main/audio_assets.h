@@ -0,0 +1,131 @@
+/**
+ * @file audio_assets.h
+ * @brief 提示音资源注册表
+ * @details 提示音源文件放在 main/assets 目录, 由 tools/gen_audio_assets.py 在编译时
+ *          转换为设备原生格式并打包为 assets 分区镜像. 新增提示音只需放入文件并在
+ *          manifest.csv 中登记, 无需修改 CMakeLists.txt 或代码.
+ *
+ *          资源存放在独立的 assets 数据分区, 启动时只读取索引, 播放时通过
+ *          esp_partition_mmap 映射. 分区可以单独烧录 (parttool.py) 或通过
+ *          audio_assets_update_*() 流式下载更新, 无需重新烧录应用.
+ */
+
+#ifndef _AUDIO_ASSETS_H_
+#define _AUDIO_ASSETS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2s_std.h"
+#include "audio_assets_gen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_ASSETS_PARTITION_LABEL   "assets"   // 分区名称
+#define AUDIO_ASSETS_PARTITION_SUBTYPE 0x40       // 分区子类型 (自定义数据分区)
+#define AUDIO_ASSETS_NAME_LEN          24         // 资源名称最大长度 (含结尾 0)
+
+/**
+ * @brief 提示音存储格式
+ */
+typedef enum {
+    AUDIO_ASSET_CODEC_PCM = 0,      // 16 位交织 PCM
+    AUDIO_ASSET_CODEC_IMA_ADPCM,    // IMA ADPCM, 块大小 AUDIO_ASSETS_ADPCM_BLOCK_SIZE
+} audio_asset_codec_t;
+
+/**
+ * @brief 提示音资源描述
+ */
+typedef struct {
+    uint16_t id;                          // 数字 ID
+    char name[AUDIO_ASSETS_NAME_LEN];     // 字符串名称
+    uint32_t offset;                      // 数据在 assets 分区内的偏移
+    uint32_t size;                        // 存储数据大小 (字节)
+    audio_asset_codec_t codec;            // 存储格式
+    uint32_t sample_rate;                 // 采样率 (Hz)
+    uint8_t channels;                     // 存储通道数 (单声道资源播放时复制到所有 I2S 通道)
+    uint32_t frames;                      // 帧数
+    uint32_t duration_ms;                 // 时长 (毫秒)
+    uint32_t generation;                  // 注册表版本, 分区更新后变化, 播放时据此判断副本是否过期
+} audio_asset_t;
+
+/**
+ * @brief 加载 assets 分区索引
+ * @details 只读取分区头部和索引, 耗时与资源大小无关. 分区无效时注册表为空, 播放请求返回 ESP_ERR_NOT_FOUND.
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_FOUND 未找到分区, ESP_ERR_INVALID_CRC/ESP_ERR_INVALID_VERSION 分区内容无效
+ */
+esp_err_t audio_assets_init(void);
+
+/**
+ * @brief 根据数字 ID 查找提示音 (O(1))
+ * @details 持有注册表锁复制资源描述, 不会读到更新中的注册表
+ * @param id 资源 ID
+ * @param[out] asset 资源描述的副本
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_FOUND 未找到, ESP_ERR_INVALID_ARG 参数无效或未初始化
+ */
+esp_err_t audio_assets_get(int id, audio_asset_t *asset);
+
+/**
+ * @brief 根据名称查找提示音
+ * @details 持有注册表锁复制资源描述, 不会读到更新中的注册表
+ * @param name 资源名称
+ * @param[out] asset 资源描述的副本
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_FOUND 未找到, ESP_ERR_INVALID_ARG 参数无效或未初始化
+ */
+esp_err_t audio_assets_find(const char *name, audio_asset_t *asset);
+
+/**
+ * @brief 播放提示音
+ * @details 映射分区中的资源数据, 按块解码 (ADPCM) 或复制 (PCM) 到内部 RAM 缓冲区后写入 I2S.
+ *          查找之后分区已更新 (副本的 generation 过期) 时不播放, 返回 ESP_ERR_NOT_FOUND.
+ *          播放期间不持有注册表锁, 查找和其他注册表操作不等待播放结束
+ * @param tx_handle I2S 发送通道句柄
+ * @param asset audio_assets_get()/audio_assets_find() 返回的资源描述
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 分区更新中或音频通道忙, 其他失败
+ */
+esp_err_t audio_assets_play(i2s_chan_handle_t tx_handle, const audio_asset_t *asset);
+
+/**
+ * @brief 开始更新 assets 分区
+ * @details 更新期间注册表清空, 新镜像头部在 audio_assets_update_end() 校验通过后最后写入,
+ *          中途断电只会导致分区无效, 不会加载到不完整的资源. 正在播放提示音时等待其结束后再擦除 (最多 30 秒),
+ *          等待期间新的播放请求返回 ESP_ERR_INVALID_STATE.
+ * @param image_size 镜像总大小 (字节), 0 表示未知 (以分区大小为上限)
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_SIZE 超出分区大小, ESP_ERR_INVALID_STATE 已在更新中,
+ *         ESP_ERR_TIMEOUT 播放未在等待时间内结束
+ */
+esp_err_t audio_assets_update_begin(size_t image_size);
+
+/**
+ * @brief 写入更新数据 (按顺序)
+ * @param data 数据
+ * @param len 数据长度
+ * @return esp_err_t ESP_OK 成功, 其他失败
+ */
+esp_err_t audio_assets_update_write(const void *data, size_t len);
+
+/**
+ * @brief 完成更新: 校验镜像, 写入头部并重新加载索引
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_CRC 等表示镜像无效
+ */
+esp_err_t audio_assets_update_end(void);
+
+/**
+ * @brief 放弃更新
+ */
+void audio_assets_update_abort(void);
+
+/**
+ * @brief 从 HTTP(S) 地址流式下载并更新 assets 分区
+ * @param url 镜像地址 (编译输出的 audio_assets.bin)
+ * @return esp_err_t ESP_OK 成功, 其他失败
+ */
+esp_err_t audio_assets_update_from_url(const char *url);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_ASSETS_H_ */
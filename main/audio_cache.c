@@ -0,0 +1,596 @@
+/**
+ * @file audio_cache.c
+ * @brief 服务器下发音频片段缓存
+ */
+
+#include <stdio.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "audio_cache.h"
+#include "audio_pool.h"
+#include "board.h"
+#include "esp_spiffs.h"
+#include "esp_http_client.h"
+#include "mbedtls/sha256.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "CACHE";
+
+#define AUDIO_CACHE_MAGIC           0x32484341  // 'ACH2', 文件头增加采样率后旧文件在扫描时删除
+#define AUDIO_CACHE_MAX_ENTRIES     64
+#define AUDIO_CACHE_PSRAM_BUDGET    (CONFIG_AUDIO_CACHE_PSRAM_KB * 1024)
+#define AUDIO_CACHE_FLASH_BUDGET    (CONFIG_AUDIO_CACHE_FLASH_KB * 1024)
+#define AUDIO_CACHE_MAX_CLIP_SIZE   (CONFIG_AUDIO_CACHE_MAX_CLIP_KB * 1024)
+#define AUDIO_CACHE_IO_CHUNK        4096
+#define AUDIO_CACHE_PATH_LEN        32
+
+_Static_assert(AUDIO_CACHE_IO_CHUNK <= BOARD_AUDIO_POOL_DMA_BLOCK_SIZE, "读取块超过缓冲区池暂存块大小");
+
+/* 闪存层文件头, 后接 PCM 数据 */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t seq;           // 写入时的 LRU 序号, 重启后用于恢复淘汰顺序
+    uint32_t sample_rate;   // 片段采样率 (Hz)
+    uint8_t hash[AUDIO_CACHE_HASH_LEN];
+} audio_cache_file_header_t;
+
+typedef struct {
+    bool used;
+    bool in_flash;          // 闪存层有副本
+    uint8_t hash[AUDIO_CACHE_HASH_LEN];
+    uint32_t size;          // PCM 数据大小
+    uint32_t sample_rate;   // 片段采样率 (Hz)
+    uint8_t *data;          // PSRAM 层副本, NULL 表示不在 PSRAM 层
+    uint32_t seq;           // 最近使用序号 (越大越新)
+    int refs;               // 正在播放/写入的引用数, 非 0 时不会被淘汰
+} audio_cache_entry_t;
+
+static audio_cache_entry_t s_entries[AUDIO_CACHE_MAX_ENTRIES];
+static SemaphoreHandle_t s_lock = NULL;
+static bool s_flash_ready = false;
+static uint32_t s_seq = 0;
+static audio_cache_stats_t s_stats;
+
+void audio_cache_hash_to_hex(const uint8_t *hash, char *hex)
+{
+    for (int i = 0; i < AUDIO_CACHE_HASH_LEN; i++) {
+        sprintf(hex + i * 2, "%02x", hash[i]);
+    }
+    hex[AUDIO_CACHE_HASH_HEX_LEN] = '\0';
+}
+
+esp_err_t audio_cache_hash_from_hex(const char *hex, uint8_t *hash)
+{
+    if (hex == NULL || strlen(hex) != AUDIO_CACHE_HASH_HEX_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < AUDIO_CACHE_HASH_LEN; i++) {
+        unsigned int byte;
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        hash[i] = (uint8_t)byte;
+    }
+    return ESP_OK;
+}
+
+/* 文件名取哈希前 8 字节, 满足 SPIFFS 文件名长度限制 */
+static void audio_cache_path(const uint8_t *hash, char *path)
+{
+    snprintf(path, AUDIO_CACHE_PATH_LEN, AUDIO_CACHE_BASE_PATH "/%02x%02x%02x%02x%02x%02x%02x%02x",
+             hash[0], hash[1], hash[2], hash[3], hash[4], hash[5], hash[6], hash[7]);
+}
+
+/* 以下函数调用者持有 s_lock */
+
+static audio_cache_entry_t *audio_cache_lookup(const uint8_t *hash)
+{
+    for (int i = 0; i < AUDIO_CACHE_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && memcmp(s_entries[i].hash, hash, AUDIO_CACHE_HASH_LEN) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void audio_cache_drop_if_empty(audio_cache_entry_t *e)
+{
+    if (e->data == NULL && !e->in_flash && e->refs == 0) {
+        e->used = false;
+        s_stats.entries--;
+    }
+}
+
+/**
+ * @brief 淘汰 PSRAM 层最久未使用的片段, 直到能容纳 size 字节
+ */
+static esp_err_t audio_cache_psram_reserve(size_t size)
+{
+    if (size > AUDIO_CACHE_PSRAM_BUDGET) {
+        return ESP_ERR_NO_MEM;
+    }
+    while (s_stats.psram_used + size > AUDIO_CACHE_PSRAM_BUDGET) {
+        audio_cache_entry_t *victim = NULL;
+        for (int i = 0; i < AUDIO_CACHE_MAX_ENTRIES; i++) {
+            audio_cache_entry_t *e = &s_entries[i];
+            if (e->used && e->data != NULL && e->refs == 0 && (victim == NULL || e->seq < victim->seq)) {
+                victim = e;
+            }
+        }
+        if (victim == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        heap_caps_free(victim->data);
+        victim->data = NULL;
+        s_stats.psram_used -= victim->size;
+        audio_cache_drop_if_empty(victim);
+    }
+    s_stats.psram_used += size;
+    return ESP_OK;
+}
+
+/**
+ * @brief 淘汰闪存层最久未使用的片段, 直到能容纳 size 字节
+ */
+static esp_err_t audio_cache_flash_reserve(size_t size)
+{
+    size = sizeof(audio_cache_file_header_t) + size;
+    if (size > AUDIO_CACHE_FLASH_BUDGET) {
+        return ESP_ERR_NO_MEM;
+    }
+    while (s_stats.flash_used + size > AUDIO_CACHE_FLASH_BUDGET) {
+        audio_cache_entry_t *victim = NULL;
+        for (int i = 0; i < AUDIO_CACHE_MAX_ENTRIES; i++) {
+            audio_cache_entry_t *e = &s_entries[i];
+            if (e->used && e->in_flash && e->refs == 0 && (victim == NULL || e->seq < victim->seq)) {
+                victim = e;
+            }
+        }
+        if (victim == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        char path[AUDIO_CACHE_PATH_LEN];
+        audio_cache_path(victim->hash, path);
+        unlink(path);
+        victim->in_flash = false;
+        s_stats.flash_used -= sizeof(audio_cache_file_header_t) + victim->size;
+        audio_cache_drop_if_empty(victim);
+    }
+    s_stats.flash_used += size;
+    return ESP_OK;
+}
+
+static audio_cache_entry_t *audio_cache_alloc_entry(void)
+{
+    for (int i = 0; i < AUDIO_CACHE_MAX_ENTRIES; i++) {
+        if (!s_entries[i].used) {
+            memset(&s_entries[i], 0, sizeof(audio_cache_entry_t));
+            s_entries[i].used = true;
+            s_stats.entries++;
+            return &s_entries[i];
+        }
+    }
+
+    // 表满时整体淘汰最久未使用的片段
+    audio_cache_entry_t *victim = NULL;
+    for (int i = 0; i < AUDIO_CACHE_MAX_ENTRIES; i++) {
+        audio_cache_entry_t *e = &s_entries[i];
+        if (e->refs == 0 && (victim == NULL || e->seq < victim->seq)) {
+            victim = e;
+        }
+    }
+    if (victim == NULL) {
+        return NULL;
+    }
+    if (victim->data != NULL) {
+        heap_caps_free(victim->data);
+        s_stats.psram_used -= victim->size;
+    }
+    if (victim->in_flash) {
+        char path[AUDIO_CACHE_PATH_LEN];
+        audio_cache_path(victim->hash, path);
+        unlink(path);
+        s_stats.flash_used -= sizeof(audio_cache_file_header_t) + victim->size;
+    }
+    memset(victim, 0, sizeof(audio_cache_entry_t));
+    victim->used = true;
+    return victim;
+}
+
+/**
+ * @brief 扫描闪存层已有的片段
+ */
+static void audio_cache_scan_flash(void)
+{
+    DIR *dir = opendir(AUDIO_CACHE_BASE_PATH);
+    if (dir == NULL) {
+        return;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        char path[AUDIO_CACHE_PATH_LEN + 16];
+        snprintf(path, sizeof(path), AUDIO_CACHE_BASE_PATH "/%s", ent->d_name);
+
+        audio_cache_file_header_t header;
+        struct stat st;
+        FILE *f = fopen(path, "rb");
+        bool valid = f != NULL && fread(&header, 1, sizeof(header), f) == sizeof(header) &&
+                     stat(path, &st) == 0 && header.magic == AUDIO_CACHE_MAGIC &&
+                     st.st_size == (off_t)(sizeof(header) + header.size);
+        if (f != NULL) {
+            fclose(f);
+        }
+
+        audio_cache_entry_t *e = valid ? audio_cache_alloc_entry() : NULL;
+        if (e == NULL) {
+            ESP_LOGW(TAG, "删除无效的缓存文件 %s", ent->d_name);
+            unlink(path);
+            continue;
+        }
+        memcpy(e->hash, header.hash, AUDIO_CACHE_HASH_LEN);
+        e->size = header.size;
+        e->sample_rate = header.sample_rate;
+        e->in_flash = true;
+        e->seq = header.seq;
+        s_stats.flash_used += sizeof(header) + header.size;
+        if (header.seq >= s_seq) {
+            s_seq = header.seq + 1;
+        }
+    }
+    closedir(dir);
+}
+
+esp_err_t audio_cache_init(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = AUDIO_CACHE_BASE_PATH,
+        .partition_label = AUDIO_CACHE_PARTITION_LABEL,
+        .max_files = 2,
+        .format_if_mount_failed = true,
+    };
+    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "挂载 cache 分区失败 (%s), 仅使用 PSRAM 缓存", esp_err_to_name(ret));
+        return ESP_OK;
+    }
+    s_flash_ready = true;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    audio_cache_scan_flash();
+    xSemaphoreGive(s_lock);
+
+    ESP_LOGI(TAG, "缓存初始化完成: 闪存中 %d 个片段 (%u 字节), PSRAM 预算 %d KB, 闪存预算 %d KB",
+             s_stats.entries, (unsigned int)s_stats.flash_used,
+             CONFIG_AUDIO_CACHE_PSRAM_KB, CONFIG_AUDIO_CACHE_FLASH_KB);
+    return ESP_OK;
+}
+
+bool audio_cache_contains(const uint8_t *hash)
+{
+    if (s_lock == NULL || hash == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool found = audio_cache_lookup(hash) != NULL;
+    xSemaphoreGive(s_lock);
+    return found;
+}
+
+/**
+ * @brief 将 PSRAM 中的片段写入闪存层
+ */
+static void audio_cache_persist(audio_cache_entry_t *e)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t ret = audio_cache_flash_reserve(e->size);
+    uint32_t seq = e->seq;
+    xSemaphoreGive(s_lock);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "闪存缓存空间不足, 片段只保存在 PSRAM");
+        return;
+    }
+
+    char path[AUDIO_CACHE_PATH_LEN];
+    audio_cache_path(e->hash, path);
+    audio_cache_file_header_t header = {
+        .magic = AUDIO_CACHE_MAGIC,
+        .size = e->size,
+        .seq = seq,
+        .sample_rate = e->sample_rate,
+    };
+    memcpy(header.hash, e->hash, AUDIO_CACHE_HASH_LEN);
+
+    FILE *f = fopen(path, "wb");
+    bool ok = f != NULL && fwrite(&header, 1, sizeof(header), f) == sizeof(header) &&
+              fwrite(e->data, 1, e->size, f) == e->size;
+    if (f != NULL) {
+        ok = (fclose(f) == 0) && ok;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (ok) {
+        e->in_flash = true;
+    } else {
+        ESP_LOGW(TAG, "写入缓存文件失败");
+        unlink(path);
+        s_stats.flash_used -= sizeof(header) + e->size;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+esp_err_t audio_cache_fetch(const char *url, const uint8_t *expected_hash, uint32_t sample_rate,
+                            uint8_t *hash, bool *cached)
+{
+    if (s_lock == NULL || url == NULL || hash == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sample_rate == 0) {
+        sample_rate = board_audio_get_sample_rate();
+    }
+    if (cached) {
+        *cached = false;
+    }
+
+    // 已知哈希且已缓存时不下载
+    if (expected_hash != NULL && audio_cache_contains(expected_hash)) {
+        memcpy(hash, expected_hash, AUDIO_CACHE_HASH_LEN);
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_stats.dedup_hits++;
+        xSemaphoreGive(s_lock);
+        if (cached) {
+            *cached = true;
+        }
+        return ESP_OK;
+    }
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .timeout_ms = BOARD_WS_NETWORK_TIMEOUT_MS,
+        .buffer_size = AUDIO_CACHE_IO_CHUNK,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client == NULL) {
+        return ESP_FAIL;
+    }
+
+    uint8_t *data = NULL;
+    bool reserved = false;
+    int64_t content_length = 0;
+    esp_err_t ret = esp_http_client_open(client, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "打开 %s 失败: %s", url, esp_err_to_name(ret));
+        goto cleanup;
+    }
+
+    content_length = esp_http_client_fetch_headers(client);
+    int status = esp_http_client_get_status_code(client);
+    if (status != 200 || content_length <= 0 || content_length > AUDIO_CACHE_MAX_CLIP_SIZE) {
+        ESP_LOGE(TAG, "下载片段失败, HTTP 状态码: %d, 长度: %lld", status, (long long)content_length);
+        ret = (status != 200) ? ESP_ERR_INVALID_RESPONSE : ESP_ERR_INVALID_SIZE;
+        goto cleanup;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    ret = audio_cache_psram_reserve((size_t)content_length);
+    xSemaphoreGive(s_lock);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "PSRAM 缓存空间不足");
+        goto cleanup;
+    }
+    reserved = true;
+
+    data = heap_caps_malloc((size_t)content_length, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (data == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    // 边下载边计算 SHA-256
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    size_t received = 0;
+    while (received < (size_t)content_length) {
+        int len = esp_http_client_read(client, (char *)data + received, (int)(content_length - received));
+        if (len <= 0) {
+            break;
+        }
+        mbedtls_sha256_update(&sha, data + received, len);
+        received += len;
+    }
+    mbedtls_sha256_finish(&sha, hash);
+    mbedtls_sha256_free(&sha);
+
+    if (received != (size_t)content_length) {
+        ESP_LOGE(TAG, "下载不完整: %u / %lld 字节", (unsigned int)received, (long long)content_length);
+        ret = ESP_FAIL;
+        goto cleanup;
+    }
+    if (expected_hash != NULL && memcmp(hash, expected_hash, AUDIO_CACHE_HASH_LEN) != 0) {
+        ESP_LOGE(TAG, "片段哈希校验失败");
+        ret = ESP_ERR_INVALID_CRC;
+        goto cleanup;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.downloads++;
+    audio_cache_entry_t *e = audio_cache_lookup(hash);
+    if (e != NULL) {
+        // 内容已存在 (不同地址相同内容), 丢弃本次下载
+        s_stats.dedup_hits++;
+        e->seq = s_seq++;
+        xSemaphoreGive(s_lock);
+        if (cached) {
+            *cached = true;
+        }
+        goto cleanup;
+    }
+    e = audio_cache_alloc_entry();
+    if (e == NULL) {
+        xSemaphoreGive(s_lock);
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+    memcpy(e->hash, hash, AUDIO_CACHE_HASH_LEN);
+    e->size = (uint32_t)content_length;
+    e->sample_rate = sample_rate;
+    e->data = data;
+    e->seq = s_seq++;
+    e->refs = 1;
+    data = NULL;
+    reserved = false;
+    xSemaphoreGive(s_lock);
+
+    if (s_flash_ready) {
+        audio_cache_persist(e);
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    e->refs--;
+    xSemaphoreGive(s_lock);
+
+    char hex[AUDIO_CACHE_HASH_HEX_LEN + 1];
+    audio_cache_hash_to_hex(hash, hex);
+    ESP_LOGI(TAG, "已缓存片段 %.16s: %lld 字节, %u Hz%s", hex, (long long)content_length,
+             (unsigned int)sample_rate, e->in_flash ? " (已持久化)" : "");
+
+cleanup:
+    if (data != NULL) {
+        heap_caps_free(data);
+    }
+    if (reserved) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_stats.psram_used -= (size_t)content_length;
+        xSemaphoreGive(s_lock);
+    }
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return ret;
+}
+
+/**
+ * @brief 从闪存层边读取边播放, 有 PSRAM 空间时同时提升到 PSRAM 层
+ */
+static esp_err_t audio_cache_play_from_flash(i2s_chan_handle_t tx_handle, audio_cache_entry_t *e)
+{
+    char path[AUDIO_CACHE_PATH_LEN];
+    audio_cache_path(e->hash, path);
+    FILE *f = fopen(path, "rb");
+    if (f == NULL || fseek(f, sizeof(audio_cache_file_header_t), SEEK_SET) != 0) {
+        if (f != NULL) {
+            fclose(f);
+        }
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool promote = audio_cache_psram_reserve(e->size) == ESP_OK;
+    xSemaphoreGive(s_lock);
+
+    uint8_t *copy = promote ? heap_caps_malloc(e->size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : NULL;
+    uint8_t *staging = copy ? NULL : audio_pool_dma_alloc();
+    esp_err_t ret = (copy || staging) ? ESP_OK : ESP_ERR_NO_MEM;
+
+    bool started = false;
+    for (size_t offset = 0; ret == ESP_OK && offset < e->size; ) {
+        size_t chunk = e->size - offset;
+        if (chunk > AUDIO_CACHE_IO_CHUNK) {
+            chunk = AUDIO_CACHE_IO_CHUNK;
+        }
+        uint8_t *buf = copy ? copy + offset : staging;
+        if (fread(buf, 1, chunk, f) != chunk) {
+            ret = ESP_FAIL;
+            break;
+        }
+        offset += chunk;
+
+        size_t loaded = 0;
+        if (!started) {
+            ret = board_audio_stream_begin(tx_handle, buf, chunk, &loaded);
+            if (ret != ESP_OK) {
+                break;
+            }
+            started = true;
+        }
+        ret = board_audio_stream_write(tx_handle, buf + loaded, chunk - loaded, UINT32_MAX);
+    }
+    fclose(f);
+
+    if (started) {
+        board_audio_stream_end(tx_handle);
+    }
+    audio_pool_dma_free(staging);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (ret == ESP_OK && copy != NULL) {
+        e->data = copy;
+        copy = NULL;
+    } else if (promote) {
+        s_stats.psram_used -= e->size;
+    }
+    xSemaphoreGive(s_lock);
+    heap_caps_free(copy);
+    return ret;
+}
+
+esp_err_t audio_cache_play(i2s_chan_handle_t tx_handle, const uint8_t *hash)
+{
+    if (s_lock == NULL || tx_handle == NULL || hash == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    audio_cache_entry_t *e = audio_cache_lookup(hash);
+    if (e == NULL) {
+        s_stats.misses++;
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+    e->refs++;
+    e->seq = s_seq++;
+    uint8_t *data = e->data;
+    uint32_t sample_rate = e->sample_rate;
+    if (data != NULL) {
+        s_stats.psram_hits++;
+    } else {
+        s_stats.flash_hits++;
+    }
+    xSemaphoreGive(s_lock);
+
+    // 占用播放通道后切换到片段的采样率, 播放结束前其他任务不能再改动时钟
+    esp_err_t ret = board_audio_playback_acquire();
+    if (ret == ESP_OK) {
+        ret = board_audio_set_sample_rate(sample_rate);
+        if (ret == ESP_OK && data != NULL) {
+            ret = board_audio_play(tx_handle, data, e->size);
+        } else if (ret == ESP_OK) {
+            ret = audio_cache_play_from_flash(tx_handle, e);
+        }
+        board_audio_playback_release();
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    e->refs--;
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+void audio_cache_get_stats(audio_cache_stats_t *stats)
+{
+    if (stats == NULL || s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
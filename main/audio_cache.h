@@ -0,0 +1,104 @@
+/**
+ * @file audio_cache.h
+ * @brief 服务器下发音频片段缓存
+ * @details 以内容 SHA-256 为键的两级 LRU 缓存:
+ *          - PSRAM 层: 热点片段常驻内存, 播放无需读闪存
+ *          - 闪存层: cache 分区 (SPIFFS), 重启后仍然有效
+ *          相同内容只下载和存储一次, 超出容量预算时淘汰最久未播放的片段.
+ *          片段格式为 I2S 原生 PCM (16 位, BOARD_AUDIO_PLAYBACK_CHANNELS 通道), 采样率随片段保存,
+ *          播放前切换时钟域.
+ */
+
+#ifndef _AUDIO_CACHE_H_
+#define _AUDIO_CACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2s_std.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_CACHE_PARTITION_LABEL "cache"     // 分区名称
+#define AUDIO_CACHE_BASE_PATH       "/cache"    // SPIFFS 挂载点
+#define AUDIO_CACHE_HASH_LEN        32          // SHA-256 字节数
+#define AUDIO_CACHE_HASH_HEX_LEN    (AUDIO_CACHE_HASH_LEN * 2)
+
+/**
+ * @brief 缓存统计
+ */
+typedef struct {
+    int entries;                // 缓存片段数
+    size_t psram_used;          // PSRAM 层占用 (字节)
+    size_t flash_used;          // 闪存层占用 (字节)
+    uint32_t psram_hits;        // 从 PSRAM 播放次数
+    uint32_t flash_hits;        // 从闪存播放次数
+    uint32_t misses;            // 播放未命中次数
+    uint32_t downloads;         // 实际下载次数
+    uint32_t dedup_hits;        // 因内容已存在而跳过的下载次数
+} audio_cache_stats_t;
+
+/**
+ * @brief 初始化缓存
+ * @details 挂载 cache 分区并扫描已缓存的片段, 分区不存在时只使用 PSRAM 层
+ * @return esp_err_t ESP_OK 成功, 其他失败
+ */
+esp_err_t audio_cache_init(void);
+
+/**
+ * @brief 下载音频片段到缓存
+ * @param url 片段地址
+ * @param expected_hash 期望的 SHA-256, 可为 NULL. 提供时若已缓存则不下载, 下载后校验不一致返回 ESP_ERR_INVALID_CRC
+ * @param sample_rate 片段采样率 (Hz), 0 表示下载时的时钟域采样率 board_audio_get_sample_rate()
+ * @param[out] hash 片段的 SHA-256 (播放时使用)
+ * @param[out] cached 可为 NULL, 返回片段是否已在缓存中 (未产生存储)
+ * @return esp_err_t ESP_OK 成功, 其他失败
+ */
+esp_err_t audio_cache_fetch(const char *url, const uint8_t *expected_hash, uint32_t sample_rate,
+                            uint8_t *hash, bool *cached);
+
+/**
+ * @brief 查询片段是否已缓存
+ * @param hash SHA-256
+ * @return true 已缓存
+ */
+bool audio_cache_contains(const uint8_t *hash);
+
+/**
+ * @brief 播放缓存的片段
+ * @details 先切换到片段的采样率. 在 PSRAM 层时直接播放; 只在闪存层时边读取边播放, 同时提升到 PSRAM 层
+ * @param tx_handle I2S 发送通道句柄
+ * @param hash SHA-256
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_FOUND 未缓存, ESP_ERR_INVALID_STATE 其他播放进行中, 其他失败
+ */
+esp_err_t audio_cache_play(i2s_chan_handle_t tx_handle, const uint8_t *hash);
+
+/**
+ * @brief 获取缓存统计
+ * @param[out] stats 统计信息
+ */
+void audio_cache_get_stats(audio_cache_stats_t *stats);
+
+/**
+ * @brief 解析十六进制 SHA-256 字符串
+ * @param hex 64 个十六进制字符
+ * @param[out] hash SHA-256
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_ARG 格式错误
+ */
+esp_err_t audio_cache_hash_from_hex(const char *hex, uint8_t *hash);
+
+/**
+ * @brief SHA-256 转十六进制字符串
+ * @param hash SHA-256
+ * @param[out] hex 输出缓冲区, 至少 AUDIO_CACHE_HASH_HEX_LEN + 1 字节
+ */
+void audio_cache_hash_to_hex(const uint8_t *hash, char *hex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_CACHE_H_ */
@@ -0,0 +1,562 @@
+/**
+ * @file audio_dsp.c
+ * @brief 播放 DSP 处理链
+ * @details 参数换算 (系数设计) 使用浮点, 只在修改参数时执行; 逐样本处理全部为定点.
+ *          样本在处理链内为 Q8 (int16 << 8), 为 EQ 提升保留余量并降低低频滤波器的量化噪声.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "audio_dsp.h"
+#include "esp_attr.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "esp_cpu.h"
+static portMUX_TYPE s_dsp_mux = portMUX_INITIALIZER_UNLOCKED;
+#define DSP_LOCK()      portENTER_CRITICAL(&s_dsp_mux)
+#define DSP_UNLOCK()    portEXIT_CRITICAL(&s_dsp_mux)
+#define DSP_CYCLES()    esp_cpu_get_cycle_count()
+#else
+#define DSP_LOCK()
+#define DSP_UNLOCK()
+#define DSP_CYCLES()    0
+#endif
+
+#define Q16_ONE             (1 << 16)
+#define COEF_SHIFT          28          // 双二阶系数 Q28 (范围 ±8)
+#define SAMPLE_SHIFT        8           // 内部样本 Q8
+#define FULL_SCALE_LOG2     (15 + SAMPLE_SHIFT)
+#define CTRL_BLOCK_FRAMES   16          // 压缩器控制速率 (每 16 帧更新一次增益)
+#define DB_PER_LOG2_Q16     394566      // 20*log10(2) = 6.0206 dB, Q16
+#define LOG2_PER_DB_Q16     10885       // 1/6.0206, Q16
+#define LUT_BITS            5
+#define LUT_SIZE            (1 << LUT_BITS)
+
+#define LA                  AUDIO_DSP_LOOKAHEAD_FRAMES
+_Static_assert((LA & (LA - 1)) == 0, "前瞻帧数必须是 2 的幂");
+
+typedef struct {
+    int32_t b0, b1, b2, a1, a2;         // Q28, a0 已归一化
+} biquad_coef_t;
+
+typedef struct {
+    int32_t x1, x2, y1, y2;
+} biquad_state_t;
+
+/* 参数 (修改时先写入 s_pending, 处理开始时拷贝) */
+typedef struct {
+    int band_count;
+    audio_dsp_eq_band_t bands[AUDIO_DSP_MAX_BANDS];
+    biquad_coef_t coef[AUDIO_DSP_MAX_BANDS];
+    bool comp_enable;
+    int32_t comp_threshold;             // dB Q16
+    int32_t comp_slope;                 // 1/ratio - 1, Q16
+    int32_t comp_knee;                  // dB Q16
+    int32_t comp_attack;                // 平滑系数 Q16 (每控制块)
+    int32_t comp_release;
+    int32_t comp_makeup;                // dB Q16
+    bool limit_enable;
+    int32_t limit_ceiling;              // Q8 样本幅度
+    int32_t limit_release_step;         // 每帧增益恢复量 Q16
+    audio_dsp_compressor_t comp_cfg;    // 原始参数, 切换采样率时重新计算
+    audio_dsp_limiter_t limit_cfg;
+} dsp_params_t;
+
+static uint32_t s_sample_rate = 44100;
+static int s_channels = 2;
+static dsp_params_t s_params;
+static dsp_params_t s_pending;
+static volatile bool s_pending_dirty = false;
+
+/* 对数/指数查找表, Q16 */
+static int32_t s_log2_lut[LUT_SIZE + 1];    // log2(1 + i/32)
+static int32_t s_exp2_lut[LUT_SIZE + 1];    // 2^(i/32)
+
+/* 处理状态 */
+static struct {
+    biquad_state_t eq[AUDIO_DSP_MAX_BANDS][AUDIO_DSP_MAX_CHANNELS];
+    // 压缩器
+    int32_t comp_gr;                    // 平滑后的增益衰减 dB Q16 (<= 0)
+    int32_t comp_gain;                  // 当前线性增益 Q16
+    int32_t comp_gain_step;             // 每帧增益插值步长
+    int32_t block_peak;                 // 当前控制块峰值 Q8
+    int block_pos;
+    // 限幅器
+    int32_t delay[LA][AUDIO_DSP_MAX_CHANNELS];
+    int32_t min_val[LA];                // 滑动最小值单调队列
+    uint32_t min_idx[LA];
+    int min_head, min_count;
+    int32_t release_gain;               // 带释放的增益包络 Q16
+    int32_t box[LA];                    // 箱式平滑环形缓冲
+    int64_t box_sum;
+    int32_t limit_min_gain;             // 最小限幅增益 Q16 (统计)
+    uint32_t n;                         // 帧计数
+    audio_dsp_stats_t stats;
+} s_st;
+
+/**************************** 定点数学 ****************************/
+
+/* log2(x), Q16, x > 0 */
+static inline int32_t IRAM_ATTR fx_log2(uint32_t x)
+{
+    int msb = 31 - __builtin_clz(x);
+    uint32_t m = (msb >= 31) ? x : (x << (31 - msb));    // [2^31, 2^32)
+    uint32_t frac = m & 0x7FFFFFFF;
+    int idx = frac >> (31 - LUT_BITS);
+    int32_t t = (frac >> (31 - LUT_BITS - 16)) & 0xFFFF;  // 表内插值位置 Q16
+    int32_t l = s_log2_lut[idx] + (int32_t)(((int64_t)(s_log2_lut[idx + 1] - s_log2_lut[idx]) * t) >> 16);
+    return (msb << 16) + l;
+}
+
+/* 2^x, x 为 Q16, 返回 Q16 */
+static inline int32_t IRAM_ATTR fx_exp2(int32_t x)
+{
+    int32_t n = x >> 16;                    // 向下取整
+    int32_t f = x & 0xFFFF;
+    int idx = f >> (16 - LUT_BITS);
+    int32_t t = (f << LUT_BITS) & 0xFFFF;
+    int32_t m = s_exp2_lut[idx] + (int32_t)(((int64_t)(s_exp2_lut[idx + 1] - s_exp2_lut[idx]) * t) >> 16);
+    if (n >= 14) {
+        return INT32_MAX;
+    }
+    if (n >= 0) {
+        return m << n;
+    }
+    return (n <= -31) ? 0 : (m >> -n);
+}
+
+static inline int16_t IRAM_ATTR sat16(int32_t v)
+{
+    v = (v + (1 << (SAMPLE_SHIFT - 1))) >> SAMPLE_SHIFT;
+    if (v > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (v < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)v;
+}
+
+static inline int32_t q16(float v)
+{
+    return (int32_t)lrintf(v * Q16_ONE);
+}
+
+/**************************** 参数设计 ****************************/
+
+static void design_biquad(const audio_dsp_eq_band_t *band, double fs, double c[5])
+{
+    double w0 = 2.0 * M_PI * band->freq_hz / fs;
+    double cw = cos(w0);
+    double alpha = sin(w0) / (2.0 * band->q);
+    double A = pow(10.0, band->gain_db / 40.0);
+    double sa = 2.0 * sqrt(A) * alpha;
+    double b0, b1, b2, a0, a1, a2;
+
+    switch (band->type) {
+    case AUDIO_DSP_EQ_LOW_SHELF:
+        b0 = A * ((A + 1) - (A - 1) * cw + sa);
+        b1 = 2 * A * ((A - 1) - (A + 1) * cw);
+        b2 = A * ((A + 1) - (A - 1) * cw - sa);
+        a0 = (A + 1) + (A - 1) * cw + sa;
+        a1 = -2 * ((A - 1) + (A + 1) * cw);
+        a2 = (A + 1) + (A - 1) * cw - sa;
+        break;
+    case AUDIO_DSP_EQ_HIGH_SHELF:
+        b0 = A * ((A + 1) + (A - 1) * cw + sa);
+        b1 = -2 * A * ((A - 1) + (A + 1) * cw);
+        b2 = A * ((A + 1) + (A - 1) * cw - sa);
+        a0 = (A + 1) - (A - 1) * cw + sa;
+        a1 = 2 * ((A - 1) - (A + 1) * cw);
+        a2 = (A + 1) - (A - 1) * cw - sa;
+        break;
+    case AUDIO_DSP_EQ_HIGH_PASS:
+        b0 = (1 + cw) / 2;
+        b1 = -(1 + cw);
+        b2 = (1 + cw) / 2;
+        a0 = 1 + alpha;
+        a1 = -2 * cw;
+        a2 = 1 - alpha;
+        break;
+    case AUDIO_DSP_EQ_LOW_PASS:
+        b0 = (1 - cw) / 2;
+        b1 = 1 - cw;
+        b2 = (1 - cw) / 2;
+        a0 = 1 + alpha;
+        a1 = -2 * cw;
+        a2 = 1 - alpha;
+        break;
+    case AUDIO_DSP_EQ_PEAK:
+    default:
+        b0 = 1 + alpha * A;
+        b1 = -2 * cw;
+        b2 = 1 - alpha * A;
+        a0 = 1 + alpha / A;
+        a1 = -2 * cw;
+        a2 = 1 - alpha / A;
+        break;
+    }
+    c[0] = b0 / a0;
+    c[1] = b1 / a0;
+    c[2] = b2 / a0;
+    c[3] = a1 / a0;
+    c[4] = a2 / a0;
+}
+
+static void commit_pending(void)
+{
+    DSP_LOCK();
+    s_pending_dirty = true;
+    DSP_UNLOCK();
+}
+
+esp_err_t audio_dsp_init(uint32_t sample_rate, int channels)
+{
+    if (sample_rate == 0 || channels < 1 || channels > AUDIO_DSP_MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_sample_rate = sample_rate;
+    s_channels = channels;
+
+    for (int i = 0; i <= LUT_SIZE; i++) {
+        s_log2_lut[i] = q16(log2f(1.0f + (float)i / LUT_SIZE));
+        s_exp2_lut[i] = q16(exp2f((float)i / LUT_SIZE));
+    }
+
+    memset(&s_pending, 0, sizeof(s_pending));
+    s_pending.limit_ceiling = INT32_MAX;
+    s_params = s_pending;
+    s_pending_dirty = false;
+    audio_dsp_reset();
+    return ESP_OK;
+}
+
+esp_err_t audio_dsp_set_eq(const audio_dsp_eq_band_t *bands, int count)
+{
+    if (count < 0 || count > AUDIO_DSP_MAX_BANDS || (count > 0 && bands == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    dsp_params_t p;
+    DSP_LOCK();
+    p = s_pending;
+    DSP_UNLOCK();
+
+    for (int i = 0; i < count; i++) {
+        const audio_dsp_eq_band_t *b = &bands[i];
+        if (b->freq_hz <= 0 || b->freq_hz >= s_sample_rate / 2.0f || b->q <= 0 ||
+            b->gain_db < -24.0f || b->gain_db > 18.0f) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        double c[5];
+        design_biquad(b, s_sample_rate, c);
+        p.coef[i].b0 = (int32_t)llround(c[0] * (1 << COEF_SHIFT));
+        p.coef[i].b1 = (int32_t)llround(c[1] * (1 << COEF_SHIFT));
+        p.coef[i].b2 = (int32_t)llround(c[2] * (1 << COEF_SHIFT));
+        p.coef[i].a1 = (int32_t)llround(c[3] * (1 << COEF_SHIFT));
+        p.coef[i].a2 = (int32_t)llround(c[4] * (1 << COEF_SHIFT));
+        p.bands[i] = *b;
+    }
+    p.band_count = count;
+
+    DSP_LOCK();
+    s_pending.band_count = p.band_count;
+    memcpy(s_pending.bands, p.bands, sizeof(p.bands));
+    memcpy(s_pending.coef, p.coef, sizeof(p.coef));
+    DSP_UNLOCK();
+    commit_pending();
+    return ESP_OK;
+}
+
+esp_err_t audio_dsp_set_compressor(const audio_dsp_compressor_t *cfg)
+{
+    if (cfg == NULL || cfg->ratio < 1.0f || cfg->knee_db < 0 || cfg->attack_ms <= 0 || cfg->release_ms <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 平滑系数按控制块计算: 1 - exp(-T_block / tau)
+    float block_s = (float)CTRL_BLOCK_FRAMES / s_sample_rate;
+    DSP_LOCK();
+    s_pending.comp_cfg = *cfg;
+    s_pending.comp_enable = cfg->enable;
+    s_pending.comp_threshold = q16(cfg->threshold_db);
+    s_pending.comp_slope = q16(1.0f / cfg->ratio - 1.0f);
+    s_pending.comp_knee = q16(cfg->knee_db);
+    s_pending.comp_attack = q16(1.0f - expf(-block_s * 1000.0f / cfg->attack_ms));
+    s_pending.comp_release = q16(1.0f - expf(-block_s * 1000.0f / cfg->release_ms));
+    s_pending.comp_makeup = q16(cfg->makeup_db);
+    DSP_UNLOCK();
+    commit_pending();
+    return ESP_OK;
+}
+
+esp_err_t audio_dsp_set_limiter(const audio_dsp_limiter_t *cfg)
+{
+    if (cfg == NULL || cfg->ceiling_db > 0 || cfg->ceiling_db < -30.0f || cfg->release_ms <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int32_t release_frames = (int32_t)(cfg->release_ms * s_sample_rate / 1000.0f);
+    DSP_LOCK();
+    s_pending.limit_cfg = *cfg;
+    s_pending.limit_enable = cfg->enable;
+    s_pending.limit_ceiling = (int32_t)(powf(10.0f, cfg->ceiling_db / 20.0f) * (32767 << SAMPLE_SHIFT));
+    s_pending.limit_release_step = release_frames > 0 ? Q16_ONE / release_frames : Q16_ONE;
+    if (s_pending.limit_release_step == 0) {
+        s_pending.limit_release_step = 1;
+    }
+    DSP_UNLOCK();
+    commit_pending();
+    return ESP_OK;
+}
+
+esp_err_t audio_dsp_set_sample_rate(uint32_t sample_rate)
+{
+    if (sample_rate == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sample_rate == s_sample_rate) {
+        return ESP_OK;
+    }
+
+    dsp_params_t p;
+    DSP_LOCK();
+    p = s_pending;
+    DSP_UNLOCK();
+    s_sample_rate = sample_rate;
+
+    // 超过新奈奎斯特频率的 EQ 段无法实现, 丢弃
+    audio_dsp_eq_band_t bands[AUDIO_DSP_MAX_BANDS];
+    int count = 0;
+    for (int i = 0; i < p.band_count; i++) {
+        if (p.bands[i].freq_hz < sample_rate / 2.0f) {
+            bands[count++] = p.bands[i];
+        }
+    }
+    audio_dsp_set_eq(bands, count);
+    // 未设置过的压缩器/限幅器参数为全零, 校验失败, 保持关闭
+    audio_dsp_set_compressor(&p.comp_cfg);
+    audio_dsp_set_limiter(&p.limit_cfg);
+    audio_dsp_reset();
+    return ESP_OK;
+}
+
+void audio_dsp_reset(void)
+{
+    memset(&s_st, 0, sizeof(s_st));
+    s_st.comp_gain = Q16_ONE;
+    s_st.release_gain = Q16_ONE;
+    s_st.limit_min_gain = Q16_ONE;
+    for (int i = 0; i < LA; i++) {
+        s_st.box[i] = Q16_ONE;
+    }
+    s_st.box_sum = (int64_t)Q16_ONE * LA;
+}
+
+/**************************** 处理 ****************************/
+
+static inline int32_t IRAM_ATTR biquad(const biquad_coef_t *c, biquad_state_t *s, int32_t x)
+{
+    int64_t acc = (int64_t)c->b0 * x + (int64_t)c->b1 * s->x1 + (int64_t)c->b2 * s->x2
+                - (int64_t)c->a1 * s->y1 - (int64_t)c->a2 * s->y2;
+    int32_t y = (int32_t)((acc + (1 << (COEF_SHIFT - 1))) >> COEF_SHIFT);
+    s->x2 = s->x1;
+    s->x1 = x;
+    s->y2 = s->y1;
+    s->y1 = y;
+    return y;
+}
+
+/* 软拐点增益计算, 输入电平/输出衰减均为 dB Q16 */
+static inline int32_t IRAM_ATTR comp_gain_computer(const dsp_params_t *p, int32_t level)
+{
+    int32_t over = level - p->comp_threshold;
+    int32_t half_knee = p->comp_knee / 2;
+    if (over <= -half_knee) {
+        return 0;
+    }
+    if (over >= half_knee) {
+        return (int32_t)(((int64_t)p->comp_slope * over) >> 16);
+    }
+    // 拐点内: slope * (over + W/2)^2 / (2W)
+    int64_t x = over + half_knee;
+    int64_t sq = (x * x) / (2 * (int64_t)p->comp_knee);
+    return (int32_t)(((int64_t)p->comp_slope * sq) >> 16);
+}
+
+/* 每个控制块更新一次压缩器目标增益 */
+static void IRAM_ATTR comp_update(const dsp_params_t *p)
+{
+    int32_t gr = 0;
+    if (s_st.block_peak > 0) {
+        int32_t level = (int32_t)(((int64_t)(fx_log2(s_st.block_peak) - (FULL_SCALE_LOG2 << 16)) * DB_PER_LOG2_Q16) >> 16);
+        gr = comp_gain_computer(p, level);
+    }
+    int32_t coef = (gr < s_st.comp_gr) ? p->comp_attack : p->comp_release;
+    s_st.comp_gr += (int32_t)(((int64_t)(gr - s_st.comp_gr) * coef) >> 16);
+
+    int32_t gain_db = s_st.comp_gr + p->comp_makeup;
+    int32_t target = fx_exp2((int32_t)(((int64_t)gain_db * LOG2_PER_DB_Q16) >> 16));
+    s_st.comp_gain_step = (target - s_st.comp_gain) / CTRL_BLOCK_FRAMES;
+
+    float gr_db = -(float)s_st.comp_gr / Q16_ONE;
+    if (gr_db > s_st.stats.max_comp_reduction_db) {
+        s_st.stats.max_comp_reduction_db = gr_db;
+    }
+    s_st.block_peak = 0;
+    s_st.block_pos = 0;
+}
+
+/* 限幅器: 滑动最小值 + 释放包络 + 箱式平滑, 保证前瞻窗口内的峰值不超过上限 */
+static inline int32_t IRAM_ATTR limiter_gain(const dsp_params_t *p, int32_t peak)
+{
+    int32_t req = Q16_ONE;
+    if (peak > p->limit_ceiling) {
+        req = (int32_t)(((int64_t)p->limit_ceiling << 16) / peak);
+    }
+
+    // 单调队列维护最近 LA 帧的最小需求增益
+    uint32_t n = s_st.n;
+    if (s_st.min_count > 0 && n - s_st.min_idx[s_st.min_head] >= LA) {
+        s_st.min_head = (s_st.min_head + 1) & (LA - 1);
+        s_st.min_count--;
+    }
+    while (s_st.min_count > 0) {
+        int back = (s_st.min_head + s_st.min_count - 1) & (LA - 1);
+        if (s_st.min_val[back] < req) {
+            break;
+        }
+        s_st.min_count--;
+    }
+    int tail = (s_st.min_head + s_st.min_count) & (LA - 1);
+    s_st.min_val[tail] = req;
+    s_st.min_idx[tail] = n;
+    s_st.min_count++;
+    int32_t m = s_st.min_val[s_st.min_head];
+
+    // 释放: 增益按固定斜率恢复, 但不超过窗口最小值
+    int32_t r = s_st.release_gain + p->limit_release_step;
+    if (r > m) {
+        r = m;
+    }
+    s_st.release_gain = r;
+
+    // 箱式平滑, 窗口内各值都不大于被延迟样本的需求增益
+    int slot = n & (LA - 1);
+    s_st.box_sum += r - s_st.box[slot];
+    s_st.box[slot] = r;
+    return (int32_t)(s_st.box_sum / LA);
+}
+
+void IRAM_ATTR audio_dsp_process(const int16_t *in, int16_t *out, size_t frames)
+{
+    uint32_t t0 = DSP_CYCLES();
+
+    if (s_pending_dirty) {
+        DSP_LOCK();
+        int old_count = s_params.band_count;
+        s_params = s_pending;
+        s_pending_dirty = false;
+        DSP_UNLOCK();
+        // 新增的 EQ 段从零状态开始
+        if (s_params.band_count > old_count) {
+            memset(&s_st.eq[old_count], 0, (s_params.band_count - old_count) * sizeof(s_st.eq[0]));
+        }
+    }
+    const dsp_params_t *p = &s_params;
+    const int ch = s_channels;
+
+    for (size_t f = 0; f < frames; f++) {
+        int32_t x[AUDIO_DSP_MAX_CHANNELS];
+        int32_t peak = 0;
+
+        // EQ
+        for (int c = 0; c < ch; c++) {
+            int32_t v = in ? ((int32_t)in[f * ch + c] << SAMPLE_SHIFT) : 0;
+            for (int b = 0; b < p->band_count; b++) {
+                v = biquad(&p->coef[b], &s_st.eq[b][c], v);
+            }
+            x[c] = v;
+            int32_t a = v < 0 ? -v : v;
+            if (a > peak) {
+                peak = a;
+            }
+        }
+
+        // 压缩器 (控制速率更新, 逐帧线性插值增益)
+        if (p->comp_enable) {
+            if (peak > s_st.block_peak) {
+                s_st.block_peak = peak;
+            }
+            if (++s_st.block_pos >= CTRL_BLOCK_FRAMES) {
+                comp_update(p);
+            }
+            s_st.comp_gain += s_st.comp_gain_step;
+            peak = 0;
+            for (int c = 0; c < ch; c++) {
+                x[c] = (int32_t)(((int64_t)x[c] * s_st.comp_gain) >> 16);
+                int32_t a = x[c] < 0 ? -x[c] : x[c];
+                if (a > peak) {
+                    peak = a;
+                }
+            }
+        }
+
+        // 限幅器 (延迟 LA - 1 帧)
+        if (p->limit_enable) {
+            int32_t g = limiter_gain(p, peak);
+            int wr = s_st.n & (LA - 1);
+            int rd = (s_st.n + 1) & (LA - 1);
+            for (int c = 0; c < ch; c++) {
+                s_st.delay[wr][c] = x[c];
+            }
+            for (int c = 0; c < ch; c++) {
+                out[f * ch + c] = sat16((int32_t)(((int64_t)s_st.delay[rd][c] * g) >> 16));
+            }
+            if (g < Q16_ONE) {
+                s_st.stats.limited_frames++;
+                if (g < s_st.limit_min_gain) {
+                    s_st.limit_min_gain = g;
+                }
+            }
+        } else {
+            for (int c = 0; c < ch; c++) {
+                out[f * ch + c] = sat16(x[c]);
+            }
+        }
+        s_st.n++;
+    }
+
+    s_st.stats.frames += frames;
+    s_st.stats.cycles += (uint32_t)(DSP_CYCLES() - t0);
+}
+
+void audio_dsp_get_stats(audio_dsp_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = s_st.stats;
+        stats->max_limit_reduction_db = (s_st.limit_min_gain > 0) ?
+            -20.0f * log10f((float)s_st.limit_min_gain / Q16_ONE) : 96.0f;
+    }
+}
+
+float audio_dsp_eq_response_db(float freq_hz)
+{
+    double w = 2.0 * M_PI * freq_hz / s_sample_rate;
+    double db = 0;
+    DSP_LOCK();
+    dsp_params_t p = s_pending;
+    DSP_UNLOCK();
+    for (int i = 0; i < p.band_count; i++) {
+        double c[5];
+        design_biquad(&p.bands[i], s_sample_rate, c);
+        // |H(e^jw)| = |b0 + b1 z^-1 + b2 z^-2| / |1 + a1 z^-1 + a2 z^-2|
+        double nr = c[0] + c[1] * cos(w) + c[2] * cos(2 * w);
+        double ni = -c[1] * sin(w) - c[2] * sin(2 * w);
+        double dr = 1 + c[3] * cos(w) + c[4] * cos(2 * w);
+        double di = -c[3] * sin(w) - c[4] * sin(2 * w);
+        db += 10.0 * log10((nr * nr + ni * ni) / (dr * dr + di * di));
+    }
+    return (float)db;
+}
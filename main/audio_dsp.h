@@ -0,0 +1,146 @@
+/**
+ * @file audio_dsp.h
+ * @brief 播放 DSP 处理链
+ * @details 位于 I2S 之前, 处理顺序: 级联双二阶 EQ -> 软拐点压缩器 -> 前瞻峰值限幅器.
+ *          处理路径全部为定点运算 (样本 Q8, 系数 Q28, 增益 Q16), 参数可在播放中修改,
+ *          新参数在下一次 audio_dsp_process() 开始时生效.
+ *          不依赖 ESP-IDF 运行时, 可在主机上编译验证 (见 tools/dsp_host).
+ */
+
+#ifndef _AUDIO_DSP_H_
+#define _AUDIO_DSP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_DSP_MAX_BANDS         6       // 最大 EQ 段数
+#define AUDIO_DSP_MAX_CHANNELS      2       // 最大通道数
+#define AUDIO_DSP_LOOKAHEAD_FRAMES  64      // 限幅器前瞻帧数 (44.1kHz 约 1.5ms, 即处理延迟)
+
+/**
+ * @brief EQ 段类型 (RBJ Audio EQ Cookbook)
+ */
+typedef enum {
+    AUDIO_DSP_EQ_PEAK = 0,          // 峰值
+    AUDIO_DSP_EQ_LOW_SHELF,         // 低架
+    AUDIO_DSP_EQ_HIGH_SHELF,        // 高架
+    AUDIO_DSP_EQ_HIGH_PASS,         // 高通 (gain_db 无效)
+    AUDIO_DSP_EQ_LOW_PASS,          // 低通 (gain_db 无效)
+} audio_dsp_eq_type_t;
+
+/**
+ * @brief EQ 段参数
+ */
+typedef struct {
+    audio_dsp_eq_type_t type;
+    float freq_hz;                  // 中心/截止频率
+    float q;                        // 品质因数
+    float gain_db;                  // 增益 (峰值/架型)
+} audio_dsp_eq_band_t;
+
+/**
+ * @brief 压缩器参数
+ */
+typedef struct {
+    bool enable;
+    float threshold_db;             // 阈值 (dBFS)
+    float ratio;                    // 压缩比 (>= 1)
+    float knee_db;                  // 软拐点宽度 (dB)
+    float attack_ms;                // 启动时间
+    float release_ms;               // 释放时间
+    float makeup_db;                // 补偿增益
+} audio_dsp_compressor_t;
+
+/**
+ * @brief 限幅器参数
+ */
+typedef struct {
+    bool enable;
+    float ceiling_db;               // 输出峰值上限 (dBFS)
+    float release_ms;               // 释放时间
+} audio_dsp_limiter_t;
+
+/**
+ * @brief 处理统计 (audio_dsp_reset() 时清零)
+ */
+typedef struct {
+    uint32_t frames;                // 已处理帧数
+    uint32_t limited_frames;        // 限幅器动作的帧数
+    float max_comp_reduction_db;    // 压缩器最大增益衰减
+    float max_limit_reduction_db;   // 限幅器最大增益衰减
+    uint64_t cycles;                // 处理耗费的 CPU 周期 (仅设备端)
+} audio_dsp_stats_t;
+
+/**
+ * @brief 初始化 DSP 处理链 (EQ 为空, 压缩器和限幅器关闭)
+ * @param sample_rate 采样率
+ * @param channels 交织通道数 (1 或 2)
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_ARG 参数错误
+ */
+esp_err_t audio_dsp_init(uint32_t sample_rate, int channels);
+
+/**
+ * @brief 设置 EQ (替换全部 EQ 段)
+ * @param bands EQ 段数组
+ * @param count 段数, 0 表示关闭 EQ
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_ARG 参数错误
+ */
+esp_err_t audio_dsp_set_eq(const audio_dsp_eq_band_t *bands, int count);
+
+/**
+ * @brief 设置压缩器参数
+ */
+esp_err_t audio_dsp_set_compressor(const audio_dsp_compressor_t *cfg);
+
+/**
+ * @brief 设置限幅器参数
+ */
+esp_err_t audio_dsp_set_limiter(const audio_dsp_limiter_t *cfg);
+
+/**
+ * @brief 修改采样率, 按新采样率重新计算 EQ 系数和压缩器/限幅器时间常数
+ * @details 当前参数保留; 频率不低于新奈奎斯特频率的 EQ 段被丢弃. 处理状态同时清空,
+ *          只能在没有播放时调用
+ * @param sample_rate 采样率
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_ARG 参数错误
+ */
+esp_err_t audio_dsp_set_sample_rate(uint32_t sample_rate);
+
+/**
+ * @brief 清空滤波器状态、延迟线和统计 (每次开始播放前调用)
+ */
+void audio_dsp_reset(void);
+
+/**
+ * @brief 处理交织的 16 位 PCM
+ * @details 输出相对输入延迟 AUDIO_DSP_LOOKAHEAD_FRAMES - 1 帧, 播放结束时以 in = NULL 处理该帧数取出尾部
+ * @param in 输入, NULL 表示静音输入
+ * @param out 输出, 可与 in 相同
+ * @param frames 帧数
+ */
+void audio_dsp_process(const int16_t *in, int16_t *out, size_t frames);
+
+/**
+ * @brief 获取处理统计
+ * @param[out] stats 统计信息
+ */
+void audio_dsp_get_stats(audio_dsp_stats_t *stats);
+
+/**
+ * @brief 计算当前 EQ 在指定频率的理论幅度响应 (用于验证)
+ * @param freq_hz 频率
+ * @return 增益 (dB)
+ */
+float audio_dsp_eq_response_db(float freq_hz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_DSP_H_ */
@@ -0,0 +1,138 @@
+/**
+ * @file audio_flash_log.c
+ * @brief 录音分区顺序写入层
+ */
+
+#include <string.h>
+#include "audio_flash_log.h"
+#include "esp_timer.h"
+
+#define SECTOR  AUDIO_FLASH_LOG_SECTOR_SIZE
+
+/**
+ * @brief 擦除数据区中的一个扇区并计时
+ */
+static esp_err_t flash_log_erase_sector(audio_flash_log_t *log)
+{
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t ret = esp_partition_erase_range(log->part, SECTOR + log->erased, SECTOR);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    if (ret == ESP_OK) {
+        log->erased += SECTOR;
+        log->stats.erases++;
+        log->stats.erase_us += us;
+        if (us > log->stats.max_erase_us) {
+            log->stats.max_erase_us = us;
+        }
+    }
+    return ret;
+}
+
+esp_err_t audio_flash_log_open(audio_flash_log_t *log, const esp_partition_t *part)
+{
+    if (log == NULL || part == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (part->size < 2 * SECTOR) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memset(log, 0, sizeof(*log));
+    log->part = part;
+    log->capacity = (part->size / SECTOR - 1) * SECTOR;
+    return ESP_OK;
+}
+
+esp_err_t audio_flash_log_read_header(audio_flash_log_t *log, audio_flash_log_header_t *header)
+{
+    esp_err_t ret = esp_partition_read(log->part, 0, header, sizeof(*header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (header->magic != AUDIO_FLASH_LOG_MAGIC || header->version != AUDIO_FLASH_LOG_VERSION ||
+        header->data_size > log->capacity) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t audio_flash_log_begin(audio_flash_log_t *log, size_t pre_erase)
+{
+    memset(&log->stats, 0, sizeof(log->stats));
+    log->written = 0;
+    log->erased = 0;
+
+    // 先擦除录音头, 旧录音立即失效
+    esp_err_t ret = esp_partition_erase_range(log->part, 0, SECTOR);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (pre_erase > log->capacity) {
+        pre_erase = log->capacity;
+    }
+    while (ret == ESP_OK && log->erased < pre_erase) {
+        ret = flash_log_erase_sector(log);
+    }
+    return ret;
+}
+
+esp_err_t audio_flash_log_append(audio_flash_log_t *log, const uint8_t *data, size_t len)
+{
+    esp_err_t full = ESP_OK;
+    if (len > log->capacity - log->written) {
+        len = log->capacity - log->written;
+        full = ESP_ERR_INVALID_SIZE;
+    }
+
+    while (len > 0) {
+        // 预擦除不足时逐个扇区擦除, 每次擦除只禁用一个扇区的时间
+        while (log->erased < log->written + len && log->erased < log->written + AUDIO_FLASH_LOG_WRITE_CHUNK) {
+            esp_err_t ret = flash_log_erase_sector(log);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            log->stats.inline_erases++;
+        }
+
+        size_t chunk = len > AUDIO_FLASH_LOG_WRITE_CHUNK ? AUDIO_FLASH_LOG_WRITE_CHUNK : len;
+        int64_t t0 = esp_timer_get_time();
+        esp_err_t ret = esp_partition_write(log->part, SECTOR + log->written, data, chunk);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        log->stats.writes++;
+        log->stats.write_us += us;
+        if (us > log->stats.max_write_us) {
+            log->stats.max_write_us = us;
+        }
+        log->written += chunk;
+        log->stats.bytes_written += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+    return full;
+}
+
+bool audio_flash_log_erase_ahead(audio_flash_log_t *log, size_t lead)
+{
+    if (log->erased >= log->capacity || log->erased >= log->written + lead) {
+        return false;
+    }
+    return flash_log_erase_sector(log) == ESP_OK;
+}
+
+esp_err_t audio_flash_log_finish(audio_flash_log_t *log, audio_flash_log_header_t *header)
+{
+    header->magic = AUDIO_FLASH_LOG_MAGIC;
+    header->version = AUDIO_FLASH_LOG_VERSION;
+    header->data_size = (uint32_t)log->written;
+    return esp_partition_write(log->part, 0, header, sizeof(*header));
+}
+
+esp_err_t audio_flash_log_read(audio_flash_log_t *log, size_t offset, void *dst, size_t len)
+{
+    if (offset + len > log->capacity) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return esp_partition_read(log->part, SECTOR + offset, dst, len);
+}
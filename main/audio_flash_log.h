@@ -0,0 +1,127 @@
+/**
+ * @file audio_flash_log.h
+ * @brief 录音分区顺序写入层
+ * @details record 分区按日志方式顺序追加: 第 0 扇区为录音头, 数据从第 1 扇区开始.
+ *          录音头在录音结束时最后写入, 开始录音时先擦除, 因此掉电中断的录音不会被当作完整录音.
+ *          写入层只做扇区对齐的擦除和分段写入, 并统计每次闪存操作的耗时
+ *          (闪存操作期间缓存被禁用, 两个核心上运行在闪存中的任务都会停顿),
+ *          双缓冲和任务调度由 audio_recorder 负责. 不依赖 FreeRTOS, 可在主机上用模拟闪存验证.
+ */
+
+#ifndef _AUDIO_FLASH_LOG_H_
+#define _AUDIO_FLASH_LOG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_FLASH_LOG_SECTOR_SIZE     4096        // 擦除单位
+#define AUDIO_FLASH_LOG_WRITE_CHUNK     1024        // 单次 esp_partition_write 的长度, 限制每次禁用缓存的时间
+#define AUDIO_FLASH_LOG_MAGIC           0x43455241  // 'AREC'
+#define AUDIO_FLASH_LOG_VERSION         2           // 2: 增加 dma_dropped_frames
+
+/* 录音数据编码 */
+typedef enum {
+    AUDIO_FLASH_LOG_CODEC_PCM = 0,          // 16 位交织 PCM
+    AUDIO_FLASH_LOG_CODEC_IMA_ADPCM = 1,    // IMA ADPCM 块 (格式见 audio_adpcm.h)
+} audio_flash_log_codec_t;
+
+/**
+ * @brief 录音头 (第 0 扇区)
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t codec;                  // audio_flash_log_codec_t
+    uint8_t channels;
+    uint32_t sample_rate;
+    uint32_t block_size;            // ADPCM 每通道子块字节数, PCM 为 0
+    uint32_t data_size;             // 数据字节数
+    uint32_t frames;                // 采样帧数
+    uint32_t sequence;              // 录音序号, 每次录音加 1
+    uint32_t dropped_frames;        // 录音期间丢弃的帧数 (DMA 或写入来不及)
+    uint32_t dma_dropped_frames;    // 其中 I2S 接收队列溢出丢失的帧数
+} audio_flash_log_header_t;
+
+/**
+ * @brief 闪存操作统计 (audio_flash_log_begin() 时清零)
+ */
+typedef struct {
+    size_t bytes_written;           // 已写入的数据字节数
+    uint32_t erases;                // 擦除的扇区数
+    uint32_t inline_erases;         // 写入时才擦除的扇区数 (预擦除不足)
+    uint32_t writes;                // esp_partition_write 调用次数
+    int64_t erase_us;               // 擦除累计耗时
+    int64_t write_us;               // 写入累计耗时
+    uint32_t max_erase_us;          // 单次擦除最长耗时
+    uint32_t max_write_us;          // 单次写入最长耗时
+} audio_flash_log_stats_t;
+
+/**
+ * @brief 写入层状态
+ */
+typedef struct {
+    const esp_partition_t *part;
+    size_t capacity;                // 数据区容量 (分区大小 - 一个扇区)
+    size_t written;                 // 数据区已写入长度
+    size_t erased;                  // 数据区已擦除长度 (扇区对齐)
+    audio_flash_log_stats_t stats;
+} audio_flash_log_t;
+
+/**
+ * @brief 绑定分区
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_SIZE 分区小于两个扇区
+ */
+esp_err_t audio_flash_log_open(audio_flash_log_t *log, const esp_partition_t *part);
+
+/**
+ * @brief 读取录音头
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_FOUND 没有完整的录音
+ */
+esp_err_t audio_flash_log_read_header(audio_flash_log_t *log, audio_flash_log_header_t *header);
+
+/**
+ * @brief 开始一次新的录音: 擦除录音头 (旧录音失效) 并预擦除数据区开头
+ * @param pre_erase 预擦除的数据区长度 (向上取整到扇区, 不超过容量)
+ */
+esp_err_t audio_flash_log_begin(audio_flash_log_t *log, size_t pre_erase);
+
+/**
+ * @brief 追加数据
+ * @details 按 AUDIO_FLASH_LOG_WRITE_CHUNK 分段写入, 未预擦除的扇区在写入前逐个擦除 (计入 inline_erases).
+ *          双缓冲的块长度应为扇区大小的整数倍, 使每次追加都从扇区边界开始; 只有最后一次可以不足一个扇区
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_SIZE 数据区已满 (写入能容纳的部分), 其他为闪存错误
+ */
+esp_err_t audio_flash_log_append(audio_flash_log_t *log, const uint8_t *data, size_t len);
+
+/**
+ * @brief 提前擦除一个扇区
+ * @details 已擦除长度领先写入位置不足 lead 时擦除一个扇区, 每次调用最多擦除一个扇区,
+ *          调用方可在两次调用之间检查停止条件
+ * @param lead 目标领先长度
+ * @return true 擦除了一个扇区, false 已领先足够、数据区已全部擦除或闪存错误
+ */
+bool audio_flash_log_erase_ahead(audio_flash_log_t *log, size_t lead);
+
+/**
+ * @brief 结束录音, 写入录音头 (data_size 取已写入长度)
+ */
+esp_err_t audio_flash_log_finish(audio_flash_log_t *log, audio_flash_log_header_t *header);
+
+/**
+ * @brief 读取数据区
+ * @param offset 数据区偏移
+ */
+esp_err_t audio_flash_log_read(audio_flash_log_t *log, size_t offset, void *dst, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_FLASH_LOG_H_ */
@@ -0,0 +1,387 @@
+/**
+ * @file audio_monitor.c
+ * @brief 低时延监听 (侧音) 通路
+ */
+
+#include <math.h>
+#include "audio_monitor.h"
+#include "board.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+
+static const char *TAG = "MONITOR";
+
+#define MONITOR_FRAMES          BOARD_AUDIO_MONITOR_DMA_FRAME_NUM
+#define MONITOR_CH              BOARD_AUDIO_PLAYBACK_CHANNELS
+#define MONITOR_BLOCK_BYTES     (MONITOR_FRAMES * MONITOR_CH * sizeof(int16_t))
+#define MONITOR_BLOCK_COUNT     4           // 采集块环形缓冲, 队列最多排队 COUNT - 2 块
+#define MONITOR_REMOTE_MS       40          // 远端音频缓冲时长
+#define MONITOR_TASK_STACK      3072
+#define MONITOR_PROBE_TIMEOUT_MS 200        // 单次测量等待脉冲返回的时长
+#define MONITOR_PROBE_FLOOR     1000        // 脉冲检测最低门限 (约 -30 dBFS)
+
+_Static_assert(MONITOR_CH == 2, "监听通路按立体声采集和回放");
+
+typedef enum {
+    PROBE_IDLE = 0,
+    PROBE_NOISE,            // 采集任务统计底噪
+    PROBE_EMIT,             // 回放任务插入脉冲
+    PROBE_WAIT,             // 采集任务等待脉冲返回
+    PROBE_DONE,
+} probe_state_t;
+
+static struct {
+    volatile bool active;
+    volatile bool stop;
+    i2s_chan_handle_t *tx_ref;
+    i2s_chan_handle_t *rx_ref;
+    uint32_t sample_rate;
+    volatile int32_t gain_q15;
+    int16_t blocks[MONITOR_BLOCK_COUNT][MONITOR_FRAMES * MONITOR_CH];
+    QueueHandle_t full_q;           // 已采集的块下标
+    StreamBufferHandle_t remote;
+    SemaphoreHandle_t remote_lock;  // 保护 active 检查与远端写入, 停止时先清 active 再释放 remote
+    volatile bool remote_flowing;
+    SemaphoreHandle_t done;         // 任务退出
+    audio_monitor_stats_t stats;
+    // 时延测量
+    volatile probe_state_t probe;
+    volatile int32_t probe_noise;
+    volatile int64_t probe_emit_us;
+    volatile int64_t probe_detect_us;
+} s_mon;
+
+/* 测量脉冲: 一个 DMA 周期的 Hann 窗音调, 约 -6 dBFS */
+static int16_t s_probe_burst[MONITOR_FRAMES];
+
+static int32_t monitor_gain_q15(float gain_db)
+{
+    if (gain_db < -60.0f) {
+        return 0;
+    }
+    if (gain_db > 12.0f) {
+        gain_db = 12.0f;
+    }
+    return (int32_t)lrintf(32768.0f * powf(10.0f, gain_db / 20.0f));
+}
+
+/**
+ * @brief 采集任务: 每个 DMA 周期读取一块交给回放任务
+ */
+static void monitor_capture_task(void *arg)
+{
+    i2s_chan_handle_t rx = *s_mon.rx_ref;
+    int idx = 0;
+
+    while (!s_mon.stop) {
+        int16_t *blk = s_mon.blocks[idx];
+        size_t got = 0;
+        if (i2s_channel_read(rx, blk, MONITOR_BLOCK_BYTES, &got, pdMS_TO_TICKS(100)) != ESP_OK ||
+            got != MONITOR_BLOCK_BYTES) {
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+
+        // 测量模式: 统计底噪, 或检测脉冲到达
+        probe_state_t probe = s_mon.probe;
+        if (probe == PROBE_NOISE || probe == PROBE_WAIT) {
+            int32_t peak = 0;
+            for (int i = 0; i < MONITOR_FRAMES * MONITOR_CH; i++) {
+                int32_t v = abs(blk[i]);
+                peak = v > peak ? v : peak;
+            }
+            if (probe == PROBE_NOISE) {
+                s_mon.probe_noise = peak > s_mon.probe_noise ? peak : s_mon.probe_noise;
+            } else if (peak > MONITOR_PROBE_FLOOR && peak > s_mon.probe_noise * 4) {
+                s_mon.probe_detect_us = now;
+                s_mon.probe = PROBE_DONE;
+            }
+        }
+
+        uint8_t ready = (uint8_t)idx;
+        if (xQueueSend(s_mon.full_q, &ready, 0) == pdTRUE) {
+            idx = (idx + 1) % MONITOR_BLOCK_COUNT;
+        } else {
+            s_mon.stats.capture_overruns++;
+        }
+    }
+
+    xSemaphoreGive(s_mon.done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 回放任务: 侧音乘增益, 混入远端音频后写入发送通道
+ */
+static void monitor_playback_task(void *arg)
+{
+    i2s_chan_handle_t tx = *s_mon.tx_ref;
+    static int16_t out[MONITOR_FRAMES * MONITOR_CH];
+    static int16_t remote[MONITOR_FRAMES * MONITOR_CH];
+
+    while (!s_mon.stop) {
+        uint8_t idx;
+        if (xQueueReceive(s_mon.full_q, &idx, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+        int64_t t0 = esp_timer_get_time();
+
+        size_t rb = xStreamBufferReceive(s_mon.remote, remote, MONITOR_BLOCK_BYTES, 0);
+        if (rb < MONITOR_BLOCK_BYTES) {
+            memset((uint8_t *)remote + rb, 0, MONITOR_BLOCK_BYTES - rb);
+            if (s_mon.remote_flowing) {
+                s_mon.stats.remote_underruns++;
+                s_mon.remote_flowing = false;
+            }
+        }
+
+        const int16_t *mic = s_mon.blocks[idx];
+        int32_t gain = s_mon.gain_q15;
+        for (int i = 0; i < MONITOR_FRAMES * MONITOR_CH; i++) {
+            int32_t v = (int32_t)(((int64_t)mic[i] * gain) >> 15) + remote[i];
+            out[i] = (int16_t)(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+        }
+
+        bool probe = (s_mon.probe == PROBE_EMIT);
+        if (probe) {
+            for (int i = 0; i < MONITOR_FRAMES; i++) {
+                out[i * MONITOR_CH] = out[i * MONITOR_CH + 1] = s_probe_burst[i];
+            }
+        }
+
+        uint32_t process_us = (uint32_t)(esp_timer_get_time() - t0);
+        if (process_us > s_mon.stats.max_process_us) {
+            s_mon.stats.max_process_us = process_us;
+        }
+
+        int64_t t_write = esp_timer_get_time();
+        size_t written = 0;
+        i2s_channel_write(tx, out, MONITOR_BLOCK_BYTES, &written, pdMS_TO_TICKS(100));
+        if (probe) {
+            s_mon.probe_emit_us = t_write;
+            s_mon.probe = PROBE_WAIT;
+        }
+        s_mon.stats.blocks++;
+    }
+
+    xSemaphoreGive(s_mon.done);
+    vTaskDelete(NULL);
+}
+
+static void monitor_release(void)
+{
+    if (s_mon.full_q != NULL) {
+        vQueueDelete(s_mon.full_q);
+        s_mon.full_q = NULL;
+    }
+    if (s_mon.remote != NULL) {
+        vStreamBufferDelete(s_mon.remote);
+        s_mon.remote = NULL;
+    }
+    if (s_mon.done != NULL) {
+        vSemaphoreDelete(s_mon.done);
+        s_mon.done = NULL;
+    }
+}
+
+esp_err_t audio_monitor_start(i2s_chan_handle_t *tx_handle, i2s_chan_handle_t *rx_handle, float gain_db)
+{
+    if (tx_handle == NULL || rx_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mon.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_mon.remote_lock == NULL) {
+        s_mon.remote_lock = xSemaphoreCreateMutex();
+        if (s_mon.remote_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    esp_err_t ret = board_audio_reinit_channels(tx_handle, rx_handle, BOARD_AUDIO_MONITOR_DMA_DESC_NUM,
+                                                BOARD_AUDIO_MONITOR_DMA_FRAME_NUM);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "重建I2S通道失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    s_mon.sample_rate = board_audio_get_sample_rate();
+    size_t remote_bytes = (size_t)s_mon.sample_rate * MONITOR_REMOTE_MS / 1000 * MONITOR_CH * sizeof(int16_t);
+    s_mon.full_q = xQueueCreate(MONITOR_BLOCK_COUNT - 2, sizeof(uint8_t));
+    s_mon.remote = xStreamBufferCreate(remote_bytes, MONITOR_BLOCK_BYTES);
+    s_mon.done = xSemaphoreCreateCounting(2, 0);
+    if (s_mon.full_q == NULL || s_mon.remote == NULL || s_mon.done == NULL) {
+        monitor_release();
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < MONITOR_FRAMES; i++) {
+        float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / (MONITOR_FRAMES - 1));
+        s_probe_burst[i] = (int16_t)(16384.0f * w * sinf(2.0f * (float)M_PI * 3000.0f * i / s_mon.sample_rate));
+    }
+
+    s_mon.tx_ref = tx_handle;
+    s_mon.rx_ref = rx_handle;
+    s_mon.gain_q15 = monitor_gain_q15(gain_db);
+    s_mon.stop = false;
+    s_mon.probe = PROBE_IDLE;
+    s_mon.remote_flowing = false;
+    memset(&s_mon.stats, 0, sizeof(s_mon.stats));
+    s_mon.stats.block_frames = MONITOR_FRAMES;
+    // 采集等待一个周期, 发送队列中最多有 desc_num 个周期
+    s_mon.stats.buffer_latency_us = (uint32_t)((uint64_t)MONITOR_FRAMES * (BOARD_AUDIO_MONITOR_DMA_DESC_NUM + 1) *
+                                               1000000 / s_mon.sample_rate);
+
+    ret = board_audio_duplex_start(*tx_handle, *rx_handle);
+    if (ret != ESP_OK) {
+        monitor_release();
+        return ret;
+    }
+
+    // 两个任务绑定同一核心, 采集优先级更高, 读到数据后立即切换到回放任务
+    int created = 0;
+    if (xTaskCreatePinnedToCore(monitor_capture_task, "mon_cap", MONITOR_TASK_STACK, NULL,
+                                BOARD_AUDIO_MONITOR_PRIORITY, NULL, BOARD_AUDIO_MONITOR_CORE) == pdPASS) {
+        created++;
+    }
+    if (created == 1 &&
+        xTaskCreatePinnedToCore(monitor_playback_task, "mon_play", MONITOR_TASK_STACK, NULL,
+                                BOARD_AUDIO_MONITOR_PRIORITY - 1, NULL, BOARD_AUDIO_MONITOR_CORE) == pdPASS) {
+        created++;
+    }
+    if (created < 2) {
+        s_mon.stop = true;
+        for (int i = 0; i < created; i++) {
+            xSemaphoreTake(s_mon.done, portMAX_DELAY);
+        }
+        board_audio_duplex_stop(*tx_handle, *rx_handle);
+        monitor_release();
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_mon.remote_lock, portMAX_DELAY);
+    s_mon.active = true;
+    xSemaphoreGive(s_mon.remote_lock);
+    ESP_LOGI(TAG, "监听已启动: %u Hz, DMA %d x %d 帧, 缓冲时延约 %u us, 侧音增益 %.1f dB",
+             (unsigned int)s_mon.sample_rate, BOARD_AUDIO_MONITOR_DMA_DESC_NUM, MONITOR_FRAMES,
+             (unsigned int)s_mon.stats.buffer_latency_us, gain_db);
+    return ESP_OK;
+}
+
+esp_err_t audio_monitor_stop(void)
+{
+    if (!s_mon.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 先清 active: 之后 audio_monitor_write_remote() 不再访问远端缓冲, 正在写入的调用结束后才能释放
+    xSemaphoreTake(s_mon.remote_lock, portMAX_DELAY);
+    s_mon.active = false;
+    xSemaphoreGive(s_mon.remote_lock);
+
+    s_mon.stop = true;
+    xSemaphoreTake(s_mon.done, portMAX_DELAY);
+    xSemaphoreTake(s_mon.done, portMAX_DELAY);
+    board_audio_duplex_stop(*s_mon.tx_ref, *s_mon.rx_ref);
+    monitor_release();
+
+    ESP_LOGI(TAG, "监听已停止: %u 块, 丢弃采集 %u 块, 远端欠载 %u 次, 最长处理 %u us",
+             (unsigned int)s_mon.stats.blocks, (unsigned int)s_mon.stats.capture_overruns,
+             (unsigned int)s_mon.stats.remote_underruns, (unsigned int)s_mon.stats.max_process_us);
+
+    // 恢复监听前的 DMA 档位, 普通播放需要较大的缓冲余量
+    return board_audio_set_dma_profile(board_audio_get_dma_profile(), s_mon.tx_ref, s_mon.rx_ref);
+}
+
+bool audio_monitor_is_active(void)
+{
+    return s_mon.active;
+}
+
+void audio_monitor_set_gain(float gain_db)
+{
+    s_mon.gain_q15 = monitor_gain_q15(gain_db);
+}
+
+size_t audio_monitor_write_remote(const uint8_t *data, size_t size)
+{
+    if (!s_mon.active || data == NULL) {
+        return 0;
+    }
+    // 在锁内重新检查, 与 audio_monitor_stop() 的释放互斥 (调用方在 WebSocket 任务中)
+    size_t written = 0;
+    xSemaphoreTake(s_mon.remote_lock, portMAX_DELAY);
+    if (s_mon.active) {
+        written = xStreamBufferSend(s_mon.remote, data, size, 0);
+        s_mon.remote_flowing = true;
+    }
+    xSemaphoreGive(s_mon.remote_lock);
+    return written;
+}
+
+esp_err_t audio_monitor_measure_latency(int count, audio_monitor_latency_t *result)
+{
+    if (result == NULL || count <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mon.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->min_us = UINT32_MAX;
+    uint64_t sum = 0;
+
+    // 侧音静音, 避免脉冲经监听通路反复循环
+    int32_t saved_gain = s_mon.gain_q15;
+    s_mon.gain_q15 = 0;
+
+    for (int n = 0; n < count && s_mon.active; n++) {
+        // 等待上一次脉冲的余响衰减, 同时统计底噪
+        s_mon.probe_noise = 0;
+        s_mon.probe = PROBE_NOISE;
+        vTaskDelay(pdMS_TO_TICKS(100));
+
+        s_mon.probe = PROBE_EMIT;
+        int waited = 0;
+        while (s_mon.probe != PROBE_DONE && waited < MONITOR_PROBE_TIMEOUT_MS) {
+            vTaskDelay(pdMS_TO_TICKS(5));
+            waited += 5;
+        }
+        if (s_mon.probe != PROBE_DONE) {
+            ESP_LOGW(TAG, "第 %d 次测量未检测到脉冲 (底噪 %d)", n + 1, (int)s_mon.probe_noise);
+            continue;
+        }
+
+        uint32_t us = (uint32_t)(s_mon.probe_detect_us - s_mon.probe_emit_us);
+        result->min_us = us < result->min_us ? us : result->min_us;
+        result->max_us = us > result->max_us ? us : result->max_us;
+        sum += us;
+        result->count++;
+    }
+    s_mon.probe = PROBE_IDLE;
+    s_mon.gain_q15 = saved_gain;
+
+    if (result->count == 0) {
+        result->min_us = 0;
+        return ESP_ERR_TIMEOUT;
+    }
+    result->avg_us = (uint32_t)(sum / result->count);
+    if (result->avg_us > BOARD_AUDIO_MONITOR_LATENCY_BUDGET_US) {
+        ESP_LOGW(TAG, "回环时延 %u us 超过目标 %d us", (unsigned int)result->avg_us,
+                 BOARD_AUDIO_MONITOR_LATENCY_BUDGET_US);
+    }
+    ESP_LOGI(TAG, "回环时延 (%d 次): 最小 %u us, 平均 %u us, 最大 %u us", result->count,
+             (unsigned int)result->min_us, (unsigned int)result->avg_us, (unsigned int)result->max_us);
+    return ESP_OK;
+}
+
+void audio_monitor_get_stats(audio_monitor_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = s_mon.stats;
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file audio_monitor.h
+ * @brief 低时延监听 (侧音) 通路
+ * @details 对讲时用户需要同时听到自己和远端的声音. 监听通路以小 DMA 周期重建 I2S 通道,
+ *          采集任务每读到一个 DMA 周期的 ES7210 数据就交给回放任务, 回放任务乘以侧音增益、
+ *          混入远端音频后在下一个 DMA 周期写入 ES8311. 两个任务绑定在同一核心上, 不经过播放 DSP
+ *          (限幅器前瞻会增加时延), 设备端时延目标 < 5ms.
+ *          监听期间 I2S 通道被独占, 普通播放和录音返回错误; 停止后恢复原 DMA 档位.
+ */
+
+#ifndef _AUDIO_MONITOR_H_
+#define _AUDIO_MONITOR_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2s_std.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 监听通路统计 (audio_monitor_start() 时清零)
+ */
+typedef struct {
+    uint32_t blocks;                // 已回放的 DMA 周期数
+    uint32_t block_frames;          // 每个 DMA 周期的帧数
+    uint32_t capture_overruns;      // 回放任务来不及处理而丢弃的采集块
+    uint32_t remote_underruns;      // 远端音频不足, 以静音补齐的块数
+    uint32_t max_process_us;        // 单块混音处理最长耗时
+    uint32_t buffer_latency_us;     // DMA 缓冲理论时延 (采集一个周期 + 发送队列)
+} audio_monitor_stats_t;
+
+/**
+ * @brief 回环时延测量结果
+ */
+typedef struct {
+    int count;                      // 成功测量的次数
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+} audio_monitor_latency_t;
+
+/**
+ * @brief 启动监听通路
+ * @details 以 BOARD_AUDIO_MONITOR_DMA_* 重建 I2S 通道并创建采集/回放任务
+ * @param[in,out] tx_handle 发送通道句柄 (会被重建)
+ * @param[in,out] rx_handle 接收通道句柄 (会被重建)
+ * @param gain_db 侧音增益 (dB), 低于 -60 视为静音
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 已在监听或通道正在使用, 其他失败
+ */
+esp_err_t audio_monitor_start(i2s_chan_handle_t *tx_handle, i2s_chan_handle_t *rx_handle, float gain_db);
+
+/**
+ * @brief 停止监听通路, 以监听前的 DMA 档位重建 I2S 通道
+ */
+esp_err_t audio_monitor_stop(void);
+
+/**
+ * @brief 是否正在监听
+ */
+bool audio_monitor_is_active(void);
+
+/**
+ * @brief 修改侧音增益, 下一个 DMA 周期生效
+ * @param gain_db 增益 (dB), 最大 +12dB
+ */
+void audio_monitor_set_gain(float gain_db);
+
+/**
+ * @brief 写入远端音频, 与侧音混合后播放
+ * @param data 交织 16 位 PCM (BOARD_AUDIO_PLAYBACK_CHANNELS 通道, 当前采样率), 应为整帧
+ * @param size 数据大小 (字节)
+ * @return 实际写入的字节数, 缓冲区满时丢弃多余部分
+ */
+size_t audio_monitor_write_remote(const uint8_t *data, size_t size);
+
+/**
+ * @brief 测量回环时延 (测试模式)
+ * @details 期间侧音暂时静音. 回放任务在输出中插入短促的音调脉冲, 记录交给 DMA 的时刻;
+ *          采集任务检测到脉冲 (喇叭 -> 麦克风) 的时刻之差即为发送缓冲 + 声学路径 + 采集缓冲的时延,
+ *          与麦克风到喇叭的监听时延相当 (精度为一个 DMA 周期)
+ * @param count 测量次数
+ * @param[out] result 测量结果
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 未在监听, ESP_ERR_TIMEOUT 未检测到脉冲
+ */
+esp_err_t audio_monitor_measure_latency(int count, audio_monitor_latency_t *result);
+
+/**
+ * @brief 获取监听通路统计
+ * @param[out] stats 统计信息
+ */
+void audio_monitor_get_stats(audio_monitor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_MONITOR_H_ */
@@ -0,0 +1,447 @@
+/**
+ * @file audio_outbox.c
+ * @brief 离线录音队列 (存储转发)
+ */
+
+#include <string.h>
+#include "audio_outbox.h"
+#include "board.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "OUTBOX";
+
+#define OUTBOX_MAX_ITEMS        CONFIG_AUDIO_OUTBOX_MAX_ITEMS
+#define OUTBOX_BUDGET           ((size_t)CONFIG_AUDIO_OUTBOX_KB * 1024)
+#define OUTBOX_UPLOAD_KBPS      CONFIG_AUDIO_OUTBOX_UPLOAD_KBPS
+#define OUTBOX_TASK_STACK       4096
+#define OUTBOX_TASK_PRIO        2           // 低于 WebSocket 任务和其他事件任务
+#define OUTBOX_TX_SLOTS         2           // 最多在 WebSocket 发送队列中排队的分块数
+#define OUTBOX_ACK_TIMEOUT_MS   3000        // 没有确认推进时从最后确认的偏移重发
+#define OUTBOX_ACK_POLL_MS      20
+#define OUTBOX_ACK_QUEUE_LEN    16
+
+_Static_assert(BOARD_AUDIO_POOL_BLOCK_SIZE % AUDIO_OUTBOX_CHUNK_SIZE == 0, "二进制帧不能跨越缓冲区池块");
+
+typedef struct {
+    audio_chain_t chain;
+    audio_outbox_meta_t meta;
+    bool started;                   // 已发送过 upload_begin, up 保存续传状态
+    audio_upload_t up;
+} outbox_item_t;
+
+typedef struct {
+    uint32_t upload_id;
+    uint32_t offset;
+    bool nack;
+} outbox_ack_t;
+
+static struct {
+    outbox_item_t *items;           // 按入队顺序排列, items[0] 最旧 (PSRAM)
+    uint16_t count;
+    size_t bytes;                   // 排队录音占用的块链总长度
+    bool sending;                   // items[0] 正在上传, 不能丢弃
+    uint32_t next_sequence;
+    SemaphoreHandle_t lock;         // 保护队列
+    SemaphoreHandle_t send_lock;    // 入队单条消息期间持有, audio_outbox_pause() 等待
+    SemaphoreHandle_t tx_slots;     // 发送槽计数, 分块写完或被丢弃时归还
+    audio_upload_chunk_hdr_t tx_hdr[OUTBOX_TX_SLOTS];  // 排队分块的头部 (数据直接引用缓冲区池块)
+    uint8_t tx_next;
+    SemaphoreHandle_t kick;         // 唤醒发送任务
+    QueueHandle_t ack_q;            // 服务器的 upload_ack / upload_nack
+    esp_websocket_client_handle_t volatile client;
+    audio_outbox_stats_t stats;
+} s_ob;
+
+/**
+ * @brief 移除 items[idx] (调用者持有 lock)
+ * @param release 是否归还块链
+ */
+static void outbox_remove(uint16_t idx, bool release)
+{
+    outbox_item_t *it = &s_ob.items[idx];
+    s_ob.bytes -= it->chain.length;
+    if (release) {
+        audio_pool_free(&it->chain);
+    }
+    memmove(&s_ob.items[idx], &s_ob.items[idx + 1], (s_ob.count - idx - 1) * sizeof(outbox_item_t));
+    s_ob.count--;
+}
+
+/**
+ * @brief 丢弃最旧的一条 (跳过正在上传的队首, 调用者持有 lock)
+ * @return 是否丢弃了一条
+ */
+static bool outbox_evict_oldest(void)
+{
+    uint16_t idx = s_ob.sending ? 1 : 0;
+    if (idx >= s_ob.count) {
+        return false;
+    }
+    ESP_LOGW(TAG, "丢弃排队录音 #%u (%u 字节)", (unsigned int)s_ob.items[idx].meta.sequence,
+             (unsigned int)s_ob.items[idx].meta.size);
+    outbox_remove(idx, true);
+    s_ob.stats.evicted++;
+    return true;
+}
+
+/**
+ * @brief 分块写完或因断开被丢弃 (WebSocket 任务中调用)
+ */
+static void outbox_tx_done(void *arg, bool sent)
+{
+    xSemaphoreGive(s_ob.tx_slots);
+}
+
+/**
+ * @brief 等待排队的分块全部写完或被丢弃, 之后才能归还或移动它们引用的块链
+ */
+static void outbox_wait_tx_idle(void)
+{
+    for (int i = 0; i < OUTBOX_TX_SLOTS; i++) {
+        xSemaphoreTake(s_ob.tx_slots, portMAX_DELAY);
+    }
+    for (int i = 0; i < OUTBOX_TX_SLOTS; i++) {
+        xSemaphoreGive(s_ob.tx_slots);
+    }
+}
+
+/**
+ * @brief 把一条上传消息放入 WebSocket 发送队列的批量通道, 连接已暂停或已断开时返回 false
+ * @details 批量通道排在控制通道之后, 上传不会推迟其他事件的回复. 文本消息复制入队;
+ *          分块的头部复制到发送槽, 数据直接引用缓冲区池块, 与头部组成一个二进制帧.
+ *          发送槽用完时等待, 上传速度不会超过网络的实际发送速度
+ * @param hdr 分块头部, 为 NULL 时 data 为文本消息
+ */
+static bool outbox_send(esp_websocket_client_handle_t client, const audio_upload_chunk_hdr_t *hdr, const void *data,
+                        size_t len)
+{
+    if (hdr != NULL) {
+        while (xSemaphoreTake(s_ob.tx_slots, pdMS_TO_TICKS(OUTBOX_ACK_POLL_MS)) != pdTRUE) {
+            if (s_ob.client != client) {
+                return false;
+            }
+        }
+    }
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_ob.send_lock, portMAX_DELAY);
+    if (s_ob.client == client) {
+        if (hdr == NULL) {
+            ret = esp_websocket_client_enqueue(client, WEBSOCKET_TX_LANE_BULK, WS_TRANSPORT_OPCODES_TEXT,
+                                               (const char *)data, len);
+        } else {
+            // 发送槽按顺序轮换, 队列先进先出, 被覆盖的槽所属的分块已经写完
+            audio_upload_chunk_hdr_t *slot = &s_ob.tx_hdr[s_ob.tx_next];
+            s_ob.tx_next = (s_ob.tx_next + 1) % OUTBOX_TX_SLOTS;
+            *slot = *hdr;
+            const esp_websocket_iov_t iov[2] = {{slot, sizeof(*slot)}, {data, len}};
+            ret = esp_websocket_client_enqueue_iov(client, WEBSOCKET_TX_LANE_BULK, WS_TRANSPORT_OPCODES_BINARY, iov, 2,
+                                                   outbox_tx_done, NULL);
+        }
+    }
+    xSemaphoreGive(s_ob.send_lock);
+    if (ret != ESP_OK && hdr != NULL) {
+        xSemaphoreGive(s_ob.tx_slots);
+    }
+    if (ret == ESP_ERR_NO_MEM) {
+        ESP_LOGW(TAG, "WebSocket 发送队列已满");
+    }
+    return ret == ESP_OK;
+}
+
+/**
+ * @brief 等待一条属于 up 的确认并处理
+ * @return true 确认推进了 (或收到否认)
+ */
+static bool outbox_wait_ack(audio_upload_t *up, TickType_t wait)
+{
+    bool progress = false;
+    outbox_ack_t ack;
+    while (xQueueReceive(s_ob.ack_q, &ack, wait) == pdTRUE) {
+        wait = 0;
+        if (ack.upload_id != up->id) {
+            continue;
+        }
+        if (ack.nack) {
+            audio_upload_on_nack(up, ack.offset);
+            progress = true;
+        } else if (audio_upload_on_ack(up, ack.offset)) {
+            progress = true;
+        }
+    }
+    return progress;
+}
+
+/**
+ * @brief 上传队首录音, 按 OUTBOX_UPLOAD_KBPS 限速; 断开时保留续传状态
+ */
+static esp_err_t outbox_upload(esp_websocket_client_handle_t client, outbox_item_t *it)
+{
+    const audio_outbox_meta_t *m = &it->meta;
+    audio_upload_t *up = &it->up;
+    if (!it->started) {
+        audio_upload_init(up, m->upload_id, m->size, AUDIO_OUTBOX_CHUNK_SIZE, AUDIO_OUTBOX_WINDOW);
+        it->started = true;
+    }
+    xQueueReset(s_ob.ack_q);
+
+    char msg[320];
+    int len = snprintf(msg, sizeof(msg),
+                       "{\"event\":\"upload_begin\",\"data\":{\"id\":%u,\"sequence\":%u,\"size\":%u,"
+                       "\"chunk_size\":%u,\"window\":%u,\"sample_rate\":%u,\"channels\":%u,\"duration_ms\":%u,"
+                       "\"age_ms\":%u,\"shortened\":%s}}",
+                       (unsigned int)up->id, (unsigned int)m->sequence, (unsigned int)m->size,
+                       (unsigned int)up->chunk_size, up->window, (unsigned int)m->sample_rate,
+                       (unsigned int)m->channels, (unsigned int)m->duration_ms,
+                       (unsigned int)((esp_timer_get_time() - m->recorded_at_us) / 1000),
+                       m->shortened ? "true" : "false");
+    if (!outbox_send(client, NULL, msg, len)) {
+        return ESP_FAIL;
+    }
+
+    // 服务器以已收到的偏移回复 upload_begin, 新上传为 0
+    outbox_ack_t ack;
+    int64_t deadline = esp_timer_get_time() + OUTBOX_ACK_TIMEOUT_MS * 1000LL;
+    bool begun = false;
+    while (!begun && esp_timer_get_time() < deadline && s_ob.client == client) {
+        if (xQueueReceive(s_ob.ack_q, &ack, pdMS_TO_TICKS(OUTBOX_ACK_POLL_MS)) == pdTRUE && ack.upload_id == up->id) {
+            begun = true;
+        }
+    }
+    if (!begun) {
+        ESP_LOGW(TAG, "录音 #%u 没有收到 upload_begin 的确认", (unsigned int)m->sequence);
+        return ESP_ERR_TIMEOUT;
+    }
+    if (ack.offset > 0 || up->high_water > 0) {
+        ESP_LOGI(TAG, "录音 #%u 从 %u/%u 字节续传", (unsigned int)m->sequence, (unsigned int)ack.offset,
+                 (unsigned int)m->size);
+        audio_upload_on_resume(up, ack.offset);
+    }
+
+    // 令牌桶: 每发送一个分块, 下一块的最早发送时间推后 分块长度 / 限速
+    const int64_t us_per_kb = 1000000 / OUTBOX_UPLOAD_KBPS;
+    int64_t next_us = esp_timer_get_time();
+    int64_t last_progress = next_us;
+    while (!audio_upload_done(up)) {
+        if (s_ob.client != client) {
+            return ESP_FAIL;
+        }
+        int64_t now = esp_timer_get_time();
+        TickType_t wait = pdMS_TO_TICKS(OUTBOX_ACK_POLL_MS);
+        size_t off, n;
+        if (now < next_us) {
+            TickType_t until = pdMS_TO_TICKS((next_us - now) / 1000) + 1;
+            wait = until < wait ? until : wait;
+        } else if (audio_upload_next(up, &off, &n)) {
+            // 数据直接从缓冲区池块发送 (分块不跨块), 与栈上的 24 字节头部组成同一帧
+            const uint8_t *p = it->chain.blocks[off / BOARD_AUDIO_POOL_BLOCK_SIZE] + off % BOARD_AUDIO_POOL_BLOCK_SIZE;
+            audio_upload_chunk_hdr_t hdr;
+            audio_upload_fill_header(up, off, p, n, &hdr);
+            if (!outbox_send(client, &hdr, p, n)) {
+                ESP_LOGW(TAG, "录音 #%u 上传中断于 %u/%u 字节", (unsigned int)m->sequence, (unsigned int)up->acked,
+                         (unsigned int)m->size);
+                return ESP_FAIL;
+            }
+            next_us = (next_us > now ? next_us : now) + (int64_t)(n + sizeof(hdr)) * us_per_kb / 1024;
+            wait = 0;
+        }
+
+        if (outbox_wait_ack(up, wait)) {
+            last_progress = esp_timer_get_time();
+        } else if (audio_upload_in_flight(up) && esp_timer_get_time() - last_progress > OUTBOX_ACK_TIMEOUT_MS * 1000LL) {
+            ESP_LOGW(TAG, "录音 #%u 确认超时, 从 %u 字节重发", (unsigned int)m->sequence, (unsigned int)up->acked);
+            audio_upload_on_timeout(up);
+            last_progress = esp_timer_get_time();
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 发送任务: 连接可用时按入队顺序逐条上传
+ */
+static void outbox_task(void *arg)
+{
+    while (1) {
+        xSemaphoreTake(s_ob.kick, portMAX_DELAY);
+
+        while (1) {
+            esp_websocket_client_handle_t client = s_ob.client;
+            xSemaphoreTake(s_ob.lock, portMAX_DELAY);
+            if (client == NULL || s_ob.count == 0) {
+                xSemaphoreGive(s_ob.lock);
+                break;
+            }
+            s_ob.sending = true;
+            outbox_item_t *it = &s_ob.items[0];         // 正在上传的队首不会被移动或丢弃
+            audio_upload_stats_t before = it->up.stats;
+            if (!it->started) {
+                memset(&before, 0, sizeof(before));
+            }
+            xSemaphoreGive(s_ob.lock);
+
+            ESP_LOGI(TAG, "上传排队录音 #%u (%u 字节, 剩余 %u 条)", (unsigned int)it->meta.sequence,
+                     (unsigned int)it->meta.size, (unsigned int)s_ob.count - 1);
+            int64_t t0 = esp_timer_get_time();
+            esp_err_t ret = outbox_upload(client, it);
+            outbox_wait_tx_idle();
+
+            xSemaphoreTake(s_ob.lock, portMAX_DELAY);
+            s_ob.sending = false;
+            const audio_upload_stats_t *after = &it->up.stats;
+            s_ob.stats.retransmitted_bytes += after->retransmitted_bytes - before.retransmitted_bytes;
+            s_ob.stats.nacks += after->nacks - before.nacks;
+            s_ob.stats.ack_timeouts += after->timeouts - before.timeouts;
+            s_ob.stats.resumes += after->resumes - before.resumes;
+            if (ret == ESP_OK) {
+                ESP_LOGI(TAG, "录音 #%u 上传完成, 耗时 %u ms, 重发 %u 字节", (unsigned int)it->meta.sequence,
+                         (unsigned int)((esp_timer_get_time() - t0) / 1000),
+                         (unsigned int)after->retransmitted_bytes);
+                s_ob.stats.uploaded++;
+                s_ob.stats.uploaded_bytes += it->meta.size;
+                outbox_remove(0, true);
+            } else {
+                s_ob.stats.retries++;
+            }
+            xSemaphoreGive(s_ob.lock);
+            if (ret != ESP_OK) {
+                break;      // 等待下一次连接
+            }
+        }
+    }
+}
+
+esp_err_t audio_outbox_init(void)
+{
+    if (s_ob.items != NULL) {
+        return ESP_OK;
+    }
+    s_ob.items = heap_caps_calloc(OUTBOX_MAX_ITEMS, sizeof(outbox_item_t), MALLOC_CAP_SPIRAM);
+    s_ob.lock = xSemaphoreCreateMutex();
+    s_ob.send_lock = xSemaphoreCreateMutex();
+    s_ob.tx_slots = xSemaphoreCreateCounting(OUTBOX_TX_SLOTS, OUTBOX_TX_SLOTS);
+    s_ob.kick = xSemaphoreCreateBinary();
+    s_ob.ack_q = xQueueCreate(OUTBOX_ACK_QUEUE_LEN, sizeof(outbox_ack_t));
+    if (s_ob.items == NULL || s_ob.lock == NULL || s_ob.send_lock == NULL || s_ob.tx_slots == NULL || s_ob.kick == NULL || s_ob.ack_q == NULL ||
+        xTaskCreate(outbox_task, "outbox", OUTBOX_TASK_STACK, NULL, OUTBOX_TASK_PRIO, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "离线录音队列初始化失败");
+        return ESP_ERR_NO_MEM;
+    }
+    s_ob.stats.upload_kbps = OUTBOX_UPLOAD_KBPS;
+    ESP_LOGI(TAG, "离线录音队列: 最多 %d 条 / %u KB, 上传限速 %d KB/s", OUTBOX_MAX_ITEMS,
+             (unsigned int)(OUTBOX_BUDGET / 1024), OUTBOX_UPLOAD_KBPS);
+    return ESP_OK;
+}
+
+esp_err_t audio_outbox_push(audio_chain_t *chain, audio_outbox_meta_t *meta)
+{
+    if (s_ob.items == NULL) {
+        audio_pool_free(chain);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_ob.lock, portMAX_DELAY);
+    meta->sequence = ++s_ob.next_sequence;
+    meta->upload_id = esp_random();
+    esp_err_t ret = ESP_OK;
+    if (chain->length > OUTBOX_BUDGET) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    // 先进先出, 超出条数或容量时丢弃最旧的录音
+    while (ret == ESP_OK && (s_ob.count >= OUTBOX_MAX_ITEMS || s_ob.bytes + chain->length > OUTBOX_BUDGET)) {
+        if (!outbox_evict_oldest()) {
+            ret = ESP_ERR_INVALID_SIZE;
+        }
+    }
+    if (ret == ESP_OK) {
+        outbox_item_t *it = &s_ob.items[s_ob.count++];
+        it->chain = *chain;
+        it->meta = *meta;
+        it->started = false;
+        s_ob.bytes += chain->length;
+        s_ob.stats.enqueued++;
+        chain->count = 0;
+        chain->length = 0;
+        ESP_LOGI(TAG, "录音 #%u 入队 (%u 字节), 排队 %u 条 / %u KB", (unsigned int)meta->sequence,
+                 (unsigned int)meta->size, (unsigned int)s_ob.count, (unsigned int)(s_ob.bytes / 1024));
+    } else {
+        s_ob.stats.rejected++;
+        audio_pool_free(chain);
+        ESP_LOGW(TAG, "录音 #%u (%u 字节) 超过队列容量, 已丢弃", (unsigned int)meta->sequence,
+                 (unsigned int)meta->size);
+    }
+    xSemaphoreGive(s_ob.lock);
+
+    xSemaphoreGive(s_ob.kick);
+    return ret;
+}
+
+int audio_outbox_reclaim(size_t bytes)
+{
+    if (s_ob.items == NULL) {
+        return 0;
+    }
+    int evicted = 0;
+    xSemaphoreTake(s_ob.lock, portMAX_DELAY);
+    while (1) {
+        audio_pool_stats_t st;
+        audio_pool_get_stats(&st);
+        if ((size_t)st.free_blocks * st.block_size >= bytes || !outbox_evict_oldest()) {
+            break;
+        }
+        evicted++;
+    }
+    xSemaphoreGive(s_ob.lock);
+    return evicted;
+}
+
+void audio_outbox_resume(esp_websocket_client_handle_t client)
+{
+    if (s_ob.items == NULL) {
+        return;
+    }
+    s_ob.client = client;
+    xSemaphoreGive(s_ob.kick);
+}
+
+void audio_outbox_pause(bool wait)
+{
+    s_ob.client = NULL;
+    if (wait && s_ob.send_lock != NULL) {
+        xSemaphoreTake(s_ob.send_lock, portMAX_DELAY);
+        xSemaphoreGive(s_ob.send_lock);
+    }
+}
+
+void audio_outbox_on_ack(uint32_t upload_id, size_t offset, bool nack)
+{
+    if (s_ob.ack_q == NULL) {
+        return;
+    }
+    outbox_ack_t ack = {
+        .upload_id = upload_id,
+        .offset = (uint32_t)offset,
+        .nack = nack,
+    };
+    // 队列满时丢弃: 累计确认, 后续的确认会覆盖
+    xQueueSend(s_ob.ack_q, &ack, 0);
+}
+
+void audio_outbox_get_stats(audio_outbox_stats_t *stats)
+{
+    if (s_ob.lock == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_ob.lock, portMAX_DELAY);
+    *stats = s_ob.stats;
+    stats->queued = s_ob.count;
+    stats->queued_bytes = s_ob.bytes;
+    xSemaphoreGive(s_ob.lock);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file audio_outbox.h
+ * @brief 离线录音队列 (存储转发)
+ * @details WebSocket 断开时完成的录音不再丢弃: 录音块链连同元数据移交给队列, 仍占用缓冲区池的 PSRAM 块.
+ *          队列按先进先出保存, 总长度不超过 CONFIG_AUDIO_OUTBOX_KB、条数不超过 CONFIG_AUDIO_OUTBOX_MAX_ITEMS,
+ *          超出时丢弃最旧的录音; 新录音借不到缓冲区池块时也先丢弃最旧的排队录音 (新录音优先).
+ *          重新连接后由发送任务按 CONFIG_AUDIO_OUTBOX_UPLOAD_KBPS 限速上传. 上传消息放入 WebSocket 发送队列的
+ *          批量通道, 客户端任务在每个分块帧之后先发送控制通道的回复, 不会被积压的上传阻塞.
+ *
+ *          上传使用 audio_upload 分块协议: 文本帧 upload_begin (上传 ID 和元数据) → 分块 (头部和直接从
+ *          缓冲区池块读取的数据由 esp_websocket_client_enqueue_iov() 组成一个二进制帧), 服务器以 upload_ack / upload_nack
+ *          确认. 上传中途断开时该录音保留在队首,
+ *          重新连接后以同一 ID 发送 upload_begin, 从服务器确认的偏移续传.
+ */
+
+#ifndef _AUDIO_OUTBOX_H_
+#define _AUDIO_OUTBOX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_websocket_client.h"
+#include "audio_pool.h"
+#include "audio_upload.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_OUTBOX_CHUNK_SIZE     4096    // 分块长度
+#define AUDIO_OUTBOX_WINDOW         8       // 最多未确认的分块数
+
+/**
+ * @brief 排队录音的元数据
+ */
+typedef struct {
+    uint32_t sequence;              // 入队序号 (由队列分配)
+    uint32_t upload_id;             // 上传 ID (由队列分配, 续传时不变)
+    uint32_t sample_rate;
+    uint8_t channels;
+    bool shortened;                 // 录音因缓冲区池预算被缩短
+    size_t size;                    // 录音字节数
+    uint32_t duration_ms;
+    int64_t recorded_at_us;         // 录音完成时间 (esp_timer)
+} audio_outbox_meta_t;
+
+/**
+ * @brief 队列统计
+ */
+typedef struct {
+    uint16_t queued;                // 当前排队条数
+    size_t queued_bytes;            // 当前排队字节数
+    uint32_t enqueued;              // 累计入队条数
+    uint32_t uploaded;              // 累计上传完成条数
+    uint32_t evicted;               // 因队列已满或新录音需要空间丢弃的条数
+    uint32_t rejected;              // 单条超过队列容量直接丢弃的条数
+    uint32_t retries;               // 上传中途断开 (之后续传) 的次数
+    size_t uploaded_bytes;          // 累计上传字节数 (不含重发)
+    size_t retransmitted_bytes;     // 累计重发字节数 (否认、确认超时或断开时未确认的分块)
+    uint32_t nacks;                 // 累计收到的 upload_nack 次数
+    uint32_t ack_timeouts;          // 累计确认超时次数
+    uint32_t resumes;               // 累计从非零偏移续传的次数
+    uint32_t upload_kbps;           // 上传限速
+} audio_outbox_stats_t;
+
+/**
+ * @brief 初始化队列并创建发送任务
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t audio_outbox_init(void);
+
+/**
+ * @brief 录音入队, 接管块链
+ * @details 成功或失败后 chain 都为空 (失败时块链已归还缓冲区池)
+ * @param[in,out] chain 录音块链
+ * @param[in,out] meta 元数据, 返回分配的序号
+ * @return esp_err_t ESP_OK 成功 (可能丢弃了更旧的录音), ESP_ERR_INVALID_SIZE 超过队列容量被丢弃,
+ *         ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_outbox_push(audio_chain_t *chain, audio_outbox_meta_t *meta);
+
+/**
+ * @brief 为新录音腾出缓冲区池空间: 丢弃最旧的排队录音, 直到空闲块不少于 bytes 或队列中只剩正在上传的录音
+ * @param bytes 需要的字节数
+ * @return 丢弃的条数
+ */
+int audio_outbox_reclaim(size_t bytes);
+
+/**
+ * @brief 连接建立后开始上传积压的录音 (WEBSOCKET_EVENT_CONNECTED 中调用)
+ * @param client WebSocket 客户端
+ */
+void audio_outbox_resume(esp_websocket_client_handle_t client);
+
+/**
+ * @brief 暂停上传
+ * @details 等待正在入队的消息完成后返回, 之后发送任务不再使用 client, 销毁客户端前调用
+ *          (已排队的分块由客户端在断开或销毁时丢弃).
+ *          在 WebSocket 事件回调中只需 wait 为 false
+ * @param wait 是否等待正在发送的帧完成
+ */
+void audio_outbox_pause(bool wait);
+
+/**
+ * @brief 收到服务器的 upload_ack / upload_nack (WebSocket 事件回调中调用, 不阻塞)
+ * @param upload_id 上传 ID
+ * @param offset 服务器已连续收到的字节数
+ * @param nack 是否为否认
+ */
+void audio_outbox_on_ack(uint32_t upload_id, size_t offset, bool nack);
+
+/**
+ * @brief 获取统计信息
+ */
+void audio_outbox_get_stats(audio_outbox_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_OUTBOX_H_ */
@@ -0,0 +1,247 @@
+/**
+ * @file audio_pool.c
+ * @brief 音频缓冲区池
+ */
+
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "audio_pool.h"
+#include "board.h"
+
+static const char *TAG = "POOL";
+
+#define AUDIO_POOL_BLOCKS_MAX   256     // PSRAM 块数上限 (16MB / 64KB)
+
+static uint8_t *s_base = NULL;          // PSRAM 区域起始
+static uint16_t s_blocks = 0;
+static bool s_used[AUDIO_POOL_BLOCKS_MAX];
+static uint16_t s_in_use = 0;
+
+static uint8_t *s_dma_base = NULL;      // 内部 RAM 暂存块区域起始
+static bool s_dma_used[BOARD_AUDIO_POOL_DMA_BLOCKS];
+static uint16_t s_dma_in_use = 0;
+
+static audio_pool_stats_t s_stats;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t audio_pool_init(void)
+{
+    if (s_base != NULL) {
+        return ESP_OK;
+    }
+
+    size_t blocks = (size_t)CONFIG_AUDIO_POOL_PSRAM_KB * 1024 / BOARD_AUDIO_POOL_BLOCK_SIZE;
+    if (blocks > AUDIO_POOL_BLOCKS_MAX) {
+        blocks = AUDIO_POOL_BLOCKS_MAX;
+    }
+    s_base = heap_caps_aligned_alloc(BOARD_AUDIO_PSRAM_DMA_ALIGN, blocks * BOARD_AUDIO_POOL_BLOCK_SIZE,
+                                     MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_dma_base = heap_caps_aligned_alloc(4, BOARD_AUDIO_POOL_DMA_BLOCKS * BOARD_AUDIO_POOL_DMA_BLOCK_SIZE,
+                                         MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s_base == NULL || s_dma_base == NULL) {
+        ESP_LOGE(TAG, "分配缓冲区池失败: PSRAM %u KB, 内部 RAM %u KB",
+                 (unsigned int)(blocks * BOARD_AUDIO_POOL_BLOCK_SIZE / 1024),
+                 (unsigned int)(BOARD_AUDIO_POOL_DMA_BLOCKS * BOARD_AUDIO_POOL_DMA_BLOCK_SIZE / 1024));
+        heap_caps_free(s_base);
+        heap_caps_free(s_dma_base);
+        s_base = NULL;
+        s_dma_base = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_blocks = (uint16_t)blocks;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.block_size = BOARD_AUDIO_POOL_BLOCK_SIZE;
+    s_stats.total_blocks = s_blocks;
+    s_stats.dma_block_size = BOARD_AUDIO_POOL_DMA_BLOCK_SIZE;
+    s_stats.dma_total_blocks = BOARD_AUDIO_POOL_DMA_BLOCKS;
+    ESP_LOGI(TAG, "缓冲区池: PSRAM %u x %u KB, 内部 RAM %u x %u KB", (unsigned int)s_blocks,
+             (unsigned int)(BOARD_AUDIO_POOL_BLOCK_SIZE / 1024), (unsigned int)BOARD_AUDIO_POOL_DMA_BLOCKS,
+             (unsigned int)(BOARD_AUDIO_POOL_DMA_BLOCK_SIZE / 1024));
+    return ESP_OK;
+}
+
+/**
+ * @brief 查找连续空闲块 (调用者持有锁)
+ * @param need 需要的块数
+ * @param[out] start 找到 need 块时为首次适配的起点, 否则为最长连续空闲的起点
+ * @return 找到的连续块数 (need 或最长连续空闲长度)
+ */
+static uint16_t audio_pool_find_run(uint16_t need, uint16_t *start)
+{
+    uint16_t best = 0, best_start = 0;
+    for (uint16_t i = 0; i < s_blocks; ) {
+        if (s_used[i]) {
+            i++;
+            continue;
+        }
+        uint16_t j = i;
+        while (j < s_blocks && !s_used[j] && j - i < need) {
+            j++;
+        }
+        if (j - i >= need) {
+            *start = i;
+            return need;
+        }
+        if (j - i > best) {
+            best = j - i;
+            best_start = i;
+        }
+        i = j;
+    }
+    *start = best_start;
+    return best;
+}
+
+esp_err_t audio_pool_alloc(size_t size, size_t min_size, uint32_t flags, audio_chain_t *chain)
+{
+    if (chain == NULL || size == 0 || min_size > size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    chain->count = 0;
+    chain->length = 0;
+    if (s_base == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const size_t bs = BOARD_AUDIO_POOL_BLOCK_SIZE;
+    size_t need = (size + bs - 1) / bs;
+    size_t min_need = (min_size + bs - 1) / bs;
+    if (min_need == 0) {
+        min_need = 1;
+    }
+    if (need > AUDIO_POOL_MAX_CHAIN) {
+        need = AUDIO_POOL_MAX_CHAIN;
+    }
+
+    uint16_t grant = 0;
+    portENTER_CRITICAL(&s_lock);
+    if (flags & AUDIO_POOL_CONTIGUOUS) {
+        uint16_t start = 0;
+        grant = audio_pool_find_run((uint16_t)need, &start);
+        if (grant >= min_need) {
+            for (uint16_t i = 0; i < grant; i++) {
+                s_used[start + i] = true;
+                chain->blocks[i] = s_base + (size_t)(start + i) * bs;
+            }
+        } else {
+            grant = 0;
+        }
+    } else {
+        uint16_t avail = s_blocks - s_in_use;
+        grant = (need < avail) ? (uint16_t)need : avail;
+        if (grant >= min_need) {
+            // 从低地址开始取, 让空闲块尽量集中在高地址, 保留连续分配的余量
+            uint16_t n = 0;
+            for (uint16_t i = 0; i < s_blocks && n < grant; i++) {
+                if (!s_used[i]) {
+                    s_used[i] = true;
+                    chain->blocks[n++] = s_base + (size_t)i * bs;
+                }
+            }
+        } else {
+            grant = 0;
+        }
+    }
+
+    if (grant > 0) {
+        s_in_use += grant;
+        if (s_in_use > s_stats.high_water_blocks) {
+            s_stats.high_water_blocks = s_in_use;
+        }
+        s_stats.allocs++;
+        if ((size_t)grant * bs < size) {
+            s_stats.shortened++;
+        }
+    } else {
+        s_stats.rejected++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    chain->count = grant;
+    chain->length = (size_t)grant * bs;
+    if (grant == 0) {
+        ESP_LOGE(TAG, "预算不足, 拒绝 %u 字节的请求 (最少 %u 字节, 空闲 %u 块)", (unsigned int)size,
+                 (unsigned int)min_size, (unsigned int)(s_blocks - s_in_use));
+        return ESP_ERR_NO_MEM;
+    }
+    if (chain->length < size) {
+        ESP_LOGW(TAG, "预算不足, 请求 %u 字节缩短为 %u 字节", (unsigned int)size, (unsigned int)chain->length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+void audio_pool_free(audio_chain_t *chain)
+{
+    if (chain == NULL || s_base == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    for (uint16_t i = 0; i < chain->count; i++) {
+        size_t idx = (size_t)(chain->blocks[i] - s_base) / BOARD_AUDIO_POOL_BLOCK_SIZE;
+        if (idx < s_blocks && s_used[idx]) {
+            s_used[idx] = false;
+            s_in_use--;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+    chain->count = 0;
+    chain->length = 0;
+}
+
+void *audio_pool_dma_alloc(void)
+{
+    void *block = NULL;
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; s_dma_base != NULL && i < BOARD_AUDIO_POOL_DMA_BLOCKS; i++) {
+        if (!s_dma_used[i]) {
+            s_dma_used[i] = true;
+            block = s_dma_base + (size_t)i * BOARD_AUDIO_POOL_DMA_BLOCK_SIZE;
+            if (++s_dma_in_use > s_stats.dma_high_water_blocks) {
+                s_stats.dma_high_water_blocks = s_dma_in_use;
+            }
+            break;
+        }
+    }
+    if (block == NULL) {
+        s_stats.dma_rejected++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (block == NULL) {
+        ESP_LOGE(TAG, "内部 RAM 暂存块已耗尽");
+    }
+    return block;
+}
+
+void audio_pool_dma_free(void *block)
+{
+    if (block == NULL || s_dma_base == NULL) {
+        return;
+    }
+    size_t idx = (size_t)((uint8_t *)block - s_dma_base) / BOARD_AUDIO_POOL_DMA_BLOCK_SIZE;
+    portENTER_CRITICAL(&s_lock);
+    if (idx < BOARD_AUDIO_POOL_DMA_BLOCKS && s_dma_used[idx]) {
+        s_dma_used[idx] = false;
+        s_dma_in_use--;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void audio_pool_get_stats(audio_pool_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    uint16_t start = 0;
+    uint16_t free_blocks = s_blocks - s_in_use;
+    uint16_t run = audio_pool_find_run(s_blocks ? s_blocks : 1, &start);
+    *stats = s_stats;
+    stats->free_blocks = free_blocks;
+    stats->largest_free_run = run;
+    stats->fragmentation_pct = free_blocks ? (uint8_t)(100 - run * 100 / free_blocks) : 0;
+    stats->dma_free_blocks = BOARD_AUDIO_POOL_DMA_BLOCKS - s_dma_in_use;
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file audio_pool.h
+ * @brief 音频缓冲区池
+ * @details 启动时一次性从 PSRAM 切出固定大小的音频块 (录音, 流播放), 从内部 RAM 切出少量
+ *          DMA 可用的暂存块 (提示音解码, 合成, 缓存读取). 使用者借出一串块 (块链), 用完归还,
+ *          长时间运行不会因反复分配数 MB 的缓冲区而产生堆碎片.
+ *          预算不足时按调用者给出的最小长度缩短或拒绝, 并返回明确的错误码, 不会悄悄降级.
+ */
+
+#ifndef _AUDIO_POOL_H_
+#define _AUDIO_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_POOL_MAX_CHAIN    128     // 单个块链最多块数
+
+/* audio_pool_alloc() 标志 */
+#define AUDIO_POOL_CONTIGUOUS   (1 << 0)    // 块在地址上连续, blocks[0] 可作为线性缓冲区使用
+
+/**
+ * @brief 块链 (借出的一组 PSRAM 块)
+ */
+typedef struct {
+    uint16_t count;                         // 块数
+    size_t length;                          // 总长度 (count * 块大小)
+    uint8_t *blocks[AUDIO_POOL_MAX_CHAIN];  // 各块地址, 按 BOARD_AUDIO_PSRAM_DMA_ALIGN 对齐
+} audio_chain_t;
+
+/**
+ * @brief 缓冲区池统计
+ */
+typedef struct {
+    size_t block_size;              // PSRAM 块大小
+    uint16_t total_blocks;          // PSRAM 块总数
+    uint16_t free_blocks;           // 空闲块数
+    uint16_t high_water_blocks;     // 启动以来同时借出的最大块数
+    uint16_t largest_free_run;      // 最长的连续空闲块数 (连续分配的上限)
+    uint8_t fragmentation_pct;      // 碎片率: 1 - 最长连续空闲 / 空闲总数
+    uint32_t allocs;                // 成功分配次数 (含缩短)
+    uint32_t shortened;             // 按预算缩短的次数
+    uint32_t rejected;              // 预算不足拒绝的次数
+    size_t dma_block_size;          // 内部 RAM 暂存块大小
+    uint16_t dma_total_blocks;      // 暂存块总数
+    uint16_t dma_free_blocks;       // 空闲暂存块数
+    uint16_t dma_high_water_blocks; // 同时借出的最大暂存块数
+    uint32_t dma_rejected;          // 暂存块耗尽拒绝的次数
+} audio_pool_stats_t;
+
+/**
+ * @brief 初始化缓冲区池, 启动时调用一次
+ * @details 从 PSRAM 分配 CONFIG_AUDIO_POOL_PSRAM_KB, 从内部 RAM 分配 BOARD_AUDIO_POOL_DMA_BLOCKS 个暂存块
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t audio_pool_init(void);
+
+/**
+ * @brief 借出 PSRAM 块链
+ * @param size 请求长度 (字节)
+ * @param min_size 预算不足时可接受的最小长度, 等于 size 表示不允许缩短
+ * @param flags AUDIO_POOL_CONTIGUOUS 等
+ * @param[out] chain 块链, 失败时 count 为 0
+ * @return esp_err_t ESP_OK 满足请求, ESP_ERR_INVALID_SIZE 预算不足已缩短 (chain->length < size, 不小于 min_size),
+ *         ESP_ERR_NO_MEM 预算不足被拒绝, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_pool_alloc(size_t size, size_t min_size, uint32_t flags, audio_chain_t *chain);
+
+/**
+ * @brief 归还块链, 之后 chain 为空
+ */
+void audio_pool_free(audio_chain_t *chain);
+
+/**
+ * @brief 借出一个内部 RAM 暂存块 (BOARD_AUDIO_POOL_DMA_BLOCK_SIZE 字节, DMA 可用)
+ * @return 块地址, 耗尽时返回 NULL
+ */
+void *audio_pool_dma_alloc(void);
+
+/**
+ * @brief 归还内部 RAM 暂存块
+ */
+void audio_pool_dma_free(void *block);
+
+/**
+ * @brief 获取统计信息
+ * @param[out] stats 统计信息
+ */
+void audio_pool_get_stats(audio_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_POOL_H_ */
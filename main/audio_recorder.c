@@ -0,0 +1,520 @@
+/**
+ * @file audio_recorder.c
+ * @brief 闪存录音
+ */
+
+#include <string.h>
+#include "audio_recorder.h"
+#include "audio_adpcm.h"
+#include "audio_pool.h"
+#include "audio_monitor.h"
+#include "board.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_http_client.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "RECORDER";
+
+#define RECORDER_SLAB_SIZE          BOARD_AUDIO_POOL_DMA_BLOCK_SIZE     // 双缓冲单块大小
+#define RECORDER_FRAME_BYTES        (BOARD_AUDIO_RECORD_SLOTS * sizeof(int16_t))
+#define RECORDER_ADPCM_FRAMES       AUDIO_ADPCM_SAMPLES_PER_BLOCK(AUDIO_RECORDER_ADPCM_BLOCK_SIZE)
+#define RECORDER_ADPCM_BYTES        (AUDIO_RECORDER_ADPCM_BLOCK_SIZE * BOARD_AUDIO_RECORD_SLOTS)
+#define RECORDER_PCM_BYTES          AUDIO_FLASH_LOG_SECTOR_SIZE         // PCM 每次读取的字节数
+#define RECORDER_ERASE_LEAD         (CONFIG_AUDIO_RECORDER_ERASE_LEAD_KB * 1024)
+#define RECORDER_WRITER_STACK       3072
+#define RECORDER_WRITER_PRIO        3           // 低于采集任务, 擦除只在空闲时进行
+#define RECORDER_READ_TIMEOUT_MS    200
+#define RECORDER_STOP_INDEX         0xFF
+
+_Static_assert(RECORDER_SLAB_SIZE % AUDIO_FLASH_LOG_SECTOR_SIZE == 0, "双缓冲块必须是扇区的整数倍");
+_Static_assert(RECORDER_SLAB_SIZE % RECORDER_ADPCM_BYTES == 0, "双缓冲块必须是 ADPCM 块的整数倍");
+_Static_assert(RECORDER_SLAB_SIZE % RECORDER_PCM_BYTES == 0, "双缓冲块必须是 PCM 读取长度的整数倍");
+_Static_assert(RECORDER_ADPCM_FRAMES * RECORDER_FRAME_BYTES <= BOARD_AUDIO_POOL_DMA_BLOCK_SIZE,
+               "ADPCM 编码输入超过暂存块大小");
+
+typedef struct {
+    uint8_t idx;
+    uint16_t len;
+} recorder_slab_msg_t;
+
+static struct {
+    const esp_partition_t *part;
+    audio_flash_log_t log;
+    SemaphoreHandle_t lock;         // 录音与上传互斥
+    volatile bool active;
+    volatile bool stop;
+    uint8_t *slab[2];
+    QueueHandle_t full_q;           // 待写入的缓冲区
+    QueueHandle_t free_q;           // 可填充的缓冲区下标
+    SemaphoreHandle_t writer_ready; // 开始前的擦除完成
+    SemaphoreHandle_t writer_done;
+    volatile esp_err_t writer_err;
+    size_t erase_lead;              // 已擦除区域领先写入位置的目标长度
+    size_t erase_end;               // 本次录音需要擦除到的位置
+    uint32_t sequence;
+} s_rec;
+
+esp_err_t audio_recorder_init(void)
+{
+    if (s_rec.lock == NULL) {
+        s_rec.lock = xSemaphoreCreateMutex();
+        if (s_rec.lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_rec.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, AUDIO_RECORDER_PARTITION_SUBTYPE,
+                                          AUDIO_RECORDER_PARTITION_LABEL);
+    if (s_rec.part == NULL) {
+        ESP_LOGE(TAG, "未找到 record 分区, 请检查分区表");
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t ret = audio_flash_log_open(&s_rec.log, s_rec.part);
+    if (ret != ESP_OK) {
+        s_rec.part = NULL;
+        return ret;
+    }
+
+    audio_flash_log_header_t header;
+    if (audio_flash_log_read_header(&s_rec.log, &header) == ESP_OK) {
+        s_rec.sequence = header.sequence;
+        ESP_LOGI(TAG, "已有录音 #%u: %s, %u Hz, %u 字节", (unsigned int)header.sequence,
+                 header.codec == AUDIO_FLASH_LOG_CODEC_IMA_ADPCM ? "adpcm" : "pcm",
+                 (unsigned int)header.sample_rate, (unsigned int)header.data_size);
+    }
+    ESP_LOGI(TAG, "record 分区容量 %u KB", (unsigned int)(s_rec.log.capacity / 1024));
+    return ESP_OK;
+}
+
+/**
+ * @brief 每秒数据量 (字节)
+ */
+static size_t recorder_bytes_per_second(audio_flash_log_codec_t codec, uint32_t rate)
+{
+    if (codec == AUDIO_FLASH_LOG_CODEC_IMA_ADPCM) {
+        return (size_t)((uint64_t)rate * RECORDER_ADPCM_BYTES / RECORDER_ADPCM_FRAMES) + 1;
+    }
+    return rate * RECORDER_FRAME_BYTES;
+}
+
+uint32_t audio_recorder_max_seconds(audio_flash_log_codec_t codec)
+{
+    if (s_rec.part == NULL) {
+        return 0;
+    }
+    return s_rec.log.capacity / recorder_bytes_per_second(codec, board_audio_get_sample_rate());
+}
+
+/**
+ * @brief 提前擦除一个扇区, 已停止、写入出错或已擦除到本次录音所需位置时不擦除
+ */
+static bool recorder_erase_ahead(void)
+{
+    if (s_rec.stop || s_rec.writer_err != ESP_OK || s_rec.log.erased >= s_rec.erase_end) {
+        return false;
+    }
+    return audio_flash_log_erase_ahead(&s_rec.log, s_rec.erase_lead);
+}
+
+/**
+ * @brief 写入任务: 先擦除领先量, 之后追加写满的缓冲区, 空闲时提前擦除
+ * @details 每次最多擦除一个扇区, 擦除前检查停止标志, 停止请求最多等待一次扇区擦除
+ */
+static void recorder_writer_task(void *arg)
+{
+    // 采集开始前擦除领先量 (PCM 为整段)
+    while (recorder_erase_ahead()) {
+    }
+    xSemaphoreGive(s_rec.writer_ready);
+
+    recorder_slab_msg_t msg;
+    bool erased = false;
+    for (;;) {
+        // 上次空闲时擦除了一个扇区则不等待, 继续检查是否还需要擦除
+        if (xQueueReceive(s_rec.full_q, &msg, erased ? 0 : pdMS_TO_TICKS(50)) != pdTRUE) {
+            erased = recorder_erase_ahead();
+            continue;
+        }
+        erased = false;
+        if (msg.idx == RECORDER_STOP_INDEX) {
+            break;
+        }
+        if (s_rec.writer_err == ESP_OK) {
+            esp_err_t ret = audio_flash_log_append(&s_rec.log, s_rec.slab[msg.idx], msg.len);
+            if (ret != ESP_OK) {
+                // 分区写满或闪存错误, 通知采集端结束
+                s_rec.writer_err = ret;
+                s_rec.stop = true;
+            }
+        }
+        xQueueSend(s_rec.free_q, &msg.idx, 0);
+    }
+    xSemaphoreGive(s_rec.writer_done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 释放录音资源
+ */
+static void recorder_cleanup(uint8_t *staging)
+{
+    for (int i = 0; i < 2; i++) {
+        audio_pool_dma_free(s_rec.slab[i]);
+        s_rec.slab[i] = NULL;
+    }
+    audio_pool_dma_free(staging);
+    if (s_rec.full_q) {
+        vQueueDelete(s_rec.full_q);
+        s_rec.full_q = NULL;
+    }
+    if (s_rec.free_q) {
+        vQueueDelete(s_rec.free_q);
+        s_rec.free_q = NULL;
+    }
+    if (s_rec.writer_ready) {
+        vSemaphoreDelete(s_rec.writer_ready);
+        s_rec.writer_ready = NULL;
+    }
+    if (s_rec.writer_done) {
+        vSemaphoreDelete(s_rec.writer_done);
+        s_rec.writer_done = NULL;
+    }
+}
+
+esp_err_t audio_recorder_record(i2s_chan_handle_t *tx_handle, i2s_chan_handle_t *rx_handle, uint32_t seconds,
+                                audio_flash_log_codec_t codec, audio_recorder_result_t *result)
+{
+    if (tx_handle == NULL || rx_handle == NULL || *rx_handle == NULL || result == NULL || seconds == 0 ||
+        codec > AUDIO_FLASH_LOG_CODEC_IMA_ADPCM) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_rec.part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (audio_monitor_is_active() || xSemaphoreTake(s_rec.lock, 0) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(result, 0, sizeof(*result));
+    s_rec.active = true;
+    s_rec.stop = false;
+    s_rec.writer_err = ESP_OK;
+
+    const uint32_t rate = board_audio_get_sample_rate();
+    const bool adpcm = (codec == AUDIO_FLASH_LOG_CODEC_IMA_ADPCM);
+    const size_t bytes_per_second = recorder_bytes_per_second(codec, rate);
+    esp_err_t status = ESP_OK;
+    result->requested_ms = seconds * 1000;
+    if (seconds > s_rec.log.capacity / bytes_per_second) {
+        ESP_LOGW(TAG, "record 分区只能容纳 %u 秒, 请求 %u 秒已缩短",
+                 (unsigned int)(s_rec.log.capacity / bytes_per_second), (unsigned int)seconds);
+        seconds = s_rec.log.capacity / bytes_per_second;
+        status = ESP_ERR_INVALID_SIZE;
+    }
+    const uint64_t target_frames = (uint64_t)seconds * rate;
+
+    audio_flash_log_header_t *hdr = &result->header;
+    hdr->codec = codec;
+    hdr->channels = BOARD_AUDIO_RECORD_SLOTS;
+    hdr->sample_rate = rate;
+    hdr->block_size = adpcm ? AUDIO_RECORDER_ADPCM_BLOCK_SIZE : 0;
+    hdr->sequence = ++s_rec.sequence;
+
+    // 采集读入暂存块, ADPCM 编码或直接复制到双缓冲
+    uint8_t *staging = audio_pool_dma_alloc();
+    s_rec.slab[0] = audio_pool_dma_alloc();
+    s_rec.slab[1] = audio_pool_dma_alloc();
+    s_rec.full_q = xQueueCreate(3, sizeof(recorder_slab_msg_t));
+    s_rec.free_q = xQueueCreate(2, sizeof(uint8_t));
+    s_rec.writer_ready = xSemaphoreCreateBinary();
+    s_rec.writer_done = xSemaphoreCreateBinary();
+    esp_err_t ret = (staging && s_rec.slab[0] && s_rec.slab[1]) ? ESP_OK : ESP_ERR_NO_MEM;
+    if (ret == ESP_OK && (s_rec.full_q == NULL || s_rec.free_q == NULL || s_rec.writer_ready == NULL ||
+                          s_rec.writer_done == NULL)) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (ret == ESP_OK) {
+        // 采集端先填充 0 号缓冲区
+        uint8_t idx = 1;
+        xQueueSend(s_rec.free_q, &idx, 0);
+    }
+
+    // 闪存操作期间采集任务停顿, 需要足够深的 DMA 缓冲
+    board_audio_dma_profile_t old_profile = board_audio_get_dma_profile();
+    bool switched = false;
+    if (ret == ESP_OK && old_profile != BOARD_AUDIO_RECORDER_DMA_PROFILE) {
+        ret = board_audio_set_dma_profile(BOARD_AUDIO_RECORDER_DMA_PROFILE, tx_handle, rx_handle);
+        switched = (ret == ESP_OK);
+    }
+
+    // 擦除由写入任务逐扇区进行, 每个扇区前检查停止标志. PCM 写入速率超过逐扇区擦除的速度, 采集前擦除整段;
+    // ADPCM 只在采集前擦除领先量, 其余在写入空闲时擦除. ADPCM 最后一块按整块写入, 多预留一块
+    s_rec.erase_end = bytes_per_second * seconds + (adpcm ? RECORDER_ADPCM_BYTES : 0);
+    s_rec.erase_lead = adpcm ? RECORDER_ERASE_LEAD : s_rec.erase_end;
+    int64_t t0 = esp_timer_get_time();
+    if (ret == ESP_OK) {
+        ret = audio_flash_log_begin(&s_rec.log, 0);
+    }
+    if (ret == ESP_OK && xTaskCreate(recorder_writer_task, "rec_writer", RECORDER_WRITER_STACK, NULL,
+                                     RECORDER_WRITER_PRIO, NULL) != pdPASS) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    bool writer_started = (ret == ESP_OK);
+    if (writer_started) {
+        xSemaphoreTake(s_rec.writer_ready, portMAX_DELAY);
+        result->pre_erase_ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+        ESP_LOGI(TAG, "预擦除 %u KB, 耗时 %u ms", (unsigned int)(s_rec.log.erased / 1024),
+                 (unsigned int)result->pre_erase_ms);
+    }
+
+    board_audio_dma_stats_t dma_before;
+    board_audio_get_dma_stats(BOARD_AUDIO_RECORDER_DMA_PROFILE, &dma_before);
+    // 预擦除期间收到停止请求则不再采集, 写入空录音头
+    const bool capture = (ret == ESP_OK && !s_rec.stop);
+    if (ret == ESP_OK && !capture) {
+        ESP_LOGW(TAG, "预擦除期间录音被停止");
+    }
+    if (capture) {
+        ret = board_audio_capture_begin(*rx_handle);
+    }
+
+    if (capture && ret == ESP_OK) {
+        ESP_LOGI(TAG, "开始闪存录音 #%u: %s, %u Hz, %u 秒", (unsigned int)hdr->sequence, adpcm ? "adpcm" : "pcm",
+                 (unsigned int)rate, (unsigned int)seconds);
+        const size_t in_bytes = adpcm ? RECORDER_ADPCM_FRAMES * RECORDER_FRAME_BYTES : RECORDER_PCM_BYTES;
+        const size_t out_bytes = adpcm ? RECORDER_ADPCM_BYTES : RECORDER_PCM_BYTES;
+        uint8_t adpcm_index[BOARD_AUDIO_RECORD_SLOTS] = {0};
+        int cur = 0;                    // 正在填充的缓冲区, -1 表示两个都在等待写入
+        size_t fill = 0;
+        uint64_t frames = 0;
+        int64_t start_us = esp_timer_get_time();
+
+        size_t staged = 0;              // 暂存块中已读取的字节数
+
+        while (!s_rec.stop && frames + hdr->dropped_frames < target_frames) {
+            // 凑满一个编码单位 (ADPCM 块或 PCM 扇区) 再处理, 读取超时返回的部分数据保留在暂存块中
+            uint64_t left = target_frames - frames - hdr->dropped_frames;
+            size_t want = in_bytes;
+            if (left * RECORDER_FRAME_BYTES < want) {
+                want = (size_t)left * RECORDER_FRAME_BYTES;
+            }
+            size_t got = 0;
+            esp_err_t rret = i2s_channel_read(*rx_handle, staging + staged, want - staged, &got,
+                                              pdMS_TO_TICKS(RECORDER_READ_TIMEOUT_MS));
+            if (rret != ESP_OK && rret != ESP_ERR_TIMEOUT) {
+                ret = rret;
+                break;
+            }
+            staged += got;
+            if (staged < want) {
+                continue;
+            }
+            size_t unit_frames = staged / RECORDER_FRAME_BYTES;
+            staged = 0;
+
+            if (cur < 0) {
+                uint8_t idx;
+                if (xQueueReceive(s_rec.free_q, &idx, 0) == pdTRUE) {
+                    cur = idx;
+                    fill = 0;
+                }
+            }
+            if (cur < 0) {
+                // 写入来不及, 丢弃这段数据 (ADPCM 以块为单位丢弃, 之后的块头重新同步预测值)
+                hdr->dropped_frames += unit_frames;
+                result->slab_overruns++;
+                continue;
+            }
+
+            if (adpcm) {
+                audio_adpcm_encode_block((const int16_t *)staging, unit_frames, BOARD_AUDIO_RECORD_SLOTS,
+                                         s_rec.slab[cur] + fill, AUDIO_RECORDER_ADPCM_BLOCK_SIZE, adpcm_index);
+                fill += out_bytes;
+            } else {
+                memcpy(s_rec.slab[cur] + fill, staging, unit_frames * RECORDER_FRAME_BYTES);
+                fill += unit_frames * RECORDER_FRAME_BYTES;
+            }
+            frames += unit_frames;
+
+            // 缓冲区写满或录音结束时交给写入任务, 换另一个缓冲区继续填充
+            if (fill == RECORDER_SLAB_SIZE || frames + hdr->dropped_frames >= target_frames) {
+                recorder_slab_msg_t msg = { .idx = (uint8_t)cur, .len = (uint16_t)fill };
+                xQueueSend(s_rec.full_q, &msg, portMAX_DELAY);
+                uint8_t idx;
+                cur = (xQueueReceive(s_rec.free_q, &idx, 0) == pdTRUE) ? idx : -1;
+                fill = 0;
+            }
+        }
+        if (cur >= 0 && fill > 0) {
+            recorder_slab_msg_t msg = { .idx = (uint8_t)cur, .len = (uint16_t)fill };
+            xQueueSend(s_rec.full_q, &msg, portMAX_DELAY);
+        }
+        board_audio_capture_end(*rx_handle);
+        result->elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+        hdr->frames = (uint32_t)frames;
+    }
+
+    // 接收队列每次溢出丢失一个 DMA 缓冲区, 与缓冲区溢出丢弃的帧一起计入录音头
+    board_audio_dma_stats_t dma_after;
+    board_audio_get_dma_stats(BOARD_AUDIO_RECORDER_DMA_PROFILE, &dma_after);
+    result->rx_overflows = dma_after.rx_overflows - dma_before.rx_overflows;
+    hdr->dma_dropped_frames = result->rx_overflows * dma_after.frame_num;
+    hdr->dropped_frames += hdr->dma_dropped_frames;
+
+    if (writer_started) {
+        // 等待写入任务处理完剩余的缓冲区
+        recorder_slab_msg_t msg = { .idx = RECORDER_STOP_INDEX, .len = 0 };
+        xQueueSend(s_rec.full_q, &msg, portMAX_DELAY);
+        xSemaphoreTake(s_rec.writer_done, portMAX_DELAY);
+        if (ret == ESP_OK && s_rec.writer_err != ESP_OK) {
+            if (s_rec.writer_err == ESP_ERR_INVALID_SIZE) {
+                ESP_LOGW(TAG, "record 分区已写满, 录音提前结束");
+                status = ESP_ERR_INVALID_SIZE;
+            } else {
+                ret = s_rec.writer_err;
+            }
+        }
+        if (ret == ESP_OK) {
+            ret = audio_flash_log_finish(&s_rec.log, hdr);
+        }
+    }
+
+    result->flash = s_rec.log.stats;
+    if (switched) {
+        board_audio_set_dma_profile(old_profile, tx_handle, rx_handle);
+    }
+    recorder_cleanup(staging);
+    s_rec.active = false;
+    xSemaphoreGive(s_rec.lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "闪存录音失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    const audio_flash_log_stats_t *st = &result->flash;
+    ESP_LOGI(TAG, "闪存录音完成: %u 帧, %u 字节, 丢弃 %u 帧 (缓冲区溢出 %u 次, DMA 溢出 %u 次 %u 帧)",
+             (unsigned int)hdr->frames, (unsigned int)hdr->data_size, (unsigned int)hdr->dropped_frames,
+             (unsigned int)result->slab_overruns, (unsigned int)result->rx_overflows,
+             (unsigned int)hdr->dma_dropped_frames);
+    ESP_LOGI(TAG, "擦除 %u 扇区 (写入时擦除 %u), 最长 %u us; 写入 %u 次, 最长 %u us",
+             (unsigned int)st->erases, (unsigned int)st->inline_erases, (unsigned int)st->max_erase_us,
+             (unsigned int)st->writes, (unsigned int)st->max_write_us);
+    return status;
+}
+
+void audio_recorder_stop(void)
+{
+    s_rec.stop = true;
+}
+
+bool audio_recorder_is_active(void)
+{
+    return s_rec.active;
+}
+
+esp_err_t audio_recorder_get_info(audio_flash_log_header_t *header)
+{
+    if (s_rec.part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (s_rec.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return audio_flash_log_read_header(&s_rec.log, header);
+}
+
+esp_err_t audio_recorder_upload(const char *url, size_t *uploaded)
+{
+    if (url == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (uploaded) {
+        *uploaded = 0;
+    }
+    if (s_rec.part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (xSemaphoreTake(s_rec.lock, 0) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    audio_flash_log_header_t header;
+    esp_err_t ret = audio_flash_log_read_header(&s_rec.log, &header);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_rec.lock);
+        return ret;
+    }
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .method = HTTP_METHOD_POST,
+        .timeout_ms = BOARD_WS_NETWORK_TIMEOUT_MS,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    uint8_t *buf = audio_pool_dma_alloc();
+    if (client == NULL || buf == NULL) {
+        ret = (client == NULL) ? ESP_FAIL : ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    char value[16];
+    esp_http_client_set_header(client, "Content-Type", "application/octet-stream");
+    esp_http_client_set_header(client, "X-Audio-Codec",
+                               header.codec == AUDIO_FLASH_LOG_CODEC_IMA_ADPCM ? "adpcm" : "pcm");
+    snprintf(value, sizeof(value), "%u", (unsigned int)header.sample_rate);
+    esp_http_client_set_header(client, "X-Sample-Rate", value);
+    snprintf(value, sizeof(value), "%u", (unsigned int)header.channels);
+    esp_http_client_set_header(client, "X-Channels", value);
+    snprintf(value, sizeof(value), "%u", (unsigned int)header.block_size);
+    esp_http_client_set_header(client, "X-Block-Size", value);
+    snprintf(value, sizeof(value), "%u", (unsigned int)header.frames);
+    esp_http_client_set_header(client, "X-Frames", value);
+    snprintf(value, sizeof(value), "%u", (unsigned int)header.sequence);
+    esp_http_client_set_header(client, "X-Sequence", value);
+
+    ret = esp_http_client_open(client, header.data_size);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "打开 %s 失败: %s", url, esp_err_to_name(ret));
+        goto cleanup;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    size_t sent = 0;
+    while (ret == ESP_OK && sent < header.data_size) {
+        size_t chunk = header.data_size - sent;
+        if (chunk > BOARD_AUDIO_POOL_DMA_BLOCK_SIZE) {
+            chunk = BOARD_AUDIO_POOL_DMA_BLOCK_SIZE;
+        }
+        ret = audio_flash_log_read(&s_rec.log, sent, buf, chunk);
+        if (ret == ESP_OK && esp_http_client_write(client, (const char *)buf, chunk) != (int)chunk) {
+            ret = ESP_FAIL;
+        }
+        if (ret == ESP_OK) {
+            sent += chunk;
+        }
+    }
+    if (ret == ESP_OK) {
+        esp_http_client_fetch_headers(client);
+        int status = esp_http_client_get_status_code(client);
+        if (status < 200 || status >= 300) {
+            ESP_LOGE(TAG, "上传录音失败, HTTP 状态码: %d", status);
+            ret = ESP_ERR_INVALID_RESPONSE;
+        } else {
+            ESP_LOGI(TAG, "上传录音 #%u: %u 字节, 耗时 %lld 毫秒", (unsigned int)header.sequence,
+                     (unsigned int)sent, (long long)((esp_timer_get_time() - start_us) / 1000));
+        }
+    }
+    if (uploaded) {
+        *uploaded = sent;
+    }
+
+cleanup:
+    if (client) {
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+    }
+    audio_pool_dma_free(buf);
+    xSemaphoreGive(s_rec.lock);
+    return ret;
+}
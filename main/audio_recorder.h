@@ -0,0 +1,100 @@
+/**
+ * @file audio_recorder.h
+ * @brief 闪存录音
+ * @details 录音长度不再受 PSRAM 缓冲区限制: 采集任务读取 I2S, 按需编码为 IMA ADPCM 后填入内部 RAM 双缓冲
+ *          (两个缓冲区池暂存块, 长度为扇区的整数倍), 写入任务把写满的缓冲区追加到 record 分区,
+ *          空闲时提前擦除后续扇区. 闪存操作期间缓存被禁用, 采集任务会停顿, 由 I2S DMA 缓冲
+ *          (录音期间切换到 BOARD_AUDIO_RECORDER_DMA_PROFILE) 吸收; 写入分段进行, 每次停顿不超过一次扇区擦除.
+ *          分区只保存最近一次录音, 录音结束后可通过 audio_recorder_upload() 上传.
+ */
+
+#ifndef _AUDIO_RECORDER_H_
+#define _AUDIO_RECORDER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2s_std.h"
+#include "audio_flash_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_RECORDER_PARTITION_LABEL      "record"    // 分区名称
+#define AUDIO_RECORDER_PARTITION_SUBTYPE    0x41        // 分区子类型 (自定义数据分区)
+#define AUDIO_RECORDER_ADPCM_BLOCK_SIZE     512         // 每通道 ADPCM 子块字节数
+
+/**
+ * @brief 录音结果
+ */
+typedef struct {
+    audio_flash_log_header_t header;    // 录音头 (编码, 采样率, 长度, 丢弃帧数等)
+    audio_flash_log_stats_t flash;      // 闪存操作统计
+    uint32_t requested_ms;              // 请求时长
+    uint32_t elapsed_ms;                // 实际录音时长
+    uint32_t pre_erase_ms;              // 开始前预擦除耗时
+    uint32_t slab_overruns;             // 两个缓冲区都在等待写入, 丢弃采集数据的次数
+    uint32_t rx_overflows;              // I2S 接收队列溢出次数 (采集任务停顿超过 DMA 缓冲时延)
+} audio_recorder_result_t;
+
+/**
+ * @brief 初始化, 查找 record 分区并读取已有录音
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_FOUND 分区不存在
+ */
+esp_err_t audio_recorder_init(void);
+
+/**
+ * @brief 录音到闪存 (阻塞, 直到时长到达、分区写满或 audio_recorder_stop())
+ * @details 录音前按需把 DMA 切换到 BOARD_AUDIO_RECORDER_DMA_PROFILE, 结束后恢复; 新录音覆盖旧录音
+ * @param[in,out] tx_handle 发送通道句柄 (切换 DMA 档位时会被重建)
+ * @param[in,out] rx_handle 接收通道句柄
+ * @param seconds 请求时长, 超过分区容量时缩短
+ * @param codec 编码
+ * @param[out] result 录音结果
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_SIZE 按分区容量缩短, ESP_ERR_INVALID_STATE 正在录音或通道被占用,
+ *         ESP_ERR_NOT_FOUND 分区不存在, ESP_ERR_NO_MEM 缓冲区池暂存块不足, 其他失败
+ */
+esp_err_t audio_recorder_record(i2s_chan_handle_t *tx_handle, i2s_chan_handle_t *rx_handle, uint32_t seconds,
+                                audio_flash_log_codec_t codec, audio_recorder_result_t *result);
+
+/**
+ * @brief 提前结束录音
+ * @details 预擦除期间同样生效, 最多等待一次扇区擦除, 之后不再采集
+ */
+void audio_recorder_stop(void);
+
+/**
+ * @brief 是否正在录音
+ */
+bool audio_recorder_is_active(void);
+
+/**
+ * @brief 获取分区中的录音信息
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_FOUND 没有完整的录音
+ */
+esp_err_t audio_recorder_get_info(audio_flash_log_header_t *header);
+
+/**
+ * @brief 按当前采样率估算分区能容纳的最长录音
+ * @param codec 编码
+ * @return 秒数, 分区不存在时为 0
+ */
+uint32_t audio_recorder_max_seconds(audio_flash_log_codec_t codec);
+
+/**
+ * @brief 上传录音 (HTTP POST, 请求体为原始数据)
+ * @details 格式信息放在请求头中: X-Audio-Codec (pcm/adpcm), X-Sample-Rate, X-Channels, X-Block-Size,
+ *          X-Frames, X-Sequence
+ * @param url 上传地址
+ * @param[out] uploaded 可为 NULL, 返回上传的字节数
+ * @return esp_err_t ESP_OK 成功 (HTTP 2xx), ESP_ERR_NOT_FOUND 没有录音, ESP_ERR_INVALID_STATE 正在录音, 其他失败
+ */
+esp_err_t audio_recorder_upload(const char *url, size_t *uploaded);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_RECORDER_H_ */
@@ -0,0 +1,344 @@
+/**
+ * @file audio_stream.c
+ * @brief HTTP(S) 音频流播放
+ */
+
+#include <strings.h>
+#include "audio_stream.h"
+#include "audio_pool.h"
+#include "board.h"
+#include "esp_timer.h"
+#include "esp_http_client.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "STREAM";
+
+#define AUDIO_STREAM_CHUNK_SIZE     (CONFIG_AUDIO_STREAM_CHUNK_KB * 1024)
+#define AUDIO_STREAM_BUF_COUNT      2           // 双缓冲
+#define AUDIO_STREAM_FRAME_BYTES    (BOARD_AUDIO_PLAYBACK_CHANNELS * BOARD_AUDIO_PLAYBACK_BIT_WIDTH / 8)
+#define AUDIO_STREAM_TASK_STACK     6144        // HTTPS 握手需要较大栈
+#define AUDIO_STREAM_TASK_PRIO      5
+#define AUDIO_STREAM_STOP_INDEX     0xFF        // 空闲队列中的停止标记
+
+_Static_assert(AUDIO_STREAM_CHUNK_SIZE % 4 == 0, "块大小必须是帧大小的整数倍");
+
+typedef struct {
+    audio_chain_t chain;    // 从缓冲区池借出的连续块
+    uint8_t *data;
+    size_t len;
+    bool last;              // 最后一个块 (结束或出错)
+    esp_err_t err;
+} audio_stream_buf_t;
+
+static struct {
+    volatile bool active;
+    volatile bool stop;
+    const char *url;
+    size_t offset;
+    audio_stream_buf_t bufs[AUDIO_STREAM_BUF_COUNT];
+    QueueHandle_t free_q;   // 可填充的缓冲区下标
+    QueueHandle_t full_q;   // 可播放的缓冲区下标
+    SemaphoreHandle_t done; // 下载任务退出
+    size_t total;           // Content-Range 中的资源总大小
+    int64_t fetch_us;       // 下载耗时
+    size_t fetched;         // 下载字节数
+    uint32_t requests;
+} s_stream;
+
+/**
+ * @brief 解析 Content-Range: bytes a-b/total
+ */
+static esp_err_t audio_stream_http_event(esp_http_client_event_t *evt)
+{
+    if (evt->event_id == HTTP_EVENT_ON_HEADER && strcasecmp(evt->header_key, "Content-Range") == 0) {
+        const char *slash = strchr(evt->header_value, '/');
+        if (slash != NULL && slash[1] != '*') {
+            s_stream.total = strtoul(slash + 1, NULL, 10);
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 从当前响应读取数据, 直到填满 len 字节或响应结束
+ */
+static int audio_stream_read_full(esp_http_client_handle_t client, uint8_t *dst, size_t len)
+{
+    size_t got = 0;
+    while (got < len && !s_stream.stop) {
+        int n = esp_http_client_read(client, (char *)dst + got, len - got);
+        if (n < 0) {
+            return n;
+        }
+        if (n == 0) {
+            break;
+        }
+        got += n;
+    }
+    return (int)got;
+}
+
+/**
+ * @brief 发起一次请求, 服务器支持 Range 时请求 [pos, pos + len)
+ * @param[out] ranged 服务器是否返回 206
+ */
+static esp_err_t audio_stream_request(esp_http_client_handle_t client, size_t pos, size_t len, bool *ranged)
+{
+    char range[48];
+    snprintf(range, sizeof(range), "bytes=%u-%u", (unsigned int)pos, (unsigned int)(pos + len - 1));
+    esp_http_client_set_header(client, "Range", range);
+
+    esp_err_t ret = esp_http_client_open(client, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    s_stream.requests++;
+    esp_http_client_fetch_headers(client);
+
+    int status = esp_http_client_get_status_code(client);
+    if (status == 206) {
+        *ranged = true;
+        return ESP_OK;
+    }
+    if (status == 200) {
+        *ranged = false;
+        return ESP_OK;
+    }
+    if (status == 416) {
+        // 偏移超出资源大小
+        return ESP_ERR_INVALID_SIZE;
+    }
+    ESP_LOGE(TAG, "HTTP 状态码: %d", status);
+    return ESP_ERR_INVALID_RESPONSE;
+}
+
+/**
+ * @brief 下载任务: 填充空闲缓冲区并交给播放端
+ */
+static void audio_stream_fetch_task(void *arg)
+{
+    esp_http_client_config_t config = {
+        .url = s_stream.url,
+        .timeout_ms = BOARD_WS_NETWORK_TIMEOUT_MS,
+        .buffer_size = 4096,
+        .event_handler = audio_stream_http_event,
+        .keep_alive_enable = true,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+
+    size_t pos = s_stream.offset;
+    bool sequential = false;    // 服务器不支持 Range, 在同一个响应中顺序读取
+    bool last = false;
+
+    while (!last) {
+        uint8_t idx;
+        xQueueReceive(s_stream.free_q, &idx, portMAX_DELAY);
+        if (idx == AUDIO_STREAM_STOP_INDEX || s_stream.stop) {
+            break;
+        }
+
+        audio_stream_buf_t *buf = &s_stream.bufs[idx];
+        buf->len = 0;
+        buf->err = (client != NULL) ? ESP_OK : ESP_FAIL;
+        int64_t t0 = esp_timer_get_time();
+
+        if (buf->err == ESP_OK && !sequential) {
+            bool ranged = false;
+            buf->err = audio_stream_request(client, pos, AUDIO_STREAM_CHUNK_SIZE, &ranged);
+            if (buf->err == ESP_OK && !ranged) {
+                ESP_LOGW(TAG, "服务器不支持 Range 请求, 改为顺序读取");
+                sequential = true;
+                // 丢弃定位偏移之前的数据
+                for (size_t skip = pos; skip > 0 && buf->err == ESP_OK; ) {
+                    size_t n = skip < AUDIO_STREAM_CHUNK_SIZE ? skip : AUDIO_STREAM_CHUNK_SIZE;
+                    int got = audio_stream_read_full(client, buf->data, n);
+                    buf->err = (got == (int)n) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+                    skip -= n;
+                }
+            }
+        }
+
+        if (buf->err == ESP_OK) {
+            int got = audio_stream_read_full(client, buf->data, AUDIO_STREAM_CHUNK_SIZE);
+            if (got < 0) {
+                buf->err = ESP_FAIL;
+            } else {
+                buf->len = got;
+            }
+        }
+        if (buf->err == ESP_OK && !sequential && !esp_http_client_is_complete_data_received(client)) {
+            // 保持连接可复用
+            esp_http_client_flush_response(client, NULL);
+        }
+
+        s_stream.fetch_us += esp_timer_get_time() - t0;
+        s_stream.fetched += buf->len;
+        pos += buf->len;
+
+        // 不足一块或到达总大小即为结束
+        last = buf->err != ESP_OK || s_stream.stop || buf->len < AUDIO_STREAM_CHUNK_SIZE ||
+               (s_stream.total > 0 && pos >= s_stream.total);
+        buf->last = last;
+        xQueueSend(s_stream.full_q, &idx, portMAX_DELAY);
+    }
+
+    if (client != NULL) {
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+    }
+    xSemaphoreGive(s_stream.done);
+    vTaskDelete(NULL);
+}
+
+static void audio_stream_cleanup(void)
+{
+    for (int i = 0; i < AUDIO_STREAM_BUF_COUNT; i++) {
+        audio_pool_free(&s_stream.bufs[i].chain);
+        s_stream.bufs[i].data = NULL;
+    }
+    if (s_stream.free_q) {
+        vQueueDelete(s_stream.free_q);
+        s_stream.free_q = NULL;
+    }
+    if (s_stream.full_q) {
+        vQueueDelete(s_stream.full_q);
+        s_stream.full_q = NULL;
+    }
+    if (s_stream.done) {
+        vSemaphoreDelete(s_stream.done);
+        s_stream.done = NULL;
+    }
+}
+
+esp_err_t audio_stream_play_url(i2s_chan_handle_t tx_handle, const char *url, size_t offset,
+                                audio_stream_stats_t *stats)
+{
+    if (tx_handle == NULL || url == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_stream.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_stream.active = true;
+    s_stream.stop = false;
+    s_stream.url = url;
+    s_stream.offset = offset - offset % AUDIO_STREAM_FRAME_BYTES;
+    s_stream.total = 0;
+    s_stream.fetch_us = 0;
+    s_stream.fetched = 0;
+    s_stream.requests = 0;
+
+    esp_err_t ret = ESP_OK;
+    s_stream.free_q = xQueueCreate(AUDIO_STREAM_BUF_COUNT + 1, sizeof(uint8_t));
+    s_stream.full_q = xQueueCreate(AUDIO_STREAM_BUF_COUNT, sizeof(uint8_t));
+    s_stream.done = xSemaphoreCreateBinary();
+    if (s_stream.free_q == NULL || s_stream.full_q == NULL || s_stream.done == NULL) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    for (uint8_t i = 0; ret == ESP_OK && i < AUDIO_STREAM_BUF_COUNT; i++) {
+        // 每个缓冲区借一段连续块, 不允许缩短; 预算不足时返回池的错误码
+        esp_err_t alloc_ret = audio_pool_alloc(AUDIO_STREAM_CHUNK_SIZE, AUDIO_STREAM_CHUNK_SIZE,
+                                               AUDIO_POOL_CONTIGUOUS, &s_stream.bufs[i].chain);
+        if (alloc_ret != ESP_OK) {
+            ret = alloc_ret;
+        } else {
+            s_stream.bufs[i].data = s_stream.bufs[i].chain.blocks[0];
+            xQueueSend(s_stream.free_q, &i, 0);
+        }
+    }
+    if (ret == ESP_OK && xTaskCreate(audio_stream_fetch_task, "audio_stream", AUDIO_STREAM_TASK_STACK,
+                                     NULL, AUDIO_STREAM_TASK_PRIO, NULL) != pdPASS) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "创建流播放资源失败");
+        audio_stream_cleanup();
+        s_stream.active = false;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "开始流播放: %s (偏移 %u)", url, (unsigned int)s_stream.offset);
+
+    audio_stream_stats_t st = {0};
+    int64_t start_us = esp_timer_get_time();
+    bool started = false;
+    bool last = false;
+
+    while (!last) {
+        uint8_t idx;
+        if (started && uxQueueMessagesWaiting(s_stream.full_q) == 0) {
+            // 上一块已写完而下一块还未下载完成, DMA 缓冲区即将耗尽
+            st.underruns++;
+        }
+        if (xQueueReceive(s_stream.full_q, &idx, pdMS_TO_TICKS(BOARD_WS_NETWORK_TIMEOUT_MS * 2)) != pdTRUE) {
+            ret = ESP_ERR_TIMEOUT;
+            break;
+        }
+
+        audio_stream_buf_t *buf = &s_stream.bufs[idx];
+        last = buf->last;
+        ret = buf->err;
+        size_t len = buf->len - buf->len % AUDIO_STREAM_FRAME_BYTES;
+        st.chunks++;
+
+        if (ret == ESP_OK && len > 0 && !s_stream.stop) {
+            size_t loaded = 0;
+            if (!started) {
+                ret = board_audio_stream_begin(tx_handle, buf->data, len, &loaded);
+                st.startup_ms = (esp_timer_get_time() - start_us) / 1000;
+                started = (ret == ESP_OK);
+            }
+            if (ret == ESP_OK) {
+                ret = board_audio_stream_write(tx_handle, buf->data + loaded, len - loaded, UINT32_MAX);
+            }
+            st.bytes += len;
+        }
+
+        if (ret != ESP_OK || s_stream.stop) {
+            break;
+        }
+        xQueueSend(s_stream.free_q, &idx, 0);
+    }
+
+    // 通知下载任务退出并等待
+    s_stream.stop = true;
+    uint8_t stop_idx = AUDIO_STREAM_STOP_INDEX;
+    xQueueSend(s_stream.free_q, &stop_idx, 0);
+    while (xSemaphoreTake(s_stream.done, pdMS_TO_TICKS(100)) != pdTRUE) {
+        // 下载任务可能阻塞在 full_q 上
+        uint8_t drop;
+        xQueueReceive(s_stream.full_q, &drop, 0);
+    }
+
+    if (started) {
+        board_audio_stream_end(tx_handle);
+    }
+
+    st.total = s_stream.total;
+    st.requests = s_stream.requests;
+    st.throughput_kbps = s_stream.fetch_us > 0 ? (uint32_t)(s_stream.fetched * 8000ULL / s_stream.fetch_us) : 0;
+    ESP_LOGI(TAG, "流播放结束 (%s): 播放 %u / %u 字节, %u 块, %u 次请求, 下载速率 %u kbps, 欠载 %u 次, 启动延迟 %u 毫秒",
+             esp_err_to_name(ret), (unsigned int)st.bytes, (unsigned int)st.total, (unsigned int)st.chunks,
+             (unsigned int)st.requests, (unsigned int)st.throughput_kbps, (unsigned int)st.underruns,
+             (unsigned int)st.startup_ms);
+    if (stats != NULL) {
+        *stats = st;
+    }
+
+    audio_stream_cleanup();
+    s_stream.active = false;
+    return ret;
+}
+
+void audio_stream_stop(void)
+{
+    if (s_stream.active) {
+        s_stream.stop = true;
+    }
+}
+
+bool audio_stream_is_active(void)
+{
+    return s_stream.active;
+}
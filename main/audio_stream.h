@@ -0,0 +1,62 @@
+/**
+ * @file audio_stream.h
+ * @brief HTTP(S) 音频流播放
+ * @details 通过 HTTP Range 请求分块下载到 PSRAM 双缓冲, 下载任务填充一个缓冲区的同时
+ *          播放另一个, 第一个块到达后即开始播放. 服务器不支持 Range 时退化为顺序读取.
+ *          音频格式为 I2S 原生 PCM (16 位, 当前时钟域采样率 board_audio_get_sample_rate(), BOARD_AUDIO_PLAYBACK_CHANNELS 通道).
+ *          本地测试服务器见 tools/stream_test_server.py.
+ */
+
+#ifndef _AUDIO_STREAM_H_
+#define _AUDIO_STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2s_std.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 流播放统计
+ */
+typedef struct {
+    size_t bytes;               // 已播放字节数
+    size_t total;               // 资源总大小 (服务器未返回时为 0)
+    uint32_t chunks;            // 下载块数
+    uint32_t requests;          // HTTP 请求次数
+    uint32_t underruns;         // 播放等待下载的次数 (欠载)
+    uint32_t throughput_kbps;   // 平均下载速率 (kbit/s, 不含等待空闲缓冲区的时间)
+    uint32_t startup_ms;        // 从请求到开始播放的时间 (毫秒)
+} audio_stream_stats_t;
+
+/**
+ * @brief 播放 HTTP(S) 音频流 (阻塞直到播放完成或被停止)
+ * @param tx_handle I2S 发送通道句柄
+ * @param url 音频地址
+ * @param offset 起始字节偏移 (定位播放), 向下对齐到帧边界
+ * @param[out] stats 可为 NULL, 返回播放统计
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 已有流在播放, ESP_ERR_NO_MEM 缓冲区池预算不足, 其他失败
+ */
+esp_err_t audio_stream_play_url(i2s_chan_handle_t tx_handle, const char *url, size_t offset,
+                                audio_stream_stats_t *stats);
+
+/**
+ * @brief 停止当前音频流
+ */
+void audio_stream_stop(void);
+
+/**
+ * @brief 是否有音频流在播放
+ * @return true 正在播放
+ */
+bool audio_stream_is_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_STREAM_H_ */
@@ -0,0 +1,139 @@
+/**
+ * @file audio_synth.c
+ * @brief 合成提示音 (earcon)
+ */
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "audio_synth.h"
+#include "audio_synth_render.h"
+#include "audio_pool.h"
+#include "board.h"
+
+static const char *TAG = "SYNTH";
+
+#define SYNTH_BLOCK_FRAMES      256                 // 每次合成并写入的帧数
+#define SYNTH_MAX_DURATION_MS   10000               // 单个提示音最长时长
+
+/* 内置提示音: 每个只有几十字节, 替代原来数百 KB 的 PCM */
+static const audio_earcon_t s_earcons[] = {
+    {
+        // 两声短促的提示后接一个长音, 表示等待配网
+        .id = AUDIO_EARCON_PROVISIONING, .name = "provisioning",
+        .wave = AUDIO_SYNTH_WAVE_SINE, .volume = 70,
+        .attack_ms = 5, .decay_ms = 60, .sustain = 60, .release_ms = 40,
+        .note_count = 5,
+        .notes = { { 660, 150 }, { 0, 60 }, { 660, 150 }, { 0, 60 }, { 880, 400 } },
+    },
+    {
+        // C-E-G 上行大三和弦, 表示成功
+        .id = AUDIO_EARCON_CONFIG_SAVED, .name = "config_saved",
+        .wave = AUDIO_SYNTH_WAVE_SINE, .volume = 70,
+        .attack_ms = 5, .decay_ms = 80, .sustain = 50, .release_ms = 60,
+        .note_count = 3,
+        .notes = { { 523, 140 }, { 659, 140 }, { 784, 360 } },
+    },
+    {
+        // 上行纯四度双音铃声, 表示已连接
+        .id = AUDIO_EARCON_CONNECTED, .name = "connected",
+        .wave = AUDIO_SYNTH_WAVE_TRIANGLE, .volume = 80,
+        .attack_ms = 3, .decay_ms = 120, .sustain = 40, .release_ms = 120,
+        .note_count = 2,
+        .notes = { { 784, 140 }, { 1047, 420 } },
+    },
+};
+
+const audio_earcon_t *audio_synth_get(int id)
+{
+    for (int i = 0; i < sizeof(s_earcons) / sizeof(s_earcons[0]); i++) {
+        if (s_earcons[i].id == id) {
+            return &s_earcons[i];
+        }
+    }
+    return NULL;
+}
+
+const audio_earcon_t *audio_synth_find(const char *name)
+{
+    for (int i = 0; name != NULL && i < sizeof(s_earcons) / sizeof(s_earcons[0]); i++) {
+        if (strcmp(s_earcons[i].name, name) == 0) {
+            return &s_earcons[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t synth_validate(const audio_earcon_t *e)
+{
+    if (e == NULL || e->note_count == 0 || e->note_count > AUDIO_SYNTH_MAX_NOTES ||
+        e->volume > 100 || e->sustain > 100 || e->wave > AUDIO_SYNTH_WAVE_TRIANGLE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t total_ms = 0;
+    for (int i = 0; i < e->note_count; i++) {
+        if (e->notes[i].freq_hz >= board_audio_get_sample_rate() / 2) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        total_ms += e->notes[i].duration_ms;
+    }
+    return (total_ms > 0 && total_ms <= SYNTH_MAX_DURATION_MS) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+typedef struct {
+    i2s_chan_handle_t tx_handle;
+    int channels;
+    bool started;
+    int64_t write_us;                       // 写入播放流 (等待 DMA) 的耗时, 不计入合成耗时
+} synth_player_t;
+
+/* 合成的每一块写入播放流, 第一块用于预加载 */
+static esp_err_t synth_write_block(void *ctx, const int16_t *frames, size_t frame_count)
+{
+    synth_player_t *p = ctx;
+    const size_t bytes = frame_count * p->channels * sizeof(int16_t);
+    int64_t t0 = esp_timer_get_time();
+    size_t loaded = 0;
+    esp_err_t ret = ESP_OK;
+    if (!p->started) {
+        ret = board_audio_stream_begin(p->tx_handle, (const uint8_t *)frames, bytes, &loaded);
+        p->started = (ret == ESP_OK);
+    }
+    if (ret == ESP_OK) {
+        ret = board_audio_stream_write(p->tx_handle, (const uint8_t *)frames + loaded, bytes - loaded, UINT32_MAX);
+    }
+    p->write_us += esp_timer_get_time() - t0;
+    return ret;
+}
+
+esp_err_t audio_synth_play(i2s_chan_handle_t tx_handle, const audio_earcon_t *earcon)
+{
+    if (tx_handle == NULL || synth_validate(earcon) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    _Static_assert(SYNTH_BLOCK_FRAMES * BOARD_AUDIO_PLAYBACK_CHANNELS * sizeof(int16_t) <= BOARD_AUDIO_POOL_DMA_BLOCK_SIZE,
+                   "合成块超过暂存块大小");
+    int16_t *buf = audio_pool_dma_alloc();
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "合成提示音: %s (%d 个音符)", earcon->name ? earcon->name : "-", earcon->note_count);
+
+    // 按当前时钟域采样率合成, 切换采样率后无需转换
+    synth_player_t player = {
+        .tx_handle = tx_handle,
+        .channels = BOARD_AUDIO_PLAYBACK_CHANNELS,
+    };
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t ret = audio_synth_render(earcon, board_audio_get_sample_rate(), player.channels, buf,
+                                       SYNTH_BLOCK_FRAMES, synth_write_block, &player);
+    int64_t render_us = esp_timer_get_time() - t0 - player.write_us;
+
+    if (player.started) {
+        board_audio_stream_end(tx_handle);
+    }
+    audio_pool_dma_free(buf);
+    ESP_LOGI(TAG, "提示音合成耗时 %lld us", render_us);
+    return ret;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file audio_synth.h
+ * @brief 合成提示音 (earcon)
+ * @details 由紧凑的描述 (波形, ADSR 包络, 音符序列) 实时合成短提示音, 直接写入播放流,
+ *          不存储任何采样数据. 内置提示音见 audio_synth.c, 服务器也可通过 play_earcon
+ *          事件下发新的描述.
+ */
+
+#ifndef _AUDIO_SYNTH_H_
+#define _AUDIO_SYNTH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2s_std.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_SYNTH_MAX_NOTES   16      // 每个提示音最多音符数
+
+/* 内置提示音 ID, 沿用原 PCM 提示音的 ID, 服务器 play_pcm 事件保持兼容 */
+#define AUDIO_EARCON_PROVISIONING   2   // 进入配网模式
+#define AUDIO_EARCON_CONFIG_SAVED   3   // 配网成功
+#define AUDIO_EARCON_CONNECTED      4   // 服务器已连接
+
+/**
+ * @brief 振荡器波形
+ */
+typedef enum {
+    AUDIO_SYNTH_WAVE_SINE = 0,      // 正弦
+    AUDIO_SYNTH_WAVE_SQUARE,        // 方波
+    AUDIO_SYNTH_WAVE_TRIANGLE,      // 三角波
+} audio_synth_wave_t;
+
+/**
+ * @brief 音符
+ */
+typedef struct {
+    uint16_t freq_hz;               // 频率, 0 表示休止
+    uint16_t duration_ms;           // 时长 (含释放)
+} audio_synth_note_t;
+
+/**
+ * @brief 提示音描述
+ */
+typedef struct {
+    uint16_t id;                    // 数字 ID (服务器下发时为 0)
+    const char *name;               // 名称
+    audio_synth_wave_t wave;        // 波形
+    uint8_t volume;                 // 音量 (0-100)
+    uint16_t attack_ms;             // 包络: 起音
+    uint16_t decay_ms;              // 包络: 衰减
+    uint8_t sustain;                // 包络: 保持电平 (0-100)
+    uint16_t release_ms;            // 包络: 释放 (每个音符末尾)
+    uint8_t note_count;             // 音符数
+    audio_synth_note_t notes[AUDIO_SYNTH_MAX_NOTES];
+} audio_earcon_t;
+
+/**
+ * @brief 根据 ID 查找内置提示音
+ * @param id 提示音 ID
+ * @return 描述, 未找到返回 NULL
+ */
+const audio_earcon_t *audio_synth_get(int id);
+
+/**
+ * @brief 根据名称查找内置提示音
+ * @param name 名称
+ * @return 描述, 未找到返回 NULL
+ */
+const audio_earcon_t *audio_synth_find(const char *name);
+
+/**
+ * @brief 合成并播放提示音
+ * @param tx_handle I2S 发送通道句柄
+ * @param earcon 提示音描述
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_ARG 描述无效, 其他失败
+ */
+esp_err_t audio_synth_play(i2s_chan_handle_t tx_handle, const audio_earcon_t *earcon);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_SYNTH_H_ */
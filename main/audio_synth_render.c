@@ -0,0 +1,115 @@
+/**
+ * @file audio_synth_render.c
+ * @brief 提示音合成核心 (振荡器, ADSR 包络, 音符序列)
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include "audio_synth_render.h"
+
+#define SYNTH_TABLE_BITS        8
+#define SYNTH_TABLE_SIZE        (1 << SYNTH_TABLE_BITS)
+#define SYNTH_FULL_SCALE        32767
+
+static int16_t s_sine[SYNTH_TABLE_SIZE + 1];
+static bool s_sine_ready = false;
+
+/**
+ * @brief 振荡器, 相位为 32 位定点 (一个周期 = 2^32), 返回 Q15
+ */
+static inline int32_t synth_osc(audio_synth_wave_t wave, uint32_t phase)
+{
+    switch (wave) {
+    case AUDIO_SYNTH_WAVE_SQUARE:
+        // 方波能量高, 降低 6dB 与正弦响度接近
+        return (phase < 0x80000000u) ? SYNTH_FULL_SCALE / 2 : -SYNTH_FULL_SCALE / 2;
+    case AUDIO_SYNTH_WAVE_TRIANGLE: {
+        int32_t t = (int32_t)(phase >> 15);         // 0 .. 131071
+        return (t < 65536) ? (t - 32768) : (98303 - t);
+    }
+    case AUDIO_SYNTH_WAVE_SINE:
+    default: {
+        uint32_t idx = phase >> (32 - SYNTH_TABLE_BITS);
+        int32_t frac = (phase >> (32 - SYNTH_TABLE_BITS - 15)) & 0x7FFF;
+        int32_t a = s_sine[idx];
+        return a + (((s_sine[idx + 1] - a) * frac) >> 15);
+    }
+    }
+}
+
+/**
+ * @brief ADSR 包络, 返回 Q15
+ * @param i 音符内帧序号
+ * @param n 音符总帧数
+ */
+static inline int32_t synth_envelope(uint32_t i, uint32_t n, uint32_t a, uint32_t d, int32_t s, uint32_t r)
+{
+    int32_t level;
+    if (i < a) {
+        level = (int32_t)((uint64_t)SYNTH_FULL_SCALE * i / a);
+    } else if (i < a + d) {
+        level = SYNTH_FULL_SCALE - (int32_t)((int64_t)(SYNTH_FULL_SCALE - s) * (i - a) / d);
+    } else {
+        level = s;
+    }
+    // 释放段位于音符末尾, 保证每个音符结束时归零, 不产生咔哒声
+    uint32_t left = n - i;
+    if (left < r) {
+        level = (int32_t)((int64_t)level * left / r);
+    }
+    return level;
+}
+
+esp_err_t audio_synth_render(const audio_earcon_t *earcon, uint32_t sample_rate, int channels,
+                             int16_t *buf, size_t block_frames, audio_synth_sink_t sink, void *ctx)
+{
+    if (!s_sine_ready) {
+        for (int i = 0; i <= SYNTH_TABLE_SIZE; i++) {
+            s_sine[i] = (int16_t)lrintf(SYNTH_FULL_SCALE * sinf(2.0f * (float)M_PI * i / SYNTH_TABLE_SIZE));
+        }
+        s_sine_ready = true;
+    }
+
+    const uint32_t fs = sample_rate;
+    const uint32_t a = earcon->attack_ms * fs / 1000 + 1;
+    const uint32_t d = earcon->decay_ms * fs / 1000 + 1;
+    const uint32_t r = earcon->release_ms * fs / 1000 + 1;
+    const int32_t sustain = SYNTH_FULL_SCALE * earcon->sustain / 100;
+    const int32_t volume = SYNTH_FULL_SCALE * earcon->volume / 100;
+
+    esp_err_t ret = ESP_OK;
+    size_t pos = 0;
+    uint32_t phase = 0;
+
+    for (int k = 0; ret == ESP_OK && k < earcon->note_count; k++) {
+        const audio_synth_note_t *note = &earcon->notes[k];
+        uint32_t n = note->duration_ms * fs / 1000;
+        uint32_t inc = (uint32_t)(((uint64_t)note->freq_hz << 32) / fs);
+
+        for (uint32_t i = 0; ret == ESP_OK && i < n; i++) {
+            int32_t v = 0;
+            if (note->freq_hz > 0) {
+                int32_t env = synth_envelope(i, n, a, d, sustain, r);
+                v = (int32_t)(((int64_t)synth_osc(earcon->wave, phase) * env >> 15) * volume >> 15);
+                phase += inc;
+            }
+            for (int c = 0; c < channels; c++) {
+                buf[pos * channels + c] = (int16_t)v;
+            }
+            if (++pos == block_frames) {
+                ret = sink(ctx, buf, pos);
+                pos = 0;
+            }
+        }
+        // 休止后从零相位开始, 下一个音符起音更干净
+        if (note->freq_hz == 0) {
+            phase = 0;
+        }
+    }
+
+    // 序列结束时不足一块的帧 (最后一个音符时长为 0 时也在这里写出)
+    if (ret == ESP_OK && pos > 0) {
+        ret = sink(ctx, buf, pos);
+    }
+    return ret;
+}
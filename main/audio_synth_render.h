@@ -0,0 +1,49 @@
+/**
+ * @file audio_synth_render.h
+ * @brief 提示音合成核心 (振荡器, ADSR 包络, 音符序列)
+ * @details 只做定点运算, 不依赖 I2S 和 FreeRTOS, 可在主机上编译验证 (tools/synth_host).
+ *          播放见 audio_synth_play().
+ */
+
+#ifndef _AUDIO_SYNTH_RENDER_H_
+#define _AUDIO_SYNTH_RENDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "audio_synth.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 接收合成好的一块交织帧
+ * @param ctx audio_synth_render() 的 ctx
+ * @param frames 交织的 16 位采样
+ * @param frame_count 帧数 (1 到 block_frames)
+ * @return ESP_OK 继续合成, 其他值中止合成并由 audio_synth_render() 返回
+ */
+typedef esp_err_t (*audio_synth_sink_t)(void *ctx, const int16_t *frames, size_t frame_count);
+
+/**
+ * @brief 按音符序列合成提示音
+ * @details 每凑满 block_frames 帧交给 sink 一次, 序列结束时剩余的不足一块的帧也交给 sink.
+ *          不校验描述 (见 audio_synth_play()), 时长为 0 的音符不产生帧.
+ * @param earcon 提示音描述
+ * @param sample_rate 采样率 (Hz)
+ * @param channels 每帧通道数, 所有通道写入相同的采样
+ * @param buf 合成缓冲区, 至少 block_frames * channels 个采样
+ * @param block_frames 每块帧数
+ * @param sink 接收函数
+ * @param ctx 传给 sink
+ * @return esp_err_t ESP_OK 成功, 否则为 sink 返回的错误
+ */
+esp_err_t audio_synth_render(const audio_earcon_t *earcon, uint32_t sample_rate, int channels,
+                             int16_t *buf, size_t block_frames, audio_synth_sink_t sink, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_SYNTH_RENDER_H_ */
@@ -0,0 +1,115 @@
+/**
+ * @file audio_upload.c
+ * @brief 可续传的分块上传协议 (发送端)
+ */
+
+#include <string.h>
+#include "audio_upload.h"
+#include "esp_rom_crc.h"
+
+void audio_upload_init(audio_upload_t *up, uint32_t id, size_t size, size_t chunk_size, uint16_t window)
+{
+    memset(up, 0, sizeof(*up));
+    up->id = id;
+    up->size = size;
+    up->chunk_size = chunk_size;
+    up->window = window > 0 ? window : 1;
+}
+
+bool audio_upload_next(audio_upload_t *up, size_t *offset, size_t *len)
+{
+    if (up->next >= up->size || up->next - up->acked >= (size_t)up->window * up->chunk_size) {
+        return false;
+    }
+    *offset = up->next;
+    *len = up->size - up->next < up->chunk_size ? up->size - up->next : up->chunk_size;
+
+    up->stats.chunks_sent++;
+    up->stats.bytes_sent += *len;
+    if (up->next < up->high_water) {
+        size_t end = up->next + *len;
+        up->stats.retransmitted_bytes += (end < up->high_water ? end : up->high_water) - up->next;
+    }
+    up->next += *len;
+    if (up->next > up->high_water) {
+        up->high_water = up->next;
+    }
+    return true;
+}
+
+void audio_upload_fill_header(const audio_upload_t *up, size_t offset, const void *payload, size_t len,
+                              audio_upload_chunk_hdr_t *hdr)
+{
+    hdr->magic = AUDIO_UPLOAD_MAGIC;
+    hdr->upload_id = up->id;
+    hdr->seq = (uint32_t)(offset / up->chunk_size);
+    hdr->offset = (uint32_t)offset;
+    hdr->len = (uint32_t)len;
+    hdr->crc32 = esp_rom_crc32_le(0, (const uint8_t *)payload, (uint32_t)len);
+}
+
+bool audio_upload_on_ack(audio_upload_t *up, size_t offset)
+{
+    // 累计确认只能落在已发送的范围内
+    if (offset <= up->acked || offset > up->high_water) {
+        return false;
+    }
+    up->acked = offset;
+    if (up->next < offset) {
+        up->next = offset;
+    }
+    return true;
+}
+
+/**
+ * @brief 回退到 offset 重发 (不超过已发送的范围)
+ */
+static void upload_rewind(audio_upload_t *up, size_t offset)
+{
+    if (offset > up->high_water) {
+        offset = up->high_water;
+    }
+    up->acked = offset;
+    up->next = offset;
+}
+
+void audio_upload_on_nack(audio_upload_t *up, size_t offset)
+{
+    up->stats.nacks++;
+    upload_rewind(up, offset);
+}
+
+void audio_upload_on_resume(audio_upload_t *up, size_t offset)
+{
+    // 服务器可能已收到断开前最后几个未确认的分块, 续传偏移允许超过本地的确认位置
+    up->stats.resumes++;
+    upload_rewind(up, offset);
+}
+
+void audio_upload_on_timeout(audio_upload_t *up)
+{
+    up->stats.timeouts++;
+    upload_rewind(up, up->acked);
+}
+
+bool audio_upload_in_flight(const audio_upload_t *up)
+{
+    return up->next > up->acked;
+}
+
+bool audio_upload_done(const audio_upload_t *up)
+{
+    return up->acked >= up->size;
+}
+
+esp_err_t audio_upload_parse_header(const void *frame, size_t len, audio_upload_chunk_hdr_t *hdr)
+{
+    if (len < AUDIO_UPLOAD_HEADER_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(hdr, frame, sizeof(*hdr));
+    if (hdr->magic != AUDIO_UPLOAD_MAGIC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file audio_upload.h
+ * @brief 可续传的分块上传协议 (发送端)
+ * @details 录音按 chunk_size 切成分块, 每块带上传 ID、序号 (偏移 / chunk_size)、偏移、长度和 CRC32.
+ *          发送端最多有 window 块未确认; 服务器回复累计确认 upload_ack {id, offset} (已连续收到的字节数),
+ *          CRC 错误或不连续时回复 upload_nack {id, offset}, 发送端从该偏移重发 (回退 N 帧).
+ *          连接中断后重新发送 upload_begin (同一 ID), 服务器以已收到的偏移确认, 发送端从该偏移续传,
+ *          不必从头重发. 长时间没有确认时也从最后确认的偏移重发.
+ *
+ *          帧格式: 二进制帧以 audio_upload_chunk_hdr_t (小端) 开头, 分块数据紧跟在同一帧中.
+ *          服务器也接受头部单独成帧 (长度恰好为 AUDIO_UPLOAD_HEADER_SIZE)、数据作为下一个二进制帧的形式.
+ *          设备端用分散发送接口把头部和录音缓冲区中的数据组成一帧, 不需要拷贝到带头部的暂存区.
+ *
+ *          只包含协议状态机, 不依赖 FreeRTOS 和 WebSocket, 可在主机上模拟断线验证.
+ */
+
+#ifndef _AUDIO_UPLOAD_H_
+#define _AUDIO_UPLOAD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_UPLOAD_MAGIC          0x4B4E4843  // 'CHNK'
+#define AUDIO_UPLOAD_HEADER_SIZE    24
+
+/**
+ * @brief 分块头部 (小端)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t upload_id;
+    uint32_t seq;                   // 分块序号, 重发时不变
+    uint32_t offset;                // 在录音中的字节偏移
+    uint32_t len;                   // 分块数据长度
+    uint32_t crc32;                 // 分块数据的 CRC32 (与 zlib 相同)
+} audio_upload_chunk_hdr_t;
+
+_Static_assert(sizeof(audio_upload_chunk_hdr_t) == AUDIO_UPLOAD_HEADER_SIZE, "分块头部长度");
+
+/**
+ * @brief 上传统计
+ */
+typedef struct {
+    uint32_t chunks_sent;           // 发送的分块数 (含重发)
+    size_t bytes_sent;              // 发送的分块数据字节数 (含重发, 不含头部)
+    size_t retransmitted_bytes;     // 重发的字节数
+    uint32_t nacks;                 // 收到的 upload_nack 次数
+    uint32_t timeouts;              // 确认超时次数
+    uint32_t resumes;               // 续传次数 (重新连接后 upload_begin 的确认)
+} audio_upload_stats_t;
+
+/**
+ * @brief 发送端状态
+ */
+typedef struct {
+    uint32_t id;
+    size_t size;                    // 总长度
+    size_t chunk_size;
+    uint16_t window;                // 最多未确认的分块数
+    size_t acked;                   // 服务器已确认的长度
+    size_t next;                    // 下一个要发送的偏移
+    size_t high_water;              // 发送过的最大偏移, 低于该偏移的发送计为重发
+    audio_upload_stats_t stats;
+} audio_upload_t;
+
+/**
+ * @brief 初始化发送端
+ * @param id 上传 ID, 续传时服务器据此找到已收到的数据
+ * @param size 总长度
+ * @param chunk_size 分块长度
+ * @param window 最多未确认的分块数 (至少为 1)
+ */
+void audio_upload_init(audio_upload_t *up, uint32_t id, size_t size, size_t chunk_size, uint16_t window);
+
+/**
+ * @brief 取下一个要发送的分块
+ * @param[out] offset 分块偏移
+ * @param[out] len 分块长度
+ * @return true 可以发送, false 窗口已满或已全部发送 (等待确认)
+ */
+bool audio_upload_next(audio_upload_t *up, size_t *offset, size_t *len);
+
+/**
+ * @brief 填写分块头部并计算 CRC32
+ * @param payload 分块数据 (offset 处, 长度 len)
+ */
+void audio_upload_fill_header(const audio_upload_t *up, size_t offset, const void *payload, size_t len,
+                              audio_upload_chunk_hdr_t *hdr);
+
+/**
+ * @brief 处理累计确认
+ * @param offset 服务器已连续收到的字节数
+ * @return true 确认推进了, false 重复或无效的确认
+ */
+bool audio_upload_on_ack(audio_upload_t *up, size_t offset);
+
+/**
+ * @brief 处理否认: 从服务器给出的偏移重发
+ */
+void audio_upload_on_nack(audio_upload_t *up, size_t offset);
+
+/**
+ * @brief 处理续传确认: 重新连接后服务器对 upload_begin 的回复, 从该偏移继续
+ */
+void audio_upload_on_resume(audio_upload_t *up, size_t offset);
+
+/**
+ * @brief 确认超时: 从最后确认的偏移重发
+ */
+void audio_upload_on_timeout(audio_upload_t *up);
+
+/**
+ * @brief 是否有已发送但未确认的数据
+ */
+bool audio_upload_in_flight(const audio_upload_t *up);
+
+/**
+ * @brief 是否全部确认
+ */
+bool audio_upload_done(const audio_upload_t *up);
+
+/**
+ * @brief 解析并校验分块头部 (服务器端和主机测试使用)
+ * @param frame 二进制帧
+ * @param len 帧长度, 至少为 AUDIO_UPLOAD_HEADER_SIZE
+ * @param[out] hdr 头部
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_SIZE 长度不足, ESP_ERR_INVALID_ARG 不是分块帧
+ */
+esp_err_t audio_upload_parse_header(const void *frame, size_t len, audio_upload_chunk_hdr_t *hdr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_UPLOAD_H_ */
@@ -10,10 +10,23 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <netdb.h>
 #include <inttypes.h>
 #include "driver/i2c.h"
 #include "es7210.h"
 #include "es8311.h"
+#include "audio_dsp.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_async_memcpy.h"
+#include "esp_cache.h"
+#include "esp_memory_utils.h"
+#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+#include "esp_crt_bundle.h"
+#endif
 
 /* 标记不同功能模块的日志标签 */
 static const char *TAG = "BOARD";           // 通用驱动
@@ -24,6 +37,14 @@ static const char *TAG_CONFIG = "CONFIG";   // 配网
 // 函数声明
 static void factory_reset_btn_timer_cb(TimerHandle_t xTimer);
 void board_factory_reset_task(void *arg);
+#if CONFIG_AUDIO_DSP_ENABLE
+static void board_audio_dsp_setup(void);
+#endif
+static bool board_audio_on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
+static bool board_audio_on_send_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
+static bool board_audio_on_recv_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
+static bool board_audio_on_recv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
+static void board_audio_rx_telemetry_end(int64_t start_us);
 
 /**************************** 全局变量 ****************************/
 /* 全局事件组 */
@@ -40,6 +61,75 @@ static esp_websocket_client_handle_t s_websocket_client = NULL;
 static httpd_handle_t s_config_server_handle = NULL;
 static esp_netif_t *s_ap_netif = NULL;
 
+/* 音频时钟域 (播放和录音共用 MCLK 引脚, 采样率必须一致) */
+static uint32_t s_audio_sample_rate = BOARD_AUDIO_SAMPLE_RATE;
+static i2s_chan_handle_t s_audio_tx = NULL;
+static i2s_chan_handle_t s_audio_rx = NULL;
+static es8311_handle_t s_es8311 = NULL;
+static volatile bool s_audio_tx_running = false;
+static volatile bool s_audio_rx_running = false;
+static uint32_t s_dma_desc_num = BOARD_AUDIO_DMA_DEFAULT_DESC_NUM;
+static uint32_t s_dma_frame_num = BOARD_AUDIO_DMA_DEFAULT_FRAME_NUM;
+
+/* I2S DMA 时延档位 */
+typedef struct {
+    const char *name;
+    uint32_t desc_num;
+    uint32_t frame_num;
+} board_dma_profile_cfg_t;
+
+static const board_dma_profile_cfg_t s_dma_profiles[BOARD_AUDIO_DMA_PROFILE_MAX] = {
+    [BOARD_AUDIO_DMA_PROFILE_LOW_LATENCY] = { "low_latency", BOARD_AUDIO_DMA_LOW_LATENCY_DESC_NUM, BOARD_AUDIO_DMA_LOW_LATENCY_FRAME_NUM },
+    [BOARD_AUDIO_DMA_PROFILE_BALANCED]    = { "balanced", BOARD_AUDIO_DMA_BALANCED_DESC_NUM, BOARD_AUDIO_DMA_BALANCED_FRAME_NUM },
+    [BOARD_AUDIO_DMA_PROFILE_ROBUST]      = { "robust", BOARD_AUDIO_DMA_ROBUST_DESC_NUM, BOARD_AUDIO_DMA_ROBUST_FRAME_NUM },
+};
+
+/* 每个档位的遥测计数, 由 I2S 中断回调更新 */
+typedef struct {
+    uint32_t tx_underflows;
+    uint32_t rx_overflows;
+    uint64_t tx_period_sum_us;  // 相邻 on_sent 回调间隔之和
+    uint32_t tx_period_count;
+    uint64_t tx_us;
+    uint64_t rx_us;
+} board_dma_telemetry_t;
+
+static board_dma_telemetry_t s_dma_tel[BOARD_AUDIO_DMA_PROFILE_MAX];
+static portMUX_TYPE s_dma_tel_lock = portMUX_INITIALIZER_UNLOCKED;
+static board_audio_dma_profile_t s_dma_profile = BOARD_AUDIO_DMA_PROFILE_DEFAULT;
+static volatile int s_dma_tel_idx = BOARD_AUDIO_DMA_PROFILE_DEFAULT; // 计入的档位, -1 表示自定义深度 (监听通路)
+static volatile bool s_tx_streaming = false;    // 有数据源在写入, 此时的发送队列溢出才是下溢
+static int64_t s_tx_last_sent_us = 0;
+/* 播放通道占用: 同一时间只允许一个任务操作发送通道、DSP 状态和时钟, 同一任务可嵌套 */
+static portMUX_TYPE s_play_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_play_owner = NULL;
+static uint32_t s_play_depth = 0;
+static TaskHandle_t s_rx_owner = NULL;      // 接收通道占用者 (录音期间, 或重建通道/切换时钟期间), 受 s_play_lock 保护
+static int64_t s_tx_start_us = 0;
+static uint32_t s_tx_underflows_start = 0;
+
+/* GDMA 零拷贝 */
+typedef struct {
+    uint8_t *const *blocks;     // PSRAM 录音缓冲区 (等长的块)
+    size_t block_size;          // 每块长度
+    size_t size;                // 可写入的总长度 (按 BOARD_AUDIO_PSRAM_DMA_ALIGN 向下取整)
+    volatile size_t issued;     // 已提交拷贝的字节数 (接收中断中更新)
+    volatile size_t done;       // 已完成拷贝的字节数 (拷贝完成中断中更新)
+    volatile uint32_t dropped;  // 拷贝队列满而丢弃的 DMA 周期数
+} board_capture_t;
+
+#if CONFIG_AUDIO_ZERO_COPY
+static bool s_zero_copy = true;
+#else
+static bool s_zero_copy = false;
+#endif
+static async_memcpy_handle_t s_audio_mcp = NULL;
+static SemaphoreHandle_t s_capture_sem = NULL;     // 录音拷贝完成
+static SemaphoreHandle_t s_prefetch_sem = NULL;    // 播放预取完成
+static board_capture_t s_capture;
+static volatile bool s_capture_active = false;
+static DMA_ATTR uint8_t s_prefetch_buf[2][BOARD_AUDIO_PREFETCH_BYTES];
+
 // 定义按钮事件队列句柄
 static QueueHandle_t factory_reset_btn_queue = NULL;
 
@@ -229,6 +319,8 @@ esp_err_t board_audio_playback_init(i2s_chan_handle_t *tx_handle_out)
     if (*tx_handle_out == NULL) {
         i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(BOARD_ES8311_I2S_NUM, I2S_ROLE_MASTER);
         chan_cfg.auto_clear = true; // 自动清除DMA缓冲区中的旧数据
+        chan_cfg.dma_desc_num = s_dma_desc_num;
+        chan_cfg.dma_frame_num = s_dma_frame_num;
         ESP_LOGI(TAG_AUDIO, "创建I2S发送通道");
         ret = i2s_new_channel(&chan_cfg, tx_handle_out, NULL);
         if (ret != ESP_OK) {
@@ -241,8 +333,9 @@ esp_err_t board_audio_playback_init(i2s_chan_handle_t *tx_handle_out)
     
     // 3. 配置I2S标准模式
     i2s_std_config_t std_cfg = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(BOARD_AUDIO_SAMPLE_RATE), // 使用配置的采样率 (44100Hz)
-        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO),
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(s_audio_sample_rate), // 使用当前时钟域采样率
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG((i2s_data_bit_width_t)BOARD_AUDIO_PLAYBACK_BIT_WIDTH,
+                                                        (BOARD_AUDIO_PLAYBACK_CHANNELS == 2) ? I2S_SLOT_MODE_STEREO : I2S_SLOT_MODE_MONO),
         .gpio_cfg = {
             .mclk = BOARD_ES8311_MCLK_IO,
             .bclk = BOARD_ES8311_BCK_IO,
@@ -256,7 +349,7 @@ esp_err_t board_audio_playback_init(i2s_chan_handle_t *tx_handle_out)
             },
         },
     };
-    std_cfg.clk_cfg.mclk_multiple = BOARD_AUDIO_MCLK_MULTIPLE;
+    std_cfg.clk_cfg.mclk_multiple = BOARD_AUDIO_MCLK_MULTIPLE_FOR(s_audio_sample_rate);
     
     ESP_LOGI(TAG_AUDIO, "初始化I2S标准模式");
     ret = i2s_channel_init_std_mode(*tx_handle_out, &std_cfg);
@@ -265,6 +358,16 @@ esp_err_t board_audio_playback_init(i2s_chan_handle_t *tx_handle_out)
         return ret;
     }
     
+    // 注册 DMA 事件回调, 统计当前档位的下溢和 DMA 周期
+    const i2s_event_callbacks_t tx_cbs = {
+        .on_sent = board_audio_on_sent,
+        .on_send_q_ovf = board_audio_on_send_q_ovf,
+    };
+    ret = i2s_channel_register_event_callback(*tx_handle_out, &tx_cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG_AUDIO, "注册I2S发送回调失败: %s", esp_err_to_name(ret));
+    }
+    
     // 4. 初始化ES8311编解码器
     ESP_LOGI(TAG_AUDIO, "初始化ES8311编解码器");
     
@@ -278,14 +381,14 @@ esp_err_t board_audio_playback_init(i2s_chan_handle_t *tx_handle_out)
         return ESP_FAIL;
     }
     
-    // 配置ES8311时钟 - 使用配置的采样率
-    uint32_t mclk_freq_hz = BOARD_AUDIO_SAMPLE_RATE * BOARD_AUDIO_MCLK_MULTIPLE;
+    // 配置ES8311时钟 - 使用当前时钟域采样率
+    uint32_t mclk_freq_hz = s_audio_sample_rate * BOARD_AUDIO_MCLK_MULTIPLE_FOR(s_audio_sample_rate);
     const es8311_clock_config_t es_clk = {
         .mclk_inverted = false,  
         .sclk_inverted = false,
         .mclk_from_mclk_pin = true,
-        .mclk_frequency = mclk_freq_hz, // 使用基于配置采样率计算的MCLK频率
-        .sample_frequency = BOARD_AUDIO_SAMPLE_RATE // 使用配置的采样率
+        .mclk_frequency = mclk_freq_hz, // 使用基于当前采样率计算的MCLK频率
+        .sample_frequency = s_audio_sample_rate
     };
     
     // 初始化ES8311
@@ -296,7 +399,7 @@ esp_err_t board_audio_playback_init(i2s_chan_handle_t *tx_handle_out)
     }
     
     // 配置采样率
-    ret = es8311_sample_frequency_config(es_handle, mclk_freq_hz, BOARD_AUDIO_SAMPLE_RATE);
+    ret = es8311_sample_frequency_config(es_handle, mclk_freq_hz, s_audio_sample_rate);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG_AUDIO, "配置ES8311采样率失败: %s", esp_err_to_name(ret));
         return ret;
@@ -322,6 +425,18 @@ esp_err_t board_audio_playback_init(i2s_chan_handle_t *tx_handle_out)
     // 额外稳定性等待
     vTaskDelay(pdMS_TO_TICKS(20));
     
+    // 保存句柄, 供运行时切换采样率使用
+    if (s_es8311 != NULL && s_es8311 != es_handle) {
+        es8311_delete(s_es8311);
+    }
+    s_es8311 = es_handle;
+    s_audio_tx = *tx_handle_out;
+    
+#if CONFIG_AUDIO_DSP_ENABLE
+    // 载入默认 DSP 参数, 之后可通过 set_eq 事件修改
+    board_audio_dsp_setup();
+#endif
+    
     ESP_LOGI(TAG_AUDIO, "ES8311播放接口初始化成功");
     return ESP_OK;
 }
@@ -354,6 +469,8 @@ esp_err_t board_audio_record_init(i2s_chan_handle_t *rx_handle_out)
     if (*rx_handle_out == NULL) {
         ESP_LOGI(TAG_AUDIO, "创建I2S接收通道");
         i2s_chan_config_t i2s_rx_conf = I2S_CHANNEL_DEFAULT_CONFIG(BOARD_ES7210_I2S_NUM, I2S_ROLE_MASTER);
+        i2s_rx_conf.dma_desc_num = s_dma_desc_num;
+        i2s_rx_conf.dma_frame_num = s_dma_frame_num;
         ret = i2s_new_channel(&i2s_rx_conf, NULL, rx_handle_out);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG_AUDIO, "创建I2S接收通道失败: %s", esp_err_to_name(ret));
@@ -369,8 +486,8 @@ esp_err_t board_audio_record_init(i2s_chan_handle_t *rx_handle_out)
         .slot_cfg = I2S_TDM_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO, BOARD_ES7210_I2S_SLOT_MASK),
         .clk_cfg  = {
             .clk_src = I2S_CLK_SRC_DEFAULT,
-            .sample_rate_hz = BOARD_AUDIO_SAMPLE_RATE,
-            .mclk_multiple = BOARD_AUDIO_MCLK_MULTIPLE
+            .sample_rate_hz = s_audio_sample_rate,
+            .mclk_multiple = BOARD_AUDIO_MCLK_MULTIPLE_FOR(s_audio_sample_rate)
         },
         .gpio_cfg = {
             .mclk = BOARD_ES7210_MCLK_IO,
@@ -392,6 +509,15 @@ esp_err_t board_audio_record_init(i2s_chan_handle_t *rx_handle_out)
         return ret;
     }
     
+    const i2s_event_callbacks_t rx_cbs = {
+        .on_recv = board_audio_on_recv,
+        .on_recv_q_ovf = board_audio_on_recv_q_ovf,
+    };
+    ret = i2s_channel_register_event_callback(*rx_handle_out, &rx_cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG_AUDIO, "注册I2S接收回调失败: %s", esp_err_to_name(ret));
+    }
+    
     // 4. 初始化ES7210编解码器
     ESP_LOGI(TAG_AUDIO, "初始化ES7210编解码器");
     
@@ -413,8 +539,8 @@ esp_err_t board_audio_record_init(i2s_chan_handle_t *rx_handle_out)
     // 配置ES7210参数
     es7210_codec_config_t codec_conf = {
         .i2s_format = BOARD_ES7210_AUDIO_FORMAT,
-        .mclk_ratio = BOARD_AUDIO_MCLK_MULTIPLE,
-        .sample_rate_hz = BOARD_AUDIO_SAMPLE_RATE,
+        .mclk_ratio = BOARD_AUDIO_MCLK_MULTIPLE_FOR(s_audio_sample_rate),
+        .sample_rate_hz = s_audio_sample_rate,
         .bit_width = (es7210_i2s_bits_t)I2S_DATA_BIT_WIDTH_16BIT,
         .mic_bias = BOARD_ES7210_MIC_BIAS,
         .mic_gain = BOARD_ES7210_MIC_GAIN,
@@ -432,202 +558,1281 @@ esp_err_t board_audio_record_init(i2s_chan_handle_t *rx_handle_out)
         ESP_LOGE(TAG_AUDIO, "配置ES7210音量失败: %s", esp_err_to_name(ret));
         return ret;
     }
-    
-    // 额外稳定性等待
-    vTaskDelay(pdMS_TO_TICKS(20));
-    
-    ESP_LOGI(TAG_AUDIO, "ES7210录音接口初始化成功");
+    
+    // 寄存器已配置完毕, 之后切换采样率直接写 I2C
+    es7210_del_codec(es7210_handle);
+    s_audio_rx = *rx_handle_out;
+    
+    // 额外稳定性等待
+    vTaskDelay(pdMS_TO_TICKS(20));
+    
+    ESP_LOGI(TAG_AUDIO, "ES7210录音接口初始化成功");
+    return ESP_OK;
+}
+
+/**
+ * @brief 安装 GDMA 异步内存拷贝 (首次使用时)
+ */
+static esp_err_t board_audio_mcp_init(void)
+{
+    if (s_audio_mcp != NULL) {
+        return ESP_OK;
+    }
+    
+    async_memcpy_config_t cfg = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    cfg.backlog = BOARD_AUDIO_DMA_COPY_BACKLOG;
+    cfg.sram_trans_align = 4;
+    cfg.psram_trans_align = BOARD_AUDIO_PSRAM_DMA_ALIGN;
+    s_capture_sem = xSemaphoreCreateBinary();
+    s_prefetch_sem = xSemaphoreCreateCounting(2, 0);
+    esp_err_t ret = (s_capture_sem && s_prefetch_sem) ? esp_async_memcpy_install(&cfg, &s_audio_mcp) : ESP_ERR_NO_MEM;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_AUDIO, "安装异步内存拷贝失败: %s, 使用CPU拷贝", esp_err_to_name(ret));
+        if (s_capture_sem) {
+            vSemaphoreDelete(s_capture_sem);
+            s_capture_sem = NULL;
+        }
+        if (s_prefetch_sem) {
+            vSemaphoreDelete(s_prefetch_sem);
+            s_prefetch_sem = NULL;
+        }
+        s_zero_copy = false;
+    }
+    return ret;
+}
+
+/**
+ * @brief 录音拷贝完成回调 (中断上下文)
+ */
+static bool IRAM_ATTR board_audio_capture_done(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *cb_args)
+{
+    BaseType_t woken = pdFALSE;
+    s_capture.done += (size_t)cb_args;
+    xSemaphoreGiveFromISR(s_capture_sem, &woken);
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief 接收完成回调 (中断上下文): 零拷贝录音时把刚填满的 DMA 缓冲区异步拷贝到 PSRAM
+ * @details DMA 缓冲区要在 desc_num - 1 个周期后才会被覆盖, GDMA 拷贝一个周期只需数十微秒
+ */
+static bool IRAM_ATTR board_audio_on_recv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    if (!s_capture_active) {
+        return false;
+    }
+    size_t n = event->size;
+    size_t left = s_capture.size - s_capture.issued;
+    if (n > left) {
+        n = left;
+    }
+    // 跨越块边界时拆成两次拷贝 (块长和 DMA 周期都是对齐长度的整数倍)
+    uint8_t *src = event->dma_buf;
+    while (n > 0) {
+        size_t off = s_capture.issued % s_capture.block_size;
+        size_t part = s_capture.block_size - off;
+        if (part > n) {
+            part = n;
+        }
+        uint8_t *dst = s_capture.blocks[s_capture.issued / s_capture.block_size] + off;
+        if (esp_async_memcpy(s_audio_mcp, dst, src, part, board_audio_capture_done, (void *)part) != ESP_OK) {
+            s_capture.dropped++;
+            break;
+        }
+        s_capture.issued += part;
+        src += part;
+        n -= part;
+    }
+    return false;
+}
+
+/**
+ * @brief 零拷贝录音循环 (通道已启用)
+ */
+static esp_err_t board_audio_record_zero_copy(uint8_t *const *blocks, size_t block_count, size_t block_size,
+                                              size_t *bytes_read, uint32_t timeout_ms, size_t bytes_per_second)
+{
+    // 先写回并作废目标区域的缓存行, 否则脏行可能在 DMA 写入后被写回, 覆盖录音数据
+    size_t size = block_count * block_size;
+    size -= size % BOARD_AUDIO_PSRAM_DMA_ALIGN;
+    for (size_t i = 0; i * block_size < size; i++) {
+        size_t n = (size - i * block_size < block_size) ? size - i * block_size : block_size;
+        esp_cache_msync(blocks[i], n, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_INVALIDATE);
+    }
+    
+    s_capture.blocks = blocks;
+    s_capture.block_size = block_size;
+    s_capture.size = size;
+    s_capture.issued = 0;
+    s_capture.done = 0;
+    s_capture.dropped = 0;
+    xSemaphoreTake(s_capture_sem, 0);
+    s_capture_active = true;
+    
+    uint32_t start_time = esp_log_timestamp();
+    uint32_t elapsed_time = 0;
+    uint32_t last_progress_time = 0;
+    while (elapsed_time < timeout_ms && s_capture.issued < size) {
+        // 每个 DMA 周期唤醒一次, 只用于进度和超时判断, 不接触音频数据
+        if (xSemaphoreTake(s_capture_sem, pdMS_TO_TICKS(500)) != pdTRUE) {
+            ESP_LOGW(TAG_AUDIO, "等待DMA数据超时，但将继续录音");
+        }
+        elapsed_time = esp_log_timestamp() - start_time;
+        if (elapsed_time - last_progress_time >= 200) {
+            last_progress_time = elapsed_time;
+            ESP_LOGI(TAG_AUDIO, "录音进度: %.2f秒/%.2f秒，已录制 %u 字节 (零拷贝)",
+                     (float)s_capture.done / bytes_per_second, (float)timeout_ms / 1000.0f,
+                     (unsigned int)s_capture.done);
+        }
+    }
+    s_capture_active = false;
+    
+    // 等待已提交的拷贝完成
+    for (int i = 0; i < 10 && s_capture.done < s_capture.issued; i++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    *bytes_read = s_capture.done;
+    
+    // DMA 写入的数据对 CPU 可见前作废缓存 (之后 DSP 或上传才读取)
+    for (size_t i = 0; i * block_size < size; i++) {
+        size_t n = (size - i * block_size < block_size) ? size - i * block_size : block_size;
+        esp_cache_msync(blocks[i], n, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+    }
+    
+    if (s_capture.dropped > 0) {
+        ESP_LOGW(TAG_AUDIO, "拷贝队列满, 丢失 %u 个DMA周期", (unsigned int)s_capture.dropped);
+        int idx = s_dma_tel_idx;
+        if (idx >= 0) {
+            portENTER_CRITICAL(&s_dma_tel_lock);
+            s_dma_tel[idx].rx_overflows += s_capture.dropped;
+            portEXIT_CRITICAL(&s_dma_tel_lock);
+        }
+    }
+    return (s_capture.done < s_capture.issued) ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+
+/**
+ * @brief 设置零拷贝路径开关
+ */
+void board_audio_set_zero_copy(bool enable)
+{
+    s_zero_copy = enable;
+}
+
+/**
+ * @brief 零拷贝路径是否启用
+ */
+bool board_audio_get_zero_copy(void)
+{
+    return s_zero_copy;
+}
+
+/**
+ * @brief 占用接收通道
+ * @details 录音在整个采集期间占用; 重建通道、切换时钟和启用全双工通路在操作期间占用, 互相排斥.
+ *          不可嵌套, 不等待
+ */
+static esp_err_t board_audio_rx_acquire(void)
+{
+    bool ok;
+    portENTER_CRITICAL(&s_play_lock);
+    ok = (s_rx_owner == NULL);
+    if (ok) {
+        s_rx_owner = xTaskGetCurrentTaskHandle();
+    }
+    portEXIT_CRITICAL(&s_play_lock);
+    return ok ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+/**
+ * @brief 释放接收通道占用
+ */
+static void board_audio_rx_release(void)
+{
+    portENTER_CRITICAL(&s_play_lock);
+    if (s_rx_owner == xTaskGetCurrentTaskHandle()) {
+        s_rx_owner = NULL;
+    }
+    portEXIT_CRITICAL(&s_play_lock);
+}
+
+/**
+ * @brief 录制音频数据
+ */
+esp_err_t board_audio_record(i2s_chan_handle_t rx_handle, uint8_t *buffer, 
+                            size_t buffer_size, size_t *bytes_read, uint32_t timeout_ms)
+{
+    uint8_t *const blocks[1] = { buffer };
+    return board_audio_record_blocks(rx_handle, blocks, 1, buffer_size, bytes_read, timeout_ms);
+}
+
+/**
+ * @brief 录制音频数据到一组等长的块
+ */
+esp_err_t board_audio_record_blocks(i2s_chan_handle_t rx_handle, uint8_t *const *blocks, size_t block_count,
+                                    size_t block_size, size_t *bytes_read, uint32_t timeout_ms)
+{
+    if (!rx_handle || !blocks || block_count == 0 || block_size == 0 || !bytes_read) {
+        ESP_LOGE(TAG_AUDIO, "无效参数");
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < block_count; i++) {
+        if (blocks[i] == NULL) {
+            ESP_LOGE(TAG_AUDIO, "无效参数");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    size_t buffer_size = block_count * block_size;
+    
+    esp_err_t ret;
+    size_t bytes_read_once = 0;
+    *bytes_read = 0;  // 初始化已读取字节数
+    
+    // 录音期间占用接收通道, 切换采样率或 DMA 档位不会重建通道; 调用者的句柄可能已在占用前失效
+    if (board_audio_rx_acquire() != ESP_OK || s_audio_rx_running || s_audio_rx == NULL) {
+        ESP_LOGW(TAG_AUDIO, "接收通道忙");
+        board_audio_rx_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    rx_handle = s_audio_rx;
+    
+    // 启用I2S通道
+    ESP_LOGI(TAG_AUDIO, "启动录音...");
+    ret = i2s_channel_enable(rx_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_AUDIO, "启用I2S通道失败: %s", esp_err_to_name(ret));
+        board_audio_rx_release();
+        return ret;
+    }
+    s_audio_rx_running = true;
+    int64_t rx_start_us = esp_timer_get_time();
+    
+    // 等待I2S通道稳定
+    vTaskDelay(pdMS_TO_TICKS(50));
+    
+    // 开始录音
+    ESP_LOGI(TAG_AUDIO, "开始录制音频，总缓冲区大小: %u 字节，请求时长: %u 毫秒", 
+              (unsigned int)buffer_size, (unsigned int)timeout_ms);
+    uint32_t start_time = esp_log_timestamp();
+    uint32_t elapsed_time = 0;
+    uint32_t last_progress_time = 0;
+    
+    // 计算每秒的数据量（用于估计录音长度）
+    // 16位立体声 @ 44.1kHz = 44100 * 2(字节) * 2(通道) = 176400 字节/秒
+    size_t bytes_per_second = s_audio_sample_rate * 2 * 2; // 采样率 * 16位(2字节) * 通道数
+    float max_recording_seconds = (float)buffer_size / bytes_per_second;
+    ESP_LOGI(TAG_AUDIO, "当前缓冲区最多可录制约 %.2f 秒音频", max_recording_seconds);
+    
+    // PSRAM 缓冲区满足对齐要求时走 GDMA 零拷贝路径, CPU 不再逐字节写 PSRAM
+    bool zero_copy = s_zero_copy && buffer_size >= BOARD_AUDIO_PSRAM_DMA_ALIGN &&
+                     (block_count == 1 || block_size % BOARD_AUDIO_PSRAM_DMA_ALIGN == 0) &&
+                     (s_dma_frame_num * 2 * sizeof(int16_t)) % BOARD_AUDIO_PSRAM_DMA_ALIGN == 0;
+    for (size_t i = 0; zero_copy && i < block_count; i++) {
+        zero_copy = esp_ptr_external_ram(blocks[i]) && ((uintptr_t)blocks[i] % BOARD_AUDIO_PSRAM_DMA_ALIGN) == 0;
+    }
+    if (zero_copy && board_audio_mcp_init() == ESP_OK) {
+        ret = board_audio_record_zero_copy(blocks, block_count, block_size, bytes_read, timeout_ms, bytes_per_second);
+        i2s_channel_disable(rx_handle);
+        s_audio_rx_running = false;
+        board_audio_rx_telemetry_end(rx_start_us);
+        board_audio_rx_release();
+        ESP_LOGI(TAG_AUDIO, "录音完成 (零拷贝)，共录制 %u 字节 (约 %.2f 秒) 的数据",
+                 (unsigned int)*bytes_read, (float)*bytes_read / bytes_per_second);
+        return ret;
+    }
+    
+    // 使用BOARD_AUDIO_RECORD_CHUNK_SIZE控制每次读取的数据量
+    size_t chunk_size = BOARD_AUDIO_RECORD_CHUNK_SIZE;
+    if (chunk_size > buffer_size) {
+        chunk_size = buffer_size;
+    }
+    
+    // 录音循环，直到达到超时时间或缓冲区已满
+    while (elapsed_time < timeout_ms && *bytes_read < buffer_size) {
+        // 计算当前块剩余可用缓冲区
+        size_t block_offset = *bytes_read % block_size;
+        size_t remaining_buffer = block_size - block_offset;
+        // 确定本次读取的大小
+        size_t read_size = (remaining_buffer < chunk_size) ? remaining_buffer : chunk_size;
+        
+        // 判断是否还有足够的可录制时间
+        uint32_t remaining_timeout = timeout_ms - elapsed_time;
+        if (remaining_timeout < 100) {
+            ESP_LOGI(TAG_AUDIO, "录音时间即将到达，完成录音");
+            break;
+        }
+        
+        // 设置单次读取的超时时间
+        uint32_t read_timeout = (remaining_timeout < 500) ? remaining_timeout : 500; // 最多500ms一次
+        
+        // 读取数据
+        ret = i2s_channel_read(rx_handle, blocks[*bytes_read / block_size] + block_offset, read_size, &bytes_read_once, 
+                              pdMS_TO_TICKS(read_timeout));
+        
+        if (ret == ESP_ERR_TIMEOUT) {
+            // 读取超时，但仍可继续
+            ESP_LOGW(TAG_AUDIO, "读取超时，但将继续录音");
+        } else if (ret != ESP_OK) {
+            // 其他错误，退出
+            ESP_LOGE(TAG_AUDIO, "读取错误: %s", esp_err_to_name(ret));
+            i2s_channel_disable(rx_handle);
+            s_audio_rx_running = false;
+            board_audio_rx_telemetry_end(rx_start_us);
+            board_audio_rx_release();
+            return ret;
+        }
+        
+        // 更新已读取的总字节数
+        *bytes_read += bytes_read_once;
+        
+        // 更新已经过的时间
+        elapsed_time = esp_log_timestamp() - start_time;
+        
+        // 更新进度信息 - 每200毫秒输出一次进度
+        if (elapsed_time - last_progress_time >= 200) {
+            last_progress_time = elapsed_time;
+            float progress_seconds = (float)*bytes_read / bytes_per_second;
+            float total_seconds = (float)timeout_ms / 1000.0f;
+            float percent = (total_seconds > 0) ? (progress_seconds / total_seconds) * 100.0f : 0.0f;
+            
+            ESP_LOGI(TAG_AUDIO, "录音进度: %.1f%% (%.2f秒/%.2f秒)，已录制 %u 字节", 
+                     percent, progress_seconds, total_seconds, (unsigned int)*bytes_read);
+        }
+        
+        // 如果缓冲区已满，提前退出循环
+        if (*bytes_read >= buffer_size) {
+            ESP_LOGW(TAG_AUDIO, "录音缓冲区已满 (%u 字节)，提前结束录音", (unsigned int)*bytes_read);
+            break;
+        }
+    }
+    
+    // 禁用I2S通道
+    i2s_channel_disable(rx_handle);
+    s_audio_rx_running = false;
+    board_audio_rx_telemetry_end(rx_start_us);
+    board_audio_rx_release();
+    
+    // 输出录音完成信息
+    elapsed_time = esp_log_timestamp() - start_time;
+    float recorded_seconds = (float)*bytes_read / bytes_per_second;
+    
+    ESP_LOGI(TAG_AUDIO, "录音完成，共录制 %u 字节 (约 %.2f 秒) 的数据, 耗时 %u 毫秒", 
+            (unsigned int)*bytes_read, recorded_seconds, (unsigned int)elapsed_time);
+    
+    return ESP_OK;
+}
+
+#if CONFIG_AUDIO_DSP_ENABLE
+#define BOARD_AUDIO_FRAME_BYTES (BOARD_AUDIO_PLAYBACK_CHANNELS * BOARD_AUDIO_PLAYBACK_BIT_WIDTH / 8)
+
+/* DSP 输出暂存缓冲区 (内部 RAM), 同一时间只有一路播放 */
+static int16_t s_dsp_buf[BOARD_AUDIO_DSP_BLOCK_FRAMES * BOARD_AUDIO_PLAYBACK_CHANNELS];
+static bool s_dsp_ready = false;
+
+/**
+ * @brief 初始化播放 DSP 并载入 board.h 中的默认参数
+ */
+static void board_audio_dsp_setup(void)
+{
+    if (s_dsp_ready) {
+        return;
+    }
+    audio_dsp_init(s_audio_sample_rate, BOARD_AUDIO_PLAYBACK_CHANNELS);
+
+    const audio_dsp_eq_band_t eq = { AUDIO_DSP_EQ_HIGH_PASS, BOARD_AUDIO_EQ_HPF_HZ, 0.707f, 0.0f };
+    const audio_dsp_compressor_t comp = {
+        .enable = true,
+        .threshold_db = BOARD_AUDIO_COMP_THRESHOLD_DB,
+        .ratio = BOARD_AUDIO_COMP_RATIO,
+        .knee_db = BOARD_AUDIO_COMP_KNEE_DB,
+        .attack_ms = BOARD_AUDIO_COMP_ATTACK_MS,
+        .release_ms = BOARD_AUDIO_COMP_RELEASE_MS,
+        .makeup_db = BOARD_AUDIO_COMP_MAKEUP_DB,
+    };
+    const audio_dsp_limiter_t limiter = {
+        .enable = true,
+        .ceiling_db = BOARD_AUDIO_LIMIT_CEILING_DB,
+        .release_ms = BOARD_AUDIO_LIMIT_RELEASE_MS,
+    };
+    audio_dsp_set_eq(&eq, 1);
+    audio_dsp_set_compressor(&comp);
+    audio_dsp_set_limiter(&limiter);
+    s_dsp_ready = true;
+    ESP_LOGI(TAG_AUDIO, "播放DSP已启用: 高通 %.0fHz, 压缩 %.0fdB %.0f:1, 限幅 %.1fdBFS",
+             BOARD_AUDIO_EQ_HPF_HZ, BOARD_AUDIO_COMP_THRESHOLD_DB, BOARD_AUDIO_COMP_RATIO,
+             BOARD_AUDIO_LIMIT_CEILING_DB);
+}
+
+/**
+ * @brief 将 DSP 暂存缓冲区写入 I2S
+ */
+static esp_err_t board_audio_write_raw(i2s_chan_handle_t tx_handle, const uint8_t *data, size_t size, TickType_t ticks)
+{
+    size_t offset = 0;
+    while (offset < size) {
+        size_t bytes_written = 0;
+        esp_err_t ret = i2s_channel_write(tx_handle, data + offset, size - offset, &bytes_written, ticks);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_AUDIO, "写入I2S通道失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        offset += bytes_written;
+    }
+    return ESP_OK;
+}
+#endif
+
+/**
+ * @brief 占用播放通道
+ */
+esp_err_t board_audio_playback_acquire(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    bool ok;
+    portENTER_CRITICAL(&s_play_lock);
+    ok = (s_play_owner == NULL || s_play_owner == self);
+    if (ok) {
+        s_play_owner = self;
+        s_play_depth++;
+    }
+    portEXIT_CRITICAL(&s_play_lock);
+    if (!ok) {
+        ESP_LOGW(TAG_AUDIO, "音频通道忙");
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 释放播放通道
+ */
+void board_audio_playback_release(void)
+{
+    portENTER_CRITICAL(&s_play_lock);
+    if (s_play_owner == xTaskGetCurrentTaskHandle() && s_play_depth > 0) {
+        if (--s_play_depth == 0) {
+            s_play_owner = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&s_play_lock);
+}
+
+/**
+ * @brief 开始流式播放
+ */
+esp_err_t board_audio_stream_begin(i2s_chan_handle_t tx_handle, const uint8_t *preload,
+                                   size_t preload_size, size_t *bytes_loaded)
+{
+    if (!tx_handle) {
+        ESP_LOGE(TAG_AUDIO, "无效参数");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 先占用通道再触碰 DSP 和 I2S 状态, 到 board_audio_stream_end() 释放
+    esp_err_t ret = board_audio_playback_acquire();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (s_audio_tx_running) {
+        // 监听等全双工通路正在使用发送通道
+        ESP_LOGW(TAG_AUDIO, "发送通道已启用, 无法开始播放");
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 调用者在占用前读取句柄, 期间通道可能已被 board_audio_reinit_channels() 重建, 占用后改用当前发送通道
+    tx_handle = s_audio_tx;
+    if (tx_handle == NULL) {
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    size_t bytes_written = 0;
+    size_t bytes_consumed = 0;
+    size_t dsp_bytes = 0;
+    
+#if CONFIG_AUDIO_DSP_ENABLE
+    board_audio_dsp_setup();
+    audio_dsp_reset();
+    
+    // 预加载经过 DSP 处理的首块数据
+    if (preload != NULL && preload_size >= BOARD_AUDIO_FRAME_BYTES) {
+        size_t frames = preload_size / BOARD_AUDIO_FRAME_BYTES;
+        if (frames > BOARD_AUDIO_DSP_BLOCK_FRAMES) {
+            frames = BOARD_AUDIO_DSP_BLOCK_FRAMES;
+        }
+        audio_dsp_process((const int16_t *)preload, s_dsp_buf, frames);
+        bytes_consumed = frames * BOARD_AUDIO_FRAME_BYTES;
+        dsp_bytes = bytes_consumed;
+        preload = (const uint8_t *)s_dsp_buf;
+        preload_size = dsp_bytes;
+    } else {
+        preload = NULL;
+    }
+#endif
+    
+    // 预加载部分数据, 避免通道启用后先输出一段空白
+    if (preload != NULL && preload_size > 0) {
+        ret = i2s_channel_preload_data(tx_handle, preload, preload_size, &bytes_written);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_AUDIO, "预加载数据失败: %s", esp_err_to_name(ret));
+            board_audio_playback_release();
+            return ret;
+        }
+        ESP_LOGI(TAG_AUDIO, "预加载了 %u 字节的音频数据", (unsigned int)bytes_written);
+    }
+    if (dsp_bytes == 0) {
+        bytes_consumed = bytes_written;
+    }
+    if (bytes_loaded) {
+        *bytes_loaded = bytes_consumed;
+    }
+    
+    // 打开功放
+    board_pa_power(true);
+    
+    // 启用发送通道
+    ret = i2s_channel_enable(tx_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_AUDIO, "启用I2S通道失败: %s", esp_err_to_name(ret));
+        board_pa_power(false);
+        board_audio_playback_release();
+        return ret;
+    }
+    s_audio_tx_running = true;
+    s_tx_last_sent_us = 0;
+    s_tx_start_us = esp_timer_get_time();
+    s_tx_underflows_start = (s_dma_tel_idx >= 0) ? s_dma_tel[s_dma_tel_idx].tx_underflows : 0;
+    s_tx_streaming = true;
+    
+#if CONFIG_AUDIO_DSP_ENABLE
+    // 已处理但未能预加载的部分在启用后写入
+    if (bytes_written < dsp_bytes) {
+        ret = board_audio_write_raw(tx_handle, (const uint8_t *)s_dsp_buf + bytes_written,
+                                    dsp_bytes - bytes_written, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            // 调用者不会再结束播放, 在这里停止通道并释放占用
+            board_audio_stream_end(tx_handle);
+            return ret;
+        }
+    }
+#endif
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief 预取完成回调 (中断上下文)
+ */
+static bool IRAM_ATTR board_audio_prefetch_done(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *cb_args)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(s_prefetch_sem, &woken);
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief 经内部 RAM 双缓冲播放 PSRAM 中的数据
+ * @details GDMA 预取第 n+1 块的同时, CPU 对已在内部 RAM 中的第 n 块做 DSP 处理或写入 I2S.
+ *          只处理完整的预取块, 不足一块的尾部由调用者按普通路径写入
+ * @param[out] consumed 已播放的字节数
+ */
+static esp_err_t board_audio_write_prefetched(i2s_chan_handle_t tx_handle, const uint8_t *data, size_t size,
+                                              TickType_t ticks, size_t *consumed)
+{
+    size_t blocks = size / BOARD_AUDIO_PREFETCH_BYTES;
+    *consumed = 0;
+    if (blocks == 0) {
+        return ESP_OK;
+    }
+    
+    // 源数据可能仍在缓存中 (CPU 写入), 写回后 DMA 才能读到
+    esp_cache_msync((void *)data, blocks * BOARD_AUDIO_PREFETCH_BYTES, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+    
+    // 拷贝队列满等失败时剩余数据交给普通路径
+    if (esp_async_memcpy(s_audio_mcp, s_prefetch_buf[0], (void *)data, BOARD_AUDIO_PREFETCH_BYTES,
+                         board_audio_prefetch_done, NULL) != ESP_OK) {
+        return ESP_OK;
+    }
+    for (size_t k = 0; k < blocks; k++) {
+        if (xSemaphoreTake(s_prefetch_sem, pdMS_TO_TICKS(100)) != pdTRUE) {
+            ESP_LOGE(TAG_AUDIO, "等待预取数据超时");
+            return ESP_ERR_TIMEOUT;
+        }
+        bool next = (k + 1 < blocks) &&
+                    esp_async_memcpy(s_audio_mcp, s_prefetch_buf[(k + 1) & 1],
+                                     (void *)(data + (k + 1) * BOARD_AUDIO_PREFETCH_BYTES),
+                                     BOARD_AUDIO_PREFETCH_BYTES, board_audio_prefetch_done, NULL) == ESP_OK;
+        
+        const uint8_t *block = s_prefetch_buf[k & 1];
+#if CONFIG_AUDIO_DSP_ENABLE
+        audio_dsp_process((const int16_t *)block, s_dsp_buf, BOARD_AUDIO_PREFETCH_BYTES / BOARD_AUDIO_FRAME_BYTES);
+        esp_err_t ret = board_audio_write_raw(tx_handle, (const uint8_t *)s_dsp_buf, BOARD_AUDIO_PREFETCH_BYTES, ticks);
+#else
+        esp_err_t ret = ESP_OK;
+        size_t offset = 0;
+        while (ret == ESP_OK && offset < BOARD_AUDIO_PREFETCH_BYTES) {
+            size_t bytes_written = 0;
+            ret = i2s_channel_write(tx_handle, block + offset, BOARD_AUDIO_PREFETCH_BYTES - offset, &bytes_written, ticks);
+            offset += bytes_written;
+        }
+#endif
+        if (ret != ESP_OK) {
+            // 等待在途的预取完成, 避免下次预取写入正在使用的缓冲区
+            if (next) {
+                xSemaphoreTake(s_prefetch_sem, pdMS_TO_TICKS(100));
+            }
+            return ret;
+        }
+        *consumed += BOARD_AUDIO_PREFETCH_BYTES;
+        if (k + 1 < blocks && !next) {
+            break;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 流式写入播放数据
+ */
+esp_err_t board_audio_stream_write(i2s_chan_handle_t tx_handle, const uint8_t *data, size_t size, uint32_t timeout_ms)
+{
+    if (!tx_handle || (!data && size > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 播放期间占用通道, 发送通道不会被重建, 使用当前句柄
+    tx_handle = s_audio_tx;
+    if (tx_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    
+    // PSRAM 中按对齐存放的数据先由 GDMA 预取到内部 RAM, 剩余尾部走下面的普通路径
+    if (s_zero_copy && size >= BOARD_AUDIO_PREFETCH_BYTES && esp_ptr_external_ram(data) &&
+        ((uintptr_t)data % BOARD_AUDIO_PSRAM_DMA_ALIGN) == 0 && board_audio_mcp_init() == ESP_OK) {
+        size_t consumed = 0;
+        esp_err_t ret = board_audio_write_prefetched(tx_handle, data, size, ticks, &consumed);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        data += consumed;
+        size -= consumed;
+    }
+    
+#if CONFIG_AUDIO_DSP_ENABLE
+    // 按块处理后写入 (不足一帧的尾部丢弃)
+    size_t frames = size / BOARD_AUDIO_FRAME_BYTES;
+    const int16_t *src = (const int16_t *)data;
+    while (frames > 0) {
+        size_t n = frames > BOARD_AUDIO_DSP_BLOCK_FRAMES ? BOARD_AUDIO_DSP_BLOCK_FRAMES : frames;
+        audio_dsp_process(src, s_dsp_buf, n);
+        esp_err_t ret = board_audio_write_raw(tx_handle, (const uint8_t *)s_dsp_buf, n * BOARD_AUDIO_FRAME_BYTES, ticks);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        src += n * BOARD_AUDIO_PLAYBACK_CHANNELS;
+        frames -= n;
+    }
+    return ESP_OK;
+#else
+    size_t offset = 0;
+    while (offset < size) {
+        size_t bytes_written = 0;
+        esp_err_t ret = i2s_channel_write(tx_handle, data + offset, size - offset, &bytes_written, ticks);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_AUDIO, "写入I2S通道失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        offset += bytes_written;
+    }
+    return ESP_OK;
+#endif
+}
+
+/**
+ * @brief 结束流式播放
+ */
+void board_audio_stream_end(i2s_chan_handle_t tx_handle)
+{
+    if (!tx_handle) {
+        return;
+    }
+    tx_handle = s_audio_tx;
+    if (tx_handle == NULL) {
+        board_audio_playback_release();
+        return;
+    }
+    
+    // 数据源已结束, 之后排空 DMA 期间的发送队列溢出不计为下溢
+    if (s_tx_streaming) {
+        s_tx_streaming = false;
+        int idx = s_dma_tel_idx;
+        if (idx >= 0) {
+            portENTER_CRITICAL(&s_dma_tel_lock);
+            s_dma_tel[idx].tx_us += esp_timer_get_time() - s_tx_start_us;
+            uint32_t underflows = s_dma_tel[idx].tx_underflows - s_tx_underflows_start;
+            portEXIT_CRITICAL(&s_dma_tel_lock);
+            if (underflows > 0) {
+                ESP_LOGW(TAG_AUDIO, "本次播放 DMA 下溢 %u 次 (档位 %s)", (unsigned int)underflows,
+                         s_dma_profiles[idx].name);
+            }
+        }
+    }
+    
+#if CONFIG_AUDIO_DSP_ENABLE
+    // 取出限幅器前瞻延迟中的尾部数据
+    audio_dsp_process(NULL, s_dsp_buf, AUDIO_DSP_LOOKAHEAD_FRAMES);
+    board_audio_write_raw(tx_handle, (const uint8_t *)s_dsp_buf,
+                          AUDIO_DSP_LOOKAHEAD_FRAMES * BOARD_AUDIO_FRAME_BYTES, pdMS_TO_TICKS(100));
+    
+    audio_dsp_stats_t st;
+    audio_dsp_get_stats(&st);
+    if (st.frames > 0) {
+        // 处理周期占音频时长对应 CPU 周期的比例
+        uint64_t budget = (uint64_t)st.frames * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000 / s_audio_sample_rate;
+        uint32_t load_permille = (uint32_t)(st.cycles * 1000 / budget);
+        ESP_LOGI(TAG_AUDIO, "播放DSP: CPU 占用 %u.%u%%, 压缩最大衰减 %.1fdB, 限幅最大衰减 %.1fdB (%u 帧)",
+                 (unsigned int)(load_permille / 10), (unsigned int)(load_permille % 10),
+                 st.max_comp_reduction_db, st.max_limit_reduction_db, (unsigned int)st.limited_frames);
+    }
+#endif
+    
+    // 等待所有数据播放完毕
+    vTaskDelay(pdMS_TO_TICKS(500));
+    
+    // 禁用I2S通道并关闭功放
+    i2s_channel_disable(tx_handle);
+    s_audio_tx_running = false;
+    board_pa_power(false);
+    board_audio_playback_release();
+}
+
+/**
+ * @brief 通过ES8311播放音频数据
+ */
+esp_err_t board_audio_play(i2s_chan_handle_t tx_handle, const uint8_t *buffer, size_t buffer_size)
+{
+    const uint8_t *blocks[1] = { buffer };
+    return board_audio_play_blocks(tx_handle, blocks, 1, buffer_size, buffer_size);
+}
+
+esp_err_t board_audio_play_blocks(i2s_chan_handle_t tx_handle, const uint8_t *const *blocks, size_t block_count,
+                                  size_t block_size, size_t total_size)
+{
+    if (!tx_handle || !blocks || block_count == 0 || block_size == 0 || total_size == 0 ||
+        total_size > block_count * block_size) {
+        ESP_LOGE(TAG_AUDIO, "无效参数");
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < block_count; i++) {
+        if (blocks[i] == NULL) {
+            ESP_LOGE(TAG_AUDIO, "无效参数");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    esp_err_t ret;
+    size_t bytes_written = 0;
+    
+    // 预加载部分数据并启动播放 (不超过第一块)
+    size_t first = total_size < block_size ? total_size : block_size;
+    size_t preload_size = first > 1024 ? 1024 : first;
+    ret = board_audio_stream_begin(tx_handle, blocks[0], preload_size, &bytes_written);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 播放剩余数据
+    size_t remaining = total_size - bytes_written;
+    size_t offset = bytes_written;
+    
+    ESP_LOGI(TAG_AUDIO, "开始播放音频...");
+    uint32_t start_time = esp_log_timestamp();
+    
+    while (remaining > 0) {
+        // 分段写入, 以便输出播放进度; 分段不跨块
+        const uint8_t *src = blocks[offset / block_size] + offset % block_size;
+        size_t left_in_block = block_size - offset % block_size;
+        size_t chunk = remaining > BOARD_AUDIO_PLAY_CHUNK_SIZE ? BOARD_AUDIO_PLAY_CHUNK_SIZE : remaining;
+        if (chunk > left_in_block) {
+            chunk = left_in_block;
+        }
+        ret = board_audio_stream_write(tx_handle, src, chunk, UINT32_MAX);
+        if (ret != ESP_OK) {
+            break;
+        }
+        
+        remaining -= chunk;
+        offset += chunk;
+        
+        // 每秒显示进度
+        if (esp_log_timestamp() - start_time >= 1000) {
+            start_time = esp_log_timestamp();
+            ESP_LOGI(TAG_AUDIO, "播放进度: %.1f%%", (float)(total_size - remaining) * 100 / total_size);
+        }
+    }
+    
+    board_audio_stream_end(tx_handle);
+    
+    ESP_LOGI(TAG_AUDIO, "音频播放完成");
+    return ESP_OK;
+}
+
+/**
+ * @brief 以指定 DMA 深度重建 I2S 发送和接收通道
+ */
+esp_err_t board_audio_reinit_channels(i2s_chan_handle_t *tx_handle, i2s_chan_handle_t *rx_handle,
+                                      uint32_t desc_num, uint32_t frame_num)
+{
+    if (tx_handle == NULL || rx_handle == NULL || desc_num < 2 || frame_num == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = board_audio_playback_acquire();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (board_audio_rx_acquire() != ESP_OK) {
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_audio_tx_running || s_audio_rx_running) {
+        board_audio_rx_release();
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ESP_LOGI(TAG_AUDIO, "重建I2S通道: DMA %u x %u 帧", (unsigned int)desc_num, (unsigned int)frame_num);
+    if (*tx_handle != NULL) {
+        board_audio_i2s_deinit(*tx_handle);
+        *tx_handle = NULL;
+    }
+    if (*rx_handle != NULL) {
+        board_audio_i2s_deinit(*rx_handle);
+        *rx_handle = NULL;
+    }
+    
+    s_dma_desc_num = desc_num;
+    s_dma_frame_num = frame_num;
+    s_dma_tel_idx = -1;     // 由 board_audio_set_dma_profile() 恢复
+    ret = board_audio_playback_init(tx_handle);
+    if (ret == ESP_OK) {
+        ret = board_audio_record_init(rx_handle);
+    }
+    board_audio_rx_release();
+    board_audio_playback_release();
+    return ret;
+}
+
+/**
+ * @brief 同时启用发送和接收通道
+ */
+esp_err_t board_audio_duplex_start(i2s_chan_handle_t tx_handle, i2s_chan_handle_t rx_handle)
+{
+    if (tx_handle == NULL || rx_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 启用后由 s_audio_tx_running 阻止播放, 不需要一直占用
+    esp_err_t ret = board_audio_playback_acquire();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (board_audio_rx_acquire() != ESP_OK) {
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_audio_tx_running || s_audio_rx_running) {
+        board_audio_rx_release();
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    board_pa_power(true);
+    ret = i2s_channel_enable(tx_handle);
+    if (ret == ESP_OK) {
+        s_audio_tx_running = true;
+        ret = i2s_channel_enable(rx_handle);
+        if (ret == ESP_OK) {
+            s_audio_rx_running = true;
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_AUDIO, "启用全双工通道失败: %s", esp_err_to_name(ret));
+        board_audio_duplex_stop(tx_handle, rx_handle);
+    }
+    board_audio_rx_release();
+    board_audio_playback_release();
+    return ret;
+}
+
+/**
+ * @brief 停止全双工通路
+ */
+void board_audio_duplex_stop(i2s_chan_handle_t tx_handle, i2s_chan_handle_t rx_handle)
+{
+    if (s_audio_rx_running && rx_handle != NULL) {
+        i2s_channel_disable(rx_handle);
+    }
+    s_audio_rx_running = false;
+    if (s_audio_tx_running && tx_handle != NULL) {
+        i2s_channel_disable(tx_handle);
+    }
+    s_audio_tx_running = false;
+    board_pa_power(false);
+}
+
+static int64_t s_capture_start_us = 0;
+
+/**
+ * @brief 启用接收通道 (流式录音)
+ */
+esp_err_t board_audio_capture_begin(i2s_chan_handle_t rx_handle)
+{
+    if (rx_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 占用到 board_audio_capture_end(), 期间切换采样率或 DMA 档位不会重建通道.
+    // 调用者自行读取句柄, 占用前已被重建的旧句柄不能使用
+    if (board_audio_rx_acquire() != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_audio_rx_running || rx_handle != s_audio_rx) {
+        board_audio_rx_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = i2s_channel_enable(rx_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_AUDIO, "启用I2S通道失败: %s", esp_err_to_name(ret));
+        board_audio_rx_release();
+        return ret;
+    }
+    s_audio_rx_running = true;
+    s_capture_start_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+/**
+ * @brief 停止流式录音
+ */
+void board_audio_capture_end(i2s_chan_handle_t rx_handle)
+{
+    if (s_audio_rx_running && rx_handle != NULL) {
+        i2s_channel_disable(rx_handle);
+        s_audio_rx_running = false;
+        board_audio_rx_telemetry_end(s_capture_start_us);
+    }
+    board_audio_rx_release();
+}
+
+/**
+ * @brief DMA 发送完成回调 (中断上下文), 统计 DMA 周期实际间隔
+ */
+static bool IRAM_ATTR board_audio_on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    int idx = s_dma_tel_idx;
+    if (s_tx_streaming && idx >= 0) {
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL_ISR(&s_dma_tel_lock);
+        if (s_tx_last_sent_us != 0) {
+            s_dma_tel[idx].tx_period_sum_us += now - s_tx_last_sent_us;
+            s_dma_tel[idx].tx_period_count++;
+        }
+        s_tx_last_sent_us = now;
+        portEXIT_CRITICAL_ISR(&s_dma_tel_lock);
+    }
+    return false;
+}
+
+/**
+ * @brief 发送队列溢出回调 (中断上下文): 应用未及时写入, DMA 重复发送旧缓冲区 (auto_clear 时为静音)
+ */
+static bool IRAM_ATTR board_audio_on_send_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    int idx = s_dma_tel_idx;
+    if (s_tx_streaming && idx >= 0) {
+        portENTER_CRITICAL_ISR(&s_dma_tel_lock);
+        s_dma_tel[idx].tx_underflows++;
+        portEXIT_CRITICAL_ISR(&s_dma_tel_lock);
+    }
+    return false;
+}
+
+/**
+ * @brief 接收队列溢出回调 (中断上下文): 应用未及时读取, 最旧的缓冲区被覆盖
+ */
+static bool IRAM_ATTR board_audio_on_recv_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    // 零拷贝录音不读取驱动队列, 队列溢出是正常现象, 丢失的周期另行统计
+    int idx = s_dma_tel_idx;
+    if (s_audio_rx_running && !s_capture_active && idx >= 0) {
+        portENTER_CRITICAL_ISR(&s_dma_tel_lock);
+        s_dma_tel[idx].rx_overflows++;
+        portEXIT_CRITICAL_ISR(&s_dma_tel_lock);
+    }
+    return false;
+}
+
+/**
+ * @brief 录音结束时累计当前档位的录音时长
+ */
+static void board_audio_rx_telemetry_end(int64_t start_us)
+{
+    int idx = s_dma_tel_idx;
+    if (idx >= 0) {
+        portENTER_CRITICAL(&s_dma_tel_lock);
+        s_dma_tel[idx].rx_us += esp_timer_get_time() - start_us;
+        portEXIT_CRITICAL(&s_dma_tel_lock);
+    }
+}
+
+/**
+ * @brief 切换 I2S DMA 时延档位
+ */
+esp_err_t board_audio_set_dma_profile(board_audio_dma_profile_t profile, i2s_chan_handle_t *tx_handle,
+                                      i2s_chan_handle_t *rx_handle)
+{
+    if (profile >= BOARD_AUDIO_DMA_PROFILE_MAX || tx_handle == NULL || rx_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_dma_tel_idx == (int)profile && *tx_handle != NULL && *rx_handle != NULL) {
+        return ESP_OK;
+    }
+    
+    const board_dma_profile_cfg_t *cfg = &s_dma_profiles[profile];
+    esp_err_t ret = board_audio_reinit_channels(tx_handle, rx_handle, cfg->desc_num, cfg->frame_num);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_AUDIO, "切换DMA档位 %s 失败: %s", cfg->name, esp_err_to_name(ret));
+        return ret;
+    }
+    s_dma_profile = profile;
+    s_dma_tel_idx = profile;
+    ESP_LOGI(TAG_AUDIO, "DMA档位: %s, 缓冲时延 %u us", cfg->name,
+             (unsigned int)((uint64_t)cfg->desc_num * cfg->frame_num * 1000000 / s_audio_sample_rate));
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取当前 DMA 档位
+ */
+board_audio_dma_profile_t board_audio_get_dma_profile(void)
+{
+    return s_dma_profile;
+}
+
+/**
+ * @brief 根据名称查找 DMA 档位
+ */
+board_audio_dma_profile_t board_audio_dma_profile_from_name(const char *name)
+{
+    for (int i = 0; name != NULL && i < BOARD_AUDIO_DMA_PROFILE_MAX; i++) {
+        if (strcmp(s_dma_profiles[i].name, name) == 0) {
+            return (board_audio_dma_profile_t)i;
+        }
+    }
+    return BOARD_AUDIO_DMA_PROFILE_MAX;
+}
+
+/**
+ * @brief 获取 DMA 档位遥测数据
+ */
+esp_err_t board_audio_get_dma_stats(board_audio_dma_profile_t profile, board_audio_dma_stats_t *stats)
+{
+    if (profile >= BOARD_AUDIO_DMA_PROFILE_MAX || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const board_dma_profile_cfg_t *cfg = &s_dma_profiles[profile];
+    portENTER_CRITICAL(&s_dma_tel_lock);
+    board_dma_telemetry_t tel = s_dma_tel[profile];
+    portEXIT_CRITICAL(&s_dma_tel_lock);
+    
+    stats->name = cfg->name;
+    stats->desc_num = cfg->desc_num;
+    stats->frame_num = cfg->frame_num;
+    stats->buffer_latency_us = (uint32_t)((uint64_t)cfg->desc_num * cfg->frame_num * 1000000 / s_audio_sample_rate);
+    stats->measured_latency_us = tel.tx_period_count ?
+                                 (uint32_t)(tel.tx_period_sum_us * cfg->desc_num / tel.tx_period_count) : 0;
+    stats->tx_underflows = tel.tx_underflows;
+    stats->rx_overflows = tel.rx_overflows;
+    stats->tx_ms = (uint32_t)(tel.tx_us / 1000);
+    stats->rx_ms = (uint32_t)(tel.rx_us / 1000);
+    return ESP_OK;
+}
+
+/* ES7210 时钟分频系数 (取自 es7210 组件系数表, 仅包含支持切换的采样率) */
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t osr;            // REG07
+    uint8_t mainclk;        // REG02: adc_div | doubler << 6 | dll << 7
+    uint8_t lrck_h;         // REG04
+    uint8_t lrck_l;         // REG05
+} board_es7210_coeff_t;
+
+static const board_es7210_coeff_t s_es7210_coeffs[] = {
+    { 8000,  0x20, 0x81, 0x02, 0x00 },     // MCLK 4.096MHz (512 倍)
+    { 16000, 0x20, 0xC1, 0x01, 0x00 },     // MCLK 4.096MHz
+    { 44100, 0x20, 0xC1, 0x01, 0x00 },     // MCLK 11.2896MHz
+    { 48000, 0x20, 0xC1, 0x01, 0x00 },     // MCLK 12.288MHz
+};
+
+/**
+ * @brief 写 ES7210 时钟分频寄存器
+ * @details es7210 组件只在 es7210_config_codec() 中设置采样率, 该函数会软复位芯片并重新上电麦克风,
+ *          运行时切换只需重写这四个寄存器
+ */
+static esp_err_t board_es7210_set_clock(const board_es7210_coeff_t *coeff)
+{
+    const uint8_t regs[][2] = {
+        { 0x07, coeff->osr },
+        { 0x02, coeff->mainclk },
+        { 0x04, coeff->lrck_h },
+        { 0x05, coeff->lrck_l },
+    };
+    for (int i = 0; i < sizeof(regs) / sizeof(regs[0]); i++) {
+        esp_err_t ret = i2c_master_write_to_device(BOARD_I2C_NUM, BOARD_ES7210_I2C_ADDR, regs[i], 2,
+                                                   pdMS_TO_TICKS(BOARD_I2C_TIMEOUT_MS));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
     return ESP_OK;
 }
 
 /**
- * @brief 录制音频数据
+ * @brief 查找 ES7210 时钟分频系数
  */
-esp_err_t board_audio_record(i2s_chan_handle_t rx_handle, uint8_t *buffer, 
-                            size_t buffer_size, size_t *bytes_read, uint32_t timeout_ms)
+static const board_es7210_coeff_t *board_es7210_find_coeff(uint32_t sample_rate)
 {
-    if (!rx_handle || !buffer || !bytes_read) {
-        ESP_LOGE(TAG_AUDIO, "无效参数");
-        return ESP_ERR_INVALID_ARG;
+    for (int i = 0; i < sizeof(s_es7210_coeffs) / sizeof(s_es7210_coeffs[0]); i++) {
+        if (s_es7210_coeffs[i].sample_rate == sample_rate) {
+            return &s_es7210_coeffs[i];
+        }
     }
+    return NULL;
+}
+
+/**
+ * @brief 重新配置 I2S 时钟和编解码器时钟分频 (通道保持已初始化状态, DMA 缓冲区不重建)
+ */
+static esp_err_t board_audio_apply_clock(uint32_t sample_rate)
+{
+    const board_es7210_coeff_t *coeff = board_es7210_find_coeff(sample_rate);
+    uint32_t mclk_multiple = BOARD_AUDIO_MCLK_MULTIPLE_FOR(sample_rate);
+    uint32_t mclk_freq_hz = sample_rate * mclk_multiple;
+    esp_err_t ret = ESP_OK;
     
-    esp_err_t ret;
-    size_t bytes_read_once = 0;
-    *bytes_read = 0;  // 初始化已读取字节数
-    
-    // 启用I2S通道
-    ESP_LOGI(TAG_AUDIO, "启动录音...");
-    ret = i2s_channel_enable(rx_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG_AUDIO, "启用I2S通道失败: %s", esp_err_to_name(ret));
-        return ret;
+    if (s_audio_tx != NULL) {
+        i2s_std_clk_config_t clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate);
+        clk_cfg.mclk_multiple = mclk_multiple;
+        ret = i2s_channel_reconfig_std_clock(s_audio_tx, &clk_cfg);
     }
-    
-    // 等待I2S通道稳定
-    vTaskDelay(pdMS_TO_TICKS(50));
-    
-    // 开始录音
-    ESP_LOGI(TAG_AUDIO, "开始录制音频，总缓冲区大小: %u 字节，请求时长: %u 毫秒", 
-              (unsigned int)buffer_size, (unsigned int)timeout_ms);
-    uint32_t start_time = esp_log_timestamp();
-    uint32_t elapsed_time = 0;
-    uint32_t last_progress_time = 0;
-    
-    // 计算每秒的数据量（用于估计录音长度）
-    // 16位立体声 @ 44.1kHz = 44100 * 2(字节) * 2(通道) = 176400 字节/秒
-    size_t bytes_per_second = BOARD_AUDIO_SAMPLE_RATE * 2 * 2; // 采样率 * 16位(2字节) * 通道数
-    float max_recording_seconds = (float)buffer_size / bytes_per_second;
-    ESP_LOGI(TAG_AUDIO, "当前缓冲区最多可录制约 %.2f 秒音频", max_recording_seconds);
-    
-    // 使用BOARD_AUDIO_RECORD_CHUNK_SIZE控制每次读取的数据量
-    size_t chunk_size = BOARD_AUDIO_RECORD_CHUNK_SIZE;
-    if (chunk_size > buffer_size) {
-        chunk_size = buffer_size;
+    if (ret == ESP_OK && s_audio_rx != NULL) {
+        i2s_tdm_clk_config_t clk_cfg = {
+            .clk_src = I2S_CLK_SRC_DEFAULT,
+            .sample_rate_hz = sample_rate,
+            .mclk_multiple = mclk_multiple,
+        };
+        ret = i2s_channel_reconfig_tdm_clock(s_audio_rx, &clk_cfg);
     }
     
-    // 录音循环，直到达到超时时间或缓冲区已满
-    while (elapsed_time < timeout_ms && *bytes_read < buffer_size) {
-        // 计算剩余可用缓冲区
-        size_t remaining_buffer = buffer_size - *bytes_read;
-        // 确定本次读取的大小
-        size_t read_size = (remaining_buffer < chunk_size) ? remaining_buffer : chunk_size;
-        
-        // 判断是否还有足够的可录制时间
-        uint32_t remaining_timeout = timeout_ms - elapsed_time;
-        if (remaining_timeout < 100) {
-            ESP_LOGI(TAG_AUDIO, "录音时间即将到达，完成录音");
-            break;
-        }
-        
-        // 设置单次读取的超时时间
-        uint32_t read_timeout = (remaining_timeout < 500) ? remaining_timeout : 500; // 最多500ms一次
-        
-        // 读取数据
-        ret = i2s_channel_read(rx_handle, buffer + *bytes_read, read_size, &bytes_read_once, 
-                              pdMS_TO_TICKS(read_timeout));
-        
-        if (ret == ESP_ERR_TIMEOUT) {
-            // 读取超时，但仍可继续
-            ESP_LOGW(TAG_AUDIO, "读取超时，但将继续录音");
-        } else if (ret != ESP_OK) {
-            // 其他错误，退出
-            ESP_LOGE(TAG_AUDIO, "读取错误: %s", esp_err_to_name(ret));
-            i2s_channel_disable(rx_handle);
-            return ret;
-        }
-        
-        // 更新已读取的总字节数
-        *bytes_read += bytes_read_once;
-        
-        // 更新已经过的时间
-        elapsed_time = esp_log_timestamp() - start_time;
-        
-        // 更新进度信息 - 每200毫秒输出一次进度
-        if (elapsed_time - last_progress_time >= 200) {
-            last_progress_time = elapsed_time;
-            float progress_seconds = (float)*bytes_read / bytes_per_second;
-            float total_seconds = (float)timeout_ms / 1000.0f;
-            float percent = (total_seconds > 0) ? (progress_seconds / total_seconds) * 100.0f : 0.0f;
-            
-            ESP_LOGI(TAG_AUDIO, "录音进度: %.1f%% (%.2f秒/%.2f秒)，已录制 %u 字节", 
-                     percent, progress_seconds, total_seconds, (unsigned int)*bytes_read);
-        }
-        
-        // 如果缓冲区已满，提前退出循环
-        if (*bytes_read >= buffer_size) {
-            ESP_LOGW(TAG_AUDIO, "录音缓冲区已满 (%u 字节)，提前结束录音", (unsigned int)*bytes_read);
-            break;
-        }
+    if (ret == ESP_OK && s_es8311 != NULL) {
+        ret = es8311_sample_frequency_config(s_es8311, mclk_freq_hz, sample_rate);
     }
-    
-    // 禁用I2S通道
-    i2s_channel_disable(rx_handle);
-    
-    // 输出录音完成信息
-    elapsed_time = esp_log_timestamp() - start_time;
-    float recorded_seconds = (float)*bytes_read / bytes_per_second;
-    
-    ESP_LOGI(TAG_AUDIO, "录音完成，共录制 %u 字节 (约 %.2f 秒) 的数据, 耗时 %u 毫秒", 
-            (unsigned int)*bytes_read, recorded_seconds, (unsigned int)elapsed_time);
-    
-    return ESP_OK;
+    if (ret == ESP_OK && s_audio_rx != NULL && coeff != NULL) {
+        ret = board_es7210_set_clock(coeff);
+    }
+    return ret;
 }
 
 /**
- * @brief 通过ES8311播放音频数据
+ * @brief 切换音频时钟域采样率
  */
-esp_err_t board_audio_play(i2s_chan_handle_t tx_handle, const uint8_t *buffer, size_t buffer_size)
+esp_err_t board_audio_set_sample_rate(uint32_t sample_rate)
 {
-    if (!tx_handle || !buffer || buffer_size == 0) {
-        ESP_LOGE(TAG_AUDIO, "无效参数");
-        return ESP_ERR_INVALID_ARG;
+    if (board_es7210_find_coeff(sample_rate) == NULL) {
+        ESP_LOGE(TAG_AUDIO, "不支持的采样率: %u", (unsigned int)sample_rate);
+        return ESP_ERR_NOT_SUPPORTED;
     }
-    
-    esp_err_t ret;
-    size_t bytes_written = 0;
-    
-    // 重置I2S通道状态
-    // i2s_channel_disable(tx_handle); // 移除此行，通道在此函数前不应被启用
-    // vTaskDelay(pdMS_TO_TICKS(10)); // 移除此行
-    
-    // 预加载部分数据
-    size_t preload_size = buffer_size > 1024 ? 1024 : buffer_size;
-    ret = i2s_channel_preload_data(tx_handle, buffer, preload_size, &bytes_written);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG_AUDIO, "预加载数据失败: %s", esp_err_to_name(ret));
-        return ret;
+    if (sample_rate == s_audio_sample_rate) {
+        return ESP_OK;
     }
-    
-    ESP_LOGI(TAG_AUDIO, "预加载了 %u 字节的音频数据", (unsigned int)bytes_written);
-    
-    // 打开功放
-    board_pa_power(true);
-    
-    // 启用发送通道
-    ret = i2s_channel_enable(tx_handle);
+    // 通道启用时无法修改时钟, 数据流中途变速也会产生可闻失真
+    esp_err_t ret = board_audio_playback_acquire();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG_AUDIO, "启用I2S通道失败: %s", esp_err_to_name(ret));
-        board_pa_power(false);
         return ret;
     }
+    if (board_audio_rx_acquire() != ESP_OK) {
+        ESP_LOGW(TAG_AUDIO, "正在录音, 无法切换采样率");
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_audio_tx_running || s_audio_rx_running) {
+        ESP_LOGW(TAG_AUDIO, "正在播放或录音, 无法切换采样率");
+        board_audio_rx_release();
+        board_audio_playback_release();
+        return ESP_ERR_INVALID_STATE;
+    }
     
-    // 播放剩余数据
-    size_t remaining = buffer_size - bytes_written;
-    size_t offset = bytes_written;
+    int64_t start_us = esp_timer_get_time();
     
-    ESP_LOGI(TAG_AUDIO, "开始播放音频...");
-    uint32_t start_time = esp_log_timestamp();
+    // 1. 静音 DAC, 避免 MCLK 变化期间输出爆音 (功放此时已关闭, 双重保护)
+    if (s_es8311 != NULL) {
+        es8311_voice_mute(s_es8311, true);
+    }
     
-    while (remaining > 0) {
-        ret = i2s_channel_write(tx_handle, buffer + offset, remaining, &bytes_written, portMAX_DELAY);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG_AUDIO, "写入I2S通道失败: %s", esp_err_to_name(ret));
-            break;
+    // 2. 重新配置 I2S 时钟, 重写编解码器时钟分频系数
+    ret = board_audio_apply_clock(sample_rate);
+    if (ret != ESP_OK) {
+        // 恢复原采样率的时钟, 保证播放和录音仍可用; s_audio_sample_rate 始终保持原值, 返回原始错误
+        ESP_LOGE(TAG_AUDIO, "切换采样率失败: %s, 恢复 %u Hz", esp_err_to_name(ret), (unsigned int)s_audio_sample_rate);
+        esp_err_t restore = board_audio_apply_clock(s_audio_sample_rate);
+        if (restore != ESP_OK) {
+            ESP_LOGE(TAG_AUDIO, "恢复 %u Hz 失败: %s", (unsigned int)s_audio_sample_rate, esp_err_to_name(restore));
         }
-        
-        if (bytes_written > 0) {
-            remaining -= bytes_written;
-            offset += bytes_written;
-            
-            // 每秒显示进度
-            if (esp_log_timestamp() - start_time >= 1000) {
-                start_time = esp_log_timestamp();
-                ESP_LOGI(TAG_AUDIO, "播放进度: %.1f%%", (float)(buffer_size - remaining) * 100 / buffer_size);
-            }
+    } else {
+        s_audio_sample_rate = sample_rate;
+        // DMA 周期随采样率变化, 实测时延重新统计
+        portENTER_CRITICAL(&s_dma_tel_lock);
+        for (int i = 0; i < BOARD_AUDIO_DMA_PROFILE_MAX; i++) {
+            s_dma_tel[i].tx_period_sum_us = 0;
+            s_dma_tel[i].tx_period_count = 0;
+        }
+        portEXIT_CRITICAL(&s_dma_tel_lock);
+#if CONFIG_AUDIO_DSP_ENABLE
+        // 3. 按新采样率重新计算 DSP 系数 (保留当前参数)
+        if (s_dsp_ready) {
+            audio_dsp_set_sample_rate(sample_rate);
         }
+#endif
     }
     
-    // 等待所有数据播放完毕
-    vTaskDelay(pdMS_TO_TICKS(500));
-    
-    // 禁用I2S通道并关闭功放
-    i2s_channel_disable(tx_handle);
-    board_pa_power(false);
+    // 4. 解除静音 (成功和失败都要解除)
+    if (s_es8311 != NULL) {
+        es8311_voice_mute(s_es8311, false);
+    }
+    board_audio_rx_release();
+    board_audio_playback_release();
+    if (ret != ESP_OK) {
+        return ret;
+    }
     
-    ESP_LOGI(TAG_AUDIO, "音频播放完成");
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    if (elapsed_us > BOARD_AUDIO_RATE_SWITCH_BUDGET_US) {
+        ESP_LOGW(TAG_AUDIO, "采样率切换到 %u Hz 耗时 %lld us, 超出预算", (unsigned int)sample_rate, elapsed_us);
+    } else {
+        ESP_LOGI(TAG_AUDIO, "采样率已切换到 %u Hz (MCLK %u Hz), 耗时 %lld us", (unsigned int)sample_rate,
+                 (unsigned int)(sample_rate * BOARD_AUDIO_MCLK_MULTIPLE_FOR(sample_rate)), elapsed_us);
+    }
     return ESP_OK;
 }
 
+/**
+ * @brief 获取当前音频时钟域采样率
+ */
+uint32_t board_audio_get_sample_rate(void)
+{
+    return s_audio_sample_rate;
+}
+
 /**
  * @brief 卸载音频 I2S 通道
  */
@@ -645,6 +1850,13 @@ void board_audio_i2s_deinit(i2s_chan_handle_t handle)
     // 删除通道
     ESP_LOGI(TAG_AUDIO, "删除 I2S 通道...");
     i2s_del_channel(handle);
+    if (handle == s_audio_tx) {
+        s_audio_tx = NULL;
+        s_audio_tx_running = false;
+    } else if (handle == s_audio_rx) {
+        s_audio_rx = NULL;
+        s_audio_rx_running = false;
+    }
     
     ESP_LOGI(TAG_AUDIO, "I2S 通道资源已释放");
 }
@@ -1640,45 +2852,45 @@ esp_err_t board_websocket_init(esp_websocket_client_handle_t *client_handle_out,
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 解析WebSocket URL
-    char *url = strdup(BOARD_WS_SERVER_URL);
-    if (url == NULL) {
+    // 从主服务器开始, 之后由调用方按服务器健康状况切换 (esp_websocket_client_set_uri)
+    char *full_url = malloc(BOARD_WS_ENDPOINT_URL_MAX);
+    if (full_url == NULL) {
         ESP_LOGE(TAG, "内存分配失败");
         return ESP_ERR_NO_MEM;
     }
-    
-    // 修改WebSocket URL，确保包含客户端ID
-    char *full_url = NULL;
-    // 检查URL是否以"/"结尾
-    if (url[strlen(url) - 1] == '/') {
-        // URL已经以"/"结尾，直接添加客户端ID
-        full_url = malloc(strlen(url) + strlen(BOARD_WS_DEVICE_CLIENT_ID) + 1);
-        if (full_url == NULL) {
-            ESP_LOGE(TAG, "内存分配失败");
-            free(url);
-            return ESP_ERR_NO_MEM;
-        }
-        sprintf(full_url, "%s%s", url, BOARD_WS_DEVICE_CLIENT_ID);
-    } else {
-        // URL不以"/"结尾，添加"/"和客户端ID
-        full_url = malloc(strlen(url) + strlen(BOARD_WS_DEVICE_CLIENT_ID) + 2);
-        if (full_url == NULL) {
-            ESP_LOGE(TAG, "内存分配失败");
-            free(url);
-            return ESP_ERR_NO_MEM;
-        }
-        sprintf(full_url, "%s/%s", url, BOARD_WS_DEVICE_CLIENT_ID);
+    esp_err_t ret = board_websocket_endpoint_url(0, full_url, BOARD_WS_ENDPOINT_URL_MAX);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "WebSocket服务器URL无效: %s", esp_err_to_name(ret));
+        free(full_url);
+        return ret;
     }
-    free(url);
+    
+    // wss: TLS 传输连接缓存的地址, SNI 和证书校验仍用域名; 重连还靠缓存的 TLS 会话省去完整握手
+    bool tls = strncmp(full_url, "wss://", 6) == 0;
     
     // 配置WebSocket客户端
     esp_websocket_client_config_t ws_config = {
         .uri = full_url,
         .disable_auto_reconnect = false,
-        .reconnect_timeout_ms = BOARD_WS_RECONNECT_INTERVAL_MS,
+        .reconnect_timeout_ms = BOARD_WS_BACKOFF_MIN_MS,   // 之后每次由 DISCONNECTED 事件按退避设置
         .network_timeout_ms = BOARD_WS_NETWORK_TIMEOUT_MS,
         .pingpong_timeout_sec = BOARD_WS_PING_INTERVAL_SEC,
-        .transport = WEBSOCKET_TRANSPORT_OVER_TCP,
+        .ping_interval_sec = BOARD_WS_PING_MIN_SEC,
+        .keep_alive_enable = true,
+        .keep_alive_idle = BOARD_WS_KEEPALIVE_IDLE_SEC,
+        .keep_alive_interval = BOARD_WS_KEEPALIVE_INTVL_SEC,
+        .keep_alive_count = BOARD_WS_KEEPALIVE_COUNT,
+        .dns_cache_ttl_ms = BOARD_WS_DNS_CACHE_TTL_MS,
+        .transport = tls ? WEBSOCKET_TRANSPORT_OVER_SSL : WEBSOCKET_TRANSPORT_OVER_TCP,
+#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        .crt_bundle_attach = tls ? esp_crt_bundle_attach : NULL,
+#endif
+        .tls_session_cache_size = BOARD_WS_ENDPOINT_MAX,
+        .tls_session_lifetime_ms = BOARD_WS_TLS_SESSION_LIFETIME_MS,
+        .tx_queue_control_size = BOARD_WS_TX_CONTROL_BYTES,
+        .tx_queue_bulk_size = BOARD_WS_TX_BULK_BYTES,
+        .tx_queue_depth = BOARD_WS_TX_QUEUE_DEPTH,
+        .rx_message_max = BOARD_WS_RX_MESSAGE_MAX,
     };
     
     // 创建WebSocket客户端
@@ -1762,6 +2974,194 @@ esp_err_t board_websocket_destroy(esp_websocket_client_handle_t client)
     return ESP_OK;
 }
 
+
+/* 备用服务器是否与主服务器使用相同的协议: 传输层按主服务器的协议建立, 切换服务器时不会改变 */
+static bool board_websocket_same_scheme(const char *url, size_t len)
+{
+    const char *primary_end = strstr(BOARD_WS_SERVER_URL, "://");
+    const char *end = memchr(url, ':', len);
+    if (primary_end == NULL || end == NULL || end + 3 > url + len || strncmp(end, "://", 3) != 0) {
+        return false;
+    }
+    size_t scheme_len = end - url;
+    return scheme_len == (size_t)(primary_end - BOARD_WS_SERVER_URL) &&
+           strncasecmp(url, BOARD_WS_SERVER_URL, scheme_len) == 0;
+}
+
+/* 第 index 个服务器的基础 URL (不含客户端 ID): 0 为主服务器, 之后依次为逗号分隔的备用服务器.
+ * 协议与主服务器不同的备用服务器跳过, 不占用序号 */
+static const char *board_websocket_endpoint_base(int index, size_t *len)
+{
+    static bool s_scheme_warned = false;
+
+    if (index == 0) {
+        *len = strlen(BOARD_WS_SERVER_URL);
+        return *len ? BOARD_WS_SERVER_URL : NULL;
+    }
+    const char *p = BOARD_WS_FALLBACK_URLS;
+    int n = 1;
+    while (*p) {
+        while (*p == ',' || *p == ' ') {
+            p++;
+        }
+        const char *end = p;
+        while (*end && *end != ',') {
+            end++;
+        }
+        size_t item = end - p;
+        while (item > 0 && p[item - 1] == ' ') {
+            item--;
+        }
+        if (item > 0 && !board_websocket_same_scheme(p, item)) {
+            if (!s_scheme_warned) {
+                s_scheme_warned = true;
+                ESP_LOGW(TAG, "备用服务器 %.*s 的协议与主服务器不同, 已跳过", (int)item, p);
+            }
+        } else if (item > 0) {
+            if (n == index) {
+                *len = item;
+                return p;
+            }
+            n++;
+        }
+        p = end;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 获取配置的 WebSocket 服务器数
+ */
+int board_websocket_endpoint_count(void)
+{
+    size_t len;
+    int count = 1;
+    while (count < BOARD_WS_ENDPOINT_MAX && board_websocket_endpoint_base(count, &len) != NULL) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief 获取 WebSocket 服务器的完整 URL
+ */
+esp_err_t board_websocket_endpoint_url(int index, char *buf, size_t len)
+{
+    size_t base_len;
+    const char *base = index >= 0 && index < BOARD_WS_ENDPOINT_MAX ? board_websocket_endpoint_base(index, &base_len) : NULL;
+    if (base == NULL || buf == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 确保 URL 以客户端 ID 结尾
+    const char *sep = base[base_len - 1] == '/' ? "" : "/";
+    int n = snprintf(buf, len, "%.*s%s%s", (int)base_len, base, sep, BOARD_WS_DEVICE_CLIENT_ID);
+    return n < 0 || (size_t)n >= len ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+/**
+ * @brief 获取 WebSocket 服务器的主机名和端口
+ */
+esp_err_t board_websocket_endpoint_addr(int index, char *host, size_t len, uint16_t *port)
+{
+    size_t base_len;
+    const char *base = index >= 0 && index < BOARD_WS_ENDPOINT_MAX ? board_websocket_endpoint_base(index, &base_len) : NULL;
+    if (base == NULL || host == NULL || port == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const char *end = base + base_len;
+    const char *p = strstr(base, "://");
+    if (p == NULL || p >= end) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *port = strncmp(base, "wss", 3) == 0 ? 443 : 80;
+    p += 3;
+
+    // host[:port][/path], IPv6 地址写在方括号中
+    const char *host_end;
+    if (*p == '[') {
+        p++;
+        host_end = memchr(p, ']', end - p);
+        if (host_end == NULL) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    } else {
+        host_end = p;
+        while (host_end < end && *host_end != ':' && *host_end != '/') {
+            host_end++;
+        }
+    }
+    size_t host_len = host_end - p;
+    if (host_len == 0 || host_len >= len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(host, p, host_len);
+    host[host_len] = '\0';
+
+    const char *q = host_end < end && *host_end == ']' ? host_end + 1 : host_end;
+    if (q < end && *q == ':') {
+        unsigned long value = strtoul(q + 1, NULL, 10);
+        if (value == 0 || value > 65535) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        *port = (uint16_t)value;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 探测服务器是否可连接
+ */
+esp_err_t board_tcp_probe(const char *host, uint16_t port, uint32_t timeout_ms, uint32_t *connect_ms)
+{
+    if (host == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    char port_str[6];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+    struct addrinfo hints = { .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port_str, &hints, &res) != 0 || res == NULL) {
+        ESP_LOGD(TAG, "探测 %s 域名解析失败", host);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = ESP_FAIL;
+    int sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (sock < 0) {
+        freeaddrinfo(res);
+        return ESP_FAIL;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    // 非阻塞连接, 用 select 等待完成, 耗时即一次 SYN/SYN-ACK 往返
+    int64_t start = esp_timer_get_time();
+    if (connect(sock, res->ai_addr, res->ai_addrlen) == 0) {
+        ret = ESP_OK;
+    } else if (errno == EINPROGRESS) {
+        fd_set wfds;
+        FD_ZERO(&wfds);
+        FD_SET(sock, &wfds);
+        struct timeval tv = {
+            .tv_sec = timeout_ms / 1000,
+            .tv_usec = (timeout_ms % 1000) * 1000,
+        };
+        int n = select(sock + 1, NULL, &wfds, NULL, &tv);
+        if (n == 0) {
+            ret = ESP_ERR_TIMEOUT;
+        } else if (n > 0) {
+            int err = 0;
+            socklen_t err_len = sizeof(err);
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &err_len);
+            ret = err == 0 ? ESP_OK : ESP_FAIL;
+        }
+    }
+    if (ret == ESP_OK && connect_ms != NULL) {
+        *connect_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    }
+    close(sock);
+    freeaddrinfo(res);
+    return ret;
+}
 /**************************** 恢复出厂设置相关函数 ****************************/
 
 // 恢复出厂设置按键定时器处理
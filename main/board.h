@@ -62,6 +62,7 @@ extern EventGroupHandle_t board_event_group; // 全局事件组句柄
 #define BOARD_I2C_SDA_IO          1       // I2C 数据引脚
 #define BOARD_I2C_SCL_IO          2       // I2C 时钟引脚
 #define BOARD_I2C_FREQ_HZ         100000  // I2C 时钟频率 (100kHz)
+#define BOARD_I2C_TIMEOUT_MS      100     // I2C 单次传输超时 (毫秒)
 
 /* 恢复出厂设置按键配置 */
 #define BOARD_FACTORY_RESET_GPIO  0     // BOOT 按键 GPIO
@@ -72,12 +73,17 @@ extern EventGroupHandle_t board_event_group; // 全局事件组句柄
 
 /**************************** 音频系统配置 ****************************/
 /* 音频公共配置 */
-#define BOARD_AUDIO_SAMPLE_RATE   CONFIG_AUDIO_SAMPLE_RATE   // 音频采样率 (Hz)
+#define BOARD_AUDIO_SAMPLE_RATE   CONFIG_AUDIO_SAMPLE_RATE   // 启动时的音频采样率 (Hz), 运行时见 board_audio_set_sample_rate()
 #define BOARD_AUDIO_BIT_WIDTH     CONFIG_AUDIO_BIT_WIDTH     // 音频位宽
 #define BOARD_AUDIO_CHANNELS      CONFIG_AUDIO_CHANNELS      // 音频通道数
 #define BOARD_AUDIO_BUFFER_SIZE   CONFIG_AUDIO_BUFFER_SIZE   // 音频缓冲区大小 (字节)
 #define BOARD_AUDIO_MCLK_MULTIPLE       256     // MCLK = Sample Rate * MCLK Multiple (修改为与play_test一致)
 #define BOARD_AUDIO_MCLK_FREQ_HZ        (BOARD_AUDIO_SAMPLE_RATE * BOARD_AUDIO_MCLK_MULTIPLE) // MCLK 频率 (注意: 播放时需根据16kHz重新计算)
+#define BOARD_AUDIO_PLAYBACK_CHANNELS   2       // 播放 I2S 通道数 (标准模式立体声, 提示音资源按此格式生成)
+#define BOARD_AUDIO_PLAYBACK_BIT_WIDTH  16      // 播放 I2S 位宽
+#define BOARD_AUDIO_RATE_SWITCH_BUDGET_US 20000 // 运行时切换采样率的耗时上限, 超出时告警
+/* 运行时可切换的采样率. 8kHz 时 ES7210 没有 256 倍 MCLK 的系数, 使用 512 倍 (4.096MHz) */
+#define BOARD_AUDIO_MCLK_MULTIPLE_FOR(rate) (((rate) == 8000) ? 512 : BOARD_AUDIO_MCLK_MULTIPLE)
 
 /* ES8311 (播放) 配置 */
 #define BOARD_ES8311_I2C_ADDR         ES8311_ADDRRES_0  // ES8311 I2C 地址
@@ -105,6 +111,58 @@ extern EventGroupHandle_t board_event_group; // 全局事件组句柄
 
 /* 音频缓冲区配置 */
 #define BOARD_AUDIO_RECORD_CHUNK_SIZE (1024 * 2) // 每次录音读取的数据块大小
+#define BOARD_AUDIO_PLAY_CHUNK_SIZE   (1024 * 8) // 每次播放写入的数据块大小
+#define BOARD_AUDIO_POOL_BLOCK_SIZE   (64 * 1024) // 缓冲区池 PSRAM 块大小 (录音, 流播放), 总量见 CONFIG_AUDIO_POOL_PSRAM_KB
+#define BOARD_AUDIO_POOL_DMA_BLOCK_SIZE BOARD_AUDIO_PLAY_CHUNK_SIZE // 缓冲区池内部 RAM 暂存块大小
+#define BOARD_AUDIO_POOL_DMA_BLOCKS   4       // 内部 RAM 暂存块数
+#define BOARD_AUDIO_RECORD_SLOTS      2       // 录音 TDM 时隙数 (16 位, 每帧 4 字节)
+#define BOARD_AUDIO_RECORDER_DMA_PROFILE BOARD_AUDIO_DMA_PROFILE_ROBUST // 闪存录音期间的 DMA 档位, 缓冲时延需覆盖一次扇区擦除
+
+/* I2S DMA 时延档位 (缓冲时延 = 描述符数 * 帧数 / 采样率, 44.1kHz 下约 6.5ms / 32.7ms / 87.1ms) */
+#define BOARD_AUDIO_DMA_LOW_LATENCY_DESC_NUM   3    // 低时延: 交互场景, 对 CPU 抢占敏感
+#define BOARD_AUDIO_DMA_LOW_LATENCY_FRAME_NUM  96
+#define BOARD_AUDIO_DMA_BALANCED_DESC_NUM      6    // 均衡: 与 I2S_CHANNEL_DEFAULT_CONFIG 相同
+#define BOARD_AUDIO_DMA_BALANCED_FRAME_NUM     240
+#define BOARD_AUDIO_DMA_ROBUST_DESC_NUM        8    // 稳健: WiFi 繁忙时抗饥饿
+#define BOARD_AUDIO_DMA_ROBUST_FRAME_NUM       480  // 单个描述符不超过 4092 字节, 且为 PSRAM DMA 对齐的整数倍
+#if CONFIG_AUDIO_DMA_PROFILE_LOW_LATENCY
+#define BOARD_AUDIO_DMA_PROFILE_DEFAULT   BOARD_AUDIO_DMA_PROFILE_LOW_LATENCY
+#define BOARD_AUDIO_DMA_DEFAULT_DESC_NUM  BOARD_AUDIO_DMA_LOW_LATENCY_DESC_NUM
+#define BOARD_AUDIO_DMA_DEFAULT_FRAME_NUM BOARD_AUDIO_DMA_LOW_LATENCY_FRAME_NUM
+#elif CONFIG_AUDIO_DMA_PROFILE_ROBUST
+#define BOARD_AUDIO_DMA_PROFILE_DEFAULT   BOARD_AUDIO_DMA_PROFILE_ROBUST
+#define BOARD_AUDIO_DMA_DEFAULT_DESC_NUM  BOARD_AUDIO_DMA_ROBUST_DESC_NUM
+#define BOARD_AUDIO_DMA_DEFAULT_FRAME_NUM BOARD_AUDIO_DMA_ROBUST_FRAME_NUM
+#else
+#define BOARD_AUDIO_DMA_PROFILE_DEFAULT   BOARD_AUDIO_DMA_PROFILE_BALANCED // 启动时的档位
+#define BOARD_AUDIO_DMA_DEFAULT_DESC_NUM  BOARD_AUDIO_DMA_BALANCED_DESC_NUM
+#define BOARD_AUDIO_DMA_DEFAULT_FRAME_NUM BOARD_AUDIO_DMA_BALANCED_FRAME_NUM
+#endif
+
+/* GDMA 零拷贝 (CONFIG_AUDIO_ZERO_COPY): PSRAM 与 I2S DMA 缓冲区之间由异步内存拷贝搬运, CPU 不参与 */
+#define BOARD_AUDIO_PSRAM_DMA_ALIGN   64      // PSRAM 侧地址和长度对齐 (不小于数据缓存行), 录音缓冲区按此对齐分配
+#define BOARD_AUDIO_DMA_COPY_BACKLOG  16      // 异步拷贝最多排队的事务数
+#define BOARD_AUDIO_PREFETCH_BYTES    (BOARD_AUDIO_DSP_BLOCK_FRAMES * BOARD_AUDIO_PLAYBACK_CHANNELS * BOARD_AUDIO_PLAYBACK_BIT_WIDTH / 8) // 播放预取块大小 (内部 RAM 双缓冲, 与 DSP 处理块相同)
+
+/* 播放 DSP 默认参数 (CONFIG_AUDIO_DSP_ENABLE, 可通过 set_eq 事件在运行时修改) */
+#define BOARD_AUDIO_DSP_BLOCK_FRAMES  256     // 每次处理的帧数 (内部 RAM 暂存缓冲区)
+#define BOARD_AUDIO_EQ_HPF_HZ         150.0f  // 高通截止频率, 滤除喇叭谐振以下易引起振动的低频
+#define BOARD_AUDIO_COMP_THRESHOLD_DB -18.0f  // 压缩器阈值 (dBFS)
+#define BOARD_AUDIO_COMP_RATIO        3.0f    // 压缩比
+#define BOARD_AUDIO_COMP_KNEE_DB      6.0f    // 软拐点宽度
+#define BOARD_AUDIO_COMP_ATTACK_MS    5.0f    // 压缩器启动时间
+#define BOARD_AUDIO_COMP_RELEASE_MS   80.0f   // 压缩器释放时间
+#define BOARD_AUDIO_COMP_MAKEUP_DB    6.0f    // 补偿增益 (提高响度, 峰值由限幅器控制)
+#define BOARD_AUDIO_LIMIT_CEILING_DB  -1.0f   // 限幅器输出上限 (dBFS), 防止功放削波
+#define BOARD_AUDIO_LIMIT_RELEASE_MS  50.0f   // 限幅器释放时间
+
+/* 监听 (侧音) 通路配置: 麦克风直通喇叭, 用于对讲 */
+#define BOARD_AUDIO_MONITOR_DMA_DESC_NUM  3   // 监听时 DMA 描述符数
+#define BOARD_AUDIO_MONITOR_DMA_FRAME_NUM 32  // 监听时每个 DMA 周期的帧数 (44.1kHz 约 0.73ms)
+#define BOARD_AUDIO_MONITOR_CORE      1       // 采集/回放任务绑定的核心 (WiFi 协议栈默认在核心 0)
+#define BOARD_AUDIO_MONITOR_PRIORITY  (configMAX_PRIORITIES - 3) // 采集任务优先级, 回放任务低一级
+#define BOARD_AUDIO_MONITOR_GAIN_DB   -12.0f  // 默认侧音增益, 过高会引起啸叫
+#define BOARD_AUDIO_MONITOR_LATENCY_BUDGET_US 5000 // 端到端时延目标
 
 /**************************** WiFi 配置 ****************************/
 /* WiFi STA 模式配置 */
@@ -128,10 +186,39 @@ extern EventGroupHandle_t board_event_group; // 全局事件组句柄
 /**************************** WebSocket 配置 ****************************/
 #define BOARD_WS_SERVER_URL         CONFIG_WS_SERVER_URL         // WebSocket 服务器URL
 #define BOARD_WS_DEVICE_CLIENT_ID   CONFIG_WS_DEVICE_CLIENT_ID   // 设备 WebSocket 客户端 ID
-#define BOARD_WS_RECONNECT_INTERVAL_MS CONFIG_WS_RECONNECT_INTERVAL_MS // WebSocket 重连间隔
-#define BOARD_WS_RECONNECT_TIMEOUT_MS 10000          // WebSocket 重连超时时间 (毫秒)
+#define BOARD_WS_FALLBACK_URLS      CONFIG_WS_SERVER_FALLBACK_URLS // WebSocket 备用服务器 URL (逗号分隔)
+#define BOARD_WS_ENDPOINT_MAX       4                // WebSocket 服务器数上限 (主服务器 + 备用服务器)
+#define BOARD_WS_ENDPOINT_URL_MAX   160              // WebSocket 服务器完整 URL (含客户端 ID) 的最大长度
+#define BOARD_WS_FAILOVER_DELAY_MS  100              // 切换到备用服务器前的等待上限 (毫秒), 实际在 1 到上限之间随机
+#define BOARD_WS_PROBE_INTERVAL_MS  30000            // 连接期间后台探测所有服务器 (含当前服务器) 的间隔 (毫秒)
+#define BOARD_WS_PROBE_TIMEOUT_MS   2000             // 探测单个服务器 (TCP 连接) 的超时 (毫秒)
+#define BOARD_WS_PROBE_TASK_STACK   4096             // 服务器探测任务栈大小
+#define BOARD_WS_PROBE_TASK_PRIO    3                // 服务器探测任务优先级 (低于 WebSocket 任务)
+#define BOARD_WS_UNKNOWN_SCORE_MS   1000             // 从未测量过的服务器的分数 (毫秒)
+#define BOARD_WS_FAILURE_PENALTY_MS 2000             // 服务器每次近期失败加的分数 (毫秒)
+#define BOARD_WS_FAILURE_DECAY_MS   60000            // 服务器近期失败次数减半的时间 (毫秒)
+#define BOARD_WS_FAILBACK_MARGIN_MS 50               // 切回更好的服务器要求的最小探测时间差 (毫秒), 另加当前探测时间的 1/8
+#define BOARD_WS_BACKOFF_MIN_MS     1000             // WebSocket 第一次重连的等待上限 (毫秒), 实际在一半到上限之间随机
+#define BOARD_WS_BACKOFF_MAX_MS     CONFIG_WS_RECONNECT_INTERVAL_MS // WebSocket 重连等待上限的最大值 (毫秒)
+#define BOARD_WS_STABLE_MS          60000            // WebSocket 连接保持这么久后断开, 退避从头开始 (毫秒)
 #define BOARD_WS_NETWORK_TIMEOUT_MS 10000          // WebSocket 网络超时时间 (毫秒)
-#define BOARD_WS_PING_INTERVAL_SEC  10               // WebSocket PING 发送间隔 (秒)
+#define BOARD_WS_PING_INTERVAL_SEC  10               // WebSocket PING 发出后等待 PONG 的时间 (秒)
+#define BOARD_WS_PING_MIN_SEC       10               // WebSocket 初始 (最短) PING 间隔 (秒)
+#define BOARD_WS_PING_MAX_SEC       120              // WebSocket 随 NAT 超时延长的最长 PING 间隔 (秒)
+#define BOARD_WS_PING_PROBE_MS      600000           // WebSocket PING 间隔稳定这么久后尝试延长 (毫秒)
+#define BOARD_WS_KEEPALIVE_IDLE_SEC 150              // TCP keepalive 空闲时间 (秒), 长于最长 PING 间隔, 只在 PING 停止时探测
+#define BOARD_WS_KEEPALIVE_INTVL_SEC 10              // TCP keepalive 探测间隔 (秒)
+#define BOARD_WS_KEEPALIVE_COUNT    3                // TCP keepalive 探测次数
+#define BOARD_WS_DNS_CACHE_TTL_MS   300000           // WebSocket 服务器域名解析结果缓存时间 (毫秒), IP 地址的 URL 不解析
+#define BOARD_WS_TLS_SESSION_LIFETIME_MS 3600000     // wss 重连时复用 TLS 会话 (session ticket/ID) 的最长时间 (毫秒), 每个服务器缓存一个
+#define BOARD_WS_STATS_LOG_MS       60000            // 主循环输出 WebSocket 连接指标的间隔 (毫秒)
+#define BOARD_WS_TX_CONTROL_BYTES   4096             // WebSocket 发送队列控制通道 (复制的回复消息) 字节数
+#define BOARD_WS_TX_BULK_BYTES      1024             // WebSocket 发送队列批量通道复制区 (上传分块按引用排队, 不占用)
+#define BOARD_WS_TX_QUEUE_DEPTH     16               // WebSocket 发送队列每个通道的最大消息数
+#define BOARD_WS_RX_MESSAGE_MAX     4096             // WebSocket 收到的文本消息重组后的最大长度 (超过的消息丢弃)
+#define BOARD_WS_CMD_BUFFER_BYTES   8192             // 收到的命令消息排队字节数 (WebSocket 任务不执行命令, 满时丢弃)
+#define BOARD_WS_CMD_TASK_STACK     6144             // 命令任务栈大小
+#define BOARD_WS_CMD_TASK_PRIO      5                // 命令任务优先级 (与 WebSocket 任务相同)
 
 /**************************** 函数声明 ****************************/
 
@@ -177,6 +264,66 @@ esp_err_t board_audio_record_init(i2s_chan_handle_t *rx_handle_out);
  */
 esp_err_t board_audio_play(i2s_chan_handle_t tx_handle, const uint8_t *buffer, size_t buffer_size);
 
+/**
+ * @brief 播放一组等长块中的音频数据 (如缓冲区池借出的块链)
+ * @param tx_handle I2S 发送通道句柄 (只检查非空, 占用通道后使用当前发送通道, 见 board_audio_stream_begin())
+ * @param blocks 各块地址
+ * @param block_count 块数
+ * @param block_size 每块大小 (字节)
+ * @param total_size 要播放的数据大小 (字节), 不超过 block_count * block_size
+ * @return esp_err_t ESP_OK 成功, 其他失败
+ */
+esp_err_t board_audio_play_blocks(i2s_chan_handle_t tx_handle, const uint8_t *const *blocks, size_t block_count,
+                                  size_t block_size, size_t total_size);
+
+/**
+ * @brief 占用播放通道
+ * @details 同一时间只有一个任务可以播放、切换采样率或重建通道. board_audio_stream_begin()
+ *          等函数内部会自动占用; 需要先切换采样率再播放的调用者应在切换前占用, 播放结束后释放,
+ *          避免其他任务在两者之间改动时钟. 同一任务可嵌套占用, 每次占用对应一次释放.
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 其他任务正在使用
+ */
+esp_err_t board_audio_playback_acquire(void);
+
+/**
+ * @brief 释放 board_audio_playback_acquire() 的占用 (必须在占用的任务中调用)
+ */
+void board_audio_playback_release(void);
+
+/**
+ * @brief 开始流式播放
+ * @details 预加载首段数据, 打开功放并启用 I2S 发送通道. 之后调用 board_audio_stream_write()
+ *          持续写入数据, 最后调用 board_audio_stream_end() 结束.
+ *          启用播放 DSP 时数据经 EQ/压缩器/限幅器处理后再写入 I2S, 数据大小应为整帧.
+ *          成功时占用播放通道, 直到同一任务调用 board_audio_stream_end().
+ *          调用者的句柄可能在占用前被 board_audio_reinit_channels() 重建而失效, 因此占用后改用当前发送通道,
+ *          stream_write/stream_end 同样如此.
+ * @param tx_handle I2S 发送通道句柄 (只检查非空)
+ * @param preload 预加载数据 (可为 NULL)
+ * @param preload_size 预加载数据大小 (字节)
+ * @param[out] bytes_loaded (可选) 实际预加载的字节数
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 其他播放或全双工通路正在进行, 其他失败
+ */
+esp_err_t board_audio_stream_begin(i2s_chan_handle_t tx_handle, const uint8_t *preload,
+                                   size_t preload_size, size_t *bytes_loaded);
+
+/**
+ * @brief 流式写入播放数据
+ * @param tx_handle I2S 发送通道句柄
+ * @param data 音频数据
+ * @param size 数据大小 (字节)
+ * @param timeout_ms 写入超时 (毫秒), UINT32_MAX 表示一直等待
+ * @return esp_err_t ESP_OK 全部写入, 其他失败
+ */
+esp_err_t board_audio_stream_write(i2s_chan_handle_t tx_handle, const uint8_t *data, size_t size, uint32_t timeout_ms);
+
+/**
+ * @brief 结束流式播放
+ * @details 等待缓冲数据播放完毕, 关闭 I2S 发送通道和功放
+ * @param tx_handle I2S 发送通道句柄
+ */
+void board_audio_stream_end(i2s_chan_handle_t tx_handle);
+
 /**
  * @brief 录制音频数据
  * @param rx_handle I2S 接收通道句柄
@@ -188,6 +335,153 @@ esp_err_t board_audio_play(i2s_chan_handle_t tx_handle, const uint8_t *buffer, s
  */
 esp_err_t board_audio_record(i2s_chan_handle_t rx_handle, uint8_t *buffer, size_t buffer_size, size_t *bytes_read, uint32_t timeout_ms);
 
+/**
+ * @brief 录制音频数据到一组等长的块 (如缓冲区池借出的块链)
+ * @details 数据按块顺序连续写入, 等同于写入总长为 block_count * block_size 的线性缓冲区.
+ *          录音期间占用接收通道, 切换采样率或 DMA 档位返回 ESP_ERR_INVALID_STATE
+ * @param rx_handle I2S 接收通道句柄 (只检查非空, 占用后使用当前接收通道)
+ * @param blocks 各块地址
+ * @param block_count 块数
+ * @param block_size 每块大小 (字节), 多于一块时应为 BOARD_AUDIO_PSRAM_DMA_ALIGN 的整数倍才能使用零拷贝
+ * @param[out] bytes_read 实际录制的数据字节数
+ * @param timeout_ms 录音时长 (毫秒)
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_TIMEOUT 超时, 其他失败
+ */
+esp_err_t board_audio_record_blocks(i2s_chan_handle_t rx_handle, uint8_t *const *blocks, size_t block_count,
+                                    size_t block_size, size_t *bytes_read, uint32_t timeout_ms);
+
+/**
+ * @brief 启用/禁用 GDMA 零拷贝路径 (默认 CONFIG_AUDIO_ZERO_COPY)
+ * @details 启用时, 录音缓冲区位于 PSRAM 且按 BOARD_AUDIO_PSRAM_DMA_ALIGN 对齐, DMA 周期长度也是其整数倍时,
+ *          board_audio_record() 在接收完成中断中把 DMA 缓冲区异步拷贝到录音缓冲区;
+ *          播放 PSRAM 中的数据时, 先异步预取到内部 RAM 双缓冲再交给 DSP 或 I2S.
+ *          条件不满足时自动使用 CPU 拷贝路径. 主要用于对比测试
+ * @param enable true 启用
+ */
+void board_audio_set_zero_copy(bool enable);
+
+/**
+ * @brief 零拷贝路径是否启用
+ */
+bool board_audio_get_zero_copy(void);
+
+/**
+ * @brief 以指定 DMA 深度重建 I2S 发送和接收通道
+ * @details 删除现有通道 (如有) 后重新初始化 ES8311 和 ES7210 通道, 之后创建的通道也使用该深度.
+ *          DMA 缓冲时延约为 desc_num * frame_num / 采样率.
+ * @param[in,out] tx_handle 发送通道句柄, 返回新句柄
+ * @param[in,out] rx_handle 接收通道句柄, 返回新句柄
+ * @param desc_num DMA 描述符数 (>= 2)
+ * @param frame_num 每个描述符的帧数
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 正在播放或录音, 其他失败
+ */
+esp_err_t board_audio_reinit_channels(i2s_chan_handle_t *tx_handle, i2s_chan_handle_t *rx_handle,
+                                      uint32_t desc_num, uint32_t frame_num);
+
+/**
+ * @brief 同时启用发送和接收通道 (全双工, 用于监听通路)
+ * @details 打开功放并启用两个通道, 发送通道无数据时输出静音 (auto_clear). 结束时调用 board_audio_duplex_stop()
+ * @param tx_handle I2S 发送通道句柄
+ * @param rx_handle I2S 接收通道句柄
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 正在播放或录音, 其他失败
+ */
+esp_err_t board_audio_duplex_start(i2s_chan_handle_t tx_handle, i2s_chan_handle_t rx_handle);
+
+/**
+ * @brief 停止全双工通路, 关闭两个通道和功放
+ */
+void board_audio_duplex_stop(i2s_chan_handle_t tx_handle, i2s_chan_handle_t rx_handle);
+
+/**
+ * @brief 启用接收通道, 由调用者自行 i2s_channel_read() (流式录音)
+ * @details 结束时调用 board_audio_capture_end(), 期间计入当前 DMA 档位的录音时长.
+ *          成功时占用接收通道直到同一任务调用 board_audio_capture_end(), 期间切换采样率或 DMA 档位
+ *          返回 ESP_ERR_INVALID_STATE, 通道不会被重建
+ * @param rx_handle I2S 接收通道句柄, 必须是当前接收通道 (重建通道后旧句柄返回 ESP_ERR_INVALID_STATE)
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 正在录音、通道正在重建或句柄已失效, 其他失败
+ */
+esp_err_t board_audio_capture_begin(i2s_chan_handle_t rx_handle);
+
+/**
+ * @brief 停止流式录音, 关闭接收通道并释放占用 (必须在 board_audio_capture_begin() 的任务中调用)
+ */
+void board_audio_capture_end(i2s_chan_handle_t rx_handle);
+
+/**
+ * @brief I2S DMA 时延档位
+ */
+typedef enum {
+    BOARD_AUDIO_DMA_PROFILE_LOW_LATENCY = 0,    // 低时延
+    BOARD_AUDIO_DMA_PROFILE_BALANCED,           // 均衡
+    BOARD_AUDIO_DMA_PROFILE_ROBUST,             // 稳健
+    BOARD_AUDIO_DMA_PROFILE_MAX,
+} board_audio_dma_profile_t;
+
+/**
+ * @brief 单个 DMA 档位的遥测数据 (启动后累计, 不随切换清零)
+ */
+typedef struct {
+    const char *name;               // 档位名称
+    uint32_t desc_num;              // DMA 描述符数
+    uint32_t frame_num;             // 每个描述符的帧数
+    uint32_t buffer_latency_us;     // 按当前采样率计算的缓冲时延
+    uint32_t measured_latency_us;   // 实测 DMA 周期间隔 * 描述符数, 尚未播放过时为 0
+    uint32_t tx_underflows;         // 播放中发送队列溢出 (on_send_q_ovf, 应用未及时写入, 输出重复/静音)
+    uint32_t rx_overflows;          // 录音中接收队列溢出 (on_recv_q_ovf, 应用未及时读取, 丢失数据)
+    uint32_t tx_ms;                 // 该档位下累计播放时长
+    uint32_t rx_ms;                 // 该档位下累计录音时长
+} board_audio_dma_stats_t;
+
+/**
+ * @brief 切换 I2S DMA 时延档位
+ * @details 以档位的 DMA 深度重建发送和接收通道 (见 board_audio_reinit_channels()), 之后的播放和录音事件计入该档位.
+ *          已处于该档位时直接返回
+ * @param profile 档位
+ * @param[in,out] tx_handle 发送通道句柄, 返回新句柄
+ * @param[in,out] rx_handle 接收通道句柄, 返回新句柄
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_STATE 正在播放或录音, 其他失败
+ */
+esp_err_t board_audio_set_dma_profile(board_audio_dma_profile_t profile, i2s_chan_handle_t *tx_handle,
+                                      i2s_chan_handle_t *rx_handle);
+
+/**
+ * @brief 获取当前 DMA 档位 (监听通路使用自定义深度期间返回监听前的档位)
+ */
+board_audio_dma_profile_t board_audio_get_dma_profile(void);
+
+/**
+ * @brief 根据名称查找 DMA 档位
+ * @param name "low_latency" / "balanced" / "robust"
+ * @return 档位, 未找到返回 BOARD_AUDIO_DMA_PROFILE_MAX
+ */
+board_audio_dma_profile_t board_audio_dma_profile_from_name(const char *name);
+
+/**
+ * @brief 获取 DMA 档位遥测数据
+ * @param profile 档位
+ * @param[out] stats 遥测数据
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t board_audio_get_dma_stats(board_audio_dma_profile_t profile, board_audio_dma_stats_t *stats);
+
+/**
+ * @brief 切换音频时钟域采样率 (播放和录音共用 MCLK)
+ * @details 在一次协调的切换中静音 ES8311, 重新配置 I2S 发送 (标准模式) 和接收 (TDM) 通道时钟,
+ *          重写 ES8311 和 ES7210 的时钟分频系数, 重新计算播放 DSP 系数后解除静音.
+ *          不重建 I2S 通道, 也不重新初始化编解码器. 已初始化的通道在切换后直接以新采样率工作,
+ *          之后初始化的通道也使用新采样率.
+ * @param sample_rate 采样率, 支持 8000/16000/44100/48000
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_NOT_SUPPORTED 不支持的采样率,
+ *         ESP_ERR_INVALID_STATE 正在播放或录音, 其他失败
+ */
+esp_err_t board_audio_set_sample_rate(uint32_t sample_rate);
+
+/**
+ * @brief 获取当前音频时钟域采样率
+ * @return 采样率 (Hz), 启动时为 BOARD_AUDIO_SAMPLE_RATE
+ */
+uint32_t board_audio_get_sample_rate(void);
+
 /**
  * @brief 卸载音频 I2S 通道
  * @param handle 要卸载的 I2S 通道句柄
@@ -289,6 +583,41 @@ esp_err_t board_websocket_stop(esp_websocket_client_handle_t client);
  */
 esp_err_t board_websocket_destroy(esp_websocket_client_handle_t client);
 
+/**
+ * @brief 获取配置的 WebSocket 服务器数 (主服务器 + 备用服务器, 不超过 BOARD_WS_ENDPOINT_MAX)
+ * @details 传输层按主服务器的协议 (ws/wss) 建立, 协议不同的备用服务器不计入, 记录一条警告后跳过
+ */
+int board_websocket_endpoint_count(void);
+
+/**
+ * @brief 获取 WebSocket 服务器的完整 URL (已附加客户端 ID)
+ * @param index 服务器序号, 0 为主服务器
+ * @param[out] buf 输出缓冲区 (建议 BOARD_WS_ENDPOINT_URL_MAX 字节)
+ * @param len 缓冲区大小
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_ARG 序号无效, ESP_ERR_INVALID_SIZE 缓冲区不足
+ */
+esp_err_t board_websocket_endpoint_url(int index, char *buf, size_t len);
+
+/**
+ * @brief 获取 WebSocket 服务器的主机名和端口 (用于后台探测)
+ * @param index 服务器序号, 0 为主服务器
+ * @param[out] host 主机名或 IP 地址
+ * @param len host 缓冲区大小
+ * @param[out] port 端口, URL 未写明时按协议取 80 或 443
+ * @return esp_err_t ESP_OK 成功, 其他失败
+ */
+esp_err_t board_websocket_endpoint_addr(int index, char *host, size_t len, uint16_t *port);
+
+/**
+ * @brief 探测服务器是否可连接: 建立一次 TCP 连接后立即关闭
+ * @param host 主机名或 IP 地址
+ * @param port 端口
+ * @param timeout_ms 连接超时 (毫秒)
+ * @param[out] connect_ms 连接耗时 (毫秒), 近似一次往返时间
+ * @return esp_err_t ESP_OK 连接成功, ESP_ERR_TIMEOUT 超时, 其他失败
+ */
+esp_err_t board_tcp_probe(const char *host, uint16_t port, uint32_t timeout_ms, uint32_t *connect_ms);
+
 /**
  * @brief 获取设备 MAC 地址字符串
  * @param[out] mac_str 输出 MAC 地址字符串 (格式: "XX:XX:XX:XX:XX:XX", 需要至少 18 字节)
@@ -11,13 +11,26 @@
  */
 
 #include "board.h"
+#include "audio_assets.h"
+#include "audio_cache.h"
+#include "audio_stream.h"
+#include "audio_dsp.h"
+#include "audio_synth.h"
+#include "audio_monitor.h"
+#include "audio_pool.h"
+#include "audio_recorder.h"
+#include "audio_outbox.h"
+#include "ws_conn.h"
+#include "ws_endpoint.h"
+#include "esp_random.h"
+#include "freertos/message_buffer.h"
 #include <inttypes.h>
+#include <math.h>
 
 static const char *TAG = "MAIN";
 
 // 录音缓冲区
-static uint8_t *s_audio_buffer = NULL;
-static size_t s_audio_buffer_size = BOARD_AUDIO_BUFFER_SIZE;
+static audio_chain_t s_record_chain;      // 录音块链 (从缓冲区池借出, 下次录音前归还)
 
 // I2S通道句柄
 static i2s_chan_handle_t s_tx_handle = NULL; // 播放
@@ -25,16 +38,13 @@ static i2s_chan_handle_t s_rx_handle = NULL; // 录音
 
 // WebSocket客户端句柄
 static esp_websocket_client_handle_t s_ws_client = NULL;
-
-// 引用嵌入的PCM文件
-extern const uint8_t pcm_1_pcm_start[] asm("_binary_1_pcm_start");
-extern const uint8_t pcm_1_pcm_end[] asm("_binary_1_pcm_end");
-extern const uint8_t pcm_2_pcm_start[] asm("_binary_2_pcm_start");
-extern const uint8_t pcm_2_pcm_end[]   asm("_binary_2_pcm_end");
-extern const uint8_t pcm_3_pcm_start[] asm("_binary_3_pcm_start");
-extern const uint8_t pcm_3_pcm_end[]   asm("_binary_3_pcm_end");
-extern const uint8_t pcm_4_pcm_start[] asm("_binary_4_pcm_start");
-extern const uint8_t pcm_4_pcm_end[]   asm("_binary_4_pcm_end");
+static MessageBufferHandle_t s_ws_cmd_buf = NULL;     // 收到的命令消息, WebSocket 任务写入, 命令任务执行
+#define WS_CMD_LOCAL_EARCON 0x00                        // 命令缓冲区中以该字节开头的是本地命令: 播放第 2 字节指定的提示音
+static ws_conn_t s_ws_conn;                             // 连接管理 (退避、PING 间隔、指标), WebSocket 任务更新
+static ws_endpoint_set_t s_ws_endpoints;                // 服务器评分与切换, 同样由 s_ws_conn_lock 保护
+static uint32_t s_ws_connect_start_ms;                  // 本次连接开始的时间, 用于计算握手时间
+static bool s_ws_failback_pending;                      // 探测任务请求切回, 由 DISCONNECTED 回调完成切换
+static portMUX_TYPE s_ws_conn_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // 系统状态
 typedef enum {
@@ -61,72 +71,188 @@ static void reset_connection_timer_cb(TimerHandle_t timer)
     ESP_LOGI(TAG, "长时间断开连接，重置首次连接标志");
 }
 
+/**
+ * @brief 把回复放入 WebSocket 控制通道 (不阻塞)
+ * @details 由 WebSocket 任务在两个帧之间发送, 排在积压的录音上传之前; 调用方 (常常就是事件回调) 不等待网络.
+ *          未连接或控制通道已满时丢弃并记录警告
+ * @param msg 文本消息
+ * @param len 长度, 小于 0 时按字符串计算
+ */
+static void ws_send_control(const char *msg, int len)
+{
+    if (s_ws_client == NULL) {
+        return;
+    }
+    if (len < 0) {
+        len = strlen(msg);
+    }
+    esp_err_t ret = esp_websocket_client_enqueue(s_ws_client, WEBSOCKET_TX_LANE_CONTROL, WS_TRANSPORT_OPCODES_TEXT,
+                                                 msg, len);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "控制消息未发送 (%s): %.*s", esp_err_to_name(ret), len > 64 ? 64 : len, msg);
+    }
+}
+
+static uint32_t ws_conn_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/**
+ * @brief 记录收到数据 (WebSocket 任务中调用), 连接稳定后延长 PING 间隔
+ */
+static void ws_conn_note_rx(void)
+{
+    portENTER_CRITICAL(&s_ws_conn_lock);
+    bool changed = ws_conn_on_rx(&s_ws_conn, ws_conn_now_ms());
+    uint16_t ping_sec = ws_conn_ping_sec(&s_ws_conn);
+    portEXIT_CRITICAL(&s_ws_conn_lock);
+    if (changed) {
+        ESP_LOGI(TAG, "连接稳定，PING 间隔延长到 %u 秒", ping_sec);
+        esp_websocket_client_set_ping_interval_sec(s_ws_client, ping_sec);
+    }
+}
+
+/**
+ * @brief 读取连接指标 (任意任务)
+ */
+static void ws_conn_get_stats(ws_conn_stats_t *st)
+{
+    portENTER_CRITICAL(&s_ws_conn_lock);
+    *st = s_ws_conn.stats;
+    portEXIT_CRITICAL(&s_ws_conn_lock);
+}
+
+/**
+ * @brief 读取服务器评分 (任意任务)
+ * @param[out] scores 每个服务器的当前分数, 至少 WS_ENDPOINT_MAX 项
+ */
+static void ws_endpoint_get_stats(ws_endpoint_set_t *set, uint32_t *scores)
+{
+    portENTER_CRITICAL(&s_ws_conn_lock);
+    *set = s_ws_endpoints;
+    uint32_t now = ws_conn_now_ms();
+    for (int i = 0; i < set->count; i++) {
+        scores[i] = ws_endpoint_score(&s_ws_endpoints, i, now);
+    }
+    portEXIT_CRITICAL(&s_ws_conn_lock);
+}
+
+/**
+ * @brief 让客户端下次连接第 index 个服务器
+ * @details 只在 DISCONNECTED 回调中 (客户端任务, 重连前) 调用, 与客户端读取 URL 不会并发
+ */
+static esp_err_t ws_endpoint_apply(int index)
+{
+    char url[BOARD_WS_ENDPOINT_URL_MAX];
+    esp_err_t ret = board_websocket_endpoint_url(index, url, sizeof(url));
+    if (ret == ESP_OK) {
+        ret = esp_websocket_client_set_uri(s_ws_client, url);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "切换到服务器 %d 失败: %s", index, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief 服务器探测任务 (配置了备用服务器时创建)
+ * @details 连接期间每 BOARD_WS_PROBE_INTERVAL_MS 用一次 TCP 连接探测每个服务器 (包括当前服务器, 切回时只比较
+ *          同一种测量); 更好的服务器 (通常是恢复了的主服务器) 的探测时间明显短于当前服务器时, 请求客户端断开重连,
+ *          由 DISCONNECTED 回调在客户端任务中换 URL. 断开期间不探测: 重连本身就在按分数轮换服务器
+ */
+static void ws_endpoint_probe_task(void *arg)
+{
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(BOARD_WS_PROBE_INTERVAL_MS));
+        if (!esp_websocket_client_is_connected(s_ws_client)) {
+            continue;
+        }
+        portENTER_CRITICAL(&s_ws_conn_lock);
+        int count = s_ws_endpoints.count;
+        int current = s_ws_endpoints.current;
+        portEXIT_CRITICAL(&s_ws_conn_lock);
+
+        for (int i = 0; i < count; i++) {
+            char host[64];
+            uint16_t port;
+            uint32_t connect_ms = 0;
+            esp_err_t ret = board_websocket_endpoint_addr(i, host, sizeof(host), &port);
+            if (ret == ESP_OK) {
+                ret = board_tcp_probe(host, port, BOARD_WS_PROBE_TIMEOUT_MS, &connect_ms);
+            }
+            ESP_LOGD(TAG, "探测服务器 %d (%s:%u): %s %" PRIu32 " ms", i, host, port, esp_err_to_name(ret), connect_ms);
+            portENTER_CRITICAL(&s_ws_conn_lock);
+            ws_endpoint_on_probe(&s_ws_endpoints, i, ws_conn_now_ms(), ret == ESP_OK, connect_ms);
+            portEXIT_CRITICAL(&s_ws_conn_lock);
+        }
+
+        if (!esp_websocket_client_is_connected(s_ws_client)) {
+            continue;
+        }
+        portENTER_CRITICAL(&s_ws_conn_lock);
+        int next = ws_endpoint_failback(&s_ws_endpoints, ws_conn_now_ms());
+        uint32_t probe_ms = s_ws_endpoints.ep[current].probe_ms;
+        uint32_t next_probe_ms = next >= 0 ? s_ws_endpoints.ep[next].probe_ms : 0;
+        portEXIT_CRITICAL(&s_ws_conn_lock);
+        if (next < 0) {
+            continue;
+        }
+
+        // 主动切换: 客户端任务断开当前连接后产生 DISCONNECTED 事件, 回调中换 URL 并立即重连 (不计入失败)
+        ESP_LOGI(TAG, "服务器 %d 优于当前服务器 %d (探测 %" PRIu32 " ms < %" PRIu32 " ms)，切换", next, current,
+                 next_probe_ms, probe_ms);
+        portENTER_CRITICAL(&s_ws_conn_lock);
+        s_ws_failback_pending = true;
+        portEXIT_CRITICAL(&s_ws_conn_lock);
+        if (esp_websocket_client_reconnect(s_ws_client) != ESP_OK) {
+            portENTER_CRITICAL(&s_ws_conn_lock);
+            s_ws_failback_pending = false;
+            portEXIT_CRITICAL(&s_ws_conn_lock);
+        }
+    }
+}
+
+/**
+ * @brief 收到的二进制消息 (WebSocket 任务中直接调用, 不经过事件循环)
+ * @details 监听期间作为远端音频混入侧音通路, 否则丢弃
+ */
+static esp_err_t ws_binary_sink(void *ctx, const uint8_t *data, size_t len, size_t offset, bool final)
+{
+    ws_conn_note_rx();
+    if (audio_monitor_is_active() && len > 0) {
+        audio_monitor_write_remote(data, len);
+    }
+    return ESP_OK;
+}
+
 // 函数声明
 static void play_recorded_audio(size_t bytes_recorded);
 static void play_default_audio(void);
+static esp_err_t play_pcm_asset(const audio_asset_t *asset);
+static esp_err_t play_earcon(const audio_earcon_t *earcon);
 static esp_err_t play_pcm_by_id(int pcm_id);
+static esp_err_t play_pcm_by_name(const char *name, int *id);
 
 /**
- * @brief 根据ID播放PCM文件
- * @param pcm_id PCM文件ID (1-4)
+ * @brief 播放提示音资源
+ * @param asset 资源描述 (audio_assets_get()/audio_assets_find() 返回的副本)
  * @return ESP_OK成功，其他失败
- * @note 当前仅实现了1.pcm，需要播放其他PCM文件，请在CMakeLists.txt中添加对应文件
- *       并添加相应的extern声明
  */
-static esp_err_t play_pcm_by_id(int pcm_id)
+static esp_err_t play_pcm_asset(const audio_asset_t *asset)
 {
     esp_err_t ret;
-    const uint8_t *pcm_start = NULL;
-    const uint8_t *pcm_end = NULL;
-    
-    // 根据ID选择PCM文件
-    switch (pcm_id) {
-        case 1:
-            pcm_start = pcm_1_pcm_start;
-            pcm_end = pcm_1_pcm_end;
-            break;
-        case 2: 
-            pcm_start = pcm_2_pcm_start;
-            pcm_end = pcm_2_pcm_end;
-            break;
-        case 3:
-            pcm_start = pcm_3_pcm_start;
-            pcm_end = pcm_3_pcm_end;
-            break;
-        case 4:
-            pcm_start = pcm_4_pcm_start;
-            pcm_end = pcm_4_pcm_end;
-            break;
-        default:
-            ESP_LOGE(TAG, "无效的PCM ID: %d", pcm_id);
-            return ESP_ERR_INVALID_ARG;
-    }
     
-    // 检查是否获取到了PCM文件
-    if (pcm_start == NULL || pcm_end == NULL) {
-        ESP_LOGE(TAG, "PCM文件 %d 未找到或未嵌入", pcm_id);
-        return ESP_ERR_NOT_FOUND;
-    }
-    
-    // 初始化播放设备 (如果未初始化)
+    // 播放设备在启动时初始化, 失败时不再重试
     if (s_tx_handle == NULL) {
-        ret = board_audio_playback_init(&s_tx_handle);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "初始化播放设备失败: %s", esp_err_to_name(ret));
-            return ret;
-        }
+        ESP_LOGE(TAG, "播放设备未初始化");
+        return ESP_ERR_INVALID_STATE;
     }
     
     // 更新系统状态
     s_system_state = SYSTEM_STATE_PLAYING;
     
-    // 计算PCM文件大小
-    size_t pcm_size = pcm_end - pcm_start;
-    
-    // 开始播放
-    ESP_LOGI(TAG, "开始播放PCM %d，数据大小: %u 字节", pcm_id, (unsigned int)pcm_size);
-    
-    ret = board_audio_play(s_tx_handle, pcm_start, pcm_size);
+    ret = audio_assets_play(s_tx_handle, asset);
     
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "播放失败: %s", esp_err_to_name(ret));
@@ -144,11 +270,79 @@ static esp_err_t play_pcm_by_id(int pcm_id)
 }
 
 /**
- * @brief 播放默认的音频文件(1.pcm)
+ * @brief 合成并播放提示音
+ * @param earcon 提示音描述 (内置或服务器下发)
+ * @return ESP_OK成功，其他失败
+ */
+static esp_err_t play_earcon(const audio_earcon_t *earcon)
+{
+    esp_err_t ret;
+    
+    // 播放设备在启动时初始化, 失败时不再重试
+    if (s_tx_handle == NULL) {
+        ESP_LOGE(TAG, "播放设备未初始化");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    s_system_state = SYSTEM_STATE_PLAYING;
+    ret = audio_synth_play(s_tx_handle, earcon);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "提示音播放失败: %s", esp_err_to_name(ret));
+    }
+    s_system_state = SYSTEM_STATE_INIT;
+    
+    return ret;
+}
+
+/**
+ * @brief 根据ID播放PCM文件
+ * @details 资源分区中没有该ID时回退到同ID的合成提示音, 因此更新资源分区即可用录音替换合成音
+ * @param pcm_id 资源ID (见 main/assets/manifest.csv 和 audio_synth.h)
+ * @return ESP_OK成功，ESP_ERR_NOT_FOUND 资源不存在，其他失败
+ */
+static esp_err_t play_pcm_by_id(int pcm_id)
+{
+    audio_asset_t asset;
+    if (audio_assets_get(pcm_id, &asset) != ESP_OK) {
+        const audio_earcon_t *earcon = audio_synth_get(pcm_id);
+        if (earcon != NULL) {
+            return play_earcon(earcon);
+        }
+        ESP_LOGE(TAG, "无效的PCM ID: %d", pcm_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return play_pcm_asset(&asset);
+}
+
+/**
+ * @brief 根据名称播放PCM文件
+ * @param name 资源名称 (见 main/assets/manifest.csv 和 audio_synth.c)
+ * @param[out] id 找到的资源 ID, 不存在时为 -1
+ * @return ESP_OK成功，ESP_ERR_NOT_FOUND 资源不存在，其他失败
+ */
+static esp_err_t play_pcm_by_name(const char *name, int *id)
+{
+    audio_asset_t asset;
+    if (audio_assets_find(name, &asset) != ESP_OK) {
+        const audio_earcon_t *earcon = audio_synth_find(name);
+        if (earcon != NULL) {
+            *id = earcon->id;
+            return play_earcon(earcon);
+        }
+        ESP_LOGE(TAG, "无效的PCM名称: %s", name);
+        *id = -1;
+        return ESP_ERR_NOT_FOUND;
+    }
+    *id = asset.id;
+    return play_pcm_asset(&asset);
+}
+
+/**
+ * @brief 播放默认的音频文件(welcome)
  */
 static void play_default_audio(void)
 {
-    play_pcm_by_id(1);
+    play_pcm_by_id(AUDIO_ASSET_WELCOME);
 }
 
 /**
@@ -174,97 +368,93 @@ static void handle_factory_reset_event(void)
 
 /**
  * @brief 启动录音功能
+ * @param seconds 请求的录音时长 (秒)
+ * @param[out] granted 实际录音时长 (秒), 缓冲区池预算不足时会被缩短
+ * @return esp_err_t ESP_OK 成功, ESP_ERR_INVALID_SIZE 已缩短, ESP_ERR_NO_MEM 预算不足被拒绝, 其他失败
  */
-static void start_audio_recording(int seconds)
+static esp_err_t start_audio_recording(int seconds, int *granted)
 {
     esp_err_t ret;
+    *granted = 0;
     
     if (s_system_state == SYSTEM_STATE_RECORDING) {
         ESP_LOGW(TAG, "录音已经在进行中");
-        return;
+        return ESP_ERR_INVALID_STATE;
     }
     
     // 限制录音时间，防止内存不足
     if (seconds < 1) seconds = 1;
     if (seconds > 30) seconds = 30; // 最大30秒
     
-    // 释放以前的录音缓冲区（如果存在）
-    if (s_audio_buffer != NULL) {
-        heap_caps_free(s_audio_buffer);
-        s_audio_buffer = NULL;
-    }
+    // 归还以前的录音块链（如果存在）
+    audio_pool_free(&s_record_chain);
     
     // 根据请求的录音时长计算所需的缓冲区大小
-    size_t bytes_per_second = BOARD_AUDIO_SAMPLE_RATE * 2 * BOARD_AUDIO_CHANNELS; // 采样率 * 16位(2字节) * 通道数
+    size_t bytes_per_second = board_audio_get_sample_rate() * 2 * BOARD_AUDIO_CHANNELS; // 采样率 * 16位(2字节) * 通道数
     size_t required_buffer_size = bytes_per_second * seconds;
     
-    // 至少使用默认的缓冲区大小
-    s_audio_buffer_size = (required_buffer_size > BOARD_AUDIO_BUFFER_SIZE) ? 
-                          required_buffer_size : BOARD_AUDIO_BUFFER_SIZE;
-                          
-    ESP_LOGI(TAG, "为%d秒录音分配缓冲区，大小: %u 字节", seconds, (unsigned int)s_audio_buffer_size);
-    
-    // 优先使用PSRAM分配大缓冲区
-    s_audio_buffer = heap_caps_malloc(s_audio_buffer_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (s_audio_buffer == NULL) {
-        // 尝试使用内部内存
-        ESP_LOGW(TAG, "PSRAM分配失败，尝试使用内部内存");
-        
-        // 对于内部内存，我们缩小缓冲区大小
-        s_audio_buffer_size = bytes_per_second * 2; // 只录制2秒，避免内存不足
-        if (s_audio_buffer_size < 32768) s_audio_buffer_size = 32768; // 至少32KB
-        
-        s_audio_buffer = heap_caps_malloc(s_audio_buffer_size, MALLOC_CAP_8BIT);
-        
-        if (s_audio_buffer == NULL) {
-            ESP_LOGE(TAG, "分配录音缓冲区失败，无法录音");
-            return;
-        }
-        
-        ESP_LOGW(TAG, "使用内部内存录音，缓冲区大小已减小: %u 字节", (unsigned int)s_audio_buffer_size);
-        // 根据缓冲区大小，重新计算可录制的秒数
-        seconds = s_audio_buffer_size / bytes_per_second;
-        if (seconds < 1) seconds = 1;
-        ESP_LOGI(TAG, "由于内存限制，录音时长调整为: %d 秒", seconds);
-    } else {
-        ESP_LOGI(TAG, "成功在PSRAM中分配 %u 字节的录音缓冲区", (unsigned int)s_audio_buffer_size);
+    // 新录音优先: 缓冲区池空间不足时丢弃最旧的离线排队录音
+    int evicted = audio_outbox_reclaim(required_buffer_size);
+    if (evicted > 0) {
+        ESP_LOGW(TAG, "为新录音丢弃 %d 条离线排队录音", evicted);
     }
     
+    // 从缓冲区池借出块链, 预算不足时最少保留 1 秒, 否则拒绝
+    esp_err_t alloc_ret = audio_pool_alloc(required_buffer_size, bytes_per_second, 0, &s_record_chain);
+    if (alloc_ret != ESP_OK && alloc_ret != ESP_ERR_INVALID_SIZE) {
+        ESP_LOGE(TAG, "缓冲区池无法容纳 %d 秒录音: %s", seconds, esp_err_to_name(alloc_ret));
+        return alloc_ret;
+    }
+    size_t record_size = s_record_chain.length < required_buffer_size ? s_record_chain.length : required_buffer_size;
+    if (alloc_ret == ESP_ERR_INVALID_SIZE) {
+        int requested = seconds;
+        seconds = record_size / bytes_per_second;
+        record_size = bytes_per_second * seconds;
+        ESP_LOGW(TAG, "缓冲区池预算不足，录音时长由 %d 秒缩短为 %d 秒", requested, seconds);
+    }
+    ESP_LOGI(TAG, "为%d秒录音借出 %u 个块，大小: %u 字节", seconds, (unsigned int)s_record_chain.count,
+             (unsigned int)record_size);
+    
     // 初始化录音设备 (如果未初始化)
     if (s_rx_handle == NULL) {
         ret = board_audio_record_init(&s_rx_handle);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "初始化录音设备失败: %s", esp_err_to_name(ret));
-            heap_caps_free(s_audio_buffer);
-            s_audio_buffer = NULL;
-            return;
+            audio_pool_free(&s_record_chain);
+            return ret;
         }
     }
     
     // 更新系统状态
     s_system_state = SYSTEM_STATE_RECORDING;
+    *granted = seconds;
     
     // 开始录音
     ESP_LOGI(TAG, "开始录音, 时长: %d 秒", seconds);
     
+    // 录音数据按块顺序写入块链, 块按 PSRAM DMA 对齐, 可由 GDMA 直接写入 (零拷贝)
     size_t bytes_read = 0;
-    ret = board_audio_record(s_rx_handle, s_audio_buffer, s_audio_buffer_size, &bytes_read, seconds * 1000);
+    size_t record_blocks = (record_size + BOARD_AUDIO_POOL_BLOCK_SIZE - 1) / BOARD_AUDIO_POOL_BLOCK_SIZE;
+    ret = board_audio_record_blocks(s_rx_handle, s_record_chain.blocks, record_blocks, BOARD_AUDIO_POOL_BLOCK_SIZE,
+                                    &bytes_read, seconds * 1000);
     
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "录音失败: %s", esp_err_to_name(ret));
         s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
-        return;
+        return ret;
     }
     
     ESP_LOGI(TAG, "录音完成，共录制 %u 字节数据", (unsigned int)bytes_read);
     
-    // 发送录音完成通知给服务器
+    // 发送录音完成通知给服务器; 未连接时录音在回放后移交离线队列, 重新连接后上传
+    bool notified = false;
     if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
-        char response[128];
+        notified = true;
+        char response[160];
         snprintf(response, sizeof(response), 
-                 "{\"event\":\"record_complete\",\"size\":%u,\"duration\":%d}", 
-                 (unsigned int)bytes_read, seconds);
-        esp_websocket_client_send_text(s_ws_client, response, strlen(response), portMAX_DELAY);
+                 "{\"event\":\"record_complete\",\"size\":%u,\"duration\":%d,\"shortened\":%s}", 
+                 (unsigned int)bytes_read, seconds, alloc_ret == ESP_ERR_INVALID_SIZE ? "true" : "false");
+        ws_send_control(response, strlen(response));
     }
     
     // 可选：播放录音内容进行测试
@@ -272,8 +462,21 @@ static void start_audio_recording(int seconds)
         play_recorded_audio(bytes_read);
     }
     
+    if (!notified && bytes_read > 0) {
+        audio_outbox_meta_t meta = {
+            .sample_rate = board_audio_get_sample_rate(),
+            .channels = BOARD_AUDIO_CHANNELS,
+            .shortened = (alloc_ret == ESP_ERR_INVALID_SIZE),
+            .size = bytes_read,
+            .duration_ms = (uint32_t)((uint64_t)bytes_read * 1000 / bytes_per_second),
+            .recorded_at_us = esp_timer_get_time(),
+        };
+        audio_outbox_push(&s_record_chain, &meta);
+    }
+    
     // 恢复系统状态
     s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
+    return alloc_ret;
 }
 
 /**
@@ -283,18 +486,15 @@ static void play_recorded_audio(size_t bytes_recorded)
 {
     esp_err_t ret;
     
-    if (s_audio_buffer == NULL || bytes_recorded == 0) {
+    if (s_record_chain.count == 0 || bytes_recorded == 0) {
         ESP_LOGE(TAG, "没有可播放的录音数据");
         return;
     }
     
-    // 初始化播放设备 (如果未初始化)
+    // 播放设备在启动时初始化, 失败时不再重试
     if (s_tx_handle == NULL) {
-        ret = board_audio_playback_init(&s_tx_handle);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "初始化播放设备失败: %s", esp_err_to_name(ret));
-            return;
-        }
+        ESP_LOGE(TAG, "播放设备未初始化");
+        return;
     }
     
     // 更新系统状态
@@ -303,7 +503,8 @@ static void play_recorded_audio(size_t bytes_recorded)
     // 开始播放
     ESP_LOGI(TAG, "开始播放录音，数据大小: %u 字节", (unsigned int)bytes_recorded);
     
-    ret = board_audio_play(s_tx_handle, s_audio_buffer, bytes_recorded);
+    ret = board_audio_play_blocks(s_tx_handle, (const uint8_t *const *)s_record_chain.blocks, s_record_chain.count,
+                                  BOARD_AUDIO_POOL_BLOCK_SIZE, bytes_recorded);
     
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "播放失败: %s", esp_err_to_name(ret));
@@ -315,8 +516,1012 @@ static void play_recorded_audio(size_t bytes_recorded)
     s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
 }
 
+/**
+ * @brief 提示音资源更新任务
+ * @param arg 镜像地址 (strdup 分配, 任务结束时释放)
+ */
+static void assets_update_task(void *arg)
+{
+    char *url = (char *)arg;
+
+    ESP_LOGI(TAG, "开始更新提示音资源: %s", url);
+    esp_err_t ret = audio_assets_update_from_url(url);
+    free(url);
+
+    // 发送更新结果
+    char response[128];
+    snprintf(response, sizeof(response),
+            "{\"event\":\"update_assets_result\",\"data\":{\"status\":\"%s\",\"error\":\"%s\"}}",
+            (ret == ESP_OK) ? "ok" : "fail", esp_err_to_name(ret));
+    if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
+        ws_send_control(response, strlen(response));
+    }
+
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 音频片段缓存任务参数
+ */
+typedef struct {
+    char *url;
+    bool has_hash;
+    uint8_t hash[AUDIO_CACHE_HASH_LEN];
+    uint32_t sample_rate;   // 0 表示当前时钟域采样率
+} cache_audio_req_t;
+
+/**
+ * @brief 音频片段下载缓存任务
+ * @param arg cache_audio_req_t (任务结束时释放)
+ */
+static void cache_audio_task(void *arg)
+{
+    cache_audio_req_t *req = (cache_audio_req_t *)arg;
+    uint8_t hash[AUDIO_CACHE_HASH_LEN] = {0};
+    bool cached = false;
+
+    esp_err_t ret = audio_cache_fetch(req->url, req->has_hash ? req->hash : NULL, req->sample_rate, hash, &cached);
+    free(req->url);
+    free(req);
+
+    // 发送缓存结果, 服务器用返回的 hash 调用 play_cached
+    char hex[AUDIO_CACHE_HASH_HEX_LEN + 1];
+    audio_cache_hash_to_hex(hash, hex);
+    char response[192];
+    snprintf(response, sizeof(response),
+            "{\"event\":\"cache_audio_result\",\"data\":{\"hash\":\"%s\",\"status\":\"%s\",\"cached\":%s}}",
+            hex, (ret == ESP_OK) ? "ok" : "fail", cached ? "true" : "false");
+    if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
+        ws_send_control(response, strlen(response));
+    }
+
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 音频流播放任务参数
+ */
+typedef struct {
+    char *url;
+    size_t offset;
+} play_url_req_t;
+
+/**
+ * @brief 音频流播放任务
+ * @param arg play_url_req_t (任务结束时释放)
+ */
+static void play_url_task(void *arg)
+{
+    play_url_req_t *req = (play_url_req_t *)arg;
+    audio_stream_stats_t stats = {0};
+    esp_err_t ret = ESP_FAIL;
+
+    // 其他播放进行中时直接拒绝, 在建立 HTTP 连接之前占用通道
+    bool busy = board_audio_playback_acquire() != ESP_OK;
+    if (!busy) {
+        if (s_tx_handle != NULL) {
+            s_system_state = SYSTEM_STATE_PLAYING;
+            ret = audio_stream_play_url(s_tx_handle, req->url, req->offset, &stats);
+            s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
+        }
+        board_audio_playback_release();
+    }
+    free(req->url);
+    free(req);
+
+    // 发送播放结果和统计
+    char response[256];
+    snprintf(response, sizeof(response),
+            "{\"event\":\"play_url_result\",\"data\":{\"status\":\"%s\",\"bytes\":%u,\"total\":%u,"
+            "\"requests\":%u,\"throughput_kbps\":%u,\"underruns\":%u,\"startup_ms\":%u}}",
+            busy ? "busy" : (ret == ESP_OK) ? "ok" : "fail", (unsigned int)stats.bytes, (unsigned int)stats.total,
+            (unsigned int)stats.requests, (unsigned int)stats.throughput_kbps,
+            (unsigned int)stats.underruns, (unsigned int)stats.startup_ms);
+    if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
+        ws_send_control(response, strlen(response));
+    }
+
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 监听回环时延测试任务
+ * @param arg 测量次数 (intptr_t)
+ */
+static void monitor_test_task(void *arg)
+{
+    int count = (int)(intptr_t)arg;
+    audio_monitor_latency_t lat = {0};
+    audio_monitor_stats_t stats = {0};
+    esp_err_t ret = ESP_OK;
+    
+    // 未在监听时临时启动 (侧音静音), 测量后停止
+    bool started = false;
+    if (!audio_monitor_is_active()) {
+        ret = audio_monitor_start(&s_tx_handle, &s_rx_handle, -100.0f);
+        started = (ret == ESP_OK);
+    }
+    if (ret == ESP_OK) {
+        ret = audio_monitor_measure_latency(count, &lat);
+        audio_monitor_get_stats(&stats);
+    }
+    if (started) {
+        audio_monitor_stop();
+    }
+    
+    char response[256];
+    snprintf(response, sizeof(response),
+            "{\"event\":\"monitor_test_result\",\"data\":{\"status\":\"%s\",\"count\":%d,\"min_us\":%u,"
+            "\"avg_us\":%u,\"max_us\":%u,\"buffer_us\":%u,\"max_process_us\":%u}}",
+            (ret == ESP_OK) ? "ok" : "fail", lat.count, (unsigned int)lat.min_us, (unsigned int)lat.avg_us,
+            (unsigned int)lat.max_us, (unsigned int)stats.buffer_latency_us, (unsigned int)stats.max_process_us);
+    if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
+        ws_send_control(response, strlen(response));
+    }
+    
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 上报各 DMA 档位的遥测数据
+ */
+static void send_dma_stats(void)
+{
+    board_audio_dma_stats_t cur;
+    board_audio_get_dma_stats(board_audio_get_dma_profile(), &cur);
+    
+    char response[768];
+    int len = snprintf(response, sizeof(response), "{\"event\":\"get_dma_stats_result\",\"data\":{\"profile\":\"%s\",\"profiles\":[",
+                       cur.name);
+    for (int i = 0; i < BOARD_AUDIO_DMA_PROFILE_MAX && len < sizeof(response); i++) {
+        board_audio_dma_stats_t st;
+        board_audio_get_dma_stats((board_audio_dma_profile_t)i, &st);
+        len += snprintf(response + len, sizeof(response) - len,
+                        "%s{\"name\":\"%s\",\"desc_num\":%u,\"frame_num\":%u,\"buffer_us\":%u,\"measured_us\":%u,"
+                        "\"tx_underflows\":%u,\"rx_overflows\":%u,\"tx_ms\":%u,\"rx_ms\":%u}",
+                        i ? "," : "", st.name, (unsigned int)st.desc_num, (unsigned int)st.frame_num,
+                        (unsigned int)st.buffer_latency_us, (unsigned int)st.measured_latency_us,
+                        (unsigned int)st.tx_underflows, (unsigned int)st.rx_overflows,
+                        (unsigned int)st.tx_ms, (unsigned int)st.rx_ms);
+    }
+    if (len < sizeof(response)) {
+        len += snprintf(response + len, sizeof(response) - len, "]}}");
+    }
+    if (len >= sizeof(response)) {
+        ESP_LOGE(TAG, "DMA 统计响应过长");
+        return;
+    }
+    ws_send_control(response, len);
+}
+
+/* CPU 占用探针: 每个核心一个与空闲任务同优先级的计数任务, 计数速率下降的比例即为其他任务和中断的占用 */
+static volatile bool s_probe_run = false;
+static volatile uint32_t s_probe_count[2];
+
+static void cpu_probe_task(void *arg)
+{
+    volatile uint32_t *count = &s_probe_count[(intptr_t)arg];
+    while (s_probe_run) {
+        (*count)++;
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 启动 CPU 占用探针
+ */
+static void cpu_probe_start(void)
+{
+    s_probe_run = true;
+    for (int core = 0; core < 2; core++) {
+        s_probe_count[core] = 0;
+        xTaskCreatePinnedToCore(cpu_probe_task, "cpu_probe", 2048, (void *)(intptr_t)core, tskIDLE_PRIORITY, NULL, core);
+    }
+}
+
+/**
+ * @brief 读取并清零探针计数, 返回每毫秒计数 (两个核心之和)
+ */
+static float cpu_probe_sample(int64_t since_us)
+{
+    float ms = (esp_timer_get_time() - since_us) / 1000.0f;
+    uint32_t count = s_probe_count[0] + s_probe_count[1];
+    s_probe_count[0] = 0;
+    s_probe_count[1] = 0;
+    return ms > 0 ? count / ms : 0;
+}
+
+/**
+ * @brief 零拷贝对比测试任务: 48kHz 立体声下分别以 CPU 拷贝和 GDMA 零拷贝录音、播放, 测量 CPU 占用
+ * @param arg 每项测试的秒数 (intptr_t)
+ */
+static void capture_bench_task(void *arg)
+{
+    int seconds = (int)(intptr_t)arg;
+    float load[2][2] = {{0}};           // [路径: CPU 拷贝 / 零拷贝][录音 / 播放], 单位: 单核百分比
+    uint32_t old_rate = board_audio_get_sample_rate();
+    bool old_zero_copy = board_audio_get_zero_copy();
+    size_t size = (size_t)seconds * 48000 * 2 * sizeof(int16_t);
+    static audio_chain_t chain;
+    esp_err_t ret = audio_pool_alloc(size, size, 0, &chain);
+    
+    // 整个测试期间占用播放通道, 其他播放不能在两次播放之间改动采样率
+    bool locked = false;
+    if (ret == ESP_OK) {
+        ret = board_audio_playback_acquire();
+        locked = (ret == ESP_OK);
+    }
+    if (ret == ESP_OK && (s_rx_handle == NULL || s_tx_handle == NULL || audio_monitor_is_active())) {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    if (ret == ESP_OK) {
+        ret = board_audio_set_sample_rate(48000);
+    }
+    if (ret == ESP_OK) {
+        s_system_state = SYSTEM_STATE_RECORDING;
+        cpu_probe_start();
+        
+        // 校准: 空载时的计数速率
+        int64_t t0 = esp_timer_get_time();
+        cpu_probe_sample(t0);
+        vTaskDelay(pdMS_TO_TICKS(500));
+        float idle_rate = cpu_probe_sample(t0);
+        
+        for (int mode = 0; ret == ESP_OK && mode < 2; mode++) {
+            board_audio_set_zero_copy(mode == 1);
+            size_t bytes = 0;
+            t0 = esp_timer_get_time();
+            cpu_probe_sample(t0);
+            ret = board_audio_record_blocks(s_rx_handle, chain.blocks, chain.count, BOARD_AUDIO_POOL_BLOCK_SIZE,
+                                            &bytes, seconds * 1000);
+            load[mode][0] = 200.0f * (1.0f - cpu_probe_sample(t0) / idle_rate);
+            if (ret == ESP_OK && bytes > 0) {
+                t0 = esp_timer_get_time();
+                cpu_probe_sample(t0);
+                ret = board_audio_play_blocks(s_tx_handle, (const uint8_t *const *)chain.blocks, chain.count,
+                                              BOARD_AUDIO_POOL_BLOCK_SIZE, bytes);
+                load[mode][1] = 200.0f * (1.0f - cpu_probe_sample(t0) / idle_rate);
+            }
+            ESP_LOGI(TAG, "%s: 录音 CPU %.1f%%, 播放 CPU %.1f%%", mode ? "GDMA 零拷贝" : "CPU 拷贝",
+                     load[mode][0], load[mode][1]);
+        }
+        
+        s_probe_run = false;
+        s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
+        board_audio_set_zero_copy(old_zero_copy);
+        board_audio_set_sample_rate(old_rate);
+    }
+    if (locked) {
+        board_audio_playback_release();
+    }
+    audio_pool_free(&chain);
+    
+    char response[256];
+    snprintf(response, sizeof(response),
+            "{\"event\":\"capture_bench_result\",\"data\":{\"status\":\"%s\",\"error\":\"%s\",\"seconds\":%d,"
+            "\"record_copy_pct\":%.1f,\"record_dma_pct\":%.1f,\"play_copy_pct\":%.1f,\"play_dma_pct\":%.1f}}",
+            (ret == ESP_OK) ? "ok" : "fail", esp_err_to_name(ret), seconds,
+            load[0][0], load[1][0], load[0][1], load[1][1]);
+    if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
+        ws_send_control(response, strlen(response));
+    }
+    
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 闪存录音任务
+ * @param arg 录音秒数 << 1 | 编码 (intptr_t)
+ */
+static void record_to_flash_task(void *arg)
+{
+    uint32_t seconds = (uint32_t)((intptr_t)arg >> 1);
+    audio_flash_log_codec_t codec = (audio_flash_log_codec_t)((intptr_t)arg & 1);
+    audio_recorder_result_t res = {0};
+    esp_err_t ret = ESP_OK;
+
+    if (s_rx_handle == NULL) {
+        ret = board_audio_record_init(&s_rx_handle);
+    }
+    if (ret == ESP_OK) {
+        s_system_state = SYSTEM_STATE_RECORDING;
+        ret = audio_recorder_record(&s_tx_handle, &s_rx_handle, seconds, codec, &res);
+        s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
+    }
+
+    // 持续写入吞吐: 写入字节数 / 擦除和编程的累计耗时
+    int64_t busy_us = res.flash.erase_us + res.flash.write_us;
+    uint32_t throughput_kbps = busy_us > 0 ? (uint32_t)((int64_t)res.flash.bytes_written * 1000000 / 1024 / busy_us) : 0;
+    char response[512];
+    snprintf(response, sizeof(response),
+            "{\"event\":\"record_to_flash_result\",\"data\":{\"status\":\"%s\",\"error\":\"%s\","
+            "\"codec\":\"%s\",\"sequence\":%u,\"requested_ms\":%u,\"elapsed_ms\":%u,\"frames\":%u,"
+            "\"data_size\":%u,\"dropped_frames\":%u,\"dma_dropped_frames\":%u,\"rx_overflows\":%u,"
+            "\"slab_overruns\":%u,\"pre_erase_ms\":%u,\"erases\":%u,\"inline_erases\":%u,\"max_erase_us\":%u,"
+            "\"max_write_us\":%u,\"flash_throughput_kbps\":%u}}",
+            (ret == ESP_OK) ? "ok" : (ret == ESP_ERR_INVALID_SIZE ? "shortened" : "fail"), esp_err_to_name(ret),
+            codec == AUDIO_FLASH_LOG_CODEC_IMA_ADPCM ? "adpcm" : "pcm", (unsigned int)res.header.sequence,
+            (unsigned int)res.requested_ms, (unsigned int)res.elapsed_ms, (unsigned int)res.header.frames,
+            (unsigned int)res.header.data_size, (unsigned int)res.header.dropped_frames,
+            (unsigned int)res.header.dma_dropped_frames, (unsigned int)res.rx_overflows, (unsigned int)res.slab_overruns, (unsigned int)res.pre_erase_ms,
+            (unsigned int)res.flash.erases, (unsigned int)res.flash.inline_erases,
+            (unsigned int)res.flash.max_erase_us, (unsigned int)res.flash.max_write_us,
+            (unsigned int)throughput_kbps);
+    if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
+        ws_send_control(response, strlen(response));
+    }
+
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 闪存录音上传任务
+ * @param arg 上传地址 (strdup, 任务结束时释放)
+ */
+static void upload_recording_task(void *arg)
+{
+    char *url = (char *)arg;
+    size_t uploaded = 0;
+    esp_err_t ret = audio_recorder_upload(url, &uploaded);
+    free(url);
+
+    char response[160];
+    snprintf(response, sizeof(response),
+            "{\"event\":\"upload_recording_result\",\"data\":{\"status\":\"%s\",\"error\":\"%s\",\"bytes\":%u}}",
+            (ret == ESP_OK) ? "ok" : "fail", esp_err_to_name(ret), (unsigned int)uploaded);
+    if (s_ws_client != NULL && esp_websocket_client_is_connected(s_ws_client)) {
+        ws_send_control(response, strlen(response));
+    }
+
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 读取 JSON 数值字段, 不存在时返回默认值
+ */
+static float json_get_float(cJSON *obj, const char *key, float def)
+{
+    cJSON *item = cJSON_GetObjectItem(obj, key);
+    return cJSON_IsNumber(item) ? (float)item->valuedouble : def;
+}
+
+/**
+ * @brief 处理播放 DSP 参数设置事件
+ * @param data_obj {"bands":[{"type","freq","q","gain"}], "compressor":{...}, "limiter":{...}}, 各部分均可省略
+ * @return ESP_OK成功，其他失败
+ */
+static esp_err_t handle_set_eq(cJSON *data_obj)
+{
+#if CONFIG_AUDIO_DSP_ENABLE
+    static const char *const eq_types[] = { "peak", "low_shelf", "high_shelf", "high_pass", "low_pass" };
+    esp_err_t ret = ESP_OK;
+    
+    if (!cJSON_IsObject(data_obj)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    cJSON *bands_obj = cJSON_GetObjectItem(data_obj, "bands");
+    if (cJSON_IsArray(bands_obj)) {
+        audio_dsp_eq_band_t bands[AUDIO_DSP_MAX_BANDS];
+        int count = cJSON_GetArraySize(bands_obj);
+        if (count > AUDIO_DSP_MAX_BANDS) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        for (int i = 0; i < count; i++) {
+            cJSON *band = cJSON_GetArrayItem(bands_obj, i);
+            cJSON *type_obj = cJSON_GetObjectItem(band, "type");
+            bands[i].type = AUDIO_DSP_EQ_PEAK;
+            for (int t = 0; cJSON_IsString(type_obj) && t < sizeof(eq_types) / sizeof(eq_types[0]); t++) {
+                if (strcmp(type_obj->valuestring, eq_types[t]) == 0) {
+                    bands[i].type = (audio_dsp_eq_type_t)t;
+                }
+            }
+            bands[i].freq_hz = json_get_float(band, "freq", 1000.0f);
+            bands[i].q = json_get_float(band, "q", 0.707f);
+            bands[i].gain_db = json_get_float(band, "gain", 0.0f);
+        }
+        ret = audio_dsp_set_eq(bands, count);
+    }
+    
+    cJSON *comp_obj = cJSON_GetObjectItem(data_obj, "compressor");
+    if (ret == ESP_OK && cJSON_IsObject(comp_obj)) {
+        const audio_dsp_compressor_t comp = {
+            .enable = !cJSON_IsFalse(cJSON_GetObjectItem(comp_obj, "enable")),
+            .threshold_db = json_get_float(comp_obj, "threshold", BOARD_AUDIO_COMP_THRESHOLD_DB),
+            .ratio = json_get_float(comp_obj, "ratio", BOARD_AUDIO_COMP_RATIO),
+            .knee_db = json_get_float(comp_obj, "knee", BOARD_AUDIO_COMP_KNEE_DB),
+            .attack_ms = json_get_float(comp_obj, "attack", BOARD_AUDIO_COMP_ATTACK_MS),
+            .release_ms = json_get_float(comp_obj, "release", BOARD_AUDIO_COMP_RELEASE_MS),
+            .makeup_db = json_get_float(comp_obj, "makeup", BOARD_AUDIO_COMP_MAKEUP_DB),
+        };
+        ret = audio_dsp_set_compressor(&comp);
+    }
+    
+    cJSON *limit_obj = cJSON_GetObjectItem(data_obj, "limiter");
+    if (ret == ESP_OK && cJSON_IsObject(limit_obj)) {
+        const audio_dsp_limiter_t limiter = {
+            .enable = !cJSON_IsFalse(cJSON_GetObjectItem(limit_obj, "enable")),
+            .ceiling_db = json_get_float(limit_obj, "ceiling", BOARD_AUDIO_LIMIT_CEILING_DB),
+            .release_ms = json_get_float(limit_obj, "release", BOARD_AUDIO_LIMIT_RELEASE_MS),
+        };
+        ret = audio_dsp_set_limiter(&limiter);
+    }
+    
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/**
+ * @brief 处理合成提示音事件
+ * @param data_obj {"name"} 播放内置提示音, 或完整描述
+ *                 {"wave","volume","attack","decay","sustain","release","notes":[[freq,ms],...]}
+ * @return ESP_OK成功，其他失败
+ */
+static esp_err_t handle_play_earcon(cJSON *data_obj)
+{
+    static const char *const waves[] = { "sine", "square", "triangle" };
+    
+    if (!cJSON_IsObject(data_obj)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    cJSON *name_obj = cJSON_GetObjectItem(data_obj, "name");
+    cJSON *notes_obj = cJSON_GetObjectItem(data_obj, "notes");
+    if (!cJSON_IsArray(notes_obj)) {
+        const audio_earcon_t *earcon = cJSON_IsString(name_obj) ? audio_synth_find(name_obj->valuestring) : NULL;
+        return earcon ? play_earcon(earcon) : ESP_ERR_NOT_FOUND;
+    }
+    
+    audio_earcon_t earcon = {
+        .name = cJSON_IsString(name_obj) ? name_obj->valuestring : "server",
+        .wave = AUDIO_SYNTH_WAVE_SINE,
+        .volume = (uint8_t)fminf(fmaxf(json_get_float(data_obj, "volume", 70), 0), 100),
+        .attack_ms = (uint16_t)fminf(fmaxf(json_get_float(data_obj, "attack", 5), 0), 2000),
+        .decay_ms = (uint16_t)fminf(fmaxf(json_get_float(data_obj, "decay", 60), 0), 2000),
+        .sustain = (uint8_t)fminf(fmaxf(json_get_float(data_obj, "sustain", 60), 0), 100),
+        .release_ms = (uint16_t)fminf(fmaxf(json_get_float(data_obj, "release", 40), 0), 2000),
+    };
+    cJSON *wave_obj = cJSON_GetObjectItem(data_obj, "wave");
+    for (int w = 0; cJSON_IsString(wave_obj) && w < sizeof(waves) / sizeof(waves[0]); w++) {
+        if (strcmp(wave_obj->valuestring, waves[w]) == 0) {
+            earcon.wave = (audio_synth_wave_t)w;
+        }
+    }
+    
+    int count = cJSON_GetArraySize(notes_obj);
+    if (count > AUDIO_SYNTH_MAX_NOTES) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (int i = 0; i < count; i++) {
+        cJSON *note = cJSON_GetArrayItem(notes_obj, i);
+        cJSON *freq_obj = cJSON_GetArrayItem(note, 0);
+        cJSON *ms_obj = cJSON_GetArrayItem(note, 1);
+        if (!cJSON_IsNumber(freq_obj) || !cJSON_IsNumber(ms_obj) ||
+            freq_obj->valueint < 0 || ms_obj->valueint < 0 ||
+            freq_obj->valueint > UINT16_MAX || ms_obj->valueint > UINT16_MAX) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        earcon.notes[i].freq_hz = (uint16_t)freq_obj->valueint;
+        earcon.notes[i].duration_ms = (uint16_t)ms_obj->valueint;
+    }
+    earcon.note_count = (uint8_t)count;
+    
+    // 其余参数范围由 audio_synth_play 校验
+    return play_earcon(&earcon);
+}
+
+/**
+ * @brief 执行一条服务器命令 (命令任务中调用, 可以阻塞)
+ */
+static void ws_handle_command(const char *msg, int len)
+{
+    ESP_LOGI(TAG, "收到数据: %.*s", len, msg);
+
+    // 使用cJSON解析
+    cJSON *root = cJSON_ParseWithLength(msg, len);
+
+    if (root) {
+        // 获取event字段
+        cJSON *event = cJSON_GetObjectItem(root, "event");
+        // 获取data字段
+        cJSON *data_obj = cJSON_GetObjectItem(root, "data");
+
+        if (cJSON_IsString(event) && event->valuestring != NULL) {
+            ESP_LOGI(TAG, "收到事件: %s", event->valuestring);
+
+            // 处理录音事件
+            if (strcmp(event->valuestring, "start_recording") == 0) {
+                // 默认录音时长为5秒
+                int duration = 5;
+
+                // 从data字段获取参数
+                if (data_obj && cJSON_IsObject(data_obj)) {
+                    cJSON *duration_obj = cJSON_GetObjectItem(data_obj, "duration");
+                    if (cJSON_IsNumber(duration_obj)) {
+                        duration = duration_obj->valueint;
+                        if (duration < 1) duration = 1;
+                        if (duration > 60) duration = 60; // 限制最大时长
+                    }
+                }
+
+                ESP_LOGI(TAG, "开始录音，时长: %d秒", duration);
+                int granted = 0;
+                esp_err_t rec_ret = start_audio_recording(duration, &granted);
+
+                // 发送确认消息; 缓冲区池预算不足时明确返回缩短或拒绝
+                char response[192];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"recording_started\",\"data\":{\"status\":\"%s\",\"requested\":%d,"
+                        "\"duration\":%d,\"error\":\"%s\"}}",
+                        rec_ret == ESP_OK ? "ok" : (rec_ret == ESP_ERR_INVALID_SIZE ? "shortened" : "rejected"),
+                        duration, granted, esp_err_to_name(rec_ret));
+                ws_send_control(response, strlen(response));
+            }
+            // 处理重启事件
+            else if (strcmp(event->valuestring, "restart") == 0) {
+                ESP_LOGW(TAG, "收到重启命令，设备将在3秒后重启");
+
+                // 发送确认消息
+                ws_send_control("{\"event\":\"restart_ack\",\"data\":{\"status\":\"ok\"}}", -1);
+                vTaskDelay(pdMS_TO_TICKS(3000));
+                esp_restart();
+            }
+            // 处理播放PCM文件事件
+            else if (strcmp(event->valuestring, "play_pcm") == 0) {
+                // 默认播放欢迎提示音
+                int pcm_id = AUDIO_ASSET_WELCOME;
+                const char *pcm_name = NULL;
+
+                // 从data字段获取参数, "name" 优先于 "id"
+                if (data_obj && cJSON_IsObject(data_obj)) {
+                    cJSON *id_obj = cJSON_GetObjectItem(data_obj, "id");
+                    cJSON *name_obj = cJSON_GetObjectItem(data_obj, "name");
+                    if (cJSON_IsString(name_obj) && name_obj->valuestring != NULL) {
+                        pcm_name = name_obj->valuestring;
+                    } else if (cJSON_IsNumber(id_obj)) {
+                        pcm_id = id_obj->valueint;
+                    }
+                }
+
+                // 播放指定PCM文件
+                esp_err_t ret;
+                if (pcm_name != NULL) {
+                    ESP_LOGI(TAG, "收到播放PCM命令，名称: %s", pcm_name);
+                    ret = play_pcm_by_name(pcm_name, &pcm_id);
+                } else {
+                    ESP_LOGI(TAG, "收到播放PCM命令，ID: %d", pcm_id);
+                    ret = play_pcm_by_id(pcm_id);
+                }
+
+                // 发送播放结果
+                char response[128];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"play_pcm_result\",\"data\":{\"id\":%d,\"status\":\"%s\"}}", 
+                        pcm_id, (ret == ESP_OK) ? "ok" : "fail");
+                ws_send_control(response, strlen(response));
+            }
+            // 处理提示音资源更新事件
+            else if (strcmp(event->valuestring, "update_assets") == 0) {
+                cJSON *url_obj = data_obj ? cJSON_GetObjectItem(data_obj, "url") : NULL;
+                char *url = cJSON_IsString(url_obj) ? strdup(url_obj->valuestring) : NULL;
+
+                // 下载耗时较长, 在独立任务中进行, 不阻塞WebSocket事件处理
+                if (url == NULL || xTaskCreate(assets_update_task, "assets_update", 
+                                               4096, url, 4, NULL) != pdPASS) {
+                    free(url);
+                    ws_send_control("{\"event\":\"update_assets_result\",\"data\":{\"status\":\"fail\"}}", -1);
+                }
+            }
+            // 处理音频片段缓存事件
+            else if (strcmp(event->valuestring, "cache_audio") == 0) {
+                cJSON *url_obj = data_obj ? cJSON_GetObjectItem(data_obj, "url") : NULL;
+                cJSON *hash_obj = data_obj ? cJSON_GetObjectItem(data_obj, "hash") : NULL;
+                cJSON *rate_obj = data_obj ? cJSON_GetObjectItem(data_obj, "sample_rate") : NULL;
+                cache_audio_req_t *req = calloc(1, sizeof(cache_audio_req_t));
+
+                if (req != NULL && cJSON_IsString(url_obj)) {
+                    req->url = strdup(url_obj->valuestring);
+                    req->sample_rate = (cJSON_IsNumber(rate_obj) && rate_obj->valueint > 0) ?
+                                       (uint32_t)rate_obj->valueint : 0;
+                    // 提供 hash 时已缓存的片段不会重复下载
+                    req->has_hash = cJSON_IsString(hash_obj) &&
+                                    audio_cache_hash_from_hex(hash_obj->valuestring, req->hash) == ESP_OK;
+                }
+                if (req == NULL || req->url == NULL || xTaskCreate(cache_audio_task, "cache_audio", 
+                                                                   4096, req, 4, NULL) != pdPASS) {
+                    if (req != NULL) {
+                        free(req->url);
+                        free(req);
+                    }
+                    ws_send_control("{\"event\":\"cache_audio_result\",\"data\":{\"status\":\"fail\"}}", -1);
+                }
+            }
+            // 处理播放缓存片段事件
+            else if (strcmp(event->valuestring, "play_cached") == 0) {
+                cJSON *hash_obj = data_obj ? cJSON_GetObjectItem(data_obj, "hash") : NULL;
+                uint8_t hash[AUDIO_CACHE_HASH_LEN];
+                esp_err_t ret = ESP_ERR_INVALID_ARG;
+
+                if (cJSON_IsString(hash_obj) &&
+                    audio_cache_hash_from_hex(hash_obj->valuestring, hash) == ESP_OK) {
+                    if (s_tx_handle != NULL) {
+                        s_system_state = SYSTEM_STATE_PLAYING;
+                        ret = audio_cache_play(s_tx_handle, hash);
+                        s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
+                    }
+                }
+
+                // 发送播放结果, 未缓存时返回 miss, 服务器应先发送 cache_audio
+                char response[192];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"play_cached_result\",\"data\":{\"hash\":\"%.64s\",\"status\":\"%s\"}}", 
+                        cJSON_IsString(hash_obj) ? hash_obj->valuestring : "", 
+                        (ret == ESP_OK) ? "ok" : (ret == ESP_ERR_NOT_FOUND) ? "miss" : "fail");
+                ws_send_control(response, strlen(response));
+            }
+            // 处理音频流播放事件
+            else if (strcmp(event->valuestring, "play_url") == 0) {
+                cJSON *url_obj = data_obj ? cJSON_GetObjectItem(data_obj, "url") : NULL;
+                cJSON *offset_obj = data_obj ? cJSON_GetObjectItem(data_obj, "offset") : NULL;
+                play_url_req_t *req = NULL;
+
+                if (cJSON_IsString(url_obj) && !audio_stream_is_active()) {
+                    req = calloc(1, sizeof(play_url_req_t));
+                }
+                if (req != NULL) {
+                    req->url = strdup(url_obj->valuestring);
+                    // 定位播放: 起始字节偏移
+                    req->offset = (cJSON_IsNumber(offset_obj) && offset_obj->valuedouble > 0) ? 
+                                  (size_t)offset_obj->valuedouble : 0;
+                }
+                if (req == NULL || req->url == NULL || xTaskCreate(play_url_task, "play_url", 
+                                                                   4096, req, 4, NULL) != pdPASS) {
+                    if (req != NULL) {
+                        free(req->url);
+                        free(req);
+                    }
+                    ws_send_control("{\"event\":\"play_url_result\",\"data\":{\"status\":\"fail\"}}", -1);
+                }
+            }
+            // 处理停止音频流事件
+            else if (strcmp(event->valuestring, "stop_url") == 0) {
+                audio_stream_stop();
+            }
+            // 处理播放 DSP 参数设置事件
+            else if (strcmp(event->valuestring, "set_eq") == 0) {
+                esp_err_t ret = handle_set_eq(data_obj);
+
+                char response[128];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"set_eq_result\",\"data\":{\"status\":\"%s\",\"error\":\"%s\"}}", 
+                        (ret == ESP_OK) ? "ok" : "fail", esp_err_to_name(ret));
+                ws_send_control(response, strlen(response));
+            }
+            // 处理合成提示音事件
+            else if (strcmp(event->valuestring, "play_earcon") == 0) {
+                esp_err_t ret = handle_play_earcon(data_obj);
+
+                char response[128];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"play_earcon_result\",\"data\":{\"status\":\"%s\",\"error\":\"%s\"}}", 
+                        (ret == ESP_OK) ? "ok" : "fail", esp_err_to_name(ret));
+                ws_send_control(response, strlen(response));
+            }
+            // 处理采样率切换事件 (如语音会话 16kHz, 音乐 48kHz)
+            else if (strcmp(event->valuestring, "set_sample_rate") == 0) {
+                cJSON *rate_obj = data_obj ? cJSON_GetObjectItem(data_obj, "rate") : NULL;
+                esp_err_t ret = cJSON_IsNumber(rate_obj) ? 
+                                board_audio_set_sample_rate((uint32_t)rate_obj->valueint) : ESP_ERR_INVALID_ARG;
+
+                char response[160];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"set_sample_rate_result\",\"data\":{\"rate\":%u,\"status\":\"%s\",\"error\":\"%s\"}}", 
+                        (unsigned int)board_audio_get_sample_rate(), (ret == ESP_OK) ? "ok" : "fail", 
+                        esp_err_to_name(ret));
+                ws_send_control(response, strlen(response));
+            }
+            // 处理 DMA 时延档位切换事件
+            else if (strcmp(event->valuestring, "set_dma_profile") == 0) {
+                cJSON *profile_obj = data_obj ? cJSON_GetObjectItem(data_obj, "profile") : NULL;
+                board_audio_dma_profile_t profile = cJSON_IsString(profile_obj) ?
+                                board_audio_dma_profile_from_name(profile_obj->valuestring) : BOARD_AUDIO_DMA_PROFILE_MAX;
+                esp_err_t ret = board_audio_set_dma_profile(profile, &s_tx_handle, &s_rx_handle);
+
+                board_audio_dma_stats_t st;
+                board_audio_get_dma_stats(board_audio_get_dma_profile(), &st);
+                char response[192];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"set_dma_profile_result\",\"data\":{\"profile\":\"%s\",\"status\":\"%s\",\"error\":\"%s\",\"buffer_us\":%u}}", 
+                        st.name, (ret == ESP_OK) ? "ok" : "fail", esp_err_to_name(ret), 
+                        (unsigned int)st.buffer_latency_us);
+                ws_send_control(response, strlen(response));
+            }
+            // 处理 DMA 档位遥测查询事件
+            else if (strcmp(event->valuestring, "get_dma_stats") == 0) {
+                send_dma_stats();
+            }
+            // 处理监听 (侧音) 启动事件, 已在监听时只修改增益
+            else if (strcmp(event->valuestring, "monitor_start") == 0) {
+                float gain_db = json_get_float(data_obj, "gain", BOARD_AUDIO_MONITOR_GAIN_DB);
+                esp_err_t ret = ESP_OK;
+                if (audio_monitor_is_active()) {
+                    audio_monitor_set_gain(gain_db);
+                } else {
+                    ret = audio_monitor_start(&s_tx_handle, &s_rx_handle, gain_db);
+                }
+
+                audio_monitor_stats_t stats;
+                audio_monitor_get_stats(&stats);
+                char response[160];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"monitor_start_result\",\"data\":{\"status\":\"%s\",\"error\":\"%s\",\"buffer_us\":%u}}", 
+                        (ret == ESP_OK) ? "ok" : "fail", esp_err_to_name(ret), 
+                        (unsigned int)stats.buffer_latency_us);
+                ws_send_control(response, strlen(response));
+            }
+            // 处理监听停止事件
+            else if (strcmp(event->valuestring, "monitor_stop") == 0) {
+                audio_monitor_stats_t stats;
+                audio_monitor_get_stats(&stats);
+                esp_err_t ret = audio_monitor_stop();
+
+                char response[224];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"monitor_stop_result\",\"data\":{\"status\":\"%s\",\"blocks\":%u,"
+                        "\"capture_overruns\":%u,\"remote_underruns\":%u,\"max_process_us\":%u}}", 
+                        (ret == ESP_OK) ? "ok" : "fail", (unsigned int)stats.blocks, 
+                        (unsigned int)stats.capture_overruns, (unsigned int)stats.remote_underruns, 
+                        (unsigned int)stats.max_process_us);
+                ws_send_control(response, strlen(response));
+            }
+            // 处理监听回环时延测试事件 (需要喇叭声音能传到麦克风)
+            else if (strcmp(event->valuestring, "monitor_test") == 0) {
+                int count = (int)json_get_float(data_obj, "count", 5);
+                count = count < 1 ? 1 : (count > 20 ? 20 : count);
+                if (xTaskCreate(monitor_test_task, "monitor_test", 4096, 
+                                (void *)(intptr_t)count, 4, NULL) != pdPASS) {
+                    ws_send_control("{\"event\":\"monitor_test_result\",\"data\":{\"status\":\"fail\"}}", -1);
+                }
+            }
+            // 处理零拷贝对比测试事件 (48kHz 立体声 CPU 占用)
+            else if (strcmp(event->valuestring, "capture_bench") == 0) {
+                int seconds = (int)json_get_float(data_obj, "seconds", 3);
+                seconds = seconds < 1 ? 1 : (seconds > 10 ? 10 : seconds);
+                if (xTaskCreate(capture_bench_task, "capture_bench", 4096, 
+                                (void *)(intptr_t)seconds, 4, NULL) != pdPASS) {
+                    ws_send_control("{\"event\":\"capture_bench_result\",\"data\":{\"status\":\"fail\"}}", -1);
+                }
+            }
+            // 处理缓冲区池统计查询事件
+            else if (strcmp(event->valuestring, "get_pool_stats") == 0) {
+                audio_pool_stats_t st;
+                audio_pool_get_stats(&st);
+                char response[384];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"get_pool_stats_result\",\"data\":{\"block_size\":%u,\"total_blocks\":%u,"
+                        "\"free_blocks\":%u,\"high_water_blocks\":%u,\"largest_free_run\":%u,"
+                        "\"fragmentation_pct\":%u,\"allocs\":%u,\"shortened\":%u,\"rejected\":%u,"
+                        "\"dma_total_blocks\":%u,\"dma_free_blocks\":%u,\"dma_high_water_blocks\":%u,"
+                        "\"dma_rejected\":%u}}", 
+                        (unsigned int)st.block_size, st.total_blocks, st.free_blocks, st.high_water_blocks,
+                        st.largest_free_run, st.fragmentation_pct, (unsigned int)st.allocs,
+                        (unsigned int)st.shortened, (unsigned int)st.rejected, st.dma_total_blocks,
+                        st.dma_free_blocks, st.dma_high_water_blocks, (unsigned int)st.dma_rejected);
+                ws_send_control(response, strlen(response));
+            }
+            // 处理分块上传确认事件 (离线录音队列)
+            else if (strcmp(event->valuestring, "upload_ack") == 0 || 
+                     strcmp(event->valuestring, "upload_nack") == 0) {
+                cJSON *id_obj = data_obj ? cJSON_GetObjectItem(data_obj, "id") : NULL;
+                cJSON *offset_obj = data_obj ? cJSON_GetObjectItem(data_obj, "offset") : NULL;
+                if (cJSON_IsNumber(id_obj) && cJSON_IsNumber(offset_obj) && offset_obj->valuedouble >= 0) {
+                    audio_outbox_on_ack((uint32_t)id_obj->valuedouble, (size_t)offset_obj->valuedouble,
+                                        strcmp(event->valuestring, "upload_nack") == 0);
+                }
+            }
+            // 处理离线录音队列统计查询事件
+            else if (strcmp(event->valuestring, "get_outbox_stats") == 0) {
+                audio_outbox_stats_t st;
+                audio_outbox_get_stats(&st);
+                char response[384];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"get_outbox_stats_result\",\"data\":{\"queued\":%u,\"queued_bytes\":%u,"
+                        "\"enqueued\":%u,\"uploaded\":%u,\"uploaded_bytes\":%u,\"evicted\":%u,"
+                        "\"rejected\":%u,\"retries\":%u,\"retransmitted_bytes\":%u,\"nacks\":%u,"
+                        "\"ack_timeouts\":%u,\"resumes\":%u,\"upload_kbps\":%u}}", 
+                        st.queued, (unsigned int)st.queued_bytes, (unsigned int)st.enqueued,
+                        (unsigned int)st.uploaded, (unsigned int)st.uploaded_bytes,
+                        (unsigned int)st.evicted, (unsigned int)st.rejected, (unsigned int)st.retries,
+                        (unsigned int)st.retransmitted_bytes, (unsigned int)st.nacks,
+                        (unsigned int)st.ack_timeouts, (unsigned int)st.resumes,
+                        (unsigned int)st.upload_kbps);
+                ws_send_control(response, strlen(response));
+            }
+            // 处理连接指标查询事件
+            else if (strcmp(event->valuestring, "get_ws_stats") == 0) {
+                ws_conn_stats_t st;
+                ws_endpoint_set_t eps;
+                uint32_t scores[WS_ENDPOINT_MAX];
+                ws_conn_get_stats(&st);
+                ws_endpoint_get_stats(&eps, scores);
+                char response[1024];
+                int n = snprintf(response, sizeof(response),
+                        "{\"event\":\"get_ws_stats_result\",\"data\":{\"connects\":%u,\"reconnects\":%u,"
+                        "\"disconnects\":%u,\"failed_attempts\":%u,\"failures\":%u,\"idle_timeouts\":%u,"
+                        "\"last_backoff_ms\":%u,\"last_reconnect_ms\":%u,\"max_reconnect_ms\":%u,"
+                        "\"avg_reconnect_ms\":%u,\"ping_sec\":%u,\"ping_good_sec\":%u,\"ping_fail_sec\":%u,"
+                        "\"endpoint\":%u,\"failovers\":%u,\"failbacks\":%u,\"endpoints\":[",
+                        (unsigned int)st.connects, (unsigned int)st.reconnects, (unsigned int)st.disconnects,
+                        (unsigned int)st.failed_attempts, (unsigned int)st.failures,
+                        (unsigned int)st.idle_timeouts, (unsigned int)st.last_backoff_ms,
+                        (unsigned int)st.last_reconnect_ms, (unsigned int)st.max_reconnect_ms,
+                        (unsigned int)(st.reconnects ? st.total_reconnect_ms / st.reconnects : 0),
+                        st.ping_sec, st.ping_good_sec, st.ping_fail_sec,
+                        eps.current, (unsigned int)eps.failovers, (unsigned int)eps.failbacks);
+                for (int i = 0; i < eps.count && n < (int)sizeof(response); i++) {
+                    const ws_endpoint_t *ep = &eps.ep[i];
+                    n += snprintf(response + n, sizeof(response) - n,
+                            "%s{\"score_ms\":%u,\"handshake_ms\":%u,\"probe_ms\":%u,\"rtt_ms\":%u,\"connects\":%u,"
+                            "\"failures\":%u}",
+                            i ? "," : "", (unsigned int)scores[i], (unsigned int)ep->handshake_ms,
+                            (unsigned int)ep->probe_ms, (unsigned int)ep->rtt_ms, (unsigned int)ep->connects,
+                            (unsigned int)ep->total_failures);
+                }
+                if (n < (int)sizeof(response)) {
+                    n += snprintf(response + n, sizeof(response) - n, "]");
+                }
+                esp_websocket_tls_stats_t tls;
+                if (n < (int)sizeof(response) && esp_websocket_client_get_tls_stats(s_ws_client, &tls) == ESP_OK) {
+                    n += snprintf(response + n, sizeof(response) - n,
+                            ",\"tls\":{\"last_ms\":%d,\"last_session\":%s,\"full\":%u,\"session\":%u,\"failed\":%u,"
+                            "\"full_avg_ms\":%u,\"session_avg_ms\":%u,\"cached\":%u}",
+                            tls.last_handshake_ms, tls.last_session_offered ? "true" : "false",
+                            (unsigned int)tls.full_handshakes, (unsigned int)tls.session_handshakes,
+                            (unsigned int)tls.failed,
+                            (unsigned int)(tls.full_handshakes ? tls.full_ms_total / tls.full_handshakes : 0),
+                            (unsigned int)(tls.session_handshakes ? tls.session_ms_total / tls.session_handshakes : 0),
+                            (unsigned int)tls.sessions_cached);
+                }
+                if (n < (int)sizeof(response)) {
+                    snprintf(response + n, sizeof(response) - n, "}}");
+                }
+                ws_send_control(response, strlen(response));
+            }
+            // 处理闪存录音事件 (录音长度不受 PSRAM 限制)
+            else if (strcmp(event->valuestring, "record_to_flash") == 0) {
+                cJSON *codec_obj = data_obj ? cJSON_GetObjectItem(data_obj, "codec") : NULL;
+                int seconds = (int)json_get_float(data_obj, "duration", 10);
+#ifdef CONFIG_AUDIO_RECORDER_ADPCM
+                audio_flash_log_codec_t codec = AUDIO_FLASH_LOG_CODEC_IMA_ADPCM;
+#else
+                audio_flash_log_codec_t codec = AUDIO_FLASH_LOG_CODEC_PCM;
+#endif
+                if (cJSON_IsString(codec_obj)) {
+                    codec = strcmp(codec_obj->valuestring, "pcm") == 0 ? 
+                            AUDIO_FLASH_LOG_CODEC_PCM : AUDIO_FLASH_LOG_CODEC_IMA_ADPCM;
+                }
+                seconds = seconds < 1 ? 1 : (seconds > 3600 ? 3600 : seconds);
+                // 超过分区容量的请求直接拒绝, 不先擦除再缩短
+                uint32_t max_seconds = audio_recorder_max_seconds(codec);
+                if (max_seconds > 0 && (uint32_t)seconds > max_seconds) {
+                    char response[160];
+                    snprintf(response, sizeof(response),
+                            "{\"event\":\"record_to_flash_result\",\"data\":{\"status\":\"fail\","
+                            "\"error\":\"ESP_ERR_INVALID_SIZE\",\"max_seconds\":%u}}", (unsigned int)max_seconds);
+                    ws_send_control(response, strlen(response));
+                } else if (audio_recorder_is_active() || 
+                    xTaskCreate(record_to_flash_task, "record_flash", 4096, 
+                                (void *)(intptr_t)((seconds << 1) | codec), 4, NULL) != pdPASS) {
+                    ws_send_control("{\"event\":\"record_to_flash_result\",\"data\":{\"status\":\"fail\"}}", -1);
+                }
+            }
+            // 处理提前结束闪存录音事件
+            else if (strcmp(event->valuestring, "record_stop") == 0) {
+                audio_recorder_stop();
+            }
+            // 处理闪存录音信息查询事件
+            else if (strcmp(event->valuestring, "get_recording_info") == 0) {
+                audio_flash_log_header_t hdr;
+                esp_err_t ret = audio_recorder_get_info(&hdr);
+                char response[384];
+                snprintf(response, sizeof(response), 
+                        "{\"event\":\"get_recording_info_result\",\"data\":{\"status\":\"%s\","
+                        "\"active\":%s,\"codec\":\"%s\",\"sequence\":%u,\"sample_rate\":%u,"
+                        "\"channels\":%u,\"frames\":%u,\"data_size\":%u,\"dropped_frames\":%u,"
+                        "\"dma_dropped_frames\":%u,\"max_seconds_pcm\":%u,\"max_seconds_adpcm\":%u}}", 
+                        (ret == ESP_OK) ? "ok" : "empty", audio_recorder_is_active() ? "true" : "false",
+                        (ret == ESP_OK && hdr.codec == AUDIO_FLASH_LOG_CODEC_PCM) ? "pcm" : "adpcm",
+                        ret == ESP_OK ? (unsigned int)hdr.sequence : 0,
+                        ret == ESP_OK ? (unsigned int)hdr.sample_rate : 0,
+                        ret == ESP_OK ? (unsigned int)hdr.channels : 0,
+                        ret == ESP_OK ? (unsigned int)hdr.frames : 0,
+                        ret == ESP_OK ? (unsigned int)hdr.data_size : 0,
+                        ret == ESP_OK ? (unsigned int)hdr.dropped_frames : 0,
+                        ret == ESP_OK ? (unsigned int)hdr.dma_dropped_frames : 0,
+                        (unsigned int)audio_recorder_max_seconds(AUDIO_FLASH_LOG_CODEC_PCM),
+                        (unsigned int)audio_recorder_max_seconds(AUDIO_FLASH_LOG_CODEC_IMA_ADPCM));
+                ws_send_control(response, strlen(response));
+            }
+            // 处理闪存录音上传事件
+            else if (strcmp(event->valuestring, "upload_recording") == 0) {
+                cJSON *url_obj = data_obj ? cJSON_GetObjectItem(data_obj, "url") : NULL;
+                char *url = cJSON_IsString(url_obj) ? strdup(url_obj->valuestring) : NULL;
+                if (url == NULL || xTaskCreate(upload_recording_task, "upload_rec", 4096, 
+                                               url, 4, NULL) != pdPASS) {
+                    free(url);
+                    ws_send_control("{\"event\":\"upload_recording_result\",\"data\":{\"status\":\"fail\"}}", -1);
+                }
+            }
+            // 处理其他事件...
+        } else {
+            ESP_LOGW(TAG, "收到的JSON数据中没有有效的event字段");
+        }
+
+        cJSON_Delete(root);
+    } else {
+        ESP_LOGW(TAG, "收到无效的JSON格式数据");
+    }
+}
+
+/**
+ * @brief 收到的数据消息 (WebSocket 任务中直接调用, 不经过事件循环)
+ * @details 只接收文本消息 (客户端已重组为完整消息); 二进制消息由 ws_binary_sink() 接收, PING/PONG/CLOSE 帧
+ *          只用于记录连接活动. 不能阻塞: 复制到命令缓冲区后立即返回, 命令由 ws_command_task() 执行.
+ */
+static void ws_data_handler(void *arg, const esp_websocket_event_data_t *data)
+{
+    ws_conn_note_rx();
+    if (data->op_code == 0x0A) {
+        int rtt_ms = esp_websocket_client_get_ping_rtt_ms(s_ws_client);
+        if (rtt_ms >= 0) {
+            portENTER_CRITICAL(&s_ws_conn_lock);
+            ws_endpoint_on_rtt(&s_ws_endpoints, (uint32_t)rtt_ms);
+            portEXIT_CRITICAL(&s_ws_conn_lock);
+        }
+        return;
+    }
+    if (data->op_code != 0x01 || data->data_len <= 0) {
+        return;
+    }
+    if (xMessageBufferSend(s_ws_cmd_buf, data->data_ptr, data->data_len, 0) == 0) {
+        ESP_LOGW(TAG, "命令缓冲区已满，丢弃 %d 字节的消息", data->data_len);
+    }
+}
+
+/**
+ * @brief 让命令任务播放提示音 (WebSocket 任务中调用, 不阻塞)
+ * @details 与服务器命令进入同一个缓冲区, 因此先于之后收到的命令播放
+ */
+static void ws_post_earcon(int earcon_id)
+{
+    const uint8_t cmd[2] = { WS_CMD_LOCAL_EARCON, (uint8_t)earcon_id };
+    if (xMessageBufferSend(s_ws_cmd_buf, cmd, sizeof(cmd), 0) == 0) {
+        ESP_LOGW(TAG, "命令缓冲区已满，跳过提示音 %d", earcon_id);
+    }
+}
+
+/**
+ * @brief 命令任务: 按收到的顺序执行服务器命令和本地命令, 不占用 WebSocket 任务
+ * @details 服务器的文本消息是 JSON, 不会以 WS_CMD_LOCAL_EARCON 开头
+ */
+static void ws_command_task(void *arg)
+{
+    static char msg[BOARD_WS_RX_MESSAGE_MAX];
+    while (1) {
+        size_t len = xMessageBufferReceive(s_ws_cmd_buf, msg, sizeof(msg), portMAX_DELAY);
+        if (len == 2 && msg[0] == WS_CMD_LOCAL_EARCON) {
+            play_pcm_by_id((uint8_t)msg[1]);
+        } else if (len > 0) {
+            ws_handle_command(msg, (int)len);
+        }
+    }
+}
+
 /**
  * @brief WebSocket事件处理函数
+ * @details 只处理连接状态等生命周期事件; 数据由 ws_data_handler() 和 ws_binary_sink() 直接接收
  */
 static void websocket_event_handler(void *handler_args, esp_event_base_t base, 
                                   int32_t event_id, void *event_data)
@@ -324,13 +1529,42 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base,
     esp_websocket_event_data_t *data = (esp_websocket_event_data_t *)event_data;
     
     switch (event_id) {
-        case WEBSOCKET_EVENT_CONNECTED:
-            ESP_LOGI(TAG, "WebSocket 已连接");
+        case WEBSOCKET_EVENT_BEFORE_CONNECT:
+            portENTER_CRITICAL(&s_ws_conn_lock);
+            s_ws_connect_start_ms = ws_conn_now_ms();
+            portEXIT_CRITICAL(&s_ws_conn_lock);
+            break;
+
+        case WEBSOCKET_EVENT_CONNECTED: {
+            portENTER_CRITICAL(&s_ws_conn_lock);
+            uint32_t now = ws_conn_now_ms();
+            uint32_t handshake_ms = now - s_ws_connect_start_ms;
+            ws_conn_on_connected(&s_ws_conn, now);
+            ws_endpoint_on_connected(&s_ws_endpoints, handshake_ms);
+            int endpoint = s_ws_endpoints.current;
+            uint16_t ping_sec = ws_conn_ping_sec(&s_ws_conn);
+            uint32_t reconnect_ms = s_ws_conn.stats.last_reconnect_ms;
+            bool reconnected = s_ws_conn.stats.reconnects > 0;
+            portEXIT_CRITICAL(&s_ws_conn_lock);
+            esp_websocket_client_set_ping_interval_sec(s_ws_client, ping_sec);
+            esp_websocket_tls_stats_t tls;
+            if (esp_websocket_client_get_tls_stats(s_ws_client, &tls) == ESP_OK) {
+                // 服务器是否接受了缓存的会话只能从耗时看出: 简短握手远快于完整握手
+                ESP_LOGI(TAG, "TLS 握手 %d ms (%s)", tls.last_handshake_ms,
+                         tls.last_session_offered ? "使用缓存会话" : "完整握手");
+            }
+            if (reconnected) {
+                ESP_LOGI(TAG, "WebSocket 已连接服务器 %d (握手 %" PRIu32 " ms, 断开 %" PRIu32 " ms, PING 间隔 %u 秒)",
+                         endpoint, handshake_ms, reconnect_ms, ping_sec);
+            } else {
+                ESP_LOGI(TAG, "WebSocket 已连接服务器 %d (握手 %" PRIu32 " ms, PING 间隔 %u 秒)",
+                         endpoint, handshake_ms, ping_sec);
+            }
             
             // 使用全局变量跟踪是否是首次连接
             if (first_connection) {
-                // 播放连接成功提示音
-                play_pcm_by_id(4);
+                // 播放连接成功提示音 (由命令任务播放, 不阻塞 WebSocket 任务)
+                ws_post_earcon(AUDIO_EARCON_CONNECTED);
                 first_connection = false;
             } else {
                 ESP_LOGI(TAG, "WebSocket 重新连接成功，跳过提示音播放");
@@ -344,14 +1578,46 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base,
             snprintf(connect_msg, sizeof(connect_msg), 
                     "{\"event\":\"device_connected\",\"data\":{\"clientId\":\"%s\",\"type\":\"esp32s3\"}}", 
                     BOARD_WS_DEVICE_CLIENT_ID);
-            esp_websocket_client_send_text(s_ws_client, connect_msg, strlen(connect_msg), portMAX_DELAY);
+            ws_send_control(connect_msg, strlen(connect_msg));
             
             // 更新系统状态
             s_system_state = SYSTEM_STATE_WS_CONNECTED;
+            
+            // 限速上传断开期间排队的录音
+            audio_outbox_resume(s_ws_client);
             break;
+        }
             
-        case WEBSOCKET_EVENT_DISCONNECTED:
-            ESP_LOGI(TAG, "WebSocket 已断开连接");
+        case WEBSOCKET_EVENT_DISCONNECTED: {
+            // 连接失败也会收到该事件; 客户端在本回调返回后按这里设置的等待时间重连
+            // 还有本轮未失败的服务器时很快切换过去, 都失败过才按退避等待.
+            // 探测任务请求的切回 (ws_endpoint_failback() 已改好当前服务器) 不计入失败, 立即连接
+            portENTER_CRITICAL(&s_ws_conn_lock);
+            uint32_t now = ws_conn_now_ms();
+            uint32_t backoff_ms = ws_conn_on_disconnected(&s_ws_conn, now);
+            uint32_t failures = s_ws_conn.stats.failures;
+            bool failback = s_ws_failback_pending;
+            s_ws_failback_pending = false;
+            int previous = s_ws_endpoints.current;
+            bool failover = false;
+            int next = previous;
+            if (!failback) {
+                next = ws_endpoint_on_failure(&s_ws_endpoints, now, &failover);
+            }
+            portEXIT_CRITICAL(&s_ws_conn_lock);
+            // 等待至少 1 ms: 客户端不接受 0, 会沿用上一次 (可能是退避上限) 的等待时间
+            if (failback) {
+                backoff_ms = 1;
+            } else if (failover) {
+                backoff_ms = 1 + esp_random() % BOARD_WS_FAILOVER_DELAY_MS;
+            }
+            if (failback || next != previous) {
+                ws_endpoint_apply(next);
+            }
+            esp_websocket_client_set_reconnect_timeout(s_ws_client, (int)backoff_ms);
+            ESP_LOGI(TAG, "WebSocket 已断开连接，%" PRIu32 " ms 后重连服务器 %d (连续失败 %" PRIu32 " 次)",
+                     backoff_ms, next, failures);
+            audio_outbox_pause(false);
             
             // 创建一个定时器，如果断开超过一定时间（例如30秒），则重置首次连接标志
             static TimerHandle_t reset_timer = NULL;
@@ -381,96 +1647,7 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base,
             // 恢复系统状态
             s_system_state = SYSTEM_STATE_WIFI_CONNECTED;
             break;
-            
-        case WEBSOCKET_EVENT_DATA:
-            // 处理收到的数据
-            if (data->data_len > 0) {
-                ESP_LOGI(TAG, "收到数据: %.*s", data->data_len, (char *)data->data_ptr);
-                
-                // 使用cJSON解析
-                cJSON *root = cJSON_Parse(data->data_ptr);
-                
-                if (root) {
-                    // 获取event字段
-                    cJSON *event = cJSON_GetObjectItem(root, "event");
-                    // 获取data字段
-                    cJSON *data_obj = cJSON_GetObjectItem(root, "data");
-                    
-                    if (cJSON_IsString(event) && event->valuestring != NULL) {
-                        ESP_LOGI(TAG, "收到事件: %s", event->valuestring);
-                        
-                        // 处理录音事件
-                        if (strcmp(event->valuestring, "start_recording") == 0) {
-                            // 默认录音时长为5秒
-                            int duration = 5;
-                            
-                            // 从data字段获取参数
-                            if (data_obj && cJSON_IsObject(data_obj)) {
-                                cJSON *duration_obj = cJSON_GetObjectItem(data_obj, "duration");
-                                if (cJSON_IsNumber(duration_obj)) {
-                                    duration = duration_obj->valueint;
-                                    if (duration < 1) duration = 1;
-                                    if (duration > 60) duration = 60; // 限制最大时长
-                                }
-                            }
-                            
-                            ESP_LOGI(TAG, "开始录音，时长: %d秒", duration);
-                            start_audio_recording(duration);
-                            
-                            // 发送确认消息
-                            char response[128];
-                            snprintf(response, sizeof(response), 
-                                    "{\"event\":\"recording_started\",\"data\":{\"duration\":%d}}", 
-                                    duration);
-                            esp_websocket_client_send_text(s_ws_client, response, strlen(response), portMAX_DELAY);
-                        }
-                        // 处理重启事件
-                        else if (strcmp(event->valuestring, "restart") == 0) {
-                            ESP_LOGW(TAG, "收到重启命令，设备将在3秒后重启");
-                            
-                            // 发送确认消息
-                            esp_websocket_client_send_text(s_ws_client, 
-                                "{\"event\":\"restart_ack\",\"data\":{\"status\":\"ok\"}}", 
-                                -1, portMAX_DELAY);
-                            vTaskDelay(pdMS_TO_TICKS(3000));
-                            esp_restart();
-                        }
-                        // 处理播放PCM文件事件
-                        else if (strcmp(event->valuestring, "play_pcm") == 0) {
-                            // 默认播放1.pcm
-                            int pcm_id = 1;
-                            
-                            // 从data字段获取参数
-                            if (data_obj && cJSON_IsObject(data_obj)) {
-                                cJSON *id_obj = cJSON_GetObjectItem(data_obj, "id");
-                                if (cJSON_IsNumber(id_obj)) {
-                                    pcm_id = id_obj->valueint;
-                                }
-                            }
-                            
-                            ESP_LOGI(TAG, "收到播放PCM命令，ID: %d", pcm_id);
-                            
-                            // 播放指定PCM文件
-                            esp_err_t ret = play_pcm_by_id(pcm_id);
-                            
-                            // 发送播放结果
-                            char response[128];
-                            snprintf(response, sizeof(response), 
-                                    "{\"event\":\"play_pcm_result\",\"data\":{\"id\":%d,\"status\":\"%s\"}}", 
-                                    pcm_id, (ret == ESP_OK) ? "ok" : "fail");
-                            esp_websocket_client_send_text(s_ws_client, response, strlen(response), portMAX_DELAY);
-                        }
-                        // 处理其他事件...
-                    } else {
-                        ESP_LOGW(TAG, "收到的JSON数据中没有有效的event字段");
-                    }
-                    
-                    cJSON_Delete(root);
-                } else {
-                    ESP_LOGW(TAG, "收到无效的JSON格式数据");
-                }
-            }
-            break;
+        }
             
         case WEBSOCKET_EVENT_ERROR:
             ESP_LOGE(TAG, "WebSocket 发生错误");
@@ -525,12 +1702,48 @@ static void init_websocket_connection(void)
     
     ESP_LOGI(TAG, "初始化WebSocket客户端...");
     
+    const ws_conn_config_t conn_cfg = {
+        .backoff_min_ms = BOARD_WS_BACKOFF_MIN_MS,
+        .backoff_max_ms = BOARD_WS_BACKOFF_MAX_MS,
+        .stable_ms = BOARD_WS_STABLE_MS,
+        .ping_min_sec = BOARD_WS_PING_MIN_SEC,
+        .ping_max_sec = BOARD_WS_PING_MAX_SEC,
+        .ping_probe_ms = BOARD_WS_PING_PROBE_MS,
+    };
+    const ws_endpoint_config_t endpoint_cfg = {
+        .unknown_ms = BOARD_WS_UNKNOWN_SCORE_MS,
+        .failure_penalty_ms = BOARD_WS_FAILURE_PENALTY_MS,
+        .failure_decay_ms = BOARD_WS_FAILURE_DECAY_MS,
+        .failback_margin_ms = BOARD_WS_FAILBACK_MARGIN_MS,
+    };
+    int endpoints = board_websocket_endpoint_count();
+    portENTER_CRITICAL(&s_ws_conn_lock);
+    ws_conn_init(&s_ws_conn, &conn_cfg, esp_random(), ws_conn_now_ms());
+    ws_endpoint_init(&s_ws_endpoints, endpoints, &endpoint_cfg);
+    s_ws_connect_start_ms = ws_conn_now_ms();
+    portEXIT_CRITICAL(&s_ws_conn_lock);
+    
+    // 命令任务只创建一次
+    if (s_ws_cmd_buf == NULL) {
+        s_ws_cmd_buf = xMessageBufferCreate(BOARD_WS_CMD_BUFFER_BYTES);
+        if (s_ws_cmd_buf == NULL || xTaskCreate(ws_command_task, "ws_command", BOARD_WS_CMD_TASK_STACK,
+                                                NULL, BOARD_WS_CMD_TASK_PRIO, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "创建命令任务失败");
+            return;
+        }
+    }
+    
     // 初始化WebSocket客户端
     esp_err_t ret = board_websocket_init(&s_ws_client, websocket_event_handler, NULL);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "初始化WebSocket客户端失败: %s", esp_err_to_name(ret));
         return;
     }
+    const esp_websocket_binary_sink_t sink = {
+        .on_data = ws_binary_sink,
+    };
+    esp_websocket_client_set_binary_sink(s_ws_client, &sink);
+    esp_websocket_client_set_data_handler(s_ws_client, ws_data_handler, NULL);
     
     // 启动WebSocket连接
     ret = board_websocket_start(s_ws_client);
@@ -538,6 +1751,15 @@ static void init_websocket_connection(void)
         ESP_LOGE(TAG, "启动WebSocket连接失败: %s", esp_err_to_name(ret));
         return;
     }
+
+    // 配置了备用服务器时在后台探测, 以便切回更好的服务器
+    if (endpoints > 1) {
+        ESP_LOGI(TAG, "共 %d 个WebSocket服务器，启用故障切换", endpoints);
+        if (xTaskCreate(ws_endpoint_probe_task, "ws_probe", BOARD_WS_PROBE_TASK_STACK, NULL,
+                        BOARD_WS_PROBE_TASK_PRIO, NULL) != pdPASS) {
+            ESP_LOGW(TAG, "创建服务器探测任务失败，不会自动切回主服务器");
+        }
+    }
 }
 
 /**
@@ -561,6 +1783,38 @@ void app_main(void)
         return;
     }
     
+    // 启动时一次性切分音频缓冲区池, 之后录音和流播放都从池中借用
+    ret = audio_pool_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "音频缓冲区池初始化失败: %s", esp_err_to_name(ret));
+        // 不退出，录音和流播放将返回 ESP_ERR_INVALID_STATE
+    }
+    
+    // 加载提示音资源索引 (assets 分区)
+    ret = audio_assets_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "提示音资源不可用: %s", esp_err_to_name(ret));
+        // 不退出，可通过 update_assets 事件重新下载
+    }
+    
+    // 初始化音频片段缓存 (cache 分区)
+    ret = audio_cache_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "音频片段缓存初始化失败: %s", esp_err_to_name(ret));
+    }
+    
+    // 离线录音队列 (WebSocket 断开期间完成的录音)
+    ret = audio_outbox_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "离线录音队列不可用: %s", esp_err_to_name(ret));
+    }
+    
+    // 查找 record 分区 (闪存录音)
+    ret = audio_recorder_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "闪存录音不可用: %s", esp_err_to_name(ret));
+    }
+    
     // I2C总线进行额外稳定等待
     vTaskDelay(pdMS_TO_TICKS(50));
     
@@ -649,7 +1903,7 @@ config_mode:
         
         // 播放进入配网模式提示音
         if (s_tx_handle != NULL) { // 确保播放设备已初始化
-            play_pcm_by_id(2);
+            play_pcm_by_id(AUDIO_EARCON_PROVISIONING);
         }
         
         s_system_state = SYSTEM_STATE_WIFI_CONFIG;
@@ -674,7 +1928,7 @@ config_mode:
                 // 配网完成，播放成功提示音
                 ESP_LOGI(TAG, "配网信息已保存");
                 if (s_tx_handle != NULL) { // 确保播放设备已初始化
-                     play_pcm_by_id(3);
+                     play_pcm_by_id(AUDIO_EARCON_CONFIG_SAVED);
                 }
 
                 // 重启设备
@@ -689,30 +1943,34 @@ config_mode:
         }
     }
     
-    // 主循环
+    // 主循环: 重连由 WebSocket 客户端按 ws_conn 的退避自行完成, 这里只定期输出连接指标
     while (1) {
-        // 根据当前系统状态执行不同的任务
-        switch (s_system_state) {
-            case SYSTEM_STATE_WIFI_CONNECTED:
-            case SYSTEM_STATE_WS_CONNECTED:
-                // 检查WebSocket连接状态
-                if (s_ws_client != NULL && !esp_websocket_client_is_connected(s_ws_client)) {
-                    ESP_LOGW(TAG, "WebSocket连接已断开，尝试重连");
-                    
-                    // 重新初始化WebSocket连接
-                    if (esp_websocket_client_destroy(s_ws_client) == ESP_OK) {
-                        s_ws_client = NULL;
-                        vTaskDelay(pdMS_TO_TICKS(1000)); // 等待1秒
-                        init_websocket_connection();
-                    }
-                }
-                break;
-                
-            default:
-                break;
+        vTaskDelay(pdMS_TO_TICKS(BOARD_WS_STATS_LOG_MS));
+        if (s_ws_client == NULL) {
+            continue;
+        }
+        ws_conn_stats_t st;
+        ws_endpoint_set_t eps;
+        uint32_t scores[WS_ENDPOINT_MAX];
+        ws_conn_get_stats(&st);
+        ws_endpoint_get_stats(&eps, scores);
+        ESP_LOGI(TAG, "WebSocket 指标: %s, 连接 %" PRIu32 " 次, 断开 %" PRIu32 " 次, 失败 %" PRIu32 " 次, "
+                 "重连耗时 最近 %" PRIu32 " ms 最大 %" PRIu32 " ms, 空闲断开 %" PRIu32 " 次, PING 间隔 %u 秒",
+                 esp_websocket_client_is_connected(s_ws_client) ? "已连接" : "未连接",
+                 st.connects, st.disconnects, st.failed_attempts, st.last_reconnect_ms, st.max_reconnect_ms,
+                 st.idle_timeouts, st.ping_sec);
+        if (eps.count > 1) {
+            ESP_LOGI(TAG, "WebSocket 服务器: 当前 %u (分数 %" PRIu32 " ms), 故障切换 %" PRIu32 " 次, 切回 %" PRIu32 " 次",
+                     eps.current, scores[eps.current], eps.failovers, eps.failbacks);
+        }
+        esp_websocket_tls_stats_t tls;
+        if (esp_websocket_client_get_tls_stats(s_ws_client, &tls) == ESP_OK) {
+            ESP_LOGI(TAG, "WebSocket TLS: 完整握手 %" PRIu32 " 次 平均 %" PRIu32 " ms, 缓存会话握手 %" PRIu32 " 次 平均 %" PRIu32 " ms, "
+                     "失败 %" PRIu32 " 次, 缓存 %" PRIu32 " 个会话",
+                     tls.full_handshakes, (uint32_t)(tls.full_handshakes ? tls.full_ms_total / tls.full_handshakes : 0),
+                     tls.session_handshakes,
+                     (uint32_t)(tls.session_handshakes ? tls.session_ms_total / tls.session_handshakes : 0),
+                     tls.failed, tls.sessions_cached);
         }
-        
-        // 每秒检查一次系统状态
-        vTaskDelay(pdMS_TO_TICKS(1000));
     }
 } 
\ No newline at end of file
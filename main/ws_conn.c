@@ -0,0 +1,152 @@
+/**
+ * @file ws_conn.c
+ * @brief WebSocket 连接管理策略: 带抖动的指数退避、连接指标、随 NAT 自适应的 PING 间隔
+ */
+
+#include <string.h>
+#include "ws_conn.h"
+
+#define WS_CONN_IDLE_STRIKES    2       // 在已验证间隔上连续空闲断开这么多次后减半
+
+static uint32_t ws_conn_random(ws_conn_t *c)
+{
+    uint32_t x = c->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    c->rng = x;
+    return x;
+}
+
+static void ws_conn_set_ping(ws_conn_t *c, uint16_t sec, uint32_t now_ms)
+{
+    c->stats.ping_sec = sec;
+    c->probe_since_ms = now_ms;
+}
+
+void ws_conn_init(ws_conn_t *c, const ws_conn_config_t *cfg, uint32_t seed, uint32_t now_ms)
+{
+    memset(c, 0, sizeof(*c));
+    c->cfg = *cfg;
+    if (c->cfg.backoff_min_ms == 0) {
+        c->cfg.backoff_min_ms = 1;
+    }
+    if (c->cfg.backoff_max_ms < c->cfg.backoff_min_ms) {
+        c->cfg.backoff_max_ms = c->cfg.backoff_min_ms;
+    }
+    if (c->cfg.ping_min_sec == 0) {
+        c->cfg.ping_min_sec = 1;
+    }
+    if (c->cfg.ping_max_sec < c->cfg.ping_min_sec) {
+        c->cfg.ping_max_sec = c->cfg.ping_min_sec;
+    }
+    c->rng = seed ? seed : 0x9E3779B9u;
+    c->down_since_ms = now_ms;
+    ws_conn_set_ping(c, c->cfg.ping_min_sec, now_ms);
+}
+
+void ws_conn_on_connected(ws_conn_t *c, uint32_t now_ms)
+{
+    c->stats.connects++;
+    if (c->ever_connected) {
+        uint32_t dt = now_ms - c->down_since_ms;
+        c->stats.reconnects++;
+        c->stats.last_reconnect_ms = dt;
+        c->stats.total_reconnect_ms += dt;
+        if (dt > c->stats.max_reconnect_ms) {
+            c->stats.max_reconnect_ms = dt;
+        }
+    }
+    c->connected = true;
+    c->ever_connected = true;
+    c->connected_at_ms = now_ms;
+    c->last_rx_ms = now_ms;
+    c->probe_since_ms = now_ms;
+}
+
+/* 连接在空闲中断开: 最后一次收到数据已超过一个 PING 间隔, 调整 PING 间隔 */
+static void ws_conn_on_idle_timeout(ws_conn_t *c, uint32_t now_ms)
+{
+    ws_conn_stats_t *s = &c->stats;
+    s->idle_timeouts++;
+    if (s->ping_sec <= c->cfg.ping_min_sec) {
+        return;
+    }
+    if (s->ping_good_sec == 0 || s->ping_sec > s->ping_good_sec) {
+        // 探测中的间隔不可用: 记下并退回已验证的间隔
+        if (s->ping_fail_sec == 0 || s->ping_sec < s->ping_fail_sec) {
+            s->ping_fail_sec = s->ping_sec;
+        }
+        c->idle_strikes = 0;
+        ws_conn_set_ping(c, s->ping_good_sec ? s->ping_good_sec : c->cfg.ping_min_sec, now_ms);
+        return;
+    }
+    // 已验证的间隔也开始失败: 网络变了, 减半后重新探测
+    if (++c->idle_strikes >= WS_CONN_IDLE_STRIKES) {
+        uint16_t sec = s->ping_sec / 2 > c->cfg.ping_min_sec ? s->ping_sec / 2 : c->cfg.ping_min_sec;
+        s->ping_fail_sec = s->ping_sec;
+        s->ping_good_sec = 0;
+        c->idle_strikes = 0;
+        ws_conn_set_ping(c, sec, now_ms);
+    }
+}
+
+uint32_t ws_conn_on_disconnected(ws_conn_t *c, uint32_t now_ms)
+{
+    ws_conn_stats_t *s = &c->stats;
+    if (c->connected) {
+        s->disconnects++;
+        if (now_ms - c->connected_at_ms >= c->cfg.stable_ms) {
+            s->failures = 0;
+        }
+        if (now_ms - c->last_rx_ms >= (uint32_t)s->ping_sec * 1000) {
+            ws_conn_on_idle_timeout(c, now_ms);
+        }
+        c->connected = false;
+        c->down_since_ms = now_ms;
+    } else {
+        s->failed_attempts++;
+    }
+    s->failures++;
+
+    uint32_t level = s->failures - 1;
+    uint32_t cap = c->cfg.backoff_max_ms;
+    if (level < 32 && c->cfg.backoff_min_ms <= (c->cfg.backoff_max_ms >> level)) {
+        cap = c->cfg.backoff_min_ms << level;
+    }
+    s->last_backoff_ms = cap / 2 + ws_conn_random(c) % (cap - cap / 2 + 1);
+    return s->last_backoff_ms;
+}
+
+bool ws_conn_on_rx(ws_conn_t *c, uint32_t now_ms)
+{
+    ws_conn_stats_t *s = &c->stats;
+    c->last_rx_ms = now_ms;
+    if (!c->connected || s->ping_sec >= c->cfg.ping_max_sec || now_ms - c->probe_since_ms < c->cfg.ping_probe_ms) {
+        return false;
+    }
+    // 当前间隔保持了一个探测周期: 记为可用, 延长一半, 不超过最大值和失败间隔的 3/4
+    if (s->ping_sec > s->ping_good_sec) {
+        s->ping_good_sec = s->ping_sec;
+    }
+    c->idle_strikes = 0;
+    uint32_t next = s->ping_sec + (s->ping_sec + 1) / 2;
+    if (next > c->cfg.ping_max_sec) {
+        next = c->cfg.ping_max_sec;
+    }
+    if (s->ping_fail_sec && next > (uint32_t)s->ping_fail_sec * 3 / 4) {
+        next = (uint32_t)s->ping_fail_sec * 3 / 4;
+    }
+    if (next <= s->ping_sec) {
+        // 已收敛, 下个探测周期再看 (失败间隔可能因减半重新探测而变化)
+        c->probe_since_ms = now_ms;
+        return false;
+    }
+    ws_conn_set_ping(c, (uint16_t)next, now_ms);
+    return true;
+}
+
+uint16_t ws_conn_ping_sec(const ws_conn_t *c)
+{
+    return c->stats.ping_sec;
+}
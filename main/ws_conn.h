@@ -0,0 +1,109 @@
+/**
+ * @file ws_conn.h
+ * @brief WebSocket 连接管理策略: 带抖动的指数退避、连接指标、随 NAT 自适应的 PING 间隔
+ * @details WebSocket 客户端自己负责重连 (auto_reconnect), 本模块只决定每次重连前等多久和 PING 间隔:
+ *          - 退避: 连续失败 n 次后的等待在 [cap/2, cap] 内随机取值, cap = min(最大值, 最小值 * 2^(n-1)).
+ *            服务器重启时大量设备同时断开, 随机等待把重连分散开, 避免同一时刻一齐握手 (重连风暴).
+ *            连接保持 stable_ms 以上再断开才把失败计数清零, 握手成功后立即被断开 (服务器过载、鉴权失败)
+ *            仍按失败退避.
+ *          - PING: 从最短间隔开始; 当前间隔稳定 ping_probe_ms 后延长一半, 直到最大值. 延长后在空闲中断开
+ *            (最后一次收到数据已超过一个 PING 间隔, 说明 PING 没有得到回应, 通常是 NAT 映射过期) 时,
+ *            记下该间隔, 退回已验证可用的间隔, 以后不超过失败间隔的 3/4. 在已验证的间隔上连续两次空闲断开
+ *            (换了网络, NAT 超时变短) 则减半重新探测.
+ *          - 指标: 连接、断开、失败次数, 重连耗时 (最近、最大、平均), 空闲断开次数, 当前 PING 间隔.
+ *
+ *          时间均为毫秒, 由调用方传入 (允许回绕). 不依赖 FreeRTOS 和 WebSocket, 可在主机上模拟断线验证
+ *          (tools/ws_host/ws_conn_soak.c). 不加锁, 由调用方保护.
+ */
+
+#ifndef _WS_CONN_H_
+#define _WS_CONN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 策略参数
+ */
+typedef struct {
+    uint32_t backoff_min_ms;        // 第一次重连的等待上限
+    uint32_t backoff_max_ms;        // 等待上限的最大值
+    uint32_t stable_ms;             // 连接保持这么久后断开, 退避从头开始
+    uint16_t ping_min_sec;          // 初始 (最短) PING 间隔
+    uint16_t ping_max_sec;          // 最长 PING 间隔, 等于 ping_min_sec 时不自适应
+    uint32_t ping_probe_ms;         // 当前间隔稳定这么久后尝试延长
+} ws_conn_config_t;
+
+/**
+ * @brief 连接指标
+ */
+typedef struct {
+    uint32_t connects;              // 连接成功次数
+    uint32_t reconnects;            // 断开后重新连上的次数
+    uint32_t disconnects;           // 已建立的连接断开的次数
+    uint32_t failed_attempts;       // 连接失败次数 (未完成握手)
+    uint32_t failures;              // 当前连续失败次数 (退避级数)
+    uint32_t idle_timeouts;         // 空闲中断开的次数 (疑似 NAT 映射过期)
+    uint32_t last_backoff_ms;       // 最近一次重连前的等待
+    uint32_t last_reconnect_ms;     // 最近一次从断开到重新连上的时间
+    uint32_t max_reconnect_ms;
+    uint64_t total_reconnect_ms;    // 平均重连时间 = total_reconnect_ms / reconnects
+    uint16_t ping_sec;              // 当前 PING 间隔
+    uint16_t ping_good_sec;         // 已验证可用的最长间隔, 0 表示未知
+    uint16_t ping_fail_sec;         // 空闲断开过的最短间隔, 0 表示未知
+} ws_conn_stats_t;
+
+/**
+ * @brief 连接管理状态
+ */
+typedef struct {
+    ws_conn_config_t cfg;
+    ws_conn_stats_t stats;
+    bool connected;
+    bool ever_connected;
+    uint32_t rng;                   // 抖动用的 xorshift32 状态
+    uint32_t connected_at_ms;
+    uint32_t down_since_ms;         // 断开 (或开始连接) 的时间
+    uint32_t last_rx_ms;            // 最后一次收到数据 (含 PONG) 的时间
+    uint32_t probe_since_ms;        // 当前 PING 间隔开始生效的时间
+    uint8_t idle_strikes;           // 在已验证间隔上连续空闲断开的次数
+} ws_conn_t;
+
+/**
+ * @brief 初始化
+ * @param seed 抖动的随机种子, 每台设备应不同 (如 esp_random())
+ * @param now_ms 开始连接的时间
+ */
+void ws_conn_init(ws_conn_t *c, const ws_conn_config_t *cfg, uint32_t seed, uint32_t now_ms);
+
+/**
+ * @brief 连接建立 (握手完成)
+ */
+void ws_conn_on_connected(ws_conn_t *c, uint32_t now_ms);
+
+/**
+ * @brief 连接断开或连接失败, 计算下次重连前的等待
+ * @return 等待时间 (毫秒)
+ */
+uint32_t ws_conn_on_disconnected(ws_conn_t *c, uint32_t now_ms);
+
+/**
+ * @brief 收到数据或 PONG
+ * @return true PING 间隔延长了, 调用方应使用 ws_conn_ping_sec() 的新值
+ */
+bool ws_conn_on_rx(ws_conn_t *c, uint32_t now_ms);
+
+/**
+ * @brief 当前应使用的 PING 间隔 (秒)
+ */
+uint16_t ws_conn_ping_sec(const ws_conn_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _WS_CONN_H_ */
@@ -0,0 +1,171 @@
+/**
+ * @file ws_endpoint.c
+ * @brief WebSocket 多服务器端点的健康评分与故障切换
+ */
+
+#include <string.h>
+#include "ws_endpoint.h"
+
+/* 指数加权平均, 新样本占 1/4 */
+static uint32_t ws_endpoint_ewma(uint32_t avg, uint32_t sample)
+{
+    if (sample == 0) {
+        sample = 1;                 // 0 表示未测
+    }
+    return avg == 0 ? sample : avg - avg / 4 + sample / 4;
+}
+
+/* 按经过的时间衰减近期失败次数 */
+static uint32_t ws_endpoint_failures(const ws_endpoint_set_t *set, const ws_endpoint_t *ep, uint32_t now_ms)
+{
+    if (ep->failures == 0 || set->cfg.failure_decay_ms == 0) {
+        return ep->failures;
+    }
+    uint32_t halvings = (now_ms - ep->failure_ms) / set->cfg.failure_decay_ms;
+    return halvings >= 32 ? 0 : ep->failures >> halvings;
+}
+
+static void ws_endpoint_add_failure(ws_endpoint_set_t *set, ws_endpoint_t *ep, uint32_t now_ms)
+{
+    ep->failures = ws_endpoint_failures(set, ep, now_ms) + 1;
+    ep->failure_ms = now_ms;
+    ep->total_failures++;
+}
+
+void ws_endpoint_init(ws_endpoint_set_t *set, int count, const ws_endpoint_config_t *cfg)
+{
+    memset(set, 0, sizeof(*set));
+    set->cfg = *cfg;
+    set->count = count < 1 ? 1 : count > WS_ENDPOINT_MAX ? WS_ENDPOINT_MAX : count;
+}
+
+/* 只探测过的端点估计握手时间: 探测时间 * 两项都测过的端点的 握手/探测 比例, 没有时按 WS_ENDPOINT_HANDSHAKE_PROBES 倍 */
+static uint32_t ws_endpoint_estimate_handshake(const ws_endpoint_set_t *set, uint32_t probe_ms)
+{
+    uint64_t handshake = 0, probe = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (set->ep[i].handshake_ms && set->ep[i].probe_ms) {
+            handshake += set->ep[i].handshake_ms;
+            probe += set->ep[i].probe_ms;
+        }
+    }
+    if (probe == 0) {
+        return probe_ms * WS_ENDPOINT_HANDSHAKE_PROBES;
+    }
+    uint64_t estimate = probe_ms * handshake / probe;
+    return estimate > UINT32_MAX / 2 ? UINT32_MAX / 2 : (uint32_t)estimate;
+}
+
+uint32_t ws_endpoint_score(const ws_endpoint_set_t *set, int index, uint32_t now_ms)
+{
+    const ws_endpoint_t *ep = &set->ep[index];
+    uint32_t latency;
+    if (ep->handshake_ms) {
+        latency = ep->handshake_ms;
+    } else if (ep->probe_ms) {
+        latency = ws_endpoint_estimate_handshake(set, ep->probe_ms);
+    } else {
+        latency = set->cfg.unknown_ms;
+    }
+    return latency + ws_endpoint_failures(set, ep, now_ms) * set->cfg.failure_penalty_ms;
+}
+
+/* 切回比较用的分数: 探测时间 + 近期失败, 所有端点用同一种测量; 未测或最近一次探测失败时返回 0 */
+static uint32_t ws_endpoint_probe_score(const ws_endpoint_set_t *set, int index, uint32_t now_ms)
+{
+    const ws_endpoint_t *ep = &set->ep[index];
+    if (!ep->probe_ok || ep->probe_ms == 0) {
+        return 0;
+    }
+    return ep->probe_ms + ws_endpoint_failures(set, ep, now_ms) * set->cfg.failure_penalty_ms;
+}
+
+/* 分数最好的端点, 跳过 mask 中的端点; 都被跳过时返回 -1 */
+static int ws_endpoint_best(const ws_endpoint_set_t *set, uint8_t mask, uint32_t now_ms)
+{
+    int best = -1;
+    uint32_t best_score = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (mask & (1u << i)) {
+            continue;
+        }
+        uint32_t score = ws_endpoint_score(set, i, now_ms);
+        if (best < 0 || score < best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+void ws_endpoint_on_connected(ws_endpoint_set_t *set, uint32_t handshake_ms)
+{
+    ws_endpoint_t *ep = &set->ep[set->current];
+    ep->handshake_ms = ws_endpoint_ewma(ep->handshake_ms, handshake_ms);
+    ep->connects++;
+    set->failed_mask = 0;
+}
+
+void ws_endpoint_on_rtt(ws_endpoint_set_t *set, uint32_t rtt_ms)
+{
+    ws_endpoint_t *ep = &set->ep[set->current];
+    ep->rtt_ms = ws_endpoint_ewma(ep->rtt_ms, rtt_ms);
+}
+
+int ws_endpoint_on_failure(ws_endpoint_set_t *set, uint32_t now_ms, bool *failover)
+{
+    ws_endpoint_add_failure(set, &set->ep[set->current], now_ms);
+    set->failed_mask |= 1u << set->current;
+
+    int next = ws_endpoint_best(set, set->failed_mask, now_ms);
+    *failover = next >= 0;
+    if (next < 0) {
+        // 本轮都失败过: 留在分数最好的端点退避, 然后开始新的一轮
+        next = ws_endpoint_best(set, 0, now_ms);
+        set->failed_mask = 0;
+    } else {
+        set->failovers++;
+    }
+    set->current = (uint8_t)next;
+    return next;
+}
+
+void ws_endpoint_on_probe(ws_endpoint_set_t *set, int index, uint32_t now_ms, bool ok, uint32_t connect_ms)
+{
+    ws_endpoint_t *ep = &set->ep[index];
+    ep->probe_ok = ok;
+    if (!ok) {
+        ws_endpoint_add_failure(set, ep, now_ms);
+        return;
+    }
+    ep->probe_ms = ws_endpoint_ewma(ep->probe_ms, connect_ms);
+    // 恢复的证据: 近期失败减半, 几次成功的探测后即可切回
+    ep->failures = ws_endpoint_failures(set, ep, now_ms) / 2;
+    ep->failure_ms = now_ms;
+}
+
+int ws_endpoint_failback(ws_endpoint_set_t *set, uint32_t now_ms)
+{
+    // 当前端点的握手 (可能含 TLS) 与其他端点的 TCP 连接时间不可比, 只比较同一轮的探测时间
+    uint32_t current = ws_endpoint_probe_score(set, set->current, now_ms);
+    if (current == 0) {
+        return -1;
+    }
+    int best = -1;
+    uint32_t score = 0;
+    for (int i = 0; i < set->count; i++) {
+        uint32_t s = i == set->current ? 0 : ws_endpoint_probe_score(set, i, now_ms);
+        if (s && (best < 0 || s < score)) {
+            best = i;
+            score = s;
+        }
+    }
+    uint32_t margin = set->cfg.failback_margin_ms + current / 8;
+    if (best < 0 || score + margin > current) {
+        return -1;
+    }
+    set->current = (uint8_t)best;
+    set->failed_mask = 0;
+    set->failbacks++;
+    return best;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file ws_endpoint.h
+ * @brief WebSocket 多服务器端点的健康评分与故障切换
+ * @details 三种测量分开保存 (指数加权平均), 只和同类测量比较:
+ *          - 握手时间: 从开始连接到 CONNECTED 的时间 (TCP 连接 + TLS 握手 + HTTP 升级), 连上过的端点才有
+ *          - 探测时间: 后台探测的 TCP 连接时间, 所有端点 (包括当前端点) 每轮各测一次
+ *          - PING 往返时间: 只有当前连接有, 只用于统计, 不参与评分
+ *          - 近期失败: 连接失败、断开、探测失败各计一次, 每过 failure_decay_ms 减半, 探测成功也减半
+ *          分数 (毫秒, 越小越好) = 握手时间 + 近期失败次数 * failure_penalty_ms. 没连上过的端点按探测时间估计握手时间:
+ *          乘以握手和探测都测过的端点的 握手/探测 比例 (没有时按 WS_ENDPOINT_HANDSHAKE_PROBES 倍), 都没测过时按
+ *          unknown_ms. 分数相同时排在前面的端点 (主服务器) 优先.
+ *
+ *          切换:
+ *          - 故障切换: 当前端点断开或连接失败时, 换到本轮还没失败过的端点中分数最好的一个, 由调用方在很短的
+ *            等待后连接; 所有端点本轮都失败过时留在分数最好的端点, 由调用方按退避等待, 然后开始新的一轮.
+ *          - 切回: 只比较探测时间 + 近期失败 (当前端点也要探测成功): 其他端点比当前端点好 failback_margin_ms
+ *            和当前值的 1/8 以上时, 换到该端点.
+ *
+ *          时间均为毫秒, 由调用方传入 (允许回绕). 不依赖 FreeRTOS 和 WebSocket, 可在主机上用多个本地服务器验证
+ *          (tools/ws_host/ws_failover_check.c). 不加锁, 由调用方保护.
+ */
+
+#ifndef _WS_ENDPOINT_H_
+#define _WS_ENDPOINT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WS_ENDPOINT_MAX     4
+#define WS_ENDPOINT_HANDSHAKE_PROBES    2   // 没有比例时握手时间按探测时间的几倍估计 (TCP 连接 + HTTP 升级)
+
+/**
+ * @brief 评分参数
+ */
+typedef struct {
+    uint32_t unknown_ms;            // 没有任何测量时的分数
+    uint32_t failure_penalty_ms;    // 每次近期失败加的分数
+    uint32_t failure_decay_ms;      // 近期失败次数减半的时间
+    uint32_t failback_margin_ms;    // 切回要求的最小分数差
+} ws_endpoint_config_t;
+
+/**
+ * @brief 单个端点的健康状况
+ */
+typedef struct {
+    uint32_t handshake_ms;          // 握手时间, 0 表示未测
+    uint32_t probe_ms;              // 探测 (TCP 连接) 时间, 0 表示未测
+    uint32_t rtt_ms;                // PING 往返时间 (只用于统计), 0 表示未测
+    uint32_t failures;              // 近期失败次数
+    uint32_t failure_ms;            // 最后一次失败 (或减半) 的时间
+    bool probe_ok;                  // 最近一次探测成功
+    uint32_t connects;              // 连接成功次数
+    uint32_t total_failures;        // 失败总次数 (含探测)
+} ws_endpoint_t;
+
+/**
+ * @brief 端点集合
+ */
+typedef struct {
+    ws_endpoint_config_t cfg;
+    ws_endpoint_t ep[WS_ENDPOINT_MAX];
+    uint8_t count;
+    uint8_t current;                // 当前 (或下一次连接的) 端点
+    uint8_t failed_mask;            // 本轮失败过的端点
+    uint32_t failovers;             // 断开后换到其他端点的次数
+    uint32_t failbacks;             // 探测后换到更好端点的次数
+} ws_endpoint_set_t;
+
+/**
+ * @brief 初始化, 从第 0 个端点开始
+ * @param count 端点数 (1 ~ WS_ENDPOINT_MAX)
+ */
+void ws_endpoint_init(ws_endpoint_set_t *set, int count, const ws_endpoint_config_t *cfg);
+
+/**
+ * @brief 端点的当前分数 (越小越好)
+ */
+uint32_t ws_endpoint_score(const ws_endpoint_set_t *set, int index, uint32_t now_ms);
+
+/**
+ * @brief 连接到当前端点
+ * @param handshake_ms 从开始连接到连接建立的时间
+ */
+void ws_endpoint_on_connected(ws_endpoint_set_t *set, uint32_t handshake_ms);
+
+/**
+ * @brief 当前连接测得一次 PING 往返时间
+ */
+void ws_endpoint_on_rtt(ws_endpoint_set_t *set, uint32_t rtt_ms);
+
+/**
+ * @brief 当前端点断开或连接失败, 选择下一次连接的端点
+ * @param[out] failover true 换到了本轮未失败的端点, 应很快重连; false 本轮都已失败, 应按退避等待
+ * @return 下一次连接的端点
+ */
+int ws_endpoint_on_failure(ws_endpoint_set_t *set, uint32_t now_ms, bool *failover);
+
+/**
+ * @brief 后台探测端点的结果 (包括当前端点)
+ * @param connect_ms 探测连接耗时 (成功时)
+ */
+void ws_endpoint_on_probe(ws_endpoint_set_t *set, int index, uint32_t now_ms, bool ok, uint32_t connect_ms);
+
+/**
+ * @brief 是否应切回更好的端点 (连接正常时, 一轮探测之后调用)
+ * @details 只比较探测时间, 当前端点和候选端点最近一次探测都要成功
+ * @return 要切换到的端点 (已设为当前端点), -1 表示留在当前端点
+ */
+int ws_endpoint_failback(ws_endpoint_set_t *set, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _WS_ENDPOINT_H_ */
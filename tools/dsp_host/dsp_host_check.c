@@ -0,0 +1,245 @@
+/**
+ * @file dsp_host_check.c
+ * @brief 播放 DSP 处理链主机验证与性能测试
+ * @details 在主机上编译 main/audio_dsp.c, 验证:
+ *          1. EQ 频率响应: 定点处理的正弦稳态增益与理论响应的误差
+ *          2. 限幅器: 超过上限的输入经处理后峰值不超过上限
+ *          3. 压缩器: 稳态增益衰减与软拐点静态曲线一致
+ *          4. 切换采样率: 参数保留, 响应按新采样率重新计算
+ *          并测量每帧处理耗时. 任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Itools/dsp_host/include -Imain tools/dsp_host/dsp_host_check.c main/audio_dsp.c -lm -o /tmp/dsp_host_check
+ *            /tmp/dsp_host_check
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "audio_dsp.h"
+
+#define FS          44100
+#define CH          2
+#define BLOCK       256
+
+static int s_failures = 0;
+static double s_fs = FS;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+/* 处理正弦信号, 返回稳态输出幅度 (dBFS) 和峰值 */
+static double run_sine(double freq, double amp_dbfs, double seconds, double *peak_out)
+{
+    static int16_t buf[BLOCK * CH];
+    double amp = pow(10.0, amp_dbfs / 20.0) * 32767.0;
+    size_t total = (size_t)(seconds * s_fs);
+    size_t settle = total / 2;
+    double sum = 0;
+    size_t count = 0;
+    int peak = 0;
+
+    audio_dsp_reset();
+    for (size_t n = 0; n < total; n += BLOCK) {
+        for (int i = 0; i < BLOCK; i++) {
+            int16_t v = (int16_t)lrint(amp * sin(2 * M_PI * freq * (double)(n + i) / s_fs));
+            buf[i * CH] = v;
+            buf[i * CH + 1] = v;
+        }
+        audio_dsp_process(buf, buf, BLOCK);
+        if (n >= settle) {
+            for (int i = 0; i < BLOCK * CH; i++) {
+                sum += (double)buf[i] * buf[i];
+                if (abs(buf[i]) > peak) {
+                    peak = abs(buf[i]);
+                }
+            }
+            count += BLOCK * CH;
+        }
+    }
+    if (peak_out) {
+        *peak_out = 20.0 * log10(peak / 32767.0);
+    }
+    // 正弦 RMS 转换为幅度
+    return 20.0 * log10(sqrt(2.0 * sum / count) / 32767.0);
+}
+
+static void test_eq_response(void)
+{
+    printf("EQ 频率响应 (高通 150Hz + 峰值 3kHz +6dB + 高架 8kHz -4dB):\n");
+    const audio_dsp_eq_band_t bands[] = {
+        { AUDIO_DSP_EQ_HIGH_PASS, 150.0f, 0.707f, 0.0f },
+        { AUDIO_DSP_EQ_PEAK, 3000.0f, 1.0f, 6.0f },
+        { AUDIO_DSP_EQ_HIGH_SHELF, 8000.0f, 0.707f, -4.0f },
+    };
+    audio_dsp_set_eq(bands, 3);
+    audio_dsp_set_compressor(&(audio_dsp_compressor_t){ .enable = false, .ratio = 1, .attack_ms = 1, .release_ms = 1 });
+    audio_dsp_set_limiter(&(audio_dsp_limiter_t){ .enable = false, .ceiling_db = 0, .release_ms = 1 });
+
+    const double freqs[] = { 50, 100, 150, 300, 1000, 2000, 3000, 5000, 8000, 12000, 16000 };
+    double max_err = 0;
+    printf("    频率(Hz)   理论(dB)   实测(dB)   误差(dB)\n");
+    for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        double expect = audio_dsp_eq_response_db(freqs[i]);
+        double got = run_sine(freqs[i], -20.0, 0.5, NULL) + 20.0;
+        double err = fabs(got - expect);
+        // 深度衰减的频点受 16 位量化噪声限制, 只要求足够低
+        if (expect > -30.0 && err > max_err) {
+            max_err = err;
+        }
+        printf("    %8.0f   %8.2f   %8.2f   %8.3f\n", freqs[i], expect, got, err);
+    }
+    char msg[64];
+    snprintf(msg, sizeof(msg), "最大误差 %.3f dB < 0.1 dB", max_err);
+    check(max_err < 0.1, msg);
+    audio_dsp_set_eq(NULL, 0);
+}
+
+static void test_limiter(void)
+{
+    printf("限幅器 (上限 -1 dBFS, EQ +12dB 低架推动到削波):\n");
+    const audio_dsp_eq_band_t boost = { AUDIO_DSP_EQ_LOW_SHELF, 1000.0f, 0.707f, 12.0f };
+    audio_dsp_set_eq(&boost, 1);
+    audio_dsp_set_limiter(&(audio_dsp_limiter_t){ .enable = true, .ceiling_db = -1.0f, .release_ms = 50.0f });
+
+    double peak;
+    run_sine(200, -3.0, 1.0, &peak);
+    audio_dsp_stats_t st;
+    audio_dsp_get_stats(&st);
+    char msg[96];
+    snprintf(msg, sizeof(msg), "输出峰值 %.2f dBFS <= -0.99 dBFS (最大衰减 %.1f dB)", peak, st.max_limit_reduction_db);
+    check(peak <= -0.99, msg);
+
+    // 短促的瞬态也必须被前瞻窗口捕获
+    static int16_t buf[BLOCK * CH];
+    audio_dsp_reset();
+    int out_peak = 0;
+    for (int blk = 0; blk < 8; blk++) {
+        for (int i = 0; i < BLOCK * CH; i++) {
+            buf[i] = (blk == 3 && i / CH == 100) ? 32767 : 0;
+        }
+        audio_dsp_process(buf, buf, BLOCK);
+        for (int i = 0; i < BLOCK * CH; i++) {
+            if (abs(buf[i]) > out_peak) {
+                out_peak = abs(buf[i]);
+            }
+        }
+    }
+    double ceiling = pow(10.0, -1.0 / 20.0) * 32767.0 + 1;
+    snprintf(msg, sizeof(msg), "单样本瞬态输出 %d <= %.0f", out_peak, ceiling);
+    check(out_peak <= ceiling, msg);
+
+    audio_dsp_set_eq(NULL, 0);
+    audio_dsp_set_limiter(&(audio_dsp_limiter_t){ .enable = false, .ceiling_db = 0, .release_ms = 1 });
+}
+
+static void test_compressor(void)
+{
+    printf("压缩器静态曲线 (阈值 -20 dBFS, 4:1, 拐点 6dB):\n");
+    const audio_dsp_compressor_t comp = {
+        .enable = true, .threshold_db = -20.0f, .ratio = 4.0f, .knee_db = 6.0f,
+        .attack_ms = 5.0f, .release_ms = 50.0f, .makeup_db = 0.0f,
+    };
+    audio_dsp_set_compressor(&comp);
+
+    const double levels[] = { -40, -23, -20, -17, -10, -3 };
+    double max_err = 0;
+    printf("    输入(dBFS)  理论(dBFS)  实测(dBFS)\n");
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        double in = levels[i];
+        double over = in - comp.threshold_db;
+        double slope = 1.0 / comp.ratio - 1.0;
+        double gr = 0;
+        if (2 * over >= comp.knee_db) {
+            gr = slope * over;
+        } else if (2 * over > -comp.knee_db) {
+            gr = slope * pow(over + comp.knee_db / 2, 2) / (2 * comp.knee_db);
+        }
+        double got = run_sine(1000, in, 1.0, NULL);
+        // 检波器取峰值, 正弦峰值即幅度
+        double err = fabs(got - (in + gr));
+        if (err > max_err) {
+            max_err = err;
+        }
+        printf("    %10.1f  %10.2f  %10.2f\n", in, in + gr, got);
+    }
+    char msg[64];
+    snprintf(msg, sizeof(msg), "最大误差 %.3f dB < 0.3 dB", max_err);
+    check(max_err < 0.3, msg);
+    audio_dsp_set_compressor(&(audio_dsp_compressor_t){ .enable = false, .ratio = 1, .attack_ms = 1, .release_ms = 1 });
+}
+
+static void test_sample_rate(void)
+{
+    printf("切换采样率 (44.1kHz -> 16kHz, 峰值 3kHz +6dB, 高架 12kHz 应被丢弃):\n");
+    const audio_dsp_eq_band_t bands[] = {
+        { AUDIO_DSP_EQ_PEAK, 3000.0f, 1.0f, 6.0f },
+        { AUDIO_DSP_EQ_HIGH_SHELF, 12000.0f, 0.707f, -6.0f },
+    };
+    audio_dsp_set_eq(bands, 2);
+    audio_dsp_set_sample_rate(16000);
+    s_fs = 16000;
+
+    double max_err = 0;
+    const double freqs[] = { 500, 3000, 6000 };
+    for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        double expect = audio_dsp_eq_response_db(freqs[i]);
+        double got = run_sine(freqs[i], -20.0, 0.5, NULL) + 20.0;
+        if (fabs(got - expect) > max_err) {
+            max_err = fabs(got - expect);
+        }
+    }
+    char msg[96];
+    snprintf(msg, sizeof(msg), "3kHz 理论 %.2f dB, 最大误差 %.3f dB < 0.1 dB",
+             audio_dsp_eq_response_db(3000), max_err);
+    check(max_err < 0.1 && fabs(audio_dsp_eq_response_db(3000) - 6.0) < 0.1, msg);
+
+    audio_dsp_set_sample_rate(FS);
+    s_fs = FS;
+    audio_dsp_set_eq(NULL, 0);
+}
+
+static void bench(void)
+{
+    printf("性能 (6 段 EQ + 压缩器 + 限幅器, 立体声):\n");
+    audio_dsp_eq_band_t bands[6];
+    for (int i = 0; i < 6; i++) {
+        bands[i] = (audio_dsp_eq_band_t){ AUDIO_DSP_EQ_PEAK, 100.0f * (1 << i), 1.0f, (i & 1) ? 3.0f : -3.0f };
+    }
+    audio_dsp_set_eq(bands, 6);
+    audio_dsp_set_compressor(&(audio_dsp_compressor_t){ .enable = true, .threshold_db = -18, .ratio = 3,
+                                                        .knee_db = 6, .attack_ms = 5, .release_ms = 80, .makeup_db = 4 });
+    audio_dsp_set_limiter(&(audio_dsp_limiter_t){ .enable = true, .ceiling_db = -1, .release_ms = 50 });
+
+    static int16_t buf[BLOCK * CH];
+    for (int i = 0; i < BLOCK * CH; i++) {
+        buf[i] = (int16_t)(rand() % 40000 - 20000);
+    }
+    const size_t frames = (size_t)FS * 60;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (size_t n = 0; n < frames; n += BLOCK) {
+        audio_dsp_process(buf, buf, BLOCK);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("  60 秒音频耗时 %.3f 秒, %.1f ns/帧, 实时倍数 %.0fx\n", sec, sec * 1e9 / frames, 60.0 / sec);
+}
+
+int main(void)
+{
+    audio_dsp_init(FS, CH);
+    test_eq_response();
+    test_limiter();
+    test_compressor();
+    test_sample_rate();
+    bench();
+    printf(s_failures ? "失败 %d 项\n" : "全部通过\n", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,4 @@
+/* 主机编译用的最小 esp_attr.h */
+#pragma once
+#define IRAM_ATTR
+#define DRAM_ATTR
@@ -0,0 +1,400 @@
+#!/usr/bin/env python3
+"""
+提示音资源生成脚本
+
+编译时由 main/CMakeLists.txt 调用:
+  1. 扫描 assets 目录, 读取 manifest.csv 中的元数据
+  2. 将 .wav / .pcm 源文件转换为设备原生格式 (16 位, 交织, BOARD 采样率)
+  3. 按门限 RMS 做响度归一化, 并限制峰值
+  4. 可选 IMA ADPCM 压缩 (左右声道相同时折叠为单声道存储)
+  5. 输出 assets 分区镜像 audio_assets.bin 以及 ID 常量头文件 audio_assets_gen.h
+
+分区镜像格式 (小端, 与 main/audio_assets.c 一致):
+  头部 32 字节   : magic 'ASET', version, count, sample_rate, channels, bit_width,
+                   adpcm_block_size, data_size, data_crc32, index_crc32, reserved
+  索引 count*44 : id, codec, channels, name[24], offset, size, frames, duration_ms
+  数据           : 各资源数据, 4 字节对齐, offset 相对分区起始
+
+任何与 I2S 配置不符且无法转换的源文件, 或超出分区大小的镜像, 都会让编译直接失败.
+"""
+
+import argparse
+import array
+import csv
+import math
+import os
+import re
+import struct
+import sys
+import wave
+import zlib
+
+ALIGN = 4                  # 每段资源在 bin 内按 4 字节对齐
+GATE_BLOCK_MS = 50         # 响度测量块长度
+GATE_THRESHOLD_DBFS = -50  # 低于该电平的块不参与响度测量 (静音门限)
+NAME_RE = re.compile(r'^[a-z][a-z0-9_]{0,22}$')
+
+IMAGE_MAGIC = 0x54455341   # 'ASET'
+IMAGE_VERSION = 1
+MAX_COUNT = 64             # 与 audio_assets.c 注册表容量一致 (索引须落在第一个扇区)
+HEADER_FMT = '<IHHIBBHIIII'
+ENTRY_FMT = '<HBB24sIIII'
+CODEC_IDS = {'pcm': 0, 'adpcm': 1}
+
+ADPCM_BLOCK_SIZE = 512     # 每通道 ADPCM 块字节数 (4 字节块头 + 压缩数据)
+ADPCM_INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+ADPCM_STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+
+
+def fail(msg):
+    sys.stderr.write('gen_audio_assets: error: %s\n' % msg)
+    sys.exit(1)
+
+
+def db_to_lin(db):
+    return 10.0 ** (db / 20.0)
+
+
+def lin_to_db(v):
+    return 20.0 * math.log10(v) if v > 0 else -200.0
+
+
+class Asset(object):
+    def __init__(self, asset_id, name, path, rate=0, channels=0, gain_db=0.0):
+        self.id = asset_id
+        self.name = name
+        self.path = path
+        self.rate = rate
+        self.channels = channels
+        self.gain_db = gain_db
+        self.data = b''
+        self.offset = 0
+        self.frames = 0
+        self.stored_channels = 0
+
+
+def load_manifest(assets_dir):
+    assets = []
+    path = os.path.join(assets_dir, 'manifest.csv')
+    if not os.path.exists(path):
+        return assets
+    with open(path, newline='') as f:
+        rows = [r for r in csv.reader(f) if r and not r[0].lstrip().startswith('#')]
+    for lineno, row in enumerate(rows, 1):
+        if len(row) != 6:
+            fail('manifest.csv 第 %d 条记录需要 6 列, 实际 %d 列' % (lineno, len(row)))
+        asset_id, name, filename, rate, channels, gain_db = [c.strip() for c in row]
+        assets.append(Asset(int(asset_id), name, os.path.join(assets_dir, filename),
+                            int(rate), int(channels), float(gain_db or 0)))
+    return assets
+
+
+def scan_assets(assets_dir):
+    assets = load_manifest(assets_dir)
+    listed = set(os.path.abspath(a.path) for a in assets)
+    next_id = max([a.id for a in assets] + [0]) + 1
+    for filename in sorted(os.listdir(assets_dir)):
+        path = os.path.abspath(os.path.join(assets_dir, filename))
+        if path in listed:
+            continue
+        base, ext = os.path.splitext(filename)
+        if ext.lower() == '.wav':
+            assets.append(Asset(next_id, base.lower().replace('-', '_'), path))
+            next_id += 1
+        elif ext.lower() == '.pcm':
+            fail('%s 没有文件头, 必须在 manifest.csv 中声明采样率和通道数' % filename)
+
+    ids, names = set(), set()
+    for a in assets:
+        if not 1 <= a.id <= 255:
+            fail('%s: ID %d 超出范围 (1-255)' % (a.name, a.id))
+        if not NAME_RE.match(a.name):
+            fail('非法资源名 "%s" (小写字母开头, 仅含 a-z0-9_, 最长 24 字符)' % a.name)
+        if a.id in ids or a.name in names:
+            fail('资源 ID %d / 名称 "%s" 重复' % (a.id, a.name))
+        if not os.path.exists(a.path):
+            fail('找不到资源文件 %s' % a.path)
+        ids.add(a.id)
+        names.add(a.name)
+    return assets
+
+
+def read_source(asset):
+    """读取源文件, 返回 (采样率, 通道数, 交织的浮点样本列表 [-1, 1))"""
+    if asset.path.lower().endswith('.wav'):
+        try:
+            with wave.open(asset.path, 'rb') as w:
+                rate, channels, width = w.getframerate(), w.getnchannels(), w.getsampwidth()
+                raw = w.readframes(w.getnframes())
+        except wave.Error as e:
+            fail('%s: 仅支持 PCM 格式的 WAV (%s)' % (asset.path, e))
+    else:
+        if asset.rate <= 0 or asset.channels <= 0:
+            fail('%s: manifest.csv 中缺少采样率或通道数' % asset.path)
+        rate, channels, width = asset.rate, asset.channels, 2
+        with open(asset.path, 'rb') as f:
+            raw = f.read()
+
+    if width == 1:
+        samples = [(b - 128) / 128.0 for b in raw]
+    elif width == 2:
+        pcm = array.array('h')
+        pcm.frombytes(raw[:len(raw) // 2 * 2])
+        if sys.byteorder != 'little':
+            pcm.byteswap()
+        samples = [s / 32768.0 for s in pcm]
+    elif width == 3:
+        samples = [int.from_bytes(raw[i:i + 3], 'little', signed=True) / 8388608.0
+                   for i in range(0, len(raw) - 2, 3)]
+    elif width == 4:
+        pcm = array.array('i')
+        pcm.frombytes(raw[:len(raw) // 4 * 4])
+        if sys.byteorder != 'little':
+            pcm.byteswap()
+        samples = [s / 2147483648.0 for s in pcm]
+    else:
+        fail('%s: 不支持的位宽 %d' % (asset.path, width * 8))
+    return rate, channels, samples[:len(samples) // channels * channels]
+
+
+def remix(samples, src_ch, dst_ch):
+    if src_ch == dst_ch:
+        return samples
+    frames = len(samples) // src_ch
+    mono = [sum(samples[i * src_ch:(i + 1) * src_ch]) / src_ch for i in range(frames)]
+    if dst_ch == 1:
+        return mono
+    return [s for s in mono for _ in range(dst_ch)]
+
+
+def resample(samples, channels, src_rate, dst_rate):
+    """线性插值重采样 (提示音场景足够, 不引入额外依赖)"""
+    if src_rate == dst_rate:
+        return samples
+    frames = len(samples) // channels
+    out_frames = int(frames * dst_rate / src_rate)
+    step = src_rate / float(dst_rate)
+    out = []
+    for n in range(out_frames):
+        pos = n * step
+        i = int(pos)
+        frac = pos - i
+        j = min(i + 1, frames - 1)
+        for c in range(channels):
+            a = samples[i * channels + c]
+            b = samples[j * channels + c]
+            out.append(a + (b - a) * frac)
+    return out
+
+
+def normalize(samples, rate, channels, target_dbfs, peak_dbfs, gain_db):
+    """门限 RMS 响度归一化, 返回 (样本, 应用的增益 dB)"""
+    block = max(1, rate * GATE_BLOCK_MS // 1000) * channels
+    gate = db_to_lin(GATE_THRESHOLD_DBFS)
+    energy, count = 0.0, 0
+    for start in range(0, len(samples), block):
+        chunk = samples[start:start + block]
+        e = sum(s * s for s in chunk)
+        if math.sqrt(e / len(chunk)) >= gate:
+            energy += e
+            count += len(chunk)
+    if count == 0:
+        return samples, 0.0
+
+    loudness = lin_to_db(math.sqrt(energy / count))
+    gain = target_dbfs - loudness + gain_db
+    peak = max(abs(s) for s in samples)
+    gain = min(gain, peak_dbfs - lin_to_db(peak))
+    k = db_to_lin(gain)
+    return [s * k for s in samples], gain
+
+
+def fold_identical_channels(pcm, channels):
+    """所有通道完全相同时折叠为单声道, 返回 (样本, 通道数)"""
+    if channels == 1:
+        return pcm, 1
+    for c in range(1, channels):
+        if pcm[c::channels] != pcm[0::channels]:
+            return pcm, channels
+    return pcm[0::channels], 1
+
+
+def adpcm_encode_channel(samples):
+    """IMA ADPCM 编码单通道, 返回按块排列的 bytes 列表"""
+    per_block = 1 + (ADPCM_BLOCK_SIZE - 4) * 2
+    blocks = []
+    index = 0
+    for start in range(0, len(samples), per_block):
+        chunk = list(samples[start:start + per_block])
+        chunk += [chunk[-1]] * (per_block - len(chunk))
+        predictor = chunk[0]
+        block = bytearray(predictor.to_bytes(2, 'little', signed=True))
+        block += bytes([index, 0])
+        nibbles = []
+        for sample in chunk[1:]:
+            step = ADPCM_STEP_TABLE[index]
+            diff = sample - predictor
+            code = 0
+            if diff < 0:
+                code = 8
+                diff = -diff
+            if diff >= step:
+                code |= 4
+                diff -= step
+            if diff >= step >> 1:
+                code |= 2
+                diff -= step >> 1
+            if diff >= step >> 2:
+                code |= 1
+            # 与解码器完全一致地重建预测值, 避免误差累积
+            delta = step >> 3
+            if code & 4:
+                delta += step
+            if code & 2:
+                delta += step >> 1
+            if code & 1:
+                delta += step >> 2
+            predictor = predictor - delta if code & 8 else predictor + delta
+            predictor = max(-32768, min(32767, predictor))
+            index = max(0, min(88, index + ADPCM_INDEX_TABLE[code]))
+            nibbles.append(code)
+        for i in range(0, len(nibbles), 2):
+            block.append(nibbles[i] | (nibbles[i + 1] << 4))
+        blocks.append(bytes(block))
+    return blocks
+
+
+def adpcm_encode(pcm, channels):
+    """多通道时每个块依次存放各通道的子块"""
+    per_channel = [adpcm_encode_channel(pcm[c::channels]) for c in range(channels)]
+    out = bytearray()
+    for group in zip(*per_channel):
+        for block in group:
+            out += block
+    return bytes(out)
+
+
+def to_pcm16(samples):
+    return [max(-32768, min(32767, int(round(s * 32768.0)))) for s in samples]
+
+
+def pcm16_bytes(pcm):
+    data = array.array('h', pcm)
+    if sys.byteorder != 'little':
+        data.byteswap()
+    return data.tobytes()
+
+
+def write_if_changed(path, content):
+    mode = 'wb' if isinstance(content, bytes) else 'w'
+    if os.path.exists(path):
+        with open(path, 'rb' if mode == 'wb' else 'r') as f:
+            if f.read() == content:
+                return
+    with open(path, mode) as f:
+        f.write(content)
+
+
+def gen_header(assets, args):
+    lines = [
+        '/* 此文件由 tools/gen_audio_assets.py 自动生成, 请勿手动修改 */',
+        '#pragma once',
+        '',
+        '#define AUDIO_ASSETS_SAMPLE_RATE  %d' % args.sample_rate,
+        '#define AUDIO_ASSETS_CHANNELS     %d' % args.channels,
+        '#define AUDIO_ASSETS_BIT_WIDTH    %d' % args.bits,
+        '#define AUDIO_ASSETS_ADPCM_BLOCK_SIZE %d' % ADPCM_BLOCK_SIZE,
+        '',
+        '/* 编译时内置资源的 ID 常量 (assets 分区可单独更新, 以分区索引为准) */',
+        'typedef enum {',
+    ]
+    for a in sorted(assets, key=lambda a: a.id):
+        lines.append('    AUDIO_ASSET_%s = %d,' % (a.name.upper(), a.id))
+    lines += ['} audio_asset_id_t;', '']
+    return '\n'.join(lines)
+
+
+def gen_image(assets, args):
+    """生成 assets 分区镜像"""
+    header_size = struct.calcsize(HEADER_FMT)
+    data_start = header_size + struct.calcsize(ENTRY_FMT) * len(assets)
+    data_start += -data_start % ALIGN
+
+    index = bytearray()
+    data = bytearray()
+    for a in sorted(assets, key=lambda a: a.id):
+        a.offset = data_start + len(data)
+        data += a.data
+        data += b'\0' * (-len(data) % ALIGN)
+        index += struct.pack(ENTRY_FMT, a.id, CODEC_IDS[args.codec], a.stored_channels,
+                             a.name.encode(), a.offset, len(a.data), a.frames,
+                             a.frames * 1000 // args.sample_rate)
+    index += b'\0' * (data_start - header_size - len(index))
+
+    header = struct.pack(HEADER_FMT, IMAGE_MAGIC, IMAGE_VERSION, len(assets), args.sample_rate,
+                         args.channels, args.bits, ADPCM_BLOCK_SIZE, len(data),
+                         zlib.crc32(data) & 0xFFFFFFFF, zlib.crc32(index) & 0xFFFFFFFF, 0)
+    return header + index + data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--assets-dir', required=True)
+    parser.add_argument('--out-dir', required=True)
+    parser.add_argument('--sample-rate', type=int, required=True, help='设备 I2S 采样率')
+    parser.add_argument('--channels', type=int, default=2, help='设备 I2S 通道数 (标准模式立体声)')
+    parser.add_argument('--bits', type=int, default=16, help='设备 I2S 位宽')
+    parser.add_argument('--target-dbfs', type=float, default=-20.0, help='响度归一化目标 (门限 RMS, dBFS)')
+    parser.add_argument('--peak-dbfs', type=float, default=-1.0, help='归一化后允许的最大峰值 (dBFS)')
+    parser.add_argument('--codec', choices=['pcm', 'adpcm'], default='pcm', help='资源存储格式')
+    parser.add_argument('--max-size', type=lambda v: int(v, 0), default=0, help='assets 分区大小 (字节)')
+    args = parser.parse_args()
+
+    if args.bits != 16:
+        fail('I2S 位宽为 %d, 资源生成仅支持 16 位' % args.bits)
+    if args.channels not in (1, 2):
+        fail('I2S 通道数为 %d, 资源生成仅支持 1 或 2' % args.channels)
+
+    assets = scan_assets(args.assets_dir)
+    if not assets:
+        fail('%s 中没有任何提示音资源' % args.assets_dir)
+    if len(assets) > MAX_COUNT:
+        fail('提示音数量 %d 超出上限 %d' % (len(assets), MAX_COUNT))
+
+    for a in sorted(assets, key=lambda a: a.id):
+        rate, channels, samples = read_source(a)
+        samples = remix(samples, channels, args.channels)
+        samples = resample(samples, args.channels, rate, args.sample_rate)
+        samples, gain = normalize(samples, args.sample_rate, args.channels,
+                                  args.target_dbfs, args.peak_dbfs, a.gain_db)
+        pcm = to_pcm16(samples)
+        a.frames = len(pcm) // args.channels
+        if args.codec == 'adpcm':
+            pcm, a.stored_channels = fold_identical_channels(pcm, args.channels)
+            a.data = adpcm_encode(pcm, a.stored_channels)
+        else:
+            a.stored_channels = args.channels
+            a.data = pcm16_bytes(pcm)
+        raw_size = a.frames * args.channels * 2
+        print('gen_audio_assets: %3d %-16s %6d Hz x%d -> %6d Hz x%d, %+5.1f dB, %7d 字节 (%s x%d, %.1f:1)'
+              % (a.id, a.name, rate, channels, args.sample_rate, args.channels, gain, len(a.data),
+                 args.codec, a.stored_channels, raw_size / float(max(1, len(a.data)))))
+
+    image = gen_image(assets, args)
+    print('gen_audio_assets: 分区镜像 %d 字节' % len(image))
+    if args.max_size and len(image) > args.max_size:
+        fail('分区镜像 %d 字节超出 assets 分区大小 %d 字节' % (len(image), args.max_size))
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    write_if_changed(os.path.join(args.out_dir, 'audio_assets.bin'), image)
+    write_if_changed(os.path.join(args.out_dir, 'audio_assets_gen.h'), gen_header(assets, args))
+
+if __name__ == '__main__':
+    main()
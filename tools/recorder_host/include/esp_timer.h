@@ -0,0 +1,5 @@
+/* 主机编译用的最小 esp_timer.h, 返回模拟时钟 (recorder_host_check.c) */
+#pragma once
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,458 @@
+/**
+ * @file recorder_host_check.c
+ * @brief 闪存录音写入层主机验证与吞吐测试
+ * @details 在主机上编译 main/audio_flash_log.c 和 main/audio_adpcm.c, 用模拟闪存 (NOR 语义 + 擦除/编程耗时模型)
+ *          和模拟时钟复现 audio_recorder 的双缓冲流程:
+ *          - 采集端以采样率向 I2S DMA 环形缓冲写入帧, 闪存操作期间 (缓存禁用) 采集任务停顿, 环形缓冲满则丢帧
+ *          - 采集端凑满一个编码单位后编码/复制到双缓冲, 两个缓冲区都在等待写入时丢弃 (缓冲区溢出)
+ *          - 写入端开始前逐扇区擦除领先量 (PCM 为整段), 之后追加写满的缓冲区, 空闲时提前擦除一个扇区
+ *          报告持续写入吞吐、闪存占用率、单次闪存操作最长耗时 (采集停顿) 与 DMA 缓冲时延的余量.
+ *          验证: 典型耗时下 ADPCM、PCM 均不丢帧, 回读数据与录音头一致; 预擦除期间的停止请求在一次扇区擦除内生效.
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Itools/recorder_host/include -Itools/dsp_host/include -Imain \
+ *                tools/recorder_host/recorder_host_check.c main/audio_flash_log.c main/audio_adpcm.c -lm -o /tmp/recorder_host_check
+ *            /tmp/recorder_host_check
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_flash_log.h"
+#include "audio_adpcm.h"
+
+#define FS              44100
+#define SLOTS           2
+#define FRAME_BYTES     (SLOTS * 2)
+#define PART_SIZE       0x2F0000        // 与 partitions.csv 中的 record 分区一致
+#define SLAB_SIZE       8192            // BOARD_AUDIO_POOL_DMA_BLOCK_SIZE
+#define ADPCM_BLOCK     512             // AUDIO_RECORDER_ADPCM_BLOCK_SIZE
+#define ADPCM_FRAMES    AUDIO_ADPCM_SAMPLES_PER_BLOCK(ADPCM_BLOCK)
+#define ADPCM_BYTES     (ADPCM_BLOCK * SLOTS)
+#define PCM_BYTES       AUDIO_FLASH_LOG_SECTOR_SIZE
+#define RING_FRAMES     (8 * 480)       // BOARD_AUDIO_RECORDER_DMA_PROFILE (robust)
+#define ERASE_LEAD      (64 * 1024)     // CONFIG_AUDIO_RECORDER_ERASE_LEAD_KB 默认值
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+/**************************** 模拟闪存 ****************************/
+
+/* 耗时模型 (微秒) */
+typedef struct {
+    const char *name;
+    uint32_t erase_min_us, erase_max_us;    // 扇区擦除
+    uint32_t page_min_us, page_max_us;      // 256 字节页编程
+    uint32_t call_us;                       // 每次调用的驱动开销
+} flash_model_t;
+
+static const flash_model_t s_typical = { "典型", 35000, 55000, 500, 800, 20 };
+static const flash_model_t s_worst   = { "数据手册上限", 400000, 400000, 3000, 3000, 20 };
+
+static uint8_t *s_flash;
+static const flash_model_t *s_model;
+static int64_t s_now_us;
+static uint32_t s_rng = 1;
+static uint32_t s_unerased_writes;
+
+static uint32_t rand_between(uint32_t lo, uint32_t hi)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return lo + (hi > lo ? (s_rng >> 8) % (hi - lo + 1) : 0);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now_us;
+}
+
+static void sim_advance(int64_t us, bool blocked);
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (src_offset + size > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, s_flash + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (dst_offset + size > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t *p = src;
+    uint32_t us = s_model->call_us;
+    for (size_t i = 0; i < size; i++) {
+        if (s_flash[dst_offset + i] != 0xFF) {
+            s_unerased_writes++;
+        }
+        s_flash[dst_offset + i] &= p[i];       // NOR 只能把 1 写成 0
+    }
+    size_t first_page = dst_offset / 256, last_page = (dst_offset + size - 1) / 256;
+    for (size_t pg = first_page; pg <= last_page; pg++) {
+        us += rand_between(s_model->page_min_us, s_model->page_max_us);
+    }
+    sim_advance(us, true);
+    sim_advance(0, false);      // 调用之间重新启用缓存, 优先级更高的采集任务先运行
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (offset % AUDIO_FLASH_LOG_SECTOR_SIZE || size % AUDIO_FLASH_LOG_SECTOR_SIZE || offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 驱动逐扇区擦除, 扇区之间重新启用缓存
+    for (size_t s = 0; s < size; s += AUDIO_FLASH_LOG_SECTOR_SIZE) {
+        memset(s_flash + offset + s, 0xFF, AUDIO_FLASH_LOG_SECTOR_SIZE);
+        sim_advance(s_model->call_us + rand_between(s_model->erase_min_us, s_model->erase_max_us), true);
+        sim_advance(0, false);
+    }
+    return ESP_OK;
+}
+
+/**************************** 模拟采集 ****************************/
+
+static struct {
+    bool adpcm;
+    bool running;               // 采集已开始
+    uint64_t target;            // 目标帧数
+    uint64_t produced;          // DMA 已采集的帧数 (含丢弃)
+    uint64_t consumed;          // 采集任务已取走的帧数
+    uint64_t encoded;           // 已写入双缓冲的帧数
+    uint32_t ring;              // DMA 环形缓冲中的帧数
+    uint64_t ring_dropped;      // DMA 环形缓冲满丢弃的帧数
+    uint64_t slab_dropped;      // 缓冲区溢出丢弃的帧数
+    uint32_t slab_overruns;
+    int64_t max_stall_us;
+    int64_t flash_busy_us;
+    uint8_t slab[2][SLAB_SIZE];
+    int cur;
+    size_t fill;
+    int pending[2];             // 待写入的缓冲区 (FIFO)
+    size_t pending_len[2];
+    int pending_count;
+    int free_idx;               // 空闲缓冲区, -1 表示没有
+    uint8_t adpcm_index[SLOTS];
+    int16_t unit[PCM_BYTES / 2];     // 一个编码单位 (PCM 扇区 >= ADPCM 块)
+} s_cap;
+
+/* 麦克风信号: 两个通道不同频率的正弦 */
+static int16_t source_sample(uint64_t frame, int ch)
+{
+    double f = ch ? 997.0 : 440.0;
+    return (int16_t)lrint(12000.0 * sin(2 * M_PI * f * (double)frame / FS));
+}
+
+static void capture_drain(void)
+{
+    const uint32_t unit_frames = s_cap.adpcm ? ADPCM_FRAMES : PCM_BYTES / FRAME_BYTES;
+    for (;;) {
+        uint64_t left = s_cap.target - s_cap.consumed;
+        uint32_t n = left < unit_frames ? (uint32_t)left : unit_frames;
+        if (n == 0 || s_cap.ring < n) {
+            return;
+        }
+        // 取走一个编码单位; DMA 丢弃的帧已在 produced 中跳过, 这里按实际采集位置生成数据
+        uint64_t first = s_cap.produced - s_cap.ring;
+        for (uint32_t i = 0; i < n; i++) {
+            for (int c = 0; c < SLOTS; c++) {
+                s_cap.unit[i * SLOTS + c] = source_sample(first + i, c);
+            }
+        }
+        s_cap.ring -= n;
+        s_cap.consumed += n;
+
+        if (s_cap.cur < 0 && s_cap.free_idx >= 0) {
+            s_cap.cur = s_cap.free_idx;
+            s_cap.free_idx = -1;
+            s_cap.fill = 0;
+        }
+        if (s_cap.cur < 0) {
+            s_cap.slab_dropped += n;
+            s_cap.slab_overruns++;
+            continue;
+        }
+        if (s_cap.adpcm) {
+            audio_adpcm_encode_block(s_cap.unit, n, SLOTS, s_cap.slab[s_cap.cur] + s_cap.fill, ADPCM_BLOCK,
+                                     s_cap.adpcm_index);
+            s_cap.fill += ADPCM_BYTES;
+        } else {
+            memcpy(s_cap.slab[s_cap.cur] + s_cap.fill, s_cap.unit, n * FRAME_BYTES);
+            s_cap.fill += n * FRAME_BYTES;
+        }
+        s_cap.encoded += n;
+        if (s_cap.fill == SLAB_SIZE || s_cap.consumed >= s_cap.target) {
+            s_cap.pending[s_cap.pending_count] = s_cap.cur;
+            s_cap.pending_len[s_cap.pending_count++] = s_cap.fill;
+            s_cap.cur = s_cap.free_idx;
+            s_cap.free_idx = -1;
+            s_cap.fill = 0;
+        }
+    }
+}
+
+/**
+ * @brief 推进模拟时钟
+ * @param blocked 闪存操作中 (缓存禁用), 采集任务不能运行
+ */
+static void sim_advance(int64_t us, bool blocked)
+{
+    if (s_cap.running) {
+        uint64_t end = (uint64_t)(s_now_us + us) * FS / 1000000;
+        uint64_t start = (uint64_t)s_now_us * FS / 1000000;
+        uint64_t total = s_cap.target;
+        for (uint64_t f = start; f < end && s_cap.produced < total; f++) {
+            s_cap.produced++;
+            if (s_cap.ring < RING_FRAMES) {
+                s_cap.ring++;
+            } else {
+                // 环形缓冲已满, 丢弃最旧的帧
+                s_cap.ring_dropped++;
+                s_cap.consumed++;
+            }
+        }
+        if (blocked) {
+            s_cap.flash_busy_us += us;
+            if (us > s_cap.max_stall_us) {
+                s_cap.max_stall_us = us;
+            }
+        }
+    }
+    s_now_us += us;
+    if (s_cap.running && !blocked) {
+        capture_drain();
+    }
+}
+
+/**************************** 场景 ****************************/
+
+typedef struct {
+    const char *name;
+    bool adpcm;
+    int seconds;
+    bool erase_ahead;           // false: 不提前擦除, 写入时逐扇区擦除 (对照)
+    const flash_model_t *model;
+} scenario_t;
+
+typedef struct {
+    uint64_t lost;
+    audio_flash_log_t log;
+    audio_flash_log_header_t header;
+} scenario_result_t;
+
+static void run_scenario(const scenario_t *sc, const esp_partition_t *part, scenario_result_t *res)
+{
+    memset(&s_cap, 0, sizeof(s_cap));
+    s_model = sc->model;
+    s_now_us = 0;
+    s_rng = 1;
+    s_unerased_writes = 0;
+    memset(s_flash, 0x00, PART_SIZE);      // 旧数据, 未擦除直接写入会被发现
+
+    audio_flash_log_t *log = &res->log;
+    audio_flash_log_open(log, part);
+    s_cap.adpcm = sc->adpcm;
+    s_cap.target = (uint64_t)sc->seconds * FS;
+    size_t bytes_per_second = sc->adpcm ? (size_t)((uint64_t)FS * ADPCM_BYTES / ADPCM_FRAMES) + 1 : FS * FRAME_BYTES;
+
+    // 与 audio_recorder 相同: ADPCM 擦除到整段多一块, 开始前只擦除领先量; PCM 开始前擦除整段
+    size_t erase_end = sc->erase_ahead ? bytes_per_second * sc->seconds + (sc->adpcm ? ADPCM_BYTES : 0) : 0;
+    size_t lead = sc->adpcm ? ERASE_LEAD : erase_end;
+    int64_t t0 = s_now_us;
+    audio_flash_log_begin(log, 0);
+    while (log->erased < erase_end && audio_flash_log_erase_ahead(log, lead)) {
+    }
+    int64_t pre_erase_us = s_now_us - t0;
+    size_t pre_erase = log->erased;
+
+    // 采集开始: 0 号缓冲区填充中, 1 号空闲
+    s_cap.running = true;
+    s_cap.cur = 0;
+    s_cap.free_idx = 1;
+    int64_t start_us = s_now_us;
+
+    for (;;) {
+        if (s_cap.pending_count > 0) {
+            int idx = s_cap.pending[0];
+            size_t len = s_cap.pending_len[0];
+            audio_flash_log_append(log, s_cap.slab[idx], len);
+            s_cap.pending[0] = s_cap.pending[1];
+            s_cap.pending_len[0] = s_cap.pending_len[1];
+            s_cap.pending_count--;
+            // 归还缓冲区, 采集端正在等待时立即使用
+            if (s_cap.cur < 0) {
+                s_cap.cur = idx;
+                s_cap.fill = 0;
+            } else {
+                s_cap.free_idx = idx;
+            }
+            sim_advance(0, false);
+        } else if (s_cap.consumed >= s_cap.target) {
+            break;
+        } else if (!(log->erased < erase_end && audio_flash_log_erase_ahead(log, lead))) {
+            sim_advance(1000, false);      // 写入任务空闲, 已领先足够
+        }
+    }
+    s_cap.running = false;
+    int64_t wall_us = s_now_us - start_us;
+
+    res->header = (audio_flash_log_header_t){
+        .codec = sc->adpcm ? AUDIO_FLASH_LOG_CODEC_IMA_ADPCM : AUDIO_FLASH_LOG_CODEC_PCM,
+        .channels = SLOTS, .sample_rate = FS, .block_size = sc->adpcm ? ADPCM_BLOCK : 0,
+        .frames = (uint32_t)s_cap.encoded, .sequence = 1,
+        .dropped_frames = (uint32_t)(s_cap.ring_dropped + s_cap.slab_dropped),
+        .dma_dropped_frames = (uint32_t)s_cap.ring_dropped,
+    };
+    audio_flash_log_finish(log, &res->header);
+    res->lost = s_cap.ring_dropped + s_cap.slab_dropped;
+
+    const audio_flash_log_stats_t *st = &log->stats;
+    double busy_s = (st->erase_us + st->write_us) / 1e6;
+    double ring_ms = RING_FRAMES * 1000.0 / FS;
+    printf("%s (%s耗时, %d 秒):\n", sc->name, sc->model->name, sc->seconds);
+    printf("    数据速率       %7.1f KB/s, 预擦除 %u KB 耗时 %.0f ms\n", bytes_per_second / 1024.0,
+           (unsigned int)(pre_erase / 1024),
+           pre_erase_us / 1000.0);
+    printf("    持续写入吞吐   %7.1f KB/s (写入 %u KB / 擦除+编程 %.2f s), 闪存占用 %.0f%%\n",
+           st->bytes_written / 1024.0 / busy_s, (unsigned int)(st->bytes_written / 1024), busy_s,
+           100.0 * s_cap.flash_busy_us / wall_us);
+    printf("    擦除 %u 扇区 (写入时擦除 %u), 最长 %.1f ms; 写入 %u 次, 最长 %.2f ms\n",
+           (unsigned int)st->erases, (unsigned int)st->inline_erases, st->max_erase_us / 1000.0,
+           (unsigned int)st->writes, st->max_write_us / 1000.0);
+    printf("    最长采集停顿   %7.1f ms (DMA 缓冲 %.1f ms, 余量 %.1f ms)\n", s_cap.max_stall_us / 1000.0,
+           ring_ms, ring_ms - s_cap.max_stall_us / 1000.0);
+    printf("    丢帧           DMA 溢出 %llu, 缓冲区溢出 %llu (%u 次)\n", (unsigned long long)s_cap.ring_dropped,
+           (unsigned long long)s_cap.slab_dropped, (unsigned int)s_cap.slab_overruns);
+    check(s_unerased_writes == 0, "只写入已擦除的区域");
+}
+
+/**
+ * @brief 回读录音: 校验录音头, PCM 逐字节比较, ADPCM 解码后计算信噪比
+ */
+static void verify_readback(const scenario_t *sc, scenario_result_t *res)
+{
+    audio_flash_log_header_t hdr;
+    char msg[128];
+    check(audio_flash_log_read_header(&res->log, &hdr) == ESP_OK &&
+          memcmp(&hdr, &res->header, sizeof(hdr)) == 0, "录音头回读一致");
+
+    double sig = 0, noise = 0;
+    uint64_t mismatches = 0, frame = 0;
+    static uint8_t chunk[SLAB_SIZE];
+    static int16_t pcm[PCM_BYTES / 2];
+    size_t unit = sc->adpcm ? ADPCM_BYTES : PCM_BYTES;
+    for (size_t off = 0; off < hdr.data_size; off += unit) {
+        size_t len = hdr.data_size - off < unit ? hdr.data_size - off : unit;
+        audio_flash_log_read(&res->log, off, chunk, len);
+        size_t n;
+        if (sc->adpcm) {
+            n = audio_adpcm_decode_block(chunk, ADPCM_BLOCK, SLOTS, pcm, SLOTS, hdr.frames - frame);
+        } else {
+            n = len / FRAME_BYTES;
+            memcpy(pcm, chunk, len);
+        }
+        for (size_t i = 0; i < n; i++, frame++) {
+            for (int c = 0; c < SLOTS; c++) {
+                double ref = source_sample(frame, c);
+                double d = pcm[i * SLOTS + c] - ref;
+                sig += ref * ref;
+                noise += d * d;
+                mismatches += (d != 0);
+            }
+        }
+    }
+    snprintf(msg, sizeof(msg), "回读 %llu 帧 = 录音头 %u 帧", (unsigned long long)frame, (unsigned int)hdr.frames);
+    check(frame == hdr.frames && hdr.frames == (uint32_t)(sc->seconds * FS), msg);
+    if (sc->adpcm) {
+        double snr = 10 * log10(sig / (noise > 0 ? noise : 1));
+        snprintf(msg, sizeof(msg), "ADPCM 解码信噪比 %.1f dB > 25 dB", snr);
+        check(snr > 25, msg);
+    } else {
+        snprintf(msg, sizeof(msg), "PCM 回读逐样本一致 (不一致 %llu)", (unsigned long long)mismatches);
+        check(mismatches == 0, msg);
+    }
+}
+
+/**
+ * @brief 预擦除期间停止: 与写入任务相同, 每个扇区前检查停止标志
+ * @details 数据手册上限耗时下擦除 PCM 整段 (分区容量) 约需 5 分钟, 1 秒时请求停止
+ */
+static void check_stop_during_pre_erase(const esp_partition_t *part)
+{
+    audio_flash_log_t log;
+    char msg[128];
+    s_model = &s_worst;
+    s_now_us = 0;
+    memset(&s_cap, 0, sizeof(s_cap));
+    audio_flash_log_open(&log, part);
+    audio_flash_log_begin(&log, 0);
+
+    const int64_t stop_at_us = 1000000;
+    bool stop = false;
+    int64_t stop_us = 0;
+    while (!stop && audio_flash_log_erase_ahead(&log, log.capacity)) {
+        if (s_now_us >= stop_at_us) {
+            stop = true;
+            stop_us = s_now_us;
+        }
+    }
+    double latency_ms = (stop_us - stop_at_us) / 1000.0;
+    printf("预擦除期间停止 (%s耗时, PCM 整段 %u KB): 已擦除 %u KB, 停止生效延迟 %.0f ms\n", s_worst.name,
+           (unsigned int)(log.capacity / 1024), (unsigned int)(log.erased / 1024), latency_ms);
+    snprintf(msg, sizeof(msg), "停止请求在一次扇区擦除内生效 (%.0f ms <= %.0f ms)", latency_ms,
+             (s_worst.erase_max_us + s_worst.call_us) / 1000.0);
+    check(stop && stop_us - stop_at_us <= (int64_t)(s_worst.erase_max_us + s_worst.call_us), msg);
+}
+
+int main(void)
+{
+    s_flash = malloc(PART_SIZE);
+    if (s_flash == NULL) {
+        return 1;
+    }
+    const esp_partition_t part = { .address = 0x510000, .size = PART_SIZE, .label = "record" };
+    scenario_result_t res;
+    char msg[128];
+
+    printf("record 分区 %u KB, 双缓冲 2 x %u 字节, DMA 缓冲 %u 帧 (%.1f ms @ %d Hz)\n\n", PART_SIZE / 1024,
+           SLAB_SIZE, RING_FRAMES, RING_FRAMES * 1000.0 / FS, FS);
+
+    const scenario_t checked[] = {
+        { "ADPCM 空闲时提前擦除", true, 60, true, &s_typical },
+        { "PCM 预擦除整段", false, 15, true, &s_typical },
+    };
+    for (size_t i = 0; i < sizeof(checked) / sizeof(checked[0]); i++) {
+        run_scenario(&checked[i], &part, &res);
+        snprintf(msg, sizeof(msg), "不丢帧 (丢弃 %llu 帧)", (unsigned long long)res.lost);
+        check(res.lost == 0, msg);
+        verify_readback(&checked[i], &res);
+    }
+
+    check_stop_during_pre_erase(&part);
+
+    // 以下只报告: 数据手册上限耗时下单次擦除 (400ms) 超过 DMA 缓冲, 丢帧计入录音头 dma_dropped_frames;
+    // PCM 的编程吞吐低于数据速率
+    const scenario_t adpcm_worst = { "ADPCM 空闲时提前擦除 (对照)", true, 60, true, &s_worst };
+    run_scenario(&adpcm_worst, &part, &res);
+    const scenario_t pcm_worst = { "PCM 预擦除整段 (对照)", false, 15, true, &s_worst };
+    run_scenario(&pcm_worst, &part, &res);
+    const scenario_t adpcm_inline = { "ADPCM 边擦除边写入 (对照)", true, 20, false, &s_worst };
+    run_scenario(&adpcm_inline, &part, &res);
+
+    free(s_flash);
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+音频流测试服务器
+
+在本机模拟 play_url / cache_audio / update_assets 使用的 HTTP 服务器:
+  - 支持 Range 请求 (206 + Content-Range), HTTP/1.1 长连接
+  - --rate-kbps 限制下载速率, 用于复现欠载
+  - --no-range  忽略 Range 头返回 200, 测试设备端顺序读取的退化路径
+  - --drop-after 在发送指定字节数后断开连接, 测试错误处理
+
+示例:
+  python3 tools/stream_test_server.py --dir build/esp-idf/main/audio_assets --port 8000 --rate-kbps 800
+  服务器发送 {"event":"play_url","data":{"url":"http://<PC IP>:8000/clip.pcm","offset":0}}
+
+设备播放 I2S 原生 PCM (16 位立体声, CONFIG_AUDIO_SAMPLE_RATE), 可用 --make-tone 生成测试音:
+  python3 tools/stream_test_server.py --dir /tmp/stream --make-tone tone.pcm --seconds 20
+"""
+
+import argparse
+import array
+import http.server
+import math
+import os
+import re
+import socketserver
+import sys
+import time
+
+RANGE_RE = re.compile(r'bytes=(\d*)-(\d*)$')
+
+
+class Handler(http.server.SimpleHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+    args = None
+
+    def log_message(self, fmt, *a):
+        sys.stderr.write('stream_test_server: %s %s\n' % (self.address_string(), fmt % a))
+
+    def do_GET(self):
+        path = self.translate_path(self.path)
+        if not os.path.isfile(path):
+            self.send_error(404)
+            return
+        size = os.path.getsize(path)
+        start, end = 0, size - 1
+        status = 200
+
+        m = RANGE_RE.match(self.headers.get('Range', ''))
+        if m and not self.args.no_range:
+            if m.group(1):
+                start = int(m.group(1))
+                if m.group(2):
+                    end = min(int(m.group(2)), size - 1)
+            elif m.group(2):
+                start = max(0, size - int(m.group(2)))
+            if start >= size:
+                self.send_response(416)
+                self.send_header('Content-Range', 'bytes */%d' % size)
+                self.send_header('Content-Length', '0')
+                self.end_headers()
+                return
+            status = 206
+
+        length = end - start + 1
+        self.send_response(status)
+        self.send_header('Content-Type', 'application/octet-stream')
+        self.send_header('Content-Length', str(length))
+        self.send_header('Accept-Ranges', 'none' if self.args.no_range else 'bytes')
+        if status == 206:
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (start, end, size))
+        self.end_headers()
+
+        with open(path, 'rb') as f:
+            f.seek(start)
+            self.send_body(f, length)
+
+    def send_body(self, f, length):
+        chunk = 1460
+        rate = self.args.rate_kbps * 1000 / 8.0
+        t0 = time.monotonic()
+        sent = 0
+        while sent < length:
+            data = f.read(min(chunk, length - sent))
+            if not data:
+                break
+            if self.args.drop_after and sent + len(data) > self.args.drop_after:
+                self.close_connection = True
+                return
+            self.wfile.write(data)
+            sent += len(data)
+            if rate > 0:
+                ahead = sent / rate - (time.monotonic() - t0)
+                if ahead > 0:
+                    time.sleep(ahead)
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+
+
+def make_tone(path, rate, seconds):
+    """生成 440 Hz 正弦测试音, 16 位立体声"""
+    samples = array.array('h')
+    for n in range(int(rate * seconds)):
+        v = int(8000 * math.sin(2 * math.pi * 440 * n / rate))
+        samples.append(v)
+        samples.append(v)
+    if sys.byteorder != 'little':
+        samples.byteswap()
+    with open(path, 'wb') as f:
+        samples.tofile(f)
+    print('stream_test_server: 已生成 %s (%d 字节)' % (path, len(samples) * 2))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--dir', default='.', help='服务目录')
+    parser.add_argument('--port', type=int, default=8000)
+    parser.add_argument('--rate-kbps', type=float, default=0, help='每个连接的下载速率上限 (kbit/s), 0 表示不限')
+    parser.add_argument('--no-range', action='store_true', help='忽略 Range 请求, 始终返回完整文件')
+    parser.add_argument('--drop-after', type=int, default=0, help='每个响应发送该字节数后断开连接')
+    parser.add_argument('--make-tone', metavar='NAME', help='在服务目录生成测试音文件后启动')
+    parser.add_argument('--sample-rate', type=int, default=44100, help='测试音采样率 (与 CONFIG_AUDIO_SAMPLE_RATE 一致)')
+    parser.add_argument('--seconds', type=float, default=10, help='测试音时长')
+    args = parser.parse_args()
+
+    os.makedirs(args.dir, exist_ok=True)
+    if args.make_tone:
+        make_tone(os.path.join(args.dir, args.make_tone), args.sample_rate, args.seconds)
+
+    Handler.args = args
+    handler = lambda *a, **kw: Handler(*a, directory=args.dir, **kw)
+    server = Server(('0.0.0.0', args.port), handler)
+    print('stream_test_server: http://0.0.0.0:%d/ -> %s' % (args.port, os.path.abspath(args.dir)))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,3 @@
+/* 主机编译用的最小 driver/i2s_std.h, audio_synth.h 只用到通道句柄类型 */
+#pragma once
+typedef struct i2s_channel_obj_t *i2s_chan_handle_t;
@@ -0,0 +1,190 @@
+/**
+ * @file synth_host_check.c
+ * @brief 提示音合成核心主机验证
+ * @details 在主机上编译 main/audio_synth_render.c, 验证音符序列按块交付:
+ *          - 合成的总帧数等于各音符帧数之和, 除最后一块外每块都是满块
+ *          - 序列结束时不足一块的帧被交付, 包括最后一个音符时长为 0 的情况
+ *          - 总帧数是块大小整数倍时不交付空块
+ *          - 每个发声音符在释放段末尾归零, 休止段为静音, 所有通道相同
+ *          - 接收函数返回错误时停止合成并返回该错误
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Itools/synth_host/include -Itools/dsp_host/include -Imain \
+ *                tools/synth_host/synth_host_check.c main/audio_synth_render.c -lm -o /tmp/synth_host_check
+ *            /tmp/synth_host_check
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_synth_render.h"
+
+#define FS          44100
+#define CH          2
+#define BLOCK       256
+#define MAX_FRAMES  (FS * 2)
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+typedef struct {
+    int16_t out[MAX_FRAMES * CH];
+    size_t frames;
+    int calls;
+    int partial_calls;                      // 不足一块的交付次数
+    bool partial_not_last;                  // 不足一块的交付之后还有交付
+    int fail_at_call;                       // 第几次交付返回错误, 0 表示不返回
+} capture_t;
+
+static esp_err_t capture_sink(void *ctx, const int16_t *frames, size_t frame_count)
+{
+    capture_t *c = ctx;
+    if (c->partial_calls > 0) {
+        c->partial_not_last = true;
+    }
+    c->calls++;
+    if (frame_count < BLOCK) {
+        c->partial_calls++;
+    }
+    if (c->fail_at_call && c->calls == c->fail_at_call) {
+        return ESP_FAIL;
+    }
+    if (frame_count == 0 || c->frames + frame_count > MAX_FRAMES) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&c->out[c->frames * CH], frames, frame_count * CH * sizeof(int16_t));
+    c->frames += frame_count;
+    return ESP_OK;
+}
+
+static size_t expected_frames(const audio_earcon_t *e)
+{
+    size_t n = 0;
+    for (int k = 0; k < e->note_count; k++) {
+        n += e->notes[k].duration_ms * FS / 1000;
+    }
+    return n;
+}
+
+static esp_err_t render(const audio_earcon_t *e, capture_t *c)
+{
+    static int16_t buf[BLOCK * CH];
+    return audio_synth_render(e, FS, CH, buf, BLOCK, capture_sink, c);
+}
+
+/* 按块交付: 帧数一致, 只有最后一块可以不满 */
+static void check_delivery(const char *name, const audio_earcon_t *e)
+{
+    static capture_t c;
+    memset(&c, 0, sizeof(c));
+    esp_err_t ret = render(e, &c);
+    size_t want = expected_frames(e);
+    char what[160];
+    printf("    %s: %zu 帧, 交付 %d 次\n", name, c.frames, c.calls);
+    snprintf(what, sizeof(what), "%s: 返回 ESP_OK, 交付全部 %zu 帧", name, want);
+    check(ret == ESP_OK && c.frames == want, what);
+    snprintf(what, sizeof(what), "%s: 除最后一块外都是满块, 不交付空块", name);
+    check(!c.partial_not_last && c.partial_calls == (want % BLOCK ? 1 : 0) &&
+          c.calls == (int)((want + BLOCK - 1) / BLOCK), what);
+}
+
+int main(void)
+{
+    printf("按块交付\n");
+
+    // 最后一个音符时长为 0: 前面音符剩下的不足一块的帧也要写出
+    audio_earcon_t zero_tail = {
+        .name = "zero_tail", .wave = AUDIO_SYNTH_WAVE_SINE, .volume = 70,
+        .attack_ms = 5, .decay_ms = 60, .sustain = 60, .release_ms = 40,
+        .note_count = 3,
+        .notes = { { 660, 150 }, { 880, 100 }, { 440, 0 } },
+    };
+    check((expected_frames(&zero_tail) % BLOCK) != 0, "测试序列的总帧数不是块大小的整数倍");
+    check_delivery("最后一个音符时长为 0", &zero_tail);
+
+    audio_earcon_t zero_rest_tail = zero_tail;
+    zero_rest_tail.notes[2].freq_hz = 0;
+    check_delivery("最后是时长为 0 的休止", &zero_rest_tail);
+
+    audio_earcon_t zero_many = zero_tail;
+    zero_many.note_count = 5;
+    zero_many.notes[3] = (audio_synth_note_t) { 0, 0 };
+    zero_many.notes[4] = (audio_synth_note_t) { 1000, 0 };
+    check_delivery("末尾连续多个时长为 0 的音符", &zero_many);
+
+    audio_earcon_t partial = zero_tail;
+    partial.note_count = 2;
+    check_delivery("最后一个音符不满一块", &partial);
+
+    audio_earcon_t exact = {
+        .name = "exact", .wave = AUDIO_SYNTH_WAVE_SQUARE, .volume = 50,
+        .attack_ms = 1, .decay_ms = 1, .sustain = 100, .release_ms = 1,
+        .note_count = 1,
+        .notes = { { 500, 0 } },
+    };
+    // 找一个帧数正好是块大小整数倍的时长
+    for (uint16_t ms = 1; ms < 2000; ms++) {
+        if ((ms * FS / 1000) % BLOCK == 0) {
+            exact.notes[0].duration_ms = ms;
+            break;
+        }
+    }
+    check(exact.notes[0].duration_ms > 0, "找到帧数为块大小整数倍的时长");
+    check_delivery("总帧数是块大小的整数倍", &exact);
+
+    audio_earcon_t only_zero = zero_tail;
+    only_zero.note_count = 1;
+    only_zero.notes[0].duration_ms = 0;
+    static capture_t c;
+    memset(&c, 0, sizeof(c));
+    check(render(&only_zero, &c) == ESP_OK && c.calls == 0, "没有帧时不调用接收函数");
+
+    printf("波形\n");
+    memset(&c, 0, sizeof(c));
+    audio_earcon_t shape = {
+        .name = "shape", .wave = AUDIO_SYNTH_WAVE_TRIANGLE, .volume = 80,
+        .attack_ms = 3, .decay_ms = 120, .sustain = 40, .release_ms = 120,
+        .note_count = 3,
+        .notes = { { 784, 140 }, { 0, 50 }, { 1047, 420 } },
+    };
+    render(&shape, &c);
+    size_t n0 = 140 * FS / 1000;
+    size_t n1 = 50 * FS / 1000;
+    bool same = true;
+    int peak = 0;
+    for (size_t i = 0; i < c.frames; i++) {
+        same = same && c.out[i * CH] == c.out[i * CH + 1];
+        peak = abs(c.out[i * CH]) > peak ? abs(c.out[i * CH]) : peak;
+    }
+    bool silent = true;
+    for (size_t i = n0; i < n0 + n1; i++) {
+        silent = silent && c.out[i * CH] == 0;
+    }
+    int tail0 = abs(c.out[(n0 - 1) * CH]);
+    int tail2 = abs(c.out[(c.frames - 1) * CH]);
+    printf("    峰值 %d, 第一个音符末帧 %d, 最后一帧 %d\n", peak, tail0, tail2);
+    check(same, "所有通道写入相同的采样");
+    check(peak > 32767 * 80 / 100 / 2 && peak <= 32767 * 80 / 100 + 1, "峰值与音量一致");
+    check(silent, "休止段为静音");
+    check(tail0 < 200 && tail2 < 200, "发声音符在释放段末尾归零");
+
+    printf("错误\n");
+    memset(&c, 0, sizeof(c));
+    c.fail_at_call = 2;
+    check(render(&shape, &c) == ESP_FAIL && c.calls == 2, "接收函数返回错误时停止合成并返回该错误");
+    memset(&c, 0, sizeof(c));
+    c.fail_at_call = (int)((expected_frames(&zero_tail) + BLOCK - 1) / BLOCK);
+    check(render(&zero_tail, &c) == ESP_FAIL, "最后不满一块的交付失败时同样返回错误");
+
+    printf("%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief 主机验证用的 ROM CRC32 替身 (与 esp_rom_crc32_le 和 zlib crc32 结果相同)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len)
+{
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    while (len--) {
+        crc = table[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
@@ -0,0 +1,409 @@
+/**
+ * @file upload_host_check.c
+ * @brief 可续传分块上传协议主机验证
+ * @details 在主机上编译 main/audio_upload.c, 用模拟时钟复现 audio_outbox 的上传流程, 对端为进程内的服务器替身:
+ *          - 上行链路按带宽串行发送, 单向时延固定, 设备只能在 TCP 发送缓冲有空间时继续发送 (send_bin 阻塞)
+ *          - 分块头部和数据组成一个二进制帧 (esp_websocket_client_send_iov), 服务器也接受头部帧 + 数据帧, 校验 CRC32 和偏移, 回复累计确认 upload_ack 或 upload_nack
+ *          - 连接在随机时刻被断开, 双向在途的帧全部丢失, 设备随后重连并以同一 ID 发送 upload_begin,
+ *            服务器以已收到的偏移确认, 设备从该偏移续传
+ *          - 按概率篡改分块数据, 触发 CRC 错误和否认
+ *          验证: 每次运行都完成上传且服务器收到的数据与源数据逐字节一致; 无故障时有效吞吐接近链路带宽.
+ *          报告有效吞吐 (录音字节 / 链路字节) 和重发量. 对照项为断开后从头重发的上传方式. 任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Itools/upload_host/include -Itools/dsp_host/include -Imain \
+ *                tools/upload_host/upload_host_check.c main/audio_upload.c -lm -o /tmp/upload_host_check
+ *            /tmp/upload_host_check
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_upload.h"
+#include "esp_rom_crc.h"
+
+#define CHUNK           4096            // AUDIO_OUTBOX_CHUNK_SIZE
+#define WINDOW          8               // AUDIO_OUTBOX_WINDOW
+#define ACK_TIMEOUT_US  3000000         // OUTBOX_ACK_TIMEOUT_MS
+#define SNDBUF          5760            // CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+#define STEP_US         250
+#define MAX_FRAMES      4096
+#define RUNS            40
+#define TIME_LIMIT_US   (300LL * 1000000)
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+/* 简单可复现的随机数 */
+static uint64_t s_rng;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 16);
+}
+
+static double rnd_unit(void)
+{
+    return (rnd() & 0xFFFFFF) / (double)0x1000000;
+}
+
+/* ---------------- 链路 ---------------- */
+
+typedef enum {
+    FRAME_BEGIN,                // 上行: upload_begin
+    FRAME_CHUNK,                // 上行: 分块头部 + 数据, 同一帧
+    FRAME_HEADER,               // 上行: 单独的分块头部帧
+    FRAME_PAYLOAD,              // 上行: 头部帧之后的分块数据帧
+    FRAME_ACK,                  // 下行: upload_ack
+    FRAME_NACK,                 // 下行: upload_nack
+} frame_type_t;
+
+typedef struct {
+    int64_t arrive_us;
+    uint32_t epoch;             // 连接编号, 断开后旧连接的帧丢弃
+    frame_type_t type;
+    audio_upload_chunk_hdr_t hdr;
+    const uint8_t *payload;     // 指向源数据 (零拷贝)
+    size_t len;
+    bool corrupt;               // 数据被篡改 (最后一个字节取反)
+} frame_t;
+
+typedef struct {
+    frame_t q[MAX_FRAMES];
+    int head, count;
+} frame_queue_t;
+
+static void fq_push(frame_queue_t *fq, const frame_t *f)
+{
+    if (fq->count == MAX_FRAMES) {
+        fprintf(stderr, "帧队列溢出\n");
+        exit(2);
+    }
+    fq->q[(fq->head + fq->count++) % MAX_FRAMES] = *f;
+}
+
+static bool fq_pop_due(frame_queue_t *fq, int64_t now, frame_t *f)
+{
+    if (fq->count == 0 || fq->q[fq->head].arrive_us > now) {
+        return false;
+    }
+    *f = fq->q[fq->head];
+    fq->head = (fq->head + 1) % MAX_FRAMES;
+    fq->count--;
+    return true;
+}
+
+typedef struct {
+    double bandwidth;           // 上行字节/秒
+    int64_t latency_us;         // 单向时延
+    double kill_mean_s;         // 平均多久断开一次, 0 表示不断开
+    double corrupt_prob;        // 每个分块被篡改的概率
+    bool restart_from_zero;     // 对照: 断开后从头重发
+} link_cfg_t;
+
+typedef struct {
+    bool ok;                    // 上传完成
+    bool data_ok;               // 服务器数据与源数据一致
+    double seconds;
+    size_t wire_bytes;          // 上行链路字节 (含帧头, 分块头部和重发)
+    uint32_t kills;
+    audio_upload_stats_t stats;
+} run_result_t;
+
+/* WebSocket 客户端帧开销: 2 字节基本头 + 4 字节掩码, 126..65535 字节时另加 2 字节长度 */
+static size_t ws_overhead(size_t len)
+{
+    return len < 126 ? 6 : 8;
+}
+
+/* ---------------- 服务器替身 ---------------- */
+
+typedef struct {
+    uint32_t id;
+    uint8_t *data;
+    size_t size;
+    size_t expected;            // 已连续收到的字节数
+    size_t nacked_at;           // 已对该偏移发送过否认, 之后不连续的分块直接丢弃
+    bool has_nacked;
+    bool pending_hdr;           // 收到头部帧, 等待数据帧
+    audio_upload_chunk_hdr_t hdr;
+} server_t;
+
+static void server_reply(frame_queue_t *down, int64_t now, const link_cfg_t *cfg, uint32_t epoch, frame_type_t type,
+                         const server_t *srv)
+{
+    frame_t f = {.arrive_us = now + cfg->latency_us, .epoch = epoch, .type = type, .len = srv->expected};
+    f.hdr.upload_id = srv->id;
+    fq_push(down, &f);
+}
+
+static void server_on_frame(server_t *srv, const frame_t *f, frame_queue_t *down, int64_t now, const link_cfg_t *cfg)
+{
+    if (f->type == FRAME_BEGIN) {
+        srv->pending_hdr = false;
+        srv->has_nacked = false;
+        server_reply(down, now, cfg, f->epoch, FRAME_ACK, srv);
+        return;
+    }
+    if (f->type == FRAME_HEADER || f->type == FRAME_CHUNK) {
+        audio_upload_chunk_hdr_t hdr;
+        if (audio_upload_parse_header(&f->hdr, sizeof(f->hdr), &hdr) == ESP_OK && hdr.upload_id == srv->id) {
+            srv->hdr = hdr;
+            srv->pending_hdr = true;
+        }
+        if (f->type == FRAME_HEADER) {
+            return;
+        }
+    }
+    if ((f->type != FRAME_PAYLOAD && f->type != FRAME_CHUNK) || !srv->pending_hdr) {
+        return;
+    }
+    srv->pending_hdr = false;
+    const audio_upload_chunk_hdr_t *h = &srv->hdr;
+
+    static uint8_t buf[CHUNK];
+    memcpy(buf, f->payload, f->len);
+    if (f->corrupt) {
+        buf[f->len - 1] ^= 0xFF;
+    }
+    bool crc_ok = (h->len == f->len && esp_rom_crc32_le(0, buf, f->len) == h->crc32 && h->seq == h->offset / CHUNK &&
+                   h->offset + h->len <= srv->size);
+
+    if (h->offset < srv->expected) {
+        server_reply(down, now, cfg, f->epoch, FRAME_ACK, srv);         // 重复的分块
+    } else if (h->offset == srv->expected && crc_ok) {
+        memcpy(srv->data + h->offset, buf, h->len);
+        srv->expected += h->len;
+        srv->has_nacked = false;
+        server_reply(down, now, cfg, f->epoch, FRAME_ACK, srv);
+    } else if (!srv->has_nacked || srv->nacked_at != srv->expected) {
+        // CRC 错误或不连续: 对同一偏移只否认一次, 之后在途的分块直接丢弃
+        srv->has_nacked = true;
+        srv->nacked_at = srv->expected;
+        server_reply(down, now, cfg, f->epoch, FRAME_NACK, srv);
+    }
+}
+
+/* ---------------- 设备 (audio_outbox 上传流程) ---------------- */
+
+typedef enum {
+    DEV_DISCONNECTED,
+    DEV_WAIT_BEGIN,
+    DEV_SENDING,
+} dev_state_t;
+
+static run_result_t run_upload(const uint8_t *src, size_t size, const link_cfg_t *cfg, uint64_t seed)
+{
+    static frame_queue_t up_q, down_q;
+    memset(&up_q, 0, sizeof(up_q));
+    memset(&down_q, 0, sizeof(down_q));
+    s_rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+
+    run_result_t res = {0};
+    server_t srv = {.id = rnd(), .size = size};
+    srv.data = calloc(1, size);
+
+    audio_upload_t up;
+    audio_upload_init(&up, srv.id, size, CHUNK, WINDOW);
+
+    int64_t now = 0;
+    uint32_t epoch = 1;
+    int64_t link_free = 0;
+    int64_t next_kill = cfg->kill_mean_s > 0 ? (int64_t)(-log(1.0 - rnd_unit()) * cfg->kill_mean_s * 1e6) : INT64_MAX;
+    dev_state_t st = DEV_WAIT_BEGIN;
+    int64_t deadline = 0;
+    int64_t reconnect_at = 0;
+    int64_t last_progress = 0;
+    bool begin_pending = true;
+
+    while (!audio_upload_done(&up) && now < TIME_LIMIT_US) {
+        // 随机断开: 双向在途的帧全部丢失
+        if (now >= next_kill) {
+            res.kills++;
+            epoch++;
+            up_q.count = 0;
+            down_q.count = 0;
+            link_free = now;
+            st = DEV_DISCONNECTED;
+            reconnect_at = now + 300000 + (int64_t)(rnd_unit() * 700000);
+            next_kill = reconnect_at + (int64_t)(-log(1.0 - rnd_unit()) * cfg->kill_mean_s * 1e6);
+        }
+        if (st == DEV_DISCONNECTED && now >= reconnect_at) {
+            st = DEV_WAIT_BEGIN;
+            begin_pending = true;
+        }
+
+        // 上行帧到达服务器, 下行帧到达设备
+        frame_t f;
+        while (fq_pop_due(&up_q, now, &f)) {
+            if (f.epoch == epoch) {
+                server_on_frame(&srv, &f, &down_q, now, cfg);
+            }
+        }
+        bool progress = false;
+        while (fq_pop_due(&down_q, now, &f)) {
+            if (f.epoch != epoch || f.hdr.upload_id != up.id) {
+                continue;
+            }
+            if (st == DEV_WAIT_BEGIN) {
+                // upload_begin 的确认: 从服务器已收到的偏移续传
+                if (cfg->restart_from_zero) {
+                    srv.expected = 0;
+                    audio_upload_on_resume(&up, 0);
+                } else if (f.len > 0 || up.high_water > 0) {
+                    audio_upload_on_resume(&up, f.len);
+                }
+                st = DEV_SENDING;
+                last_progress = now;
+            } else if (f.type == FRAME_NACK) {
+                audio_upload_on_nack(&up, f.len);
+                progress = true;
+            } else if (audio_upload_on_ack(&up, f.len)) {
+                progress = true;
+            }
+        }
+        if (progress) {
+            last_progress = now;
+        }
+
+        if (st == DEV_WAIT_BEGIN && begin_pending) {
+            frame_t b = {.arrive_us = now + cfg->latency_us + (int64_t)(200 / cfg->bandwidth * 1e6), .epoch = epoch,
+                         .type = FRAME_BEGIN};
+            res.wire_bytes += 200;
+            fq_push(&up_q, &b);
+            begin_pending = false;
+            deadline = now + ACK_TIMEOUT_US;
+        } else if (st == DEV_WAIT_BEGIN && now >= deadline) {
+            begin_pending = true;       // 重发 upload_begin
+        }
+
+        if (st == DEV_SENDING) {
+            // TCP 发送缓冲有空间时才能继续发送
+            size_t off, n;
+            while ((link_free - now) * cfg->bandwidth / 1e6 < SNDBUF && audio_upload_next(&up, &off, &n)) {
+                frame_t c = {.epoch = epoch, .type = FRAME_CHUNK, .payload = src + off, .len = n,
+                             .corrupt = rnd_unit() < cfg->corrupt_prob};
+                audio_upload_fill_header(&up, off, src + off, n, &c.hdr);
+                size_t bytes = sizeof(c.hdr) + n + ws_overhead(sizeof(c.hdr) + n);
+                int64_t start = link_free > now ? link_free : now;
+                link_free = start + (int64_t)(bytes / cfg->bandwidth * 1e6);
+                c.arrive_us = link_free + cfg->latency_us;
+                fq_push(&up_q, &c);
+                res.wire_bytes += bytes;
+            }
+            if (audio_upload_in_flight(&up) && now - last_progress > ACK_TIMEOUT_US) {
+                audio_upload_on_timeout(&up);
+                last_progress = now;
+            }
+        }
+        now += STEP_US;
+    }
+
+    res.ok = audio_upload_done(&up);
+    res.data_ok = res.ok && srv.expected == size && memcmp(srv.data, src, size) == 0;
+    res.seconds = now / 1e6;
+    res.stats = up.stats;
+    free(srv.data);
+    return res;
+}
+
+/* ---------------- 场景 ---------------- */
+
+typedef struct {
+    uint32_t runs;
+    uint32_t completed;
+    uint32_t data_ok;
+    uint32_t kills;
+    double goodput_sum;         // 录音字节 / 链路字节
+    double rate_sum;            // 录音字节 / 用时, KB/s
+    double worst_seconds;
+    size_t retransmitted;
+    uint32_t nacks, timeouts, resumes;
+} scenario_t;
+
+static scenario_t run_scenario(const char *name, const uint8_t *src, size_t size, const link_cfg_t *cfg, int runs)
+{
+    scenario_t sc = {0};
+    for (int i = 0; i < runs; i++) {
+        run_result_t r = run_upload(src, size, cfg, (uint64_t)i + 1);
+        sc.runs++;
+        sc.completed += r.ok;
+        sc.data_ok += r.data_ok;
+        sc.kills += r.kills;
+        if (r.ok) {
+            sc.goodput_sum += (double)size / r.wire_bytes;
+            sc.rate_sum += size / 1024.0 / r.seconds;
+        }
+        if (r.seconds > sc.worst_seconds) {
+            sc.worst_seconds = r.seconds;
+        }
+        sc.retransmitted += r.stats.retransmitted_bytes;
+        sc.nacks += r.stats.nacks;
+        sc.timeouts += r.stats.timeouts;
+        sc.resumes += r.stats.resumes;
+    }
+    double done = sc.completed > 0 ? sc.completed : 1;
+    printf("%s (%u 次, 每次 %u KB):\n", name, sc.runs, (unsigned int)(size / 1024));
+    printf("    完成 %u/%u, 断开 %u 次 (平均每次上传 %.1f), 最长用时 %.1f s\n", sc.completed, sc.runs, sc.kills,
+           (double)sc.kills / sc.runs, sc.worst_seconds);
+    printf("    有效吞吐 %.1f%% (录音字节/链路字节), 平均速率 %.1f KB/s (链路 %.0f KB/s)\n",
+           100.0 * sc.goodput_sum / done, sc.rate_sum / done, cfg->bandwidth / 1024);
+    printf("    重发 %u KB, 否认 %u, 确认超时 %u, 续传 %u\n", (unsigned int)(sc.retransmitted / 1024), sc.nacks,
+           sc.timeouts, sc.resumes);
+    return sc;
+}
+
+int main(void)
+{
+    // 非整块长度的源数据, 最后一块不足 CHUNK
+    const size_t size = 1000003;
+    uint8_t *src = malloc(size);
+    s_rng = 12345;
+    for (size_t i = 0; i < size; i++) {
+        src[i] = (uint8_t)(rnd() >> 8);
+    }
+
+    link_cfg_t clean = {.bandwidth = 250 * 1024, .latency_us = 15000};
+    link_cfg_t faulty = clean;
+    faulty.kill_mean_s = 1.5;
+    faulty.corrupt_prob = 0.002;
+    link_cfg_t restart = faulty;
+    restart.corrupt_prob = 0;
+    restart.restart_from_zero = true;
+
+    printf("分块 %d 字节, 窗口 %d 块, 发送缓冲 %d 字节, 单向时延 %lld ms\n\n", CHUNK, WINDOW, SNDBUF,
+           (long long)clean.latency_us / 1000);
+
+    scenario_t a = run_scenario("无故障", src, size, &clean, 1);
+    check(a.completed == a.runs && a.data_ok == a.runs, "完成且数据逐字节一致");
+    check(a.goodput_sum / a.runs > 0.99, "有效吞吐 > 99%");
+    check(a.rate_sum / a.runs > 0.9 * clean.bandwidth / 1024, "速率 > 链路带宽的 90% (窗口足以覆盖往返时延)");
+    check(a.retransmitted == 0, "没有重发");
+
+    scenario_t b = run_scenario("随机断开 (平均 1.5 s) + 分块篡改 0.2%", src, size, &faulty, RUNS);
+    check(b.completed == b.runs, "每次都完成上传");
+    check(b.data_ok == b.runs, "服务器数据与源数据逐字节一致");
+    check(b.kills >= b.runs, "每次上传平均至少断开一次");
+    check(b.nacks > 0, "篡改的分块被 CRC 检出并否认");
+    check(b.goodput_sum / b.completed > 0.9, "有效吞吐 > 90% (断开只重发未确认的窗口)");
+
+    scenario_t c = run_scenario("对照: 断开后从头重发", src, size, &restart, RUNS);
+    printf("    续传相对从头重发: 链路字节减少 %.0f%%\n",
+           100.0 * (1.0 - (c.goodput_sum / (c.completed ? c.completed : 1)) / (b.goodput_sum / b.completed)));
+
+    free(src);
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
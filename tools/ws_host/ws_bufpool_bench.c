@@ -0,0 +1,253 @@
+/**
+ * @file ws_bufpool_bench.c
+ * @brief WebSocket 动态缓冲区池 (esp_websocket_bufpool.c) 的主机基准与验证
+ * @details 在主机上编译 components/esp_websocket_client/esp_websocket_bufpool.c, 链接时包装 malloc/calloc/free 计数:
+ *          - 堆分配次数: 模拟繁忙连接 (每条消息一次接收、一次发送, 与 CONFIG_ESP_WS_CLIENT_ENABLE_DYNAMIC_BUFFER
+ *            下 esp_websocket_new_buf()/esp_websocket_free_buf() 的调用顺序相同), 比较原来每次 calloc/free
+ *            和每客户端池、共享池的分配器调用次数
+ *          - 取还时延: 每对 取出+归还 的耗时 (p50/p99, 按批计时), 主机 glibc 的分配器比芯片上的堆 (加锁、
+ *            多个堆区) 快得多, 这里只能说明池本身的开销
+ *          - 空闲回收: 流量停止超过空闲时间后 trim 把缓存的缓冲区全部释放, 之后没有驻留的缓冲区
+ *          - 并发: 多个线程 (相当于多个客户端任务) 共用一个池, 每个线程在取到的缓冲区里写入自己的标记再检查,
+ *            验证同一缓冲区不会同时交给两个线程, 结束时分配与释放次数相等 (无泄漏)
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Icomponents/esp_websocket_client/private_include tools/ws_host/ws_bufpool_bench.c \
+ *                components/esp_websocket_client/esp_websocket_bufpool.c -lpthread \
+ *                -Wl,--wrap=malloc,--wrap=calloc,--wrap=free -o /tmp/ws_bufpool_bench
+ *            /tmp/ws_bufpool_bench
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_websocket_bufpool.h"
+
+#define BUFFER_SIZE     1024                // WEBSOCKET_BUFFER_SIZE_BYTE
+#define MESSAGES        1000000
+#define IDLE_MS         5000                // CONFIG_ESP_WS_CLIENT_BUFFER_POOL_IDLE_MS
+#define BATCH           64                  // 按批计时, 避免时钟本身的开销
+#define THREADS         4
+#define SHARED_SLOTS    4
+#define THREAD_ROUNDS   500000
+
+static int s_failures = 0;
+static atomic_long s_mallocs, s_frees;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void __real_free(void *p);
+
+void *__wrap_malloc(size_t size)
+{
+    atomic_fetch_add(&s_mallocs, 1);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    atomic_fetch_add(&s_mallocs, 1);
+    return __real_calloc(n, size);
+}
+
+void __wrap_free(void *p)
+{
+    if (p) {
+        atomic_fetch_add(&s_frees, 1);
+    }
+    __real_free(p);
+}
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* ---------------- 单客户端: 原方式与池 ---------------- */
+
+typedef struct {
+    esp_websocket_bufpool_t *pool;      // NULL: 原来的 calloc/free
+    char *rx_buffer;
+    char *tx_buffer;
+} client_t;
+
+/* 经函数指针调用, 防止编译器把成对的 calloc/free 优化掉 */
+static void *(*volatile s_calloc)(size_t, size_t) = calloc;
+static void (*volatile s_free)(void *) = free;
+
+static char *buf_alloc(client_t *c)
+{
+    return c->pool ? esp_websocket_bufpool_get(c->pool) : s_calloc(1, BUFFER_SIZE);
+}
+
+static void buf_release(client_t *c, char *buf, uint32_t now_ms)
+{
+    if (c->pool) {
+        esp_websocket_bufpool_put(c->pool, buf, now_ms);
+    } else {
+        s_free(buf);
+    }
+}
+
+typedef struct {
+    double allocs_per_msg;
+    double p50_ns, p99_ns;
+    int cached_after_idle;
+    bool ok;
+} result_t;
+
+static result_t run_client(esp_websocket_bufpool_t *pool)
+{
+    static double samples[MESSAGES / BATCH];
+    client_t c = {.pool = pool};
+    static char payload[BUFFER_SIZE];
+    uint32_t now_ms = 0;
+    result_t r = {.ok = true};
+
+    long m0 = atomic_load(&s_mallocs);
+    for (int b = 0; b < MESSAGES / BATCH; b++) {
+        int64_t t0 = now_ns();
+        for (int i = 0; i < BATCH; i++) {
+            // esp_websocket_client_recv(): new_buf(rx) ... free_buf(rx)
+            c.rx_buffer = buf_alloc(&c);
+            c.rx_buffer[0] = (char)i;
+            buf_release(&c, c.rx_buffer, now_ms);
+            c.rx_buffer = NULL;
+            // esp_websocket_client_send_with_exact_opcode(): new_buf(tx) ... free_buf(tx)
+            c.tx_buffer = buf_alloc(&c);
+            memcpy(c.tx_buffer, payload, 64);
+            buf_release(&c, c.tx_buffer, now_ms);
+            c.tx_buffer = NULL;
+        }
+        samples[b] = (double)(now_ns() - t0) / (2 * BATCH);
+        now_ms += 1;
+    }
+    r.allocs_per_msg = (double)(atomic_load(&s_mallocs) - m0) / MESSAGES;
+    qsort(samples, MESSAGES / BATCH, sizeof(double), cmp_double);
+    r.p50_ns = samples[MESSAGES / BATCH / 2];
+    r.p99_ns = samples[MESSAGES / BATCH * 99 / 100];
+
+    if (pool) {
+        // 空闲: 未到时间不回收, 超过空闲时间全部释放
+        r.ok = esp_websocket_bufpool_trim(pool, now_ms + IDLE_MS / 2) == 0 && esp_websocket_bufpool_cached(pool) > 0;
+        esp_websocket_bufpool_trim(pool, now_ms + IDLE_MS);
+        r.cached_after_idle = esp_websocket_bufpool_cached(pool);
+    }
+    return r;
+}
+
+/* ---------------- 共享池并发 ---------------- */
+
+typedef struct {
+    esp_websocket_bufpool_t *pool;
+    int id;
+    bool ok;
+} worker_t;
+
+static void *worker(void *arg)
+{
+    worker_t *w = arg;
+    w->ok = true;
+    for (int i = 0; i < THREAD_ROUNDS; i++) {
+        // 同时持有 rx 和 tx 两个缓冲区 (发送在接收回调里)
+        uint8_t *a = esp_websocket_bufpool_get(w->pool);
+        uint8_t *b = esp_websocket_bufpool_get(w->pool);
+        if (a == NULL || b == NULL) {
+            w->ok = false;
+            break;
+        }
+        uint8_t mark = (uint8_t)(w->id * 64 + (i & 63));
+        uint8_t inv = (uint8_t)~mark;
+        memset(a, mark, 64);
+        memset(b, inv, 64);
+        for (int k = 0; k < 64; k++) {
+            w->ok = w->ok && a[k] == mark && b[k] == inv;
+        }
+        esp_websocket_bufpool_put(w->pool, b, (uint32_t)i);
+        esp_websocket_bufpool_put(w->pool, a, (uint32_t)i);
+        if ((i & 1023) == 0) {
+            esp_websocket_bufpool_trim(w->pool, (uint32_t)i);
+        }
+    }
+    return NULL;
+}
+
+static bool run_shared(double *allocs_per_pair)
+{
+    esp_websocket_bufpool_slot_t slots[SHARED_SLOTS];
+    esp_websocket_bufpool_t pool;
+    esp_websocket_bufpool_init(&pool, slots, SHARED_SLOTS, BUFFER_SIZE, IDLE_MS);
+    long m0 = atomic_load(&s_mallocs), f0 = atomic_load(&s_frees);
+
+    pthread_t t[THREADS];
+    worker_t w[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        w[i] = (worker_t) {
+            .pool = &pool, .id = i
+        };
+        pthread_create(&t[i], NULL, worker, &w[i]);
+    }
+    bool ok = true;
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(t[i], NULL);
+        ok = ok && w[i].ok;
+    }
+    *allocs_per_pair = (double)(atomic_load(&s_mallocs) - m0) / (THREADS * THREAD_ROUNDS);
+    esp_websocket_bufpool_drain(&pool);
+    long allocs = atomic_load(&s_mallocs) - m0, frees = atomic_load(&s_frees) - f0;
+    printf("    %d 线程共用 %d 个槽, 每线程 %d 轮 (每轮同时持有 2 个): 分配 %ld 次, 释放 %ld 次, 命中 %u, 满时释放 %u\n",
+           THREADS, SHARED_SLOTS, THREAD_ROUNDS, allocs, frees, atomic_load(&pool.hits), atomic_load(&pool.overflow));
+    return ok && allocs == frees && esp_websocket_bufpool_cached(&pool) == 0;
+}
+
+int main(void)
+{
+    printf("%d 条消息 (每条一次接收、一次发送), 缓冲区 %d 字节, 空闲回收 %d ms\n\n", MESSAGES, BUFFER_SIZE, IDLE_MS);
+
+    result_t orig = run_client(NULL);
+    esp_websocket_bufpool_slot_t slots[2];
+    esp_websocket_bufpool_t pool;
+    esp_websocket_bufpool_init(&pool, slots, 2, BUFFER_SIZE, IDLE_MS);
+    result_t pooled = run_client(&pool);
+    esp_websocket_bufpool_drain(&pool);
+
+    printf("    %-22s 每条消息分配 %5.3f 次   取还 p50 %5.1f ns  p99 %5.1f ns\n", "原方式 (calloc/free)",
+           orig.allocs_per_msg, orig.p50_ns, orig.p99_ns);
+    printf("    %-22s 每条消息分配 %5.3f 次   取还 p50 %5.1f ns  p99 %5.1f ns   空闲后驻留 %d 个\n\n", "每客户端池",
+           pooled.allocs_per_msg, pooled.p50_ns, pooled.p99_ns, pooled.cached_after_idle);
+
+    check(orig.allocs_per_msg > 1.99, "原方式每条消息分配两次");
+    check(pooled.allocs_per_msg < 1e-5, "池: 预热后不再分配");
+    check(pooled.ok && pooled.cached_after_idle == 0, "池: 未到空闲时间不回收, 超过后全部释放");
+    check(pooled.p50_ns < orig.p50_ns, "池的取还比 calloc/free 快");
+
+    double shared_allocs;
+    bool shared_ok = run_shared(&shared_allocs);
+    check(shared_ok, "共享池: 缓冲区不会同时交给两个线程, 分配与释放相等, 清空后无驻留");
+    check(shared_allocs < 0.05, "共享池: 槽位足够时极少分配");
+
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,535 @@
+/**
+ * @file ws_conn_soak.c
+ * @brief WebSocket 连接管理策略 (main/ws_conn.c) 的主机浸泡测试
+ * @details 三部分:
+ *          - 服务器反复启停: 回环 TCP 服务器按固定随机序列 "在线 1~4 秒 / 离线 0.3~3 秒" 反复启停, 离线时关闭
+ *            监听套接字和全部连接. 64 个设备线程各自连接 (服务器接受后发 1 字节相当于握手完成), 断开或连接失败后
+ *            按策略等待再连. 时间按 1/20 缩放 (退避 1~5 秒 -> 50~250 ms). 与原来的方式对比: 客户端固定 5 秒
+ *            重连, 加上 app_main 每秒检查一次、发现断开就销毁客户端、等 1 秒再重建 (实际每 ~2 秒重试一次, 不退避,
+ *            不抖动). 比较连接尝试总数、服务器重新上线后任意 50 ms 内完成的握手峰值 (重连风暴)、上线后设备重新连上的时间,
+ *            并核对指标: 各设备连接次数之和等于服务器完成的握手数, 失败次数等于被拒绝的尝试数.
+ *          - 退避分布: 1000 台设备同一时刻断开, 统计第一次和第五次重连时刻在 10 ms 格子里的最大堆积.
+ *          - NAT 自适应 PING (虚拟时间): 只有 PING/PONG 的空闲连接经过 NAT, 空闲超过 NAT 超时映射失效, 下一个
+ *            PING 得不到回应, PONG 超时 (10 秒) 后断开. 模拟 24 小时, 验证 PING 间隔收敛到 NAT 超时以下、
+ *            空闲断开次数有限、收敛后不再断开; NAT 超时变短 (换网络) 后重新收敛; 没有 NAT 时延长到最大值.
+ *          DNS 缓存在 esp_websocket_client.c 中, 依赖 lwIP, 不在本测试范围.
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Imain tools/ws_host/ws_conn_soak.c main/ws_conn.c -lpthread -o /tmp/ws_conn_soak
+ *            /tmp/ws_conn_soak
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "ws_conn.h"
+
+#define SCALE               20              // 时间缩放: 测试中 1 ms = 实际 20 ms
+#define DEVICES             64
+#define SOAK_MS             20000
+#define MAX_ATTEMPTS        200000
+#define MAX_FLAPS           64
+#define WINDOW_MS           50
+
+/* board.h 的取值, 按 SCALE 缩放 */
+#define BACKOFF_MIN_MS      (1000 / SCALE)
+#define BACKOFF_MAX_MS      (5000 / SCALE)  // CONFIG_WS_RECONNECT_INTERVAL_MS
+#define STABLE_MS           (60000 / SCALE)
+#define OLD_RECONNECT_MS    (5000 / SCALE)  // 原来的 CONFIG_WS_RECONNECT_INTERVAL_MS
+#define OLD_LOOP_MS         (1000 / SCALE)  // app_main 每秒检查一次, 重建前等 1 秒
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static int64_t s_t0_ns;
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((ts.tv_sec * 1000000000LL + ts.tv_nsec - s_t0_ns) / 1000000);
+}
+
+static void sleep_ms(uint32_t ms)
+{
+    struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+static uint32_t xorshift(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+/* ---------------- 反复启停的服务器 ---------------- */
+
+typedef struct {
+    uint32_t up_ms, down_ms;        // 上线时刻, 之后离线的时刻
+} flap_t;
+
+static struct {
+    uint16_t port;
+    atomic_bool stop;
+    atomic_int handshakes;
+    uint32_t handshake_at[MAX_ATTEMPTS];
+    flap_t flaps[MAX_FLAPS];
+    int flap_count;
+} s_srv;
+
+static int listen_on(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (bind(fd, (struct sockaddr *)&a, sizeof(a)) != 0 || listen(fd, 512) != 0) {
+        perror("listen");
+        exit(2);
+    }
+    return fd;
+}
+
+static void *server_thread(void *arg)
+{
+    (void)arg;
+    uint32_t rng = 12345;           // 两种方式看到相同的启停序列
+    int conns[DEVICES * 4];
+    int nconns = 0;
+    s_srv.flap_count = 0;
+    while (!atomic_load(&s_srv.stop) && s_srv.flap_count < MAX_FLAPS) {
+        int lfd = listen_on(s_srv.port);
+        flap_t *f = &s_srv.flaps[s_srv.flap_count++];
+        f->up_ms = now_ms();
+        uint32_t until = f->up_ms + 1000 + xorshift(&rng) % 3000;
+        while (!atomic_load(&s_srv.stop) && (int32_t)(until - now_ms()) > 0) {
+            struct pollfd p = {.fd = lfd, .events = POLLIN};
+            if (poll(&p, 1, 5) > 0) {
+                int c = accept(lfd, NULL, NULL);
+                if (c < 0) {
+                    continue;
+                }
+                if (nconns == (int)(sizeof(conns) / sizeof(conns[0])) || write(c, "H", 1) != 1) {
+                    close(c);
+                    continue;
+                }
+                conns[nconns++] = c;
+                int n = atomic_fetch_add(&s_srv.handshakes, 1);
+                if (n < MAX_ATTEMPTS) {
+                    s_srv.handshake_at[n] = now_ms();
+                }
+            }
+            // 回收已被设备关闭的连接
+            for (int i = 0; i < nconns; i++) {
+                char b;
+                if (recv(conns[i], &b, 1, MSG_DONTWAIT) == 0) {
+                    close(conns[i]);
+                    conns[i--] = conns[--nconns];
+                }
+            }
+        }
+        close(lfd);
+        for (int i = 0; i < nconns; i++) {
+            close(conns[i]);
+        }
+        nconns = 0;
+        f->down_ms = now_ms();
+        sleep_ms(300 + xorshift(&rng) % 2700);
+    }
+    return NULL;
+}
+
+/* ---------------- 设备 ---------------- */
+
+typedef enum {
+    MODE_OLD,                       // 固定间隔 + app_main 销毁重建
+    MODE_WS_CONN,                   // ws_conn 退避
+} mode_t_;
+
+static struct {
+    mode_t_ mode;
+    atomic_int count;               // 连接尝试次数
+    atomic_int refused;
+} s_att;
+
+typedef struct {
+    int id;
+    ws_conn_t conn;
+    uint32_t loop_phase;            // app_main 主循环的相位
+    uint32_t min_backoff, max_backoff;
+    int connects;
+    uint32_t *reconnected_at;       // 每次连上的时刻
+    int reconnected_count;
+    double connected_ms;
+} device_t;
+
+/* 连接并等待握手字节; 返回套接字, 失败返回 -1 */
+static int device_connect(void)
+{
+    atomic_fetch_add(&s_att.count, 1);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a = {.sin_family = AF_INET, .sin_port = htons(s_srv.port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (connect(fd, (struct sockaddr *)&a, sizeof(a)) != 0) {
+        close(fd);
+        atomic_fetch_add(&s_att.refused, 1);
+        return -1;
+    }
+    struct pollfd p = {.fd = fd, .events = POLLIN};
+    char b;
+    if (poll(&p, 1, 1000) != 1 || read(fd, &b, 1) != 1) {
+        close(fd);
+        atomic_fetch_add(&s_att.refused, 1);
+        return -1;
+    }
+    return fd;
+}
+
+/* 原方式: 断开后在 app_main 的下一个检查点销毁客户端, 等 1 秒重建并立即连接; 客户端自己的 5 秒重连来不及触发 */
+static uint32_t old_delay(device_t *d, uint32_t now)
+{
+    uint32_t to_tick = (d->loop_phase + OLD_LOOP_MS - now % OLD_LOOP_MS) % OLD_LOOP_MS;
+    uint32_t delay = to_tick + OLD_LOOP_MS;
+    return delay < OLD_RECONNECT_MS ? delay : OLD_RECONNECT_MS;
+}
+
+static void *device_thread(void *arg)
+{
+    device_t *d = arg;
+    while (now_ms() < SOAK_MS) {
+        int fd = device_connect();
+        uint32_t now = now_ms();
+        if (fd >= 0) {
+            d->connects++;
+            d->reconnected_at[d->reconnected_count++] = now;
+            ws_conn_on_connected(&d->conn, now);
+            // 保持连接直到服务器关闭
+            struct pollfd p = {.fd = fd, .events = POLLIN};
+            char b;
+            while (now_ms() < SOAK_MS) {
+                if (poll(&p, 1, 20) == 1 && read(fd, &b, 1) <= 0) {
+                    break;
+                }
+            }
+            close(fd);
+            d->connected_ms += now_ms() - now;
+            now = now_ms();
+        }
+        uint32_t delay = ws_conn_on_disconnected(&d->conn, now);
+        if (s_att.mode == MODE_OLD) {
+            delay = old_delay(d, now);
+        } else {
+            d->min_backoff = delay < d->min_backoff ? delay : d->min_backoff;
+            d->max_backoff = delay > d->max_backoff ? delay : d->max_backoff;
+        }
+        sleep_ms(delay);
+    }
+    return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+typedef struct {
+    int attempts;
+    int peak;                       // 服务器重新上线后任意 WINDOW_MS 内最多完成的握手数
+    uint32_t p50_ms, p99_ms, max_ms;// 服务器上线到设备连上
+    double connected_pct;           // 设备在线时间 / 服务器在线时间
+    bool metrics_ok;
+    bool backoff_ok;
+} soak_result_t;
+
+static soak_result_t run_soak(mode_t_ mode, uint16_t port)
+{
+    static device_t dev[DEVICES];
+    static uint32_t latencies[DEVICES * MAX_FLAPS];
+    soak_result_t r = {.metrics_ok = true, .backoff_ok = true};
+    memset(&s_srv, 0, sizeof(s_srv));
+    memset(&s_att, 0, sizeof(s_att));
+    s_srv.port = port;
+    s_att.mode = mode;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    s_t0_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+
+    pthread_t srv, th[DEVICES];
+    pthread_create(&srv, NULL, server_thread, NULL);
+    sleep_ms(50);
+    const ws_conn_config_t cfg = {
+        .backoff_min_ms = BACKOFF_MIN_MS,
+        .backoff_max_ms = BACKOFF_MAX_MS,
+        .stable_ms = STABLE_MS,
+        .ping_min_sec = 10,
+        .ping_max_sec = 10,
+    };
+    for (int i = 0; i < DEVICES; i++) {
+        free(dev[i].reconnected_at);
+        dev[i] = (device_t) {
+            .id = i, .loop_phase = (uint32_t)(i * 7919u) % OLD_LOOP_MS, .min_backoff = UINT32_MAX,
+            .reconnected_at = calloc(MAX_ATTEMPTS / DEVICES, sizeof(uint32_t)),
+        };
+        ws_conn_init(&dev[i].conn, &cfg, 0x1234567u + (uint32_t)i * 2654435761u, now_ms());
+        pthread_create(&th[i], NULL, device_thread, &dev[i]);
+    }
+    for (int i = 0; i < DEVICES; i++) {
+        pthread_join(th[i], NULL);
+    }
+    atomic_store(&s_srv.stop, true);
+    pthread_join(srv, NULL);
+
+    // 第一次上线 (设备同时启动) 之后的握手峰值
+    r.attempts = atomic_load(&s_att.count);
+    int n = atomic_load(&s_srv.handshakes);
+    n = n < MAX_ATTEMPTS ? n : MAX_ATTEMPTS;
+    qsort(s_srv.handshake_at, n, sizeof(uint32_t), cmp_u32);
+    for (int i = 0, j = 0; i < n; i++) {
+        while (s_srv.handshake_at[i] - s_srv.handshake_at[j] >= WINDOW_MS) {
+            j++;
+        }
+        if (s_srv.flap_count > 1 && s_srv.handshake_at[j] >= s_srv.flaps[1].up_ms) {
+            r.peak = i - j + 1 > r.peak ? i - j + 1 : r.peak;
+        }
+    }
+
+    // 每次服务器上线后 (第一次之外) 每台设备第一次连上的时间
+    int nl = 0;
+    double up_total = 0;
+    for (int f = 0; f < s_srv.flap_count; f++) {
+        uint32_t down = s_srv.flaps[f].down_ms ? s_srv.flaps[f].down_ms : SOAK_MS;
+        up_total += (down < SOAK_MS ? down : SOAK_MS) - s_srv.flaps[f].up_ms;
+        if (f == 0 || s_srv.flaps[f].up_ms > SOAK_MS - BACKOFF_MAX_MS * 2) {
+            continue;
+        }
+        for (int i = 0; i < DEVICES; i++) {
+            for (int k = 0; k < dev[i].reconnected_count; k++) {
+                uint32_t t = dev[i].reconnected_at[k];
+                if (t >= s_srv.flaps[f].up_ms && t < down) {
+                    latencies[nl++] = t - s_srv.flaps[f].up_ms;
+                    break;
+                }
+            }
+        }
+    }
+    qsort(latencies, nl, sizeof(uint32_t), cmp_u32);
+    if (nl) {
+        r.p50_ms = latencies[nl / 2];
+        r.p99_ms = latencies[nl * 99 / 100];
+        r.max_ms = latencies[nl - 1];
+    }
+
+    int connects = 0, failed = 0;
+    double connected = 0;
+    for (int i = 0; i < DEVICES; i++) {
+        const ws_conn_stats_t *st = &dev[i].conn.stats;
+        connects += st->connects;
+        failed += st->failed_attempts;
+        connected += dev[i].connected_ms;
+        r.metrics_ok = r.metrics_ok && st->connects == (uint32_t)dev[i].connects &&
+                       st->disconnects == st->connects && (st->connects == 0 || st->reconnects + 1 == st->connects) &&
+                       st->max_reconnect_ms >= st->last_reconnect_ms &&
+                       (st->reconnects == 0 || st->total_reconnect_ms / st->reconnects <= st->max_reconnect_ms);
+        if (mode == MODE_WS_CONN) {
+            r.backoff_ok = r.backoff_ok && dev[i].min_backoff >= BACKOFF_MIN_MS / 2 &&
+                           dev[i].max_backoff <= BACKOFF_MAX_MS;
+        }
+    }
+    r.metrics_ok = r.metrics_ok && connects == atomic_load(&s_srv.handshakes) &&
+                   failed == atomic_load(&s_att.refused);
+    r.connected_pct = connected * 100.0 / (up_total * DEVICES);
+    printf("    服务器启停 %d 次, 握手 %d 次, 设备记录连接 %d 次, 被拒绝 %d 次, 设备记录失败 %d 次\n",
+           s_srv.flap_count, atomic_load(&s_srv.handshakes), connects, atomic_load(&s_att.refused), failed);
+    return r;
+}
+
+/* ---------------- 退避分布 ---------------- */
+
+static int peak_bin(const uint32_t *t, int n, uint32_t bin_ms)
+{
+    static int bins[100000];
+    memset(bins, 0, sizeof(bins));
+    int peak = 0;
+    for (int i = 0; i < n; i++) {
+        int b = (int)(t[i] / bin_ms);
+        if (b < 100000 && ++bins[b] > peak) {
+            peak = bins[b];
+        }
+    }
+    return peak;
+}
+
+static void run_spread(void)
+{
+    enum { N = 1000 };
+    static ws_conn_t c[N];
+    static uint32_t first[N], fifth[N];
+    const ws_conn_config_t cfg = {
+        .backoff_min_ms = 1000, .backoff_max_ms = 30000, .stable_ms = 60000, .ping_min_sec = 10, .ping_max_sec = 10,
+    };
+    bool bounded = true;
+    for (int i = 0; i < N; i++) {
+        ws_conn_init(&c[i], &cfg, 0xC0FFEEu + (uint32_t)i * 2654435761u, 0);
+        ws_conn_on_connected(&c[i], 0);
+        uint32_t t = 100000;        // 连接 100 秒后服务器重启, 所有设备同时断开
+        for (int k = 1; k <= 5; k++) {
+            uint32_t d = ws_conn_on_disconnected(&c[i], t);
+            uint32_t cap = 1000u << (k - 1);
+            bounded = bounded && d >= cap / 2 && d <= cap;
+            t += d;
+            if (k == 1) {
+                first[i] = t - 100000;
+            }
+        }
+        fifth[i] = t - 100000;
+    }
+    int p1 = peak_bin(first, N, 10), p5 = peak_bin(fifth, N, 10);
+    printf("    1000 台设备同时断开: 第一次重连 10 ms 内最多 %d 台 (固定间隔: 1000 台), 第五次 %d 台\n", p1, p5);
+    check(bounded, "退避: 第 n 次等待在 [min*2^(n-1)/2, min*2^(n-1)] 内");
+    check(p1 <= 40 && p5 <= 20, "退避: 同时断开的设备重连被分散 (10 ms 内不超过 4%)");
+
+    // 握手后立即被断开不清零, 保持 stable_ms 以上断开才清零; 上限不超过最大值
+    ws_conn_t x;
+    ws_conn_init(&x, &cfg, 1, 0);
+    uint32_t t = 0, d = 0;
+    for (int k = 0; k < 12; k++) {
+        ws_conn_on_connected(&x, t);
+        t += 100;
+        d = ws_conn_on_disconnected(&x, t);
+        t += d;
+    }
+    bool capped = x.stats.failures == 12 && d >= 15000 && d <= 30000;
+    ws_conn_on_connected(&x, t);
+    d = ws_conn_on_disconnected(&x, t + 60000);
+    check(capped && x.stats.failures == 1 && d <= 1000, "退避: 短连接继续退避且不超过上限, 稳定连接后从头开始");
+}
+
+/* ---------------- NAT 自适应 PING (虚拟时间) ---------------- */
+
+typedef struct {
+    uint32_t idle_timeouts;         // 模拟期间的空闲断开
+    uint32_t last_disconnect_s;     // 最后一次断开的时刻 (秒)
+    uint32_t pings;                 // 发出的 PING 数
+    uint16_t final_ping;
+    uint16_t min_ping_seen;
+} nat_result_t;
+
+/*
+ * 连接只有 PING/PONG: 客户端空闲 ping_sec 后发 PING (收到 PONG 算收到数据); NAT 映射在空闲 nat_timeout_s 后失效,
+ * 之后的 PING 没有回应, 10 秒后 PONG 超时断开, 按退避重连. 时间单位秒, 调用 ws_conn 时换算为毫秒.
+ */
+static nat_result_t simulate_nat(ws_conn_t *c, uint32_t *t_s, uint32_t duration_s, uint32_t nat_timeout_s)
+{
+    nat_result_t r = {.min_ping_seen = UINT16_MAX};
+    uint32_t end = *t_s + duration_s;
+    uint32_t t = *t_s;
+    ws_conn_on_connected(c, t * 1000);
+    uint32_t last_rx = t;
+    while (t < end) {
+        uint16_t ping = ws_conn_ping_sec(c);
+        r.min_ping_seen = ping < r.min_ping_seen ? ping : r.min_ping_seen;
+        t = last_rx + ping;         // 下一个 PING
+        r.pings++;
+        if (t - last_rx < nat_timeout_s) {
+            last_rx = t;            // PONG
+            ws_conn_on_rx(c, t * 1000);
+            continue;
+        }
+        t += 10;                    // PONG 超时
+        uint32_t delay = ws_conn_on_disconnected(c, t * 1000);
+        r.idle_timeouts++;
+        r.last_disconnect_s = t;
+        t += (delay + 999) / 1000 + 1;
+        ws_conn_on_connected(c, t * 1000);
+        last_rx = t;
+    }
+    r.final_ping = ws_conn_ping_sec(c);
+    *t_s = t;
+    return r;
+}
+
+static void run_nat(void)
+{
+    const ws_conn_config_t cfg = {
+        .backoff_min_ms = 1000, .backoff_max_ms = 30000, .stable_ms = 60000,
+        .ping_min_sec = 10, .ping_max_sec = 120, .ping_probe_ms = 600000,
+    };
+    ws_conn_t c;
+    uint32_t t = 0;
+    ws_conn_init(&c, &cfg, 7, 0);
+    nat_result_t a = simulate_nat(&c, &t, 24 * 3600, 45);
+    printf("    NAT 超时 45 秒, 24 小时: PING 间隔 10 -> %u 秒, 空闲断开 %u 次 (最后一次在第 %u 秒), PING %u 次 (固定 10 秒: %u 次)\n",
+           a.final_ping, a.idle_timeouts, a.last_disconnect_s, a.pings, 24 * 360);
+    check(a.final_ping >= 30 && a.final_ping < 45 && a.idle_timeouts <= 2 && a.last_disconnect_s < 6 * 3600,
+          "NAT: PING 间隔收敛到 NAT 超时的 2/3 以上且低于超时, 断开不超过 2 次, 之后不再断开");
+
+    uint32_t t_change = t;
+    nat_result_t b = simulate_nat(&c, &t, 24 * 3600, 20);
+    printf("    换到 NAT 超时 20 秒的网络: PING 间隔 -> %u 秒, 空闲断开 %u 次 (最后一次在变化后第 %u 秒)\n",
+           b.final_ping, b.idle_timeouts, b.last_disconnect_s - t_change);
+    check(b.final_ping >= 10 && b.final_ping < 20 && b.idle_timeouts <= 4 && b.last_disconnect_s - t_change < 6 * 3600 &&
+          b.min_ping_seen >= cfg.ping_min_sec, "NAT: 超时变短后重新收敛, 不低于最短间隔");
+
+    ws_conn_init(&c, &cfg, 7, 0);
+    t = 0;
+    nat_result_t n = simulate_nat(&c, &t, 24 * 3600, UINT32_MAX);
+    printf("    没有 NAT: PING 间隔 -> %u 秒, 空闲断开 %u 次\n", n.final_ping, n.idle_timeouts);
+    check(n.final_ping == cfg.ping_max_sec && n.idle_timeouts == 0, "NAT: 没有空闲超时时延长到最大值");
+
+    // 有数据时的断开 (服务器主动关闭) 不算 NAT 超时
+    ws_conn_init(&c, &cfg, 7, 0);
+    ws_conn_on_connected(&c, 0);
+    ws_conn_on_rx(&c, 5000);
+    ws_conn_on_disconnected(&c, 6000);
+    check(c.stats.idle_timeouts == 0 && c.stats.ping_fail_sec == 0, "NAT: 有数据往来时断开不计为空闲超时");
+}
+
+int main(void)
+{
+    printf("退避分布\n");
+    run_spread();
+
+    printf("\nNAT 自适应 PING (虚拟时间)\n");
+    run_nat();
+
+    printf("\n服务器反复启停 %d 秒 (时间缩放 1/%d), %d 台设备\n", SOAK_MS / 1000, SCALE, DEVICES);
+    soak_result_t old = run_soak(MODE_OLD, 47811);
+    soak_result_t pol = run_soak(MODE_WS_CONN, 47812);
+    printf("\n    %-30s 尝试 %6d 次  %d ms 内握手峰值 %3d  上线后连上 p50 %4u p99 %4u 最大 %4u ms  在线 %.1f%%\n",
+           "原方式 (固定间隔+销毁重建)", old.attempts, WINDOW_MS, old.peak, old.p50_ms, old.p99_ms, old.max_ms,
+           old.connected_pct);
+    printf("    %-30s 尝试 %6d 次  %d ms 内握手峰值 %3d  上线后连上 p50 %4u p99 %4u 最大 %4u ms  在线 %.1f%%\n\n",
+           "ws_conn (抖动指数退避)", pol.attempts, WINDOW_MS, pol.peak, pol.p50_ms, pol.p99_ms, pol.max_ms,
+           pol.connected_pct);
+    check(old.metrics_ok && pol.metrics_ok, "指标: 连接次数与服务器握手数、失败次数与被拒绝次数一致");
+    check(pol.backoff_ok, "退避: 每次等待在 [min/2, max] 内");
+    check(pol.attempts * 2 < old.attempts, "连接尝试不到原方式的一半");
+    check(pol.peak * 2 < old.peak, "服务器重新上线后的握手峰值不到原方式的一半");
+    check(pol.max_ms <= BACKOFF_MAX_MS + 200, "服务器上线后重新连上的时间不超过最大退避");
+
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,560 @@
+/**
+ * @file ws_failover_check.c
+ * @brief WebSocket 多服务器故障切换 (main/ws_endpoint.c) 的主机验证
+ * @details 三个回环 TCP 服务器代替 WebSocket 服务器, 各自模拟不同的网络时延 (一个往返): 接受连接后等一个时延再发
+ *          'g' (相当于 TCP 连接完成), 收到 'u' (TLS 握手 + HTTP 升级) 后等 HANDSHAKE_RTTS 个时延再回 'h' (握手完成),
+ *          收到 'p' (PING) 后等一个时延再回 'P' (PONG). 时延可在运行中修改. 服务器可随时停止 (关闭监听套接字和
+ *          全部连接) 和重新启动.
+ *
+ *          设备线程按 main.c 的方式使用 ws_endpoint 和 ws_conn: 从主服务器 (0) 开始连接, 记录握手时间 (到 'h'),
+ *          连接期间定期 PING 记录往返时间、定期探测所有服务器 (包括当前服务器, 连接后等到 'g', 与设备上只测 TCP
+ *          连接相同, 比握手短); 断开时还有本轮未失败的服务器就在 0 ~ 100 ms 后切换过去, 都失败过才按退避等待;
+ *          探测后有明显更好的服务器时关闭连接切回.
+ *          时间按实际设备缩短 (探测 30 秒 -> 300 ms, 退避 1~30 秒 -> 200~2000 ms, 失败减半 60 秒 -> 5 秒).
+ *          设备线程同时负责探测, 探测期间发现断开要等探测结束 (设备上探测在单独的任务中), 切换时间因此偏长.
+ *
+ *          先用构造的测量值检查只比较同类测量: 当前服务器的握手 (含 TLS) 远长于其他服务器的探测时间, 时延相同时
+ *          不切回, 探测时间明显更短时切回; 只探测过的服务器按握手/探测比例估计握手时间.
+ *
+ *          场景 (服务器时延 0: 200 ms, 1: 20 ms, 2: 120 ms):
+ *          - 从主服务器开始, 探测后切到最快的服务器 1
+ *          - 停止服务器 1, 1 秒内切换到次快的服务器 2
+ *          - 服务器 1 恢复, 探测后切回
+ *          - 全部停止: 每个服务器很快各试一次, 之后按退避等待, 尝试次数有上限; 只恢复服务器 2 后连上
+ *          - 全部恢复, 最终回到服务器 1
+ *          - 服务器 1 和 2 改为相同时延: 握手比探测多几个往返, 但不会切到服务器 2; 核对各服务器连接次数之和等于连接指标
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Imain tools/ws_host/ws_failover_check.c main/ws_endpoint.c main/ws_conn.c -lpthread -o /tmp/ws_failover_check
+ *            /tmp/ws_failover_check
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "ws_endpoint.h"
+#include "ws_conn.h"
+
+#define SERVERS             3
+#define MAX_CONNS           16
+
+/* board.h 的取值, 时间缩短 */
+#define PROBE_INTERVAL_MS   300
+#define PROBE_TIMEOUT_MS    500
+#define PING_INTERVAL_MS    100
+#define PONG_TIMEOUT_MS     1000
+#define NETWORK_TIMEOUT_MS  1000
+#define FAILOVER_DELAY_MS   100
+#define BACKOFF_MIN_MS      200
+#define BACKOFF_MAX_MS      2000
+#define HANDSHAKE_RTTS      3           // TCP 连接之后的握手往返: TLS 1.2 两个 + HTTP 升级一个
+
+static atomic_uint s_latency_ms[SERVERS] = {200, 20, 120};
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static int64_t s_t0_ns;
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((ts.tv_sec * 1000000000LL + ts.tv_nsec - s_t0_ns) / 1000000);
+}
+
+static void sleep_ms(uint32_t ms)
+{
+    struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+/* ---------------- 模拟时延的服务器 ---------------- */
+
+typedef struct {
+    int index;
+    uint16_t port;
+    atomic_bool want_up;
+    atomic_bool stop;
+    atomic_int handshakes;
+    pthread_mutex_t lock;
+    int conns[MAX_CONNS];
+    int nconns;
+} server_t;
+
+static server_t s_srv[SERVERS];
+
+static int listen_on(uint16_t port, uint16_t *bound)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t len = sizeof(a);
+    if (bind(fd, (struct sockaddr *)&a, sizeof(a)) != 0 || listen(fd, 64) != 0) {
+        perror("listen");
+        exit(2);
+    }
+    getsockname(fd, (struct sockaddr *)&a, &len);
+    *bound = ntohs(a.sin_port);
+    return fd;
+}
+
+typedef struct {
+    server_t *srv;
+    int fd;
+} conn_arg_t;
+
+static void *conn_thread(void *arg)
+{
+    conn_arg_t c = *(conn_arg_t *)arg;
+    free(arg);
+    atomic_uint *latency = &s_latency_ms[c.srv->index];
+    sleep_ms(atomic_load(latency));
+    char ch = 'g';
+    if (send(c.fd, &ch, 1, MSG_NOSIGNAL) == 1) {
+        while (recv(c.fd, &ch, 1, 0) == 1) {
+            if (ch == 'u') {
+                sleep_ms(HANDSHAKE_RTTS * atomic_load(latency));
+                ch = 'h';
+                atomic_fetch_add(&c.srv->handshakes, 1);
+            } else if (ch == 'p') {
+                sleep_ms(atomic_load(latency));
+                ch = 'P';
+            } else {
+                continue;
+            }
+            if (send(c.fd, &ch, 1, MSG_NOSIGNAL) != 1) {
+                break;
+            }
+        }
+    }
+    pthread_mutex_lock(&c.srv->lock);
+    for (int i = 0; i < c.srv->nconns; i++) {
+        if (c.srv->conns[i] == c.fd) {
+            c.srv->conns[i] = c.srv->conns[--c.srv->nconns];
+            break;
+        }
+    }
+    close(c.fd);
+    pthread_mutex_unlock(&c.srv->lock);
+    return NULL;
+}
+
+static void *server_thread(void *arg)
+{
+    server_t *srv = arg;
+    int lfd = -1;
+    while (!atomic_load(&srv->stop)) {
+        bool up = atomic_load(&srv->want_up);
+        if (up && lfd < 0) {
+            lfd = listen_on(srv->port, &srv->port);
+        } else if (!up && lfd >= 0) {
+            // 停止: 新连接被拒绝, 已有连接收到 FIN
+            close(lfd);
+            lfd = -1;
+            pthread_mutex_lock(&srv->lock);
+            for (int i = 0; i < srv->nconns; i++) {
+                shutdown(srv->conns[i], SHUT_RDWR);
+            }
+            pthread_mutex_unlock(&srv->lock);
+        }
+        if (lfd < 0) {
+            sleep_ms(5);
+            continue;
+        }
+        struct pollfd p = {.fd = lfd, .events = POLLIN};
+        if (poll(&p, 1, 5) <= 0) {
+            continue;
+        }
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        pthread_mutex_lock(&srv->lock);
+        if (srv->nconns == MAX_CONNS) {
+            pthread_mutex_unlock(&srv->lock);
+            close(fd);
+            continue;
+        }
+        srv->conns[srv->nconns++] = fd;
+        pthread_mutex_unlock(&srv->lock);
+        conn_arg_t *c = malloc(sizeof(*c));
+        c->srv = srv;
+        c->fd = fd;
+        pthread_t t;
+        pthread_create(&t, NULL, conn_thread, c);
+        pthread_detach(t);
+    }
+    if (lfd >= 0) {
+        close(lfd);
+    }
+    return NULL;
+}
+
+static void server_set(int i, bool up)
+{
+    atomic_store(&s_srv[i].want_up, up);
+    sleep_ms(20);                   // 等服务器线程处理
+}
+
+/* ---------------- 设备 ---------------- */
+
+static struct {
+    pthread_mutex_t lock;
+    ws_endpoint_set_t set;
+    ws_conn_t conn;
+    bool connected;
+    uint32_t attempts;              // 连接尝试次数 (含失败)
+    atomic_bool stop;
+    uint32_t rng;
+} s_dev;
+
+/* 连接到服务器并等待 'g' (TCP 连接), handshake 时再完成握手 ('u'/'h'); 返回套接字, 失败返回 -1 */
+static int dial(int index, bool handshake, uint32_t timeout_ms, uint32_t *elapsed_ms)
+{
+    uint32_t start = now_ms();
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a = {.sin_family = AF_INET, .sin_port = htons(s_srv[index].port),
+                            .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (connect(fd, (struct sockaddr *)&a, sizeof(a)) != 0) {
+        close(fd);
+        return -1;
+    }
+    struct pollfd p = {.fd = fd, .events = POLLIN};
+    char ch;
+    if (poll(&p, 1, (int)timeout_ms) != 1 || recv(fd, &ch, 1, 0) != 1 || ch != 'g') {
+        close(fd);
+        return -1;
+    }
+    if (handshake) {
+        ch = 'u';
+        p.revents = 0;
+        if (send(fd, &ch, 1, MSG_NOSIGNAL) != 1 || poll(&p, 1, (int)timeout_ms) != 1 ||
+                recv(fd, &ch, 1, 0) != 1 || ch != 'h') {
+            close(fd);
+            return -1;
+        }
+    }
+    *elapsed_ms = now_ms() - start;
+    return fd;
+}
+
+/* 探测所有服务器 (包括当前服务器), 之后判断是否切回; 返回 true 表示应断开当前连接重连 */
+static bool probe_and_failback(void)
+{
+    for (int i = 0; i < SERVERS; i++) {
+        uint32_t ms = 0;
+        int fd = dial(i, false, PROBE_TIMEOUT_MS, &ms);
+        if (fd >= 0) {
+            close(fd);
+        }
+        pthread_mutex_lock(&s_dev.lock);
+        ws_endpoint_on_probe(&s_dev.set, i, now_ms(), fd >= 0, ms);
+        pthread_mutex_unlock(&s_dev.lock);
+    }
+    pthread_mutex_lock(&s_dev.lock);
+    int next = ws_endpoint_failback(&s_dev.set, now_ms());
+    if (next >= 0) {
+        // 主动切换, 与 main.c 相同: 计入断开, 不经过 on_failure
+        ws_conn_on_disconnected(&s_dev.conn, now_ms());
+        s_dev.connected = false;
+    }
+    pthread_mutex_unlock(&s_dev.lock);
+    return next >= 0;
+}
+
+/* 保持连接: PING、探测, 直到断开 (返回 false) 或决定切回 (返回 true) */
+static bool stay_connected(int fd)
+{
+    uint32_t next_ping = now_ms() + PING_INTERVAL_MS;
+    uint32_t next_probe = now_ms() + PROBE_INTERVAL_MS;
+    while (!atomic_load(&s_dev.stop)) {
+        struct pollfd p = {.fd = fd, .events = POLLIN};
+        if (poll(&p, 1, 10) == 1) {
+            return false;           // 服务器关闭 (测试服务器不主动发数据)
+        }
+        if ((int32_t)(now_ms() - next_ping) >= 0) {
+            uint32_t start = now_ms();
+            char ch = 'p';
+            if (send(fd, &ch, 1, MSG_NOSIGNAL) != 1) {
+                return false;
+            }
+            p.revents = 0;
+            if (poll(&p, 1, PONG_TIMEOUT_MS) != 1 || recv(fd, &ch, 1, 0) != 1 || ch != 'P') {
+                return false;
+            }
+            pthread_mutex_lock(&s_dev.lock);
+            ws_endpoint_on_rtt(&s_dev.set, now_ms() - start);
+            pthread_mutex_unlock(&s_dev.lock);
+            next_ping = now_ms() + PING_INTERVAL_MS;
+        }
+        if ((int32_t)(now_ms() - next_probe) >= 0) {
+            if (probe_and_failback()) {
+                return true;
+            }
+            next_probe = now_ms() + PROBE_INTERVAL_MS;
+        }
+    }
+    return false;
+}
+
+static void *device_thread(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&s_dev.stop)) {
+        pthread_mutex_lock(&s_dev.lock);
+        int current = s_dev.set.current;
+        s_dev.attempts++;
+        pthread_mutex_unlock(&s_dev.lock);
+
+        uint32_t handshake_ms = 0;
+        int fd = dial(current, true, NETWORK_TIMEOUT_MS, &handshake_ms);
+        if (fd >= 0) {
+            pthread_mutex_lock(&s_dev.lock);
+            ws_conn_on_connected(&s_dev.conn, now_ms());
+            ws_endpoint_on_connected(&s_dev.set, handshake_ms);
+            s_dev.connected = true;
+            pthread_mutex_unlock(&s_dev.lock);
+            bool failback = stay_connected(fd);
+            close(fd);
+            if (failback) {
+                continue;
+            }
+        }
+
+        // DISCONNECTED 回调: 还有本轮未失败的服务器时很快切换, 否则退避
+        pthread_mutex_lock(&s_dev.lock);
+        uint32_t now = now_ms();
+        s_dev.connected = false;
+        uint32_t delay = ws_conn_on_disconnected(&s_dev.conn, now);
+        bool failover;
+        ws_endpoint_on_failure(&s_dev.set, now, &failover);
+        if (failover) {
+            s_dev.rng = s_dev.rng * 1103515245u + 12345u;
+            delay = 1 + (s_dev.rng >> 8) % FAILOVER_DELAY_MS;
+        }
+        pthread_mutex_unlock(&s_dev.lock);
+        sleep_ms(delay);
+    }
+    return NULL;
+}
+
+/* 等到设备连上指定服务器 (-1 表示任意), 返回耗时, 超时返回 UINT32_MAX */
+static uint32_t wait_connected(int index, uint32_t timeout_ms)
+{
+    uint32_t start = now_ms();
+    while (now_ms() - start < timeout_ms) {
+        pthread_mutex_lock(&s_dev.lock);
+        bool ok = s_dev.connected && (index < 0 || s_dev.set.current == index);
+        pthread_mutex_unlock(&s_dev.lock);
+        if (ok) {
+            return now_ms() - start;
+        }
+        sleep_ms(2);
+    }
+    return UINT32_MAX;
+}
+
+static void snapshot(ws_endpoint_set_t *set, ws_conn_stats_t *st, uint32_t *attempts)
+{
+    pthread_mutex_lock(&s_dev.lock);
+    *set = s_dev.set;
+    *st = s_dev.conn.stats;
+    *attempts = s_dev.attempts;
+    pthread_mutex_unlock(&s_dev.lock);
+}
+
+static void print_scores(void)
+{
+    pthread_mutex_lock(&s_dev.lock);
+    uint32_t now = now_ms();
+    printf("  分数 (探测):");
+    for (int i = 0; i < SERVERS; i++) {
+        printf(" %d=%u(%u)%s", i, ws_endpoint_score(&s_dev.set, i, now), s_dev.set.ep[i].probe_ms,
+               i == s_dev.set.current ? "*" : "");
+    }
+    printf(" (故障切换 %u, 切回 %u)\n", s_dev.set.failovers, s_dev.set.failbacks);
+    pthread_mutex_unlock(&s_dev.lock);
+}
+
+/* 构造的测量值: 当前服务器 0 经 wss 连上 (握手 = TCP + TLS + 升级 = 4 个往返), 服务器 1 只探测过 */
+static void check_like_for_like(const ws_endpoint_config_t *cfg)
+{
+    printf("== 只比较同类测量 ==\n");
+    ws_endpoint_set_t set;
+    ws_endpoint_init(&set, 2, cfg);
+    ws_endpoint_on_connected(&set, 800);
+    ws_endpoint_on_rtt(&set, 200);
+    ws_endpoint_on_probe(&set, 0, 0, true, 200);
+    ws_endpoint_on_probe(&set, 1, 0, true, 200);
+    printf("  时延相同: 分数 0=%u 1=%u\n", ws_endpoint_score(&set, 0, 0), ws_endpoint_score(&set, 1, 0));
+    check(ws_endpoint_failback(&set, 0) < 0, "时延相同的服务器 (只有探测时间) 不会因握手含 TLS 被切走");
+    check(ws_endpoint_score(&set, 1, 0) == ws_endpoint_score(&set, 0, 0), "只探测过的服务器按握手/探测比例估计握手时间");
+
+    ws_endpoint_init(&set, 2, cfg);
+    ws_endpoint_on_connected(&set, 800);
+    ws_endpoint_on_probe(&set, 1, 0, true, 200);
+    check(ws_endpoint_failback(&set, 0) < 0, "当前服务器没有探测时间时不切回");
+
+    for (int i = 0; i < 8; i++) {
+        ws_endpoint_on_probe(&set, 0, 0, true, 200);
+        ws_endpoint_on_probe(&set, 1, 0, true, 100);
+    }
+    printf("  服务器 1 更快: 探测 0=%u 1=%u, 分数 1=%u\n", set.ep[0].probe_ms, set.ep[1].probe_ms,
+           ws_endpoint_score(&set, 1, 0));
+    check(ws_endpoint_failback(&set, 0) == 1, "探测时间明显更短时切回");
+}
+
+int main(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    s_t0_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+
+    pthread_t srv_threads[SERVERS];
+    for (int i = 0; i < SERVERS; i++) {
+        s_srv[i].index = i;
+        pthread_mutex_init(&s_srv[i].lock, NULL);
+        atomic_store(&s_srv[i].want_up, true);
+        pthread_create(&srv_threads[i], NULL, server_thread, &s_srv[i]);
+    }
+    sleep_ms(50);
+
+    const ws_endpoint_config_t ecfg = {
+        .unknown_ms = 1000,
+        .failure_penalty_ms = 2000,
+        .failure_decay_ms = 5000,
+        .failback_margin_ms = 50,
+    };
+    check_like_for_like(&ecfg);
+
+    const ws_conn_config_t ccfg = {
+        .backoff_min_ms = BACKOFF_MIN_MS,
+        .backoff_max_ms = BACKOFF_MAX_MS,
+        .stable_ms = 3000,
+        .ping_min_sec = 10,
+        .ping_max_sec = 10,
+        .ping_probe_ms = 600000,
+    };
+    pthread_mutex_init(&s_dev.lock, NULL);
+    ws_endpoint_init(&s_dev.set, SERVERS, &ecfg);
+    ws_conn_init(&s_dev.conn, &ccfg, 1, now_ms());
+    s_dev.rng = 1;
+    pthread_t dev;
+    pthread_create(&dev, NULL, device_thread, NULL);
+
+    ws_endpoint_set_t set;
+    ws_conn_stats_t st;
+    uint32_t attempts;
+
+    printf("== 选择最快的服务器 (时延 0: %u ms, 1: %u ms, 2: %u ms) ==\n",
+           atomic_load(&s_latency_ms[0]), atomic_load(&s_latency_ms[1]), atomic_load(&s_latency_ms[2]));
+    uint32_t t = wait_connected(0, 2000);
+    check(t != UINT32_MAX, "先连接主服务器 0");
+    t = wait_connected(1, 3000);
+    printf("  %u ms 后切到服务器 1\n", t);
+    check(t != UINT32_MAX, "探测后切到最快的服务器 1");
+    sleep_ms(1000);
+    snapshot(&set, &st, &attempts);
+    print_scores();
+    check(set.current == 1 && set.failbacks == 1, "留在服务器 1, 不来回切换");
+
+    printf("== 停止服务器 1 ==\n");
+    server_set(1, false);
+    t = wait_connected(2, 3000);
+    printf("  %u ms 后切换到服务器 2\n", t);
+    check(t < 1000, "1 秒内切换到次快的服务器 2");
+    print_scores();
+
+    printf("== 恢复服务器 1 ==\n");
+    server_set(1, true);
+    t = wait_connected(1, 3000);
+    printf("  %u ms 后切回服务器 1\n", t);
+    check(t != UINT32_MAX, "探测后切回服务器 1");
+    print_scores();
+
+    printf("== 全部停止 4 秒 ==\n");
+    snapshot(&set, &st, &attempts);
+    uint32_t attempts0 = attempts, failovers0 = set.failovers;
+    for (int i = 0; i < SERVERS; i++) {
+        server_set(i, false);
+    }
+    sleep_ms(4000);
+    snapshot(&set, &st, &attempts);
+    printf("  连接尝试 %u 次, 故障切换 %u 次, 当前退避 %u ms\n", attempts - attempts0,
+           set.failovers - failovers0, st.last_backoff_ms);
+    check(attempts - attempts0 <= 24, "都不可用时按退避等待, 尝试次数有上限");
+    check(set.failovers - failovers0 >= SERVERS - 1, "每轮先很快试过其他服务器");
+    pthread_mutex_lock(&s_dev.lock);
+    bool connected = s_dev.connected;
+    pthread_mutex_unlock(&s_dev.lock);
+    check(!connected, "未连接");
+
+    printf("== 只恢复服务器 2 ==\n");
+    server_set(2, true);
+    t = wait_connected(2, 2 * BACKOFF_MAX_MS + 2000);
+    printf("  %u ms 后连上服务器 2\n", t);
+    check(t != UINT32_MAX, "在一个退避周期内连上唯一可用的服务器");
+
+    printf("== 全部恢复 ==\n");
+    server_set(0, true);
+    server_set(1, true);
+    t = wait_connected(1, 8000);
+    printf("  %u ms 后回到服务器 1\n", t);
+    check(t != UINT32_MAX, "失败次数衰减后回到最快的服务器 1");
+    print_scores();
+
+    printf("== 服务器 1 和 2 时延相同 ==\n");
+    atomic_store(&s_latency_ms[1], 60);
+    atomic_store(&s_latency_ms[2], 60);
+    // 重连一次, 握手时间按新的时延测量
+    server_set(1, false);
+    server_set(1, true);
+    wait_connected(-1, 3000);
+    t = wait_connected(1, 8000);
+    snapshot(&set, &st, &attempts);
+    uint32_t failbacks0 = set.failbacks;
+    sleep_ms(20 * PROBE_INTERVAL_MS);
+    snapshot(&set, &st, &attempts);
+    print_scores();
+    check(t != UINT32_MAX && set.current == 1 && set.failbacks == failbacks0,
+          "握手比探测多几个往返, 仍留在服务器 1, 不切到时延相同的服务器 2");
+
+    atomic_store(&s_dev.stop, true);
+    pthread_join(dev, NULL);
+    snapshot(&set, &st, &attempts);
+    uint32_t sum = 0;
+    for (int i = 0; i < SERVERS; i++) {
+        sum += set.ep[i].connects;
+    }
+    printf("  连接 %u 次, 断开 %u 次, 失败 %u 次\n", st.connects, st.disconnects, st.failed_attempts);
+    check(sum == st.connects, "各服务器连接次数之和等于连接指标");
+    check(st.connects + st.failed_attempts == attempts, "连接尝试 = 成功 + 失败");
+
+    for (int i = 0; i < SERVERS; i++) {
+        atomic_store(&s_srv[i].stop, true);
+        pthread_join(srv_threads[i], NULL);
+    }
+    printf("%s\n", s_failures ? "FAIL" : "PASS");
+    return s_failures ? 1 : 0;
+}
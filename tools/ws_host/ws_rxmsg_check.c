@@ -0,0 +1,220 @@
+/**
+ * @file ws_rxmsg_check.c
+ * @brief WebSocket 收到消息重组 (esp_websocket_rxmsg.c) 的主机验证
+ * @details 随机生成文本和二进制消息, 随机分成多个帧 (续帧), 每帧再按客户端接收缓冲区 (1KB) 分块,
+ *          帧之间随机插入 PING/PONG, 偶尔插入没有开始帧的续帧和超过上限的消息, 逐块喂给重组层:
+ *          - 不超过上限的文本消息恰好交付一次, 内容一致并以 NUL 结尾
+ *          - 超过上限的消息整条丢弃并计数, 不影响后面的消息
+ *          - 控制帧原样透传; 二进制消息在不重组时按块透传 (拼起来与原消息一致), 重组时整条交付
+ *          - 初始化之后不再分配内存 (链接时包装 malloc 计数)
+ *          并统计原来逐块交付时有多少文本消息能在一个事件里完整拿到 (main.c 原来按此假设解析 JSON).
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Icomponents/esp_websocket_client/private_include tools/ws_host/ws_rxmsg_check.c \
+ *                components/esp_websocket_client/esp_websocket_rxmsg.c -Wl,--wrap=malloc -o /tmp/ws_rxmsg_check
+ *            /tmp/ws_rxmsg_check
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_websocket_rxmsg.h"
+
+#define CHUNK           1024        // WEBSOCKET_BUFFER_SIZE_BYTE
+#define MESSAGE_MAX     4096        // BOARD_WS_RX_MESSAGE_MAX
+#define MESSAGES        20000
+
+static int s_failures = 0;
+static size_t s_mallocs = 0;
+
+void *__real_malloc(size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    s_mallocs++;
+    return __real_malloc(size);
+}
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static uint64_t s_rng = 0xD1B54A32D192ED03ULL;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 16);
+}
+
+typedef struct {
+    esp_websocket_rxmsg_t m;
+    // 期望
+    uint32_t text_expected, text_oversize, binary_messages;
+    // 实际
+    uint32_t delivered, control_passed, control_sent, stray_dropped, stray_sent;
+    bool ok;
+    // 透传的二进制消息按块拼接
+    uint8_t *binary_buf;
+    size_t binary_len;
+    // 原来逐块交付时一个事件就是完整文本消息的条数
+    uint32_t whole_in_one_event;
+    uint32_t text_total;
+} ctx_t;
+
+static const uint8_t *s_expect;
+static size_t s_expect_len;
+static uint8_t s_expect_opcode;
+
+/* 把一帧按接收缓冲区分块喂给重组层 */
+static void feed_frame(ctx_t *c, uint8_t opcode, bool fin, const uint8_t *payload, size_t len)
+{
+    size_t off = 0;
+    do {
+        size_t n = len - off < CHUNK ? len - off : CHUNK;
+        esp_websocket_rxmsg_result_t r = esp_websocket_rxmsg_feed(&c->m, opcode, fin, off, len, payload + off, n);
+        bool control = opcode >= 0x08;
+        if (control) {
+            c->ok = c->ok && r == ESP_WEBSOCKET_RXMSG_PASS;
+            c->control_passed += r == ESP_WEBSOCKET_RXMSG_PASS;
+        } else if (r == ESP_WEBSOCKET_RXMSG_PASS) {
+            // 只有不重组的二进制消息透传
+            c->ok = c->ok && !c->m.binary && s_expect_opcode == 0x02;
+            memcpy(c->binary_buf + c->binary_len, payload + off, n);
+            c->binary_len += n;
+        } else if (r == ESP_WEBSOCKET_RXMSG_COMPLETE) {
+            c->delivered++;
+            c->ok = c->ok && c->m.len == s_expect_len && c->m.opcode == s_expect_opcode &&
+                    memcmp(c->m.buf, s_expect, s_expect_len) == 0 && c->m.buf[c->m.len] == 0;
+        }
+        off += n;
+    } while (off < len);
+}
+
+static void send_control(ctx_t *c)
+{
+    uint8_t ping[125];
+    size_t len = rnd() % sizeof(ping);
+    memset(ping, 0xA5, len);
+    feed_frame(c, rnd() % 2 ? 0x09 : 0x0A, true, ping, len);
+    c->control_sent++;
+}
+
+/* 发送一条消息: 随机分成 1~4 帧, 帧之间可能插入控制帧 */
+static void send_message(ctx_t *c, uint8_t opcode, const uint8_t *msg, size_t len)
+{
+    s_expect = msg;
+    s_expect_len = len;
+    s_expect_opcode = opcode;
+    c->binary_len = 0;
+
+    int frames = 1 + rnd() % 4;
+    size_t off = 0;
+    for (int f = 0; f < frames; f++) {
+        bool last = f == frames - 1;
+        size_t n = last ? len - off : (len - off) * (rnd() % 100) / 100;
+        feed_frame(c, f == 0 ? opcode : 0x00, last, msg + off, n);
+        off += n;
+        if (!last && rnd() % 3 == 0) {
+            send_control(c);
+        }
+    }
+
+    if (opcode == 0x01) {
+        c->text_total++;
+        // 原来每块一个事件: 只有单帧且不超过一块的消息能完整解析
+        c->whole_in_one_event += frames == 1 && len <= CHUNK;
+    }
+    if (opcode == 0x02 && !c->m.binary) {
+        c->ok = c->ok && c->binary_len == len && memcmp(c->binary_buf, msg, len) == 0;
+    }
+}
+
+static bool run(bool reassemble_binary, ctx_t *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->ok = true;
+    c->binary_buf = malloc(4 * MESSAGE_MAX);
+    uint8_t *msg = malloc(4 * MESSAGE_MAX);
+    if (esp_websocket_rxmsg_init(&c->m, MESSAGE_MAX, reassemble_binary) != 0) {
+        return false;
+    }
+    uint8_t *arena = c->m.buf;
+    size_t mallocs = s_mallocs;
+
+    for (int i = 0; i < MESSAGES; i++) {
+        int kind = rnd() % 20;
+        uint8_t opcode = kind < 14 ? 0x01 : 0x02;
+        size_t len;
+        if (kind == 0) {
+            len = MESSAGE_MAX + 1 + rnd() % MESSAGE_MAX;        // 超过上限
+        } else if (kind < 8) {
+            len = rnd() % 200;                                   // 常见的短命令
+        } else {
+            len = rnd() % (MESSAGE_MAX + 1);
+        }
+        for (size_t k = 0; k < len; k++) {
+            msg[k] = (uint8_t)(' ' + (i + k) % 90);
+        }
+        bool oversize = len > MESSAGE_MAX;
+        bool reassembled = opcode == 0x01 || reassemble_binary;
+        if (reassembled) {
+            if (oversize) {
+                c->text_oversize++;
+            } else {
+                c->text_expected++;
+            }
+        } else {
+            c->binary_messages++;
+        }
+        send_message(c, opcode, msg, len);
+
+        // 偶尔插入一个没有开始帧的续帧 (协议错误), 应被丢弃
+        if (rnd() % 50 == 0) {
+            uint8_t junk[16] = {0};
+            esp_websocket_rxmsg_result_t r = esp_websocket_rxmsg_feed(&c->m, 0x00, true, 0, sizeof(junk), junk,
+                                             sizeof(junk));
+            c->stray_sent++;
+            c->stray_dropped += r == ESP_WEBSOCKET_RXMSG_DROPPED;
+        }
+        if (rnd() % 10 == 0) {
+            send_control(c);
+        }
+    }
+
+    bool no_alloc = s_mallocs == mallocs && c->m.buf == arena;
+    bool counts = c->delivered == c->text_expected && c->m.delivered == c->text_expected &&
+                  c->m.dropped == c->text_oversize && c->control_passed == c->control_sent &&
+                  c->stray_dropped == c->stray_sent;
+    esp_websocket_rxmsg_deinit(&c->m);
+    free(msg);
+    free(c->binary_buf);
+    return c->ok && no_alloc && counts;
+}
+
+int main(void)
+{
+    ctx_t c;
+    bool ok = run(false, &c);
+    printf("文本重组, 二进制透传: %u 条消息, 交付 %u, 超长丢弃 %u, 二进制透传 %u, 控制帧 %u\n", MESSAGES, c.delivered,
+           c.m.dropped, c.binary_messages, c.control_passed);
+    printf("  原来逐块交付时一个事件就是完整文本消息: %u / %u (%.1f%%)\n", c.whole_in_one_event, c.text_total,
+           100.0 * c.whole_in_one_event / c.text_total);
+    check(ok, "文本消息恰好交付一次且内容一致 (NUL 结尾), 超长丢弃, 控制帧和二进制块透传, 无多余分配");
+
+    ok = run(true, &c);
+    printf("文本和二进制都重组: 交付 %u, 超长丢弃 %u\n", c.delivered, c.m.dropped);
+    check(ok, "二进制消息也整条交付");
+
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
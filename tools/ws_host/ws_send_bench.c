@@ -0,0 +1,443 @@
+/**
+ * @file ws_send_bench.c
+ * @brief WebSocket 分散发送 (esp_websocket_client_send_iov) 主机基准与验证
+ * @details 在主机上编译 components/esp_websocket_client/esp_websocket_frame.c, 对比上传分块的两种发送方式:
+ *          - 原方式: 24 字节头部和 4096 字节数据各发一条消息 (esp_websocket_client_send_bin), 客户端把数据按
+ *            1KB 拷贝到发送缓冲区, 每 1KB 一帧; 每帧原地逐字节掩码, 先写帧头再写数据 (两次写), 写完逐字节去掩码
+ *          - 新方式: 头部和数据组成一帧, 逐字 (32 位) 掩码直接拷入 1KB 发送缓冲区, 满了才写 (每 1KB 一次写)
+ *          两种方式各测两种对端:
+ *          - 丢弃: 写操作只计数, 只测掩码和组帧的 CPU 开销
+ *          - 回环 TCP: 服务器线程逐帧解析、去掩码并与源数据逐字节比较
+ *          另外验证 esp_websocket_mask_copy() 在所有对齐和掩码相位下与逐字节掩码一致, 以及帧头的三种长度编码.
+ *          报告吞吐 (MB/s)、发送线程每 MB 的 CPU 时间、每 MB 的写调用次数和帧数. 任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Icomponents/esp_websocket_client/private_include tools/ws_host/ws_send_bench.c \
+ *                components/esp_websocket_client/esp_websocket_frame.c -lpthread -o /tmp/ws_send_bench
+ *            /tmp/ws_send_bench
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_websocket_frame.h"
+
+#define TX_BUFFER_SIZE  1024            // WEBSOCKET_BUFFER_SIZE_BYTE
+#define CHUNK_HDR       24              // AUDIO_UPLOAD_HEADER_SIZE
+#define CHUNK           4096            // AUDIO_OUTBOX_CHUNK_SIZE
+#define SRC_SIZE        (1024 * 1024)   // 源数据 (模拟缓冲区池中的录音)
+#define TOTAL_BYTES     (256LL * 1024 * 1024)
+#define ROUNDS          3
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static uint64_t s_rng = 88172645463325252ULL;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 16);
+}
+
+static double thread_cpu_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double wall_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ---------------- 对端 ---------------- */
+
+typedef struct {
+    int fd;                     // < 0 时丢弃
+    uint64_t writes;
+    uint64_t frames;
+    uint64_t bytes;             // 写出的字节数 (含帧头)
+} sink_t;
+
+static int sink_write(sink_t *s, const uint8_t *buf, size_t len)
+{
+    s->writes++;
+    s->bytes += len;
+    if (s->fd < 0) {
+        __asm__ volatile("" : : "r"(buf) : "memory");      // 防止编译器省略掩码计算
+        return 0;
+    }
+    while (len > 0) {
+        ssize_t n = send(s->fd, buf, len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* ---------------- 原方式 (esp_websocket_client_send_bin + esp_transport_ws_send_raw) ---------------- */
+
+static void mask_bytes(uint8_t *buf, size_t len, const uint8_t mask[4])
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] ^= mask[i % 4];
+    }
+}
+
+static int old_send_message(sink_t *s, uint8_t *tx, const uint8_t *data, size_t len)
+{
+    size_t widx = 0;
+    uint8_t opcode = 0x02;
+    while (widx < len) {
+        size_t n = len - widx > TX_BUFFER_SIZE ? TX_BUFFER_SIZE : len - widx;
+        uint8_t op = opcode | (widx + n == len ? 0x80 : 0);
+        memcpy(tx, data + widx, n);
+
+        uint8_t mask[4], hdr[ESP_WEBSOCKET_FRAME_MAX_HEADER];
+        uint32_t r = rnd();
+        memcpy(mask, &r, 4);
+        size_t hlen = esp_websocket_frame_header(hdr, op, n, mask);
+        mask_bytes(tx, n, mask);
+        if (sink_write(s, hdr, hlen) < 0 || sink_write(s, tx, n) < 0) {
+            return -1;
+        }
+        mask_bytes(tx, n, mask);
+        s->frames++;
+        opcode = 0;
+        widx += n;
+    }
+    return 0;
+}
+
+static int old_send_chunk(sink_t *s, uint8_t *tx, const uint8_t *hdr, const uint8_t *data, size_t len)
+{
+    if (old_send_message(s, tx, hdr, CHUNK_HDR) < 0) {
+        return -1;
+    }
+    return old_send_message(s, tx, data, len);
+}
+
+/* ---------------- 新方式 (esp_websocket_client_send_iov) ---------------- */
+
+typedef struct {
+    const void *data;
+    size_t len;
+} iov_t;
+
+static int iov_send(sink_t *s, uint8_t *tx, const iov_t *iov, int iovcnt)
+{
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        total += iov[i].len;
+    }
+    uint8_t mask[4];
+    uint32_t r = rnd();
+    memcpy(mask, &r, 4);
+    size_t fill = esp_websocket_frame_header(tx, 0x82, total, mask);
+    size_t phase = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        const uint8_t *src = iov[i].data;
+        size_t remain = iov[i].len;
+        while (remain > 0) {
+            size_t n = TX_BUFFER_SIZE - fill;
+            n = n < remain ? n : remain;
+            esp_websocket_mask_copy(tx + fill, src, n, mask, phase);
+            fill += n;
+            phase += n;
+            src += n;
+            remain -= n;
+            if (fill == TX_BUFFER_SIZE) {
+                if (sink_write(s, tx, fill) < 0) {
+                    return -1;
+                }
+                fill = 0;
+            }
+        }
+    }
+    if (fill > 0 && sink_write(s, tx, fill) < 0) {
+        return -1;
+    }
+    s->frames++;
+    return 0;
+}
+
+static int new_send_chunk(sink_t *s, uint8_t *tx, const uint8_t *hdr, const uint8_t *data, size_t len)
+{
+    const iov_t iov[2] = {{hdr, CHUNK_HDR}, {data, len}};
+    return iov_send(s, tx, iov, 2);
+}
+
+/* ---------------- 服务器线程: 解析帧, 去掩码, 与源数据比较 ---------------- */
+
+typedef struct {
+    int listen_fd;
+    const uint8_t *src;
+    uint64_t expect_bytes;      // 消息载荷总字节数
+    uint64_t frames;
+    uint64_t payload;
+    uint64_t messages;
+    bool ok;
+} server_t;
+
+static bool read_full(int fd, uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+/* 期望的载荷流: 每个分块为 24 字节头部 (按分块编号生成) + 源数据中的 CHUNK 字节 */
+static uint8_t expected_byte(const uint8_t *src, uint64_t pos)
+{
+    uint64_t k = pos / (CHUNK_HDR + CHUNK);
+    uint64_t o = pos % (CHUNK_HDR + CHUNK);
+    if (o < CHUNK_HDR) {
+        return (uint8_t)(k * 31 + o);
+    }
+    return src[(k * CHUNK) % SRC_SIZE + (o - CHUNK_HDR)];
+}
+
+static void *server_thread(void *arg)
+{
+    server_t *srv = arg;
+    int fd = accept(srv->listen_fd, NULL, NULL);
+    static uint8_t buf[65536];
+    srv->ok = fd >= 0;
+    while (srv->ok && srv->payload < srv->expect_bytes) {
+        uint8_t h[2];
+        if (!read_full(fd, h, 2)) {
+            srv->ok = false;
+            break;
+        }
+        uint64_t len = h[1] & 0x7F;
+        if (len == 126 || len == 127) {
+            uint8_t ext[8];
+            size_t n = len == 126 ? 2 : 8;
+            if (!read_full(fd, ext, n)) {
+                srv->ok = false;
+                break;
+            }
+            len = 0;
+            for (size_t i = 0; i < n; i++) {
+                len = (len << 8) | ext[i];
+            }
+        }
+        uint8_t mask[4];
+        if (!(h[1] & 0x80) || !read_full(fd, mask, 4) || len > sizeof(buf) || !read_full(fd, buf, len)) {
+            srv->ok = false;
+            break;
+        }
+        for (uint64_t i = 0; i < len; i++) {
+            if ((uint8_t)(buf[i] ^ mask[i % 4]) != expected_byte(srv->src, srv->payload + i)) {
+                srv->ok = false;
+                break;
+            }
+        }
+        srv->payload += len;
+        srv->frames++;
+        srv->messages += (h[0] & 0x80) != 0;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return NULL;
+}
+
+/* ---------------- 测量 ---------------- */
+
+typedef int (*send_chunk_fn)(sink_t *s, uint8_t *tx, const uint8_t *hdr, const uint8_t *data, size_t len);
+
+typedef struct {
+    double mb_s;
+    double cpu_ms_per_mb;
+    double writes_per_mb;
+    double frames_per_mb;
+    bool ok;
+} bench_t;
+
+static bench_t run_bench(send_chunk_fn fn, const uint8_t *src, bool loopback, long long total)
+{
+    bench_t b = {.ok = true};
+    sink_t s = {.fd = -1};
+    server_t srv = {0};
+    pthread_t th;
+    uint64_t chunks = total / CHUNK;
+
+    if (loopback) {
+        srv.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+        socklen_t alen = sizeof(addr);
+        bind(srv.listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+        getsockname(srv.listen_fd, (struct sockaddr *)&addr, &alen);
+        listen(srv.listen_fd, 1);
+        srv.src = src;
+        srv.expect_bytes = chunks * (CHUNK_HDR + CHUNK);
+        pthread_create(&th, NULL, server_thread, &srv);
+        s.fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(s.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(s.fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            b.ok = false;
+            return b;
+        }
+    }
+
+    static uint8_t tx[TX_BUFFER_SIZE];
+    double w0 = wall_s(), c0 = thread_cpu_s();
+    for (uint64_t k = 0; k < chunks && b.ok; k++) {
+        uint8_t hdr[CHUNK_HDR];
+        for (int i = 0; i < CHUNK_HDR; i++) {
+            hdr[i] = (uint8_t)(k * 31 + i);
+        }
+        b.ok = fn(&s, tx, hdr, src + (k * CHUNK) % SRC_SIZE, CHUNK) == 0;
+    }
+    double cpu = thread_cpu_s() - c0;
+
+    if (loopback) {
+        pthread_join(th, NULL);
+        close(s.fd);
+        close(srv.listen_fd);
+        b.ok = b.ok && srv.ok && srv.payload == srv.expect_bytes && srv.frames == s.frames;
+    }
+    double wall = wall_s() - w0;
+    double mb = (double)chunks * CHUNK / (1024 * 1024);
+    b.mb_s = mb / wall;
+    b.cpu_ms_per_mb = cpu * 1000 / mb;
+    b.writes_per_mb = s.writes / mb;
+    b.frames_per_mb = s.frames / mb;
+    return b;
+}
+
+static bench_t best_of(send_chunk_fn fn, const uint8_t *src, bool loopback)
+{
+    bench_t best = {0};
+    best.ok = true;
+    for (int r = 0; r < ROUNDS; r++) {
+        bench_t b = run_bench(fn, src, loopback, loopback ? TOTAL_BYTES / 4 : TOTAL_BYTES);
+        best.ok = best.ok && b.ok;
+        if (r == 0 || b.cpu_ms_per_mb < best.cpu_ms_per_mb) {
+            bool ok = best.ok;
+            best = b;
+            best.ok = ok;
+        }
+    }
+    return best;
+}
+
+static void report(const char *name, const bench_t *b)
+{
+    printf("    %-9s %8.1f MB/s  CPU %6.2f ms/MB  写调用 %6.0f /MB  帧 %5.0f /MB\n", name, b->mb_s, b->cpu_ms_per_mb,
+           b->writes_per_mb, b->frames_per_mb);
+}
+
+/* ---------------- 正确性 ---------------- */
+
+static bool verify_mask_copy(void)
+{
+    static uint8_t src[128 + 4], dst[128 + 4], ref[128 + 4];
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)rnd();
+    }
+    uint8_t mask[4] = {0x12, 0x9A, 0x5C, 0xE7};
+    for (int so = 0; so < 4; so++) {
+        for (int dof = 0; dof < 4; dof++) {
+            for (size_t phase = 0; phase < 8; phase++) {
+                for (size_t len = 0; len <= 100; len++) {
+                    memset(dst, 0xAA, sizeof(dst));
+                    memset(ref, 0xAA, sizeof(ref));
+                    for (size_t i = 0; i < len; i++) {
+                        ref[dof + i] = src[so + i] ^ mask[(phase + i) % 4];
+                    }
+                    esp_websocket_mask_copy(dst + dof, src + so, len, mask, phase);
+                    if (memcmp(dst, ref, sizeof(dst)) != 0) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool verify_header(void)
+{
+    uint8_t mask[4] = {1, 2, 3, 4}, h[ESP_WEBSOCKET_FRAME_MAX_HEADER];
+    static const uint8_t h1[] = {0x82, 0x80 | 125, 1, 2, 3, 4};
+    static const uint8_t h2[] = {0x81, 0x80 | 126, 0x10, 0x18, 1, 2, 3, 4};
+    static const uint8_t h3[] = {0x02, 0x80 | 127, 0, 0, 0, 0, 0, 0x01, 0x00, 0x00, 1, 2, 3, 4};
+    static const uint8_t h4[] = {0x8A, 0};
+    return esp_websocket_frame_header(h, 0x82, 125, mask) == sizeof(h1) && memcmp(h, h1, sizeof(h1)) == 0 &&
+           esp_websocket_frame_header(h, 0x81, 4120, mask) == sizeof(h2) && memcmp(h, h2, sizeof(h2)) == 0 &&
+           esp_websocket_frame_header(h, 0x02, 65536, mask) == sizeof(h3) && memcmp(h, h3, sizeof(h3)) == 0 &&
+           esp_websocket_frame_header(h, 0x8A, 0, NULL) == sizeof(h4) && memcmp(h, h4, sizeof(h4)) == 0;
+}
+
+int main(void)
+{
+    check(verify_mask_copy(), "mask_copy 在所有对齐/相位/长度下与逐字节掩码一致");
+    check(verify_header(), "帧头 7 位 / 16 位 / 64 位长度编码和无掩码帧");
+
+    uint8_t *src = malloc(SRC_SIZE + 1);
+    for (size_t i = 0; i < SRC_SIZE + 1; i++) {
+        src[i] = (uint8_t)rnd();
+    }
+    // 缓冲区池块中的分块起始地址不一定字对齐, 用奇数偏移的源数据
+    const uint8_t *p = src + 1;
+
+    printf("\n分块 %d + 头部 %d 字节, 发送缓冲区 %d 字节\n", CHUNK, CHUNK_HDR, TX_BUFFER_SIZE);
+    printf("丢弃 (只测掩码和组帧):\n");
+    bench_t old_null = best_of(old_send_chunk, p, false);
+    bench_t new_null = best_of(new_send_chunk, p, false);
+    report("send_bin", &old_null);
+    report("send_iov", &new_null);
+
+    printf("回环 TCP (服务器逐帧去掩码并校验):\n");
+    bench_t old_tcp = best_of(old_send_chunk, p, true);
+    bench_t new_tcp = best_of(new_send_chunk, p, true);
+    report("send_bin", &old_tcp);
+    report("send_iov", &new_tcp);
+
+    printf("    send_iov 相对原方式: 组帧 CPU 减少 %.0f%%, 回环吞吐 %.2f 倍, 写调用减少 %.0f%%\n",
+           100.0 * (1 - new_null.cpu_ms_per_mb / old_null.cpu_ms_per_mb), new_tcp.mb_s / old_tcp.mb_s,
+           100.0 * (1 - new_tcp.writes_per_mb / old_tcp.writes_per_mb));
+
+    check(old_tcp.ok && new_tcp.ok, "服务器收到的载荷与源数据逐字节一致, 帧数一致");
+    check(new_null.frames_per_mb * 4 < old_null.frames_per_mb, "每个分块一帧 (原方式每分块 5 帧)");
+    check(new_null.writes_per_mb * 2 <= old_null.writes_per_mb, "写调用次数至少减半");
+    check(new_null.cpu_ms_per_mb < old_null.cpu_ms_per_mb, "组帧 CPU 低于原方式");
+
+    free(src);
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,414 @@
+/**
+ * @file ws_sink_bench.c
+ * @brief WebSocket 下行二进制数据接收方式的主机基准
+ * @details 回环 TCP 上的服务器线程连续发送二进制消息 (每条 256KB, 分成 4 个 64KB 帧: 开始帧 + 续帧),
+ *          客户端线程用与 esp_transport_ws 相同语义的读取 (每次读取先解析帧头, 再读至多 len 字节载荷)
+ *          和与 esp_websocket_client_recv() 相同的循环接收, 比较三种交付方式:
+ *          - 事件: 每 1KB 一个 WEBSOCKET_EVENT_DATA, 经事件循环 (投递时复制事件数据到深度 1 的队列, 再取出
+ *            按事件 ID 查找处理函数) 交给应用, 应用再把数据复制到自己的环形缓冲区
+ *          - 接收器: esp_websocket_client_set_binary_sink() 只设 on_data, 仍按 1KB 读入接收缓冲区,
+ *            不经过事件循环, on_data 复制到环形缓冲区
+ *          - 接收器 + 应用缓冲区: 同时设 get_buffer, 每帧第一块 (与帧头一起读入接收缓冲区) 复制过去,
+ *            其余载荷按环形缓冲区的连续空闲空间直接读入, 不再复制
+ *          应用端校验每个字节和消息偏移、final 标志. 报告吞吐 (MB/s) 和客户端线程的 CPU 时间 (ms/MB).
+ *          两种接收器方式链接组件中的 esp_websocket_sink.c (帧归属、缓冲区选择、复制和 final 标志);
+ *          接收循环、帧头解析和事件循环是按 esp_websocket_client_recv()/esp_transport_ws/esp_event 写的模型,
+ *          不链接组件代码 (依赖 IDF 和 FreeRTOS). 事件循环在主机上只是近似 (芯片上还有 FreeRTOS 队列的
+ *          临界区和任务切换), 读取粒度和复制次数与芯片相同. 任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Icomponents/esp_websocket_client/private_include tools/ws_host/ws_sink_bench.c \
+ *                components/esp_websocket_client/esp_websocket_sink.c -lpthread -o /tmp/ws_sink_bench
+ *            /tmp/ws_sink_bench
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_websocket_sink.h"
+
+#define RX_BUFFER       1024                // WEBSOCKET_BUFFER_SIZE_BYTE
+#define FRAME_LEN       (64 * 1024)
+#define FRAMES_PER_MSG  4
+#define MSG_LEN         (FRAME_LEN * FRAMES_PER_MSG)
+#define MESSAGES        1024                // 256MB
+#define RING_SIZE       (32 * 1024)         // 应用的环形缓冲区
+#define PATTERN         251
+
+typedef enum {
+    MODE_EVENT,
+    MODE_SINK,
+    MODE_SINK_BUFFER,
+} mode_t_;
+
+static const char *const s_mode_names[] = {"事件 (每 1KB 一个事件)", "接收器 (1KB 读取)", "接收器 + 应用缓冲区"};
+
+static int s_failures = 0;
+static uint8_t s_pattern[PATTERN + MSG_LEN];
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static double now_s(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ---------------- 服务器 ---------------- */
+
+static bool write_full(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static void *server_thread(void *arg)
+{
+    int fd = *(int *)arg;
+    for (int m = 0; m < MESSAGES; m++) {
+        for (int f = 0; f < FRAMES_PER_MSG; f++) {
+            uint8_t h[4] = {(uint8_t)((f == 0 ? 0x02 : 0x00) | (f == FRAMES_PER_MSG - 1 ? 0x80 : 0)), 127};
+            uint8_t ext[8] = {0};
+            uint64_t len = FRAME_LEN;
+            for (int i = 0; i < 8; i++) {
+                ext[7 - i] = (uint8_t)(len >> (8 * i));
+            }
+            size_t off = (size_t)f * FRAME_LEN;
+            if (!write_full(fd, h, 2) || !write_full(fd, ext, 8) ||
+                    !write_full(fd, s_pattern + off % PATTERN, FRAME_LEN)) {
+                return NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* ---------------- esp_transport_ws 的读取语义 ---------------- */
+
+typedef struct {
+    int fd;
+    uint64_t remaining;         // 当前帧剩余载荷
+    uint64_t payload_len;
+    uint8_t opcode;
+    bool fin;
+} ws_reader_t;
+
+static bool read_full(int fd, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+/* 与 ws_read() 相同: 当前帧读完时先读帧头, 然后一次 recv 至多 len 字节载荷 */
+static int ws_read(ws_reader_t *r, char *buf, int len)
+{
+    if (r->remaining == 0) {
+        uint8_t h[2];
+        if (!read_full(r->fd, h, 2)) {
+            return -1;
+        }
+        r->opcode = h[0] & 0x0F;
+        r->fin = h[0] & 0x80;
+        uint64_t plen = h[1] & 0x7F;
+        if (plen >= 126) {
+            uint8_t ext[8];
+            size_t n = plen == 126 ? 2 : 8;
+            if (!read_full(r->fd, ext, n)) {
+                return -1;
+            }
+            plen = 0;
+            for (size_t i = 0; i < n; i++) {
+                plen = (plen << 8) | ext[i];
+            }
+        }
+        r->payload_len = r->remaining = plen;
+    }
+    size_t want = r->remaining < (uint64_t)len ? r->remaining : (size_t)len;
+    ssize_t n = recv(r->fd, buf, want, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    r->remaining -= n;
+    return (int)n;
+}
+
+/* ---------------- 应用: 环形缓冲区 + 校验 ---------------- */
+
+typedef struct {
+    uint8_t ring[RING_SIZE];
+    size_t head;                // 下一个写入位置
+    size_t received;            // 当前消息已收到的字节
+    uint32_t messages;
+    bool ok;
+} app_t;
+
+/* 消费者: 校验后立即"播放"掉 (保持环形缓冲区空闲) */
+static void app_commit(app_t *a, const uint8_t *data, size_t len, size_t offset, bool final)
+{
+    a->ok = a->ok && offset == a->received && memcmp(data, s_pattern + offset % PATTERN, len) == 0;
+    a->received += len;
+    a->head = (a->head + len) % RING_SIZE;
+    if (final) {
+        a->ok = a->ok && a->received == MSG_LEN;
+        a->received = 0;
+        a->messages++;
+    }
+}
+
+static void app_copy(app_t *a, const uint8_t *data, size_t len, size_t offset, bool final)
+{
+    while (len > 0) {
+        size_t n = RING_SIZE - a->head < len ? RING_SIZE - a->head : len;
+        memcpy(a->ring + a->head, data, n);
+        len -= n;
+        app_commit(a, a->ring + a->head, n, offset, final && len == 0);
+        data += n;
+        offset += n;
+    }
+}
+
+/* esp_websocket_binary_sink_t 的两个回调 */
+static void *app_get_buffer(void *ctx, size_t offset, size_t *size)
+{
+    (void)offset;
+    app_t *a = ctx;
+    *size = RING_SIZE - a->head;
+    return a->ring + a->head;
+}
+
+static int app_on_data(void *ctx, const uint8_t *data, size_t len, size_t offset, bool final)
+{
+    app_t *a = ctx;
+    if (data == a->ring + a->head) {
+        app_commit(a, data, len, offset, final);
+    } else {
+        app_copy(a, data, len, offset, final);
+    }
+    return 0;
+}
+
+/* ---------------- 近似的事件循环 ---------------- */
+
+typedef struct {
+    void *client;
+    void *user_context;
+    const char *data_ptr;
+    int data_len;
+    int op_code;
+    int payload_len;
+    int payload_offset;
+    bool fin;
+    int error[8];
+} event_data_t;
+
+typedef void (*handler_t)(void *arg, int32_t id, void *data);
+
+typedef struct {
+    int32_t id;
+    handler_t fn;
+    void *arg;
+} handler_entry_t;
+
+static struct {
+    event_data_t slot;          // 深度 1 的队列
+    bool full;
+    handler_entry_t handlers[4];
+    int count;
+    pthread_mutex_t lock;
+} s_loop = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+static void event_post_and_run(int32_t id, const event_data_t *data)
+{
+    pthread_mutex_lock(&s_loop.lock);
+    memcpy(&s_loop.slot, data, sizeof(*data));
+    s_loop.full = true;
+    pthread_mutex_unlock(&s_loop.lock);
+
+    event_data_t ev;
+    pthread_mutex_lock(&s_loop.lock);
+    memcpy(&ev, &s_loop.slot, sizeof(ev));
+    s_loop.full = false;
+    pthread_mutex_unlock(&s_loop.lock);
+    for (int i = 0; i < s_loop.count; i++) {
+        if (s_loop.handlers[i].id == id || s_loop.handlers[i].id == -1) {
+            s_loop.handlers[i].fn(s_loop.handlers[i].arg, id, &ev);
+        }
+    }
+}
+
+/* 应用原来的事件处理: 二进制块按 payload_offset 累加出消息偏移 */
+static size_t s_event_msg_offset;
+
+static void app_event_handler(void *arg, int32_t id, void *data)
+{
+    (void)id;
+    app_t *a = arg;
+    event_data_t *ev = data;
+    if (ev->op_code == 0x02 && ev->payload_offset == 0) {
+        s_event_msg_offset = 0;
+    }
+    bool final = ev->fin && ev->payload_offset + ev->data_len >= ev->payload_len;
+    app_copy(a, (const uint8_t *)ev->data_ptr, ev->data_len, s_event_msg_offset, final);
+    s_event_msg_offset += ev->data_len;
+}
+
+/* ---------------- 客户端接收循环 ---------------- */
+
+static bool client_run(mode_t_ mode, int fd, app_t *a)
+{
+    static char rx_buffer[RX_BUFFER];
+    ws_reader_t r = {.fd = fd};
+    // esp_websocket_client_set_binary_sink(): 接收器方式只设 on_data, 接收器 + 应用缓冲区同时设 get_buffer
+    esp_websocket_sink_cb_t cb = {
+        .get_buffer = mode == MODE_SINK_BUFFER ? app_get_buffer : NULL,
+        .on_data = app_on_data,
+        .ctx = a,
+    };
+    esp_websocket_sink_t sink = {0};
+    bool sink_frame = false;
+    s_loop.count = 0;
+    s_loop.handlers[s_loop.count++] = (handler_entry_t) {
+        .id = -1, .fn = app_event_handler, .arg = a
+    };
+
+    while (a->messages < MESSAGES) {
+        // 与 esp_websocket_client_recv() 相同: 读完一帧为止
+        size_t payload_offset = 0;
+        sink_frame = false;
+        do {
+            // 帧的第一次读取同时解析帧头, 只能读入接收缓冲区
+            char *buf = rx_buffer;
+            int size = RX_BUFFER;
+            if (sink_frame) {
+                buf = esp_websocket_sink_buffer(&sink, rx_buffer, RX_BUFFER, &size);
+            }
+            int rlen = ws_read(&r, buf, size);
+            if (rlen < 0) {
+                return false;
+            }
+            if (payload_offset == 0 && mode != MODE_EVENT) {
+                bool interrupted;
+                sink_frame = esp_websocket_sink_frame(&sink, &cb, r.opcode, &interrupted);
+            }
+            bool last = r.fin && payload_offset + rlen >= r.payload_len;
+            if (sink_frame) {
+                if (!esp_websocket_sink_data(&sink, buf, rlen, buf == rx_buffer, last)) {
+                    return false;
+                }
+            } else {
+                event_data_t ev = {
+                    .data_ptr = buf, .data_len = rlen, .op_code = r.opcode, .fin = r.fin,
+                    .payload_len = (int)r.payload_len, .payload_offset = (int)payload_offset,
+                };
+                event_post_and_run(4, &ev);
+            }
+            payload_offset += rlen;
+        } while (payload_offset < r.payload_len);
+    }
+    return true;
+}
+
+typedef struct {
+    double mbps;
+    double cpu_ms_per_mb;
+    bool ok;
+} result_t;
+
+static result_t run(mode_t_ mode)
+{
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t alen = sizeof(addr);
+    bind(lfd, (struct sockaddr *)&addr, sizeof(addr));
+    getsockname(lfd, (struct sockaddr *)&addr, &alen);
+    listen(lfd, 1);
+    int cfd = socket(AF_INET, SOCK_STREAM, 0);
+    connect(cfd, (struct sockaddr *)&addr, sizeof(addr));
+    int sfd = accept(lfd, NULL, NULL);
+
+    static app_t app;
+    memset(&app, 0, sizeof(app));
+    app.ok = true;
+    pthread_t ts;
+    pthread_create(&ts, NULL, server_thread, &sfd);
+
+    double t0 = now_s(CLOCK_MONOTONIC), c0 = now_s(CLOCK_THREAD_CPUTIME_ID);
+    bool ok = client_run(mode, cfd, &app);
+    double t1 = now_s(CLOCK_MONOTONIC), c1 = now_s(CLOCK_THREAD_CPUTIME_ID);
+    pthread_join(ts, NULL);
+    close(cfd);
+    close(sfd);
+    close(lfd);
+
+    double mb = (double)MESSAGES * MSG_LEN / (1024 * 1024);
+    result_t r = {
+        .mbps = mb / (t1 - t0),
+        .cpu_ms_per_mb = (c1 - c0) * 1000 / mb,
+        .ok = ok && app.ok && app.messages == MESSAGES,
+    };
+    return r;
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(s_pattern); i++) {
+        s_pattern[i] = (uint8_t)(i % PATTERN);
+    }
+    printf("%d 条 %dKB 二进制消息 (每条 %d 帧), 回环 TCP, 接收缓冲区 %d 字节, 应用环形缓冲区 %dKB\n\n", MESSAGES,
+           MSG_LEN / 1024, FRAMES_PER_MSG, RX_BUFFER, RING_SIZE / 1024);
+
+    result_t res[3];
+    for (int m = MODE_EVENT; m <= MODE_SINK_BUFFER; m++) {
+        // 取三次中最快的一次, 减少主机调度的干扰
+        res[m] = run(m);
+        for (int k = 0; k < 2; k++) {
+            result_t r = run(m);
+            res[m].ok = res[m].ok && r.ok;
+            if (r.cpu_ms_per_mb < res[m].cpu_ms_per_mb) {
+                res[m].cpu_ms_per_mb = r.cpu_ms_per_mb;
+                res[m].mbps = r.mbps;
+            }
+        }
+        printf("    %-28s %8.0f MB/s   客户端 CPU %6.3f ms/MB\n", s_mode_names[m], res[m].mbps, res[m].cpu_ms_per_mb);
+    }
+    printf("\n");
+
+    check(res[MODE_EVENT].ok && res[MODE_SINK].ok && res[MODE_SINK_BUFFER].ok, "三种方式收到的数据、偏移和 final 标志一致");
+    check(res[MODE_SINK].cpu_ms_per_mb < res[MODE_EVENT].cpu_ms_per_mb, "接收器省掉事件循环后 CPU 更少");
+    check(res[MODE_SINK_BUFFER].cpu_ms_per_mb < 0.5 * res[MODE_EVENT].cpu_ms_per_mb,
+          "直接读入应用缓冲区的 CPU 不到事件方式的一半");
+
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,492 @@
+/**
+ * @file ws_tls_resume_check.c
+ * @brief wss 重连复用 TLS 会话 (esp_websocket_tls_cache.c, 用法同 esp_websocket_tls.c) 的主机验证
+ * @details 本地 TLS WebSocket 服务器 (OpenSSL, 自签名 EC 证书) 代替 wss 服务器: 握手后读 HTTP 升级请求,
+ *          回 101 和 Sec-WebSocket-Accept, 再发一个文本帧. 服务器每读到数据后的第一次写先等一个往返时间
+ *          (RTT_MS), 模拟网络时延: TLS 1.2 完整握手要 2 个往返, 复用会话的简短握手只要 1 个.
+ *
+ *          客户端按 esp_websocket_tls.c 的方式连接: 连接前从缓存取该服务器 (主机 + 端口) 的会话提供给服务器,
+ *          握手成功后和关闭连接时把新会话存入缓存; 握手失败时丢弃提供的会话, 但 TCP 连不上时保留.
+ *          设备上 esp-tls 的会话对 OpenSSL 来说就是 SSL_SESSION, 释放函数换成 SSL_SESSION_free.
+ *
+ *          场景:
+ *          - TLS 1.2 session ticket: 重连都复用会话, 握手时间中位数明显短于完整握手
+ *          - TLS 1.2 session ID (服务器不发 ticket, 用服务器端会话缓存): 同样复用
+ *          - TLS 1.3: ticket 在握手之后才到, 靠关闭连接时再取一次会话, 重连仍能复用
+ *          - 服务器重启 (ticket 密钥更换): 提供的会话被拒绝, 完整握手照样成功, 之后又能复用
+ *          - 服务器停止 (TCP 连不上): 保留会话, 恢复后直接复用; 服务器接受 TCP 后断开 (TLS 失败): 丢弃会话
+ *          - 4 个缓存槽轮流连接 5 个服务器: 淘汰最久没用的会话, 其余照常复用
+ *          - 超过会话有效期不再提供
+ *          - 全部会话都释放且只释放一次
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Icomponents/esp_websocket_client/private_include tools/ws_host/ws_tls_resume_check.c \
+ *                components/esp_websocket_client/esp_websocket_tls_cache.c -lssl -lcrypto -lpthread -o /tmp/ws_tls_resume_check
+ *            /tmp/ws_tls_resume_check
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include "esp_websocket_tls_cache.h"
+
+#define RTT_MS          40          // 模拟的网络往返时间
+#define ROUNDS          7           // 每种握手测量次数
+#define SERVERS         5
+#define CACHE_SIZE      4           // 同 board.c: BOARD_WS_ENDPOINT_MAX
+#define HOST            "localhost"
+#define WS_GUID         "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static void sleep_ms(uint32_t ms)
+{
+    struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+static void ws_accept_key(const char *key, char *out)
+{
+    char buf[128];
+    unsigned char sha[SHA_DIGEST_LENGTH];
+    snprintf(buf, sizeof(buf), "%s%s", key, WS_GUID);
+    SHA1((const unsigned char *)buf, strlen(buf), sha);
+    EVP_EncodeBlock((unsigned char *)out, sha, sizeof(sha));
+}
+
+/* ---------------- 证书 ---------------- */
+
+static EVP_PKEY *s_key;
+static X509 *s_cert;
+
+static void make_cert(void)
+{
+    s_key = EVP_EC_gen("P-256");
+    s_cert = X509_new();
+    X509_set_version(s_cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(s_cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(s_cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(s_cert), 3600);
+    X509_set_pubkey(s_cert, s_key);
+    X509_NAME *name = X509_get_subject_name(s_cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)HOST, -1, -1, 0);
+    X509_set_issuer_name(s_cert, name);
+    X509_sign(s_cert, s_key, EVP_sha256());
+}
+
+/* ---------------- 服务器 ---------------- */
+
+typedef enum {
+    MODE_TLS12_TICKET,
+    MODE_TLS12_SESSION_ID,
+    MODE_TLS13,
+} server_mode_t;
+
+typedef struct {
+    uint16_t port;
+    int listen_fd;
+    SSL_CTX *ctx;                   // 每次启动新建: ticket 密钥和会话缓存随之更换
+    server_mode_t mode;
+    atomic_bool stop;
+    atomic_bool reject_tls;         // 接受 TCP 连接后立即断开
+    pthread_t thread;
+} server_t;
+
+static server_t s_srv[SERVERS];
+
+static long delay_cb(BIO *b, int oper, const char *argp, size_t len, int argi, long argl, int ret, size_t *processed)
+{
+    (void)argp;
+    (void)len;
+    (void)argi;
+    (void)argl;
+    (void)processed;
+    // 读到对方的数据之后的第一次写 (即一组握手消息或一个回复) 等一个往返时间
+    bool *pending = (bool *)BIO_get_callback_arg(b);
+    if (oper == (BIO_CB_READ | BIO_CB_RETURN) && ret > 0) {
+        *pending = true;
+    } else if (oper == BIO_CB_WRITE && *pending) {
+        *pending = false;
+        sleep_ms(RTT_MS);
+    }
+    return ret;
+}
+
+static void serve(server_t *srv, int fd)
+{
+    if (atomic_load(&srv->reject_tls)) {
+        close(fd);
+        return;
+    }
+    struct timeval tv = {.tv_sec = 2};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    SSL *ssl = SSL_new(srv->ctx);
+    SSL_set_fd(ssl, fd);
+    bool pending = false;
+    BIO_set_callback_arg(SSL_get_rbio(ssl), (char *)&pending);
+    BIO_set_callback_ex(SSL_get_rbio(ssl), delay_cb);
+    if (SSL_accept(ssl) == 1) {
+        char req[1024];
+        int n = 0;
+        while (n < (int)sizeof(req) - 1) {
+            int r = SSL_read(ssl, req + n, sizeof(req) - 1 - n);
+            if (r <= 0) {
+                break;
+            }
+            n += r;
+            req[n] = '\0';
+            if (strstr(req, "\r\n\r\n")) {
+                break;
+            }
+        }
+        req[n] = '\0';
+        char *key = strstr(req, "Sec-WebSocket-Key: ");
+        if (key) {
+            key += strlen("Sec-WebSocket-Key: ");
+            *strstr(key, "\r\n") = '\0';
+            char accept[64];
+            ws_accept_key(key, accept);
+            char resp[256];
+            int len = snprintf(resp, sizeof(resp), "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                               "Connection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n\x81\x05hello", accept);
+            SSL_write(ssl, resp, len);
+            // 等客户端关闭
+            while (SSL_read(ssl, req, sizeof(req)) > 0) {
+            }
+        }
+        SSL_shutdown(ssl);
+    }
+    SSL_free(ssl);
+    close(fd);
+}
+
+static void *server_thread(void *arg)
+{
+    server_t *srv = arg;
+    while (!atomic_load(&srv->stop)) {
+        struct pollfd p = {.fd = srv->listen_fd, .events = POLLIN};
+        if (poll(&p, 1, 20) == 1) {
+            int fd = accept(srv->listen_fd, NULL, NULL);
+            if (fd >= 0) {
+                serve(srv, fd);
+            }
+        }
+    }
+    return NULL;
+}
+
+/* 暂停/恢复只关闭和重新打开监听套接字, TLS 上下文 (ticket 密钥) 不变 */
+static void server_resume(server_t *srv)
+{
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a = {.sin_family = AF_INET, .sin_port = htons(srv->port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t len = sizeof(a);
+    if (bind(srv->listen_fd, (struct sockaddr *)&a, sizeof(a)) != 0 || listen(srv->listen_fd, 8) != 0) {
+        perror("listen");
+        exit(2);
+    }
+    getsockname(srv->listen_fd, (struct sockaddr *)&a, &len);
+    srv->port = ntohs(a.sin_port);
+    atomic_store(&srv->stop, false);
+    pthread_create(&srv->thread, NULL, server_thread, srv);
+}
+
+static void server_pause(server_t *srv)
+{
+    atomic_store(&srv->stop, true);
+    pthread_join(srv->thread, NULL);
+    close(srv->listen_fd);
+}
+
+static void server_start(server_t *srv)
+{
+    srv->ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate(srv->ctx, s_cert);
+    SSL_CTX_use_PrivateKey(srv->ctx, s_key);
+    SSL_CTX_set_max_proto_version(srv->ctx, srv->mode == MODE_TLS13 ? TLS1_3_VERSION : TLS1_2_VERSION);
+    SSL_CTX_set_session_id_context(srv->ctx, (const unsigned char *)"ws", 2);
+    if (srv->mode == MODE_TLS12_SESSION_ID) {
+        SSL_CTX_set_options(srv->ctx, SSL_OP_NO_TICKET);
+    }
+    server_resume(srv);
+}
+
+static void server_stop(server_t *srv)
+{
+    server_pause(srv);
+    SSL_CTX_free(srv->ctx);
+}
+
+/* ---------------- 客户端 (esp_websocket_tls.c 的做法) ---------------- */
+
+static SSL_CTX *s_client_ctx;
+static atomic_int s_sessions_taken;
+static atomic_int s_sessions_freed;
+
+static void free_session(void *session)
+{
+    atomic_fetch_add(&s_sessions_freed, 1);
+    SSL_SESSION_free(session);
+}
+
+static void store_session(esp_websocket_tls_cache_t *cache, SSL *ssl, uint16_t port)
+{
+    SSL_SESSION *session = SSL_get1_session(ssl);
+    if (session) {
+        atomic_fetch_add(&s_sessions_taken, 1);
+        esp_websocket_tls_cache_put(cache, HOST, port, session, now_ms());
+    }
+}
+
+typedef struct {
+    bool ok;
+    bool offered;
+    bool reused;                    // 服务器接受了提供的会话 (设备上 esp-tls 看不到, 只能从时间判断)
+    bool tcp_failed;
+    uint32_t ms;                    // TCP 连接 + TLS 握手
+} result_t;
+
+static result_t ws_connect(esp_websocket_tls_cache_t *cache, uint16_t port)
+{
+    result_t r = {0};
+    SSL_SESSION *session = esp_websocket_tls_cache_get(cache, HOST, port, now_ms());
+    r.offered = session != NULL;
+
+    uint32_t start = now_ms();
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (connect(fd, (struct sockaddr *)&a, sizeof(a)) != 0) {
+        // TCP 连不上: 与会话无关, 保留
+        close(fd);
+        r.tcp_failed = true;
+        return r;
+    }
+    struct timeval tv = {.tv_sec = 2};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    SSL *ssl = SSL_new(s_client_ctx);
+    SSL_set_fd(ssl, fd);
+    SSL_set_tlsext_host_name(ssl, HOST);
+    SSL_set1_host(ssl, HOST);
+    if (session) {
+        SSL_set_session(ssl, session);
+    }
+    if (SSL_connect(ssl) != 1) {
+        if (r.offered) {
+            esp_websocket_tls_cache_drop(cache, HOST, port);
+        }
+        SSL_free(ssl);
+        close(fd);
+        return r;
+    }
+    r.ms = now_ms() - start;
+    r.reused = SSL_session_reused(ssl);
+    store_session(cache, ssl, port);
+
+    // WebSocket 升级和第一个消息
+    const char *key = "dGhlIHNhbXBsZSBub25jZQ==";
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf), "GET /ws HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n", HOST, key);
+    SSL_write(ssl, buf, len);
+    int n = 0;
+    while (n < (int)sizeof(buf) - 1) {
+        int got = SSL_read(ssl, buf + n, sizeof(buf) - 1 - n);
+        if (got <= 0) {
+            break;
+        }
+        n += got;
+        buf[n] = '\0';
+        char *end = strstr(buf, "\r\n\r\n");
+        if (end && n >= end + 4 - buf + 7) {
+            break;
+        }
+    }
+    buf[n] = '\0';
+    char accept[64];
+    ws_accept_key(key, accept);
+    char *end = strstr(buf, "\r\n\r\n");
+    r.ok = strncmp(buf, "HTTP/1.1 101", 12) == 0 && strstr(buf, accept) && end &&
+           memcmp(end + 4, "\x81\x05hello", 7) == 0;
+
+    // 关闭: TLS 1.3 的 ticket 此时已经收到
+    store_session(cache, ssl, port);
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    close(fd);
+    return r;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t median(uint32_t *v, int n)
+{
+    qsort(v, n, sizeof(v[0]), cmp_u32);
+    return v[n / 2];
+}
+
+/* 完整握手 ROUNDS 次 (每次先丢弃会话) 和复用会话重连 ROUNDS 次, 返回两者中位数 */
+static bool measure(esp_websocket_tls_cache_t *cache, server_t *srv, uint32_t *full_ms, uint32_t *resumed_ms,
+                    int *reused)
+{
+    uint32_t full[ROUNDS], resumed[ROUNDS];
+    bool ok = true;
+    *reused = 0;
+    for (int i = 0; i < ROUNDS; i++) {
+        esp_websocket_tls_cache_drop(cache, HOST, srv->port);
+        result_t r = ws_connect(cache, srv->port);
+        ok = ok && r.ok && !r.offered && !r.reused;
+        full[i] = r.ms;
+    }
+    for (int i = 0; i < ROUNDS; i++) {
+        result_t r = ws_connect(cache, srv->port);
+        ok = ok && r.ok && r.offered;
+        *reused += r.reused;
+        resumed[i] = r.ms;
+    }
+    *full_ms = median(full, ROUNDS);
+    *resumed_ms = median(resumed, ROUNDS);
+    return ok;
+}
+
+int main(void)
+{
+    make_cert();
+    s_client_ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(s_client_ctx, SSL_VERIFY_PEER, NULL);
+    X509_STORE_add_cert(SSL_CTX_get_cert_store(s_client_ctx), s_cert);
+    // 同 esp-tls: 客户端自己保存会话, 不用 OpenSSL 的客户端会话缓存
+    SSL_CTX_set_session_cache_mode(s_client_ctx, SSL_SESS_CACHE_OFF);
+
+    esp_websocket_tls_cache_t cache;
+    esp_websocket_tls_cache_init(&cache, CACHE_SIZE, 0, free_session);
+    char what[256];
+    uint32_t full_ms, resumed_ms;
+    int reused;
+
+    printf("模拟往返时间 %d ms, 每种握手 %d 次取中位数\n", RTT_MS, ROUNDS);
+
+    printf("TLS 1.2 session ticket:\n");
+    s_srv[0].mode = MODE_TLS12_TICKET;
+    server_start(&s_srv[0]);
+    bool ok = measure(&cache, &s_srv[0], &full_ms, &resumed_ms, &reused);
+    snprintf(what, sizeof(what), "重连复用会话 %d/%d 次, 握手 完整 %u ms -> 复用 %u ms", reused, ROUNDS,
+             full_ms, resumed_ms);
+    check(ok && reused == ROUNDS, what);
+    check(resumed_ms * 4 < full_ms * 3, "复用会话的握手时间中位数明显短于完整握手 (少一个往返)");
+
+    printf("TLS 1.2 session ID:\n");
+    s_srv[1].mode = MODE_TLS12_SESSION_ID;
+    server_start(&s_srv[1]);
+    ok = measure(&cache, &s_srv[1], &full_ms, &resumed_ms, &reused);
+    snprintf(what, sizeof(what), "服务器不发 ticket 时用 session ID 复用 %d/%d 次, 握手 完整 %u ms -> 复用 %u ms",
+             reused, ROUNDS, full_ms, resumed_ms);
+    check(ok && reused == ROUNDS && resumed_ms < full_ms, what);
+
+    printf("TLS 1.3:\n");
+    s_srv[2].mode = MODE_TLS13;
+    server_start(&s_srv[2]);
+    ok = measure(&cache, &s_srv[2], &full_ms, &resumed_ms, &reused);
+    snprintf(what, sizeof(what), "握手后才到的 ticket 在关闭时取得, 重连复用 %d/%d 次 (握手 完整 %u ms, 复用 %u ms, "
+             "都是 1 个往返)", reused, ROUNDS, full_ms, resumed_ms);
+    check(ok && reused == ROUNDS, what);
+
+    printf("服务器重启和故障:\n");
+    server_stop(&s_srv[0]);
+    server_start(&s_srv[0]);
+    result_t r1 = ws_connect(&cache, s_srv[0].port);
+    result_t r2 = ws_connect(&cache, s_srv[0].port);
+    check(r1.ok && r1.offered && !r1.reused && r2.ok && r2.reused,
+          "服务器重启 (ticket 密钥更换) 后提供的会话被拒绝, 完整握手成功, 下一次又复用");
+
+    server_pause(&s_srv[0]);
+    result_t r3 = ws_connect(&cache, s_srv[0].port);
+    bool kept = esp_websocket_tls_cache_get(&cache, HOST, s_srv[0].port, now_ms()) != NULL;
+    server_resume(&s_srv[0]);
+    result_t r4 = ws_connect(&cache, s_srv[0].port);
+    check(r3.tcp_failed && kept && r4.ok && r4.offered && r4.reused,
+          "服务器停止 (TCP 连不上) 时保留会话, 恢复后直接复用");
+
+    atomic_store(&s_srv[0].reject_tls, true);
+    result_t r5 = ws_connect(&cache, s_srv[0].port);
+    atomic_store(&s_srv[0].reject_tls, false);
+    result_t r6 = ws_connect(&cache, s_srv[0].port);
+    check(!r5.ok && !r5.tcp_failed && r5.offered && r6.ok && !r6.offered,
+          "TLS 握手失败时丢弃提供的会话, 下一次完整握手");
+
+    printf("缓存槽和有效期:\n");
+    for (int i = 3; i < SERVERS; i++) {
+        s_srv[i].mode = MODE_TLS12_TICKET;
+        server_start(&s_srv[i]);
+    }
+    // 依次连接 0..4, 缓存 4 个槽: 最久没用的服务器 0 被淘汰
+    uint32_t evicted = cache.evicted;
+    for (int i = 0; i < SERVERS; i++) {
+        ws_connect(&cache, s_srv[i].port);
+    }
+    result_t r7 = ws_connect(&cache, s_srv[0].port);
+    result_t r8 = ws_connect(&cache, s_srv[4].port);
+    snprintf(what, sizeof(what), "%d 个槽轮流连接 %d 个服务器: 淘汰最久没用的会话 (%u 次), 其余照常复用",
+             CACHE_SIZE, SERVERS, cache.evicted - evicted);
+    check(cache.evicted > evicted && r7.ok && !r7.offered && r8.ok && r8.reused &&
+          esp_websocket_tls_cache_count(&cache) == CACHE_SIZE, what);
+
+    esp_websocket_tls_cache_t aged;
+    esp_websocket_tls_cache_init(&aged, CACHE_SIZE, 300, free_session);
+    ws_connect(&aged, s_srv[1].port);
+    result_t r9 = ws_connect(&aged, s_srv[1].port);
+    sleep_ms(400);
+    result_t r10 = ws_connect(&aged, s_srv[1].port);
+    check(r9.reused && r10.ok && !r10.offered && aged.expired == 1, "超过有效期的会话不再提供");
+
+    for (int i = 0; i < SERVERS; i++) {
+        server_stop(&s_srv[i]);
+    }
+    esp_websocket_tls_cache_deinit(&cache);
+    esp_websocket_tls_cache_deinit(&aged);
+    snprintf(what, sizeof(what), "取得的 %d 个会话全部释放且只释放一次", atomic_load(&s_sessions_taken));
+    check(atomic_load(&s_sessions_taken) == atomic_load(&s_sessions_freed), what);
+
+    SSL_CTX_free(s_client_ctx);
+    X509_free(s_cert);
+    EVP_PKEY_free(s_key);
+    printf("%s\n", s_failures ? "FAIL" : "PASS");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,646 @@
+/**
+ * @file ws_txq_bench.c
+ * @brief WebSocket 发送队列 (控制/批量通道) 主机基准与验证
+ * @details 在主机上编译 components/esp_websocket_client/esp_websocket_txq.c 和 esp_websocket_frame.c:
+ *          - 队列验证: 随机入队/出队复制消息和引用消息, 检查复制区不越界、内容不被覆盖、先进先出、
+ *            满时拒绝 (背压) 以及清空时每条消息的完成回调恰好调用一次
+ *          - 时延基准: 本地套接字对另一端的服务器替身按限定带宽读取 (模拟 WiFi 上行, 发送缓冲区设为 lwIP 的量级),
+ *            收到控制消息立即回显. 批量生产者让上传持续饱和, 控制生产者每 10ms 发一条控制消息,
+ *            测量从发起到收到回显的往返时延 (p50/p99/最大).
+ *            对照为原来的发送方式: 各任务直接调用发送函数, 在客户端锁内写完整条消息 (公平锁, 即最好情况),
+ *            批量为 4KB 分块或整段录音 (256KB 一条消息).
+ *            队列方式: 客户端任务先写完控制通道, 再写至多一条批量消息, 控制消息最多等待正在写的一个批量帧.
+ *          任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Icomponents/esp_websocket_client/private_include tools/ws_host/ws_txq_bench.c \
+ *                components/esp_websocket_client/esp_websocket_txq.c \
+ *                components/esp_websocket_client/esp_websocket_frame.c -lpthread -lm -o /tmp/ws_txq_bench
+ *            /tmp/ws_txq_bench
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_websocket_frame.h"
+#include "esp_websocket_txq.h"
+
+#define TX_BUFFER_SIZE  1024                // WEBSOCKET_BUFFER_SIZE_BYTE
+#define LINK_BPS        (1024 * 1024)       // 模拟上行带宽, 字节/秒
+#define SOCK_BUF        5760                // CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+#define CHUNK           (24 + 4096)         // 上传分块帧载荷 (头部 + 数据)
+#define BIG_MESSAGE     (256 * 1024)        // 整段录音一条消息
+#define CONTROL_EVERY_MS 10
+#define RUN_MS          4000
+#define POLL_MS         10                  // CONFIG_ESP_WS_CLIENT_TX_QUEUE_POLL_MS
+#define MAX_SAMPLES     4096
+#define BULK_SLOTS      2                   // audio_outbox 的 OUTBOX_TX_SLOTS
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static uint64_t s_rng = 0x2545F4914F6CDD1DULL;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 16);
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void sleep_us(int64_t us)
+{
+    if (us > 0) {
+        struct timespec ts = {.tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000};
+        nanosleep(&ts, NULL);
+    }
+}
+
+/* ---------------- 队列验证 ---------------- */
+
+static int s_done_calls[64];
+
+static void count_done(void *arg, bool sent)
+{
+    (void)sent;
+    s_done_calls[(intptr_t)arg]++;
+}
+
+static bool verify_queue(void)
+{
+    esp_websocket_txq_t q;
+    const size_t rings[ESP_WEBSOCKET_TXQ_LANES] = {1000, 0};
+    if (esp_websocket_txq_init(&q, rings, 8) != 0) {
+        return false;
+    }
+    bool ok = true;
+
+    // 复制消息: 随机长度, 内容由序号决定, 出队时校验
+    uint32_t pushed = 0, popped = 0, rejected = 0;
+    uint8_t msg[400];
+    for (int step = 0; step < 200000 && ok; step++) {
+        if (rnd() % 2) {
+            size_t len = rnd() % 400;
+            for (size_t i = 0; i < len; i++) {
+                msg[i] = (uint8_t)(pushed * 7 + i);
+            }
+            esp_websocket_txq_seg_t seg[2] = {{msg, len / 2}, {msg + len / 2, len - len / 2}};
+            if (esp_websocket_txq_push(&q, 0, 0x01, seg, 2, true, NULL, NULL) == 0) {
+                pushed++;
+            } else {
+                rejected++;
+                // 只有条数满或复制区放不下时才拒绝 (复制区要求连续空间, 放不下的尾部会被跳过)
+                esp_websocket_txq_lane_t *l = &q.lanes[0];
+                ok = ok && (l->count == l->depth || l->ring_size - l->ring_used < 2 * len);
+            }
+        } else {
+            int lane;
+            const esp_websocket_txq_msg_t *m = esp_websocket_txq_peek(&q, &lane);
+            if (m != NULL) {
+                const uint8_t *p = m->segs[0].data;
+                for (size_t i = 0; i < m->len; i++) {
+                    ok = ok && p[i] == (uint8_t)(popped * 7 + i);
+                }
+                ok = ok && p >= q.lanes[0].ring && p + m->len <= q.lanes[0].ring + q.lanes[0].ring_size;
+                esp_websocket_txq_msg_t out;
+                ok = ok && esp_websocket_txq_pop(&q, lane, true, &out) == 0 && out.len == m->len;
+                popped++;
+            }
+        }
+        ok = ok && q.lanes[0].ring_used <= q.lanes[0].ring_size;
+    }
+    ok = ok && rejected > 0 && pushed > 10000;
+
+    // 控制通道优先: 两个通道都有消息时先取控制通道
+    static const uint8_t ref[8];
+    esp_websocket_txq_seg_t seg = {ref, sizeof(ref)};
+    esp_websocket_txq_msg_t out;
+    int lane;
+    while (esp_websocket_txq_pop(&q, 0, true, &out) == 0) {
+    }
+    memset(s_done_calls, 0, sizeof(s_done_calls));
+    for (int i = 0; i < 8; i++) {
+        ok = ok && esp_websocket_txq_push(&q, 1, 0x02, &seg, 1, false, count_done, (void *)(intptr_t)i) == 0;
+    }
+    ok = ok && esp_websocket_txq_push(&q, 1, 0x02, &seg, 1, false, count_done, (void *)(intptr_t)8) != 0;
+    ok = ok && esp_websocket_txq_push(&q, 0, 0x01, &seg, 1, true, NULL, NULL) == 0;
+    ok = ok && esp_websocket_txq_peek(&q, &lane) != NULL && lane == 0;
+
+    // 清空: 每条引用消息的回调恰好一次
+    for (int l = 0; l < ESP_WEBSOCKET_TXQ_LANES; l++) {
+        while (esp_websocket_txq_pop(&q, l, false, &out) == 0) {
+            if (out.done) {
+                out.done(out.arg, false);
+            }
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        ok = ok && s_done_calls[i] == 1;
+    }
+    ok = ok && s_done_calls[8] == 0 && esp_websocket_txq_pending(&q) == 0 && q.lanes[1].stats.dropped == 8 &&
+         q.lanes[1].stats.rejected == 1;
+    esp_websocket_txq_deinit(&q);
+    return ok;
+}
+
+/* ---------------- 帧读写 ---------------- */
+
+static bool read_full(int fd, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool write_full(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+/* 与 esp_websocket_client_send_segments() 相同: 头部和各段掩码后拷入 1KB 发送缓冲区, 满了才写 */
+static bool write_frame(int fd, uint8_t opcode, const esp_websocket_txq_seg_t *segs, int n, size_t total)
+{
+    uint8_t tx[TX_BUFFER_SIZE];
+    uint8_t mask[4];
+    uint32_t r = rnd();
+    memcpy(mask, &r, 4);
+    size_t fill = esp_websocket_frame_header(tx, opcode | 0x80, total, mask);
+    size_t phase = 0;
+    for (int i = 0; i < n; i++) {
+        const uint8_t *src = segs[i].data;
+        size_t remain = segs[i].len;
+        while (remain > 0) {
+            size_t k = TX_BUFFER_SIZE - fill < remain ? TX_BUFFER_SIZE - fill : remain;
+            esp_websocket_mask_copy(tx + fill, src, k, mask, phase);
+            fill += k;
+            phase += k;
+            src += k;
+            remain -= k;
+            if (fill == TX_BUFFER_SIZE) {
+                if (!write_full(fd, tx, fill)) {
+                    return false;
+                }
+                fill = 0;
+            }
+        }
+    }
+    return fill == 0 || write_full(fd, tx, fill);
+}
+
+/* 读一帧的头部, 返回载荷长度; 掩码写入 mask (无掩码时为 0) */
+static bool read_header(int fd, uint8_t *opcode, uint64_t *len, uint8_t mask[4])
+{
+    uint8_t h[2];
+    if (!read_full(fd, h, 2)) {
+        return false;
+    }
+    *opcode = h[0];
+    *len = h[1] & 0x7F;
+    if (*len >= 126) {
+        uint8_t ext[8];
+        size_t n = *len == 126 ? 2 : 8;
+        if (!read_full(fd, ext, n)) {
+            return false;
+        }
+        *len = 0;
+        for (size_t i = 0; i < n; i++) {
+            *len = (*len << 8) | ext[i];
+        }
+    }
+    memset(mask, 0, 4);
+    return !(h[1] & 0x80) || read_full(fd, mask, 4);
+}
+
+/* ---------------- 服务器替身: 限速读取, 回显控制消息 ---------------- */
+
+typedef struct {
+    int fd;
+    atomic_bool stop;
+    uint64_t bulk_bytes;
+    uint64_t control_msgs;
+    bool ok;
+} server_t;
+
+static void *server_thread(void *arg)
+{
+    server_t *srv = arg;
+    srv->ok = true;
+
+    static uint8_t buf[8192];
+    int64_t t0 = now_us();
+    uint64_t link_bytes = 0;
+    while (srv->ok && !atomic_load(&srv->stop)) {
+        uint8_t opcode, mask[4];
+        uint64_t len;
+        if (!read_header(srv->fd, &opcode, &len, mask)) {
+            break;
+        }
+        uint64_t got = 0;
+        uint8_t text[64];
+        while (got < len) {
+            size_t n = len - got > sizeof(buf) ? sizeof(buf) : len - got;
+            // 按链路带宽读取: 读得慢, 客户端的发送缓冲区就会填满
+            n = n > 1024 ? 1024 : n;
+            if (!read_full(srv->fd, buf, n)) {
+                srv->ok = false;
+                break;
+            }
+            if ((opcode & 0x0F) == 0x01 && got < sizeof(text)) {
+                size_t k = n < sizeof(text) - got ? n : sizeof(text) - got;
+                for (size_t i = 0; i < k; i++) {
+                    text[got + i] = buf[i] ^ mask[(got + i) % 4];
+                }
+            }
+            got += n;
+            link_bytes += n;
+            sleep_us(t0 + (int64_t)(link_bytes * 1e6 / LINK_BPS) - now_us());
+        }
+        if ((opcode & 0x0F) == 0x01) {
+            // 控制消息: 原样回显 (服务器到客户端不掩码)
+            uint8_t echo[80];
+            size_t n = len < sizeof(text) ? len : sizeof(text);
+            size_t h = esp_websocket_frame_header(echo, 0x81, n, NULL);
+            memcpy(echo + h, text, n);
+            if (!write_full(srv->fd, echo, h + n)) {
+                break;
+            }
+            srv->control_msgs++;
+        } else {
+            srv->bulk_bytes += len;
+        }
+    }
+    return NULL;
+}
+
+/* ---------------- 共享状态 ---------------- */
+
+typedef enum {
+    MODE_DIRECT,        // 原方式: 各任务在客户端锁内直接写完整条消息
+    MODE_QUEUE,         // 发送队列: 客户端任务按通道优先级写
+} mode_t_;
+
+typedef struct {
+    mode_t_ mode;
+    size_t bulk_len;
+    int fd;
+    atomic_bool stop;
+
+    // 原方式: 公平 (排号) 的客户端锁
+    pthread_mutex_t m;
+    pthread_cond_t cv;
+    uint64_t next_ticket, serving;
+
+    // 队列方式
+    esp_websocket_txq_t q;
+    pthread_mutex_t qlock;
+    pthread_cond_t slot_cv;
+    int bulk_in_flight;
+
+    // 控制消息往返时延
+    int64_t sent_us[MAX_SAMPLES];
+    double rtt_ms[MAX_SAMPLES];
+    atomic_int rtt_count;
+    atomic_int control_sent;
+    uint32_t control_rejected;
+    int64_t call_max_us;        // 控制消息发送调用本身的最长阻塞时间
+    uint64_t bulk_written;
+} bench_t;
+
+static void lock_fair(bench_t *b)
+{
+    pthread_mutex_lock(&b->m);
+    uint64_t t = b->next_ticket++;
+    while (b->serving != t) {
+        pthread_cond_wait(&b->cv, &b->m);
+    }
+    pthread_mutex_unlock(&b->m);
+}
+
+static void unlock_fair(bench_t *b)
+{
+    pthread_mutex_lock(&b->m);
+    b->serving++;
+    pthread_cond_broadcast(&b->cv);
+    pthread_mutex_unlock(&b->m);
+}
+
+static void bulk_done(void *arg, bool sent)
+{
+    (void)sent;
+    bench_t *b = arg;
+    pthread_mutex_lock(&b->qlock);
+    b->bulk_in_flight--;
+    pthread_cond_signal(&b->slot_cv);
+    pthread_mutex_unlock(&b->qlock);
+}
+
+static uint8_t s_bulk_src[BIG_MESSAGE];
+
+/* 批量生产者: 让上传一直饱和 */
+static void *bulk_thread(void *arg)
+{
+    bench_t *b = arg;
+    static uint8_t hdr[24];
+    while (!atomic_load(&b->stop)) {
+        esp_websocket_txq_seg_t segs[2] = {{hdr, 24}, {s_bulk_src, b->bulk_len - 24}};
+        if (b->mode == MODE_DIRECT) {
+            lock_fair(b);
+            bool ok = write_frame(b->fd, 0x02, segs, 2, b->bulk_len);
+            unlock_fair(b);
+            if (!ok) {
+                break;
+            }
+            b->bulk_written += b->bulk_len;
+        } else {
+            pthread_mutex_lock(&b->qlock);
+            while (b->bulk_in_flight >= BULK_SLOTS && !atomic_load(&b->stop)) {
+                pthread_cond_wait(&b->slot_cv, &b->qlock);
+            }
+            if (esp_websocket_txq_push(&b->q, 1, 0x02, segs, 2, false, bulk_done, b) == 0) {
+                b->bulk_in_flight++;
+            }
+            pthread_mutex_unlock(&b->qlock);
+        }
+    }
+    return NULL;
+}
+
+/* 控制生产者: 每 CONTROL_EVERY_MS 一条, 消息带序号 */
+static void *control_thread(void *arg)
+{
+    bench_t *b = arg;
+    int64_t next = now_us();
+    while (!atomic_load(&b->stop)) {
+        int seq = atomic_load(&b->control_sent);
+        if (seq >= MAX_SAMPLES) {
+            break;
+        }
+        char msg[48];
+        int len = snprintf(msg, sizeof(msg), "{\"event\":\"ctl\",\"seq\":%d}", seq);
+        b->sent_us[seq] = now_us();
+        esp_websocket_txq_seg_t seg = {msg, (size_t)len};
+        int64_t call = now_us();
+        if (b->mode == MODE_DIRECT) {
+            lock_fair(b);
+            write_frame(b->fd, 0x01, &seg, 1, len);
+            unlock_fair(b);
+            atomic_fetch_add(&b->control_sent, 1);
+        } else {
+            pthread_mutex_lock(&b->qlock);
+            if (esp_websocket_txq_push(&b->q, 0, 0x01, &seg, 1, true, NULL, NULL) == 0) {
+                atomic_fetch_add(&b->control_sent, 1);
+            } else {
+                b->control_rejected++;
+            }
+            pthread_mutex_unlock(&b->qlock);
+        }
+        call = now_us() - call;
+        if (call > b->call_max_us) {
+            b->call_max_us = call;
+        }
+        next += CONTROL_EVERY_MS * 1000;
+        sleep_us(next - now_us());
+    }
+    return NULL;
+}
+
+/* 读取一条回显并记录往返时延 */
+static bool read_echo(bench_t *b)
+{
+    uint8_t opcode, mask[4];
+    uint64_t len;
+    char text[80];
+    if (!read_header(b->fd, &opcode, &len, mask) || len >= sizeof(text) || !read_full(b->fd, text, len)) {
+        return false;
+    }
+    text[len] = 0;
+    const char *p = strstr(text, "\"seq\":");
+    int seq = p ? atoi(p + 6) : -1;
+    int n = atomic_load(&b->rtt_count);
+    if (seq >= 0 && seq < MAX_SAMPLES && n < MAX_SAMPLES) {
+        b->rtt_ms[n] = (now_us() - b->sent_us[seq]) / 1000.0;
+        atomic_fetch_add(&b->rtt_count, 1);
+    }
+    return true;
+}
+
+/* 原方式的接收: 客户端任务只读 */
+static void *reader_thread(void *arg)
+{
+    bench_t *b = arg;
+    while (!atomic_load(&b->stop)) {
+        struct pollfd pfd = {.fd = b->fd, .events = POLLIN};
+        if (poll(&pfd, 1, POLL_MS) > 0 && !read_echo(b)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* 队列方式的客户端任务: 与 esp_websocket_client_drain_tx_queue() 相同的顺序 */
+static void *client_task(void *arg)
+{
+    bench_t *b = arg;
+    bool pending = false;
+    while (!atomic_load(&b->stop)) {
+        int lane = 0;
+        while (lane == 0) {
+            pthread_mutex_lock(&b->qlock);
+            const esp_websocket_txq_msg_t *head = esp_websocket_txq_peek(&b->q, &lane);
+            esp_websocket_txq_msg_t msg;
+            if (head) {
+                msg = *head;
+            }
+            pthread_mutex_unlock(&b->qlock);
+            if (head == NULL) {
+                break;
+            }
+            bool sent = write_frame(b->fd, msg.opcode, msg.segs, msg.seg_count, msg.len);
+            pthread_mutex_lock(&b->qlock);
+            esp_websocket_txq_pop(&b->q, lane, sent, &msg);
+            pthread_mutex_unlock(&b->qlock);
+            if (lane == 1 && sent) {
+                b->bulk_written += msg.len;
+            }
+            if (msg.done) {
+                msg.done(msg.arg, sent);
+            }
+        }
+        pthread_mutex_lock(&b->qlock);
+        pending = esp_websocket_txq_pending(&b->q) > 0;
+        pthread_mutex_unlock(&b->qlock);
+
+        struct pollfd pfd = {.fd = b->fd, .events = POLLIN};
+        while (poll(&pfd, 1, pending ? 0 : POLL_MS) > 0) {
+            if (!read_echo(b)) {
+                return NULL;
+            }
+            pending = true;     // 读完已到的回显后马上回去发送
+        }
+    }
+    return NULL;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+typedef struct {
+    double p50, p99, max;
+    int samples;
+    double call_max;
+    double bulk_kbps;
+    uint32_t rejected;
+} result_t;
+
+static result_t run(mode_t_ mode, size_t bulk_len)
+{
+    static bench_t b;
+    memset(&b, 0, sizeof(b));
+    b.mode = mode;
+    b.bulk_len = bulk_len;
+    pthread_mutex_init(&b.m, NULL);
+    pthread_cond_init(&b.cv, NULL);
+    pthread_mutex_init(&b.qlock, NULL);
+    pthread_cond_init(&b.slot_cv, NULL);
+    const size_t rings[ESP_WEBSOCKET_TXQ_LANES] = {4096, 1024};    // BOARD_WS_TX_CONTROL_BYTES / BULK_BYTES
+    esp_websocket_txq_init(&b.q, rings, 16);
+
+    // 本地流套接字对代替 TCP: 服务器读走数据后立即唤醒写方, 没有回环 TCP 小窗口时的零窗口探测延迟
+    static server_t srv;
+    memset(&srv, 0, sizeof(srv));
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    b.fd = sv[0];
+    srv.fd = sv[1];
+    int snd = SOCK_BUF;
+    setsockopt(b.fd, SOL_SOCKET, SO_SNDBUF, &snd, sizeof(snd));
+    pthread_t ts, tb, tc, tr;
+    pthread_create(&ts, NULL, server_thread, &srv);
+
+    pthread_create(&tr, NULL, mode == MODE_DIRECT ? reader_thread : client_task, &b);
+    pthread_create(&tb, NULL, bulk_thread, &b);
+    usleep(300 * 1000);     // 先让批量上传饱和
+    int64_t t0 = now_us();
+    uint64_t bulk0 = b.bulk_written;
+    pthread_create(&tc, NULL, control_thread, &b);
+    usleep(RUN_MS * 1000);
+    atomic_store(&b.stop, true);
+    double secs = (now_us() - t0) / 1e6;
+    uint64_t bulk1 = b.bulk_written;
+
+    pthread_mutex_lock(&b.qlock);
+    pthread_cond_broadcast(&b.slot_cv);
+    pthread_mutex_unlock(&b.qlock);
+    shutdown(b.fd, SHUT_RDWR);
+    atomic_store(&srv.stop, true);
+    pthread_join(tc, NULL);
+    pthread_join(tb, NULL);
+    pthread_join(tr, NULL);
+    shutdown(srv.fd, SHUT_RDWR);
+    pthread_join(ts, NULL);
+    close(b.fd);
+    close(srv.fd);
+
+    // 清空队列中残留的引用消息
+    esp_websocket_txq_msg_t out;
+    for (int l = 0; l < ESP_WEBSOCKET_TXQ_LANES; l++) {
+        while (esp_websocket_txq_pop(&b.q, l, false, &out) == 0) {
+        }
+    }
+    esp_websocket_txq_deinit(&b.q);
+
+    result_t r = {0};
+    int n = atomic_load(&b.rtt_count);
+    qsort(b.rtt_ms, n, sizeof(double), cmp_double);
+    r.samples = n;
+    if (n > 0) {
+        r.p50 = b.rtt_ms[n / 2];
+        r.p99 = b.rtt_ms[(int)(n * 0.99)];
+        r.max = b.rtt_ms[n - 1];
+    }
+    r.bulk_kbps = (bulk1 - bulk0) / 1024.0 / secs;
+    r.rejected = b.control_rejected;
+    r.call_max = b.call_max_us / 1000.0;
+    return r;
+}
+
+static void report(const char *name, const result_t *r)
+{
+    printf("    %-24s 控制往返 p50 %6.1f ms  p99 %6.1f ms  最大 %6.1f ms (%3d 条)  调用最长阻塞 %6.2f ms  批量 %4.0f KB/s\n",
+           name, r->p50, r->p99, r->max, r->samples, r->call_max, r->bulk_kbps);
+}
+
+int main(void)
+{
+    check(verify_queue(), "队列: 复制区不越界, 内容与顺序正确, 满时拒绝, 控制通道优先, 清空时回调恰好一次");
+
+    for (size_t i = 0; i < sizeof(s_bulk_src); i++) {
+        s_bulk_src[i] = (uint8_t)rnd();
+    }
+    printf("\n链路 %d KB/s, 发送/接收缓冲区 %d 字节, 控制消息每 %d ms 一条, 批量持续饱和, 每种 %d ms\n",
+           LINK_BPS / 1024, SOCK_BUF, CONTROL_EVERY_MS, RUN_MS);
+
+    result_t d_big = run(MODE_DIRECT, BIG_MESSAGE);
+    report("原方式, 256KB 录音消息", &d_big);
+    result_t d_chunk = run(MODE_DIRECT, CHUNK);
+    report("原方式, 4KB 分块", &d_chunk);
+    result_t q_chunk = run(MODE_QUEUE, CHUNK);
+    report("发送队列, 4KB 分块", &q_chunk);
+
+    // 控制消息在队列方式下最多等待正在写的一个分块帧和发送缓冲区中的数据
+    double bound_ms = (CHUNK + 2.0 * SOCK_BUF) * 1000.0 / LINK_BPS + 2 * POLL_MS;
+    printf("    理论上限 (一个分块 + 双向缓冲区 + 两个轮询周期): %.1f ms\n", bound_ms);
+
+    check(q_chunk.samples > RUN_MS / CONTROL_EVERY_MS / 2, "队列方式收到足够的控制回显");
+    check(q_chunk.rejected == 0, "控制通道没有拒绝");
+    check(q_chunk.p99 <= bound_ms, "队列方式控制往返 p99 不超过理论上限");
+    check(q_chunk.p99 < d_big.p99 / 4, "队列方式 p99 远低于原方式的整段录音发送");
+    check(q_chunk.call_max < 1.0, "入队不阻塞调用者 (< 1 ms)");
+    check(q_chunk.bulk_kbps > 0.85 * LINK_BPS / 1024, "批量上传仍占满链路 (> 85%)");
+
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+/**
+ * @file ws_wakeup_bench.c
+ * @brief WebSocket 客户端任务等待方式的主机基准
+ * @details 在主机 (Linux) 上编译 components/esp_websocket_client/esp_websocket_wakeup.c, 用与
+ *          esp_websocket_client_task() 相同结构的循环比较三种等待方式:
+ *          - 1s 轮询: 原来的 esp_transport_poll_read(transport, 1000)
+ *          - 10ms 轮询: 发送队列开启时的 CONFIG_ESP_WS_CLIENT_TX_QUEUE_POLL_MS
+ *          - 唤醒事件: select 同时等待套接字和 eventfd, 超时取下一个 PING 截止时间
+ *          测量入队到数据写出的时延、停止请求到任务退出的时延、PING 相对截止时间的延迟,
+ *          以及空闲时每秒的唤醒次数. 对端是本地套接字对另一端的线程. 任一验证失败时返回非 0.
+ *
+ *          编译运行:
+ *            gcc -O2 -Icomponents/esp_websocket_client/private_include tools/ws_host/ws_wakeup_bench.c \
+ *                components/esp_websocket_client/esp_websocket_wakeup.c -lpthread -o /tmp/ws_wakeup_bench
+ *            /tmp/ws_wakeup_bench
+ */
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_websocket_wakeup.h"
+
+#define PING_INTERVAL_MS    1500
+#define SEND_SAMPLES        40
+#define STOP_SAMPLES        8
+#define IDLE_MS             2000
+
+typedef enum {
+    WAIT_SLICE_1000,
+    WAIT_SLICE_10,
+    WAIT_WAKEUP,
+} wait_mode_t;
+
+static const char *const s_mode_names[] = {"1s 轮询", "10ms 轮询", "唤醒事件"};
+
+static int s_failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        s_failures++;
+    }
+    printf("  [%s] %s\n", ok ? " OK " : "FAIL", what);
+}
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static uint64_t s_rng = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 16);
+}
+
+/* ---------------- 模拟的客户端任务 ---------------- */
+
+typedef struct {
+    wait_mode_t mode;
+    int sock;                   // 客户端一端
+    int peer;                   // 对端
+    int wakeup_fd;
+    atomic_bool run;
+    pthread_mutex_t lock;       // 相当于 tx_queue_lock
+    int64_t queued[64];         // 排队消息的入队时间
+    int queued_count;
+    int64_t ping_tick_us;
+    double ping_late_ms_max;
+    int pings;
+    atomic_int iterations;
+} client_t;
+
+static int ms_until(int64_t since_us, int64_t interval_ms)
+{
+    int64_t left = since_us + interval_ms * 1000 - now_us();
+    return left <= 0 ? 0 : (int)((left + 999) / 1000);
+}
+
+/* 原来的两种方式按固定片轮询; 唤醒事件与 esp_websocket_client_poll() 相同, 等到下一个截止时间 */
+static int client_poll(client_t *c, bool tx_pending)
+{
+    struct pollfd pfd = {.fd = c->sock, .events = POLLIN};
+    if (tx_pending) {
+        return poll(&pfd, 1, 0);
+    }
+    if (c->mode != WAIT_WAKEUP) {
+        return poll(&pfd, 1, c->mode == WAIT_SLICE_10 ? 10 : 1000);
+    }
+    return esp_websocket_wakeup_wait(c->wakeup_fd, c->sock, ms_until(c->ping_tick_us, PING_INTERVAL_MS));
+}
+
+static void *client_task(void *arg)
+{
+    client_t *c = arg;
+    bool tx_pending = false;
+    int read_select = 0;
+    while (atomic_load(&c->run)) {
+        atomic_fetch_add(&c->iterations, 1);
+        // PING: 原循环在 1s 轮询超时之后才检查截止时间
+        int64_t now = now_us();
+        if (now - c->ping_tick_us > PING_INTERVAL_MS * 1000) {
+            double late = (now - c->ping_tick_us - PING_INTERVAL_MS * 1000) / 1000.0;
+            if (late > c->ping_late_ms_max) {
+                c->ping_late_ms_max = late;
+            }
+            c->pings++;
+            c->ping_tick_us = now;
+            int64_t ping = 0;
+            (void)!write(c->sock, &ping, sizeof(ping));
+        }
+        // 发送队列: 每条消息把入队时间写给对端
+        pthread_mutex_lock(&c->lock);
+        for (int i = 0; i < c->queued_count; i++) {
+            (void)!write(c->sock, &c->queued[i], sizeof(c->queued[i]));
+        }
+        c->queued_count = 0;
+        tx_pending = false;
+        pthread_mutex_unlock(&c->lock);
+        if (read_select > 0) {
+            char buf[64];
+            (void)!read(c->sock, buf, sizeof(buf));
+        }
+        if (!atomic_load(&c->run)) {
+            break;
+        }
+        read_select = client_poll(c, tx_pending);
+    }
+    return NULL;
+}
+
+static void client_start(client_t *c, wait_mode_t mode, pthread_t *task)
+{
+    memset(c, 0, sizeof(*c));
+    c->mode = mode;
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    c->sock = sv[0];
+    c->peer = sv[1];
+    c->wakeup_fd = mode == WAIT_WAKEUP ? esp_websocket_wakeup_open() : -1;
+    pthread_mutex_init(&c->lock, NULL);
+    c->ping_tick_us = now_us();
+    atomic_store(&c->run, true);
+    pthread_create(task, NULL, client_task, c);
+}
+
+/* 相当于 esp_websocket_client_stop(): 清除 run, 唤醒任务并等待退出 */
+static double client_stop(client_t *c, pthread_t task)
+{
+    int64_t t0 = now_us();
+    atomic_store(&c->run, false);
+    esp_websocket_wakeup_signal(c->wakeup_fd);
+    pthread_join(task, NULL);
+    double ms = (now_us() - t0) / 1000.0;
+    esp_websocket_wakeup_close(c->wakeup_fd);
+    close(c->sock);
+    close(c->peer);
+    return ms;
+}
+
+/* 相当于 esp_websocket_client_enqueue() */
+static void client_enqueue(client_t *c)
+{
+    pthread_mutex_lock(&c->lock);
+    c->queued[c->queued_count++] = now_us();
+    pthread_mutex_unlock(&c->lock);
+    esp_websocket_wakeup_signal(c->wakeup_fd);
+}
+
+/* 对端收到一条消息 (跳过 PING) 时返回入队到收到的时延 */
+static double peer_receive(client_t *c)
+{
+    for (;;) {
+        int64_t stamp;
+        if (read(c->peer, &stamp, sizeof(stamp)) != sizeof(stamp)) {
+            return -1;
+        }
+        if (stamp != 0) {
+            return (now_us() - stamp) / 1000.0;
+        }
+    }
+}
+
+static void sleep_ms(int ms)
+{
+    usleep(ms * 1000);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+typedef struct {
+    double send_p50, send_p99, send_max;
+    double stop_p50, stop_max;
+    double ping_late_max;
+    double idle_wakeups;
+} result_t;
+
+static result_t run(wait_mode_t mode)
+{
+    result_t r = {0};
+    client_t c;
+    pthread_t task;
+
+    // 入队到写出: 随机间隔入队, 对端测量
+    static double send_ms[SEND_SAMPLES];
+    client_start(&c, mode, &task);
+    for (int i = 0; i < SEND_SAMPLES; i++) {
+        sleep_ms(5 + rnd() % 30);
+        client_enqueue(&c);
+        send_ms[i] = peer_receive(&c);
+    }
+    // 空闲唤醒次数
+    int before = atomic_load(&c.iterations);
+    sleep_ms(IDLE_MS);
+    r.idle_wakeups = (atomic_load(&c.iterations) - before) * 1000.0 / IDLE_MS;
+    r.ping_late_max = c.ping_late_ms_max;
+    client_stop(&c, task);
+    qsort(send_ms, SEND_SAMPLES, sizeof(double), cmp_double);
+    r.send_p50 = send_ms[SEND_SAMPLES / 2];
+    r.send_p99 = send_ms[SEND_SAMPLES * 99 / 100];
+    r.send_max = send_ms[SEND_SAMPLES - 1];
+
+    // 停止: 启动后随机时刻停止
+    double stop_ms[STOP_SAMPLES];
+    for (int i = 0; i < STOP_SAMPLES; i++) {
+        client_start(&c, mode, &task);
+        sleep_ms(20 + rnd() % 200);
+        stop_ms[i] = client_stop(&c, task);
+    }
+    qsort(stop_ms, STOP_SAMPLES, sizeof(double), cmp_double);
+    r.stop_p50 = stop_ms[STOP_SAMPLES / 2];
+    r.stop_max = stop_ms[STOP_SAMPLES - 1];
+    return r;
+}
+
+int main(void)
+{
+    printf("PING 间隔 %d ms, 入队 %d 次, 停止 %d 次, 空闲 %d ms\n\n", PING_INTERVAL_MS, SEND_SAMPLES, STOP_SAMPLES, IDLE_MS);
+    result_t res[3];
+    for (int m = WAIT_SLICE_1000; m <= WAIT_WAKEUP; m++) {
+        res[m] = run(m);
+        printf("  %s\n    入队到写出 p50 %.2f / p99 %.2f / 最大 %.2f ms, 停止 p50 %.2f / 最大 %.2f ms, "
+               "PING 最大延迟 %.1f ms, 空闲唤醒 %.1f 次/s\n", s_mode_names[m], res[m].send_p50, res[m].send_p99,
+               res[m].send_max, res[m].stop_p50, res[m].stop_max, res[m].ping_late_max, res[m].idle_wakeups);
+    }
+    printf("\n");
+
+    const result_t *w = &res[WAIT_WAKEUP];
+    check(w->send_p50 < 1.0 && w->send_p99 < 2.0, "唤醒事件: 入队到写出 p50 < 1ms, p99 < 2ms");
+    check(w->stop_max < 2.0, "唤醒事件: 停止请求 < 2ms 内任务退出");
+    check(w->ping_late_max < 5.0, "唤醒事件: PING 按截止时间发送 (延迟 < 5ms)");
+    check(w->idle_wakeups < 2 * 1000.0 / PING_INTERVAL_MS, "唤醒事件: 空闲时只在 PING 截止时间醒来");
+    check(res[WAIT_SLICE_1000].send_p50 > 100 * w->send_p50, "1s 轮询的入队到写出时延高两个数量级以上");
+    check(res[WAIT_SLICE_1000].stop_p50 > 100 * w->stop_p50, "1s 轮询的停止时延高两个数量级以上");
+    check(res[WAIT_SLICE_10].idle_wakeups > 20 * w->idle_wakeups, "10ms 轮询空闲唤醒次数多一个数量级以上");
+
+    printf("\n%s: %d 项失败\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}